@@ -6,6 +6,14 @@
 
 const unsigned long g_MaxUnInt = -1;
 
+// ļ[Magic][][][ֽ][][][ͼ˳][ͼ˳]ModelFactory::LoadMeshһ
+// 65536ʱʹ16λʹ32λ
+// ڵûRwgeViewOrders = trueʱ͸񣩣Ϊ8޸һӺǰ˳ÿ˳Ϊ*3
+// ͬͼ˳Ϊ0
+const unsigned int g_u32MeshFileMagic = 0x48534D52;		// "RMSH"
+const unsigned int g_u32MaxIndex16VertexCount = 65536;
+const unsigned int g_u32ViewOrderCount = 8;
+
 struct VertexData
 {
 	Point3 position;
@@ -26,6 +26,7 @@
 #include <map>
 #include <vector>
 #include <fstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -229,6 +230,56 @@ bool Rwge3dsMaxPlug::ExportBones()
 	return true;
 }
 
+// ΪÿһӺǰ˳ޱRRenderUnit::SelectViewOrderһ£۲췽x<0Ϊ0λ
+// y<0Ϊ1λz<0Ϊ2λΰ޴ϵľӴСУͬʱԭ˳
+static void BuildViewOrders(const vector<VertexData>& vertices, const vector<unsigned int>& indices, vector<unsigned int>& viewOrders)
+{
+	const unsigned int uFaceCount = static_cast<unsigned int>(indices.size() / 3);
+
+	vector<Point3> centroids(uFaceCount);
+	for (unsigned int i = 0; i < uFaceCount; ++i)
+	{
+		centroids[i] = (vertices[indices[i * 3 + 0]].position + vertices[indices[i * 3 + 1]].position + vertices[indices[i * 3 + 2]].position) / 3.0f;
+	}
+
+	vector<unsigned int> faces(uFaceCount);
+	vector<float> depths(uFaceCount);
+	viewOrders.clear();
+	viewOrders.reserve(g_u32ViewOrderCount * indices.size());
+
+	for (unsigned int uOctant = 0; uOctant < g_u32ViewOrderCount; ++uOctant)
+	{
+		Point3 direction((uOctant & 1) ? -1.0f : 1.0f, (uOctant & 2) ? -1.0f : 1.0f, (uOctant & 4) ? -1.0f : 1.0f);
+		for (unsigned int i = 0; i < uFaceCount; ++i)
+		{
+			faces[i] = i;
+			depths[i] = DotProd(centroids[i], direction);
+		}
+
+		stable_sort(faces.begin(), faces.end(), [&depths](unsigned int uFace0, unsigned int uFace1) { return depths[uFace0] > depths[uFace1]; });
+
+		for (unsigned int uFace : faces)
+		{
+			viewOrders.push_back(indices[uFace * 3 + 0]);
+			viewOrders.push_back(indices[uFace * 3 + 1]);
+			viewOrders.push_back(indices[uFace * 3 + 2]);
+		}
+	}
+}
+
+static void WriteIndices(ofstream& meshFile, const vector<unsigned int>& indices, unsigned int uIndexSize)
+{
+	if (uIndexSize == sizeof(unsigned int))
+	{
+		meshFile.write(reinterpret_cast<const char*>(indices.data()), sizeof(unsigned int) * indices.size());
+	}
+	else
+	{
+		vector<unsigned short> indices16(indices.begin(), indices.end());
+		meshFile.write(reinterpret_cast<const char*>(indices16.data()), sizeof(unsigned short) * indices16.size());
+	}
+}
+
 bool Rwge3dsMaxPlug::ExportMesh(IGameNode* pNode) 
 {
 	IGameMesh* pMesh = static_cast<IGameMesh*>(pNode->GetIGameObject());
@@ -449,21 +500,41 @@ bool Rwge3dsMaxPlug::ExportMesh(IGameNode* pNode)
 	strFileName.append(".mesh");
 	meshFile.open(strFileName, ios::out | ios::binary);
 	
-	unsigned short* indices = new unsigned short[modelFile.uFaceCount * 3];
+	// ֶ֮ȷȣ16λΧʱʹ32λٽض
+	vector<unsigned int> indices(modelFile.uFaceCount * 3);
 	for (unsigned int i = 0; i < modelFile.uFaceCount; ++i) 
 	{
 		FaceEx * pFace = pMesh->GetFace(i);
-		indices[i * 3 + 0] = static_cast<unsigned short>(pFace->vert[0]);
-		indices[i * 3 + 1] = static_cast<unsigned short>(pFace->vert[1]);
-		indices[i * 3 + 2] = static_cast<unsigned short>(pFace->vert[2]);
+		indices[i * 3 + 0] = pFace->vert[0];
+		indices[i * 3 + 1] = pFace->vert[1];
+		indices[i * 3 + 2] = pFace->vert[2];
 	}
 
+	unsigned int uIndexSize = modelFile.uVertexCount <= g_u32MaxIndex16VertexCount ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	// ͸ûRwgeViewOrders = trueÿ޵˳
+	BOOL bViewOrders = FALSE;
+	pNode->GetMaxNode()->GetUserPropBool(_T("RwgeViewOrders"), bViewOrders);
+
+	vector<unsigned int> viewOrders;
+	if (bViewOrders)
+	{
+		BuildViewOrders(vertices, indices, viewOrders);
+	}
+	unsigned int uViewOrderCount = bViewOrders ? g_u32ViewOrderCount : 0;
+
+	meshFile.write(reinterpret_cast<const char*>(&g_u32MeshFileMagic), sizeof(g_u32MeshFileMagic));
 	meshFile.write(reinterpret_cast<char*>(&modelFile.uVertexCount), sizeof(modelFile.uVertexCount));
 	meshFile.write(reinterpret_cast<char*>(&modelFile.uFaceCount), sizeof(modelFile.uFaceCount));
+	meshFile.write(reinterpret_cast<char*>(&uIndexSize), sizeof(uIndexSize));
 	for (unsigned int i = 0; i < modelFile.uVertexCount; ++i) {
 		meshFile.write(reinterpret_cast<char*>(&vertices[i]), sizeof(Point3) * 3 + sizeof(Point2));
 	}
-	meshFile.write(reinterpret_cast<char*>(indices), sizeof(unsigned short)* modelFile.uFaceCount * 3);
+
+	WriteIndices(meshFile, indices, uIndexSize);
+
+	meshFile.write(reinterpret_cast<char*>(&uViewOrderCount), sizeof(uViewOrderCount));
+	WriteIndices(meshFile, viewOrders, uIndexSize);
 
 	meshFile.close();
 
@@ -0,0 +1,26 @@
+#include <cstdio>
+#include <RwgeApplication.h>
+#include <RwgeD3d9RenderSystem.h>
+
+#include "RwgeBenchmark.h"
+
+int main()
+{
+	// RApplicationRenderSystemǵл׼ԹͬһӦóͷȾĿ
+	RApplication::AppDelegate appDelegate;
+	RApplication::SetDelegate(&appDelegate);
+
+	RApplication application;
+	RD3d9RenderSystem::GetInstance().CreateHeadlessRenderTarget(320, 240);
+
+	bool bPassed = true;
+
+	bPassed = RunTransformBenchmark() && bPassed;
+	bPassed = RunSpatialIndexBenchmark() && bPassed;
+	bPassed = RunSubmitBenchmark() && bPassed;
+	bPassed = RunOcclusionBenchmark() && bPassed;
+
+	printf(bPassed ? "All benchmark results verified.\n" : "Benchmark verification FAILED!\n");
+
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	ͷ׼Գ򣬲ڣ̨
+	2.	ÿ׼ڼʱͬʱУУʧʱfalseķֵΪ0
+	3.	Ҫģ͵Ļ׼ʹCreateHeadlessRenderTargetNullRenderDeviceMainͳһ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+// 򵥵ͬͬκƽ̨϶õͬУ֤Աȵļ·õȫͬ
+class RBenchmarkRandom
+{
+public:
+	RBenchmarkRandom(unsigned int u32Seed = 12345) : m_u32State(u32Seed) {};
+
+	unsigned int NextUInt()						{ m_u32State = m_u32State * 1664525 + 1013904223; return m_u32State >> 8; };
+	float NextFloat(float f32Min, float f32Max)	{ return f32Min + (f32Max - f32Min) * (NextUInt() & 0xFFFF) / 65535.0f; };
+
+private:
+	unsigned int m_u32State;
+};
+
+bool RunTransformBenchmark();		// RTransformStoreݹ³ĶԱ
+bool RunSpatialIndexBenchmark();	// ÿ֡ƶ10%ģʱռˢѯ
+bool RunSubmitBenchmark();			// ȾԪύDrawPacketύĻ
+bool RunOcclusionBenchmark();		// ڵSSE դĺʱڵԵĺʱ
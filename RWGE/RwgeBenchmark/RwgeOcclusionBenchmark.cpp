@@ -0,0 +1,140 @@
+#include "RwgeBenchmark.h"
+
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <RwgeClock.h>
+#include <RwgeOcclusionBuffer.h>
+
+using namespace std;
+
+namespace
+{
+	const unsigned int u32FrameCount = 20;
+	const unsigned int u32OccluderTriangles = 64;		// ÿڵ
+	const unsigned int u32OccludeeCount = 10000;
+
+	/*
+	ϳɳλԭ㿴+ZڵֲZ[-1, 40]СΣڵֲZ[0, 80]AABB
+	ƽཻӸռһС֣ڸǲü뱣жϵ·
+	*/
+	struct OcclusionScene
+	{
+		D3DXMATRIX				viewProj;
+		vector<float>			vecPositions;
+		vector<D3DXVECTOR3>		vecBoxMin;
+		vector<D3DXVECTOR3>		vecBoxMax;
+	};
+
+	void BuildScene(OcclusionScene& scene, unsigned int u32TriangleCount, RBenchmarkRandom& random)
+	{
+		D3DXMatrixPerspectiveFovLH(&scene.viewProj, D3DX_PI / 3.0f, 2.0f, 0.1f, 100.0f);
+
+		scene.vecPositions.reserve(u32TriangleCount * 9);
+		for (unsigned int u32Triangle = 0; u32Triangle < u32TriangleCount; ++u32Triangle)
+		{
+			D3DXVECTOR3 center(random.NextFloat(-20.0f, 20.0f), random.NextFloat(-10.0f, 10.0f), random.NextFloat(-1.0f, 40.0f));
+			for (unsigned int u32Vertex = 0; u32Vertex < 3; ++u32Vertex)
+			{
+				scene.vecPositions.push_back(center.x + random.NextFloat(-3.0f, 3.0f));
+				scene.vecPositions.push_back(center.y + random.NextFloat(-3.0f, 3.0f));
+				scene.vecPositions.push_back(center.z + random.NextFloat(-1.0f, 1.0f));
+			}
+		}
+
+		for (unsigned int u32Box = 0; u32Box < u32OccludeeCount; ++u32Box)
+		{
+			D3DXVECTOR3 center(random.NextFloat(-30.0f, 30.0f), random.NextFloat(-15.0f, 15.0f), random.NextFloat(0.0f, 80.0f));
+			D3DXVECTOR3 extents(random.NextFloat(0.1f, 2.0f), random.NextFloat(0.1f, 2.0f), random.NextFloat(0.1f, 2.0f));
+			scene.vecBoxMin.push_back(center - extents);
+			scene.vecBoxMax.push_back(center + extents);
+		}
+	}
+
+	// դu32FrameCount֡ÿ֡ƽʱ룩
+	float MeasureRasterizeMs(const OcclusionScene& scene, ROcclusionBuffer& occlusionBuffer)
+	{
+		const unsigned int u32TriangleCount = static_cast<unsigned int>(scene.vecPositions.size() / 9);
+		D3DXMATRIX world;
+		D3DXMatrixIdentity(&world);
+		RClock clock;
+
+		clock.Tick();
+		for (unsigned int u32Frame = 0; u32Frame < u32FrameCount; ++u32Frame)
+		{
+			occlusionBuffer.BeginFrame(scene.viewProj);
+			for (unsigned int u32First = 0; u32First < u32TriangleCount; u32First += u32OccluderTriangles)
+			{
+				const unsigned int u32Count = u32TriangleCount - u32First < u32OccluderTriangles ? u32TriangleCount - u32First : u32OccluderTriangles;
+				occlusionBuffer.AddOccluder(&scene.vecPositions[u32First * 9], u32Count * 3, sizeof(float) * 3, nullptr, sizeof(unsigned short), u32Count, world);
+			}
+			occlusionBuffer.Rasterize();
+		}
+
+		return clock.Tick() * 1000.0f / u32FrameCount;
+	}
+
+	// бڵu32FrameCountΣÿβԵƽʱ΢룩뱻ڵ
+	float MeasureQueryUs(const OcclusionScene& scene, const ROcclusionBuffer& occlusionBuffer, vector<unsigned char>& vecOccluded)
+	{
+		vecOccluded.assign(scene.vecBoxMin.size(), 0);
+		RClock clock;
+
+		clock.Tick();
+		for (unsigned int u32Frame = 0; u32Frame < u32FrameCount; ++u32Frame)
+		{
+			for (unsigned int u32Box = 0; u32Box < scene.vecBoxMin.size(); ++u32Box)
+			{
+				vecOccluded[u32Box] = occlusionBuffer.IsOccluded(scene.vecBoxMin[u32Box], scene.vecBoxMax[u32Box]) ? 1 : 0;
+			}
+		}
+
+		return clock.Tick() * 1000000.0f / (u32FrameCount * scene.vecBoxMin.size());
+	}
+}
+
+bool RunOcclusionBenchmark()
+{
+	static const unsigned int arrTriangleCounts[] = { 1000, 10000, 50000 };
+
+	RBenchmarkRandom random;
+	bool bPassed = true;
+
+	printf("Occlusion culling (rasterize ms per frame, query us per box, %u frames, %u boxes)\n", u32FrameCount, u32OccludeeCount);
+	printf("  %9s  %10s  %10s  %10s  %10s\n", "Triangles", "SSE", "Scalar", "Query", "Occluded");
+
+	for (unsigned int u32TriangleCount : arrTriangleCounts)
+	{
+		OcclusionScene scene;
+		BuildScene(scene, u32TriangleCount, random);
+
+		ROcclusionBuffer simdBuffer;
+		ROcclusionBuffer scalarBuffer;
+		scalarBuffer.SetSimdEnabled(false);
+
+		const float f32SimdMs = MeasureRasterizeMs(scene, simdBuffer);
+		const float f32ScalarMs = MeasureRasterizeMs(scene, scalarBuffer);
+
+		vector<unsigned char> vecSimdOccluded, vecScalarOccluded;
+		const float f32QueryUs = MeasureQueryUs(scene, simdBuffer, vecSimdOccluded);
+		MeasureQueryUs(scene, scalarBuffer, vecScalarOccluded);
+
+		// ʵֵȻֽͬڵҲͬ
+		if (memcmp(simdBuffer.GetDepthBuffer(), scalarBuffer.GetDepthBuffer(), simdBuffer.GetWidth() * simdBuffer.GetHeight() * sizeof(float)) != 0 ||
+			vecSimdOccluded != vecScalarOccluded)
+		{
+			printf("  %u triangles : SSE and scalar rasterization produced different depth buffers!\n", u32TriangleCount);
+			bPassed = false;
+		}
+
+		unsigned int u32OccludedCount = 0;
+		for (unsigned char u8Occluded : vecSimdOccluded)
+		{
+			u32OccludedCount += u8Occluded;
+		}
+
+		printf("  %9u  %10.3f  %10.3f  %10.3f  %10u\n", u32TriangleCount, f32SimdMs, f32ScalarMs, f32QueryUs, u32OccludedCount);
+	}
+
+	return bPassed;
+}
@@ -0,0 +1,183 @@
+#include "RwgeBenchmark.h"
+
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+#include <RwgeClock.h>
+#include <RwgeSceneManager.h>
+#include <RwgeSceneNode.h>
+#include <RwgeModel.h>
+#include <RwgeModelFactory.h>
+#include <RwgeTransformStore.h>
+
+using namespace std;
+
+namespace
+{
+	const unsigned int u32ModelCount = 100000;
+	const unsigned int u32FrameCount = 20;
+	const unsigned int u32QueriesPerFrame = 1000;
+	const unsigned int u32VerifiedQueryCount = 200;
+	const float f32WorldSize = 1000.0f;		// ģͷֲڱ߳Ϊ1000
+	const float f32QuerySize = 20.0f;
+
+	D3DXVECTOR3 RandomPoint(RBenchmarkRandom& random)
+	{
+		return D3DXVECTOR3(random.NextFloat(0.0f, f32WorldSize), random.NextFloat(0.0f, f32WorldSize), random.NextFloat(0.0f, f32WorldSize));
+	}
+
+	// 볡Ĳѯͬģ͵Χ
+	void BruteForceQuery(const vector<RModel*>& vecModels, const D3DXVECTOR3& minPoint, const D3DXVECTOR3& maxPoint, vector<RModel*>& vecOutModels)
+	{
+		Aabb queryAabb(minPoint, maxPoint);
+
+		for (RModel* pModel : vecModels)
+		{
+			const RBounds& bounds = pModel->GetWorldBounds();
+			if (!bounds.IsEmpty() && queryAabb.Overlaps(Aabb(bounds.center - bounds.extents, bounds.center + bounds.extents)))
+			{
+				vecOutModels.push_back(pModel);
+			}
+		}
+	}
+}
+
+bool RunSpatialIndexBenchmark()
+{
+	RTransformStore& transformStore = RTransformStore::GetInstance();
+	RBenchmarkRandom random;
+	RClock clock;
+	bool bPassed = true;
+
+	// ģ͹ͬһӵĶֻгڵȾԪǶ
+	RSceneManager* pScene = new RSceneManager();
+	RModel* pSourceModel = ModelFactory::CreateBox();
+	vector<RModel*> vecModels;
+	vecModels.reserve(u32ModelCount);
+
+	for (unsigned int u32Model = 0; u32Model < u32ModelCount; ++u32Model)
+	{
+		RModel* pModel = ModelFactory::CloneModel(pSourceModel);
+		pModel->SetPosition(RandomPoint(random));
+		pScene->GetSceneRoot()->AttachChild(pModel);
+		vecModels.push_back(pModel);
+	}
+
+	pScene->BeginFrame();
+
+	float f32TransformMs = 0.0f;
+	float f32RefitMs = 0.0f;
+	float f32QueryMs = 0.0f;
+	float f32RayCastMs = 0.0f;
+	unsigned int u32RefittedCount = 0;
+	unsigned int u32ReinsertedCount = 0;
+	unsigned int u32QueryResultCount = 0;
+	unsigned int u32RayHitCount = 0;
+	vector<unsigned int> vecMovedFrame(u32ModelCount, 0);
+	vector<RModel*> vecResults;
+
+	for (unsigned int u32Frame = 1; u32Frame <= u32FrameCount; ++u32Frame)
+	{
+		// ÿ֡ƶ10%ģͣ󲿷ֻƶһСξ룬Fat AABBڣ͵µλãҪ²
+		unsigned int u32MovedCount = 0;
+		for (unsigned int u32Move = 0; u32Move < u32ModelCount / 10; ++u32Move)
+		{
+			unsigned int u32Model = random.NextUInt() % u32ModelCount;
+			RModel* pModel = vecModels[u32Model];
+
+			if (random.NextUInt() % 10 == 0)
+			{
+				pModel->SetPosition(RandomPoint(random));
+			}
+			else
+			{
+				pModel->Translate(D3DXVECTOR3(random.NextFloat(-0.1f, 0.1f), random.NextFloat(-0.1f, 0.1f), random.NextFloat(-0.1f, 0.1f)));
+			}
+
+			if (vecMovedFrame[u32Model] != u32Frame)
+			{
+				vecMovedFrame[u32Model] = u32Frame;
+				++u32MovedCount;
+			}
+		}
+
+		// ȵ任UpdateSpatialIndexֻʣˢ¿ռĲ
+		clock.Tick();
+		transformStore.Update();
+		f32TransformMs += clock.Tick() * 1000.0f;
+
+		pScene->UpdateSpatialIndex();
+		f32RefitMs += clock.Tick() * 1000.0f;
+
+		if (pScene->GetLastRefittedProxyCount() != u32MovedCount)
+		{
+			printf("  Frame %u : %u models moved but %u proxies refitted!\n", u32Frame, u32MovedCount, pScene->GetLastRefittedProxyCount());
+			bPassed = false;
+		}
+		u32RefittedCount += pScene->GetLastRefittedProxyCount();
+		u32ReinsertedCount += pScene->GetLastReinsertedProxyCount();
+
+		clock.Tick();
+		for (unsigned int u32Query = 0; u32Query < u32QueriesPerFrame; ++u32Query)
+		{
+			D3DXVECTOR3 minPoint = RandomPoint(random);
+			D3DXVECTOR3 maxPoint = minPoint + D3DXVECTOR3(f32QuerySize, f32QuerySize, f32QuerySize);
+
+			vecResults.clear();
+			pScene->QueryModelsInAabb(minPoint, maxPoint, vecResults);
+			u32QueryResultCount += static_cast<unsigned int>(vecResults.size());
+		}
+		f32QueryMs += clock.Tick() * 1000.0f;
+
+		for (unsigned int u32Ray = 0; u32Ray < u32QueriesPerFrame; ++u32Ray)
+		{
+			D3DXVECTOR3 direction(random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f));
+			D3DXVec3Normalize(&direction, &direction);
+
+			if (pScene->RayCast(RandomPoint(random), direction, 200.0f))
+			{
+				++u32RayHitCount;
+			}
+		}
+		f32RayCastMs += clock.Tick() * 1000.0f;
+	}
+
+	printf("Spatial index (%u models, 10%% moved per frame, average of %u frames)\n", u32ModelCount, u32FrameCount);
+	printf("  Transform update : %8.3f ms\n", f32TransformMs / u32FrameCount);
+	printf("  Refit            : %8.3f ms  (%u refitted, %u reinserted per frame)\n", f32RefitMs / u32FrameCount, u32RefittedCount / u32FrameCount, u32ReinsertedCount / u32FrameCount);
+	printf("  %u AABB queries : %8.3f ms  (%.1f models per query)\n", u32QueriesPerFrame, f32QueryMs / u32FrameCount, static_cast<float>(u32QueryResultCount) / (u32QueriesPerFrame * u32FrameCount));
+	printf("  %u ray casts    : %8.3f ms  (%.1f%% hit)\n", u32QueriesPerFrame, f32RayCastMs / u32FrameCount, 100.0f * u32RayHitCount / (u32QueriesPerFrame * u32FrameCount));
+
+	// ˢ֮ռĲѯģ͵Ľȫͬ
+	vector<RModel*> vecExpected;
+	for (unsigned int u32Query = 0; u32Query < u32VerifiedQueryCount; ++u32Query)
+	{
+		D3DXVECTOR3 minPoint = RandomPoint(random);
+		D3DXVECTOR3 maxPoint = minPoint + D3DXVECTOR3(f32QuerySize, f32QuerySize, f32QuerySize);
+
+		vecResults.clear();
+		vecExpected.clear();
+		pScene->QueryModelsInAabb(minPoint, maxPoint, vecResults);
+		BruteForceQuery(vecModels, minPoint, maxPoint, vecExpected);
+
+		sort(vecResults.begin(), vecResults.end());
+		sort(vecExpected.begin(), vecExpected.end());
+		if (vecResults != vecExpected)
+		{
+			printf("  AABB query %u returned %u models, expected %u!\n", u32Query, static_cast<unsigned int>(vecResults.size()), static_cast<unsigned int>(vecExpected.size()));
+			bPassed = false;
+			break;
+		}
+	}
+
+	// ͷŸڵ㣬ģһԽ󶨣ӸڵӽڵƳ
+	delete pScene->GetSceneRoot();
+	for (RModel* pModel : vecModels)
+	{
+		delete pModel;
+	}
+	delete pSourceModel;
+	delete pScene;
+
+	return bPassed;
+}
@@ -0,0 +1,307 @@
+#include "RwgeBenchmark.h"
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <RwgeClock.h>
+#include <RwgeRenderUnit.h>
+#include <RwgeVertexStream.h>
+#include <RwgeIndexStream.h>
+#include <RwgeCommandBuffer.h>
+#include <RwgeRenderDevice.h>
+#include <RwgeD3d9VertexDeclaration.h>
+#include <RwgeVertexDeclarationManager.h>
+
+using namespace std;
+
+namespace
+{
+	const unsigned int u32FrameCount = 20;
+	const unsigned int u32VertexCount = 24;
+	const unsigned int u32IndexCount = 36;
+
+	/*
+	DrawPacket֮ǰRenderSystemύȾԪ·ǰ󶨵״̬Ϊָ룬
+	ÿλƶҪȾԪÿVertexStreamٷIndexStream붥
+	ӹӷ֮󣬰IndexStreamָȽϻΪÿȾԪظͬһ壬DrawPacket·
+	Ƚϣֻڻıʱã·ȫͬ
+	*/
+	class RenderUnitSubmitter
+	{
+	public:
+		RenderUnitSubmitter() : m_pVertexDeclaration(nullptr), m_pIndexStream(nullptr) {};
+
+		void SubmitRenderUnit(RCommandBuffer& commandBuffer, const RRenderUnit& renderUnit)
+		{
+			if (m_pVertexDeclaration != renderUnit.GetVertexDeclaration())
+			{
+				commandBuffer.SetVertexDeclaration(renderUnit.GetVertexDeclaration()->GetD3dVertexDeclaration());
+				m_pVertexDeclaration = renderUnit.GetVertexDeclaration();
+			}
+
+			const vector<VertexStream*>& vecVertexStreams = renderUnit.GetVertexStreams();
+			for (unsigned int i = vecVertexStreams.size(); i < m_vecVertexStreams.size(); ++i)
+			{
+				commandBuffer.SetStreamSource(i, nullptr, 0, 0);
+			}
+			m_vecVertexStreams.resize(vecVertexStreams.size(), nullptr);
+
+			for (unsigned int i = 0; i < vecVertexStreams.size(); ++i)
+			{
+				const VertexStream* pVertexStream = vecVertexStreams[i];
+				if (m_vecVertexStreams[i] != pVertexStream)
+				{
+					commandBuffer.SetStreamSource(i, pVertexStream->pD3dVertexBuffer, pVertexStream->u32StreamOffset, pVertexStream->u8VertexSize);
+					m_vecVertexStreams[i] = pVertexStream;
+				}
+			}
+
+			const IndexStream* pIndexStream = renderUnit.GetIndexStream();
+			if (m_pIndexStream != pIndexStream)
+			{
+				commandBuffer.SetIndices(pIndexStream->pD3dIndexBuffer, pIndexStream->u8IndexSize == IndexStream::u8Index32Size ? D3DFMT_INDEX32 : D3DFMT_INDEX16);
+				m_pIndexStream = pIndexStream;
+			}
+
+			commandBuffer.DrawIndexedPrimitive(
+				renderUnit.GetPrimitiveType(),
+				renderUnit.GetBaseVertexIndex(),
+				0,
+				renderUnit.GetVertexCount(),
+				renderUnit.GetStartIndex() + pIndexStream->u32StreamOffset / pIndexStream->u8IndexSize,
+				renderUnit.GetPrimitveCount());
+		}
+
+	private:
+		const RD3d9VertexDeclaration*	m_pVertexDeclaration;
+		vector<const VertexStream*>		m_vecVertexStreams;
+		const IndexStream*				m_pIndexStream;
+	};
+
+	// RD3d9RenderSystem::SubmitDrawPacketSubmitDraw¼ļֻͬȡDrawPacketĸ
+	class DrawPacketSubmitter
+	{
+	public:
+		void SubmitDrawPacket(RCommandBuffer& commandBuffer, const DrawPacket& drawPacket)
+		{
+			if (m_ActivedDrawPacket.pD3dVertexDeclaration != drawPacket.pD3dVertexDeclaration)
+			{
+				commandBuffer.SetVertexDeclaration(drawPacket.pD3dVertexDeclaration);
+				m_ActivedDrawPacket.pD3dVertexDeclaration = drawPacket.pD3dVertexDeclaration;
+			}
+
+			for (unsigned char i = drawPacket.u8StreamCount; i < m_ActivedDrawPacket.u8StreamCount; ++i)
+			{
+				commandBuffer.SetStreamSource(i, nullptr, 0, 0);
+				m_ActivedDrawPacket.aryVertexBuffers[i] = nullptr;
+				m_ActivedDrawPacket.aryStreamOffsets[i] = 0;
+				m_ActivedDrawPacket.aryStreamStrides[i] = 0;
+			}
+
+			for (unsigned char i = 0; i < drawPacket.u8StreamCount; ++i)
+			{
+				if (m_ActivedDrawPacket.aryVertexBuffers[i] != drawPacket.aryVertexBuffers[i] ||
+					m_ActivedDrawPacket.aryStreamOffsets[i] != drawPacket.aryStreamOffsets[i] ||
+					m_ActivedDrawPacket.aryStreamStrides[i] != drawPacket.aryStreamStrides[i])
+				{
+					commandBuffer.SetStreamSource(i, drawPacket.aryVertexBuffers[i], drawPacket.aryStreamOffsets[i], drawPacket.aryStreamStrides[i]);
+					m_ActivedDrawPacket.aryVertexBuffers[i] = drawPacket.aryVertexBuffers[i];
+					m_ActivedDrawPacket.aryStreamOffsets[i] = drawPacket.aryStreamOffsets[i];
+					m_ActivedDrawPacket.aryStreamStrides[i] = drawPacket.aryStreamStrides[i];
+				}
+			}
+			m_ActivedDrawPacket.u8StreamCount = drawPacket.u8StreamCount;
+
+			if (m_ActivedDrawPacket.pD3dIndexBuffer != drawPacket.pD3dIndexBuffer)
+			{
+				commandBuffer.SetIndices(drawPacket.pD3dIndexBuffer, drawPacket.GetIndexFormat());
+				m_ActivedDrawPacket.pD3dIndexBuffer = drawPacket.pD3dIndexBuffer;
+			}
+
+			commandBuffer.DrawIndexedPrimitive(
+				drawPacket.GetPrimitiveType(),
+				drawPacket.u32BaseVertexIndex,
+				0,
+				drawPacket.u32VertexCount,
+				drawPacket.u32StartIndex,
+				drawPacket.u32PrimitiveCount);
+		}
+
+	private:
+		DrawPacket m_ActivedDrawPacket;
+	};
+
+	struct SubmitScene
+	{
+		vector<RRenderUnit*>	vecRenderUnits;
+		vector<DrawPacket>		vecDrawPackets;		// ȾеĻһڴʱȾԪDrawPacket
+		vector<unsigned int>	vecSubmitOrder;		// ҵύ˳൱ڰɫ֮˳
+		vector<void*>			vecPadding;			// ȾԪ֮ķ䣬ʹʵһɢڶ
+	};
+
+	// һȾԪʹõĬ϶һѶλòֵУÿȾԪԼĶ
+	void BuildScene(SubmitScene& scene, unsigned int u32UnitCount, RBenchmarkRandom& random)
+	{
+		static unsigned char aryVertices[u32VertexCount * 64] = { 0 };
+		static unsigned short aryIndices[u32IndexCount] = { 0 };
+
+		RVertexDeclarationManager& declarationManager = RVertexDeclarationManager::GetInstance();
+		RD3d9VertexDeclaration* aryDeclarations[2] = { declarationManager.GetDefaultVertexDeclaration(), declarationManager.GetPositionSplitVertexDeclaration() };
+
+		for (unsigned int u32Unit = 0; u32Unit < u32UnitCount; ++u32Unit)
+		{
+			RD3d9VertexDeclaration* pDeclaration = aryDeclarations[u32Unit % 2];
+
+			RRenderUnit* pRenderUnit = new RRenderUnit();
+			pRenderUnit->SetVertexDeclaration(pDeclaration);
+			pRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
+			pRenderUnit->SetPrimitiveCount(u32IndexCount / 3);
+
+			for (unsigned char u8Stream = 0; u8Stream < pDeclaration->GetStreamCount(); ++u8Stream)
+			{
+				scene.vecPadding.push_back(malloc(32 + random.NextUInt() % 256));
+				pRenderUnit->AddVertexStream(new VertexStream(pDeclaration->GetVertexSizeOfStream(u8Stream), u32VertexCount, aryVertices));
+			}
+			pRenderUnit->SetIndexStream(new IndexStream(u32IndexCount, aryIndices));
+			pRenderUnit->BindStreamToBuffer();
+
+			scene.vecPadding.push_back(malloc(64 + random.NextUInt() % 512));
+			scene.vecRenderUnits.push_back(pRenderUnit);
+			scene.vecDrawPackets.push_back(pRenderUnit->GetDrawPacket());
+			scene.vecSubmitOrder.push_back(u32Unit);
+		}
+
+		for (unsigned int i = u32UnitCount - 1; i > 0; --i)
+		{
+			swap(scene.vecSubmitOrder[i], scene.vecSubmitOrder[random.NextUInt() % (i + 1)]);
+		}
+	}
+
+	void ReleaseScene(SubmitScene& scene)
+	{
+		for (RRenderUnit* pRenderUnit : scene.vecRenderUnits)
+		{
+			vector<VertexStream*> vecVertexStreams = pRenderUnit->GetVertexStreams();
+			const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+
+			delete pRenderUnit;
+			for (VertexStream* pVertexStream : vecVertexStreams)
+			{
+				delete pVertexStream;
+			}
+			delete pIndexStream;
+		}
+
+		for (void* pPadding : scene.vecPadding)
+		{
+			free(pPadding);
+		}
+	}
+
+	void RecordRenderUnits(const SubmitScene& scene, RCommandBuffer& commandBuffer)
+	{
+		RenderUnitSubmitter submitter;
+		for (unsigned int u32Unit : scene.vecSubmitOrder)
+		{
+			submitter.SubmitRenderUnit(commandBuffer, *scene.vecRenderUnits[u32Unit]);
+		}
+	}
+
+	void RecordDrawPackets(const SubmitScene& scene, RCommandBuffer& commandBuffer)
+	{
+		DrawPacketSubmitter submitter;
+		for (unsigned int u32Unit : scene.vecSubmitOrder)
+		{
+			submitter.SubmitDrawPacket(commandBuffer, scene.vecDrawPackets[u32Unit]);
+		}
+	}
+
+	// SetIndicesDrawPacket·ࣩ֮⣬·¼ÿͬ
+	bool VerifyCommands(const SubmitScene& scene)
+	{
+		RCommandBuffer renderUnitCommands;
+		RCommandBuffer drawPacketCommands;
+		RecordRenderUnits(scene, renderUnitCommands);
+		RecordDrawPackets(scene, drawPacketCommands);
+
+		bool bSame = drawPacketCommands.GetCommandCount(ERC_DrawIndexedPrimitive) == scene.vecSubmitOrder.size();
+		for (unsigned int u32Command = 0; u32Command < ERenderCommand_MAX; ++u32Command)
+		{
+			ERenderCommand command = static_cast<ERenderCommand>(u32Command);
+			if (command == ERC_SetIndices)
+			{
+				bSame = bSame && drawPacketCommands.GetCommandCount(command) <= renderUnitCommands.GetCommandCount(command);
+			}
+			else
+			{
+				bSame = bSame && drawPacketCommands.GetCommandCount(command) == renderUnitCommands.GetCommandCount(command);
+			}
+		}
+
+		if (!bSame)
+		{
+			printf("  %u units : render unit and draw packet paths recorded different commands!\n", static_cast<unsigned int>(scene.vecRenderUnits.size()));
+		}
+
+		return bSame;
+	}
+
+	// ÿĻƴbExecuteΪtrueʱÿ֡¼֮NullRenderDeviceִ
+	float MeasureDrawsPerMs(const SubmitScene& scene, bool bDrawPackets, bool bExecute)
+	{
+		RRenderDevice& renderDevice = RRenderDevice::GetInstance();
+		RCommandBuffer commandBuffer;
+		RClock clock;
+
+		clock.Tick();
+		for (unsigned int u32Frame = 0; u32Frame < u32FrameCount; ++u32Frame)
+		{
+			commandBuffer.Reset();
+			if (bDrawPackets)
+			{
+				RecordDrawPackets(scene, commandBuffer);
+			}
+			else
+			{
+				RecordRenderUnits(scene, commandBuffer);
+			}
+
+			if (bExecute)
+			{
+				commandBuffer.Execute(renderDevice);
+			}
+		}
+
+		return scene.vecSubmitOrder.size() * u32FrameCount / (clock.Tick() * 1000.0f);
+	}
+}
+
+bool RunSubmitBenchmark()
+{
+	static const unsigned int arrUnitCounts[] = { 1000, 10000, 100000 };
+
+	RBenchmarkRandom random;
+	bool bPassed = true;
+
+	printf("Draw submission (draws per ms, %u frames, shuffled order)\n", u32FrameCount);
+	printf("  %8s  %14s  %14s  %16s  %16s\n", "Units", "Unit record", "Packet record", "Unit + execute", "Packet + execute");
+
+	for (unsigned int u32UnitCount : arrUnitCounts)
+	{
+		SubmitScene scene;
+		BuildScene(scene, u32UnitCount, random);
+
+		bPassed = VerifyCommands(scene) && bPassed;
+
+		const float f32UnitRecord = MeasureDrawsPerMs(scene, false, false);
+		const float f32PacketRecord = MeasureDrawsPerMs(scene, true, false);
+		const float f32UnitExecute = MeasureDrawsPerMs(scene, false, true);
+		const float f32PacketExecute = MeasureDrawsPerMs(scene, true, true);
+
+		printf("  %8u  %14.0f  %14.0f  %16.0f  %16.0f\n", u32UnitCount, f32UnitRecord, f32PacketRecord, f32UnitExecute, f32PacketExecute);
+
+		ReleaseScene(scene);
+	}
+
+	return bPassed;
+}
@@ -0,0 +1,328 @@
+#include "RwgeBenchmark.h"
+
+#include <list>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <RwgeClock.h>
+#include <RwgeMath.h>
+#include <RwgeSceneNode.h>
+#include <RwgeTransformStore.h>
+
+using namespace std;
+using namespace RwgeMath;
+
+namespace
+{
+	const unsigned int u32BonesPerCharacter = 32;		// ÿɫһ32ڵĶɣɫڵڳڵ
+	const unsigned int u32FrameCount = 20;
+
+	/*
+	RTransformStore֮ǰRSceneNodeĵݹ·ֻ任صĲ֣
+	ڵ㷢任ʱظڵϵǼǴµӽڵ㣬ʱӸڵݹ飬任ĽڵᱻǿƸ¡
+	ԭʵ任ڲѯʱżģȾÿ֡ѯпɼģͣڸʱֱӼ
+	*/
+	class RecursiveNode
+	{
+	public:
+		RecursiveNode() :
+			m_Position		(0.0f, 0.0f, 0.0f),
+			m_Orientation	(0.0f, 0.0f, 0.0f, 1.0f),
+			m_Scale			(1.0f, 1.0f, 1.0f),
+			m_pParent		(nullptr),
+			m_bWorldTransformChanged(true),
+			m_bParentHasNotified	(false),
+			m_bNeedAllChildrenUpdate(true)
+		{
+
+		}
+
+		void AttachChild(RecursiveNode* pNode)
+		{
+			pNode->m_pParent = this;
+			m_listChildren.push_back(pNode);
+		}
+
+		void SetPosition(const D3DXVECTOR3& position)		{ m_Position = position; NeedUpdate(); };
+		void SetOrientation(const RQuaternion& orientation)	{ m_Orientation = orientation; NeedUpdate(); };
+		void SetScale(const D3DXVECTOR3& scale)				{ m_Scale = scale; NeedUpdate(); };
+
+		const D3DXMATRIX& GetWorldTransform() const { return m_WorldTransform; };
+
+		void UpdateSelfAndAllChildren(bool bForceUpdate = false)
+		{
+			if (bForceUpdate)
+			{
+				UpdateWorldTransform();
+
+				m_bNeedAllChildrenUpdate = true;
+				m_listChildrenToUpdate.clear();
+			}
+			else if (m_bWorldTransformChanged)
+			{
+				UpdateWorldTransform();
+			}
+
+			if (m_bNeedAllChildrenUpdate)
+			{
+				for (auto pChild : m_listChildren)
+				{
+					pChild->UpdateSelfAndAllChildren(true);
+				}
+
+				m_bNeedAllChildrenUpdate = false;
+			}
+			else
+			{
+				for (auto pChild : m_listChildrenToUpdate)
+				{
+					pChild->UpdateSelfAndAllChildren(true);
+				}
+
+				m_listChildrenToUpdate.clear();
+			}
+		}
+
+	private:
+		void NeedUpdate()
+		{
+			m_bWorldTransformChanged = true;
+
+			NotifyParentToUpdate();
+			m_bNeedAllChildrenUpdate = true;
+			m_listChildrenToUpdate.clear();
+		}
+
+		void NotifyParentToUpdate()
+		{
+			if (m_pParent && !m_bParentHasNotified)
+			{
+				if (!m_pParent->m_bNeedAllChildrenUpdate)
+				{
+					m_pParent->m_listChildrenToUpdate.push_back(this);
+					m_pParent->NotifyParentToUpdate();
+				}
+
+				m_bParentHasNotified = true;
+			}
+		}
+
+		// RTransformStore::ComputeWorldļ˳򱣳һ£·ĽӦλͬ
+		void UpdateWorldTransform()
+		{
+			if (m_pParent)
+			{
+				m_WorldPosition = m_pParent->m_WorldOrientation.RotateVector(m_pParent->m_WorldScale * m_Position) + m_pParent->m_WorldPosition;
+				m_WorldOrientation = m_pParent->m_WorldOrientation * m_Orientation;
+				m_WorldScale = m_pParent->m_WorldScale * m_Scale;
+			}
+			else
+			{
+				m_WorldPosition = m_Position;
+				m_WorldOrientation = m_Orientation;
+				m_WorldScale = m_Scale;
+			}
+
+			RSceneNode::SetTransform(m_WorldTransform, m_WorldPosition, m_WorldOrientation, m_WorldScale);
+
+			m_bWorldTransformChanged = false;
+			m_bParentHasNotified = false;
+		}
+
+	private:
+		D3DXVECTOR3 m_Position;
+		RQuaternion m_Orientation;
+		D3DXVECTOR3 m_Scale;
+		D3DXVECTOR3 m_WorldPosition;
+		RQuaternion m_WorldOrientation;
+		D3DXVECTOR3 m_WorldScale;
+		D3DXMATRIX m_WorldTransform;
+
+		RecursiveNode* m_pParent;
+		std::list<RecursiveNode*> m_listChildren;
+		std::list<RecursiveNode*> m_listChildrenToUpdate;
+
+		bool m_bWorldTransformChanged;
+		bool m_bParentHasNotified;
+		bool m_bNeedAllChildrenUpdate;
+	};
+
+	// ͬһóֱַʽʾڵiһһӦ
+	struct BenchmarkScene
+	{
+		vector<RecursiveNode> vecRecursiveNodes;
+		vector<unsigned int> vecHandles;
+	};
+
+	unsigned int GetParentOf(unsigned int u32Node)
+	{
+		unsigned int u32Bone = (u32Node - 1) % u32BonesPerCharacter;
+		unsigned int u32CharacterRoot = u32Node - u32Bone;
+
+		return u32Bone == 0 ? 0 : u32CharacterRoot + (u32Bone - 1) / 2;
+	}
+
+	void BuildScene(BenchmarkScene& scene, unsigned int u32NodeCount)
+	{
+		RTransformStore& transformStore = RTransformStore::GetInstance();
+		RBenchmarkRandom random;
+
+		scene.vecRecursiveNodes.clear();
+		scene.vecRecursiveNodes.resize(u32NodeCount);
+		scene.vecHandles.resize(u32NodeCount);
+
+		for (unsigned int u32Node = 0; u32Node < u32NodeCount; ++u32Node)
+		{
+			D3DXVECTOR3 position(random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f));
+			D3DXVECTOR3 axis(random.NextFloat(0.1f, 1.0f), random.NextFloat(0.1f, 1.0f), random.NextFloat(0.1f, 1.0f));
+			D3DXVec3Normalize(&axis, &axis);
+			RQuaternion orientation(axis, AngleRadian(random.NextFloat(-0.5f, 0.5f)));
+			D3DXVECTOR3 scale(random.NextFloat(0.9f, 1.1f), random.NextFloat(0.9f, 1.1f), random.NextFloat(0.9f, 1.1f));
+
+			RecursiveNode& node = scene.vecRecursiveNodes[u32Node];
+			unsigned int u32Handle = transformStore.CreateTransform();
+			scene.vecHandles[u32Node] = u32Handle;
+
+			if (u32Node > 0)
+			{
+				unsigned int u32Parent = GetParentOf(u32Node);
+				scene.vecRecursiveNodes[u32Parent].AttachChild(&node);
+				transformStore.SetParent(u32Handle, scene.vecHandles[u32Parent]);
+			}
+
+			node.SetPosition(position);
+			node.SetOrientation(orientation);
+			node.SetScale(scale);
+			transformStore.SetLocalPosition(u32Handle, position);
+			transformStore.SetLocalOrientation(u32Handle, orientation);
+			transformStore.SetLocalScale(u32Handle, scale);
+		}
+
+		scene.vecRecursiveNodes[0].UpdateSelfAndAllChildren(true);
+		transformStore.Update();
+	}
+
+	void ReleaseScene(BenchmarkScene& scene)
+	{
+		RTransformStore& transformStore = RTransformStore::GetInstance();
+
+		for (unsigned int u32Handle : scene.vecHandles)
+		{
+			transformStore.ReleaseTransform(u32Handle);
+		}
+
+		transformStore.Update();
+
+		scene.vecRecursiveNodes.clear();
+		scene.vecHandles.clear();
+	}
+
+	bool VerifyScene(const BenchmarkScene& scene)
+	{
+		const RTransformStore& transformStore = RTransformStore::GetInstance();
+
+		for (unsigned int u32Node = 0; u32Node < scene.vecHandles.size(); ++u32Node)
+		{
+			const D3DXMATRIX& recursiveWorld = scene.vecRecursiveNodes[u32Node].GetWorldTransform();
+			const D3DXMATRIX& storeWorld = transformStore.GetWorldTransform(scene.vecHandles[u32Node]);
+
+			if (memcmp(&recursiveWorld, &storeWorld, sizeof(D3DXMATRIX)) != 0)
+			{
+				printf("  World transform mismatch at node %u!\n", u32Node);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// ÿ֡޸һֽڵľֲ任Ȼֱʱ·ĸ£·ÿ֡ƽʱ룩
+	bool RunFrames(BenchmarkScene& scene, bool bMoveRootOnly, float& f32RecursiveMs, float& f32StoreMs)
+	{
+		RTransformStore& transformStore = RTransformStore::GetInstance();
+		const unsigned int u32NodeCount = static_cast<unsigned int>(scene.vecHandles.size());
+		RBenchmarkRandom random;
+		RClock clock;
+
+		f32RecursiveMs = 0.0f;
+		f32StoreMs = 0.0f;
+
+		for (unsigned int u32Frame = 0; u32Frame < u32FrameCount; ++u32Frame)
+		{
+			if (bMoveRootOnly)
+			{
+				// ƶڵ㣬нڵ任Ҫ¼
+				D3DXVECTOR3 position(0.01f * u32Frame, 0.0f, 0.0f);
+				scene.vecRecursiveNodes[0].SetPosition(position);
+				transformStore.SetLocalPosition(scene.vecHandles[0], position);
+			}
+			else
+			{
+				// ת10%Ľڵ㣬ɫвֹ仯
+				for (unsigned int u32Change = 0; u32Change < u32NodeCount / 10; ++u32Change)
+				{
+					unsigned int u32Node = random.NextUInt() % u32NodeCount;
+					RQuaternion orientation(RwgeMath::Vector3UnitY, AngleRadian(random.NextFloat(-0.5f, 0.5f)));
+
+					scene.vecRecursiveNodes[u32Node].SetOrientation(orientation);
+					transformStore.SetLocalOrientation(scene.vecHandles[u32Node], orientation);
+				}
+			}
+
+			clock.Tick();
+			scene.vecRecursiveNodes[0].UpdateSelfAndAllChildren();
+			f32RecursiveMs += clock.Tick() * 1000.0f;
+
+			transformStore.Update();
+			f32StoreMs += clock.Tick() * 1000.0f;
+		}
+
+		f32RecursiveMs /= u32FrameCount;
+		f32StoreMs /= u32FrameCount;
+
+		return VerifyScene(scene);
+	}
+}
+
+bool RunTransformBenchmark()
+{
+	static const unsigned int arrNodeCounts[] = { 1000, 10000, 100000 };
+	static const char* arrScenarioNames[] = { "root moved", "10% rotated" };
+
+	RTransformStore& transformStore = RTransformStore::GetInstance();
+	bool bPassed = true;
+
+	printf("Transform update (ms per frame, average of %u frames)\n", u32FrameCount);
+	printf("  %8s  %-12s  %10s  %10s  %10s\n", "Nodes", "Scenario", "Recursive", "Serial", "Parallel");
+
+	for (unsigned int u32NodeCount : arrNodeCounts)
+	{
+		BenchmarkScene scene;
+		BuildScene(scene, u32NodeCount);
+
+		if (!VerifyScene(scene))
+		{
+			bPassed = false;
+		}
+
+		for (unsigned int u32Scenario = 0; u32Scenario < 2; ++u32Scenario)
+		{
+			float f32RecursiveMs, f32SerialMs, f32ParallelMs, f32Unused;
+
+			// ģʽ벢ģʽֱͬ֡Уݹ·ĺʱȡһֵĽ
+			transformStore.SetParallelSplitDepth(0);
+			bPassed = RunFrames(scene, u32Scenario == 0, f32RecursiveMs, f32SerialMs) && bPassed;
+
+			// ԽɫڵڵΪָȣÿɫһ
+			transformStore.SetParallelSplitDepth(1);
+			bPassed = RunFrames(scene, u32Scenario == 0, f32Unused, f32ParallelMs) && bPassed;
+
+			printf("  %8u  %-12s  %10.3f  %10.3f  %10.3f\n", u32NodeCount, arrScenarioNames[u32Scenario], f32RecursiveMs, f32SerialMs, f32ParallelMs);
+		}
+
+		transformStore.SetParallelSplitDepth(0);
+		ReleaseScene(scene);
+	}
+
+	return bPassed;
+}
@@ -5,6 +5,24 @@
 	1.	ͻ˵ѭ࣬˳ڣ߿Լ̳AppDelegateʵֶԳڵļ
 	2.	ģĳʼٹ
 	3.	򴴽ĵһڳΪPrimaryWindowһرգͻ˳
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-24
+	DESC :	ûԿʱԵRenderSystem::CreateHeadlessRenderTargetͷȾĿ꣬ͨRunFramesִй̶֡
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-27
+	DESC :	GetFrameStatisticsHistoryRenderSystem¼֡ȾͳƣԲѯΧ򱣴ΪCSVJSON
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-07
+	DESC :
+	1.	ػԣĬERP_Alwaysÿ֡Ⱦ༭ڿʹERP_OnChangeÿ֡ȻAppDelegateֻ֮
+		RenderSystem::HasFrameChangedΪtrueյ봰Ϣ̡ꡢıСػ桢ߵ
+		RequestRedrawʱȾPresent¡ȾйPresentۼGetSkippedFrameCount
+	2.	ERP_OnChange¿ǿػļʱûȾʱۻǷı䶼Ⱦһ֮֡޸ģֱ
+		޸ҪRequestRedraw
+	3.	Runһ֡ûдϢʱȴu32IdleWaitTime룬еĴڲռһCPU 
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -22,12 +40,19 @@ class RAppDelegate;
 class RInputManager;
 class RD3d9RenderSystem;
 class RAppWindow;
+class RFrameStatisticsHistory;
 
 class RApplication : 
 	public RObject,
 	public Singleton<RApplication>
 {
 public:
+	enum ERedrawPolicy
+	{
+		ERP_Always,			// ÿ֡Ⱦ
+		ERP_OnChange,		// ֻڻܷıʱȾ
+	};
+
 	class AppDelegate
 	{
 	public:
@@ -46,6 +71,7 @@ public:
 
 	static void SetDelegate(AppDelegate* pDelegate);
 	void Run();
+	void RunFrames(unsigned int u32FrameCount);			// Ϣִָ֡ͷȾĿ
 
 	HINSTANCE GetHandle() const;
 	float GetTimeSinceLastFrame() const;
@@ -56,10 +82,20 @@ public:
 	bool DestroyAppWindow(const char* pName);
 
 	float GetCurrentFPS() const;
+	const RFrameStatisticsHistory& GetFrameStatisticsHistory() const;
+	void SetFrameStatisticsWindow(unsigned int u32FrameCount);		// òͳƵ֡Ѿ¼֡
+
+	void SetRedrawPolicy(ERedrawPolicy policy);
+	ERedrawPolicy GetRedrawPolicy() const;
+	void RequestRedraw();										// һ֡ۻǷı䶼Ⱦ
+	void SetForcedRedrawInterval(float f32Interval);			// λΪ룬Ϊ0ʱǿػ
+	unsigned int GetSkippedFrameCount() const;					// ERP_OnChangeۼȾ֡
 
 private:
 	static LRESULT CALLBACK AppWndProc(HWND hWnd, UINT u32Message, WPARAM wParam, LPARAM lParam);
-	void UpdateFrame();
+	bool UpdateFrame();		// Ⱦʱfalse
+
+	static const unsigned int u32IdleWaitTime;		// һ֡ȴϢʱ䣨룩
 
 private:
 	HINSTANCE m_hInstance;
@@ -69,6 +105,12 @@ private:
 	RD3d9RenderSystem* m_pRenderSystem;
 	RInputManager* m_pInputManager;
 
+	ERedrawPolicy m_RedrawPolicy;
+	bool m_bRedrawRequested;
+	float m_f32ForcedRedrawInterval;
+	float m_f32TimeSinceRedraw;
+	unsigned int m_u32SkippedFrameCount;
+
 	std::map<std::string, RAppWindow*> m_mapAppWindows;
 };
 
@@ -15,6 +15,13 @@
 #	define FORCE_INLINE		inline
 #endif
 
+// Ŀƽ̨֧SSE ʱ㣨׶üʹSSE ʵ֣ʹñʵ
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#	define RWGE_SIMD_SSE	1
+#else
+#	define RWGE_SIMD_SSE	0
+#endif
+
 // ȻdeleteѾָǷΪ0жϣĳЩдĿԶжϵĿ
 // Ϊ˱дٶһ
 #define RwgeSafeDelete(pObject)			if (pObject) { delete (pObject); (pObject) = nullptr; }
@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	FrameRingAllocatorһ[0, u32Capacity)ĻεַΧ˳ÿ֡дݣTlsfAllocatorһֻƫƣ
+		ڴ棬ҲȾˣÿ֡꼴Ҫͷ
+	2.	ÿ֡ʱһΧֵرһ֡֡GPU ִӦΧ֮ǰһֱռķΧRetireGPU Ѿɵ
+		Χֵͷɵ֡ΧֵɵṩRenderDevice::IssueFrameFenceֻҪ
+	3.	еbDiscardʾдʱǷҪDISCARD
+		A.	ͷ֮Ŀռ㹻ʱֱӷ䣬дʱʹNOOVERWRITE
+		B.	βռ䲻ʱص0ֻҪ[0, u32Size)ѾGPU ͷţȻʹNOOVERWRITEβ뵱ǰ֡
+		C.	ֻڵǰ֡ûзʱDISCARDΪ廻һڴ棬֮ǰ֡ķΧã֡мDISCARDʹ
+			֮ǰݶ֮ĻƲɼÿ֡DISCARDһΣһһ֡ĵһη
+		D.	֡мռ䲻ʱʧܣɵ˻صʹûλ·֡ĵһηʱʣռСһ֡
+			ǰDISCARDһ֡мʧ
+	4.	ݰ룬ʹʱͨBaseVertexIndexλ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <deque>
+#include "RwgeCoreDef.h"
+#include "RwgeObject.h"
+
+struct RingAllocation
+{
+	unsigned int	u32Offset;			// 䵽ƫֽ
+	unsigned int	u32Size;			// ֽ
+	bool			bDiscard;			// дʱҪDISCARD
+
+	RingAllocation() :
+		u32Offset(0),
+		u32Size(0),
+		bDiscard(false)
+	{
+
+	}
+};
+
+class RFrameRingAllocator : public RObject
+{
+public:
+	RFrameRingAllocator(unsigned int u32Capacity);
+	~RFrameRingAllocator();
+
+	bool Allocate(unsigned int u32Size, unsigned int u32Alignment, RingAllocation& allocation);		// ռ䲻ʱfalse
+	void EndFrame(unsigned int u32Fence);						// رյǰ֮֡ķһ֡
+	void Retire(unsigned int u32CompletedFence);				// ͷΧֵu32CompletedFence֡
+
+	FORCE_INLINE unsigned int	GetCapacity()				const { return m_u32Capacity; };
+	FORCE_INLINE unsigned int	GetUsedSize()				const { return m_u32UsedSize; };			// δͷŵ֡뵱ǰֽ֡β
+	FORCE_INLINE unsigned int	GetFrameSize()				const { return m_u32FrameSize; };			// ǰֽ֡
+	FORCE_INLINE unsigned int	GetInFlightFrameCount()		const { return static_cast<unsigned int>(m_deqFrames.size()); };
+	FORCE_INLINE unsigned int	GetDiscardCount()			const { return m_u32DiscardCount; };		// ܴ
+	FORCE_INLINE unsigned int	GetFailedCount()			const { return m_u32FailedCount; };
+
+private:
+	struct InFlightFrame
+	{
+		unsigned int	u32Fence;
+		unsigned int	u32Size;			// һ֡Ľλÿʼ˳ռõֽ
+	};
+
+	void Discard();
+
+private:
+	unsigned int					m_u32Capacity;
+	unsigned int					m_u32Head;					// һηʼλ
+	unsigned int					m_u32Tail;					// һδͷŵ֡ʼλ
+	unsigned int					m_u32UsedSize;
+
+	unsigned int					m_u32FrameSize;
+	unsigned int					m_u32FrameAllocationCount;
+	unsigned int					m_u32LastFrameSize;
+	std::deque<InFlightFrame>		m_deqFrames;
+
+	unsigned int					m_u32DiscardCount;
+	unsigned int					m_u32FailedCount;
+};
@@ -0,0 +1,86 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-18
+	DESC :
+	1.	Դ64λԪִLSDÿ˰8λͰ8ˣȶ
+	2.	ǰȱһԪأͬʱͳ8ֽڵֱͼĳֽԪصֵͬһˣ˵
+		Ĵ󲿷λͬʱƶͬһȾ㼶ʵִеԶ8
+	3.	RadixSortͨgetKeyȡԪصļRadixSort64ҪԪTһΪu64SortKeyunsigned long longԱԪ
+		ᱻ帴ƣԪӦСֻ±꣩
+	4.	aryItemsaryTemp֮ظƣλһУɷֵָ
+	5.	ʱȰҪļٰҪļȶģҪҪ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <string.h>
+#include "RwgeCoreDef.h"
+
+/*
+Ԫص޷ִLSD
+@Param
+	u32KeyBytes		ЧֽӵλʼΪ8
+	getKey			unsigned long long (const T& item)Ԫصļ
+*/
+template<typename T, typename TGetKey>
+T* RadixSort(T* aryItems, T* aryTemp, unsigned int u32Count, unsigned int u32KeyBytes, TGetKey getKey)
+{
+	if (u32Count < 2)
+	{
+		return aryItems;
+	}
+
+	unsigned int aryHistograms[8][256];
+	memset(aryHistograms, 0, sizeof(aryHistograms));
+
+	for (unsigned int i = 0; i < u32Count; ++i)
+	{
+		unsigned long long u64Key = getKey(aryItems[i]);
+		for (unsigned int u32Byte = 0; u32Byte < u32KeyBytes; ++u32Byte)
+		{
+			++aryHistograms[u32Byte][(u64Key >> (u32Byte * 8)) & 0xFF];
+		}
+	}
+
+	T* pSource = aryItems;
+	T* pDest = aryTemp;
+
+	for (unsigned int u32Byte = 0; u32Byte < u32KeyBytes; ++u32Byte)
+	{
+		unsigned int u32Shift = u32Byte * 8;
+		unsigned int* aryOffsets = aryHistograms[u32Byte];
+
+		// Ԫֽϵֵͬһ˲ı˳
+		if (aryOffsets[(getKey(pSource[0]) >> u32Shift) & 0xFF] == u32Count)
+		{
+			continue;
+		}
+
+		unsigned int u32Offset = 0;
+		for (unsigned int u32Bucket = 0; u32Bucket < 256; ++u32Bucket)
+		{
+			unsigned int u32BucketCount = aryOffsets[u32Bucket];
+			aryOffsets[u32Bucket] = u32Offset;
+			u32Offset += u32BucketCount;
+		}
+
+		for (unsigned int i = 0; i < u32Count; ++i)
+		{
+			pDest[aryOffsets[(getKey(pSource[i]) >> u32Shift) & 0xFF]++] = pSource[i];
+		}
+
+		T* pSwap = pSource;
+		pSource = pDest;
+		pDest = pSwap;
+	}
+
+	return pSource;
+}
+
+// u64SortKeyԱ
+template<typename T>
+FORCE_INLINE T* RadixSort64(T* aryItems, T* aryTemp, unsigned int u32Count)
+{
+	return RadixSort(aryItems, aryTemp, u32Count, 8, [](const T& item) { return item.u64SortKey; });
+}
@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-14
+	DESC :
+	1.	̳߳״ʹʱ߳ΪCPUһParallelForִ߳ͬ
+	2.	ParallelFor[0, u32TaskCount)ַ̣߳ÿ߳ÿȡһţֱִ
+		ŷأ˵ýдݶԵ߳һǿɼ
+	3.	֮䲻ϵвٴεParallelFor
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	SetWorkerCount´ָḶ́߳Ϊ0ʱ൱ڹر̳߳أڵִ߳Уڵ
+		˵ĻҲִв·߹ر̳߳صõеĲο
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include "RwgeCoreDef.h"
+#include "RwgeObject.h"
+#include "RwgeSingleton.h"
+
+class RThreadPool :
+	public RObject,
+	public SingletonLazyMode<RThreadPool>
+{
+	friend class SingletonLazyMode<RThreadPool>;
+
+private:
+	RThreadPool();
+	~RThreadPool();
+
+public:
+	void ParallelFor(unsigned int u32TaskCount, const std::function<void(unsigned int u32TaskIndex)>& task);
+
+	void SetWorkerCount(unsigned int u32WorkerCount);		// ParallelForִڼ
+	FORCE_INLINE unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_vecWorkers.size()); };
+
+private:
+	void StopWorkers();
+	void WorkerLoop();
+	void RunTasks(const std::function<void(unsigned int)>* pTask, unsigned int u32TaskCount);		// ȡֱִȫȡ
+
+private:
+	std::vector<std::thread>	m_vecWorkers;
+
+	std::mutex					m_Mutex;
+	std::condition_variable		m_cvTaskReady;
+	std::condition_variable		m_cvTaskFinished;
+
+	const std::function<void(unsigned int)>*	m_pTask;
+	unsigned int				m_u32TaskCount;
+	std::atomic<unsigned int>	m_u32NextTask;
+	unsigned int				m_u32FinishedCount;		// ³Աm_Mutex
+	unsigned int				m_u32ActiveWorkers;		// ȡĹ߳Ϊ0ʱܿʼһParallelFor
+	unsigned int				m_u32Generation;		// ÿParallelForһڻѹ߳
+	bool						m_bQuit;
+};
@@ -0,0 +1,105 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	TlsfAllocatorһ[0, u32Capacity)ĵַΧڷƫƣκڴ棬ҲȾˣԴ滺ӷ
+		GpuMemoryManagerƫӳ䵽D3Dϣ˷Ƭ豸
+	2.	TLSFTwo-Level Segregated Fitп鰴СΪһΪСλÿһپΪ
+		16ݣλͼ¼ǿյͷŶO(1)
+		A.	ʱѴСȡڶϽٲңҵĿпһ㹻󣬶ĲзΪµĿп
+		B.	ͷʱַڵĿпϲڵĿп飬жԴпռǾ
+	3.	дСƫƶu32Alignment2ݣ룬С䵥λΪu32Alignment
+	4.	Ƭ = 1 - п / ܿдСпռһʱΪ0
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	2Aȡ֮ҲпʱٱСڵһŵµĿͬʹãͬķ
+		GpuMemoryManagerΪҳСҳԼӽռʱķʧ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include "RwgeCoreDef.h"
+#include "RwgeObject.h"
+
+struct TlsfAllocation
+{
+	unsigned int	u32Offset;			// 䵽ƫֽ
+	unsigned int	u32Size;			// ֽ
+	unsigned int	u32Block;			// ڲĿţͷʱʹ
+
+	TlsfAllocation() :
+		u32Offset(0),
+		u32Size(0),
+		u32Block(0xFFFFFFFF)
+	{
+
+	}
+
+	FORCE_INLINE bool IsValid() const { return u32Block != 0xFFFFFFFF; };
+};
+
+class RTlsfAllocator : public RObject
+{
+public:
+	RTlsfAllocator(unsigned int u32Capacity, unsigned int u32Alignment = 16);
+	~RTlsfAllocator();
+
+	bool Allocate(unsigned int u32Size, TlsfAllocation& allocation);		// ռ䲻ʱfalseallocationЧ
+	void Free(TlsfAllocation& allocation);									// ͷźallocationΪЧ
+
+	unsigned int GetLargestFreeBlock() const;
+	float GetFragmentation() const;
+
+	FORCE_INLINE unsigned int	GetCapacity()			const { return m_u32Capacity; };
+	FORCE_INLINE unsigned int	GetAlignment()			const { return m_u32Alignment; };
+	FORCE_INLINE unsigned int	GetUsedSize()			const { return m_u32UsedSize; };
+	FORCE_INLINE unsigned int	GetFreeSize()			const { return m_u32Capacity - m_u32UsedSize; };
+	FORCE_INLINE unsigned int	GetAllocationCount()	const { return m_u32AllocationCount; };
+	FORCE_INLINE unsigned int	GetFreeBlockCount()		const { return m_u32FreeBlockCount; };
+	FORCE_INLINE bool			IsEmpty()				const { return m_u32AllocationCount == 0; };
+
+private:
+	static const unsigned int	u32SecondLevelLog2	= 4;
+	static const unsigned int	u32SecondLevelCount	= 1 << u32SecondLevelLog2;
+	static const unsigned int	u32FirstLevelCount	= 32 - u32SecondLevelLog2 + 1;
+	static const unsigned int	u32NullBlock		= 0xFFFFFFFF;
+
+	// ĴСƫԶ뵥λ
+	struct Block
+	{
+		unsigned int	u32Offset;
+		unsigned int	u32Size;
+		unsigned int	u32PrevPhysical;		// ַڵǰһ
+		unsigned int	u32NextPhysical;		// ַڵĺһ
+		unsigned int	u32PrevFree;			// ͬһеǰһ
+		unsigned int	u32NextFree;
+		bool			bFree;
+	};
+
+	static void MapSize(unsigned int u32Size, unsigned int& u32FirstLevel, unsigned int& u32SecondLevel);
+	bool FindFreeList(unsigned int u32Size, unsigned int& u32FirstLevel, unsigned int& u32SecondLevel) const;	// ҿһ㹻ķǿ
+
+	unsigned int CreateBlock(unsigned int u32Offset, unsigned int u32Size);
+	void DestroyBlock(unsigned int u32Block);
+	void InsertFreeBlock(unsigned int u32Block);
+	void RemoveFreeBlock(unsigned int u32Block);
+
+private:
+	unsigned int				m_u32Capacity;
+	unsigned int				m_u32Alignment;
+	unsigned int				m_u32AlignmentLog2;
+	unsigned int				m_u32UsedSize;
+	unsigned int				m_u32AllocationCount;
+	unsigned int				m_u32FreeBlockCount;
+
+	std::vector<Block>			m_vecBlocks;
+	std::vector<unsigned int>	m_vecUnusedBlocks;			// m_vecBlocksпԸõλ
+
+	unsigned int				m_u32FirstLevelBitmap;
+	unsigned int				m_arySecondLevelBitmaps[u32FirstLevelCount];
+	unsigned int				m_aryFreeLists[u32FirstLevelCount][u32SecondLevelCount];
+};
@@ -8,10 +8,16 @@
 using namespace std;
 
 RApplication::AppDelegate* RApplication::m_pDelegate = nullptr;
+const unsigned int RApplication::u32IdleWaitTime = 15;
 
 RApplication::RApplication() :
-	m_pRenderSystem	(nullptr),
-	m_pInputManager	(nullptr)
+	m_pRenderSystem				(nullptr),
+	m_pInputManager				(nullptr),
+	m_RedrawPolicy				(ERP_Always),
+	m_bRedrawRequested			(true),
+	m_f32ForcedRedrawInterval	(0.0f),
+	m_f32TimeSinceRedraw		(0.0f),
+	m_u32SkippedFrameCount		(0)
 {
 	m_hInstance = GetModuleHandle(nullptr);
 
@@ -60,13 +66,22 @@ void RApplication::Run()
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
-		else
+		else if (!UpdateFrame())
 		{
-			UpdateFrame();
+			// ûиıʱȴµĴϢִһ֡
+			MsgWaitForMultipleObjects(0, nullptr, FALSE, u32IdleWaitTime, QS_ALLINPUT);
 		}
 	}
 }
 
+void RApplication::RunFrames(unsigned int u32FrameCount)
+{
+	for (unsigned int i = 0; i < u32FrameCount; ++i)
+	{
+		UpdateFrame();
+	}
+}
+
 HINSTANCE RApplication::GetHandle() const
 {
 	return m_hInstance;
@@ -129,12 +144,56 @@ float RApplication::GetCurrentFPS() const
 	return m_FPSController.GetCurrentFPS();
 }
 
+const RFrameStatisticsHistory& RApplication::GetFrameStatisticsHistory() const
+{
+	return m_pRenderSystem->GetFrameStatisticsHistory();
+}
+
+void RApplication::SetFrameStatisticsWindow(unsigned int u32FrameCount)
+{
+	m_pRenderSystem->GetFrameStatisticsHistory().SetWindowSize(u32FrameCount);
+}
+
+void RApplication::SetRedrawPolicy(ERedrawPolicy policy)
+{
+	m_RedrawPolicy = policy;
+	m_bRedrawRequested = true;
+}
+
+RApplication::ERedrawPolicy RApplication::GetRedrawPolicy() const
+{
+	return m_RedrawPolicy;
+}
+
+void RApplication::RequestRedraw()
+{
+	m_bRedrawRequested = true;
+}
+
+void RApplication::SetForcedRedrawInterval(float f32Interval)
+{
+	m_f32ForcedRedrawInterval = f32Interval;
+}
+
+unsigned int RApplication::GetSkippedFrameCount() const
+{
+	return m_u32SkippedFrameCount;
+}
+
 LRESULT CALLBACK RApplication::AppWndProc(HWND hWnd, UINT u32Message, WPARAM wParam, LPARAM lParam)
 {
+	// 봰״̬ĸı䶼Ӱһ֡Ļ
+	if ((u32Message >= WM_KEYFIRST && u32Message <= WM_KEYLAST) ||
+		(u32Message >= WM_MOUSEFIRST && u32Message <= WM_MOUSELAST) ||
+		u32Message == WM_SIZE || u32Message == WM_PAINT || u32Message == WM_ACTIVATE || u32Message == WM_SHOWWINDOW)
+	{
+		GetInstance().RequestRedraw();
+	}
+
 	return RInputManager::GetInstance().HandleMessage(hWnd, u32Message, wParam, lParam);
 }
 
-void RApplication::UpdateFrame()
+bool RApplication::UpdateFrame()
 {
 	m_FPSController.FrameStart();
 
@@ -142,9 +201,28 @@ void RApplication::UpdateFrame()
 
 	// ================ ¸ģ ================
 	m_pDelegate->BeforeRenderingFrame(f32DeltaTime);
-	m_pRenderSystem->RenderOneFrame(f32DeltaTime);
-	m_pDelegate->AfterRenderingFrame(f32DeltaTime);
-	m_pRenderSystem->PresentFrame();
+
+	// ߼BeforeRenderingFrame޸Ҫڱ֡Ⱦ֮ж
+	m_f32TimeSinceRedraw += f32DeltaTime;
+	const bool bRender = m_RedrawPolicy == ERP_Always || m_bRedrawRequested || m_pRenderSystem->HasFrameChanged() ||
+		(m_f32ForcedRedrawInterval > 0.0f && m_f32TimeSinceRedraw >= m_f32ForcedRedrawInterval);
+
+	if (bRender)
+	{
+		m_bRedrawRequested = false;
+		m_f32TimeSinceRedraw = 0.0f;
+
+		m_pRenderSystem->RenderOneFrame(f32DeltaTime);
+		m_pDelegate->AfterRenderingFrame(f32DeltaTime);
+		m_pRenderSystem->PresentFrame();
+	}
+	else
+	{
+		++m_u32SkippedFrameCount;
+		m_pDelegate->AfterRenderingFrame(f32DeltaTime);
+	}
 
 	m_FPSController.FrameEnd();
+
+	return bRender;
 }
\ No newline at end of file
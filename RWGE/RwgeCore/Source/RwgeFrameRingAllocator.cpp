@@ -0,0 +1,154 @@
+#include "RwgeFrameRingAllocator.h"
+
+#include <algorithm>
+#include "RwgeAssert.h"
+
+using namespace std;
+
+RFrameRingAllocator::RFrameRingAllocator(unsigned int u32Capacity) :
+	m_u32Capacity(u32Capacity),
+	m_u32Head(0),
+	m_u32Tail(0),
+	m_u32UsedSize(0),
+	m_u32FrameSize(0),
+	m_u32FrameAllocationCount(0),
+	m_u32LastFrameSize(0),
+	m_u32DiscardCount(0),
+	m_u32FailedCount(0)
+{
+
+}
+
+RFrameRingAllocator::~RFrameRingAllocator()
+{
+
+}
+
+bool RFrameRingAllocator::Allocate(unsigned int u32Size, unsigned int u32Alignment, RingAllocation& allocation)
+{
+	RwgeAssert(u32Alignment != 0);
+
+	allocation = RingAllocation();
+
+	if (u32Size == 0 || u32Size > m_u32Capacity)
+	{
+		++m_u32FailedCount;
+		return false;
+	}
+
+	// ֡ѾGPU ͷʱͷʼҪDISCARD
+	if (m_u32UsedSize == 0)
+	{
+		m_u32Head = 0;
+		m_u32Tail = 0;
+	}
+
+	// ֡ĵһηʱʣռ䲻һ֡ǰDISCARD
+	const bool bFirstAllocation = m_u32FrameAllocationCount == 0;
+	bool bDiscard = bFirstAllocation && m_u32UsedSize > 0 && m_u32Capacity - m_u32UsedSize < max(m_u32LastFrameSize, u32Size);
+
+	unsigned int u32Offset = 0;
+	unsigned int u32Consumed = 0;		// β
+	bool bFound = false;
+
+	if (!bDiscard && m_u32UsedSize < m_u32Capacity)
+	{
+		const unsigned int u32AlignedHead = (m_u32Head + u32Alignment - 1) / u32Alignment * u32Alignment;
+
+		if (m_u32Head >= m_u32Tail)
+		{
+			// зΧΪ[Head, Capacity)[0, Tail)
+			if (u32AlignedHead <= m_u32Capacity && u32Size <= m_u32Capacity - u32AlignedHead)
+			{
+				u32Offset = u32AlignedHead;
+				u32Consumed = u32AlignedHead - m_u32Head + u32Size;
+				bFound = true;
+			}
+			else if (u32Size <= m_u32Tail)
+			{
+				u32Offset = 0;
+				u32Consumed = m_u32Capacity - m_u32Head + u32Size;
+				bFound = true;
+			}
+		}
+		else
+		{
+			// зΧΪ[Head, Tail)
+			if (u32AlignedHead <= m_u32Tail && u32Size <= m_u32Tail - u32AlignedHead)
+			{
+				u32Offset = u32AlignedHead;
+				u32Consumed = u32AlignedHead - m_u32Head + u32Size;
+				bFound = true;
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		// ֡мDISCARDʹһ֮֡ǰʧЧ
+		if (!bFirstAllocation)
+		{
+			++m_u32FailedCount;
+			return false;
+		}
+
+		bDiscard = true;
+	}
+
+	if (bDiscard)
+	{
+		Discard();
+		u32Offset = 0;
+		u32Consumed = u32Size;
+	}
+
+	m_u32Head = u32Offset + u32Size;
+	m_u32UsedSize += u32Consumed;
+	m_u32FrameSize += u32Consumed;
+	++m_u32FrameAllocationCount;
+
+	allocation.u32Offset = u32Offset;
+	allocation.u32Size = u32Size;
+	allocation.bDiscard = bDiscard;
+
+	return true;
+}
+
+void RFrameRingAllocator::EndFrame(unsigned int u32Fence)
+{
+	if (m_u32FrameSize > 0)
+	{
+		InFlightFrame frame;
+		frame.u32Fence = u32Fence;
+		frame.u32Size = m_u32FrameSize;
+		m_deqFrames.push_back(frame);
+	}
+
+	m_u32LastFrameSize = m_u32FrameSize;
+	m_u32FrameSize = 0;
+	m_u32FrameAllocationCount = 0;
+}
+
+void RFrameRingAllocator::Retire(unsigned int u32CompletedFence)
+{
+	// ΧֵƣֵȽȺ
+	while (!m_deqFrames.empty() && static_cast<int>(m_deqFrames.front().u32Fence - u32CompletedFence) <= 0)
+	{
+		const InFlightFrame& frame = m_deqFrames.front();
+		m_u32Tail = (m_u32Tail + frame.u32Size) % m_u32Capacity;
+		m_u32UsedSize -= frame.u32Size;
+		m_deqFrames.pop_front();
+	}
+}
+
+void RFrameRingAllocator::Discard()
+{
+	RwgeAssert(m_u32FrameSize == 0);
+
+	// Ϊ廻һڴ棬GPU ʹõ֡ھڴУռûηΧ
+	m_deqFrames.clear();
+	m_u32Head = 0;
+	m_u32Tail = 0;
+	m_u32UsedSize = 0;
+	++m_u32DiscardCount;
+}
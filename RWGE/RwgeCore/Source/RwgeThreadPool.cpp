@@ -0,0 +1,158 @@
+#include "RwgeThreadPool.h"
+
+#include "RwgeAssert.h"
+
+using namespace std;
+
+RThreadPool::RThreadPool() :
+	m_pTask				(nullptr),
+	m_u32TaskCount		(0),
+	m_u32NextTask		(0),
+	m_u32FinishedCount	(0),
+	m_u32ActiveWorkers	(0),
+	m_u32Generation		(0),
+	m_bQuit				(false)
+{
+	unsigned int u32CoreCount = thread::hardware_concurrency();
+	SetWorkerCount(u32CoreCount > 1 ? u32CoreCount - 1 : 0);
+}
+
+RThreadPool::~RThreadPool()
+{
+	StopWorkers();
+}
+
+void RThreadPool::SetWorkerCount(unsigned int u32WorkerCount)
+{
+	RwgeAssert(m_pTask == nullptr);
+
+	StopWorkers();
+
+	m_bQuit = false;
+	for (unsigned int u32Worker = 0; u32Worker < u32WorkerCount; ++u32Worker)
+	{
+		m_vecWorkers.push_back(thread(&RThreadPool::WorkerLoop, this));
+	}
+}
+
+void RThreadPool::StopWorkers()
+{
+	{
+		lock_guard<mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+	m_cvTaskReady.notify_all();
+
+	for (auto& worker : m_vecWorkers)
+	{
+		worker.join();
+	}
+	m_vecWorkers.clear();
+}
+
+void RThreadPool::ParallelFor(unsigned int u32TaskCount, const function<void(unsigned int u32TaskIndex)>& task)
+{
+	RwgeAssert(m_pTask == nullptr);
+
+	if (u32TaskCount == 0)
+	{
+		return;
+	}
+
+	// ûйֻ̻߳һʱֱڵǰִ߳Уʡȥ߳ͬĿ
+	if (m_vecWorkers.empty() || u32TaskCount == 1)
+	{
+		for (unsigned int u32TaskIndex = 0; u32TaskIndex < u32TaskCount; ++u32TaskIndex)
+		{
+			task(u32TaskIndex);
+		}
+		return;
+	}
+
+	unique_lock<mutex> lock(m_Mutex);
+
+	// һParallelForĹܻ߳̿û˳RunTasks˳
+	m_cvTaskFinished.wait(lock, [this]() { return m_u32ActiveWorkers == 0; });
+
+	m_pTask = &task;
+	m_u32TaskCount = u32TaskCount;
+	m_u32NextTask = 0;
+	m_u32FinishedCount = 0;
+	++m_u32Generation;
+
+	lock.unlock();
+	m_cvTaskReady.notify_all();
+
+	RunTasks(&task, u32TaskCount);
+
+	// ȴִ߳ȡ
+	lock.lock();
+	m_cvTaskFinished.wait(lock, [this]() { return m_u32FinishedCount == m_u32TaskCount; });
+	m_pTask = nullptr;
+}
+
+void RThreadPool::WorkerLoop()
+{
+	// ̳߳´߳ʱѾִйParallelForֻӦ֮
+	unsigned int u32Generation;
+	{
+		lock_guard<mutex> lock(m_Mutex);
+		u32Generation = m_u32Generation;
+	}
+
+	for (;;)
+	{
+		const function<void(unsigned int)>* pTask;
+		unsigned int u32TaskCount;
+
+		{
+			unique_lock<mutex> lock(m_Mutex);
+			m_cvTaskReady.wait(lock, [&]() { return m_bQuit || m_u32Generation != u32Generation; });
+
+			if (m_bQuit)
+			{
+				return;
+			}
+
+			u32Generation = m_u32Generation;
+			pTask = m_pTask;
+			u32TaskCount = m_u32TaskCount;
+			++m_u32ActiveWorkers;
+		}
+
+		RunTasks(pTask, u32TaskCount);
+
+		{
+			lock_guard<mutex> lock(m_Mutex);
+			--m_u32ActiveWorkers;
+		}
+		m_cvTaskFinished.notify_all();
+	}
+}
+
+void RThreadPool::RunTasks(const function<void(unsigned int)>* pTask, unsigned int u32TaskCount)
+{
+	unsigned int u32Finished = 0;
+
+	for (;;)
+	{
+		// ߳ȡıһСʱpTaskѾʧЧᱻ
+		unsigned int u32TaskIndex = m_u32NextTask++;
+		if (u32TaskIndex >= u32TaskCount)
+		{
+			break;
+		}
+
+		(*pTask)(u32TaskIndex);
+		++u32Finished;
+	}
+
+	if (u32Finished > 0)
+	{
+		{
+			lock_guard<mutex> lock(m_Mutex);
+			m_u32FinishedCount += u32Finished;
+		}
+		m_cvTaskFinished.notify_all();
+	}
+}
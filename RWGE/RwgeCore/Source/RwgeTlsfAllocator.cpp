@@ -0,0 +1,347 @@
+#include "RwgeTlsfAllocator.h"
+
+#include "RwgeAssert.h"
+
+using namespace std;
+
+// λλıţu32ValueΪ0
+static unsigned int HighestBit(unsigned int u32Value)
+{
+	unsigned int u32Bit = 0;
+	if (u32Value & 0xFFFF0000) { u32Value >>= 16; u32Bit += 16; }
+	if (u32Value & 0x0000FF00) { u32Value >>= 8; u32Bit += 8; }
+	if (u32Value & 0x000000F0) { u32Value >>= 4; u32Bit += 4; }
+	if (u32Value & 0x0000000C) { u32Value >>= 2; u32Bit += 2; }
+	if (u32Value & 0x00000002) { u32Bit += 1; }
+
+	return u32Bit;
+}
+
+static unsigned int LowestBit(unsigned int u32Value)
+{
+	return HighestBit(u32Value & (~u32Value + 1));
+}
+
+RTlsfAllocator::RTlsfAllocator(unsigned int u32Capacity, unsigned int u32Alignment /* = 16 */) :
+	m_u32Alignment(u32Alignment),
+	m_u32UsedSize(0),
+	m_u32AllocationCount(0),
+	m_u32FreeBlockCount(0),
+	m_u32FirstLevelBitmap(0)
+{
+	RwgeAssert(u32Alignment != 0 && (u32Alignment & (u32Alignment - 1)) == 0);
+
+	m_u32AlignmentLog2 = HighestBit(u32Alignment);
+	m_u32Capacity = (u32Capacity >> m_u32AlignmentLog2) << m_u32AlignmentLog2;		// һ뵥λβʹ
+
+	for (unsigned int u32FirstLevel = 0; u32FirstLevel < u32FirstLevelCount; ++u32FirstLevel)
+	{
+		m_arySecondLevelBitmaps[u32FirstLevel] = 0;
+		for (unsigned int u32SecondLevel = 0; u32SecondLevel < u32SecondLevelCount; ++u32SecondLevel)
+		{
+			m_aryFreeLists[u32FirstLevel][u32SecondLevel] = u32NullBlock;
+		}
+	}
+
+	if (m_u32Capacity > 0)
+	{
+		InsertFreeBlock(CreateBlock(0, m_u32Capacity >> m_u32AlignmentLog2));
+	}
+}
+
+RTlsfAllocator::~RTlsfAllocator()
+{
+
+}
+
+bool RTlsfAllocator::Allocate(unsigned int u32Size, TlsfAllocation& allocation)
+{
+	allocation = TlsfAllocation();
+
+	if (u32Size == 0 || u32Size > m_u32Capacity - m_u32UsedSize)
+	{
+		return false;
+	}
+
+	const unsigned int u32Units = (u32Size + m_u32Alignment - 1) >> m_u32AlignmentLog2;
+
+	unsigned int u32FirstLevel, u32SecondLevel;
+	unsigned int u32Block = u32NullBlock;
+	if (FindFreeList(u32Units, u32FirstLevel, u32SecondLevel))
+	{
+		u32Block = m_aryFreeLists[u32FirstLevel][u32SecondLevel];
+	}
+	else
+	{
+		// ȡûиʱСڵԿзŵµĿ飨ҳСͬķ䣩ֻһ
+		MapSize(u32Units, u32FirstLevel, u32SecondLevel);
+		for (unsigned int u32Candidate = m_aryFreeLists[u32FirstLevel][u32SecondLevel]; u32Candidate != u32NullBlock; u32Candidate = m_vecBlocks[u32Candidate].u32NextFree)
+		{
+			if (m_vecBlocks[u32Candidate].u32Size >= u32Units)
+			{
+				u32Block = u32Candidate;
+				break;
+			}
+		}
+
+		if (u32Block == u32NullBlock)
+		{
+			return false;
+		}
+	}
+
+	RemoveFreeBlock(u32Block);
+
+	// ĲзΪµĿп飬ڷ֮
+	if (m_vecBlocks[u32Block].u32Size > u32Units)
+	{
+		const unsigned int u32Remainder = CreateBlock(m_vecBlocks[u32Block].u32Offset + u32Units, m_vecBlocks[u32Block].u32Size - u32Units);
+		Block& block = m_vecBlocks[u32Block];
+		Block& remainder = m_vecBlocks[u32Remainder];
+
+		remainder.u32PrevPhysical = u32Block;
+		remainder.u32NextPhysical = block.u32NextPhysical;
+		if (block.u32NextPhysical != u32NullBlock)
+		{
+			m_vecBlocks[block.u32NextPhysical].u32PrevPhysical = u32Remainder;
+		}
+		block.u32NextPhysical = u32Remainder;
+		block.u32Size = u32Units;
+
+		InsertFreeBlock(u32Remainder);
+	}
+
+	allocation.u32Offset = m_vecBlocks[u32Block].u32Offset << m_u32AlignmentLog2;
+	allocation.u32Size = u32Units << m_u32AlignmentLog2;
+	allocation.u32Block = u32Block;
+
+	m_u32UsedSize += allocation.u32Size;
+	++m_u32AllocationCount;
+
+	return true;
+}
+
+void RTlsfAllocator::Free(TlsfAllocation& allocation)
+{
+	if (!allocation.IsValid())
+	{
+		return;
+	}
+
+	unsigned int u32Block = allocation.u32Block;
+	RwgeAssert(u32Block < m_vecBlocks.size() && !m_vecBlocks[u32Block].bFree);
+
+	m_u32UsedSize -= m_vecBlocks[u32Block].u32Size << m_u32AlignmentLog2;
+	--m_u32AllocationCount;
+	allocation = TlsfAllocation();
+
+	// ַڵĿпϲ
+	const unsigned int u32Prev = m_vecBlocks[u32Block].u32PrevPhysical;
+	if (u32Prev != u32NullBlock && m_vecBlocks[u32Prev].bFree)
+	{
+		RemoveFreeBlock(u32Prev);
+
+		m_vecBlocks[u32Prev].u32Size += m_vecBlocks[u32Block].u32Size;
+		m_vecBlocks[u32Prev].u32NextPhysical = m_vecBlocks[u32Block].u32NextPhysical;
+		if (m_vecBlocks[u32Block].u32NextPhysical != u32NullBlock)
+		{
+			m_vecBlocks[m_vecBlocks[u32Block].u32NextPhysical].u32PrevPhysical = u32Prev;
+		}
+
+		DestroyBlock(u32Block);
+		u32Block = u32Prev;
+	}
+
+	const unsigned int u32Next = m_vecBlocks[u32Block].u32NextPhysical;
+	if (u32Next != u32NullBlock && m_vecBlocks[u32Next].bFree)
+	{
+		RemoveFreeBlock(u32Next);
+
+		m_vecBlocks[u32Block].u32Size += m_vecBlocks[u32Next].u32Size;
+		m_vecBlocks[u32Block].u32NextPhysical = m_vecBlocks[u32Next].u32NextPhysical;
+		if (m_vecBlocks[u32Next].u32NextPhysical != u32NullBlock)
+		{
+			m_vecBlocks[m_vecBlocks[u32Next].u32NextPhysical].u32PrevPhysical = u32Block;
+		}
+
+		DestroyBlock(u32Next);
+	}
+
+	InsertFreeBlock(u32Block);
+}
+
+unsigned int RTlsfAllocator::GetLargestFreeBlock() const
+{
+	if (m_u32FirstLevelBitmap == 0)
+	{
+		return 0;
+	}
+
+	// ĿпһߵķǿУͬһеĿСͬҪ
+	const unsigned int u32FirstLevel = HighestBit(m_u32FirstLevelBitmap);
+	const unsigned int u32SecondLevel = HighestBit(m_arySecondLevelBitmaps[u32FirstLevel]);
+
+	unsigned int u32Largest = 0;
+	for (unsigned int u32Block = m_aryFreeLists[u32FirstLevel][u32SecondLevel]; u32Block != u32NullBlock; u32Block = m_vecBlocks[u32Block].u32NextFree)
+	{
+		u32Largest = m_vecBlocks[u32Block].u32Size > u32Largest ? m_vecBlocks[u32Block].u32Size : u32Largest;
+	}
+
+	return u32Largest << m_u32AlignmentLog2;
+}
+
+float RTlsfAllocator::GetFragmentation() const
+{
+	const unsigned int u32FreeSize = GetFreeSize();
+	if (u32FreeSize == 0)
+	{
+		return 0.0f;
+	}
+
+	return 1.0f - static_cast<float>(GetLargestFreeBlock()) / u32FreeSize;
+}
+
+void RTlsfAllocator::MapSize(unsigned int u32Size, unsigned int& u32FirstLevel, unsigned int& u32SecondLevel)
+{
+	// СڶĴСȫ0һУÿӦһС
+	if (u32Size < u32SecondLevelCount)
+	{
+		u32FirstLevel = 0;
+		u32SecondLevel = u32Size;
+	}
+	else
+	{
+		const unsigned int u32HighestBit = HighestBit(u32Size);
+		u32FirstLevel = u32HighestBit - u32SecondLevelLog2 + 1;
+		u32SecondLevel = (u32Size >> (u32HighestBit - u32SecondLevelLog2)) - u32SecondLevelCount;
+	}
+}
+
+bool RTlsfAllocator::FindFreeList(unsigned int u32Size, unsigned int& u32FirstLevel, unsigned int& u32SecondLevel) const
+{
+	// ȡڶϽ磬֮ҵκһ鶼㹻
+	if (u32Size >= u32SecondLevelCount)
+	{
+		const unsigned int u32Round = (1 << (HighestBit(u32Size) - u32SecondLevelLog2)) - 1;
+		if (u32Size > 0xFFFFFFFF - u32Round)
+		{
+			return false;
+		}
+		u32Size += u32Round;
+	}
+
+	MapSize(u32Size, u32FirstLevel, u32SecondLevel);
+	if (u32FirstLevel >= u32FirstLevelCount)
+	{
+		return false;
+	}
+
+	unsigned int u32SecondLevelBitmap = m_arySecondLevelBitmaps[u32FirstLevel] & (0xFFFFFFFF << u32SecondLevel);
+	if (u32SecondLevelBitmap == 0)
+	{
+		const unsigned int u32FirstLevelBitmap = u32FirstLevel + 1 < 32 ? m_u32FirstLevelBitmap & (0xFFFFFFFF << (u32FirstLevel + 1)) : 0;
+		if (u32FirstLevelBitmap == 0)
+		{
+			return false;
+		}
+
+		u32FirstLevel = LowestBit(u32FirstLevelBitmap);
+		u32SecondLevelBitmap = m_arySecondLevelBitmaps[u32FirstLevel];
+	}
+
+	u32SecondLevel = LowestBit(u32SecondLevelBitmap);
+
+	return true;
+}
+
+unsigned int RTlsfAllocator::CreateBlock(unsigned int u32Offset, unsigned int u32Size)
+{
+	unsigned int u32Block;
+	if (m_vecUnusedBlocks.empty())
+	{
+		u32Block = m_vecBlocks.size();
+		m_vecBlocks.push_back(Block());
+	}
+	else
+	{
+		u32Block = m_vecUnusedBlocks.back();
+		m_vecUnusedBlocks.pop_back();
+	}
+
+	Block& block = m_vecBlocks[u32Block];
+	block.u32Offset = u32Offset;
+	block.u32Size = u32Size;
+	block.u32PrevPhysical = u32NullBlock;
+	block.u32NextPhysical = u32NullBlock;
+	block.u32PrevFree = u32NullBlock;
+	block.u32NextFree = u32NullBlock;
+	block.bFree = false;
+
+	return u32Block;
+}
+
+void RTlsfAllocator::DestroyBlock(unsigned int u32Block)
+{
+	m_vecBlocks[u32Block].bFree = false;
+	m_vecUnusedBlocks.push_back(u32Block);
+}
+
+void RTlsfAllocator::InsertFreeBlock(unsigned int u32Block)
+{
+	Block& block = m_vecBlocks[u32Block];
+
+	unsigned int u32FirstLevel, u32SecondLevel;
+	MapSize(block.u32Size, u32FirstLevel, u32SecondLevel);
+
+	unsigned int& u32Head = m_aryFreeLists[u32FirstLevel][u32SecondLevel];
+	block.u32PrevFree = u32NullBlock;
+	block.u32NextFree = u32Head;
+	if (u32Head != u32NullBlock)
+	{
+		m_vecBlocks[u32Head].u32PrevFree = u32Block;
+	}
+	u32Head = u32Block;
+	block.bFree = true;
+
+	m_u32FirstLevelBitmap |= 1 << u32FirstLevel;
+	m_arySecondLevelBitmaps[u32FirstLevel] |= 1 << u32SecondLevel;
+	++m_u32FreeBlockCount;
+}
+
+void RTlsfAllocator::RemoveFreeBlock(unsigned int u32Block)
+{
+	Block& block = m_vecBlocks[u32Block];
+	RwgeAssert(block.bFree);
+
+	unsigned int u32FirstLevel, u32SecondLevel;
+	MapSize(block.u32Size, u32FirstLevel, u32SecondLevel);
+
+	if (block.u32PrevFree != u32NullBlock)
+	{
+		m_vecBlocks[block.u32PrevFree].u32NextFree = block.u32NextFree;
+	}
+	else
+	{
+		m_aryFreeLists[u32FirstLevel][u32SecondLevel] = block.u32NextFree;
+	}
+
+	if (block.u32NextFree != u32NullBlock)
+	{
+		m_vecBlocks[block.u32NextFree].u32PrevFree = block.u32PrevFree;
+	}
+
+	block.u32PrevFree = u32NullBlock;
+	block.u32NextFree = u32NullBlock;
+	block.bFree = false;
+
+	if (m_aryFreeLists[u32FirstLevel][u32SecondLevel] == u32NullBlock)
+	{
+		m_arySecondLevelBitmaps[u32FirstLevel] &= ~(1 << u32SecondLevel);
+		if (m_arySecondLevelBitmaps[u32FirstLevel] == 0)
+		{
+			m_u32FirstLevelBitmap &= ~(1 << u32FirstLevel);
+		}
+	}
+
+	--m_u32FreeBlockCount;
+}
@@ -31,6 +31,7 @@
 
 		MSDN
 		https://msdn.microsoft.com/en-us/library/windows/desktop/bb205342(v=vs.85).aspx
+	5.	׶ڻȡʱŻ£ͼͶӰıʱ׶
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -38,6 +39,7 @@
 
 #include <d3dx9.h>
 
+#include <RwgeFrustum.h>
 #include "RwgeSceneNode.h"
 
 class RSceneManager;
@@ -55,9 +57,9 @@ public:
 
 	const D3DXMATRIX* GetViewTransform() const;
 	const D3DXMATRIX* GetProjectionTransform() const;
+	const RFrustum& GetFrustum() const;
 
 	void UpdateCachedViewTransform() const;
-	void UpdateCachedWorldTransform() const override;
 
 	void GetSceneShot(RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue);
 
@@ -70,5 +72,8 @@ private:
 	float m_f32LookNear;				// üƽ
 	float m_f32LookFar;					// Զüƽ
 
-	mutable bool m_bCacheViewTransformOutOfDate;
+	mutable unsigned int m_u32ViewTransformRevision;	// ͼʱ任İ汾
+
+	mutable RFrustum m_Frustum;
+	mutable bool m_bFrustumOutOfDate;
 };
\ No newline at end of file
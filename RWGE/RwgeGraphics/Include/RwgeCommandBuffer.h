@@ -0,0 +1,137 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-25
+	DESC :
+	1.	CommandBufferRenderSystemRenderDevice֮һȾĿꡢӿClearȾ״̬EffectĿʼ
+		DPԼÿ֡дĶ̬ݶ¼Ϊһ֮Execute
+		˳RenderDeviceִ
+	2.	ÿͷ̶ֽĲɣ뻺ݽڲ֮8ֽڶţ
+		Resetֻݶͷڴ棬ÿ֡¼ȶ¼̲ٷڴ
+	3.	бԴԴ󣬼¼ʱԴѾִǰܱͷ
+	4.	SaveToFileõľдļһγֵ˳ţͬһ֡ļȫͬ
+		ֱӱȽϣLoadFromFileȡΪÿ㻺ָRenderDeviceϴ㹻Ļ壬滻
+		Ϊܽõļپ˶ȡֻNullRenderDeviceطţ߶Աύ·Ŀ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-27
+	DESC :
+	1.	¼ʱͳÿEffectݵֽRenderSystemȽȾӿǰֵõӿڵ󶨴
+		ϴĳֽͳֻReset㣬LoadFromFileȡ¼
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	WriteVertexBufferWriteIndexBufferٸƵߵݣǷеɵֱд룬̬
+		ʵĽҪдһʱڴ棻ڼ¼һ֮ǰЧ֮·ڴ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	SetIndicesͬʱ¼ĸʽļľÿ屣ĸʽļ汾2LoadFromFileͬ
+		ĸʽ´壬32λطʱٱ16λֻдûбSetIndicesʹõ
+		D3DFMT_INDEX16
+	2.	LoadFromFileȡֽ밴8ֽڶ롢СڸĲṹ壬Effect뻺д븽
+		ݲܳ뻺Сʹһ£ļͷ𻵵ļ
+		ܾأطʱԽд
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+class RRenderDevice;
+
+enum ERenderCommand
+{
+	ERC_BeginScene,
+	ERC_EndScene,
+	ERC_SetRenderTarget,
+	ERC_SetViewport,
+	ERC_Clear,
+	ERC_SetRenderState,
+	ERC_BeginEffect,
+	ERC_EndEffect,
+	ERC_CommitEffectChanges,
+	ERC_SetEffectValue,
+	ERC_SetEffectRawValue,
+	ERC_SetEffectTexture,
+	ERC_SetVertexDeclaration,
+	ERC_SetStreamSource,
+	ERC_SetStreamSourceFreq,
+	ERC_SetIndices,
+	ERC_DrawIndexedPrimitive,
+	ERC_WriteVertexBuffer,
+	ERC_WriteIndexBuffer,
+
+	ERenderCommand_MAX
+};
+
+class RCommandBuffer : public RObject
+{
+public:
+	RCommandBuffer();
+	~RCommandBuffer();
+
+	void Reset();										// Ѿڴ
+
+	FORCE_INLINE unsigned int GetCommandCount()	const	{ return m_u32CommandCount; };
+	FORCE_INLINE unsigned int GetDataSize()		const	{ return static_cast<unsigned int>(m_vecData.size()); };	// ֽ
+	FORCE_INLINE unsigned int GetCommandCount(ERenderCommand command) const { return m_aryCommandCounts[command]; };
+	FORCE_INLINE unsigned int GetEffectDataSize()	const	{ return m_u32EffectDataSize; };		// SetEffectValueSetEffectRawValueֽ
+
+	static const char* GetCommandName(ERenderCommand command);
+
+	// ================================ ¼ ================================
+	void BeginScene();
+	void EndScene();
+	void SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface);
+	void SetViewport(const D3DVIEWPORT9* pViewport);
+	void Clear(const D3DRECT* pRect, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil);	// pRectΪʱClearȾĿ
+	void SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value);
+
+	void BeginEffect(ID3DXEffect* pEffect);
+	void EndEffect(ID3DXEffect* pEffect);
+	void CommitEffectChanges(ID3DXEffect* pEffect);
+	void SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size);
+	void SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size);
+	void SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture);
+
+	void SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration);
+	void SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride);
+	void SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting);
+	void SetIndices(IDirect3DIndexBuffer9* pIndexBuffer, D3DFORMAT format);		// formatΪʱĸʽļʱʹ
+	void DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount);
+
+	// u32Sizeֽڵֻд߱ڼ¼һ֮ǰд룬ִʱu32LockFlags岢
+	void* WriteVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, unsigned long u32LockFlags);
+	void* WriteIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, unsigned long u32LockFlags);
+
+	// ================================ ִл ================================
+	void Execute(RRenderDevice& device, unsigned int u32BeginOffset = 0) const;		// ִдu32BeginOffsetʼ״̬þ豸DeviceStateShadow
+
+	bool SaveToFile(const TCHAR* szPath) const;
+	bool LoadFromFile(const TCHAR* szPath, RRenderDevice& device);
+
+	FORCE_INLINE const std::vector<IDirect3DIndexBuffer9*>& GetLoadedIndexBuffers() const { return m_vecLoadedIndexBuffers; };	// ŵ˳
+
+private:
+	template<typename T> T* AllocateCommand(ERenderCommand command, unsigned int u32PayloadSize = 0);
+	void ReleaseLoadedResources();
+
+	static const unsigned int	u32CommandAlignment;
+
+private:
+	std::vector<unsigned char>				m_vecData;
+	unsigned int							m_u32CommandCount;
+	unsigned int							m_aryCommandCounts[ERenderCommand_MAX];
+	unsigned int							m_u32EffectDataSize;
+
+	// LoadFromFileĻ
+	RRenderDevice*							m_pLoadedDevice;
+	std::vector<IDirect3DVertexBuffer9*>	m_vecLoadedVertexBuffers;
+	std::vector<IDirect3DIndexBuffer9*>		m_vecLoadedIndexBuffers;
+};
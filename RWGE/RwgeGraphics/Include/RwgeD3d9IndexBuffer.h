@@ -4,6 +4,21 @@
 	DESC :	
 	1.	壬Դ洫
 	2.	ͨ²ᾭı䣬POOLΪDefault ģʽЧ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	붥㻺ͬԴΪ̬壬дָƫƣRwgeGpuMemoryManager.h
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	붥㻺ͬWriteDataеֻдRwgeDynamicUploader.h
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-04
+	DESC :
+	1.	ʱָȣD3DFMT_INDEX16D3DFMT_INDEX32һֻܴͬһȵ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -14,21 +29,27 @@
 
 struct IndexStream;
 class RD3d9Device;
+class RCommandBuffer;
 struct IDirect3DDevice9;
 struct IDirect3DIndexBuffer9;
 
 class RD3d9IndexBuffer : public RObject
 {
 public:
-	RD3d9IndexBuffer(unsigned int u32BufferSize /*ֽ*/);
+	RD3d9IndexBuffer(unsigned int u32BufferSize /*ֽ*/, bool bDynamic = true, unsigned char u8IndexSize = 2 /*IndexStream::u8Index16Size*/);
 	~RD3d9IndexBuffer();
 
 	FORCE_INLINE IDirect3DIndexBuffer9* GetD3dIndexBuffer() const { return m_pD3dIndexBuffer; };
-	bool BindIndexStream(IndexStream* pIndexStream) const;
+	bool BindIndexStream(IndexStream* pIndexStream, unsigned int u32Offset = 0) const;
+	void* WriteData(RCommandBuffer& commandBuffer, unsigned int u32Offset, unsigned int u32Size, bool bDiscard);	// ÿ֡дݣеԽʱnullptrbDiscardΪfalseʱԲǷʽд
+
+	FORCE_INLINE unsigned int GetBufferSize() const { return m_u32BufferSize; };
+	FORCE_INLINE unsigned char GetIndexSize() const { return m_u8IndexSize; };
 
 private:
 	IDirect3DIndexBuffer9*	m_pD3dIndexBuffer;
 
 	unsigned int			m_u32BufferSize;
+	unsigned char			m_u8IndexSize;
 };
 
@@ -0,0 +1,94 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-24
+	DESC :	RenderDeviceD3D9 ʵ֣еתD3D9 Deviceg_pD3d9DeviceԴD3DX
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-26
+	DESC :
+	1.	EffectʱΪ״̬Effect豸״̬ãȾ״̬״̬ɫ볣Ĵ
+		ȾDeviceStateShadowĹ
+	2.	BeginEffectʹD3DXFX_DONOTSAVESTATEEffectBeginʱ桢Endʱָ豸״ָ̬״̬ƹ״̬
+		ʹӰ豸һ£ÿPassʹõȾ״ָ̬ҲǶĿ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	֡ΧʹD3DQUERYTYPE_EVENTѯʵ֣ѯѭʹãѯʧʱٶGPU u32MaxFrameLatency֡
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "RwgeRenderDevice.h"
+
+class RD3d9RenderDevice : public RRenderDevice
+{
+public:
+	RD3d9RenderDevice();
+	virtual ~RD3d9RenderDevice();
+
+	virtual HRESULT CreateVertexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DPOOL pool, IDirect3DVertexBuffer9** ppVertexBuffer) override;
+	virtual HRESULT LockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) override;
+	virtual HRESULT UnlockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) override;
+	virtual void ReleaseVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) override;
+
+	virtual HRESULT CreateIndexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9** ppIndexBuffer) override;
+	virtual HRESULT LockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) override;
+	virtual HRESULT UnlockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) override;
+	virtual void ReleaseIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) override;
+
+	virtual HRESULT CreateVertexDeclaration(const D3DVERTEXELEMENT9* aryVertexElements, IDirect3DVertexDeclaration9** ppVertexDeclaration) override;
+	virtual void ReleaseVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) override;
+
+	virtual HRESULT CreateTextureFromFile(const TCHAR* szPath, IDirect3DTexture9** ppTexture) override;
+	virtual void ReleaseTexture(IDirect3DTexture9* pTexture) override;
+
+	virtual HRESULT CreateEffectPool(ID3DXEffectPool** ppEffectPool) override;
+	virtual void ReleaseEffectPool(ID3DXEffectPool* pEffectPool) override;
+	virtual HRESULT CreateEffectFromFile(const TCHAR* szPath, ID3DXEffectPool* pEffectPool, ID3DXEffect** ppEffect, ID3DXBuffer** ppErrorBuffer) override;
+	virtual void ReleaseEffect(ID3DXEffect* pEffect) override;
+
+	virtual D3DXHANDLE GetEffectParameterByName(ID3DXEffect* pEffect, const char* szName) override;
+	virtual D3DXHANDLE GetEffectTechniqueByName(ID3DXEffect* pEffect, const char* szName) override;
+	virtual HRESULT BeginEffect(ID3DXEffect* pEffect) override;
+	virtual HRESULT EndEffect(ID3DXEffect* pEffect) override;
+	virtual HRESULT CommitEffectChanges(ID3DXEffect* pEffect) override;
+	virtual HRESULT SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size) override;
+	virtual HRESULT SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Offset, unsigned int u32Size) override;
+	virtual HRESULT SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture) override;
+
+	virtual HRESULT BeginScene() override;
+	virtual HRESULT EndScene() override;
+	virtual HRESULT SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface) override;
+	virtual HRESULT SetViewport(const D3DVIEWPORT9* pViewport) override;
+	virtual HRESULT Clear(unsigned int u32RectCount, const D3DRECT* aryRects, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil) override;
+	virtual HRESULT SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value) override;
+	virtual HRESULT SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) override;
+	virtual HRESULT SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride) override;
+	virtual HRESULT SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting) override;
+	virtual HRESULT SetIndices(IDirect3DIndexBuffer9* pIndexBuffer) override;
+	virtual HRESULT DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount) override;
+
+	virtual unsigned int IssueFrameFence() override;
+	virtual unsigned int GetCompletedFrameFence() override;
+
+private:
+	struct FrameFence
+	{
+		unsigned int		u32Fence;
+		IDirect3DQuery9*	pQuery;				// IssueʧʱΪ
+	};
+
+	static const unsigned int			u32MaxFrameLatency;
+
+private:
+	ID3DXEffectStateManager*			m_pEffectStateManager;		// Effect
+
+	std::deque<FrameFence>				m_deqPendingFences;
+	std::vector<IDirect3DQuery9*>		m_vecFreeQueries;
+	unsigned int						m_u32LastFence;
+	unsigned int						m_u32CompletedFence;
+};
@@ -50,19 +50,100 @@
 			Stencil\Depth Test
 			Alpha Blending
 			
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-18
+	DESC :
+	1.	Ⱦвʹstd::map/std::set/std::list飨ÿλƶҪһڵ㣬Ұֵָ򣩣Ϊһƽ
+		̹Ļ飬ÿӦһ64λģͲɺûRadixSort64
+		RenderSystem˳ύֻɫʱ仯ʱлȾ״̬
+	2.	Ĳ֣Ӹλλ
+		A.	͸㼶㼶2λ> ɫţ14λ> ʱţ16λ> ȣ32λȽԶ
+		B.	͸㼶㼶2λ> ȣ32λԶ> ɫţ14λ> ʱţ16λ
+		㼶ΪOpaqueMaskedTranslucentTranslucentAdditiveModulateMaskedڲ͸֮ƣ
+		Alpha TestĶ󲻻Ӱ첻͸Early Z Culling
+	3.	ΧĵƽǸλģʽֵĴС˳һ£ֱΪ32λʹã͸
+		㼶еȡʵԶ
+	4.	ɫʵıֻڷ飬ųλʱᷢصʱֻȾ״̬лӰȷԣΪύʱ
+		Ƚϵָ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-19
+	DESC :
+	1.	Ⱦ֮֡䱣ÿȾǰգ
+		A.	ģ͵һοɼʱΪÿȾԪֻ֮ģ͵任Ĳʻʻɫı
+			ʱ»״̬λòʱֹģ͵Ҫ¼㡣һιпɼûƶ
+			ûʱ滻ʱֻģ͵Ļɼ
+		B.	ģʹӳƳʱһȾʱͨRemoveModelɾĻģ͵ȾԪ
+			ıʱ´οɼʱ´
+		C.	ģ͵ı任ȾֻһĻлһʱȫ
+	2.	ʱһεΪƳβɼĻˢģ֮֡ƶͨ
+		Сʹòָ˳򣻲ƶԪصĴʱΪлִл򡣱
+		³ֵĻִл鲢
+	3.	ÿιͳݣ½Ƴ¼ĻƶȣͨGetStatisticsȡ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-20
+	DESC :
+	1.	ӲйSetParallelBuildEnabledĬϹرգInsertModelsɼģͷΪν̳߳ش
+		A.	ÿֻԼģ͵Ļ³ֵдԼ鲢򣬲Ҫ
+		B.	ҪҪȡɫģͲдShaderManager̰߳ȫģ¼
+			ɺԭ˳InsertModel˻ķɫĴ˳봮йһ
+		C.	Ľ봮дģ͵Ľ鲢
+		йʱģ͵任Ѿ£RTransformStore::Updateʱȡ任дRTransformStore
+	2.	³ֵ±꣩򣬽ģ͵Ĳ˳ԼĻַʽ޹أйǲοʵ֣
+		ַʽõύ˳ȫͬ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-21
+	DESC :
+	1.	͸㼶ȾԪļαţ12λλڲʱ֮䣬ֻλģʽĸ20λ
+		8λָ11λβԾԼΪ1/2048ȽԶ˳򣩣
+			㼶2λ> ɫţ14λ> ʱţ16λ> αţ12λ> ȣ20λ
+		ݵȾԪͬһɫУȾϵͳԽǺϲΪһʵƣ͸㼶
+		ϸ򣬲ֲ䣬ֻǡͬȾԪŻᱻϲ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-27
+	DESC :
+	1.	ͳӹʱInsertModelsSortĺʱ֮ͣ룩RenderSystemѱ빹Ⱦеʱֿ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-29
+	DESC :
+	1.	ڴʱȾԪDrawPacketRenderSystemύʱֻȡٷȾԪĶ
+		붥
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-05
+	DESC :
+	1.	RenderSystemΪÿӿڱһȾУÿȾֻ۲һԼһ֡ĽΪ
+	2.	BeginBuildӳ֡ţֻһ֡ṩһ֮֡עģͣȾһι֮˳
+		֡ʱ޷֪ڼ䱻עģͣл
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-06
+	DESC :
+	1.	͸ȾԪͼ˳ʱ¼ͬʱĵķѡޣֻ޸ĻDrawPacket
+		ʼѡͬ޵ĻݲͬᱻϲΪͬһʵ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	GetSortKeysSort֮ύ˳еڱȽȾУ紮벢йĽǷȫͬ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
 #pragma once
 
 #include "RwgeRenderUnit.h"
-#include <map>
-#include <list>
-#include <set>
+#include <vector>
 #include "RwgeShaderKey.h"
 
 class RCamera;
 class RModel;
+class RMesh;
+class RSceneManager;
 class RD3d9Shader;
 class RMaterial;
 class RLight;
@@ -84,48 +165,70 @@ struct RenderState
 	}
 };
 
-// ڲ͸ȾͼԪ
-struct RenderUnitWithDepth
+// Ʋ㼶λ2λ㼶СȻ
+enum EDrawLayer
 {
-	float			f32DepthSquare;		// ͼԪֵƽ
-	RRenderUnit*	pRenderUnit;
-
-	RenderUnitWithDepth() : f32DepthSquare(0.0f), pRenderUnit(nullptr) {};
-	RenderUnitWithDepth(float f32DepthSquare, RRenderUnit* pPrimitive) : f32DepthSquare(f32DepthSquare), pRenderUnit(pPrimitive) {};
+	EDL_Opaque,
+	EDL_Masked,
+	EDL_Translucent,
 
-	bool operator < (const RenderUnitWithDepth& right) const
-	{
-		return f32DepthSquare < right.f32DepthSquare;
-	}
+	EDrawLayer_MAX
 };
 
-// ڰ͸ȾͼԪ
-struct RenderStateWithDepth : public RenderState
+// Ⱦеһλƣ֮֡䱣
+struct DrawItem
 {
-	float f32DepthSquare;				// ͼԪֵƽ
+	RRenderUnit*		pRenderUnit;			// Ϊʱʾδʹ
+	RD3d9Shader*		pShader;
+	RMaterial*			pMaterial;
+	RMesh*				pMesh;
+	D3DXVECTOR3			worldCenter;			// Χĵ꣬ڼ
+	unsigned long long	u64SortKey;
+	unsigned int		u32ShaderGeneration;	// ȡpShaderʱȾеɫ汾
+	unsigned int		u32VisibleBuild;		// һοɼʱĹ
+	unsigned int		u32OrderBuild;			// һγеĹ
+	DrawPacket			drawPacket;				// ȾԪDrawPacketĸڴʱ
+};
 
-	RenderStateWithDepth() : RenderState(), f32DepthSquare(0.0f) {};
-	RenderStateWithDepth(const RenderState& renderState) : RenderState(renderState), f32DepthSquare(0.0f) {};
+// ʱֻƶṹ壬ƶ
+struct DrawSortKey
+{
+	unsigned long long	u64SortKey;
+	unsigned int		u32DrawItem;		// Ⱦе±
+};
 
-	bool operator < (const RenderStateWithDepth& right) const
+// Ⱦÿιͳ
+struct RenderQueueStatistics
+{
+	unsigned int u32DrawItemCount;				// ύĻ
+	unsigned int u32RegisteredItemCount;		// ȾбĻ
+	unsigned int u32AddedItemCount;				// ´Ļ
+	unsigned int u32RemovedItemCount;			// ɾĻ
+	unsigned int u32RekeyedItemCount;			// ¼Ļȡʻɫı䣩
+	unsigned int u32InsertedItemCount;			// һβУҪ鲢еĻ
+	unsigned int u32SortMoveCount;				// ƶԪصĴ
+	bool		 bFullSort;						// Ƿ˲򣬶лִл
+	unsigned int u32BuildTaskCount;				// ййʱΪ0
+	unsigned int u32DeferredModelCount;			// йʱɺдģ
+	float		 f32BuildTime;					// ɼģĺʱ룩
+
+	RenderQueueStatistics() :
+		u32DrawItemCount(0),
+		u32RegisteredItemCount(0),
+		u32AddedItemCount(0),
+		u32RemovedItemCount(0),
+		u32RekeyedItemCount(0),
+		u32InsertedItemCount(0),
+		u32SortMoveCount(0),
+		bFullSort(false),
+		u32BuildTaskCount(0),
+		u32DeferredModelCount(0),
+		f32BuildTime(0.0f)
 	{
-		if (f32DepthSquare != right.f32DepthSquare)
-		{
-			return f32DepthSquare < right.f32DepthSquare;
-		}
 
-		if (pShader != right.pShader)
-		{
-			return pShader < right.pShader;
-		}
-
-		return pMaterial < right.pMaterial;
 	}
 };
 
-typedef std::map<RenderState,			std::set<RenderUnitWithDepth>>		OpaqueGroupMap;
-typedef std::map<RenderStateWithDepth,	std::list<RRenderUnit*>>			TranslucentGroupMap;
-
 class RD3d9RenderQueue
 {
 	friend class RD3d9RenderSystem;
@@ -134,32 +237,93 @@ private:
 	RD3d9RenderQueue();
 	~RD3d9RenderQueue();
 
+	// ģ͵Ļ任
+	struct ModelDrawItems
+	{
+		RModel*						pModel;				// ΪʱʾûжӦģ
+		const D3DXMATRIX*			pWorldTransform;
+		unsigned int				u32WorldRevision;
+		unsigned int				u32VisibleBuild;	// һοɼʱĹ
+		std::vector<unsigned int>	vecDrawItems;		// ȾԪ˳
+	};
+
+	// йеһִֻ߳д
+	struct BuildTask
+	{
+		std::vector<DrawSortKey>	vecNewSortKeys;
+		std::vector<DrawSortKey>	vecSortTemp;
+		std::vector<unsigned int>	vecDeferredModels;		// Ҫɺдģе±
+		const DrawSortKey*			arySortedKeys;			// λvecNewSortKeysvecSortTemp
+		unsigned int				u32MergePosition;		// 鲢ʱһҪȡ
+		unsigned int				u32RekeyedItemCount;
+	};
+
 public:
 	// ÷ı䣨糡лıȣҪ²лShader
-	FORCE_INLINE void NeedUpdateCachedMaterialShader()		{ m_bNeedUpdateCachedMaterialShader = true; };
+	FORCE_INLINE void NeedUpdateCachedMaterialShader()		{ ++m_u32ShaderGeneration; };
+	void BeginBuild(const RSceneManager* pSceneManager, unsigned int u32SceneFrame);	// ʼΪһ֡ȾУһβͬ֡ʱл
+	void RemoveModel(unsigned int u32TransformHandle);		// ɾģ͵ĻģͿѾֻݾ
 	void SetCamera(const RCamera* pCamera);		// ӰйȾ״̬
-	void InsertModel(RModel* pModel);
+	void InsertModel(RModel* pModel);			// ģڱιпɼ
+	void InsertModels(RModel* const* aryModels, unsigned int u32Count);	// һɼģͣйʱ̳߳ش
+	FORCE_INLINE void SetParallelBuildEnabled(bool bEnabled)	{ m_bParallelBuild = bEnabled; };
+	FORCE_INLINE bool IsParallelBuildEnabled() const			{ return m_bParallelBuild; };
 	FORCE_INLINE void SetLight(const RLight* pLight)		{ m_pLight = pLight; };
 	FORCE_INLINE void SetSceneKey(const SceneKey& key)		{ m_SceneKey = key; };
 	FORCE_INLINE void SetGlobalKey(const GlobalKey& key)	{ m_GlobalKey = key; };
 
-	void Clear();								// Ⱦ״̬ͼԪ
+	void Sort();								// ģͲɺ󣬰ԿɼĻ
+	void Clear();								// ɾл
+
+	FORCE_INLINE unsigned int GetDrawItemCount() const { return static_cast<unsigned int>(m_vecSortKeys.size()); };
+	FORCE_INLINE const RenderQueueStatistics& GetStatistics() const { return m_Statistics; };
+	FORCE_INLINE const std::vector<DrawSortKey>& GetSortKeys() const { return m_vecSortKeys; };		// Sort֮ύ˳
+
+	FORCE_INLINE static EDrawLayer GetSortKeyLayer(unsigned long long u64SortKey) { return static_cast<EDrawLayer>(u64SortKey >> 62); };
+	static unsigned long long MakeSortKey(EDrawLayer layer, const RD3d9Shader* pShader, const RMaterial* pMaterial, const RRenderUnit* pRenderUnit, float f32DepthSquare);
 
 private:
-	OpaqueGroupMap			m_mapOpaqueGroup;
-	TranslucentGroupMap		m_mapTranslucentGroup;
+	unsigned int AllocateDrawItem();
+	void FreeDrawItem(unsigned int u32DrawItem);
+	bool UpdateRenderState(DrawItem& drawItem);		// ʻɫıʱ»Ƿ˸ı
+	bool NeedQueryShader(const ModelDrawItems& modelDrawItems) const;	// ģ͵ĻʱǷҪShaderManagerȡɫ
+	ModelDrawItems& GetModelDrawItems(unsigned int u32TransformHandle);
+	bool CreateDrawItems(ModelDrawItems& modelDrawItems, RModel* pModel);	// Ҫʱ´ģ͵ĻǷ񴴽
+	// ģ͵ĻֻдģԼĻ봫ĲҪȡɫʱڲе
+	void UpdateDrawItems(ModelDrawItems& modelDrawItems, RModel* pModel, bool bCreated, std::vector<DrawSortKey>& vecNewSortKeys, unsigned int& u32RekeyedCount);
+
+private:
+	const RSceneManager*		m_pSceneManager;		// ĳ
+	unsigned int				m_u32SceneFrame;		// һιʱ֡
+	unsigned int				m_u32BuildIndex;		// ÿι1
+	unsigned int				m_u32ShaderGeneration;	// Ҫ²лShaderʱ1
+	unsigned int				m_u32MaterialRevision;	// һιʱĲʰ汾
+	bool						m_bMaterialChanged;		// ι֮Ĳʱ滻ҪɼĲ
+
+	std::vector<DrawItem>		m_vecDrawItems;
+	std::vector<unsigned int>	m_vecFreeDrawItems;
+	std::vector<ModelDrawItems>	m_vecHandleToDrawItems;
+
+	std::vector<DrawSortKey>	m_vecSortKeys;			// Sort֮ύ˳УһιΪ
+	std::vector<DrawSortKey>	m_vecNewSortKeys;		// ι³еĻ
+	bool						m_bNewSortKeysSorted;	// m_vecNewSortKeysѾ±꣩
+	std::vector<DrawSortKey>	m_vecSortTemp;			// 鲢ʹõʱ飬Աÿ֡ڴ
+
+	RenderQueueStatistics		m_Statistics;
+
+	bool						m_bParallelBuild;
+	std::vector<BuildTask>		m_vecBuildTasks;
 
 	// 
 	D3DXVECTOR3				m_ViewOppositeDirection;
-	const D3DXVECTOR3*		m_pCameraPosition;
+	D3DXVECTOR3				m_CameraPosition;
+	bool					m_bCameraMoved;			// λһιͬпɼȶҪ¼
 	const D3DXMATRIX*		m_pViewTransform;
 	const D3DXMATRIX*		m_pProjectionTransform;
 	D3DXMATRIX				m_ViewProjTransform;
 
 	const RLight*			m_pLight;
 
-	bool					m_bNeedUpdateCachedMaterialShader;
-
 	SceneKey				m_SceneKey;
 	GlobalKey				m_GlobalKey;
 };
@@ -6,7 +6,8 @@
 
 	2.	RenderSystemRenderQueue
 		A.	RenderQueueRenderSystemһ
-		B.	ÿViewportʱǰRenderQueueᱻ
+		B.	RenderQueue֮֡䱣ÿViewportʱֻ¿ɼģзıĻRenderQueue
+			һε˳ΪԻRenderSystem˳ύ
 		C.	RenderQueueƳɵԭҪ߳ȾҪʹ˫壬ܻҪRenderQueue
 
 	3.	еD3D ͼԪύDPϣEndSceneִϷ߼ִPresent ԳַCPU GPU 첽
@@ -23,6 +24,125 @@
 	ToDo :
 	2016-05-20
 		Ϊһ£仯Ƚ٣ĿǰRWGEûнǵȾ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-21
+	DESC :
+	1.	ԶʵύȾʱġɫͬҹݣRRenderUnit::HasSameGeometryĻ
+		ﵽu32MinInstanceCountʱʹɫʵ汾SHADER_INSTANCING붥ʵ汾ǵ
+		дʵ壬ͨSetStreamSourceFreqһDPϣɫʵ汾ʱ˻
+	2.	ʵһ̬㻺壬ÿдʱNOOVERWRITEʽ׷ӣдDISCARDʽͷʼȴGPU
+	3.	ÿ֡ĻͳƣDPʵDPʵͨGetFrameStatisticsȡȷϺЧ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-23
+	DESC :
+	1.	̬ʵĻУġɫ붥ͬСȾԪRDynamicBatcher::
+		CanBatchﵽu32MinDynamicBatchCountʱDynamicBatcherCPUϱ任ռ䲢д뻷λ壬һDP
+		ϣϲı˳Ҳڰ͸㼶
+	2.	ͳӶ̬DP뱻ϲĻ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-24
+	DESC :
+	1.	ͼAPIøΪͨRenderDeviceִУΪڴDeviceʱͬʱD3d9RenderDeviceCreateHeadlessRenderTarget
+		NullRenderDeviceһڵȾĿ꣬ûԿĻ̲֡ͳƿ
+	2.	ͷģʽ봰ȾĿ겻ͬʱʹ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-25
+	DESC :
+	1.	ȾĿꡢӿڡȾSubmitӿڲֱӵRenderDeviceǰ¼CommandBufferУEndScene
+		ʱ˳ִУʵ붯̬ĻλдҲΪ¼DISCARD֮Ⱥ˳򱣳ֲ
+	2.	ÿ֡ʼʱգGetCommandBufferһ֡Ա浽ļNullRenderDeviceط
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-26
+	DESC :
+	1.	ִʱRenderDeviceDeviceStateShadowֵ˶״̬ãRenderSystemжԵǰShaderʡ
+		붥ָıȽȻ¼
+	2.	ÿ״̬ύ뱻˵ĴͨGetDeviceStateStatisticsȡRenderOneFrameʼʱ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-27
+	DESC :
+	1.	RenderOneFrameΪÿӿÿȾĿ¼FrameStatisticsDPɫл󶨡л볣ֽ
+		ȡжӦȾӿǰĲֵͼԪл㼶ȾԪύʱۼӣģ
+		ӿڵĲüͳƣ빹ȾеĺʱUpdateCameraĺʱȾеĹʱõ
+	2.	ȾĿͳӿ֮ͣύʱEndSceneִʱ䣻֡ĺϼƼFrameStatisticsHistory
+		Բѯ֡ķΧ򱣴ΪCSVJSON
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-28
+	DESC :
+	1.	ύȾǰΪлPrimitiveTransformд뱾֡ı任ύʱֱʹã
+		Ϊλʵ붯̬ÿȾмһεı任
+	2.	g_Transformg_vecOppositeViewg_LightEffectPoolеĹShader֮䱣ֵֻ뱾֡һ
+		¼ֵͬʱż¼ڵĻ任ͬʱظϴͬһ֡ԴĶӿֻϴ
+		һγЩ¼ÿ֡ʼʱʧЧ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-29
+	DESC :
+	1.	ֻʹDrawPacketSubmitDrawPacketԭֱύĽӿڣǰ󶨵ļ״̬Ҳ
+		ΪһDrawPacketD3DƫơȽϣٱȽVertexStreamIndexStreamָ
+	2.	ύȾʱӻиƵDrawPacketȡݣʵDrawPacketʵжܷʵ
+		ʱȽDrawPacket
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-30
+	DESC :
+	1.	ԤȾĬϹرգύȾʱȰѲ͸㼶лľϸӽԶʹøɫ
+		Ȱ汾RD3d9ShaderManager::GetDepthOnlyShaderֻдȣ֮PassƲ͸㼶ʱȲԸΪEQUAL
+		رд룬ÿִֻһɫκһ͸ûɫʱȾвʹԤȾ
+	2.	EQUALҪPassȫͬȣ˿ԤȾʱ͸㼶ʹʵ붯̬Passʹ
+		ñ任ͬһ۲ͶӰƣMasked͸㼶Ӱ
+	3.	ȻƹƣĬϹرգύȾʱOverdrawEstimatorύ˳Ʋ͸㼶ĸǡդɫ
+		¼ӿڵFrameStatisticsУɫ븲֮ԤȾʡȥɫ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ԤȾʱ0ֻλõĻʹöֻλð汾ֻ0
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	ʵ붯̬ݶDynamicUploaderĻλ䣬ֱдRenderOneFrame
+		ȾĿִϺDynamicUploader::EndFrame֡Χ
+	2.	λ֡мռ䲻ʱʵֹͣʣʵ̬˻ص
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-05
+	DESC :
+	1.	ÿӿӵԼȾУڵһȾʱĳһ֡ûȾʱͷţRenderOneFrameΪӿڹȾ
+		УٰȾĿύ
+		A.	ÿӿڵڵĳֻһRSceneManager::BeginFrameµĺʱһ۲óӿ
+		B.	ӿڵ׶ü̳߳زִ
+		C.	ڵ޳ɼģͰӿڵ˳ִУڵShaderManager̰߳ȫģڲҲʹ߳
+			أ̳߳صвٵParallelFor
+		D.	Ⱦе򽻸̳߳زִ
+	2.	ÿȾֻ۲һӿڲΪλõĽ仯ÿ֡Ⱦ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-07
+	DESC :
+	1.	RenderOneFrameʱ¼һ֡ǩTransformStore޸ļԪʡԴɫ붥ݵȫְ汾ţ
+		ԼÿȾĿӿڵķΧɫͶӰڳİ汾šHasFrameChangedռǩ
+		һȾ֡Ƚϣͬʱ˵Ⱦһ֡õĻ治ı䣬Applicationһ֡ȾPresent
+	2.	ǩֻͨӿ޸ģֱ޸ĶݺҪRRenderUnit::UpdateVertexStream޸Ĳʱ
+		ʽҪͨMaterialFactoryʹЧ򲻻ᱻΪ淢˸ı
+	3.	GetQueueBuildCountۼΪӿڹȾеĴȷϱ֡ûؽȾ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	CreateRenderQueueκӿڵȾУɵͨSceneManager::BuildViewQueueͨ
+		ReleaseRenderQueueͷţӿ֮⹹ȽȾ
+	2.	λ֡мռ䲻ʱʵƲٶʣʵѾдʵĲճƣʣĻԭ
+		ɫƣ¼RenderSystemStatistics::u32InstancingFallbackItemCount
+	3.	ԤȾύκλ֮ǰΪлDrawPacketд붯̬λŲʱһ֡ԤȾ
+		PassʹɫԼȲԣдʧܵĻûдȣᱻPassEQUAL޳
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -35,6 +155,12 @@
 #include <RwgeSingleton.h>
 #include <RwgeObject.h>
 #include "RwgeD3d9RenderQueue.h"
+#include "RwgeVertexStream.h"
+#include "RwgeCommandBuffer.h"
+#include "RwgeFrameStatistics.h"
+#include "RwgeD3d9Shader.h"
+#include "RwgeOverdrawEstimator.h"
+#include "RwgeSceneManager.h"
 
 class RD3d9Viewport;
 class RenderTarget;
@@ -52,6 +178,35 @@ class RD3d9IndexBuffer;
 class RVertexDeclarationManager;
 class RD3d9ShaderManager;
 class RTextureManager;
+class RGpuMemoryManager;
+class RDynamicUploader;
+class RDynamicBatcher;
+class RRenderDevice;
+struct DeviceStateStatistics;
+
+// ÿ֡ĻͳƣRenderOneFrameʼʱ
+struct RenderSystemStatistics
+{
+	unsigned int		u32DrawItemCount;			// ύĻ
+	unsigned int		u32DrawCallCount;			// DPʵDP
+	unsigned int		u32InstancedDrawCallCount;	// ʵDP
+	unsigned int		u32InstanceCount;			// ͨʵƵĻ
+	unsigned int		u32DynamicBatchCount;		// ̬DP
+	unsigned int		u32DynamicBatchedItemCount;	// ̬ͨƵĻ
+	unsigned int		u32InstancingFallbackItemCount;	// ʵռ䲻㣬˻صƵĻ
+
+	RenderSystemStatistics() :
+		u32DrawItemCount(0),
+		u32DrawCallCount(0),
+		u32InstancedDrawCallCount(0),
+		u32InstanceCount(0),
+		u32DynamicBatchCount(0),
+		u32DynamicBatchedItemCount(0),
+		u32InstancingFallbackItemCount(0)
+	{
+
+	}
+};
 
 class RD3d9RenderSystem :
 	public RObject,
@@ -63,13 +218,14 @@ public:
 
 	RD3d9RenderTarget* RegWinodwForRenderTarget(RAppWindow& window);	// ΪڴDeviceSwapChain
 	bool DeRegWindowForRenderTarget(RAppWindow& window);
+	RD3d9RenderTarget* CreateHeadlessRenderTarget(int s32Width, int s32Height);	// NullRenderDevice벻ڵȾĿ
 
 	void BeginScene();
 	void EndScene();
 
 	void SubmitRenderTarget(RD3d9RenderTarget* pRenderTarget);
 	void SubmitFormerRenderTarget();					// ָ֮ǰʹõRenderTarget֮ǰRenderTargetΪգָΪĬ
-	void SubmitDefaultRenderTarget();					// RenderTargetΪD3D DeviceBackBuffer
+	void SubmitDefaultRenderTarget();					// RenderTargetΪD3D DeviceBackBufferͷģʽΪͷȾĿ꣩
 	void ClearActivedRenderTarget();					// ֻеǰRenderTargetܱClear
 
 	void SubmitViewport(const RD3d9Viewport* pViewport);
@@ -80,22 +236,88 @@ public:
 	void SubmitRenderState(const RenderState& newRenderState);
 	void SubmitMaterial(RMaterial* pNewMaterial);
 	void SubmitShader(RD3d9Shader* pNewShader);			// ύյShaderָ룬ʱʾǰ󶨵Shader
-	void SubmitVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration);
-	void SubmitVertexStream(const std::vector<VertexStream*>& vecVertexStreams);
-	void SubmitIndexStream(const IndexStream* pIndexStream);
+	void SubmitDrawPacket(const DrawPacket& drawPacket);	// ύ壬뵱ǰ󶨵ֵͬʱ
 	void SubmitRenderUnit(const RRenderUnit& primitive);
 	void SubmitRenderQueue(const RD3d9RenderQueue& renderQueue);
 
+	FORCE_INLINE void SetInstancingEnabled(bool bEnabled)	{ m_bInstancingEnabled = bEnabled; };
+	FORCE_INLINE bool IsInstancingEnabled()			const	{ return m_bInstancingEnabled; };
+	FORCE_INLINE void SetDynamicBatchingEnabled(bool bEnabled)	{ m_bDynamicBatchingEnabled = bEnabled; };
+	FORCE_INLINE bool IsDynamicBatchingEnabled()		const	{ return m_bDynamicBatchingEnabled; };
+	FORCE_INLINE void SetDepthPrepassEnabled(bool bEnabled)	{ m_bDepthPrepassEnabled = bEnabled; };
+	FORCE_INLINE bool IsDepthPrepassEnabled()			const	{ return m_bDepthPrepassEnabled; };
+	FORCE_INLINE void SetParallelQueueBuildEnabled(bool bEnabled)	{ m_bParallelQueueBuild = bEnabled; };	// RD3d9RenderQueue::SetParallelBuildEnabled
+	FORCE_INLINE bool IsParallelQueueBuildEnabled()		const	{ return m_bParallelQueueBuild; };
+	FORCE_INLINE void SetOverdrawEstimationEnabled(bool bEnabled)	{ m_bOverdrawEstimationEnabled = bEnabled; };
+	FORCE_INLINE bool IsOverdrawEstimationEnabled()		const	{ return m_bOverdrawEstimationEnabled; };
+	FORCE_INLINE const OverdrawEstimate& GetOverdrawEstimate() const { return m_OverdrawEstimator.GetEstimate(); };	// һύȾеĹ
+	FORCE_INLINE const RenderSystemStatistics& GetFrameStatistics() const { return m_FrameStatistics; };
+	FORCE_INLINE const RCommandBuffer& GetCommandBuffer() const { return m_CommandBuffer; };		// һ֡¼RenderOneFrame֮󱣴
+	const DeviceStateStatistics& GetDeviceStateStatistics() const;		// һ֡ύ뱻˵״̬ô
+
+	// һ֡ӿڡȾĿ֡ͳƣȾĿ갴Ⱦ˳
+	FORCE_INLINE const std::vector<ViewportFrameStatistics>& GetViewportFrameStatistics()	const { return m_vecViewportFrameStatistics; };
+	FORCE_INLINE const std::vector<FrameStatistics>& GetRenderTargetFrameStatistics()		const { return m_vecRenderTargetFrameStatistics; };
+	FORCE_INLINE const FrameStatistics& GetTotalFrameStatistics()							const { return m_TotalFrameStatistics; };
+	FORCE_INLINE const RFrameStatisticsHistory& GetFrameStatisticsHistory()				const { return m_FrameStatisticsHistory; };
+	FORCE_INLINE RFrameStatisticsHistory& GetFrameStatisticsHistory()							  { return m_FrameStatisticsHistory; };
+
 	void RenderOneFrame(float fDeltaTime);
 	void PresentFrame();
+	bool HasFrameChanged() const;		// һRenderOneFrameǷӰ컭ĸı䣬ûȾʱtrue
+	FORCE_INLINE unsigned int GetRenderedFrameCount()	const { return m_u32FrameIndex; };
+	FORCE_INLINE unsigned int GetQueueBuildCount()		const { return m_u32QueueBuildCount; };		// ۼƹӿȾеĴ
 
 	FORCE_INLINE IDirect3D9* GetD3d9() const { return m_pD3d9; };
 	FORCE_INLINE const RD3d9RenderTarget* GetActivedRenderTarget()	const { return m_pActivedRenderTarget; };
-	FORCE_INLINE const RD3d9RenderQueue&  GetRenderQueue()			const { return m_RenderQueue; };
+	const RD3d9RenderQueue* GetViewportRenderQueue(const RD3d9Viewport* pViewport) const;	// ӿһ֡ȾУûȾʱnullptr
+	RD3d9RenderQueue* CreateRenderQueue();							// κӿڵȾ
+	void ReleaseRenderQueue(RD3d9RenderQueue* pRenderQueue);
+
+private:
+	// ӿڵȾü֮֡䱣
+	struct ViewportRenderData
+	{
+		RD3d9Viewport*		pViewport;
+		RD3d9RenderQueue*	pRenderQueue;
+		RSceneManager*		pSceneManager;		// ֡ڵĳΪʱȾ
+		SceneView			sceneView;
+		unsigned int		u32LastFrame;		// һαȾ֡
+		float				f32SceneTime;		// ֡³üڵ޳ĺʱ룩Ⱦ
+	};
+
+	void FlushCommandBuffer();		// ִδִе
+	void CollectFrameSignature(std::vector<size_t>& vecSignature) const;	// ռӰ컭״̬HasFrameChanged
+	ViewportRenderData* GetViewportRenderData(RD3d9Viewport& viewport);		// ʱ
+	void BuildViewportRenderQueues();		// Ϊm_vecFrameViewportsеӿڸ³üȾ
+	// ύӿڵȾУ¼ӿڵͳƲۼӵȾĿͳ
+	void RenderViewport(const ViewportRenderData& viewportData, unsigned int u32RenderTarget, FrameStatistics& renderTargetStatistics);
+
+	void SubmitSceneConstants(RD3d9Shader* pSharedShader, const RD3d9RenderQueue& renderQueue);	// ֵ뱾֡Ѽ¼ֵͬʱ
+	void SubmitTransform(const PrimitiveTransform& transform);						// ֵһμ¼ֵͬʱ
+	void SubmitDraw(const DrawPacket& drawPacket, const PrimitiveTransform& transform);
+
+	// ʹõǰύʵɫһλ[u32Begin, u32End)ΧڹݵĻѾƵ
+	// ΧĽλãλռ䲻ʱСu32EndʣĻɵ
+	unsigned int SubmitInstancedRenderUnits(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin, unsigned int u32End);
+
+	// شu32BeginʼԶ̬ĻĽλãһܺʱu32Begin
+	unsigned int FindDynamicBatchEnd(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin) const;
+	bool SubmitDynamicBatch(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin, unsigned int u32End);
+
+	// ӽԶֻд[0, u32OpaqueEnd)Χڻȣлûɫʱ¼κfalse
+	bool SubmitDepthPrepass(const RD3d9RenderQueue& renderQueue, unsigned int u32OpaqueEnd, unsigned int u32TransformBase);
+	void EstimateOverdraw(const RD3d9RenderQueue& renderQueue, unsigned int u32OpaqueEnd, unsigned int u32TransformBase);
+
+	static const unsigned int	u32MinInstanceCount;			// ĿʱƸ
+	static const unsigned int	u32MaxInstancesPerBuffer;		// һʵDPʵ
+	static const unsigned int	u32MinDynamicBatchCount;		// Ŀʱж̬
 
 private:
 	IDirect3D9*					m_pD3d9;
 	RD3d9Device*				m_pDevice;
+	RRenderDevice*				m_pRenderDevice;
+	RD3d9RenderTarget*			m_pDefaultRenderTarget;			// D3D DeviceͷȾĿ
 
 	// ӳеĵһRenderTargetһD3D Device
 	std::map<RAppWindow*, RD3d9RenderTarget*> m_mapWindowsToRenderTargets;	
@@ -105,15 +327,59 @@ private:
 	const RD3d9Viewport*		m_pAcitvedViewport;
 	const RD3d9Viewport*		m_pFormerViewport;
 
-	RD3d9RenderQueue			m_RenderQueue;
+	std::map<const RD3d9Viewport*, ViewportRenderData*>	m_mapViewportRenderData;
+	std::vector<ViewportRenderData*>	m_vecFrameViewports;		// ֡Ⱦ˳еӿ
+	std::vector<RSceneManager*>			m_vecFrameScenes;			// ֡ѾùBeginFrameĳ
+	unsigned int						m_u32FrameIndex;
+	unsigned int						m_u32QueueBuildCount;
+	std::vector<size_t>					m_vecRenderedSignature;		// һȾ֡ǩ
+	mutable std::vector<size_t>			m_vecSignatureScratch;
+	GlobalKey							m_GlobalShaderKey;			// Ⱦйõȫɫֵ
+	bool								m_bParallelQueueBuild;
+	D3DXMATRIX							m_SubmittedViewProjTransform;	// һύȾеĹ۲ͶӰSubmitRenderUnitʹ
+
 	RenderState					m_ActivedRenderState;			// ǰЧȾ״̬Shaderʣ
 	
-	const RD3d9VertexDeclaration*		m_pActivedVertexDeclaration;
-	unsigned char						m_u8ActivedStreamCount;
-	std::vector<const VertexStream*>	m_vecActivedVertexStreams;
-	const IndexStream*					m_pActivedIndexStream;
+	DrawPacket					m_ActivedDrawPacket;			// ǰ󶨵Ķ壬ֻʹ⼸
 
 	RVertexDeclarationManager*	m_pVertexDeclarationManager;
 	RD3d9ShaderManager*			m_pShaderManager;
 	RTextureManager*			m_pTextureManager;
+	RGpuMemoryManager*			m_pGpuMemoryManager;
+	RDynamicUploader*			m_pDynamicUploader;
+
+	bool						m_bInstancingEnabled;
+
+	std::vector<PrimitiveTransform>		m_vecTransformArena;			// ֡лı任Ⱦеύ˳
+	std::vector<const D3DXMATRIX*>		m_vecTransformWorlds;			// 任ʱռ
+	PrimitiveTransform					m_IdentityWorldTransform;		// Ϊλʱı任ÿύȾʱ
+	PrimitiveTransform					m_SubmittedTransform;
+	bool								m_bTransformSubmitted;
+	D3DXVECTOR3							m_SubmittedOppositeView;
+	bool								m_bOppositeViewSubmitted;
+	std::vector<float>					m_vecSubmittedLightConstants;
+	bool								m_bLightSubmitted;
+
+	bool								m_bDynamicBatchingEnabled;
+	RDynamicBatcher*					m_pDynamicBatcher;
+	std::vector<const RRenderUnit*>		m_vecDynamicBatchUnits;
+
+	bool								m_bDepthPrepassEnabled;
+	std::vector<DrawSortKey>			m_vecDepthPrepassKeys;			// Ϊƽu32DrawItemΪеλ
+	std::vector<DrawSortKey>			m_vecDepthPrepassTemp;
+	std::vector<DrawPacket>				m_vecDepthPrepassPackets;		// m_vecDepthPrepassKeysu32DrawItemӦ̬Ѿд
+	bool								m_bOverdrawEstimationEnabled;
+	ROverdrawEstimator					m_OverdrawEstimator;
+
+	RCommandBuffer				m_CommandBuffer;				// Submitӿڶֻ¼EndSceneʱִ
+	unsigned int				m_u32ExecutedCommandSize;		// Ѿִеֽ
+
+	RenderSystemStatistics		m_FrameStatistics;
+
+	FrameStatistics*						m_pViewportStatistics;			// ȾӿڵͳƣSubmitӿۼ
+	FrameStatistics							m_DiscardedStatistics;			// ûȾӿʱۼĿ
+	std::vector<ViewportFrameStatistics>	m_vecViewportFrameStatistics;
+	std::vector<FrameStatistics>			m_vecRenderTargetFrameStatistics;
+	FrameStatistics							m_TotalFrameStatistics;
+	RFrameStatisticsHistory					m_FrameStatisticsHistory;
 };
\ No newline at end of file
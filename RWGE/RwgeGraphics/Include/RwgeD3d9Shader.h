@@ -30,6 +30,20 @@
 		ݸShaderлƵЧʶԱȡֱӽΪ궨崫ݸShaderԽּڱִУȾΪƿʱ
 		ЧʸߣַʽԽʡֲĿڳ궨ShaderKey ļ⣬Գʹ
 		TextureHashKeyķʽ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-26
+	DESC :
+	1.	EndѰ󶨵EffectĲEnd֮ȻлͬһShaderʱͬظ
+	2.	SetMaterialһõĲʳֵͬʱãD3DRS_ALPHAREFg_Transformȹˣ
+		ǰҲᱻ͸Pass޸ģͨEffectPoolShader֮乲߶豸DeviceStateShadowֵ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-28
+	DESC :
+	1.	ComputePrimitiveTransformsһμһӦPrimitiveTransformתú۲ͶӰ󣩣
+		֧SSE ʱʹSIMD ָSetTransformֱԤȼõPrimitiveTransformRenderSystemύȾǰ
+		Ϊл㣬ύʱ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -44,6 +58,7 @@ class ShaderType;
 class RMaterial;
 class RLight;
 class RD3d9Texture;
+class RCommandBuffer;
 
 struct PrimitiveTransform
 {
@@ -67,20 +82,26 @@ private:
 	~RD3d9Shader();
 
 public:
-	void Begin();
-	void End();
-	void CommitChanges() const;
+	// ½ӿֻѶEffectȾ״̬޸ļ¼УRenderSystemͳһִ
+	void Begin(RCommandBuffer& commandBuffer);
+	void End(RCommandBuffer& commandBuffer);
+	void CommitChanges(RCommandBuffer& commandBuffer) const;
 
-	void SetOppositeView(const D3DXVECTOR3* pDirection);
-	void SetLight(const RLight* pLight);
-	void SetMaterial(const RMaterial* pMaterial);
-	void SetTexture(unsigned int u32Index, const RD3d9Texture* pTexture);
-	void SetTransform(const D3DXMATRIX* pWorld, const D3DXMATRIX* pViewProjection);
+	void SetOppositeView(RCommandBuffer& commandBuffer, const D3DXVECTOR3* pDirection);
+	void SetLight(RCommandBuffer& commandBuffer, const RLight* pLight);
+	void SetMaterial(RCommandBuffer& commandBuffer, const RMaterial* pMaterial);
+	void SetTexture(RCommandBuffer& commandBuffer, unsigned int u32Index, const RD3d9Texture* pTexture);
+	void SetTransform(RCommandBuffer& commandBuffer, const D3DXMATRIX* pWorld, const D3DXMATRIX* pViewProjection);
+	void SetTransform(RCommandBuffer& commandBuffer, const PrimitiveTransform& transform);
 
-	FORCE_INLINE bool IsSuccessLoaded() const { return m_bSuccessLoaded; };
+	// ΪaryWorldsеÿɫʹõı任˳дaryTransforms
+	static void ComputePrimitiveTransforms(const D3DXMATRIX* const* aryWorlds, unsigned int u32Count, const D3DXMATRIX& matViewProjection, PrimitiveTransform* aryTransforms);
 
-private:
-	void ClearBoundingTextures();
+	bool HasTechnique(const char* szName) const;		// EffectǷָTechnique
+
+	FORCE_INLINE bool IsSuccessLoaded() const { return m_bSuccessLoaded; };
+	FORCE_INLINE unsigned short GetSortId() const { return m_u16SortId; };		// ɫ˳䣬Ⱦ
+	FORCE_INLINE const RShaderKey& GetShaderKey() const { return m_ShaderKey; };
 
 private:
 	Rwge::tstring			m_strBinaryFilePath;
@@ -94,7 +115,14 @@ private:
 	D3DXHANDLE				m_hPrimitiveTransform;
 
 	bool					m_bSuccessLoaded;
+	unsigned short			m_u16SortId;
+	RD3d9Shader*			m_pInstancedShader;			// ͬһShaderKeyʵ汾ɫڵһʹʱȡ
+	bool					m_bInstancedShaderQueried;	// Ѿȡʵ汾ȡʧʱm_pInstancedShaderΪգ
+	RD3d9Shader*			m_pDepthOnlyShader;			// ֻȵİ汾ԤȾͬڵһʹʱȡ
+	bool					m_bDepthOnlyShaderQueried;
 	unsigned char			m_u8TextureCount;
 	D3DXHANDLE*				m_aryTextureHandles;
-	RD3d9Texture**			m_aryBoundingTextures;		// ǰ󶨵
+	RD3d9Texture**			m_aryBoundingTextures;		// ǰ󶨵飬Shaderл֮䱣
+	float*					m_aryBoundMaterialConstants;	// һõĲʳڹֵͬ
+	unsigned short			m_u16BoundMaterialConstantCount;
 };
@@ -9,6 +9,12 @@
 			вңҳɹʱShaderShaderKey Դļмɫʧʱ±ɫ
 	3.	ɫָD3D9DeviceһָͲܱΪеShaderDevice󶨵ģDeviceζ
 		Ҫ¼еShader
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-30
+	DESC :
+	1.	GetDepthOnlyShaderɫȰ汾ֻӰ춥λ޳ʽֶΣƤ˫棩ԼֶΣ
+		ֶ㣬ʹòͬʵĲ͸ɫͨͬһɫ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -40,6 +46,8 @@ public:
 
 	static bool CompileShader(const RShaderKey& key);
 	RD3d9Shader* GetShader(const RShaderKey& key);
+	RD3d9Shader* GetInstancedShader(RD3d9Shader* pShader);		// ɫʵ汾ʧʱnullptr
+	RD3d9Shader* GetDepthOnlyShader(RD3d9Shader* pShader);		// ɫͬȵɫʧܻEffectûDepthOnlyTechniqueʱnullptr
 
 	RD3d9Shader* GetSharedShader();				// ɫӳеĵһɫӳΪ򷵻nullptr
 
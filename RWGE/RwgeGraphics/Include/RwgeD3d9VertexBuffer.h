@@ -2,6 +2,18 @@
    CREATE	
 	AUTH :	һ																			   DATE : 2016-05-20
 	DESC :	㻺壬D3D ύ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	ʱָΪ̬壨ֻWRITEONLYûDYNAMIC̬GpuMemoryManagerӷ䣬ֻڼʱ
+		дһ
+	2.	BindVertexStream԰Ѷдָƫƣƫɵ߷䣬Ӱ˳׷ʱôС
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	WriteDataеֻдɵֱд룬ƫDISCARDDynamicUploaderĻη
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -12,18 +24,23 @@
 
 struct VertexStream;
 class RD3d9Device;
+class RCommandBuffer;
 struct IDirect3DDevice9;
 struct IDirect3DVertexBuffer9;
 
 class RD3d9VertexBuffer : RObject
 {
 public:
-	RD3d9VertexBuffer(unsigned int u32BufferSize /*ֽ*/);
+	RD3d9VertexBuffer(unsigned int u32BufferSize /*ֽ*/, bool bDynamic = true);
 	~RD3d9VertexBuffer();
 
 	FORCE_INLINE IDirect3DVertexBuffer9* GetD3dVertexBuffer() const { return m_pD3dVertexBuffer; };
-	bool BindVertexStream(VertexStream* pVertexStream);
+	bool BindVertexStream(VertexStream* pVertexStream);							// ׷Ѿ󶨵Ķ֮
+	bool BindVertexStream(VertexStream* pVertexStream, unsigned int u32Offset);	// дָƫ
 	bool UpdateVertexStream(VertexStream* pVertexStream) const;
+	void* WriteData(RCommandBuffer& commandBuffer, unsigned int u32Offset, unsigned int u32Size, bool bDiscard);	// ÿ֡дݣеԽʱnullptrbDiscardΪfalseʱԲǷʽд
+
+	FORCE_INLINE unsigned int GetBufferSize() const { return m_u32BufferSize; };
 
 private:
 	IDirect3DVertexBuffer9*	m_pD3dVertexBuffer;
@@ -20,6 +20,19 @@
 		B.	ͲƣǰĶʵҲ࣬ԿǽԴһģ࣬Ķ
 			
 		C.	ܻӰ춥ɫĶ壬Ŀǰʵʱ֮Ĺϵ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-21
+	DESC :
+	1.	洴ģ壬Դʵ汾һʵȡ
+		4FLOAT4TEXCOORD4 - TEXCOORD7ʹʵƵĶвʹ⼸
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ֻͨͬģ干ͬһ
+	2.	0ֻλʱֻλð汾ֻ0ԤȾʱʹã
+		Ҫ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -46,10 +59,20 @@ public:
 	FORCE_INLINE unsigned int GetVertexSizeOfStream(unsigned char u8StreamID)	const { return m_vecStreamVertexSize[u8StreamID]; };
 	FORCE_INLINE unsigned int GetVertexSize()									const { return m_u32VertexSize; };
 	FORCE_INLINE unsigned int GetStreamCount()									const { return m_vecStreamVertexSize.size(); };
+	FORCE_INLINE bool HasPosition()												const { return m_u16PositionOffset != 0xFFFF; };
+	FORCE_INLINE unsigned char GetPositionStream()								const { return m_u8PositionStream; };
+	FORCE_INLINE unsigned short GetPositionOffset()								const { return m_u16PositionOffset; };
+	FORCE_INLINE const RVertexDeclarationTemplate& GetTemplate()				const { return m_Template; };
 
 private:
 	IDirect3DVertexDeclaration9*		m_pD3dVertexDeclaration;		// D3D
 	std::vector<unsigned int>			m_vecStreamVertexSize;			// ÿĶС
 	unsigned int						m_u32VertexSize;				// жܶС
+	unsigned char						m_u8PositionStream;				// λãPOSITION0FLOAT3ڵĶ
+	unsigned short						m_u16PositionOffset;			// λڶеƫƣʱΪ0xFFFFڼΧ
+	RVertexDeclarationTemplate			m_Template;						// ģ
+	mutable RD3d9VertexDeclaration*		m_pInstancedDeclaration;		// ʵ汾ɶڵһʹʱ
+	mutable RD3d9VertexDeclaration*		m_pPositionOnlyDeclaration;		// ֻλð汾ͬϣʱΪnullptr
+	mutable bool						m_bPositionOnlyDeclarationQueried;
 };
 
@@ -9,6 +9,7 @@
 	5.	ViewportǶĶԱõRenderTargetУȾʾ
 	6.	ViewportֻһD3D COM 󣬿ⴴɾҲΪˣֻбõRenderTarget
 		в
+	7.	ÿΪViewportȾʱ׶üڵ޳ͳݼ¼Viewport
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -22,6 +23,32 @@ class RCamera;
 class RD3d9RenderTarget;
 class RD3d9RenderQueue;
 
+// ׶üڵ޳ͳ
+struct CullingStatistics
+{
+	unsigned int u32ModelCount;					// üģ
+	unsigned int u32VisibleModelCount;
+	unsigned int u32CulledModelCount;			// ڵģ
+	unsigned int u32OccludedModelCount;			// ͨ׶üڵ޳ģ
+	unsigned int u32OccluderCount;				// դڵ
+	unsigned int u32OccluderTriangleCount;
+	unsigned int u32VisibleRenderUnitCount;		// ȾеȾԪDP
+	unsigned int u32CulledRenderUnitCount;		// üȾԪʡDP
+
+	CullingStatistics() :
+		u32ModelCount(0),
+		u32VisibleModelCount(0),
+		u32CulledModelCount(0),
+		u32OccludedModelCount(0),
+		u32OccluderCount(0),
+		u32OccluderTriangleCount(0),
+		u32VisibleRenderUnitCount(0),
+		u32CulledRenderUnitCount(0)
+	{
+
+	}
+};
+
 class RD3d9Viewport : public RObject
 {
 public:
@@ -43,6 +70,8 @@ public:
 	FORCE_INLINE void					SetRenderTarget(RD3d9RenderTarget* pTarget)		{ m_pRenderTarget = pTarget; };
 	FORCE_INLINE RD3d9RenderTarget*		GetRenderTarget()		const					{ return m_pRenderTarget; };
 	FORCE_INLINE float					GetMaxZ()				const					{ return m_D3dViewport.MaxZ; };
+	FORCE_INLINE void					SetCullingStatistics(const CullingStatistics& statistics)	{ m_CullingStatistics = statistics; };
+	FORCE_INLINE const CullingStatistics& GetCullingStatistics()	const					{ return m_CullingStatistics; };
 
 private:
 	D3DVIEWPORT9		m_D3dViewport;
@@ -51,4 +80,6 @@ private:
 
 	RCamera*			m_pCamera;					// Viewport󶨵Camera
 	RD3d9RenderTarget*	m_pRenderTarget;			// ViewportRenderTarget
+
+	CullingStatistics	m_CullingStatistics;		// һȾĲüͳ
 };
\ No newline at end of file
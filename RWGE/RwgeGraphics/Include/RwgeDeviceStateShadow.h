@@ -0,0 +1,165 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-26
+	DESC :
+	1.	DeviceStateShadow豸ǰ״̬Ⱦ״̬״̬ÿVertexShaderPixelShader
+		floatĴ붥Ƶʡ״̬ǰӰеֵȽϣֵͬĵòύ
+		豸ȽϵֵԴ˲ͬĲʻֵͬʱҲԱ
+	2.	ÿRenderDeviceӵһӰӣCommandBufferִʱͨȾ״̬D3d9RenderDevice
+		װΪEffect״̬ID3DXEffectStateManagerEffectBeginPassCommitChangesõȾ״̬
+		״̬ɫ볣ĴҲͬĹ
+	3.	Ĵfloat4ȽϣֵֻıᱻύӰӷΧļĴ
+	4.	Ӱӵĳʼ״̬δ֪ģÿ״̬һʱܻύ豸Reset´ҪInvalidate
+	5.	ͳÿύ뱻˵ĴRenderSystemÿ֡ʼʱ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <d3d9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+enum EDeviceState
+{
+	EDS_RenderState,
+	EDS_SamplerState,
+	EDS_Texture,
+	EDS_VertexShader,
+	EDS_PixelShader,
+	EDS_VertexShaderConstant,
+	EDS_PixelShaderConstant,
+	EDS_VertexDeclaration,
+	EDS_StreamSource,
+	EDS_StreamSourceFreq,
+	EDS_Indices,
+
+	EDeviceState_MAX
+};
+
+// ÿ״̬ύ豸뱻˵ĴôǼĴͳ
+struct DeviceStateStatistics
+{
+	unsigned int	aryIssuedCounts[EDeviceState_MAX];
+	unsigned int	arySkippedCounts[EDeviceState_MAX];
+
+	DeviceStateStatistics()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (unsigned int i = 0; i < EDeviceState_MAX; ++i)
+		{
+			aryIssuedCounts[i] = 0;
+			arySkippedCounts[i] = 0;
+		}
+	}
+
+	unsigned int GetIssuedCount() const
+	{
+		unsigned int u32Count = 0;
+		for (unsigned int i = 0; i < EDeviceState_MAX; ++i)
+		{
+			u32Count += aryIssuedCounts[i];
+		}
+		return u32Count;
+	}
+
+	unsigned int GetSkippedCount() const
+	{
+		unsigned int u32Count = 0;
+		for (unsigned int i = 0; i < EDeviceState_MAX; ++i)
+		{
+			u32Count += arySkippedCounts[i];
+		}
+		return u32Count;
+	}
+};
+
+class RDeviceStateShadow : public RObject
+{
+public:
+	RDeviceStateShadow();
+	~RDeviceStateShadow();
+
+	void Invalidate();		// ״̬Ϊδ֪
+
+	FORCE_INLINE const DeviceStateStatistics& GetStatistics()	const	{ return m_Statistics; };
+	FORCE_INLINE void ResetStatistics()									{ m_Statistics.Reset(); };
+
+	static const char* GetStateName(EDeviceState state);
+
+	// ½ӿֵӰеֵͬʱӰӲtrueҪύ豸ֵͬʱfalse
+	bool SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value);
+	bool SetSamplerState(unsigned long u32Sampler, D3DSAMPLERSTATETYPE type, unsigned long u32Value);
+	bool SetTexture(unsigned long u32Sampler, IDirect3DBaseTexture9* pTexture);
+	bool SetVertexShader(IDirect3DVertexShader9* pVertexShader);
+	bool SetPixelShader(IDirect3DPixelShader9* pPixelShader);
+
+	// trueʱСΪһһֵıļĴֻҪύС
+	bool SetVertexShaderConstantF(unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount);
+	bool SetPixelShaderConstantF(unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount);
+
+	bool SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration);
+	bool SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride);
+	bool SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting);
+	bool SetIndices(IDirect3DIndexBuffer9* pIndexBuffer);
+
+	static const unsigned int	u32MaxRenderStates;			// D3DRENDERSTATETYPE
+	static const unsigned int	u32MaxSamplers;				// 16ز4
+	static const unsigned int	u32MaxSamplerStates;		// D3DSAMPLERSTATETYPE
+	static const unsigned int	u32MaxShaderConstants;		// vs_3_0ps_3_0floatĴ
+	static const unsigned int	u32MaxStreams;
+
+private:
+	struct ShadowValue
+	{
+		unsigned long	u32Value;
+		bool			bValid;
+	};
+
+	struct ShadowPointer
+	{
+		const void*		pValue;
+		bool			bValid;
+	};
+
+	struct ShadowStream
+	{
+		IDirect3DVertexBuffer9*	pVertexBuffer;
+		unsigned int			u32Offset;
+		unsigned int			u32Stride;
+		bool					bValid;
+	};
+
+	struct ShadowConstant
+	{
+		float			aryValues[4];
+		bool			bValid;
+	};
+
+	bool UpdateValue(ShadowValue& shadowValue, unsigned long u32Value, EDeviceState state);
+	bool UpdatePointer(ShadowPointer& shadowPointer, const void* pValue, EDeviceState state);
+	bool UpdateConstants(ShadowConstant* aryShadowConstants, unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount, EDeviceState state);
+	int GetSamplerIndex(unsigned long u32Sampler) const;		// ӳ䵽ز֮󣬳Χʱ-1
+
+	FORCE_INLINE bool Issue(EDeviceState state)		{ ++m_Statistics.aryIssuedCounts[state]; return true; };
+	FORCE_INLINE bool Skip(EDeviceState state)		{ ++m_Statistics.arySkippedCounts[state]; return false; };
+
+private:
+	ShadowValue*				m_aryRenderStates;
+	ShadowValue*				m_arySamplerStates;			// u32MaxSamplers * u32MaxSamplerStates
+	ShadowPointer*				m_aryTextures;
+	ShadowPointer				m_VertexShader;
+	ShadowPointer				m_PixelShader;
+	ShadowConstant*				m_aryVertexShaderConstants;
+	ShadowConstant*				m_aryPixelShaderConstants;
+	ShadowPointer				m_VertexDeclaration;
+	ShadowStream*				m_aryStreams;
+	ShadowValue*				m_aryStreamFrequencies;
+	ShadowPointer				m_Indices;
+
+	DeviceStateStatistics		m_Statistics;
+};
@@ -0,0 +1,54 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-29
+	DESC :
+	1.	DrawPacketһDPҪȫݣÿ󶨵Ķ㻺ƫơ塢ͼԪ
+		Ŀ㷶ΧֻD3DֵָύʱҪٷȾԪ붥
+	2.	ȾԪڰ󶨻壨BindStreamToBufferӷΧSetSubRangeʱDrawPacket֮ٸı䣻Ⱦ
+		ڴʱһݣRenderSystem˳ȡеDrawPacketύɫλͬһڴ
+	3.	32λ´СΪ64ֽڣһУ4ʵҪһʵֻв3
+		ȾԪʵ
+	4.	ṹڹʱ㣨ֽڣDrawPacketֽȼʾͬ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	u8IndexSize¼ȣԭֽУС䣻ύʱSetIndices¼У
+		ļݴͬĸʽ´
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <d3d9.h>
+#include <RwgeCoreDef.h>
+
+struct DrawPacket
+{
+	static const unsigned char u8MaxStreams = 4;
+
+	IDirect3DVertexDeclaration9*	pD3dVertexDeclaration;
+	IDirect3DIndexBuffer9*			pD3dIndexBuffer;
+	IDirect3DVertexBuffer9*			aryVertexBuffers[u8MaxStreams];
+	unsigned int					aryStreamOffsets[u8MaxStreams];		// ڶ㻺еƫֽ
+	unsigned char					aryStreamStrides[u8MaxStreams];		// С
+	unsigned char					u8StreamCount;
+	unsigned char					u8PrimitiveType;					// D3DPRIMITIVETYPE
+	unsigned char					u8IndexSize;						// һֽûʱΪ0
+	unsigned int					u32BaseVertexIndex;
+	unsigned int					u32VertexCount;
+	unsigned int					u32StartIndex;
+	unsigned int					u32PrimitiveCount;
+
+	DrawPacket()
+	{
+		RwgeZeroMemory(this, sizeof(DrawPacket));
+	}
+
+	FORCE_INLINE D3DPRIMITIVETYPE GetPrimitiveType() const { return static_cast<D3DPRIMITIVETYPE>(u8PrimitiveType); };
+	FORCE_INLINE D3DFORMAT GetIndexFormat() const { return u8IndexSize == sizeof(unsigned int) ? D3DFMT_INDEX32 : D3DFMT_INDEX16; };
+
+	FORCE_INLINE bool HasSameGeometry(const DrawPacket& other) const { return RwgeEqualMemory(this, &other, sizeof(DrawPacket)); };
+};
+
+static_assert(sizeof(void*) != 4 || sizeof(DrawPacket) <= 64, "DrawPacket must fit in a cache line.");
@@ -0,0 +1,99 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-23
+	DESC :
+	1.	DynamicBatcherÿ֡ϲСȾԪƬʰȡеUIƬȣȾԪGPUСÿ
+		ƵSetTransformCommitChangesSetStreamSourceSetIndicesDPCPUռҪ
+	2.	ȾϵͳȾҳġɫͬͬҶCanBatchȾԪDynamicBatcher
+		CPUϰǵĶ任ռ䣬дÿ֡ѭʹõĶ㻺壬һһλϵȾԪ
+		任Ϊλ
+		A.	λð任ߡߡֻ3x3֣ɫʹg_Transform.matWorld任Ľһ
+		B.	֧SSE ʱÿԪصı任ʹSIMD ָʹñʵ
+		C.	ϲĶﵽu32ParallelVertexCountʱȾԪ̳ͨ߳زб任ÿȾԪĿλ
+			ȷ֮䲻
+	3.	λʹ÷ʽʵͬNOOVERWRITEʽ׷ӣʣռ䲻ʱDISCARDʽͷʼ㰴
+		д룬ʱͨBaseVertexIndexλƫʼΪ0˲֮ͬ䲻ҪSetStreamSource
+	4.	ֵֻ֧бݱ뱣ڴ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	ٳԼĻλ壬DynamicUploader䣨RwgeDynamicUploader.hDISCARDͳһ
+		ֱӱ任Уڶд룬پʱڴ
+	2.	DynamicUploaderռ䲻ʱBatchnullptrȾϵͳЩȾԪ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include "RwgeRenderUnit.h"
+#include "RwgeVertexStream.h"
+#include "RwgeIndexStream.h"
+
+class RDynamicBatcher : public RObject
+{
+public:
+	static const unsigned int	u32MaxUnitVertexCount;		// ֵȾԪŻᱻϲ
+	static const unsigned int	u32MaxBatchVertexCount;		// һεĶޣ֤ϲ16λ
+	static const unsigned int	u32MaxBatchIndexCount;		// һε
+	static const unsigned int	u32ParallelVertexCount;		// εĶﵽֵʱб任
+
+private:
+	// ȾԪеλ
+	struct BatchEntry
+	{
+		const RRenderUnit*	pRenderUnit;
+		unsigned int		u32FirstVertex;
+		unsigned int		u32FirstIndex;
+	};
+
+	// Ҫ任Ԫ
+	struct VertexLayout
+	{
+		unsigned int				u32Stride;
+		unsigned int				u32PositionOffset;
+		std::vector<unsigned int>	vecDirectionOffsets;		// ߡߡ
+	};
+
+	// ÿֲʹһһȾԪƫʼΪ0ȾϵͳݴظSetStreamSource
+	struct RingTarget
+	{
+		VertexStream		vertexStream;
+		RRenderUnit			renderUnit;
+	};
+
+public:
+	RDynamicBatcher();
+	~RDynamicBatcher();
+
+	static bool CanBatch(const RRenderUnit& renderUnit);
+
+	/*
+	ϲȾԪڻƵȾԪһεBatch֮ǰЧռ䲻дʧʱnullptr
+	ϲĶͨDynamicUploader¼ȾϵͳУ֮¼Ļ֮ǰִ
+	@Param
+		aryRenderUnits		ҪϲȾԪ붼CanBatchҶ֮ͬͲ
+		u32Count			ȾԪ
+	*/
+	const RRenderUnit* Batch(const RRenderUnit* const* aryRenderUnits, unsigned int u32Count);
+
+private:
+	void TransformEntries(const VertexLayout& layout, unsigned int u32Begin, unsigned int u32End);
+	void WriteIndices(unsigned short* aryBatchIndices) const;
+	static void BuildVertexLayout(const RD3d9VertexDeclaration* pVertexDeclaration, VertexLayout& outLayout);
+
+private:
+	VertexLayout							m_Layout;				// ǰεĶ㲼
+	std::vector<BatchEntry>					m_vecEntries;
+	std::vector<unsigned int>				m_vecTaskEntryBegin;	// б任ʱÿĵһȾԪ
+	unsigned char*							m_pBatchVertices;		// 任ʱΪǰеĶ
+
+	std::map<unsigned int, RingTarget>		m_mapRingTargets;
+	IndexStream								m_RingIndexStream;
+	D3DXMATRIX								m_matIdentity;
+};
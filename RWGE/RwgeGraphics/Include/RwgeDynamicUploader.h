@@ -0,0 +1,60 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	DynamicUploaderΪÿ֡дṩֻдʵ󡢶̬ĶCPUƤдĶ
+		Լ֮ӣͬһDYNAMIC㻺а֡η䣬ٸԳл塢DISCARD
+	2.	DISCARDĹRwgeFrameRingAllocator.hдʹNOOVERWRITEֻڻλƶGPU ûͷſͷ
+		ķΧʱDISCARDÿ֡һΡֻһ֡ĵһдʱGPU ǷͷRenderDevice֡ΧжϣȾϵͳ
+		ÿ֡ȫִ֮EndFrame
+	3.	صλȾϵͳУڼ¼һ֮ǰдִ꣬ʱٸƵĻ壻д֮
+		ܽʹķΧֻڵǰ֡Чÿ֡ʹõĶ̬ݶһ֡д
+	4.	֡мռ䲻ʱnullptr˻صʹö̬ݵĻƷʽ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include <RwgeSingleton.h>
+#include <RwgeFrameRingAllocator.h>
+
+class RCommandBuffer;
+class RRenderDevice;
+class RD3d9VertexBuffer;
+class RD3d9IndexBuffer;
+struct IDirect3DVertexBuffer9;
+struct IDirect3DIndexBuffer9;
+
+class RDynamicUploader :
+	public RObject,
+	public Singleton<RDynamicUploader>
+{
+public:
+	RDynamicUploader(RCommandBuffer& commandBuffer, unsigned int u32VertexBufferSize = 4 * 1024 * 1024, unsigned int u32IndexBufferSize = 1024 * 1024);
+	~RDynamicUploader();
+
+	// u32Sizeֽڵֻдu32OffsetΪڻеƫƣݵu32AlignmentͨΪƫ
+	void* WriteVertices(unsigned int u32Size, unsigned int u32Alignment, unsigned int& u32Offset);
+	void* WriteIndices(unsigned int u32Size, unsigned int& u32Offset);
+
+	void EndFrame(RRenderDevice& device);		// Ϊǰ֡ΧͷGPU Ѿִϵ֡
+
+	IDirect3DVertexBuffer9* GetD3dVertexBuffer() const;
+	IDirect3DIndexBuffer9* GetD3dIndexBuffer() const;
+	FORCE_INLINE unsigned int GetVertexBufferSize()				const { return m_VertexRing.GetCapacity(); };
+	FORCE_INLINE unsigned int GetIndexBufferSize()				const { return m_IndexRing.GetCapacity(); };
+	FORCE_INLINE const RFrameRingAllocator& GetVertexRing()		const { return m_VertexRing; };
+	FORCE_INLINE const RFrameRingAllocator& GetIndexRing()		const { return m_IndexRing; };
+
+	void LogStatistics() const;
+
+private:
+	RCommandBuffer&			m_CommandBuffer;
+
+	RD3d9VertexBuffer*		m_pVertexBuffer;
+	RD3d9IndexBuffer*		m_pIndexBuffer;
+	RFrameRingAllocator		m_VertexRing;
+	RFrameRingAllocator		m_IndexRing;
+};
@@ -0,0 +1,154 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-27
+	DESC :
+	1.	FrameStatistics¼һȾ̵ĿDPͼԪɫʵл󶨴
+		лϴĳֽÿƲ㼶ȾԪɼ뱻üģԼȾύ
+		׶εĺʱ룩
+	2.	RenderSystemRenderOneFrameΪÿӿÿȾĿ¼һݣ֡ĺϼƼFrameStatisticsHistory
+	3.	FrameStatisticsHistory֡ĺϼƣԲѯÿͳƵСֵƽֵֵΪCSV
+		JSONļCSVÿ֡һУJSONÿͳƵķΧ֡
+	4.	ͳбţǰ׶κʱںΪļеֶ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-30
+	DESC :
+	1.	ԤȾDPԼȻƹʱ͸㼶ĸդ벻ʹԤȾʱɫ
+		OverdrawEstimatorûпʱΪ0
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+enum EFrameCounter
+{
+	EFC_DrawCallCount,
+	EFC_PrimitiveCount,
+	EFC_VertexCount,
+	EFC_ShaderSwitchCount,
+	EFC_MaterialSwitchCount,
+	EFC_TextureBindCount,
+	EFC_StreamSourceChangeCount,
+	EFC_ConstantBytes,
+	EFC_OpaqueRenderUnitCount,			// 㼶˳EDrawLayerһ
+	EFC_MaskedRenderUnitCount,
+	EFC_TranslucentRenderUnitCount,
+	EFC_VisibleModelCount,
+	EFC_CulledModelCount,
+	EFC_DepthPrepassDrawCount,			// ͬʱEFC_DrawCallCount
+	EFC_EstimatedCoveredPixels,
+	EFC_EstimatedRasterizedPixels,
+	EFC_EstimatedShadedPixels,
+
+	EFrameCounter_MAX
+};
+
+enum EFramePhase
+{
+	EFP_RenderScene,					// ¿ռüȾ
+	EFP_BuildQueue,						// ѿɼģͲȾв
+	EFP_Submit,							// ¼ȾĿͳƻEndSceneʱִʱ
+
+	EFramePhase_MAX
+};
+
+struct FrameStatistics
+{
+	unsigned int	aryCounters[EFrameCounter_MAX];
+	float			aryPhaseTimes[EFramePhase_MAX];		// 
+
+	FrameStatistics()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (unsigned int i = 0; i < EFrameCounter_MAX; ++i)
+		{
+			aryCounters[i] = 0;
+		}
+
+		for (unsigned int i = 0; i < EFramePhase_MAX; ++i)
+		{
+			aryPhaseTimes[i] = 0.0f;
+		}
+	}
+
+	void Accumulate(const FrameStatistics& statistics)
+	{
+		for (unsigned int i = 0; i < EFrameCounter_MAX; ++i)
+		{
+			aryCounters[i] += statistics.aryCounters[i];
+		}
+
+		for (unsigned int i = 0; i < EFramePhase_MAX; ++i)
+		{
+			aryPhaseTimes[i] += statistics.aryPhaseTimes[i];
+		}
+	}
+
+	float GetColumn(unsigned int u32Column) const;			// ʱͳһжȡ
+
+	static const unsigned int	u32ColumnCount;				// EFrameCounter_MAX + EFramePhase_MAX
+	static const char* GetColumnName(unsigned int u32Column);
+	static const char* GetCounterName(EFrameCounter counter);
+	static const char* GetPhaseName(EFramePhase phase);
+};
+
+// һӿһ֡еͳƣȾĿӿһ֡бȾ˳
+struct ViewportFrameStatistics
+{
+	unsigned int		u32RenderTarget;
+	unsigned int		u32Viewport;
+	FrameStatistics		statistics;
+};
+
+// һͳƵķΧ
+struct FrameStatisticsRange
+{
+	float		f32Min;
+	float		f32Average;
+	float		f32Max;
+
+	FrameStatisticsRange() : f32Min(0.0f), f32Average(0.0f), f32Max(0.0f) {};
+};
+
+class RFrameStatisticsHistory : public RObject
+{
+public:
+	RFrameStatisticsHistory();
+	~RFrameStatisticsHistory();
+
+	void SetWindowSize(unsigned int u32WindowSize);		// ı䴰ڴСѾ¼֡
+	FORCE_INLINE unsigned int GetWindowSize()	const	{ return static_cast<unsigned int>(m_vecFrames.size()); };
+	FORCE_INLINE unsigned int GetFrameCount()	const	{ return m_u32FrameCount; };			// е֡
+	FORCE_INLINE unsigned int GetTotalFrameCount() const { return m_u32TotalFrameCount; };	// ֡
+
+	void Clear();
+	void AddFrame(const FrameStatistics& statistics);
+	const FrameStatistics& GetFrame(unsigned int u32Frame) const;		// 0Ϊһ֡
+
+	FrameStatisticsRange GetCounterRange(EFrameCounter counter) const;
+	FrameStatisticsRange GetPhaseRange(EFramePhase phase) const;
+
+	bool SaveToCsv(const TCHAR* szPath) const;
+	bool SaveToJson(const TCHAR* szPath) const;
+
+	static const unsigned int	u32DefaultWindowSize;
+
+private:
+	FrameStatisticsRange GetColumnRange(unsigned int u32Column) const;
+	FORCE_INLINE unsigned int GetFirstFrameNumber() const	{ return m_u32TotalFrameCount - m_u32FrameCount; };
+
+private:
+	std::vector<FrameStatistics>	m_vecFrames;		// λ
+	unsigned int					m_u32NextFrame;		// һ֡дλ
+	unsigned int					m_u32FrameCount;
+	unsigned int					m_u32TotalFrameCount;
+};
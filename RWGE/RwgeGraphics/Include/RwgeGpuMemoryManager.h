@@ -0,0 +1,106 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	GpuMemoryManager̬ʹõԴ棺ٸԴһ壬ǴĴ󻺳壨ҳ
+		ӷ䣬ҳǾ̬壨WRITEONLYʹDYNAMICֻڼʱд룻ҳСʹһСպõҳ
+	2.	ÿҳһTlsfAllocatorRwgeTlsfAllocator.hƫƣʱ˳ҵһŵµҳµ
+		ڿǰҳУͷʱпڵĿпϲҳʱͷҳÿֻٱһҳ
+		жԴҪٵƬ
+	3.	ƫͨSetStreamSourceƫЧƫDrawPacketʱΪʼӷԻ
+		͸
+	4.	Ҫÿ֡дݣ̬ʵCPUƤĶ̬ȻʹøԵDYNAMIC壬
+	5.	GetStatisticsÿֻҳôСппƬ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	4ÿ֡дݲʹøԵDYNAMIC壬ͳһDynamicUploaderRwgeDynamicUploader.h֡η
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-04
+	DESC :
+	1.	D3D9ʽ壬32λʹEGBT_Index32ҳҳС16λͬ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include <RwgeSingleton.h>
+#include <RwgeTlsfAllocator.h>
+
+struct VertexStream;
+struct IndexStream;
+struct GpuBufferPage;
+
+enum EGpuBufferType
+{
+	EGBT_Vertex,
+	EGBT_Index,
+	EGBT_Index32,
+	EGpuBufferType_MAX
+};
+
+// һӷ䣬ͷʱʹ
+struct GpuAllocation
+{
+	GpuBufferPage*		pPage;
+	TlsfAllocation		allocation;
+
+	GpuAllocation() : pPage(nullptr) {};
+
+	FORCE_INLINE bool IsValid() const { return pPage != nullptr; };
+};
+
+struct GpuMemoryStatistics
+{
+	unsigned int	u32PageCount;
+	unsigned int	u32Capacity;				// ҳֽ
+	unsigned int	u32UsedSize;				// ѷֽĴСƣ
+	unsigned int	u32AllocationCount;
+	unsigned int	u32FreeBlockCount;
+	unsigned int	u32LargestFreeBlock;		// һη䲻ҳʱܵõֽ
+	float			f32Fragmentation;			// 1 - п / ܿдС
+
+	GpuMemoryStatistics() :
+		u32PageCount(0),
+		u32Capacity(0),
+		u32UsedSize(0),
+		u32AllocationCount(0),
+		u32FreeBlockCount(0),
+		u32LargestFreeBlock(0),
+		f32Fragmentation(0.0f)
+	{
+
+	}
+};
+
+class RGpuMemoryManager :
+	public RObject,
+	public Singleton<RGpuMemoryManager>
+{
+public:
+	RGpuMemoryManager(unsigned int u32VertexPageSize = 4 * 1024 * 1024, unsigned int u32IndexPageSize = 1024 * 1024);
+	~RGpuMemoryManager();
+
+	// 䲢дݣɹĻƫƱ
+	bool BindVertexStream(VertexStream* pVertexStream, GpuAllocation& allocation);
+	bool BindIndexStream(IndexStream* pIndexStream, GpuAllocation& allocation);
+	bool UpdateVertexStream(const GpuAllocation& allocation, VertexStream* pVertexStream) const;		// д̬ȴGPUֻںٷ޸
+	void Free(GpuAllocation& allocation);
+
+	GpuMemoryStatistics GetStatistics(EGpuBufferType type) const;
+	void LogStatistics() const;
+
+private:
+	GpuBufferPage* Allocate(EGpuBufferType type, unsigned int u32Size, TlsfAllocation& allocation);
+
+private:
+	static const unsigned int		u32Alignment;
+
+	std::vector<GpuBufferPage*>		m_aryPages[EGpuBufferType_MAX];
+	unsigned int					m_aryPageSizes[EGpuBufferType_MAX];
+};
@@ -2,6 +2,7 @@
 
 #include <d3dx9.h>
 #include <RwgeD3d9Device.h>
+#include <RwgeRenderDevice.h>
 
 enum EBlendMode
 {
@@ -24,4 +25,5 @@ enum EShadingMode
 
 #define g_RwgeDevice				RD3d9Device::GetInstance()							// RWGEDevice
 #define g_pD3d9Device				RD3d9Device::GetInstance().GetD3dDevice()			// D3D9Device
+#define g_pRenderDevice				(&RRenderDevice::GetInstance())						// ͼAPIöͨRenderDeviceִ
 #define g_RwgeRenderSystem			RRenderSystem::GetInstance()
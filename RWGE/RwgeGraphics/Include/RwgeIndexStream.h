@@ -2,39 +2,95 @@
    CREATE	
 	AUTH :	һ																			   DATE : 2016-05-20
 	DESC :	壬D3D ύ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-04
+	DESC :
+	1.	Ȳٹ̶Ϊ16λɹʱ;u8IndexSizeΪ24õĶ㲻65536ʱӦʹ16λ
+		SelectIndexSizeֻиʹ32λ
+	2.	aryIndicesй̶ͣȡʱʹGetIndex
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	VertexStreamͬӷΰ󶨵ȾԪϣһȾԪʱŹ黹
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
 #pragma once
 
+#include <RwgeCoreDef.h>
+#include "RwgeGpuMemoryManager.h"
+
 struct IDirect3DIndexBuffer9;
 
 struct IndexStream
 {
-	static const unsigned char	u8IndexSize = 2;	// һֽ
+	static const unsigned char	u8Index16Size = 2;					// 16λֽ
+	static const unsigned char	u8Index32Size = 4;					// 32λֽ
+	static const unsigned int	u32MaxIndex16VertexCount = 65536;	// 16λõĶ
 
+	unsigned char			u8IndexSize;					// һֽ
 	unsigned int			u32IndexCount;					// е
 	unsigned int			u32StreamSize;					// ֽ
-	unsigned short*			aryIndices;						// ָ
+	void*					aryIndices;						// ָ룬u8IndexSize
 
 	IDirect3DIndexBuffer9*	pD3dIndexBuffer;
+	unsigned int			u32StreamOffset;				// еƫֽʱΪʼ
+	GpuAllocation			allocation;						// GpuMemoryManagerеӷ
+	unsigned int			u32BindCount;					// ΰ󶨵ȾԪΪ0ʱûа
 
 	IndexStream() :
+		u8IndexSize(u8Index16Size),
 		u32IndexCount(0),
 		u32StreamSize(0),
 		aryIndices(nullptr),
-		pD3dIndexBuffer(nullptr)
+		pD3dIndexBuffer(nullptr),
+		u32StreamOffset(0),
+		u32BindCount(0)
 	{
 		
 	}
 
 	IndexStream(unsigned int u32Count, unsigned short* aryIndices) : 
+		u8IndexSize(u8Index16Size),
+		u32IndexCount(u32Count),
+		u32StreamSize(u8IndexSize * u32IndexCount),
+		aryIndices(aryIndices),
+		pD3dIndexBuffer(nullptr),
+		u32StreamOffset(0),
+		u32BindCount(0)
+	{
+
+	}
+
+	IndexStream(unsigned int u32Count, unsigned int* aryIndices) :
+		u8IndexSize(u8Index32Size),
 		u32IndexCount(u32Count),
 		u32StreamSize(u8IndexSize * u32IndexCount),
 		aryIndices(aryIndices),
-		pD3dIndexBuffer(nullptr)
+		pD3dIndexBuffer(nullptr),
+		u32StreamOffset(0),
+		u32BindCount(0)
 	{
 
 	}
+
+	FORCE_INLINE unsigned int GetIndex(unsigned int u32Index) const
+	{
+		return u8IndexSize == u8Index32Size ? static_cast<const unsigned int*>(aryIndices)[u32Index] : static_cast<const unsigned short*>(aryIndices)[u32Index];
+	}
+
+	// ӵu32FirstIndexʼݵַ
+	FORCE_INLINE const void* GetIndexData(unsigned int u32FirstIndex) const
+	{
+		return static_cast<const unsigned char*>(aryIndices) + u32FirstIndex * u8IndexSize;
+	}
+
+	// u32VertexCountʹõ
+	FORCE_INLINE static unsigned char SelectIndexSize(unsigned int u32VertexCount)
+	{
+		return u32VertexCount <= u32MaxIndex16VertexCount ? u8Index16Size : u8Index32Size;
+	}
 };
 
@@ -31,7 +31,7 @@ public:
 	const FColorRGB& GetAmbientColor()		const	{ return m_AmbientColor; };
 	const FColorRGB& GetDiffuseColor()		const	{ return m_DiffuseColor; };
 
-	virtual void UpdateWorldTransform() const override;
+	static unsigned int GetColorRevision()			{ return m_u32ColorRevision; };	// Դɫıʱһ
 
 protected:
 	FColorRGB		m_AmbientColor;
@@ -40,7 +40,10 @@ protected:
 	unsigned short	m_u16ConstantCount;
 	float*			m_aryConstants;
 
-	mutable bool	m_bConstantBufferOutOfDate;
+	mutable bool			m_bConstantBufferOutOfDate;
+	mutable unsigned int	m_u32ConstantBufferRevision;	// ³ʱԴ任İ汾
+
+	static unsigned int		m_u32ColorRevision;
 };
 
 // ڵԷ˵ΨһǷ
@@ -95,6 +95,10 @@ public:
 	FORCE_INLINE EBlendMode				GetBlendMode()				const { return m_BlendMode; };
 	FORCE_INLINE EShadingMode			GetShadingMode()			const { return m_ShadingMode; };
 
+	FORCE_INLINE unsigned short			GetSortId()					const { return m_u16SortId; };		// ʱ˳䣬Ⱦ
+
+	static FORCE_INLINE unsigned int	GetUpdateRevision()			{ return m_u32UpdateRevision; };	// ʵЧһμһ
+
 	FORCE_INLINE RD3d9Shader*			GetCachedShader()			const { return m_pCachedShader; };
 	FORCE_INLINE void SetCachedShader(RD3d9Shader* pShader)			const { m_pCachedShader = pShader; };
 
@@ -128,6 +132,10 @@ private:
 
 	MaterialKey							m_MaterialKey;				// ShaderĲ
 
+	unsigned short						m_u16SortId;
+	static unsigned short				m_u16NextSortId;
+	static unsigned int					m_u32UpdateRevision;
+
 	// һshaderʡʽйأϸ˵shaderǲֱܹʰ󶨵ģ
 	// ȣͨ£ʽ뻷صķ仯٣ÿһ֡жҪƵл
 	// ǵԭ򣬿Խshaderʰ󶨣ٶһʾ仯Ƶʽϵ͵Ƿı䣬
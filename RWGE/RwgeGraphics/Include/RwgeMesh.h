@@ -3,13 +3,20 @@
 	AUTH :	һ																			   DATE : 2016-05-23
 	DESC :	
 	1.	һģвͬĿȾԪһMesh
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-19
+	DESC :
+	1.	Ĳʱ滻ʱȫֵĲʰ汾ż1Ⱦֻڰ汾ŸıʱĲ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
 #pragma once
 
 #include <list>
+#include <RwgeCoreDef.h>
 #include <RwgeObject.h>
+#include <RwgeBounds.h>
 
 class RMaterial;
 class RRenderUnit;
@@ -26,8 +33,15 @@ public:
 	void AddRenderUnit(RRenderUnit* pPrimitive);
 	const std::list<RRenderUnit*>& GetRenderUnits();
 
+	FORCE_INLINE const RBounds& GetLocalBounds() const { return m_LocalBounds; };	// ȾԪֲΧĲ
+
+	static FORCE_INLINE unsigned int GetMaterialRevision() { return m_u32MaterialRevision; };
+
 private:
 	RMaterial* m_pMaterial;
 	std::list<RRenderUnit*> m_listPrimitives;
+	RBounds m_LocalBounds;
+
+	static unsigned int m_u32MaterialRevision;
 };
 
@@ -3,6 +3,34 @@
 	AUTH :	һ																			   DATE : 2016-05-24
 	DESC :	
 	1.	ģɶ񡢹Լ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-15
+	DESC :
+	1.	ģ͵ľֲΧΧĲһβѯʱ㣻ӵģͺַ˸ı䣬Ҫ
+		NeedUpdateLocalBounds
+	2.	ΧɾֲΧ任õֻнڵ任汾ŷıʱŻ¼㣬׶ü
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-16
+	DESC :
+	1.	ֲΧ巢ıʱ֪ͨĳԱˢģڿռеAABB
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-17
+	DESC :
+	1.	ģͿΪڵ޳ڵ壬ֻв͸ʵбŻᱻդڵѡʽOccluderMode
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-22
+	DESC :
+	1.	ģͿԱΪ̬SetStaticִо̬ʱȾԪ任ռ䣬ϲĶ
+		УϲģͲעᵽռɺɵĴģʹüȾ˺֮Ӧƶ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	λûCPUݵȾԪٱڵ壬ڵԤAddToOcclusionBufferʹͬһж
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -13,8 +41,21 @@
 #include <list>
 #include <map>
 #include <d3dx9.h>
+#include <RwgeBounds.h>
 
 class RMesh;
+class RRenderUnit;
+class ROcclusionBuffer;
+
+// ģΪڵķʽ
+enum EOccluderMode
+{
+	EOM_Auto,			// ɳĻߴԶѡĬϣ
+	EOM_Always,			// ָڵ壬ֻҪɼһᱻդ
+	EOM_Never,			// ӲΪڵ壬οյդϸ
+
+	EOccluderMode_MAX
+};
 
 struct Bone
 {
@@ -27,6 +68,7 @@ struct Bone
 class RModel : public RSceneNode
 {
 	friend class ModelFactory;
+	friend class RStaticBatcher;
 
 private:
 	RModel();
@@ -37,9 +79,38 @@ public:
 	void AddMesh(RMesh* pMesh);
 	std::list<RMesh*>& GetMeshes();
 
+	void NeedUpdateLocalBounds();
+	const RBounds& GetLocalBounds() const;
+	const RBounds& GetWorldBounds() const;
+	unsigned int GetRenderUnitCount() const;
+
+	FORCE_INLINE void SetOccluderMode(EOccluderMode mode)	{ m_OccluderMode = mode; };
+	FORCE_INLINE EOccluderMode GetOccluderMode() const		{ return m_OccluderMode; };
+	unsigned int GetOccluderTriangleCount() const;						// ΪڵΪ0ʱģͲΪڵ
+	void AddToOcclusionBuffer(ROcclusionBuffer& occlusionBuffer) const;	// ѿΪڵӵڵ
+
+	FORCE_INLINE void SetStatic(bool bStatic)	{ m_bStatic = bStatic; };
+	FORCE_INLINE bool IsStatic() const			{ return m_bStatic; };
+	FORCE_INLINE bool IsStaticBatched() const	{ return m_bStaticBatched; };		// Ѿϲ̬
+
+private:
+	void UpdateLocalBounds() const;
+	static bool IsOccluderRenderUnit(const RMesh* pMesh, const RRenderUnit* pRenderUnit);
+
 private:
 	std::list<RMesh*>					m_listMeshes;
 	std::map<std::string, Bone*>		m_mapBones;				// < >
 	std::map<std::string, Animation*>	m_mapAnimations;		// < >
+
+	mutable RBounds						m_LocalBounds;
+	mutable RBounds						m_WorldBounds;
+	mutable unsigned int				m_u32RenderUnitCount;
+	mutable unsigned int				m_u32OccluderTriangleCount;
+	mutable unsigned int				m_u32WorldBoundsRevision;	// Χʱڵ任İ汾
+	mutable bool						m_bLocalBoundsOutOfDate;
+
+	EOccluderMode						m_OccluderMode;
+	bool								m_bStatic;
+	bool								m_bStaticBatched;
 };
 
@@ -3,6 +3,30 @@
 	AUTH :	һ																			   DATE : 2016-05-24
 	DESC :	
 	1.	ģ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ʱ԰ļн洢ĶݲΪEVertexStreamLayoutĬϲֳֻλõ0
+		ԤȾֻ0ÿȡ12ֽڶ44ֽ
+	2.	ƤʹSkinnedSplit֣CPUƤÿֻ֡޸λáߣֻҪͨRRenderUnit::UpdateVertexStreamд
+		01ڵ2䡣ʱûƤʵ֣ļҲûйȨأֻṩ
+	3.	񲻲붯̬DynamicBatcherֻϲȾԪ̬ʵӰ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-04
+	DESC :
+	1.	ļMagicȣ16λ32λûMagicľļȻ16λ
+	2.	غֻɶ65536ʱʹ16λļе32λת
+	3.	ļ޷򿪡ضϡг㷶Χ߾ļĶ16λķΧʱLoadMesh¼־
+		nullptrɴ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-06
+	DESC :
+	1.	ļ֮԰8ͼ˳򣨵ΪRwgeViewOrdersûԵİ͸ɣʱ
+		֮ͬһȾԪͼ˳򣨼RwgeRenderUnit.hûͼ˳ľļӰ
+	2.	ͼ˳Ŀȷضϻг㷶Χʱ¼־ֻʹû˳
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -10,6 +34,14 @@
 
 #include "RwgeModel.h"
 
+enum EVertexStreamLayout
+{
+	EVSL_Interleaved,			// λáꡢߡ
+	EVSL_PositionSplit,			// 0λã1ꡢߡ
+	EVSL_SkinnedSplit,			// 0λã1ߡߣ01CPUƤд2
+	EVertexStreamLayout_MAX
+};
+
 class ModelFactory
 {
 public:
@@ -17,8 +49,11 @@ public:
 	static RModel* CreatePanel();
 	static RModel* CreateBox();
 
-	static RMesh*  LoadMesh(const std::string& strPath);
+	static RMesh*  LoadMesh(const std::string& strPath, EVertexStreamLayout layout = EVSL_PositionSplit);
 	static RModel* CreateZhanHun();
 
 	static RModel* LoadModel(const std::string& strPath);
+
+	// pSourceʵģͣͬһģͱηʱʹãԱϲΪʵ
+	static RModel* CloneModel(RModel* pSource);
 };
@@ -0,0 +1,184 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-24
+	DESC :
+	1.	NullRenderDeviceǲGPU RenderDeviceD3d9RenderDeviceͬĵãֻ¼ÿõĴд뻺
+		EffectֽԼDPͼԪûԿĻϷԱһ֡CPU ֵĿ
+	2.	ԴʱصļپܱãLockһʱڴ棬дݻᱻݵĿʵ
+		豸ͬ
+	3.	ͨSetCallCostΪÿģĿ룩ͨSetBufferWriteCostÿд1KB ݵĿ
+		ʱæȴӦʱ䣬ĿĬϿΪ0
+	4.	EffectǴɹɫʵ汾Ϊ
+	5.	NullRenderTargetNullRenderDeviceʹõȾĿ꣬ûSurfaceRenderSystem::CreateHeadlessRenderTarget
+		
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	֡ΧSetFenceLatencyõ֡ģGPU CPUɵΧǱΧСu32FramesĬΪ0
+		GPU ɣûԿĻ֤DynamicUploaderĻλڲͬӳµΪ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	¼ÿ崴ʱĸʽGetIndexBufferFormatڼCommandBufferȡļǷԭĸʽؽ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include "RwgeRenderDevice.h"
+#include "RwgeD3d9RenderTarget.h"
+
+enum ERenderDeviceCall
+{
+	ERDC_CreateResource,				// 塢EffectEffectPool
+	ERDC_ReleaseResource,
+	ERDC_LockBuffer,
+	ERDC_GetEffectParameter,			// ȡTechnique
+	ERDC_BeginEffect,
+	ERDC_EndEffect,
+	ERDC_CommitEffectChanges,
+	ERDC_SetEffectValue,				// SetValueSetRawValue
+	ERDC_SetEffectTexture,
+	ERDC_BeginScene,
+	ERDC_EndScene,
+	ERDC_SetRenderTarget,
+	ERDC_SetViewport,
+	ERDC_Clear,
+	ERDC_SetRenderState,
+	ERDC_SetVertexDeclaration,
+	ERDC_SetStreamSource,
+	ERDC_SetStreamSourceFreq,
+	ERDC_SetIndices,
+	ERDC_DrawIndexedPrimitive,
+
+	ERenderDeviceCall_MAX
+};
+
+// NullRenderDevice¼ĵͳƣͨResetCounters
+struct NullDeviceCounters
+{
+	unsigned int		aryCallCounts[ERenderDeviceCall_MAX];
+	unsigned long long	u64BufferBytesWritten;		// ͨLockд뻺ֽ
+	unsigned long long	u64EffectBytesWritten;		// ͨSetValueSetRawValueдEffectֽ
+	unsigned long long	u64PrimitiveCount;			// DPƵͼԪ
+
+	NullDeviceCounters()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (unsigned int i = 0; i < ERenderDeviceCall_MAX; ++i)
+		{
+			aryCallCounts[i] = 0;
+		}
+		u64BufferBytesWritten = 0;
+		u64EffectBytesWritten = 0;
+		u64PrimitiveCount = 0;
+	}
+};
+
+class RNullRenderDevice : public RRenderDevice
+{
+public:
+	RNullRenderDevice();
+	virtual ~RNullRenderDevice();
+
+	FORCE_INLINE const NullDeviceCounters& GetCounters()		const	{ return m_Counters; };
+	FORCE_INLINE void ResetCounters()									{ m_Counters.Reset(); };
+	FORCE_INLINE unsigned long long GetBufferBytesAllocated()	const	{ return m_u64BufferBytesAllocated; };	// ǰڵĻֽ
+	D3DFORMAT GetIndexBufferFormat(const IDirect3DIndexBuffer9* pIndexBuffer) const;							// ڵ巵D3DFMT_UNKNOWN
+
+	FORCE_INLINE void SetCallCost(ERenderDeviceCall call, unsigned int u32Nanoseconds)	{ m_aryCallCosts[call] = u32Nanoseconds; };
+	FORCE_INLINE void SetBufferWriteCost(unsigned int u32NanosecondsPerKB)				{ m_u32BufferWriteCostPerKB = u32NanosecondsPerKB; };
+	FORCE_INLINE void SetFenceLatency(unsigned int u32Frames)							{ m_u32FenceLatency = u32Frames; };
+
+	static const char* GetCallName(ERenderDeviceCall call);
+
+	virtual HRESULT CreateVertexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DPOOL pool, IDirect3DVertexBuffer9** ppVertexBuffer) override;
+	virtual HRESULT LockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) override;
+	virtual HRESULT UnlockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) override;
+	virtual void ReleaseVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) override;
+
+	virtual HRESULT CreateIndexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9** ppIndexBuffer) override;
+	virtual HRESULT LockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) override;
+	virtual HRESULT UnlockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) override;
+	virtual void ReleaseIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) override;
+
+	virtual HRESULT CreateVertexDeclaration(const D3DVERTEXELEMENT9* aryVertexElements, IDirect3DVertexDeclaration9** ppVertexDeclaration) override;
+	virtual void ReleaseVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) override;
+
+	virtual HRESULT CreateTextureFromFile(const TCHAR* szPath, IDirect3DTexture9** ppTexture) override;
+	virtual void ReleaseTexture(IDirect3DTexture9* pTexture) override;
+
+	virtual HRESULT CreateEffectPool(ID3DXEffectPool** ppEffectPool) override;
+	virtual void ReleaseEffectPool(ID3DXEffectPool* pEffectPool) override;
+	virtual HRESULT CreateEffectFromFile(const TCHAR* szPath, ID3DXEffectPool* pEffectPool, ID3DXEffect** ppEffect, ID3DXBuffer** ppErrorBuffer) override;
+	virtual void ReleaseEffect(ID3DXEffect* pEffect) override;
+
+	virtual D3DXHANDLE GetEffectParameterByName(ID3DXEffect* pEffect, const char* szName) override;
+	virtual D3DXHANDLE GetEffectTechniqueByName(ID3DXEffect* pEffect, const char* szName) override;
+	virtual HRESULT BeginEffect(ID3DXEffect* pEffect) override;
+	virtual HRESULT EndEffect(ID3DXEffect* pEffect) override;
+	virtual HRESULT CommitEffectChanges(ID3DXEffect* pEffect) override;
+	virtual HRESULT SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size) override;
+	virtual HRESULT SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Offset, unsigned int u32Size) override;
+	virtual HRESULT SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture) override;
+
+	virtual HRESULT BeginScene() override;
+	virtual HRESULT EndScene() override;
+	virtual HRESULT SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface) override;
+	virtual HRESULT SetViewport(const D3DVIEWPORT9* pViewport) override;
+	virtual HRESULT Clear(unsigned int u32RectCount, const D3DRECT* aryRects, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil) override;
+	virtual HRESULT SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value) override;
+	virtual HRESULT SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) override;
+	virtual HRESULT SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride) override;
+	virtual HRESULT SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting) override;
+	virtual HRESULT SetIndices(IDirect3DIndexBuffer9* pIndexBuffer) override;
+	virtual HRESULT DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount) override;
+
+	virtual unsigned int IssueFrameFence() override;
+	virtual unsigned int GetCompletedFrameFence() override;
+
+private:
+	void RecordCall(ERenderDeviceCall call);
+	void* CreateHandle();
+	HRESULT CreateBuffer(unsigned int u32Size, void** ppBuffer);
+	HRESULT LockBuffer(const void* pBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData);
+	HRESULT UnlockBuffer(const void* pBuffer);
+	void ReleaseBuffer(const void* pBuffer);
+	static void SimulateCost(unsigned long long u64Nanoseconds);
+
+private:
+	NullDeviceCounters						m_Counters;
+	unsigned int							m_aryCallCosts[ERenderDeviceCall_MAX];
+	unsigned int							m_u32BufferWriteCostPerKB;
+	unsigned int							m_u32FenceLatency;
+	unsigned int							m_u32LastFence;
+
+	unsigned int							m_u32NextHandle;
+	std::map<const void*, unsigned int>		m_mapBufferSizes;			// ֽӳ䣬ڼLockķΧ
+	unsigned long long						m_u64BufferBytesAllocated;
+	std::map<const void*, D3DFORMAT>		m_mapIndexFormats;			// ʱĸʽӳ
+
+	std::vector<unsigned char>				m_vecLockMemory;			// Lockصʱڴ
+	const void*								m_pLockedBuffer;
+	unsigned int							m_u32LockedSize;
+};
+
+class RNullRenderTarget : public RD3d9RenderTarget
+{
+	friend class RD3d9RenderSystem;
+
+private:
+	RNullRenderTarget(int s32Width, int s32Height) : RD3d9RenderTarget(s32Width, s32Height) {};
+	virtual ~RNullRenderTarget() {};
+
+public:
+	virtual IDirect3DSurface9* GetD3dSurface() override { return nullptr; };
+};
@@ -0,0 +1,148 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-17
+	DESC :
+	1.	OcclusionBufferһCPUϹդĵͷֱȻ壬ڵ޳Ȱڵ壨Occluderιդ
+		ȻУñڵ壨OccludeeĻռΧȻĲZHiZȽϣȱȾ
+		صԶȻҪԶĶһڵ
+	2.	ֵD3D һ£ΧΪ[0, 1]1ʾԶü棬ÿ֡Ϊ1
+	3.	һ̣֡BeginFrame -> AddOccluderΣ -> Rasterize -> IsOccludedΣ
+		A.	AddOccluderֻ¼ָ룬ЩRasterizeǰ뱣Ч
+		B.	RasterizeΪн׶Σ
+			I.	䣨Binningڵ屻Ϊɸÿα任üռ䡢üƽ桢ͶӰĻ
+				ߺƽ棬Ȼ󰴰ΧΰαдԼķֿ飨Tileб֮䲻κ
+			II.	դÿֿһδзڸ÷ֿΣֿ֮以صҪͬ
+		C.	դɺڵǰ߳ȻHiZÿһһ2x2еԶ
+	4.	դֻģڵ岻޳ڵ岻ҪǷյҲεĻƷ
+	5.	֧SSE ʱդÿδһе4أʹñʵ֣ߵļ˳ȫһ
+	6.	OcclusionBufferֻD3DXѧ̳߳أD3D 豸Ⱦϵͳʹ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-04
+	DESC :
+	1.	ڵ16λ32λAddOccluderu8IndexSizeָ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	դǱ룬SetSimdEnabled(false)ʱʹ֧SSE Ҳʹñʵ֣׼Աʵֵ
+		ʱ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+class ROcclusionBuffer : public RObject
+{
+public:
+	static const unsigned int u32TileWidth	= 32;		// 4ı
+	static const unsigned int u32TileHeight	= 32;
+
+private:
+	// ڵ壬ֻ¼ݵָ
+	struct Occluder
+	{
+		const unsigned char*	pPositions;
+		unsigned int			u32VertexCount;
+		unsigned int			u32Stride;
+		const void*				aryIndices;			// Ϊʱ˳ÿһ
+		unsigned int			u32IndexSize;		// ֽ24
+		unsigned int			u32TriangleCount;
+		D3DXMATRIX				worldViewProj;
+	};
+
+	// õĻռΣߺƽ涼Ϊ
+	struct TriangleSetup
+	{
+		float	aryEdgeA[3];		// ߺ E = A * x + B * y + CڲߺС0
+		float	aryEdgeB[3];
+		float	aryEdgeC[3];
+		float	f32DepthA;			// ƽ Z = A * x + B * y + C
+		float	f32DepthB;
+		float	f32DepthC;
+		int		s32MinX;			// ǵطΧ
+		int		s32MinY;
+		int		s32MaxX;
+		int		s32MaxY;
+	};
+
+	struct BinningTask
+	{
+		std::vector<TriangleSetup>				vecTriangles;
+		std::vector<std::vector<unsigned int>>	vecTileBins;		// ÿֿеα
+		std::vector<D3DXVECTOR4>				vecClipVertices;	// 任üռĶ
+	};
+
+public:
+	// ߻ȡΪֿС
+	ROcclusionBuffer(unsigned int u32Width = 256, unsigned int u32Height = 128);
+	~ROcclusionBuffer();
+
+	void BeginFrame(const D3DXMATRIX& viewProj);		// Ȼڵ
+
+	/*
+	һڵ壬ֻ֧б
+	@Param
+		pPositions			һλõĵַ
+		u32VertexCount		
+		u32Stride			λֽ֮
+		aryIndices			Ϊʱʹ
+		u8IndexSize			һֽ24
+		u32TriangleCount	
+		world				ڵ任
+	*/
+	void AddOccluder(
+		const void* pPositions,
+		unsigned int u32VertexCount,
+		unsigned int u32Stride,
+		const void* aryIndices,
+		unsigned char u8IndexSize,
+		unsigned int u32TriangleCount,
+		const D3DXMATRIX& world);
+
+	void Rasterize();		// з䡢դڵ壬HiZ
+
+	bool IsOccluded(const D3DXVECTOR3& minPoint, const D3DXVECTOR3& maxPoint) const;	// ռAABBǷȫڵƽཻʱǷfalse
+
+	FORCE_INLINE void			SetSimdEnabled(bool bEnabled)		{ m_bSimdEnabled = bEnabled; };		// ֧SSE ʱʹñʵ
+
+	FORCE_INLINE unsigned int	GetWidth()					const { return m_u32Width; };
+	FORCE_INLINE unsigned int	GetHeight()					const { return m_u32Height; };
+	FORCE_INLINE const float*	GetDepthBuffer()			const { return m_vecHiZLevels[0].data(); };		// д洢
+	FORCE_INLINE unsigned int	GetOccluderCount()			const { return static_cast<unsigned int>(m_vecOccluders.size()); };
+	FORCE_INLINE unsigned int	GetOccluderTriangleCount()	const { return m_u32OccluderTriangleCount; };		// ӵ
+	FORCE_INLINE unsigned int	GetRasterizedTriangleCount()const { return m_u32RasterizedTriangleCount; };	// üʵʹդ
+
+private:
+	void BinOccluders(BinningTask& task, unsigned int u32Begin, unsigned int u32End);
+	void SetupTriangle(BinningTask& task, const D3DXVECTOR4& v0, const D3DXVECTOR4& v1, const D3DXVECTOR4& v2);
+	void RasterizeTile(unsigned int u32Tile);
+	void RasterizeTriangle(const TriangleSetup& triangle, int s32MinX, int s32MinY, int s32MaxX, int s32MaxY);		// طΧλͬһֿ
+	void RasterizeTriangleScalar(const TriangleSetup& triangle, int s32MinX, int s32MinY, int s32MaxX, int s32MaxY);
+	void BuildHiZ();
+
+private:
+	unsigned int						m_u32Width;
+	unsigned int						m_u32Height;
+	unsigned int						m_u32TileCountX;
+	unsigned int						m_u32TileCountY;
+
+	D3DXMATRIX							m_ViewProj;
+	std::vector<Occluder>				m_vecOccluders;
+	std::vector<BinningTask>			m_vecBinningTasks;
+	std::vector<unsigned int>			m_vecTaskOccluderBegin;		// ÿĵһڵ壬һԪΪڵ
+	unsigned int						m_u32BinningTaskCount;		// ֡ʹõķ
+	bool								m_bSimdEnabled;
+
+	std::vector<std::vector<float>>		m_vecHiZLevels;		// 0Ȼ
+	std::vector<unsigned int>			m_vecLevelWidth;
+	std::vector<unsigned int>			m_vecLevelHeight;
+
+	unsigned int						m_u32OccluderTriangleCount;
+	unsigned int						m_u32RasterizedTriangleCount;
+};
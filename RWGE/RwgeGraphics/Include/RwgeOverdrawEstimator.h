@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-30
+	DESC :
+	1.	OverdrawEstimatorCPUϰύ˳һƵĹȻƣжһǷֵÿԤȾÿ
+		ΧͶӰĻľȷΧǵأһͷֱʵĸۼ
+	2.	Ըͳ
+		A.	դRasterized- ǸӵĻ֮ͣȸӶ
+		B.	ɫShaded- ʹԤȾʱͨEarly-ZҪִɫĴƵȲȸд
+			ԶʱΪһɫӵȸΪƵԶȣصΪȫ˾Σ
+		C.	Covered- ٱһƸǵĸʹԤȾʱPassÿֻɫһΣɫǸ
+	3.	ÿӴΪأɫ븲֮ԤȾʡȥɫֻʹðΧ
+		Уʵ״뱳޳ʺͬһĲ֮ͬȽ
+	4.	OcclusionBufferһֻǸģûаκθʱڵĸӣĻڵĻٸ
+		һӣƽཻĻưӿڡȷΧΪ[0, 1]
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+class RBounds;
+
+struct OverdrawEstimate
+{
+	unsigned int	u32DrawCount;			// ٸһӵĻ
+	unsigned int	u32CoveredPixels;
+	unsigned int	u32RasterizedPixels;
+	unsigned int	u32ShadedPixels;		// ʹԤȾʱɫ
+
+	OverdrawEstimate() :
+		u32DrawCount(0),
+		u32CoveredPixels(0),
+		u32RasterizedPixels(0),
+		u32ShadedPixels(0)
+	{
+
+	}
+
+	FORCE_INLINE float GetDepthComplexity()	const { return u32CoveredPixels ? static_cast<float>(u32RasterizedPixels) / u32CoveredPixels : 0.0f; };
+	FORCE_INLINE float GetShadedOverdraw()	const { return u32CoveredPixels ? static_cast<float>(u32ShadedPixels) / u32CoveredPixels : 0.0f; };	// ÿصƽɫ
+};
+
+class ROverdrawEstimator : public RObject
+{
+public:
+	// ӵı߳Ϊu32CellSizeأÿĸu32MaxCellsPerAxisʱ
+	ROverdrawEstimator(unsigned int u32CellSize = 16, unsigned int u32MaxCellsPerAxis = 128);
+	~ROverdrawEstimator();
+
+	void Begin(unsigned int u32ViewportWidth, unsigned int u32ViewportHeight);		// ոͳ
+	void AddDraw(const RBounds& localBounds, const D3DXMATRIX& worldViewProj);		// ƵľֲΧ۲ͶӰ
+	void End();			// ѸӵͳƻΪ
+
+	FORCE_INLINE const OverdrawEstimate&	GetEstimate()		const { return m_Estimate; };
+	FORCE_INLINE unsigned int				GetCellCountX()		const { return m_u32CellCountX; };
+	FORCE_INLINE unsigned int				GetCellCountY()		const { return m_u32CellCountY; };
+
+private:
+	unsigned int					m_u32CellSize;
+	unsigned int					m_u32MaxCellsPerAxis;
+	unsigned int					m_u32CellCountX;
+	unsigned int					m_u32CellCountY;
+	double							m_f64PixelsPerCell;
+
+	std::vector<float>				m_vecDepth;				// ÿдȣΪ1
+	std::vector<unsigned char>		m_vecCovered;
+
+	unsigned long long				m_u64CoveredCells;
+	unsigned long long				m_u64RasterizedCells;
+	unsigned long long				m_u64ShadedCells;
+
+	OverdrawEstimate				m_Estimate;
+};
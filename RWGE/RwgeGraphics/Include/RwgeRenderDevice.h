@@ -0,0 +1,100 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-24
+	DESC :
+	1.	RenderDeviceRenderSystemͼAPI ֮һӿڣ㻺塢塢EffectĴд
+		ͷţԼȾ״̬DPͨɣͼģе벻ֱӵIDirect3DDevice9ID3DXEffect
+	2.	Ŀǰʵ֣
+		A.	D3d9RenderDevice	- תD3D9 DeviceD3DXȾĿʱʹ
+		B.	NullRenderDevice	- GPUֻͳƵôдֽΪÿģ̶Ŀû
+								  ԿĻϷһ֡CPU ֵĿ¡üȾύ߼
+	3.	ӿȻʹD3D9ΪԴNullRenderDeviceصľֻԴܱãԴ
+		Lock/Unlock/ReleaseҲͨRenderDevice
+	4.	ӿڵĺD3D9 ĺһһӦHRESULTߵĴʽ֮ǰͬ
+	5.	RenderDeviceǵRenderSystemڴһȾĿʱͨg_pRenderDevice
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-26
+	DESC :
+	1.	ÿRenderDeviceӵһDeviceStateShadow¼ύ豸״̬CommandBufferִʱֵͨûиı
+		״̬ã˵ĵòᵽʵ֣NullRenderDeviceͳҲֻύĵ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	֡Χÿִ֡ϺIssueFrameFenceһΧصΧֵGetCompletedFrameFenceȴ
+		GPU ѾִϵΧֵDynamicUploaderݴжϻλЩΧѾٱGPU ʹ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include <RwgeSingleton.h>
+#include "RwgeDeviceStateShadow.h"
+
+class RRenderDevice :
+	public RObject,
+	public Singleton<RRenderDevice>
+{
+public:
+	RRenderDevice()				{};
+	virtual ~RRenderDevice()	{};
+
+	FORCE_INLINE RDeviceStateShadow& GetStateShadow()				{ return m_StateShadow; };
+	FORCE_INLINE const RDeviceStateShadow& GetStateShadow() const	{ return m_StateShadow; };
+
+	// ================================ Դ ================================
+	virtual HRESULT CreateVertexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DPOOL pool, IDirect3DVertexBuffer9** ppVertexBuffer) = 0;
+	virtual HRESULT LockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) = 0;
+	virtual HRESULT UnlockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) = 0;
+	virtual void ReleaseVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer) = 0;
+
+	virtual HRESULT CreateIndexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9** ppIndexBuffer) = 0;
+	virtual HRESULT LockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags) = 0;
+	virtual HRESULT UnlockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) = 0;
+	virtual void ReleaseIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer) = 0;
+
+	virtual HRESULT CreateVertexDeclaration(const D3DVERTEXELEMENT9* aryVertexElements, IDirect3DVertexDeclaration9** ppVertexDeclaration) = 0;
+	virtual void ReleaseVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) = 0;
+
+	virtual HRESULT CreateTextureFromFile(const TCHAR* szPath, IDirect3DTexture9** ppTexture) = 0;
+	virtual void ReleaseTexture(IDirect3DTexture9* pTexture) = 0;
+
+	virtual HRESULT CreateEffectPool(ID3DXEffectPool** ppEffectPool) = 0;
+	virtual void ReleaseEffectPool(ID3DXEffectPool* pEffectPool) = 0;
+	virtual HRESULT CreateEffectFromFile(const TCHAR* szPath, ID3DXEffectPool* pEffectPool, ID3DXEffect** ppEffect, ID3DXBuffer** ppErrorBuffer) = 0;
+	virtual void ReleaseEffect(ID3DXEffect* pEffect) = 0;
+
+	// ================================ Effect ================================
+	virtual D3DXHANDLE GetEffectParameterByName(ID3DXEffect* pEffect, const char* szName) = 0;
+	virtual D3DXHANDLE GetEffectTechniqueByName(ID3DXEffect* pEffect, const char* szName) = 0;		// EffectûиTechniqueʱnullptr
+	virtual HRESULT BeginEffect(ID3DXEffect* pEffect) = 0;			// BeginBeginPass(0)ĿǰTechniqueǵPass
+	virtual HRESULT EndEffect(ID3DXEffect* pEffect) = 0;			// EndPassEnd
+	virtual HRESULT CommitEffectChanges(ID3DXEffect* pEffect) = 0;
+	virtual HRESULT SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size) = 0;
+	virtual HRESULT SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Offset, unsigned int u32Size) = 0;
+	virtual HRESULT SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture) = 0;
+
+	// ================================ Ⱦ״̬ ================================
+	virtual HRESULT BeginScene() = 0;
+	virtual HRESULT EndScene() = 0;
+	virtual HRESULT SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface) = 0;
+	virtual HRESULT SetViewport(const D3DVIEWPORT9* pViewport) = 0;
+	virtual HRESULT Clear(unsigned int u32RectCount, const D3DRECT* aryRects, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil) = 0;
+	virtual HRESULT SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value) = 0;
+	virtual HRESULT SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration) = 0;
+	virtual HRESULT SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride) = 0;
+	virtual HRESULT SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting) = 0;
+	virtual HRESULT SetIndices(IDirect3DIndexBuffer9* pIndexBuffer) = 0;
+	virtual HRESULT DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount) = 0;
+
+	// ================================ ֡Χ ================================
+	virtual unsigned int IssueFrameFence() = 0;				// Ѿύ֮ΧΧֵһΧΪ1
+	virtual unsigned int GetCompletedFrameFence() = 0;		// GPU ѾִϵΧֵûɵΧʱ0
+
+protected:
+	RDeviceStateShadow		m_StateShadow;
+};
@@ -15,6 +15,68 @@
 			D3DPT_TRIANGLEFAN           = 6,
 			D3DPT_FORCE_DWORD           = 0x7fffffff,
 		} D3DPRIMITIVETYPE
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-21
+	DESC :
+	1.	ͬһڳбηʱͨݵĹ캯ȾԪʹͬĶ
+		ֻ任ͬȾаαŽһȾϵͳġɫҲͬȾԪ
+		Ϊһʵ
+	2.	αڴµļʱ䣬ֻ򣬱صʱֻٺϲĻᣬǷܺϲHasSameGeometryж
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-22
+	DESC :
+	1.	ȾԪֻʹöеһΣSetSubRangeӵu32BaseVertexIndexʼӵ
+		u32StartIndexʼʼš̬ʱعͬһ鶥лʱҪ
+		SetStreamSource
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-29
+	DESC :
+	1.	BindStreamToBufferSetSubRangeȾԪDrawPacketRwgeDrawPacket.hύʱֻʹDrawPacketȾ
+		Ԫ֮޸ļݣȾѾƵDrawPacket
+	2.	HasSameGeometryΪȽDrawPacket
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ʱÿͬĶ㣨ÿŶһԣĶ֮
+	2.	UpdateVertexStreamֻһд붥㻺壬CPUƤֻ޸ĲԵʹö֣ÿֻ֡
+		д̬RwgeModelFactory.h
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	BindStreamToBufferΪÿȾԪ壺̬ĶGpuMemoryManagerľ̬ӷ䣬
+		u32DynamicStreamMaskбǵĶCPUƤдȾԪԼDYNAMIC
+	2.	BindStreamToBufferȾԪӵЩ壬жؼʱUnbindStreamFromBuffer黹ݵ
+		ȾԪӵл壬ڼж֮ǰƳ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-03
+	DESC :
+	1.	u32DynamicStreamMaskбǵĶٷȾԪԼDYNAMICУȾϵͳÿλʱͨWriteDynamicStreams
+		CPUϵдDynamicUploaderĻλ壬޸λʹõDrawPacketƫƣλе
+		ֻڵǰ֡ЧUpdateVertexStreamԶ̬Ҫκ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-06
+	DESC :
+	1.	͸֮ûȲԣ˳ϽΪԤȼ8ͼ˳ÿһ
+		ΰ޴ϵľӺǰУͼ˳ڻ֮ͬһУi޵
+		˳ӻ֮ĵi*u32PrimitiveCount*3ʼ
+	2.	ɾֲռеĹ۲췽ķžx<0Ϊ0λy<0Ϊ1λz<0Ϊ2λSelectViewOrderռĹ۲
+		任ֲռ䣬Ⱦж԰͸ȾԪֻ滻ʹõʼ嶼
+	3.	ͼ˳ֻЧSetSubRange֮ʹã̬ϲͼ˳ȾԪ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	2016-07-022йݵȾԪҪڼж֮ǰƳһѾ󶨵ȾԪʱҲ
+		ΰ󶨣ϵu32BindCountһUnbindStreamFromBufferֻѼһһЩȾԪ
+		ʱŹ黹ӷ䲢Ļ壬ɾԴȾԪøʹѾ黹Ļ
+	2.	ͬٴεBindStreamToBufferֻüеӷ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -25,17 +87,19 @@
 #include <vector>
 #include <RwgeCoreDef.h>
 #include <RwgeObject.h>
+#include <RwgeBounds.h>
+#include "RwgeDrawPacket.h"
+#include "RwgeGpuMemoryManager.h"
 
 struct VertexStream;
 struct IndexStream;
 class RD3d9VertexDeclaration;
-class RD3d9VertexBuffer;
-class RD3d9IndexBuffer;
 
 class RRenderUnit : public RObject
 {
 public:
 	RRenderUnit();
+	explicit RRenderUnit(const RRenderUnit& geometrySource);		// geometrySourceݣ任Ҫ
 	~RRenderUnit();
 
 	FORCE_INLINE void SetVertexDeclaration(RD3d9VertexDeclaration* pVertexDeclaration)	{ m_pVertexDeclaration = pVertexDeclaration; };
@@ -51,11 +115,36 @@ public:
 	FORCE_INLINE const std::vector<VertexStream*>&			GetVertexStreams()		const { return m_vecVertexStreams; };
 	FORCE_INLINE const IndexStream*							GetIndexStream()		const { return m_pIndexStream; };
 	FORCE_INLINE const D3DXMATRIX*							GetWorldTransform()		const { return m_pWorldTransform; };
+	FORCE_INLINE const RBounds&								GetLocalBounds()		const { return m_LocalBounds; };
+	FORCE_INLINE unsigned short								GetGeometrySortId()		const { return m_u16GeometrySortId; };
+	FORCE_INLINE unsigned int								GetBaseVertexIndex()	const { return m_u32BaseVertexIndex; };
+	FORCE_INLINE unsigned int								GetStartIndex()			const { return m_u32StartIndex; };
+	FORCE_INLINE const DrawPacket&							GetDrawPacket()			const { return m_DrawPacket; };
+	FORCE_INLINE unsigned int								GetDynamicStreamMask()	const { return m_u32DynamicStreamMask; };
+	FORCE_INLINE bool										HasViewOrders()			const { return m_bViewOrders; };
+
+	bool HasSameGeometry(const RRenderUnit& other) const;			// ȾԪʹͬһʵ
 
 	void AddVertexStream(VertexStream* pVertexStream);
-	void BindStreamToBuffer();
+	void BindStreamToBuffer(unsigned int u32DynamicStreamMask = 0);		// iλΪ1ĶÿλʱдDynamicUploaderĻλ
+	void UnbindStreamFromBuffer();										// ͷŶ󶨵ãһù黹Ļ
+	bool UpdateVertexStream(unsigned char u8StreamID);					// CPUϱ޸֮ãֻдһ
+	bool WriteDynamicStreams(DrawPacket& drawPacket) const;				// ǰдdrawPacketʹõĶ̬ռ䲻ʱfalse
+	void SetSubRange(unsigned int u32BaseVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount);	// Ѿ󶨵ʱʹ
 
-//private:
+	bool SetViewOrdersEnabled(bool bEnabled);							// ڻ֮ͼ˳ʱʹãʱfalse
+	unsigned int GetViewOrderStartIndex(unsigned int u32Octant) const;	// u32Octantͼ˳еʼ滻DrawPacketеu32StartIndex
+
+	// ۲췽򣨴ָ壩ھֲռڵ
+	static unsigned int SelectViewOrder(const D3DXVECTOR3& viewDirection, const D3DXMATRIX& worldTransform);
+
+	static const unsigned char u8ViewOrderCount = 8;					// ÿһͼ˳
+
+	static FORCE_INLINE unsigned int GetVertexRevision() { return m_u32VertexRevision; };	// ȾԪUpdateVertexStreamʱһ
+
+private:
+	void UpdateLocalBounds();		// ݶеĶλüֲΧ
+	void BakeDrawPacket();			// 󶨵֮DrawPacket
 	//void UpdatePrimitiveCount();
 
 private:
@@ -63,13 +152,24 @@ private:
 	D3DPRIMITIVETYPE					m_PrimitiveType;
 	unsigned int						m_u32PrimitiveCount;
 	unsigned int						m_u32VertexCount;
+	unsigned int						m_u32BaseVertexIndex;			// ʹõĵһڶеı
+	unsigned int						m_u32StartIndex;				// ʹõĵһеı
 
 	std::vector<VertexStream*>			m_vecVertexStreams;
 	IndexStream*						m_pIndexStream;
 
-	RD3d9VertexBuffer*					m_pVertexBuffer;
-	RD3d9IndexBuffer*					m_pIndexBuffer;
+	unsigned int						m_u32DynamicStreamMask;			// iλΪ1ʾiǶ̬
+	bool								m_bBound;						// 󶨵һãʱ黹
+	bool								m_bViewOrders;					// ڻ֮u8ViewOrderCountͼ˳
 
 	const D3DXMATRIX*					m_pWorldTransform;				// ͼԪ任
+
+	RBounds								m_LocalBounds;					// BindStreamToBufferʱһ
+
+	DrawPacket							m_DrawPacket;					// BindStreamToBufferSetSubRangeʱ
+
+	unsigned short						m_u16GeometrySortId;			// Ⱦ򣬹ݵȾԪͬ
+	static unsigned short				m_u16NextGeometrySortId;
+	static unsigned int					m_u32VertexRevision;
 };
 
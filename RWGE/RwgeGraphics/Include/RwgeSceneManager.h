@@ -5,6 +5,58 @@
 	1.	ֱӲȾ
 		A.	֯ṹ
 		B.	ӿڽͼԪüͼԪȾ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-15
+	DESC :
+	1.	ʱֻռģԼǵΧ壨SoAʹ׶üֻпɼģͲŻᱻ
+		ȾУüͳݼ¼Viewport
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-16
+	DESC :
+	1.	ʹö̬AABBΪռģͱ󶨵ʱעᵽУӳƳͷʱעȾʱ
+		
+		A.	TransformStoreºֻ任¼ģͣԼùNeedUpdateLocalBounds / AddMeshģͲŻ
+			ˢеAABBģûκο
+		B.	׶ѯȫλ׶ڵģֱӿɼ׶ཻ߽ģʹΧһü˲ü
+			Χȫһ
+	2.	ռͬʱṩ߲ѯAABBصѯѯǰȵUpdateSpatialIndex֤뵱ǰĳһ
+	3.	TransformStoreֻ¼һUpdate¼ı任˳еб任Ӧɳ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-17
+	DESC :
+	1.	׶ü֮ӿѡڵ޳ĬϹرգ
+		A.	ӿɼģѡڵ壺OccluderModeΪEOM_AlwaysģǱѡУEOM_AutoģͰĻߴ磨Χ뾶
+			֮ȣӴСѡιĻߴСģͲѡѡеԤ
+		B.	ڵ屻դOcclusionBufferУɼģ͵ΧHiZȽϣȫڵģͲȾ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-22
+	DESC :
+	1.	سԵBuildStaticBatchesбΪ̬ģͺϲΪ̬ΣRStaticBatcher
+		A.	ɵĴģͰڳڵµһרýڵϣͨģһעᵽռУزü
+		B.	ϲģʹӿռע֮ʹ°󶨵ҲעᣬֱClearStaticBatches
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-05
+	DESC :
+	1.	ȾΪÿ֡һεĳÿͼһεĲü빹ӿڹ۲ͬһʱı任ռ
+		עģ͵б볡ɫֵֻһΣ
+		A.	BeginFrame¿ռȡһ֮֡עģ볡ĸıǣ֡Ⱦжʹ
+		B.	CullViewʹͼԼSceneViewüֻȡռģ͵Χ壨BeginFrame֮ǶѾ
+			ģд볡ͼڲͬ߳ͬʱ
+		C.	BuildViewQueueڵ޳ѿɼģͲͼȾУڵShaderManagerֻһݣֻܴ
+			ã֮ɵ߶ȾSortֻȾԼݣͬͼȾпԲ
+	2.	Ⱦֻܽ֡бעģͣһ֡֡ûйȾ´ιʱ
+	3.	RenderSceneε漸裬ÿεöµһֻ֡һͼ۲һ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	ͬһTransformStoreΪTransformStoreĸ¼ÿUpdate֪ͨм¼ڱ
+		ģͣUpdateSpatialIndexʱͳһˢ£UpdateĸĴβѯģ©ģ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -12,8 +64,15 @@
 
 #include <hash_map>
 #include <list>
+#include <vector>
 #include <RwgeObject.h>
+#include <RwgeFrustum.h>
+#include <RwgeDynamicAabbTree.h>
+#include "RwgeOcclusionBuffer.h"
+#include "RwgeStaticBatcher.h"
 #include "RwgeShaderKey.h"
+#include "RwgeD3d9Viewport.h"
+#include "RwgeTransformStore.h"
 
 class RSceneNode;
 class RCamera;
@@ -23,8 +82,27 @@ class RD3d9RenderQueue;
 class RLight;
 class RenderTarget;
 
-class RSceneManager : public RObject
+// һͼĲüɵΪÿͼ֮֡临ڴ
+struct SceneView
 {
+	RCamera*					pCamera;
+	std::vector<RModel*>		vecCandidateModels;		// ׶ཻ߽Ҫһüģ
+	BoundsBatch					candidateBounds;		// vecCandidateModelsһһӦΧ
+	std::vector<unsigned char>	vecVisibleFlags;
+	std::vector<RModel*>		vecVisibleModels;
+	std::vector<unsigned int>	vecQueryStack;			// ѯռʱʹõջ
+	CullingStatistics			statistics;
+
+	SceneView() : pCamera(nullptr) {};
+};
+
+class RSceneManager :
+	public RObject,
+	public RTransformUpdateListener
+{
+	friend class RSceneNode;
+	friend class RModel;
+
 public:
 	RSceneManager();
 	~RSceneManager();
@@ -32,14 +110,65 @@ public:
 	RSceneNode* GetSceneRoot() const;
 	void RenderScene(RCamera* pCamera, RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue);
 
+	void BeginFrame();										// ÿ֡һΣ֮ܲüͼ
+	void CullView(SceneView& view) const;					// ׶üڶ߳ͬʱ
+	void BuildViewQueue(SceneView& view, RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue);	// еãȾ
+	FORCE_INLINE unsigned int GetFrameIndex() const			{ return m_u32FrameIndex; };
+	FORCE_INLINE unsigned int GetRevision() const			{ return m_u32Revision; };		// עᡢעģͣģͰΧԴıʱһ
+
 	void SetLight(RLight* pLight);
 	const RLight* GetLight() const;
 
 	RCamera* GetActiveCamera();
 
+	FORCE_INLINE void SetFrustumCullingEnabled(bool bEnabled)	{ m_bFrustumCullingEnabled = bEnabled; };
+	FORCE_INLINE bool IsFrustumCullingEnabled() const			{ return m_bFrustumCullingEnabled; };
+
+	FORCE_INLINE void SetOcclusionCullingEnabled(bool bEnabled)	{ m_bOcclusionCullingEnabled = bEnabled; };
+	FORCE_INLINE bool IsOcclusionCullingEnabled() const			{ return m_bOcclusionCullingEnabled; };
+
+	/*
+	ԶѡڵĲ
+	@Param
+		f32MinScreenSize			Χ뾶뵽֮СڸֵģͲᱻԶѡ
+		u32MaxTrianglesPerOccluder	ֵģͲᱻԶѡ
+		u32TriangleBudget			ÿ֡դޣEOM_AlwaysģͲƵͬռԤ
+	*/
+	void SetOccluderSelection(float f32MinScreenSize, unsigned int u32MaxTrianglesPerOccluder, unsigned int u32TriangleBudget);
+	FORCE_INLINE const ROcclusionBuffer& GetOcclusionBuffer() const	{ return m_OcclusionBuffer; };
+
+	void UpdateSpatialIndex();		// ³ڵ任ˢ·ıģڿռеAABB
+
+	/*
+	߲ѯཻģͣûཻģʱnullptr
+	@Param
+		origin				
+		direction			߷򣬾ԷĳΪλ
+		f32MaxDistance		ѯ
+		pOutDistance		Ϊʱľ
+	*/
+	RModel* RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, float f32MaxDistance, float* pOutDistance = nullptr);
+	void QueryModelsInAabb(const D3DXVECTOR3& minPoint, const D3DXVECTOR3& maxPoint, std::vector<RModel*>& vecOutModels);	// ΧAABBصģ
+
+	FORCE_INLINE const RDynamicAabbTree& GetSpatialIndex() const	{ return m_SpatialIndex; };
+	FORCE_INLINE unsigned int GetLastRefittedProxyCount() const		{ return m_u32LastRefittedProxyCount; };	// һUpdateSpatialIndexˢµģ
+	FORCE_INLINE unsigned int GetLastReinsertedProxyCount() const	{ return m_u32LastReinsertedProxyCount; };	// гFat AABB²
+
+	void BuildStaticBatches();		// ϲбΪ̬δϲģ
+	void ClearStaticBatches();		// ͷž̬Σϲģעᵽռ
+	FORCE_INLINE RStaticBatcher& GetStaticBatcher()								{ return m_StaticBatcher; };
+	FORCE_INLINE const StaticBatchStatistics& GetStaticBatchStatistics() const	{ return m_StaticBatcher.GetStatistics(); };
+
 private:
-	void FindModelsInSceneTree(RSceneNode* pNode, RD3d9RenderQueue& renderQueue);
+	void RegisterNode(RSceneNode* pNode);				// ڵģʱעᵽռ
+	void UnregisterNode(RSceneNode* pNode);
+	void NotifyModelBoundsChanged(RModel* pModel);		// ģ͵ľֲΧ巢ı
+	void RefreshProxy(unsigned int u32TransformHandle);
+	virtual void OnTransformsUpdated(const RTransformStore& transformStore) override;	// ¼任¼ģ
+	static Aabb GetProxyAabb(const RModel* pModel);
+	void OcclusionCullModels(SceneView& view);		// view.vecVisibleModelsƳڵģ
 	const SceneKey& GetSceneKey();
+	static void CollectStaticModels(RSceneNode* pNode, std::vector<RModel*>& vecOutModels);
 
 private:
 	RSceneNode* m_pRoot;
@@ -49,5 +178,49 @@ private:
 
 	bool m_bSceneChanged;	// ӰshaderĻǷı
 	SceneKey m_SceneKey;
+
+	bool m_bFrustumCullingEnabled;
+	SceneView m_SceneView;		// RenderSceneʹõͼ
+
+	unsigned int				m_u32FrameIndex;			// ÿBeginFrame1
+	bool						m_bFrameSceneChanged;		// ֡ĳɫֵ˸ı
+	unsigned int				m_u32Revision;
+	std::vector<unsigned int>	m_vecFrameUnregisteredHandles;	// һ֮֡עģͣ֡ȾжҪɾ
+
+	// ģڿռеļ¼任
+	struct ModelProxy
+	{
+		unsigned int u32Proxy;
+		unsigned int u32RenderUnitCount;
+		bool bTransformChanged;		// Ѿ¼m_vecTransformChangedHandlesУUpdate֮ظ¼
+	};
+
+	RDynamicAabbTree			m_SpatialIndex;
+	std::vector<ModelProxy>		m_vecHandleToProxy;			// ûעľӦu32ProxyΪRDynamicAabbTree::u32NullNode
+	std::vector<unsigned int>	m_vecBoundsChangedHandles;	// ֲΧ巢ıģ͵ı任
+	std::vector<unsigned int>	m_vecTransformChangedHandles;	// һUpdateSpatialIndex֮任¼ģ͵ı任
+	std::vector<unsigned int>	m_vecUnregisteredHandles;	// ӳƳģ͵ı任һ֡ȾɾǵĻ
+	unsigned int				m_u32RenderUnitCount;		// עģ͵ȾԪ֮ͣͳƱüȾԪ
+	unsigned int				m_u32LastRefittedProxyCount;
+	unsigned int				m_u32LastReinsertedProxyCount;
+
+	// ڵ޳
+	struct OccluderCandidate
+	{
+		float			f32ScreenSize;
+		unsigned int	u32VisibleIndex;		// ͼĿɼģеλ
+	};
+
+	bool							m_bOcclusionCullingEnabled;
+	ROcclusionBuffer				m_OcclusionBuffer;
+	std::vector<OccluderCandidate>	m_vecOccluderCandidates;
+	std::vector<unsigned char>		m_vecOccluderFlags;			// ͼĿɼģһһӦǱѡΪڵģ
+	float							m_f32OccluderMinScreenSize;
+	unsigned int					m_u32MaxTrianglesPerOccluder;
+	unsigned int					m_u32OccluderTriangleBudget;
+
+	// ̬ģʱҪӿռעڿռ֮
+	RSceneNode*						m_pStaticBatchRoot;			// ģ͵ĸڵ㣬һκʱ
+	RStaticBatcher					m_StaticBatcher;
 };
 
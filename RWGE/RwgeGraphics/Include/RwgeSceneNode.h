@@ -19,6 +19,21 @@
 		Ϊ˳ʱ룩䷽ϵУʹִĴָָתᣬָȭָָķΪת
 		ϵУ򻻳֣
 	9.	Ĭ£峡ڵǰΪZϷΪYҷΪX
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-12
+	DESC :
+	1.	ռ任ȫRTransformStoreڵֻһ任л任
+	2.	56е֪ͨƱTransformStoreλȡڵ㷢任ʱֻȾǰTransformStore
+		бǵѯ任ʱֻӽڵ㲻һ֡ӳ٣NOTIFY_CHILDREN_WHEN_TRANSFORM
+		֮Ƴ
+	3.	Ĳ㼶ϵm_pParentm_listChildrenȻɳڵάʹã󶨹ϵͬTransformStore
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-16
+	DESC :
+	1.	ڵ㱻󶨵ߴӳƳʱm_pSceneManager֮ı䣬еģͬʱעᵽ
+		Ŀռлߴע
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -27,10 +42,9 @@
 #include <list>
 #include <d3dx9.h>
 #include <RwgeQuaternion.h>
+#include <RwgeCoreDef.h>
 #include <RwgeObject.h>
 
-#define NOTIFY_CHILDREN_WHEN_TRANSFORM	0
-
 enum ETransformSpace
 {
 	TS_World,
@@ -89,18 +103,11 @@ public:
 	const RQuaternion&		GetWorldOrientation	() const;		// صǰڵϵеķ
 	const D3DXVECTOR3&		GetScale			() const;		// صǰڵԸڵ
 	const D3DXVECTOR3&		GetWorldScale		() const;		// صǰڵϵе
-	const D3DXMATRIX&		GetTransform		() const;		// صǰڵ任
+	D3DXMATRIX				GetTransform		() const;		// صǰڵ任
 	const D3DXMATRIX&		GetWorldTransform	() const;		// صǰڵ任
+	unsigned int			GetWorldRevision	() const;		// صǰڵ任İ汾ţж任ĻǷ
 
-	virtual void UpdateWorldTransform() const;	// WorldPositionWorldOrientationWorldScale
-	void UpdateCachedTransform() const;
-	virtual void UpdateCachedWorldTransform() const;
-
-	void NeedUpdate();
-	void NotifyParentToUpdate();
-	void NotifyChildrenToUpdate();
-
-	void UpdateSelfAndAllChildren(bool bForceUpdate = false) const;		// µǰڵԼҪµӽڵ
+	FORCE_INLINE unsigned int GetTransformHandle() const { return m_u32TransformHandle; };
 
 	static D3DXMATRIX* SetTransform(
 		D3DXMATRIX& pOut, 
@@ -117,33 +124,16 @@ public:
 	bool GetInheritRotation() const;
 	bool GetInheritScale() const;
 
-protected:
-			RSceneManager*			m_pSceneManager;
-			ENodeType				m_NodeType;
-
-			D3DXVECTOR3				m_Position;				// ڸڵλ
-			RQuaternion				m_Orientation;			// ڸڵתתΪڵĵǰλ
-			D3DXVECTOR3				m_Scale;				// ڸڵţŻΪڵĵǰλ
-	mutable D3DXMATRIX				m_Transform;			// ڸڵϵı任
+private:
+	void SetInheritFlag(unsigned char u8Flag, bool bInherit);
+	void SetSceneManager(RSceneManager* pSceneManager);		// ݹĳ
 
-	mutable D3DXVECTOR3				m_WorldPosition;		// ϵλ
-	mutable RQuaternion				m_WorldOrientation;		// ϵת
-	mutable D3DXVECTOR3				m_WorldScale;			// ϵ
-	mutable D3DXMATRIX				m_WorldTransform;		// ϵı任
-
-			RSceneNode*				m_pParent;
-			std::list<RSceneNode*>	m_listChildren;
-	mutable std::list<RSceneNode*>	m_listChildrenToUpdate;
-
-	mutable bool					m_bParentHasNotified;				// ǷѾ֪ͨڵı
-	mutable bool					m_bNeedAllChildrenUpdate;			// ǷҪеӽڵ
-
-	mutable bool					m_bWorldTransformChanged;			// ǷҪµǰڵ任
-	mutable bool					m_bCachedTransformOutOfDate;		// ı任Ƿ
-	mutable bool					m_bCachedWorldTransformOutOfDate;	// 任Ƿ
+protected:
+	RSceneManager*			m_pSceneManager;
+	ENodeType				m_NodeType;
 
-	bool							m_bInheritTranslation;	// ̳иڵλ
-	bool							m_bInheritRotation;		// ̳иڵת
-	bool							m_bInheritScale;		// ̳иڵ
-};
+	unsigned int			m_u32TransformHandle;	// ռ任RTransformStoreеľ
 
+	RSceneNode*				m_pParent;
+	std::list<RSceneNode*>	m_listChildren;
+};
\ No newline at end of file
@@ -30,6 +30,18 @@
 	DESC :	
 	1.	޷stringͱֵ0ַᱻΪֹºݶʧԪǴ0 ʼģ
 		Ҫ¶һTexturesToTextureUnitsMapڱԪӳϵ
+
+	UPDATE	
+	AUTH :	һ																			   DATE : 2016-06-21
+	DESC :	
+	1.	GlobalKey ʵֶΣShaderInstancingKey ӦɫеSHADER_INSTANCING꣬ʵɫһ
+		аʵȡȾϵͳںϲͬĻʱʹ
+
+	UPDATE
+	AUTH :	һ																			   DATE : 2016-06-30
+	DESC :
+	1.	GlobalKey ֶΣShaderDepthOnlyKey ӦɫеSHADER_DEPTH_ONLY꣬ɫֻλã
+		Ⱦϵͳڲ͸㼶ԤȾʹ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -117,11 +129,15 @@ private:
 	class GlobalKeyField
 	{
 	public:
-		FORCE_INLINE void SetShaderSkinKey(bool bKey)	{ m_u8ShaderSkinKey &= ZeroMaskBit1; m_u8ShaderSkinKey |= static_cast<unsigned char>(bKey); };
-		FORCE_INLINE bool GetShaderSkinKey()	const	{ return m_u8ShaderSkinKey & ValueMaskBit1; };
+		FORCE_INLINE void SetShaderSkinKey(bool bKey)			{ m_u8ShaderSkinKey &= ZeroMaskBit1; m_u8ShaderSkinKey |= static_cast<unsigned char>(bKey); };
+		FORCE_INLINE void SetShaderInstancingKey(bool bKey)		{ m_u8ShaderSkinKey &= ZeroMaskBit2; m_u8ShaderSkinKey |= static_cast<unsigned char>(bKey) << 1; };
+		FORCE_INLINE void SetShaderDepthOnlyKey(bool bKey)		{ m_u8ShaderSkinKey &= ZeroMaskBit3; m_u8ShaderSkinKey |= static_cast<unsigned char>(bKey) << 2; };
+		FORCE_INLINE bool GetShaderSkinKey()			const	{ return m_u8ShaderSkinKey & ValueMaskBit1; };
+		FORCE_INLINE bool GetShaderInstancingKey()		const	{ return (m_u8ShaderSkinKey >> 1) & ValueMaskBit1; };
+		FORCE_INLINE bool GetShaderDepthOnlyKey()		const	{ return (m_u8ShaderSkinKey >> 2) & ValueMaskBit1; };
 
 	private:
-		unsigned char m_u8ShaderSkinKey;				// ӵλλ1bit-ɫƤ7bit-ֶ
+		unsigned char m_u8ShaderSkinKey;				// ӵλλ1bit-ɫƤ1bit-ʵ1bit-ֻȣ5bit-ֶ
 		unsigned char m_u8ReservedKey;
 	};
 
@@ -222,6 +238,8 @@ public:
 	FORCE_INLINE void SetTextureMapHashKey(unsigned int pKey)		{ m_Value.Fields.MaterialKey.SetTextureMapHashKey(pKey); };
 	FORCE_INLINE void SetLightTypeKey(unsigned char u8Key)			{ m_Value.Fields.SceneKey.SetLightTypeKey(u8Key); };
 	FORCE_INLINE void SetShaderSkinKey(bool bKey)					{ m_Value.Fields.GlobalKey.SetShaderSkinKey(bKey); };
+	FORCE_INLINE void SetShaderInstancingKey(bool bKey)				{ m_Value.Fields.GlobalKey.SetShaderInstancingKey(bKey); };
+	FORCE_INLINE void SetShaderDepthOnlyKey(bool bKey)				{ m_Value.Fields.GlobalKey.SetShaderDepthOnlyKey(bKey); };
 
 	FORCE_INLINE unsigned char		GetBaseColorKey()		const	{ return m_Value.Fields.MaterialKey.GetBaseColorKey(); };
 	FORCE_INLINE unsigned char		GetEmissiveColorKey()	const	{ return m_Value.Fields.MaterialKey.GetEmissiveColorKey(); };
@@ -240,6 +258,8 @@ public:
 	FORCE_INLINE unsigned int		GetTextureMapHashKey()	const	{ return m_Value.Fields.MaterialKey.GetTextureMapHashKey(); };
 	FORCE_INLINE unsigned char		GetLightTypeKey()		const	{ return m_Value.Fields.SceneKey.GetLightTypeKey(); };
 	FORCE_INLINE bool				GetShaderSkinKey()		const	{ return m_Value.Fields.GlobalKey.GetShaderSkinKey(); };
+	FORCE_INLINE bool				GetShaderInstancingKey()	const	{ return m_Value.Fields.GlobalKey.GetShaderInstancingKey(); };
+	FORCE_INLINE bool				GetShaderDepthOnlyKey()		const	{ return m_Value.Fields.GlobalKey.GetShaderDepthOnlyKey(); };
 
 	FORCE_INLINE void SetMaterialKey(const MaterialKey& key);
 	FORCE_INLINE void SetSceneKey(const SceneKey& key);
@@ -273,6 +293,7 @@ private:
 	// ZeroMaskϡ롱ڽunsigned charĳλ0
 	static const unsigned char ZeroMaskBit1		= b08(1111, 1110);
 	static const unsigned char ZeroMaskBit2		= b08(1111, 1101);
+	static const unsigned char ZeroMaskBit3		= b08(1111, 1011);
 	static const unsigned char ZeroMaskBit7		= b08(1011, 1111);
 	static const unsigned char ZeroMaskBit1To3	= b08(1111, 1000);
 	static const unsigned char ZeroMaskBit1To4	= b08(1111, 0000);
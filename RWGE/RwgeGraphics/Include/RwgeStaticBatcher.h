@@ -0,0 +1,134 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-22
+	DESC :
+	1.	StaticBatcherڼسѱΪ̬ģͺϲΪĴ󶥵̬DP붥㻺塢
+		
+		A.	ϲģ͵ȾԪģ͵任Ԥȱ任ռ䣨λð任ߡߡ߰߱任
+		B.	ȾԪʣڵ巽ʽ飬ÿΪһΣһεжͬһ鶥У
+			ͬһУеÿأClusterֻʹеһ
+		C.	еȾԪΧĵMortonٰΧ뾶λΪأÿڿռ
+			ǽյģÿһģͣעᵽĿռУ֮ȻԴΪλ׶ü
+			޳
+	2.	ֻȫȾԪϲģͲŻᱻϲбλáȻ
+		ڴУ͸ģҪ򣬲ϲ
+	3.	صڴصĵһ㣬ʱͨBaseVertexIndexλ˴صĶܳ16λķΧ
+	4.	StaticBatcherֻΣϲģ͵עעɳ𣨼RSceneManager::BuildStaticBatches
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-02
+	DESC :
+	1.	εĶGpuMemoryManagerľ̬ӷ䣬Clearʱ黹
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include "RwgeModel.h"
+#include "RwgeGpuMemoryManager.h"
+
+
+class RMesh;
+class RMaterial;
+class RRenderUnit;
+class RSceneNode;
+class RD3d9VertexDeclaration;
+struct VertexStream;
+struct IndexStream;
+
+// ̬ͳݣϲǰDPģͿɼ
+struct StaticBatchStatistics
+{
+	unsigned int	u32SourceModelCount;			// ϲģ
+	unsigned int	u32SourceRenderUnitCount;		// ϲȾԪϲǰDP
+	unsigned int	u32SourceBufferCount;			// ϲȾԪʹõĶ㻺
+	unsigned int	u32SkippedModelCount;			// Ϊ̬ϲģ
+	unsigned int	u32BatchCount;					// 
+	unsigned int	u32ClusterCount;				// صϲDP
+	unsigned int	u32BufferCount;					// ϲĶԴеķ
+
+	StaticBatchStatistics() :
+		u32SourceModelCount(0),
+		u32SourceRenderUnitCount(0),
+		u32SourceBufferCount(0),
+		u32SkippedModelCount(0),
+		u32BatchCount(0),
+		u32ClusterCount(0),
+		u32BufferCount(0)
+	{
+
+	}
+};
+
+class RStaticBatcher : public RObject
+{
+private:
+	// ϲȾԪ
+	struct SourceUnit
+	{
+		RRenderUnit*		pRenderUnit;
+		D3DXMATRIX			worldTransform;
+		D3DXVECTOR3			worldCenter;
+		float				f32WorldRadius;
+		unsigned int		u32MortonCode;
+	};
+
+	// һΣʡڵ巽ʽͬȾԪϲ
+	struct StaticBatch
+	{
+		RMaterial*								pMaterial;
+		const RD3d9VertexDeclaration*			pVertexDeclaration;
+		EOccluderMode							occluderMode;
+		std::vector<SourceUnit>					vecSourceUnits;
+
+		std::vector<std::vector<unsigned char>>	vecStreamData;		// ÿĶ
+		std::vector<unsigned short>				vecIndices;
+		std::vector<VertexStream*>				vecVertexStreams;
+		IndexStream*							pIndexStream;
+		std::vector<GpuAllocation>				vecVertexAllocations;
+		GpuAllocation							indexAllocation;
+
+		std::vector<RModel*>					vecClusters;
+	};
+
+public:
+	RStaticBatcher();
+	~RStaticBatcher();
+
+	/*
+	ûִصޣеĵһȾԪ
+	@Param
+		u32MaxVertexCount	жޣܳ65536
+		f32MaxRadius		صΧ뾶
+	*/
+	void SetClusterLimits(unsigned int u32MaxVertexCount, float f32MaxRadius);
+
+	/*
+	ϲģͣϲģ׷ӵGetBatchedModelsĩβԶεãÿεµ
+	@Param
+		vecModels			Ҫϲģͣģ͵任Ѿ
+		pClusterParent		ɵĴģͱ󶨵ڵ
+	*/
+	void Build(const std::vector<RModel*>& vecModels, RSceneNode* pClusterParent);
+	void Clear();		// ͷģͣϲģͻָΪδϲ״̬
+
+	FORCE_INLINE const std::vector<RModel*>&		GetBatchedModels()	const { return m_vecBatchedModels; };
+	FORCE_INLINE const StaticBatchStatistics&		GetStatistics()		const { return m_Statistics; };
+
+private:
+	bool CanBatchModel(RModel* pModel) const;
+	void BuildClusters(StaticBatch& batch, RSceneNode* pClusterParent);
+	static void AppendSourceUnit(StaticBatch& batch, const SourceUnit& sourceUnit, unsigned int u32ClusterBaseVertex);	// ȾԪ任ռ׷ӵε
+	static unsigned int GetSourceVertexCount(const RRenderUnit* pRenderUnit);
+
+private:
+	std::vector<StaticBatch*>		m_vecBatches;
+	std::vector<RModel*>			m_vecBatchedModels;
+	unsigned int					m_u32MaxClusterVertexCount;
+	float							m_f32MaxClusterRadius;
+	StaticBatchStatistics			m_Statistics;
+};
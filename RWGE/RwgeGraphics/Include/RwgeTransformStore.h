@@ -0,0 +1,202 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-12
+	DESC :
+	1.	TransformStoreд洢гڵĿռ任ݣڵֻһָݵľ
+	2.	ݰSoAķʽֲ֯λơֲתֲšλơתš任󡢸ڵ
+		̳б־ֱڸԵУʱֻҪ飬Գû
+	3.	еĽڵ㰴ճУ֤ڵһӽڵ֮ǰһжһ
+		A.	任ʱֻҪһԱĳڵʱĸڵһѾ
+		B.	ĳڵ㷢任ʱֻҪʱ[Index, SubtreeEnd)ᱻһ䴦
+	4.	ڵʹλ洢ʱ԰32λΪλûз仯Ľڵ
+	5.	Ľṹı䣨ͷš󶨡ڵ㣩ʱ飬һUpdateʱͳһţǰѯ
+		任Ӱ죬ΪڵǰʼЧ
+	6.	ڽڵڱֲ䣬ʱֻҪ¾ӳ
+	7.	ѯ任ʱڵȽڵ㱻Ϊֻ࣬һ·ϵĽڵ㣬
+	8.	GetWorldTransformصľַڳṹıǰЧȾпһֱ֡
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-14
+	DESC :
+	1.	ӲиģʽΪParallelSplitDepthĽڵΪѳзֳɻཻÿΪһ񽻸
+		ִ̳߳УɺUpdateŷ
+		A.	СڷָȵĽڵͨ٣ڵǰ߳ди£¼ÿڵ任Ƿ˸ı
+		B.	ֻдڵݣֻȡڵԼѾϵȽڵ㣬֮䲻Ҫͬ
+		C.	ģʽ봮ģʽʹͬComputeWorldȫһ
+	2.	ָΪ0ʱʹôģʽĬϣдڴ໥ĽɫʱͨѽɫڵڵΪָ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-06-16
+	DESC :
+	1.	Updateʽ¼¼任Ľڵ㣬ֱһUpdateǰͨForEachUpdatedTransform
+		任ģ飨糡ĿռֻҪЩڵ㣬Ҫ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	TransformStoreгĵκһӦòĲѯUpdateḲһUpdateĽ
+		ֻԼUpdate֮ͻ©˵Update¼Ľڵ
+	2.	½ģʵRTransformUpdateListenerעᵽTransformStoreУÿUpdate¼˽ڵʱյ
+		֪֪ͨͨм¼ԼĵĽڵ㣬֮ͳһ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <list>
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+#include <RwgeSingleton.h>
+#include <RwgeQuaternion.h>
+
+class RTransformStore;
+
+// TransformStoreĸ£Update¼˽ڵʱãصпͨForEachUpdatedTransformθµĽ
+class RTransformUpdateListener
+{
+public:
+	RTransformUpdateListener()			{};
+	virtual ~RTransformUpdateListener()	{};
+
+	virtual void OnTransformsUpdated(const RTransformStore& transformStore) = 0;
+};
+
+class RTransformStore :
+	public RObject,
+	public SingletonLazyMode<RTransformStore>
+{
+	friend class SingletonLazyMode<RTransformStore>;
+
+public:
+	static const unsigned int u32InvalidHandle = 0xFFFFFFFF;
+
+	// ڵ̳иڵ任ı־
+	enum EInheritFlag
+	{
+		EIF_Translation = 0x01,
+		EIF_Rotation	= 0x02,
+		EIF_Scale		= 0x04,
+
+		EIF_All			= EIF_Translation | EIF_Rotation | EIF_Scale
+	};
+
+private:
+	RTransformStore();
+	~RTransformStore();
+
+public:
+	unsigned int CreateTransform();						// һڵΪյĵλ任ľ
+	void ReleaseTransform(unsigned int u32Handle);		// ͷű任ע⡿ӽڵ㲻ᱻͷţǳΪûиڵĸ
+
+	void SetParent(unsigned int u32Handle, unsigned int u32ParentHandle);	// u32ParentHandleΪu32InvalidHandleʱʾ
+	unsigned int GetParent(unsigned int u32Handle) const;
+
+	void SetLocalPosition(unsigned int u32Handle, const D3DXVECTOR3& position);
+	void SetLocalOrientation(unsigned int u32Handle, const RQuaternion& orientation);
+	void SetLocalScale(unsigned int u32Handle, const D3DXVECTOR3& scale);
+	void SetInheritFlags(unsigned int u32Handle, unsigned char u8InheritFlags);
+
+	FORCE_INLINE const D3DXVECTOR3&	GetLocalPosition	(unsigned int u32Handle) const { return m_vecLocalPosition[m_vecHandleToIndex[u32Handle]]; };
+	FORCE_INLINE const RQuaternion&	GetLocalOrientation	(unsigned int u32Handle) const { return m_vecLocalOrientation[m_vecHandleToIndex[u32Handle]]; };
+	FORCE_INLINE const D3DXVECTOR3&	GetLocalScale		(unsigned int u32Handle) const { return m_vecLocalScale[m_vecHandleToIndex[u32Handle]]; };
+	FORCE_INLINE unsigned char		GetInheritFlags		(unsigned int u32Handle) const { return m_vecInheritFlags[m_vecHandleToIndex[u32Handle]]; };
+
+	const D3DXVECTOR3&	GetWorldPosition	(unsigned int u32Handle) const;
+	const RQuaternion&	GetWorldOrientation	(unsigned int u32Handle) const;
+	const D3DXVECTOR3&	GetWorldScale		(unsigned int u32Handle) const;
+	const D3DXMATRIX&	GetWorldTransform	(unsigned int u32Handle) const;
+	unsigned int		GetWorldRevision	(unsigned int u32Handle) const;		// 任ÿ¼һΣ汾żһж任ĻǷ
+
+	void Update();		// ԱбΪǵ任
+
+	void RegUpdateListener(RTransformUpdateListener* pListener);
+	void DeRegUpdateListener(RTransformUpdateListener* pListener);
+
+	void SetParallelSplitDepth(unsigned int u32Depth);		// Ϊ0ʱرղи
+	FORCE_INLINE unsigned int GetParallelSplitDepth()	const { return m_u32ParallelSplitDepth; };
+
+	FORCE_INLINE unsigned int GetTransformCount()		const { return m_u32TransformCount; };
+	FORCE_INLINE unsigned int GetLastUpdatedCount()		const { return m_u32LastUpdatedCount; };	// һUpdate¼Ľڵ
+	FORCE_INLINE unsigned int GetChangeEpoch()			const { return m_u32ChangeEpoch; };			// ڵľֲ任򸸽ڵıʱһжϳǷҪȾ
+
+	template<typename T>
+	void ForEachUpdatedTransform(T callback) const;		// һUpdate¼ı任callbackԭΪvoid (unsigned int u32Handle)
+
+private:
+	// 任¼һ[u32Begin, u32End)
+	struct UpdatedRange
+	{
+		unsigned int u32Begin;
+		unsigned int u32End;
+	};
+
+private:
+	void RebuildOrder();								// 飬¼
+	void RebuildParallelTasks();						// ݷָ»ִнڵ
+	unsigned int UpdateDirtyRange(unsigned int u32Begin, unsigned int u32End, std::vector<UpdatedRange>& vecRanges) const;	// ڱǵ¼Ľڵ
+	void UpdateParallel();
+	void UpdateWorldOnDemand(unsigned int u32Index) const;
+	void ComputeWorld(unsigned int u32Index) const;		// ݸڵ任㵥ڵ任ǰڵѾµ
+	void MarkDirty(unsigned int u32Index);
+
+	FORCE_INLINE bool IsDirty(unsigned int u32Index) const { return (m_vecDirtyBits[u32Index >> 5] & (1u << (u32Index & 31))) != 0; };
+
+	template<typename T>
+	static void Permute(std::vector<T>& vecData, const std::vector<unsigned int>& vecNewToOld);
+
+private:
+	// 鰴ʣ˳򼴳
+			std::vector<D3DXVECTOR3>	m_vecLocalPosition;
+			std::vector<RQuaternion>	m_vecLocalOrientation;
+			std::vector<D3DXVECTOR3>	m_vecLocalScale;
+	mutable std::vector<D3DXVECTOR3>	m_vecWorldPosition;
+	mutable std::vector<RQuaternion>	m_vecWorldOrientation;
+	mutable std::vector<D3DXVECTOR3>	m_vecWorldScale;
+	mutable std::vector<D3DXMATRIX>		m_vecWorldTransform;
+	mutable std::vector<unsigned int>	m_vecWorldRevision;
+	mutable std::vector<unsigned int>	m_vecFreshStamp;		// ʱ¼޸ļԪ뵱ǰԪ˵任µ
+			std::vector<unsigned int>	m_vecParentIndex;
+			std::vector<unsigned int>	m_vecSubtreeEnd;		// Ľλã
+			std::vector<unsigned char>	m_vecInheritFlags;
+			std::vector<unsigned int>	m_vecIndexToHandle;
+			std::vector<unsigned int>	m_vecDirtyBits;			// λÿunsigned int32ڵı
+
+	// 鰴
+			std::vector<unsigned int>	m_vecHandleToIndex;		// ͷŵľӳΪu32InvalidHandle
+			std::vector<unsigned int>	m_vecParentHandle;		// ʱݸڵؽ
+			std::vector<unsigned int>	m_vecFreeHandles;
+			std::vector<unsigned int>	m_vecReleasedHandles;	// ǰͷŵľɺܱ
+
+	mutable std::vector<unsigned int>	m_vecPathScratch;		// ʱ¼
+
+	// ڲи
+			std::vector<unsigned int>	m_vecSerialNodes;		// СڷָȵĽڵ㣬
+			std::vector<unsigned int>	m_vecTaskRoots;			// ȵڷָȵĽڵ㣬ÿڵһ
+			std::vector<unsigned char>	m_vecSerialNodeChanged;	// н׶нڵ任Ƿ¼㣬
+			std::vector<unsigned int>	m_vecTaskUpdatedCount;	// ÿ¼Ľڵ
+			std::vector<std::vector<UpdatedRange>>	m_vecTaskUpdatedRanges;	// ÿ¼
+
+			std::vector<UpdatedRange>	m_vecUpdatedRanges;		// һUpdate¼
+			std::list<RTransformUpdateListener*>	m_listUpdateListeners;
+
+			unsigned int				m_u32TransformCount;	// Чı任
+			unsigned int				m_u32DirtyCount;		// ΪĽڵΪ0ʱѯֱӷ
+			unsigned int				m_u32ChangeEpoch;		// ڵ㷢任ʱһ
+			unsigned int				m_u32LastUpdatedCount;
+			unsigned int				m_u32ParallelSplitDepth;
+			bool						m_bOrderOutOfDate;		// ṹı䣬Ҫ
+};
+
+template<typename T>
+void RTransformStore::ForEachUpdatedTransform(T callback) const
+{
+	for (const UpdatedRange& range : m_vecUpdatedRanges)
+	{
+		for (unsigned int u32Index = range.u32Begin; u32Index < range.u32End; ++u32Index)
+		{
+			callback(m_vecIndexToHandle[u32Index]);
+		}
+	}
+}
@@ -7,12 +7,22 @@
 	ToDo
 	2016-05-18
 		ʱֻ֧ͨVertexDeclarationTemplateɶҪṩļضĹ
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ģĲֹϣȥأGetVertexDeclarationϣͬʱٱȽģ壬ͬǵõͬһ
+		ȾалʱʶͬĲ
+	2.	Ĭϵĵ֮⣬ṩֶ֣RwgeModelFactoryеEVertexStreamLayoutӦ
+		A.	PositionSplit0ֻλã12ֽڣ1ꡢ
+		B.	SkinnedSplit0Ϊλã1ΪߣCPUƤÿ֡д2Ϊ
+	3.	0ֻλõĶֻ0İ汾GetPositionOnlyVertexDeclarationԤȾֻҪ
+		λõPassʹʱÿֻȡ12ֽ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
 #pragma once
 
-#include <string>
 #include <map>
 #include <RwgeObject.h>
 #include <RwgeSingleton.h>
@@ -26,11 +36,22 @@ public:
 	RVertexDeclarationManager();
 	~RVertexDeclarationManager();
 
+	RD3d9VertexDeclaration* GetVertexDeclaration(const RVertexDeclarationTemplate& declarationTemplate);		// ͬģ巵ͬһ
 	RD3d9VertexDeclaration* GetDefaultVertexDeclaration();
+	RD3d9VertexDeclaration* GetPositionSplitVertexDeclaration();
+	RD3d9VertexDeclaration* GetSkinnedSplitVertexDeclaration();
+	const RD3d9VertexDeclaration* GetInstancedVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration);		// ʵ
+	const RD3d9VertexDeclaration* GetPositionOnlyVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration);	// ֻ00ֻλʱnullptr
+
+	FORCE_INLINE unsigned int GetVertexDeclarationCount() const { return m_mapVertexDeclarations.size(); };
 
 private:
 	void GenerateDefaultVertexDeclaration();
+	void GenerateSplitVertexDeclarations();
 
 private:
-	std::map<std::string, RD3d9VertexDeclaration*> m_mapVertexDeclarations;
+	std::multimap<unsigned int, RD3d9VertexDeclaration*>	m_mapVertexDeclarations;		// <ֹϣ>ϣͻʱͬһж
+	RD3d9VertexDeclaration*									m_pDefaultVertexDeclaration;
+	RD3d9VertexDeclaration*									m_pPositionSplitVertexDeclaration;
+	RD3d9VertexDeclaration*									m_pSkinnedSplitVertexDeclaration;
 };
@@ -76,6 +76,12 @@
 
 		Search "D3DVERTEXELEMENT9" in MSDN for more information.
 		https://msdn.microsoft.com/en-us/library/bb172630(VS.85).aspx
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-01
+	DESC :
+	1.	ģṩֹϣGetLayoutHashȱȽϣֶǰֶԶȥأĸÿ
+		Ԫص˳ʽͬģͬһ
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
@@ -96,7 +102,7 @@ struct VertexElement
 	// ݶԪͻȡԪصĴСλbytes
 	unsigned char GetElementSize() const;
 
-	bool operator == (const VertexElement& right)
+	bool operator == (const VertexElement& right) const
 	{
 		return u8Type == right.u8Type && u8Method == right.u8Method && u8Usage == right.u8Usage && u8UsageIndex == right.u8UsageIndex;
 	}
@@ -132,6 +138,9 @@ public:
 	FORCE_INLINE unsigned short						GetStreamVertexSize(unsigned char u8StreamID = 0)			const { return m_ElementTable[u8StreamID].u16StreamVertexSize; };
 	FORCE_INLINE const std::list<VertexElement>&	GetVertexElementListOfStream(unsigned char u8StreamID = 0)	const { return m_ElementTable[u8StreamID].listVertexElements; };
 
+	unsigned int GetLayoutHash() const;			// ˳жԪؼϣͬģϣͬ
+	bool operator == (const RVertexDeclarationTemplate& right) const;
+
 private:
 	VertexElementTable	m_ElementTable;
 
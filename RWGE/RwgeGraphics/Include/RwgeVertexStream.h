@@ -12,11 +12,19 @@
 	4.	VertexStreamVertexBuffer˵
 		VertexStreamװҪύԿĶݣVertexBufferװD3D Ķ㻺󣬶Ƕĸһ
 		ͬʱŶݣԸҪڲͬĶ㻺Уͬһʱֻܰһ壩
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	ݵȾԪͬһӷ䲻ټڰȾԪУǼڶϣu32BindCount
+		¼ΰ󶨵ȾԪһȾԪʱŹ黹ӷ䣨RwgeRenderUnit.h
 \*--------------------------------------------------------------------------------------------------------------------*/
 
 
 #pragma once
 
+#include "RwgeGpuMemoryManager.h"
+
 struct IDirect3DVertexBuffer9;
 
 struct VertexStream
@@ -29,6 +37,8 @@ struct VertexStream
 	// ============== ڶ󶨵㻺 ==============
 	IDirect3DVertexBuffer9*	pD3dVertexBuffer;	// 󶨵Ķ㻺
 	unsigned int			u32StreamOffset;	// ڶ㻺еƫֽ
+	GpuAllocation			allocation;			// ̬GpuMemoryManagerеӷ䣬̬Ч
+	unsigned int			u32BindCount;		// ΰ󶨵ȾԪΪ0ʱûа
 
 	VertexStream() :
 		u8VertexSize(0),
@@ -36,7 +46,8 @@ struct VertexStream
 		u32StreamSize(0),
 		aryVertices(nullptr),
 		pD3dVertexBuffer(nullptr),
-		u32StreamOffset(0)
+		u32StreamOffset(0),
+		u32BindCount(0)
 	{
 
 	}
@@ -47,7 +58,8 @@ struct VertexStream
 		u32StreamSize(u8VertexSize * u32VertexCount),
 		aryVertices(aryVertices),
 		pD3dVertexBuffer(nullptr),
-		u32StreamOffset(0)
+		u32StreamOffset(0),
+		u32BindCount(0)
 	{
 
 	}
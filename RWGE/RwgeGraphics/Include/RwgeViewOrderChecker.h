@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-06
+	DESC :
+	1.	ViewOrderCheckerCPUϼһȾԪ˳԰͸ǷȷڱȽϵɵͼ˳򣨼
+		RwgeRenderUnit.h˳
+	2.	ع۲췽ͶӰͶӰصȷΧཻαȻԶٻģԶڽ֮ʱ
+		Ϊһ˳ζԣȷΧཻζԣ໥߹ö㣩жܳ
+	3.	Evaluateھֲռȡu32ViewCount۲췽ͬʱͬÿ·ֱͳƻ˳밴ѡ
+		ͼ˳˳ĶÿļΪO(n^2)ֻ߼飬Ҫÿ֡
+	4.	ȾԪ뱣CPUϵλݣȿ16λ32λ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include <RwgeObject.h>
+
+class RRenderUnit;
+
+struct ViewOrderQuality
+{
+	unsigned int		u32ViewCount;
+	unsigned long long	u64OverlappingPairCount;			// ͶӰصȷΧཻζԣз֮
+	unsigned long long	u64BaseOutOfOrderCount;				// ˳˳ζ
+	unsigned long long	u64ViewOrderOutOfOrderCount;		// ͼ˳˳ζԣȾԪûͼ˳ʱ˳ͬ
+
+	ViewOrderQuality() :
+		u32ViewCount(0),
+		u64OverlappingPairCount(0),
+		u64BaseOutOfOrderCount(0),
+		u64ViewOrderOutOfOrderCount(0)
+	{
+
+	}
+
+	FORCE_INLINE float GetBaseErrorRate()		const { return u64OverlappingPairCount ? static_cast<float>(u64BaseOutOfOrderCount) / u64OverlappingPairCount : 0.0f; };
+	FORCE_INLINE float GetViewOrderErrorRate()	const { return u64OverlappingPairCount ? static_cast<float>(u64ViewOrderOutOfOrderCount) / u64OverlappingPairCount : 0.0f; };
+};
+
+class RViewOrderChecker : public RObject
+{
+public:
+	RViewOrderChecker();
+	~RViewOrderChecker();
+
+	ViewOrderQuality Evaluate(const RRenderUnit& renderUnit, unsigned int u32ViewCount, unsigned int u32Seed = 1);
+	void LogQuality(const ViewOrderQuality& quality) const;
+
+private:
+	struct ProjectedTriangle
+	{
+		D3DXVECTOR2		aryPoints[3];			// ͶӰƽϵ
+		D3DXVECTOR2		boundsMin;
+		D3DXVECTOR2		boundsMax;
+		float			f32MinDepth;
+		float			f32MaxDepth;
+		unsigned int	u32DrawOrder;			// ˳еڼ
+	};
+
+	// ĵu32StartIndexʼΰ˳ʱviewDirection˳Ķ
+	unsigned long long CountOutOfOrderPairs(const RRenderUnit& renderUnit, unsigned int u32StartIndex, const D3DXVECTOR3& viewDirection, unsigned long long& u64OverlappingPairCount);
+	static bool Overlap(const ProjectedTriangle& triangle0, const ProjectedTriangle& triangle1);
+
+private:
+	std::vector<ProjectedTriangle>		m_vecTriangles;
+};
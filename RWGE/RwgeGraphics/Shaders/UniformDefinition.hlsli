@@ -26,19 +26,72 @@ struct PrimitiveTransform
 // sharedؼͨEffect Poolڲͬshader乲
 shared PrimitiveTransform g_Transform;
 
+// ʵʱʵһУÿԪǾһУʱg_Transform.matWorldΪλ
+// g_Transform.matWorldViewProjΪ۲ͶӰ󣻶ɫڲбĩβVS_INSTANCE_INPUTͨĺȡ任
+#if SHADER_INSTANCING
+	struct InstanceInput
+	{
+		float4 worldRow0 : TEXCOORD4;
+		float4 worldRow1 : TEXCOORD5;
+		float4 worldRow2 : TEXCOORD6;
+		float4 worldRow3 : TEXCOORD7;
+	};
+
+	float4x4 GetInstanceWorld(InstanceInput instance)
+	{
+		return float4x4(instance.worldRow0, instance.worldRow1, instance.worldRow2, instance.worldRow3);
+	}
+
+#	define VS_INSTANCE_INPUT			, InstanceInput instance
+#	define GET_WORLD_TRANSFORM()		GetInstanceWorld(instance)
+#	define GET_WORLD_VIEW_PROJ()		mul(GetInstanceWorld(instance), g_Transform.matWorldViewProj)
+#else
+#	define VS_INSTANCE_INPUT
+#	define GET_WORLD_TRANSFORM()		g_Transform.matWorld
+#	define GET_WORLD_VIEW_PROJ()		g_Transform.matWorldViewProj
+#endif
+
+// ɫSHADER_DEPTH_ONLYڲ͸㼶ԤȾ֮PassʹEQUALȲԣв͸ɫ
+// GET_WORLD_VIEW_PROJ()üռλãɫļȫһ£ֵᵼر޳
+// ɫTechniqueλڰɫԼTechnique֮ǰEffectĬʹõTechnique
+#if SHADER_DEPTH_ONLY
+	float4 DepthOnlyVS(float4 inPosition : POSITION VS_INSTANCE_INPUT) : POSITION
+	{
+		return mul(inPosition, GET_WORLD_VIEW_PROJ());
+	}
+
+	float4 DepthOnlyPS() : COLOR
+	{
+		return 0;
+	}
+
+	technique DepthOnlyTechnique
+	{
+		pass DepthOnlyPass
+		{
+			AlphaBlendEnable	= FALSE;
+			AlphaTestEnable		= FALSE;
+			ZEnable				= TRUE;
+			ZFunc				= LESSEQUAL;
+			ZWriteEnable		= TRUE;
+			ColorWriteEnable	= 0;		// ȾϵͳԤȾָɫд
+#if MATERIAL_TWO_SIDED
+			CullMode			= NONE;
+#else
+			CullMode			= CCW;
+#endif
+
+			VertexShader = compile vs_3_0 DepthOnlyVS();
+			PixelShader  = compile ps_3_0 DepthOnlyPS();
+		}
+	}
+#endif
+
 // Ȼʹfloat3Ϳԣʵfloat3ҲҪռһfloat4ĴֱӶΪvectorԱCPUִݶ룬Ӷݴ
 // ToDoҪԱɫvectorתΪfloat3ʱǷʹöָ
 shared vector g_vecOppositeView;			// ָӵ㷢ķ
 
-// Դ
-#if LIGHT_TYPE == DIRECTIONAL_LIGHT
-	shared DirectionalLight g_Light;
-#elif LIGHT_TYPE == POINT_LIGHT
-	shared PointLight		g_Light
-#endif
-
-// ʳ
-Material g_Material;
+// Դg_LightLight.hlsliУʳg_MaterialMaterial.hlsli
 
 // 壬ShaderModel 3.0֧ͬʱ16
 #if TEXTURE_COUNT >= 1
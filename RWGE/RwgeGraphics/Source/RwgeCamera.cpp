@@ -9,7 +9,8 @@ RCamera::RCamera() :
 	m_f32Aspect						(800.0f / 600.0f),
 	m_f32LookNear						(2.0f),
 	m_f32LookFar						(1000.0f),
-	m_bCacheViewTransformOutOfDate	(false)
+	m_u32ViewTransformRevision		(0xFFFFFFFF),
+	m_bFrustumOutOfDate				(true)
 {
 	m_NodeType = ENT_Camera;
 
@@ -30,16 +31,21 @@ void RCamera::SetPerspective(float f32Fovy, float f32Aspect, float f32LookNear,
 	m_f32LookFar = f32LookFar;
 
 	D3DXMatrixPerspectiveFovLH(&m_ProjectionTransform, f32Fovy, f32Aspect, f32LookNear, f32LookFar);
+
+	m_bFrustumOutOfDate = true;
 }
 
 void RCamera::SetOrthogonal(float fW, float fH, float fLookNear, float fLookFar)
 {
 	D3DXMatrixOrthoLH(&m_ProjectionTransform, fW, fH, fLookNear, fLookFar);
+
+	m_bFrustumOutOfDate = true;
 }
 
 const D3DXMATRIX* RCamera::GetViewTransform() const
 {
-	if (m_bCachedWorldTransformOutOfDate || m_bCacheViewTransformOutOfDate)
+	// 任汾ŷ仯˵ͼ任
+	if (m_u32ViewTransformRevision != GetWorldRevision())
 	{
 		UpdateCachedViewTransform();
 	}
@@ -52,24 +58,31 @@ const D3DXMATRIX* RCamera::GetProjectionTransform() const
 	return &m_ProjectionTransform;
 }
 
-void RCamera::UpdateCachedWorldTransform() const
+const RFrustum& RCamera::GetFrustum() const
 {
-	__super::UpdateCachedWorldTransform();
+	// ȻȡͼͼʱὫ׶Ϊ
+	const D3DXMATRIX* pViewTransform = GetViewTransform();
 
-	// 任˸£˵ͼ任
-	m_bCacheViewTransformOutOfDate = true;
+	if (m_bFrustumOutOfDate)
+	{
+		D3DXMATRIX viewProjTransform;
+		D3DXMatrixMultiply(&viewProjTransform, pViewTransform, &m_ProjectionTransform);
+		m_Frustum.SetByViewProjection(viewProjTransform);
+
+		m_bFrustumOutOfDate = false;
+	}
+
+	return m_Frustum;
 }
 
 void RCamera::UpdateCachedViewTransform() const
 {
-	if (m_bCachedWorldTransformOutOfDate)
-	{
-		UpdateCachedWorldTransform();
-	}
-
-	RwgeAssert(D3DXMatrixInverse(&m_ViewTransform, nullptr, &m_WorldTransform));
+	// 治дRwgeAssertУRelease汾ͼ
+	D3DXMATRIX* pViewTransform = D3DXMatrixInverse(&m_ViewTransform, nullptr, &GetWorldTransform());
+	RwgeAssert(pViewTransform);
 
-	m_bCacheViewTransformOutOfDate = false;
+	m_u32ViewTransformRevision = GetWorldRevision();
+	m_bFrustumOutOfDate = true;
 }
 
 void RCamera::GetSceneShot(RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue)
@@ -0,0 +1,913 @@
+#include "RwgeCommandBuffer.h"
+
+#include <map>
+#include <climits>
+#include <fstream>
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+#include "RwgeRenderDevice.h"
+#include "RwgeD3dx9Extension.h"
+
+using namespace std;
+using namespace RwgeD3dx9Extension;
+
+const unsigned int RCommandBuffer::u32CommandAlignment = 8;
+
+namespace
+{
+	// ================================ ʽ ================================
+	struct RenderCommand
+	{
+		unsigned int	u32Command;			// ERenderCommand
+		unsigned int	u32Size;			// ֽ
+	};
+
+	struct SetRenderTargetCommand : RenderCommand
+	{
+		IDirect3DSurface9*	pSurface;
+		unsigned int		u32Index;
+	};
+
+	struct SetViewportCommand : RenderCommand
+	{
+		D3DVIEWPORT9		viewport;
+	};
+
+	struct ClearCommand : RenderCommand
+	{
+		D3DRECT				rect;
+		unsigned int		u32RectCount;
+		unsigned long		u32Flags;
+		D3DCOLOR			color;
+		float				f32Z;
+		unsigned long		u32Stencil;
+	};
+
+	struct SetRenderStateCommand : RenderCommand
+	{
+		D3DRENDERSTATETYPE	state;
+		unsigned long		u32Value;
+	};
+
+	struct EffectCommand : RenderCommand	// BeginEffectEndEffectCommitEffectChanges
+	{
+		ID3DXEffect*		pEffect;
+	};
+
+	struct SetEffectValueCommand : RenderCommand	// SetEffectValueSetEffectRawValueݽ֮
+	{
+		ID3DXEffect*		pEffect;
+		D3DXHANDLE			hParameter;
+		unsigned int		u32DataSize;
+	};
+
+	struct SetEffectTextureCommand : RenderCommand
+	{
+		ID3DXEffect*			pEffect;
+		D3DXHANDLE				hParameter;
+		IDirect3DBaseTexture9*	pTexture;
+	};
+
+	struct SetVertexDeclarationCommand : RenderCommand
+	{
+		IDirect3DVertexDeclaration9*	pVertexDeclaration;
+	};
+
+	struct SetStreamSourceCommand : RenderCommand
+	{
+		IDirect3DVertexBuffer9*	pVertexBuffer;
+		unsigned int			u32Stream;
+		unsigned int			u32Offset;
+		unsigned int			u32Stride;
+	};
+
+	struct SetStreamSourceFreqCommand : RenderCommand
+	{
+		unsigned int		u32Stream;
+		unsigned int		u32Setting;
+	};
+
+	struct SetIndicesCommand : RenderCommand
+	{
+		IDirect3DIndexBuffer9*	pIndexBuffer;
+		D3DFORMAT				format;
+	};
+
+	struct DrawIndexedPrimitiveCommand : RenderCommand
+	{
+		D3DPRIMITIVETYPE	type;
+		int					s32BaseVertexIndex;
+		unsigned int		u32MinVertexIndex;
+		unsigned int		u32VertexCount;
+		unsigned int		u32StartIndex;
+		unsigned int		u32PrimitiveCount;
+	};
+
+	struct WriteBufferCommand : RenderCommand		// WriteVertexBufferWriteIndexBufferݽ֮
+	{
+		void*				pBuffer;
+		unsigned int		u32Offset;
+		unsigned int		u32DataSize;
+		unsigned long		u32LockFlags;
+	};
+
+	FORCE_INLINE const void* GetCommandPayload(const RenderCommand* pCommand, size_t u32CommandSize)
+	{
+		return reinterpret_cast<const unsigned char*>(pCommand) + u32CommandSize;
+	}
+
+	// ÿĲṹСERenderCommand˳УȡļʱֽС
+	const unsigned int aryCommandStructSizes[] =
+	{
+		sizeof(RenderCommand),					// ERC_BeginScene
+		sizeof(RenderCommand),					// ERC_EndScene
+		sizeof(SetRenderTargetCommand),			// ERC_SetRenderTarget
+		sizeof(SetViewportCommand),				// ERC_SetViewport
+		sizeof(ClearCommand),					// ERC_Clear
+		sizeof(SetRenderStateCommand),			// ERC_SetRenderState
+		sizeof(EffectCommand),					// ERC_BeginEffect
+		sizeof(EffectCommand),					// ERC_EndEffect
+		sizeof(EffectCommand),					// ERC_CommitEffectChanges
+		sizeof(SetEffectValueCommand),			// ERC_SetEffectValue
+		sizeof(SetEffectValueCommand),			// ERC_SetEffectRawValue
+		sizeof(SetEffectTextureCommand),		// ERC_SetEffectTexture
+		sizeof(SetVertexDeclarationCommand),	// ERC_SetVertexDeclaration
+		sizeof(SetStreamSourceCommand),			// ERC_SetStreamSource
+		sizeof(SetStreamSourceFreqCommand),		// ERC_SetStreamSourceFreq
+		sizeof(SetIndicesCommand),				// ERC_SetIndices
+		sizeof(DrawIndexedPrimitiveCommand),	// ERC_DrawIndexedPrimitive
+		sizeof(WriteBufferCommand),				// ERC_WriteVertexBuffer
+		sizeof(WriteBufferCommand),				// ERC_WriteIndexBuffer
+	};
+	static_assert(sizeof(aryCommandStructSizes) / sizeof(aryCommandStructSizes[0]) == ERenderCommand_MAX, "Every render command needs a struct size.");
+
+	// ================================ ļʽ ================================
+	const unsigned int u32CommandFileMagic		= 0x42435752;		// "RWCB"
+	const unsigned int u32CommandFileVersion	= 2;
+
+	struct CommandFileHeader
+	{
+		unsigned int		u32Magic;
+		unsigned int		u32Version;
+		unsigned int		u32PointerSize;		// еľֶָȿͬλĳ֮䲻ܽļ
+		unsigned int		u32CommandCount;
+		unsigned int		u32DataSize;
+		unsigned int		u32HandleCount;
+	};
+
+	enum EHandleKind
+	{
+		EHK_Other,
+		EHK_VertexBuffer,
+		EHK_IndexBuffer
+	};
+
+	struct CommandFileHandle
+	{
+		unsigned int		u32Kind;			// EHandleKind
+		unsigned int		u32BufferSize;		// бʹõֽ
+		unsigned int		u32Format;			// D3DFORMATʽΪD3DFMT_UNKNOWN
+	};
+
+	struct HandleField
+	{
+		void**				ppHandle;
+		EHandleKind			kind;
+		unsigned int		u32UsedSize;
+		D3DFORMAT			format;				// м¼˻ĸʽʱЧ
+	};
+
+	FORCE_INLINE HandleField MakeHandleField(void** ppHandle, EHandleKind kind, unsigned int u32UsedSize, D3DFORMAT format = D3DFMT_UNKNOWN)
+	{
+		HandleField field;
+		field.ppHandle = ppHandle;
+		field.kind = kind;
+		field.u32UsedSize = u32UsedSize;
+		field.format = format;
+		return field;
+	}
+
+	// ļȡһЧֽ벢ҲʣݡСڲṹ壬ݲ
+	// ΧͨGetHandleFieldsExecuteֻԼֽ
+	bool IsValidCommand(const RenderCommand* pCommand, unsigned int u32RemainingSize, unsigned int u32Alignment)
+	{
+		if (u32RemainingSize < sizeof(RenderCommand) ||
+			pCommand->u32Command >= ERenderCommand_MAX ||
+			pCommand->u32Size % u32Alignment != 0 ||
+			pCommand->u32Size > u32RemainingSize ||
+			pCommand->u32Size < aryCommandStructSizes[pCommand->u32Command])
+		{
+			return false;
+		}
+
+		const unsigned int u32PayloadSize = pCommand->u32Size - aryCommandStructSizes[pCommand->u32Command];
+		switch (pCommand->u32Command)
+		{
+		case ERC_Clear:
+			return static_cast<const ClearCommand*>(pCommand)->u32RectCount <= 1;		// ֻһ
+
+		case ERC_SetEffectValue:
+		case ERC_SetEffectRawValue:
+			return static_cast<const SetEffectValueCommand*>(pCommand)->u32DataSize <= u32PayloadSize;
+
+		case ERC_WriteVertexBuffer:
+		case ERC_WriteIndexBuffer:
+		{
+			const WriteBufferCommand* pWriteCommand = static_cast<const WriteBufferCommand*>(pCommand);
+			return pWriteCommand->u32DataSize <= u32PayloadSize && pWriteCommand->u32Offset <= UINT_MAX - pWriteCommand->u32DataSize;
+		}
+
+		default:
+			return true;
+		}
+	}
+
+	// оֶεĵַлʱ滻һ3
+	unsigned int GetHandleFields(RenderCommand* pCommand, HandleField* aryFields)
+	{
+		switch (pCommand->u32Command)
+		{
+		case ERC_SetRenderTarget:
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&static_cast<SetRenderTargetCommand*>(pCommand)->pSurface), EHK_Other, 0);
+			return 1;
+
+		case ERC_BeginEffect:
+		case ERC_EndEffect:
+		case ERC_CommitEffectChanges:
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&static_cast<EffectCommand*>(pCommand)->pEffect), EHK_Other, 0);
+			return 1;
+
+		case ERC_SetEffectValue:
+		case ERC_SetEffectRawValue:
+		{
+			SetEffectValueCommand* pValueCommand = static_cast<SetEffectValueCommand*>(pCommand);
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&pValueCommand->pEffect), EHK_Other, 0);
+			aryFields[1] = MakeHandleField(reinterpret_cast<void**>(const_cast<char**>(&pValueCommand->hParameter)), EHK_Other, 0);
+			return 2;
+		}
+
+		case ERC_SetEffectTexture:
+		{
+			SetEffectTextureCommand* pTextureCommand = static_cast<SetEffectTextureCommand*>(pCommand);
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&pTextureCommand->pEffect), EHK_Other, 0);
+			aryFields[1] = MakeHandleField(reinterpret_cast<void**>(const_cast<char**>(&pTextureCommand->hParameter)), EHK_Other, 0);
+			aryFields[2] = MakeHandleField(reinterpret_cast<void**>(&pTextureCommand->pTexture), EHK_Other, 0);
+			return 3;
+		}
+
+		case ERC_SetVertexDeclaration:
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&static_cast<SetVertexDeclarationCommand*>(pCommand)->pVertexDeclaration), EHK_Other, 0);
+			return 1;
+
+		case ERC_SetStreamSource:
+		{
+			SetStreamSourceCommand* pStreamCommand = static_cast<SetStreamSourceCommand*>(pCommand);
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&pStreamCommand->pVertexBuffer), EHK_VertexBuffer, pStreamCommand->u32Offset + pStreamCommand->u32Stride);
+			return 1;
+		}
+
+		case ERC_SetIndices:
+		{
+			SetIndicesCommand* pIndicesCommand = static_cast<SetIndicesCommand*>(pCommand);
+			aryFields[0] = MakeHandleField(reinterpret_cast<void**>(&pIndicesCommand->pIndexBuffer), EHK_IndexBuffer, 0, pIndicesCommand->format);
+			return 1;
+		}
+
+		case ERC_WriteVertexBuffer:
+		case ERC_WriteIndexBuffer:
+		{
+			WriteBufferCommand* pWriteCommand = static_cast<WriteBufferCommand*>(pCommand);
+			EHandleKind kind = pCommand->u32Command == ERC_WriteVertexBuffer ? EHK_VertexBuffer : EHK_IndexBuffer;
+			aryFields[0] = MakeHandleField(&pWriteCommand->pBuffer, kind, pWriteCommand->u32Offset + pWriteCommand->u32DataSize);
+			return 1;
+		}
+
+		default:
+			return 0;
+		}
+	}
+}
+
+RCommandBuffer::RCommandBuffer() :
+	m_u32CommandCount(0),
+	m_u32EffectDataSize(0),
+	m_pLoadedDevice(nullptr)
+{
+	RwgeZeroMemory(m_aryCommandCounts, sizeof(m_aryCommandCounts));
+}
+
+RCommandBuffer::~RCommandBuffer()
+{
+	ReleaseLoadedResources();
+}
+
+void RCommandBuffer::Reset()
+{
+	m_vecData.clear();
+	m_u32CommandCount = 0;
+	RwgeZeroMemory(m_aryCommandCounts, sizeof(m_aryCommandCounts));
+	m_u32EffectDataSize = 0;
+}
+
+const char* RCommandBuffer::GetCommandName(ERenderCommand command)
+{
+	RwgeSymbolToStringBegin(command)
+	{
+		RwgeSymbolToString(ERC_BeginScene);
+		RwgeSymbolToString(ERC_EndScene);
+		RwgeSymbolToString(ERC_SetRenderTarget);
+		RwgeSymbolToString(ERC_SetViewport);
+		RwgeSymbolToString(ERC_Clear);
+		RwgeSymbolToString(ERC_SetRenderState);
+		RwgeSymbolToString(ERC_BeginEffect);
+		RwgeSymbolToString(ERC_EndEffect);
+		RwgeSymbolToString(ERC_CommitEffectChanges);
+		RwgeSymbolToString(ERC_SetEffectValue);
+		RwgeSymbolToString(ERC_SetEffectRawValue);
+		RwgeSymbolToString(ERC_SetEffectTexture);
+		RwgeSymbolToString(ERC_SetVertexDeclaration);
+		RwgeSymbolToString(ERC_SetStreamSource);
+		RwgeSymbolToString(ERC_SetStreamSourceFreq);
+		RwgeSymbolToString(ERC_SetIndices);
+		RwgeSymbolToString(ERC_DrawIndexedPrimitive);
+		RwgeSymbolToString(ERC_WriteVertexBuffer);
+		RwgeSymbolToString(ERC_WriteIndexBuffer);
+		RwgeSymbolToStringDefault();
+	}
+}
+
+template<typename T>
+T* RCommandBuffer::AllocateCommand(ERenderCommand command, unsigned int u32PayloadSize /* = 0 */)
+{
+	const unsigned int u32Size = (sizeof(T) + u32PayloadSize + u32CommandAlignment - 1) & ~(u32CommandAlignment - 1);
+	const unsigned int u32Offset = static_cast<unsigned int>(m_vecData.size());
+
+	// ʱȶٷڴ
+	if (u32Offset + u32Size > m_vecData.capacity())
+	{
+		m_vecData.reserve(max(m_vecData.capacity() * 2, static_cast<size_t>(u32Offset + u32Size)));
+	}
+	m_vecData.resize(u32Offset + u32Size);
+
+	T* pCommand = reinterpret_cast<T*>(m_vecData.data() + u32Offset);
+	pCommand->u32Command = command;
+	pCommand->u32Size = u32Size;
+	++m_u32CommandCount;
+	++m_aryCommandCounts[command];
+
+	return pCommand;
+}
+
+void RCommandBuffer::BeginScene()
+{
+	AllocateCommand<RenderCommand>(ERC_BeginScene);
+}
+
+void RCommandBuffer::EndScene()
+{
+	AllocateCommand<RenderCommand>(ERC_EndScene);
+}
+
+void RCommandBuffer::SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface)
+{
+	SetRenderTargetCommand* pCommand = AllocateCommand<SetRenderTargetCommand>(ERC_SetRenderTarget);
+	pCommand->pSurface = pSurface;
+	pCommand->u32Index = u32Index;
+}
+
+void RCommandBuffer::SetViewport(const D3DVIEWPORT9* pViewport)
+{
+	RwgeAssert(pViewport);
+
+	AllocateCommand<SetViewportCommand>(ERC_SetViewport)->viewport = *pViewport;
+}
+
+void RCommandBuffer::Clear(const D3DRECT* pRect, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil)
+{
+	ClearCommand* pCommand = AllocateCommand<ClearCommand>(ERC_Clear);
+	if (pRect != nullptr)
+	{
+		pCommand->rect = *pRect;
+	}
+	pCommand->u32RectCount = pRect != nullptr ? 1 : 0;
+	pCommand->u32Flags = u32Flags;
+	pCommand->color = color;
+	pCommand->f32Z = f32Z;
+	pCommand->u32Stencil = u32Stencil;
+}
+
+void RCommandBuffer::SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value)
+{
+	SetRenderStateCommand* pCommand = AllocateCommand<SetRenderStateCommand>(ERC_SetRenderState);
+	pCommand->state = state;
+	pCommand->u32Value = u32Value;
+}
+
+void RCommandBuffer::BeginEffect(ID3DXEffect* pEffect)
+{
+	AllocateCommand<EffectCommand>(ERC_BeginEffect)->pEffect = pEffect;
+}
+
+void RCommandBuffer::EndEffect(ID3DXEffect* pEffect)
+{
+	AllocateCommand<EffectCommand>(ERC_EndEffect)->pEffect = pEffect;
+}
+
+void RCommandBuffer::CommitEffectChanges(ID3DXEffect* pEffect)
+{
+	AllocateCommand<EffectCommand>(ERC_CommitEffectChanges)->pEffect = pEffect;
+}
+
+void RCommandBuffer::SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size)
+{
+	SetEffectValueCommand* pCommand = AllocateCommand<SetEffectValueCommand>(ERC_SetEffectValue, u32Size);
+	pCommand->pEffect = pEffect;
+	pCommand->hParameter = hParameter;
+	pCommand->u32DataSize = u32Size;
+	RwgeCopyMemory(pCommand + 1, pData, u32Size);
+	m_u32EffectDataSize += u32Size;
+}
+
+void RCommandBuffer::SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size)
+{
+	SetEffectValueCommand* pCommand = AllocateCommand<SetEffectValueCommand>(ERC_SetEffectRawValue, u32Size);
+	pCommand->pEffect = pEffect;
+	pCommand->hParameter = hParameter;
+	pCommand->u32DataSize = u32Size;
+	RwgeCopyMemory(pCommand + 1, pData, u32Size);
+	m_u32EffectDataSize += u32Size;
+}
+
+void RCommandBuffer::SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture)
+{
+	SetEffectTextureCommand* pCommand = AllocateCommand<SetEffectTextureCommand>(ERC_SetEffectTexture);
+	pCommand->pEffect = pEffect;
+	pCommand->hParameter = hParameter;
+	pCommand->pTexture = pTexture;
+}
+
+void RCommandBuffer::SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	AllocateCommand<SetVertexDeclarationCommand>(ERC_SetVertexDeclaration)->pVertexDeclaration = pVertexDeclaration;
+}
+
+void RCommandBuffer::SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride)
+{
+	SetStreamSourceCommand* pCommand = AllocateCommand<SetStreamSourceCommand>(ERC_SetStreamSource);
+	pCommand->pVertexBuffer = pVertexBuffer;
+	pCommand->u32Stream = u32Stream;
+	pCommand->u32Offset = u32Offset;
+	pCommand->u32Stride = u32Stride;
+}
+
+void RCommandBuffer::SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting)
+{
+	SetStreamSourceFreqCommand* pCommand = AllocateCommand<SetStreamSourceFreqCommand>(ERC_SetStreamSourceFreq);
+	pCommand->u32Stream = u32Stream;
+	pCommand->u32Setting = u32Setting;
+}
+
+void RCommandBuffer::SetIndices(IDirect3DIndexBuffer9* pIndexBuffer, D3DFORMAT format)
+{
+	SetIndicesCommand* pCommand = AllocateCommand<SetIndicesCommand>(ERC_SetIndices);
+	pCommand->pIndexBuffer = pIndexBuffer;
+	pCommand->format = format;
+}
+
+void RCommandBuffer::DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount)
+{
+	DrawIndexedPrimitiveCommand* pCommand = AllocateCommand<DrawIndexedPrimitiveCommand>(ERC_DrawIndexedPrimitive);
+	pCommand->type = type;
+	pCommand->s32BaseVertexIndex = s32BaseVertexIndex;
+	pCommand->u32MinVertexIndex = u32MinVertexIndex;
+	pCommand->u32VertexCount = u32VertexCount;
+	pCommand->u32StartIndex = u32StartIndex;
+	pCommand->u32PrimitiveCount = u32PrimitiveCount;
+}
+
+void* RCommandBuffer::WriteVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, unsigned long u32LockFlags)
+{
+	WriteBufferCommand* pCommand = AllocateCommand<WriteBufferCommand>(ERC_WriteVertexBuffer, u32Size);
+	pCommand->pBuffer = pVertexBuffer;
+	pCommand->u32Offset = u32Offset;
+	pCommand->u32DataSize = u32Size;
+	pCommand->u32LockFlags = u32LockFlags;
+
+	return pCommand + 1;
+}
+
+void* RCommandBuffer::WriteIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, unsigned long u32LockFlags)
+{
+	WriteBufferCommand* pCommand = AllocateCommand<WriteBufferCommand>(ERC_WriteIndexBuffer, u32Size);
+	pCommand->pBuffer = pIndexBuffer;
+	pCommand->u32Offset = u32Offset;
+	pCommand->u32DataSize = u32Size;
+	pCommand->u32LockFlags = u32LockFlags;
+
+	return pCommand + 1;
+}
+
+void RCommandBuffer::Execute(RRenderDevice& device, unsigned int u32BeginOffset /* = 0 */) const
+{
+	RwgeAssert(u32BeginOffset <= m_vecData.size());
+
+	const unsigned char* pData = m_vecData.data();
+	const unsigned int u32DataSize = static_cast<unsigned int>(m_vecData.size());
+	RDeviceStateShadow& stateShadow = device.GetStateShadow();		// ֵûиı״̬òύ豸
+
+	for (unsigned int u32Offset = u32BeginOffset; u32Offset < u32DataSize;)
+	{
+		const RenderCommand* pCommand = reinterpret_cast<const RenderCommand*>(pData + u32Offset);
+		u32Offset += pCommand->u32Size;
+
+		HRESULT hResult = D3D_OK;
+		switch (pCommand->u32Command)
+		{
+		case ERC_BeginScene:
+			hResult = device.BeginScene();
+			break;
+
+		case ERC_EndScene:
+			hResult = device.EndScene();
+			break;
+
+		case ERC_SetRenderTarget:
+		{
+			const SetRenderTargetCommand* pTargetCommand = static_cast<const SetRenderTargetCommand*>(pCommand);
+			hResult = device.SetRenderTarget(pTargetCommand->u32Index, pTargetCommand->pSurface);
+			break;
+		}
+
+		case ERC_SetViewport:
+			hResult = device.SetViewport(&static_cast<const SetViewportCommand*>(pCommand)->viewport);
+			break;
+
+		case ERC_Clear:
+		{
+			const ClearCommand* pClearCommand = static_cast<const ClearCommand*>(pCommand);
+			hResult = device.Clear(
+				pClearCommand->u32RectCount,
+				pClearCommand->u32RectCount != 0 ? &pClearCommand->rect : nullptr,
+				pClearCommand->u32Flags,
+				pClearCommand->color,
+				pClearCommand->f32Z,
+				pClearCommand->u32Stencil);
+			break;
+		}
+
+		case ERC_SetRenderState:
+		{
+			const SetRenderStateCommand* pStateCommand = static_cast<const SetRenderStateCommand*>(pCommand);
+			if (stateShadow.SetRenderState(pStateCommand->state, pStateCommand->u32Value))
+			{
+				hResult = device.SetRenderState(pStateCommand->state, pStateCommand->u32Value);
+			}
+			break;
+		}
+
+		case ERC_BeginEffect:
+			hResult = device.BeginEffect(static_cast<const EffectCommand*>(pCommand)->pEffect);
+			break;
+
+		case ERC_EndEffect:
+			hResult = device.EndEffect(static_cast<const EffectCommand*>(pCommand)->pEffect);
+			break;
+
+		case ERC_CommitEffectChanges:
+			hResult = device.CommitEffectChanges(static_cast<const EffectCommand*>(pCommand)->pEffect);
+			break;
+
+		case ERC_SetEffectValue:
+		{
+			const SetEffectValueCommand* pValueCommand = static_cast<const SetEffectValueCommand*>(pCommand);
+			hResult = device.SetEffectValue(
+				pValueCommand->pEffect,
+				pValueCommand->hParameter,
+				GetCommandPayload(pCommand, sizeof(SetEffectValueCommand)),
+				pValueCommand->u32DataSize);
+			break;
+		}
+
+		case ERC_SetEffectRawValue:
+		{
+			const SetEffectValueCommand* pValueCommand = static_cast<const SetEffectValueCommand*>(pCommand);
+			hResult = device.SetEffectRawValue(
+				pValueCommand->pEffect,
+				pValueCommand->hParameter,
+				GetCommandPayload(pCommand, sizeof(SetEffectValueCommand)),
+				0,
+				pValueCommand->u32DataSize);
+			break;
+		}
+
+		case ERC_SetEffectTexture:
+		{
+			const SetEffectTextureCommand* pTextureCommand = static_cast<const SetEffectTextureCommand*>(pCommand);
+			hResult = device.SetEffectTexture(pTextureCommand->pEffect, pTextureCommand->hParameter, pTextureCommand->pTexture);
+			break;
+		}
+
+		case ERC_SetVertexDeclaration:
+		{
+			IDirect3DVertexDeclaration9* pVertexDeclaration = static_cast<const SetVertexDeclarationCommand*>(pCommand)->pVertexDeclaration;
+			if (stateShadow.SetVertexDeclaration(pVertexDeclaration))
+			{
+				hResult = device.SetVertexDeclaration(pVertexDeclaration);
+			}
+			break;
+		}
+
+		case ERC_SetStreamSource:
+		{
+			const SetStreamSourceCommand* pStreamCommand = static_cast<const SetStreamSourceCommand*>(pCommand);
+			if (stateShadow.SetStreamSource(pStreamCommand->u32Stream, pStreamCommand->pVertexBuffer, pStreamCommand->u32Offset, pStreamCommand->u32Stride))
+			{
+				hResult = device.SetStreamSource(pStreamCommand->u32Stream, pStreamCommand->pVertexBuffer, pStreamCommand->u32Offset, pStreamCommand->u32Stride);
+			}
+			break;
+		}
+
+		case ERC_SetStreamSourceFreq:
+		{
+			const SetStreamSourceFreqCommand* pFreqCommand = static_cast<const SetStreamSourceFreqCommand*>(pCommand);
+			if (stateShadow.SetStreamSourceFreq(pFreqCommand->u32Stream, pFreqCommand->u32Setting))
+			{
+				hResult = device.SetStreamSourceFreq(pFreqCommand->u32Stream, pFreqCommand->u32Setting);
+			}
+			break;
+		}
+
+		case ERC_SetIndices:
+		{
+			IDirect3DIndexBuffer9* pIndexBuffer = static_cast<const SetIndicesCommand*>(pCommand)->pIndexBuffer;
+			if (stateShadow.SetIndices(pIndexBuffer))
+			{
+				hResult = device.SetIndices(pIndexBuffer);
+			}
+			break;
+		}
+
+		case ERC_DrawIndexedPrimitive:
+		{
+			const DrawIndexedPrimitiveCommand* pDrawCommand = static_cast<const DrawIndexedPrimitiveCommand*>(pCommand);
+			hResult = device.DrawIndexedPrimitive(
+				pDrawCommand->type,
+				pDrawCommand->s32BaseVertexIndex,
+				pDrawCommand->u32MinVertexIndex,
+				pDrawCommand->u32VertexCount,
+				pDrawCommand->u32StartIndex,
+				pDrawCommand->u32PrimitiveCount);
+			break;
+		}
+
+		case ERC_WriteVertexBuffer:
+		case ERC_WriteIndexBuffer:
+		{
+			const WriteBufferCommand* pWriteCommand = static_cast<const WriteBufferCommand*>(pCommand);
+			const bool bVertexBuffer = pCommand->u32Command == ERC_WriteVertexBuffer;
+
+			void* pDestinationBuffer;
+			hResult = bVertexBuffer ?
+				device.LockVertexBuffer(static_cast<IDirect3DVertexBuffer9*>(pWriteCommand->pBuffer), pWriteCommand->u32Offset, pWriteCommand->u32DataSize, &pDestinationBuffer, pWriteCommand->u32LockFlags) :
+				device.LockIndexBuffer(static_cast<IDirect3DIndexBuffer9*>(pWriteCommand->pBuffer), pWriteCommand->u32Offset, pWriteCommand->u32DataSize, &pDestinationBuffer, pWriteCommand->u32LockFlags);
+			if (FAILED(hResult))
+			{
+				break;
+			}
+
+			RwgeCopyMemory(pDestinationBuffer, GetCommandPayload(pCommand, sizeof(WriteBufferCommand)), pWriteCommand->u32DataSize);
+
+			hResult = bVertexBuffer ?
+				device.UnlockVertexBuffer(static_cast<IDirect3DVertexBuffer9*>(pWriteCommand->pBuffer)) :
+				device.UnlockIndexBuffer(static_cast<IDirect3DIndexBuffer9*>(pWriteCommand->pBuffer));
+			break;
+		}
+
+		default:
+			RwgeAssert(false);
+			break;
+		}
+
+		if (FAILED(hResult))
+		{
+			RwgeLog(TEXT("Execute render command %s failed - ErrorCode: %s"),
+				GetCommandName(static_cast<ERenderCommand>(pCommand->u32Command)),
+				D3dErrorCodeToString(hResult));
+		}
+	}
+}
+
+bool RCommandBuffer::SaveToFile(const TCHAR* szPath) const
+{
+	// Ѿ滻Ϊ1ʼıţվΪ0ͬʱ¼ÿ屻ʹõֽĸʽ
+	vector<unsigned char> vecData(m_vecData);
+	map<void*, unsigned int> mapHandleIndices;
+	vector<CommandFileHandle> vecHandles;
+
+	HandleField aryFields[3];
+	for (unsigned int u32Offset = 0; u32Offset < vecData.size();)
+	{
+		RenderCommand* pCommand = reinterpret_cast<RenderCommand*>(vecData.data() + u32Offset);
+		u32Offset += pCommand->u32Size;
+
+		unsigned int u32FieldCount = GetHandleFields(pCommand, aryFields);
+		for (unsigned int i = 0; i < u32FieldCount; ++i)
+		{
+			void*& pHandle = *aryFields[i].ppHandle;
+			if (pHandle == nullptr)
+			{
+				continue;
+			}
+
+			auto itHandle = mapHandleIndices.find(pHandle);
+			if (itHandle == mapHandleIndices.end())
+			{
+				CommandFileHandle handle;
+				handle.u32Kind = aryFields[i].kind;
+				handle.u32BufferSize = 0;
+				handle.u32Format = D3DFMT_UNKNOWN;
+				vecHandles.push_back(handle);
+				itHandle = mapHandleIndices.insert(make_pair(pHandle, static_cast<unsigned int>(vecHandles.size()))).first;
+			}
+
+			CommandFileHandle& handle = vecHandles[itHandle->second - 1];
+			handle.u32BufferSize = max(handle.u32BufferSize, aryFields[i].u32UsedSize);
+			if (aryFields[i].format != D3DFMT_UNKNOWN)
+			{
+				handle.u32Format = aryFields[i].format;
+			}
+			pHandle = reinterpret_cast<void*>(static_cast<size_t>(itHandle->second));
+		}
+	}
+
+	ofstream commandFile(szPath, ios::out | ios::binary);
+	if (!commandFile)
+	{
+		RwgeLog(TEXT("Failed to open command file \"%s\"."), szPath);
+		return false;
+	}
+
+	CommandFileHeader header;
+	header.u32Magic = u32CommandFileMagic;
+	header.u32Version = u32CommandFileVersion;
+	header.u32PointerSize = sizeof(void*);
+	header.u32CommandCount = m_u32CommandCount;
+	header.u32DataSize = static_cast<unsigned int>(vecData.size());
+	header.u32HandleCount = static_cast<unsigned int>(vecHandles.size());
+
+	commandFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	commandFile.write(reinterpret_cast<const char*>(vecHandles.data()), vecHandles.size() * sizeof(CommandFileHandle));
+	commandFile.write(reinterpret_cast<const char*>(vecData.data()), vecData.size());
+
+	return commandFile.good();
+}
+
+bool RCommandBuffer::LoadFromFile(const TCHAR* szPath, RRenderDevice& device)
+{
+	ifstream commandFile(szPath, ios::in | ios::binary);
+	if (!commandFile)
+	{
+		RwgeLog(TEXT("Failed to open command file \"%s\"."), szPath);
+		return false;
+	}
+
+	CommandFileHeader header;
+	commandFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!commandFile ||
+		header.u32Magic != u32CommandFileMagic ||
+		header.u32Version != u32CommandFileVersion ||
+		header.u32PointerSize != sizeof(void*))
+	{
+		RwgeLog(TEXT("Command file \"%s\" is invalid or incompatible."), szPath);
+		return false;
+	}
+
+	vector<CommandFileHandle> vecHandles(header.u32HandleCount);
+	vector<unsigned char> vecData(header.u32DataSize);
+	commandFile.read(reinterpret_cast<char*>(vecHandles.data()), vecHandles.size() * sizeof(CommandFileHandle));
+	commandFile.read(reinterpret_cast<char*>(vecData.data()), vecData.size());
+	if (!commandFile)
+	{
+		RwgeLog(TEXT("Command file \"%s\" is truncated."), szPath);
+		return false;
+	}
+
+	// ================================ 岢 ================================
+	ReleaseLoadedResources();
+	m_pLoadedDevice = &device;
+
+	vector<void*> vecHandlePointers(vecHandles.size());
+	for (unsigned int i = 0; i < vecHandles.size(); ++i)
+	{
+		// ֻ󶨶ûбдĻҲҪڣٷһ㣨󣩵ĴС
+		const unsigned int u32BufferSize = max(vecHandles[i].u32BufferSize, static_cast<unsigned int>(sizeof(D3DXMATRIX)));
+
+		HRESULT hResult = D3D_OK;
+		if (vecHandles[i].u32Kind == EHK_VertexBuffer)
+		{
+			IDirect3DVertexBuffer9* pVertexBuffer = nullptr;
+			hResult = device.CreateVertexBuffer(u32BufferSize, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, D3DPOOL_DEFAULT, &pVertexBuffer);
+			if (SUCCEEDED(hResult))
+			{
+				m_vecLoadedVertexBuffers.push_back(pVertexBuffer);
+			}
+			vecHandlePointers[i] = pVertexBuffer;
+		}
+		else if (vecHandles[i].u32Kind == EHK_IndexBuffer)
+		{
+			// ûбSetIndicesʹù岻֪ʽд޹أ16λ
+			const D3DFORMAT format = vecHandles[i].u32Format == D3DFMT_INDEX32 ? D3DFMT_INDEX32 : D3DFMT_INDEX16;
+
+			IDirect3DIndexBuffer9* pIndexBuffer = nullptr;
+			hResult = device.CreateIndexBuffer(u32BufferSize, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, format, D3DPOOL_DEFAULT, &pIndexBuffer);
+			if (SUCCEEDED(hResult))
+			{
+				m_vecLoadedIndexBuffers.push_back(pIndexBuffer);
+			}
+			vecHandlePointers[i] = pIndexBuffer;
+		}
+		else
+		{
+			vecHandlePointers[i] = reinterpret_cast<void*>(static_cast<size_t>(i + 1) << 4);
+		}
+
+		if (FAILED(hResult))
+		{
+			RwgeLog(TEXT("Create buffer for command file failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
+			ReleaseLoadedResources();
+			return false;
+		}
+	}
+
+	// ================================ ѱ滻Ϊ ================================
+	unsigned int aryCommandCounts[ERenderCommand_MAX] = { 0 };
+	unsigned int u32CommandCount = 0;
+	unsigned int u32EffectDataSize = 0;
+
+	HandleField aryFields[3];
+	for (unsigned int u32Offset = 0; u32Offset < vecData.size();)
+	{
+		RenderCommand* pCommand = reinterpret_cast<RenderCommand*>(vecData.data() + u32Offset);
+		if (!IsValidCommand(pCommand, static_cast<unsigned int>(vecData.size()) - u32Offset, u32CommandAlignment))
+		{
+			RwgeLog(TEXT("Command file \"%s\" is corrupted."), szPath);
+			ReleaseLoadedResources();
+			return false;
+		}
+		u32Offset += pCommand->u32Size;
+
+		++aryCommandCounts[pCommand->u32Command];
+		++u32CommandCount;
+		if (pCommand->u32Command == ERC_SetEffectValue || pCommand->u32Command == ERC_SetEffectRawValue)
+		{
+			u32EffectDataSize += static_cast<SetEffectValueCommand*>(pCommand)->u32DataSize;
+		}
+
+		unsigned int u32FieldCount = GetHandleFields(pCommand, aryFields);
+		for (unsigned int i = 0; i < u32FieldCount; ++i)
+		{
+			// ͱֶһ£ʹõĻ巶ΧܳΪĻ
+			size_t u32HandleIndex = reinterpret_cast<size_t>(*aryFields[i].ppHandle);
+			if (u32HandleIndex > vecHandlePointers.size() ||
+				(u32HandleIndex != 0 && (vecHandles[u32HandleIndex - 1].u32Kind != static_cast<unsigned int>(aryFields[i].kind) ||
+					aryFields[i].u32UsedSize > max(vecHandles[u32HandleIndex - 1].u32BufferSize, static_cast<unsigned int>(sizeof(D3DXMATRIX))))))
+			{
+				RwgeLog(TEXT("Command file \"%s\" is corrupted."), szPath);
+				ReleaseLoadedResources();
+				return false;
+			}
+
+			*aryFields[i].ppHandle = u32HandleIndex != 0 ? vecHandlePointers[u32HandleIndex - 1] : nullptr;
+		}
+	}
+
+	if (u32CommandCount != header.u32CommandCount)
+	{
+		RwgeLog(TEXT("Command file \"%s\" is corrupted."), szPath);
+		ReleaseLoadedResources();
+		return false;
+	}
+
+	m_vecData.swap(vecData);
+	m_u32CommandCount = u32CommandCount;
+	RwgeCopyMemory(m_aryCommandCounts, aryCommandCounts, sizeof(m_aryCommandCounts));
+	m_u32EffectDataSize = u32EffectDataSize;
+
+	return true;
+}
+
+void RCommandBuffer::ReleaseLoadedResources()
+{
+	for (IDirect3DVertexBuffer9* pVertexBuffer : m_vecLoadedVertexBuffers)
+	{
+		m_pLoadedDevice->ReleaseVertexBuffer(pVertexBuffer);
+	}
+	for (IDirect3DIndexBuffer9* pIndexBuffer : m_vecLoadedIndexBuffers)
+	{
+		m_pLoadedDevice->ReleaseIndexBuffer(pIndexBuffer);
+	}
+
+	m_vecLoadedVertexBuffers.clear();
+	m_vecLoadedIndexBuffers.clear();
+	m_pLoadedDevice = nullptr;
+}
@@ -4,6 +4,8 @@
 #include "RwgeAssert.h"
 #include "RwgeD3d9RenderSystem.h"
 #include <RwgeLog.h>
+#include "RwgeGraphics.h"
+#include "RwgeRenderDevice.h"
 #include "RwgeD3d9RenderTarget.h"
 #include "RwgeD3dx9Extension.h"
 
@@ -150,6 +152,9 @@ void RD3d9Device::Resize(int s32Width, int s32Height, EDisplayMode mode)
 		RwgeLog(TEXT("D3D Device reset failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
 	}
 
+	// Reset豸״ָ̬ΪĬֵ״̬ӰеֵЧ
+	g_pRenderDevice->GetStateShadow().Invalidate();
+
 	RD3d9RenderTarget::Resize(s32Width, s32Height, mode);
 }
 
@@ -1,6 +1,7 @@
 #include "RwgeD3d9IndexBuffer.h"
 
 #include "RwgeGraphics.h"
+#include "RwgeCommandBuffer.h"
 #include "RwgeD3d9Device.h"
 #include "RwgeIndexStream.h"
 #include <d3dx9.h>
@@ -9,15 +10,18 @@
 
 using namespace RwgeD3dx9Extension;
 
-RD3d9IndexBuffer::RD3d9IndexBuffer(unsigned int u32BufferSize) : m_u32BufferSize(u32BufferSize)
+RD3d9IndexBuffer::RD3d9IndexBuffer(unsigned int u32BufferSize, bool bDynamic /* = true */, unsigned char u8IndexSize /* = 2 */) :
+	m_u32BufferSize(u32BufferSize),
+	m_u8IndexSize(u8IndexSize)
 {
-	HRESULT hResult = g_pD3d9Device->CreateIndexBuffer(
+	RwgeAssert(u8IndexSize == IndexStream::u8Index16Size || u8IndexSize == IndexStream::u8Index32Size);
+
+	HRESULT hResult = g_pRenderDevice->CreateIndexBuffer(
 		u32BufferSize,								// ֽ
-		D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,		// ;
-		D3DFMT_INDEX16,								// ʽ
+		bDynamic ? D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY : D3DUSAGE_WRITEONLY,	// ;
+		u8IndexSize == IndexStream::u8Index32Size ? D3DFMT_INDEX32 : D3DFMT_INDEX16,	// ʽ
 		D3DPOOL_DEFAULT,							// ԴͣĬϷԴ
-		&m_pD3dIndexBuffer,							// ַ
-		nullptr);									// 
+		&m_pD3dIndexBuffer);						// ַ
 
 	if (FAILED(hResult))
 	{
@@ -29,27 +33,30 @@ RD3d9IndexBuffer::~RD3d9IndexBuffer()
 {
 	if (m_pD3dIndexBuffer)
 	{
-		m_pD3dIndexBuffer->Release();
+		g_pRenderDevice->ReleaseIndexBuffer(m_pD3dIndexBuffer);
 	}
 }
 
-bool RD3d9IndexBuffer::BindIndexStream(IndexStream* pIndexStream) const
+bool RD3d9IndexBuffer::BindIndexStream(IndexStream* pIndexStream, unsigned int u32Offset /* = 0 */) const
 {
 	RwgeAssert(pIndexStream);
 	RwgeAssert(pIndexStream->aryIndices);
 	RwgeAssert(pIndexStream->u32StreamSize);
+	RwgeAssert(pIndexStream->u8IndexSize == m_u8IndexSize);
+	RwgeAssert(u32Offset % m_u8IndexSize == 0);
 
-	if (pIndexStream->u32StreamSize > m_u32BufferSize)
+	if (u32Offset > m_u32BufferSize || pIndexStream->u32StreamSize > m_u32BufferSize - u32Offset)
 	{
-		RwgeLog(TEXT("Failed to bind index stream to buffer - Not enough spacee. BufferSize : %u, StreamSize : %u"),
+		RwgeLog(TEXT("Failed to bind index stream to buffer - Not enough spacee. BufferSize : %u, Offset : %u, StreamSize : %u"),
 			m_u32BufferSize,
+			u32Offset,
 			pIndexStream->u32StreamSize);
 		return false;
 	}
 
 	void* pDestinationBuffer;
 
-	HRESULT hResult = m_pD3dIndexBuffer->Lock(0, pIndexStream->u32StreamSize, &pDestinationBuffer, 0);
+	HRESULT hResult = g_pRenderDevice->LockIndexBuffer(m_pD3dIndexBuffer, u32Offset, pIndexStream->u32StreamSize, &pDestinationBuffer, 0);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to lock index buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
@@ -58,7 +65,7 @@ bool RD3d9IndexBuffer::BindIndexStream(IndexStream* pIndexStream) const
 
 	RwgeCopyMemory(pDestinationBuffer, pIndexStream->aryIndices, pIndexStream->u32StreamSize);
 
-	hResult = m_pD3dIndexBuffer->Unlock();
+	hResult = g_pRenderDevice->UnlockIndexBuffer(m_pD3dIndexBuffer);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to unlock index buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
@@ -66,6 +73,23 @@ bool RD3d9IndexBuffer::BindIndexStream(IndexStream* pIndexStream) const
 	}
 
 	pIndexStream->pD3dIndexBuffer = m_pD3dIndexBuffer;
+	pIndexStream->u32StreamOffset = u32Offset;
 
 	return true;
+}
+
+void* RD3d9IndexBuffer::WriteData(RCommandBuffer& commandBuffer, unsigned int u32Offset, unsigned int u32Size, bool bDiscard)
+{
+	RwgeAssert(u32Size);
+
+	if (u32Offset + u32Size > m_u32BufferSize)
+	{
+		RwgeLog(TEXT("Failed to write index buffer - Buffer overflow. BufferSize : %u, Offset : %u, Size : %u"),
+			m_u32BufferSize,
+			u32Offset,
+			u32Size);
+		return nullptr;
+	}
+
+	return commandBuffer.WriteIndexBuffer(m_pD3dIndexBuffer, u32Offset, u32Size, bDiscard ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE);
 }
\ No newline at end of file
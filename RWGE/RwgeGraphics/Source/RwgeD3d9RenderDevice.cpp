@@ -0,0 +1,431 @@
+#include "RwgeD3d9RenderDevice.h"
+
+#include "RwgeGraphics.h"
+#include "RwgeD3d9Device.h"
+
+namespace
+{
+	// Effect״̬Effect豸״̬ȾDeviceStateShadowĹˣֵıʱתD3D9 Device
+	// ̶ߵ״̬RWGEûʹãֱת
+	class RD3d9EffectStateManager : public ID3DXEffectStateManager
+	{
+	public:
+		RD3d9EffectStateManager(RDeviceStateShadow& stateShadow) :
+			m_StateShadow(stateShadow),
+			m_u32ReferenceCount(1)
+		{
+
+		}
+
+		virtual ~RD3d9EffectStateManager()
+		{
+
+		}
+
+		STDMETHOD(QueryInterface)(REFIID iid, LPVOID* ppObject) override
+		{
+			if (iid == IID_IUnknown || iid == IID_ID3DXEffectStateManager)
+			{
+				*ppObject = this;
+				AddRef();
+				return S_OK;
+			}
+
+			*ppObject = nullptr;
+			return E_NOINTERFACE;
+		}
+
+		// EffectֻȾ߳ʹãüҪԭӲ
+		STDMETHOD_(ULONG, AddRef)() override
+		{
+			return ++m_u32ReferenceCount;
+		}
+
+		STDMETHOD_(ULONG, Release)() override
+		{
+			ULONG u32ReferenceCount = --m_u32ReferenceCount;
+			if (u32ReferenceCount == 0)
+			{
+				delete this;
+			}
+
+			return u32ReferenceCount;
+		}
+
+		STDMETHOD(SetTransform)(D3DTRANSFORMSTATETYPE state, const D3DMATRIX* pMatrix) override
+		{
+			return g_pD3d9Device->SetTransform(state, pMatrix);
+		}
+
+		STDMETHOD(SetMaterial)(const D3DMATERIAL9* pMaterial) override
+		{
+			return g_pD3d9Device->SetMaterial(pMaterial);
+		}
+
+		STDMETHOD(SetLight)(DWORD u32Index, const D3DLIGHT9* pLight) override
+		{
+			return g_pD3d9Device->SetLight(u32Index, pLight);
+		}
+
+		STDMETHOD(LightEnable)(DWORD u32Index, BOOL bEnable) override
+		{
+			return g_pD3d9Device->LightEnable(u32Index, bEnable);
+		}
+
+		STDMETHOD(SetRenderState)(D3DRENDERSTATETYPE state, DWORD u32Value) override
+		{
+			return m_StateShadow.SetRenderState(state, u32Value) ? g_pD3d9Device->SetRenderState(state, u32Value) : D3D_OK;
+		}
+
+		STDMETHOD(SetTexture)(DWORD u32Sampler, LPDIRECT3DBASETEXTURE9 pTexture) override
+		{
+			return m_StateShadow.SetTexture(u32Sampler, pTexture) ? g_pD3d9Device->SetTexture(u32Sampler, pTexture) : D3D_OK;
+		}
+
+		STDMETHOD(SetTextureStageState)(DWORD u32Stage, D3DTEXTURESTAGESTATETYPE type, DWORD u32Value) override
+		{
+			return g_pD3d9Device->SetTextureStageState(u32Stage, type, u32Value);
+		}
+
+		STDMETHOD(SetSamplerState)(DWORD u32Sampler, D3DSAMPLERSTATETYPE type, DWORD u32Value) override
+		{
+			return m_StateShadow.SetSamplerState(u32Sampler, type, u32Value) ? g_pD3d9Device->SetSamplerState(u32Sampler, type, u32Value) : D3D_OK;
+		}
+
+		STDMETHOD(SetNPatchMode)(FLOAT f32SegmentCount) override
+		{
+			return g_pD3d9Device->SetNPatchMode(f32SegmentCount);
+		}
+
+		STDMETHOD(SetFVF)(DWORD u32FVF) override
+		{
+			return g_pD3d9Device->SetFVF(u32FVF);
+		}
+
+		STDMETHOD(SetVertexShader)(LPDIRECT3DVERTEXSHADER9 pVertexShader) override
+		{
+			return m_StateShadow.SetVertexShader(pVertexShader) ? g_pD3d9Device->SetVertexShader(pVertexShader) : D3D_OK;
+		}
+
+		STDMETHOD(SetVertexShaderConstantF)(UINT u32StartRegister, const FLOAT* pData, UINT u32RegisterCount) override
+		{
+			return m_StateShadow.SetVertexShaderConstantF(u32StartRegister, pData, u32RegisterCount) ?
+				g_pD3d9Device->SetVertexShaderConstantF(u32StartRegister, pData, u32RegisterCount) : D3D_OK;
+		}
+
+		STDMETHOD(SetVertexShaderConstantI)(UINT u32StartRegister, const INT* pData, UINT u32RegisterCount) override
+		{
+			return g_pD3d9Device->SetVertexShaderConstantI(u32StartRegister, pData, u32RegisterCount);
+		}
+
+		STDMETHOD(SetVertexShaderConstantB)(UINT u32StartRegister, const BOOL* pData, UINT u32RegisterCount) override
+		{
+			return g_pD3d9Device->SetVertexShaderConstantB(u32StartRegister, pData, u32RegisterCount);
+		}
+
+		STDMETHOD(SetPixelShader)(LPDIRECT3DPIXELSHADER9 pPixelShader) override
+		{
+			return m_StateShadow.SetPixelShader(pPixelShader) ? g_pD3d9Device->SetPixelShader(pPixelShader) : D3D_OK;
+		}
+
+		STDMETHOD(SetPixelShaderConstantF)(UINT u32StartRegister, const FLOAT* pData, UINT u32RegisterCount) override
+		{
+			return m_StateShadow.SetPixelShaderConstantF(u32StartRegister, pData, u32RegisterCount) ?
+				g_pD3d9Device->SetPixelShaderConstantF(u32StartRegister, pData, u32RegisterCount) : D3D_OK;
+		}
+
+		STDMETHOD(SetPixelShaderConstantI)(UINT u32StartRegister, const INT* pData, UINT u32RegisterCount) override
+		{
+			return g_pD3d9Device->SetPixelShaderConstantI(u32StartRegister, pData, u32RegisterCount);
+		}
+
+		STDMETHOD(SetPixelShaderConstantB)(UINT u32StartRegister, const BOOL* pData, UINT u32RegisterCount) override
+		{
+			return g_pD3d9Device->SetPixelShaderConstantB(u32StartRegister, pData, u32RegisterCount);
+		}
+
+	private:
+		RDeviceStateShadow&		m_StateShadow;
+		ULONG					m_u32ReferenceCount;
+	};
+}
+
+const unsigned int RD3d9RenderDevice::u32MaxFrameLatency = 3;
+
+RD3d9RenderDevice::RD3d9RenderDevice() :
+	m_u32LastFence(0),
+	m_u32CompletedFence(0)
+{
+	m_pEffectStateManager = new RD3d9EffectStateManager(m_StateShadow);
+}
+
+RD3d9RenderDevice::~RD3d9RenderDevice()
+{
+	// ûͷŵEffect״̬ãһɾ
+	m_pEffectStateManager->Release();
+
+	for (FrameFence& fence : m_deqPendingFences)
+	{
+		RwgeSafeRelease(fence.pQuery);
+	}
+	for (IDirect3DQuery9* pQuery : m_vecFreeQueries)
+	{
+		RwgeSafeRelease(pQuery);
+	}
+}
+
+HRESULT RD3d9RenderDevice::CreateVertexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DPOOL pool, IDirect3DVertexBuffer9** ppVertexBuffer)
+{
+	return g_pD3d9Device->CreateVertexBuffer(u32Size, u32Usage, D3DFMT_VERTEXDATA, pool, ppVertexBuffer, nullptr);
+}
+
+HRESULT RD3d9RenderDevice::LockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags)
+{
+	return pVertexBuffer->Lock(u32Offset, u32Size, ppData, u32Flags);
+}
+
+HRESULT RD3d9RenderDevice::UnlockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer)
+{
+	return pVertexBuffer->Unlock();
+}
+
+void RD3d9RenderDevice::ReleaseVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer)
+{
+	pVertexBuffer->Release();
+}
+
+HRESULT RD3d9RenderDevice::CreateIndexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9** ppIndexBuffer)
+{
+	return g_pD3d9Device->CreateIndexBuffer(u32Size, u32Usage, format, pool, ppIndexBuffer, nullptr);
+}
+
+HRESULT RD3d9RenderDevice::LockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags)
+{
+	return pIndexBuffer->Lock(u32Offset, u32Size, ppData, u32Flags);
+}
+
+HRESULT RD3d9RenderDevice::UnlockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	return pIndexBuffer->Unlock();
+}
+
+void RD3d9RenderDevice::ReleaseIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	pIndexBuffer->Release();
+}
+
+HRESULT RD3d9RenderDevice::CreateVertexDeclaration(const D3DVERTEXELEMENT9* aryVertexElements, IDirect3DVertexDeclaration9** ppVertexDeclaration)
+{
+	return g_pD3d9Device->CreateVertexDeclaration(aryVertexElements, ppVertexDeclaration);
+}
+
+void RD3d9RenderDevice::ReleaseVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	pVertexDeclaration->Release();
+}
+
+HRESULT RD3d9RenderDevice::CreateTextureFromFile(const TCHAR* szPath, IDirect3DTexture9** ppTexture)
+{
+	return D3DXCreateTextureFromFile(g_pD3d9Device, szPath, ppTexture);
+}
+
+void RD3d9RenderDevice::ReleaseTexture(IDirect3DTexture9* pTexture)
+{
+	pTexture->Release();
+}
+
+HRESULT RD3d9RenderDevice::CreateEffectPool(ID3DXEffectPool** ppEffectPool)
+{
+	return D3DXCreateEffectPool(ppEffectPool);
+}
+
+void RD3d9RenderDevice::ReleaseEffectPool(ID3DXEffectPool* pEffectPool)
+{
+	pEffectPool->Release();
+}
+
+HRESULT RD3d9RenderDevice::CreateEffectFromFile(const TCHAR* szPath, ID3DXEffectPool* pEffectPool, ID3DXEffect** ppEffect, ID3DXBuffer** ppErrorBuffer)
+{
+	HRESULT hResult = D3DXCreateEffectFromFile(
+		g_pD3d9Device,								// D3D Deviceָ
+		szPath,										// ShaderԴļ·
+		nullptr,									// 궨ļҪ
+		nullptr,									// IncludeļҪ
+		0,											// Flag
+		pEffectPool,								// EffectPoolָ
+		ppEffect,									// Effectָָ
+		ppErrorBuffer);								// ErrorϢָ
+	if (FAILED(hResult))
+	{
+		return hResult;
+	}
+
+	return (*ppEffect)->SetStateManager(m_pEffectStateManager);
+}
+
+void RD3d9RenderDevice::ReleaseEffect(ID3DXEffect* pEffect)
+{
+	pEffect->Release();
+}
+
+D3DXHANDLE RD3d9RenderDevice::GetEffectParameterByName(ID3DXEffect* pEffect, const char* szName)
+{
+	return pEffect->GetParameterByName(nullptr, szName);
+}
+
+D3DXHANDLE RD3d9RenderDevice::GetEffectTechniqueByName(ID3DXEffect* pEffect, const char* szName)
+{
+	return pEffect->GetTechniqueByName(szName);
+}
+
+HRESULT RD3d9RenderDevice::BeginEffect(ID3DXEffect* pEffect)
+{
+	unsigned int u32PassCount;
+	HRESULT hResult = pEffect->Begin(&u32PassCount, D3DXFX_DONOTSAVESTATE);
+	if (FAILED(hResult))
+	{
+		return hResult;
+	}
+
+	return pEffect->BeginPass(0);
+}
+
+HRESULT RD3d9RenderDevice::EndEffect(ID3DXEffect* pEffect)
+{
+	HRESULT hResult = pEffect->EndPass();
+	if (FAILED(hResult))
+	{
+		return hResult;
+	}
+
+	return pEffect->End();
+}
+
+HRESULT RD3d9RenderDevice::CommitEffectChanges(ID3DXEffect* pEffect)
+{
+	return pEffect->CommitChanges();
+}
+
+HRESULT RD3d9RenderDevice::SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size)
+{
+	return pEffect->SetValue(hParameter, pData, u32Size);
+}
+
+HRESULT RD3d9RenderDevice::SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Offset, unsigned int u32Size)
+{
+	return pEffect->SetRawValue(hParameter, pData, u32Offset, u32Size);
+}
+
+HRESULT RD3d9RenderDevice::SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture)
+{
+	return pEffect->SetTexture(hParameter, pTexture);
+}
+
+HRESULT RD3d9RenderDevice::BeginScene()
+{
+	return g_pD3d9Device->BeginScene();
+}
+
+HRESULT RD3d9RenderDevice::EndScene()
+{
+	return g_pD3d9Device->EndScene();
+}
+
+HRESULT RD3d9RenderDevice::SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface)
+{
+	return g_pD3d9Device->SetRenderTarget(u32Index, pSurface);
+}
+
+HRESULT RD3d9RenderDevice::SetViewport(const D3DVIEWPORT9* pViewport)
+{
+	return g_pD3d9Device->SetViewport(pViewport);
+}
+
+HRESULT RD3d9RenderDevice::Clear(unsigned int u32RectCount, const D3DRECT* aryRects, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil)
+{
+	return g_pD3d9Device->Clear(u32RectCount, aryRects, u32Flags, color, f32Z, u32Stencil);
+}
+
+HRESULT RD3d9RenderDevice::SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value)
+{
+	return g_pD3d9Device->SetRenderState(state, u32Value);
+}
+
+HRESULT RD3d9RenderDevice::SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	return g_pD3d9Device->SetVertexDeclaration(pVertexDeclaration);
+}
+
+HRESULT RD3d9RenderDevice::SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride)
+{
+	return g_pD3d9Device->SetStreamSource(u32Stream, pVertexBuffer, u32Offset, u32Stride);
+}
+
+HRESULT RD3d9RenderDevice::SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting)
+{
+	return g_pD3d9Device->SetStreamSourceFreq(u32Stream, u32Setting);
+}
+
+HRESULT RD3d9RenderDevice::SetIndices(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	return g_pD3d9Device->SetIndices(pIndexBuffer);
+}
+
+HRESULT RD3d9RenderDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount)
+{
+	return g_pD3d9Device->DrawIndexedPrimitive(type, s32BaseVertexIndex, u32MinVertexIndex, u32VertexCount, u32StartIndex, u32PrimitiveCount);
+}
+
+unsigned int RD3d9RenderDevice::IssueFrameFence()
+{
+	IDirect3DQuery9* pQuery = nullptr;
+	if (!m_vecFreeQueries.empty())
+	{
+		pQuery = m_vecFreeQueries.back();
+		m_vecFreeQueries.pop_back();
+	}
+	else if (FAILED(g_pD3d9Device->CreateQuery(D3DQUERYTYPE_EVENT, &pQuery)))
+	{
+		pQuery = nullptr;
+	}
+
+	if (pQuery != nullptr && FAILED(pQuery->Issue(D3DISSUE_END)))
+	{
+		m_vecFreeQueries.push_back(pQuery);
+		pQuery = nullptr;
+	}
+
+	FrameFence fence;
+	fence.u32Fence = ++m_u32LastFence;
+	fence.pQuery = pQuery;
+	m_deqPendingFences.push_back(fence);
+
+	return fence.u32Fence;
+}
+
+unsigned int RD3d9RenderDevice::GetCompletedFrameFence()
+{
+	while (!m_deqPendingFences.empty())
+	{
+		const FrameFence& fence = m_deqPendingFences.front();
+		if (fence.pQuery != nullptr)
+		{
+			// ʹD3DGETDATA_FLUSHֻѯǿύ豸ʧȴɴ
+			if (fence.pQuery->GetData(nullptr, 0, 0) == S_FALSE)
+			{
+				break;
+			}
+
+			m_vecFreeQueries.push_back(fence.pQuery);
+		}
+		else if (m_deqPendingFences.size() <= u32MaxFrameLatency)
+		{
+			break;
+		}
+
+		m_u32CompletedFence = fence.u32Fence;
+		m_deqPendingFences.pop_front();
+	}
+
+	return m_u32CompletedFence;
+}
@@ -6,13 +6,82 @@
 #include <RwgeGraphics.h>
 #include "RwgeMaterial.h"
 #include "RwgeD3d9ShaderManager.h"
+#include "RwgeD3d9Shader.h"
+#include <RwgeRadixSort.h>
+#include <RwgeThreadPool.h>
+#include <RwgeClock.h>
+#include <string.h>
 
 using namespace std;
 
+// ÿԪƽƶĴʱΪһε˳̫󣬸Ϊִл
+static const unsigned int u32MaxSortMovesPerItem = 4;
+
+// йʱÿٴģģ̫ʱй
+static const unsigned int u32MinModelsPerBuildTask = 256;
+
+// ³ֵ±꣩Ƚϣ±겻ظ˳Ψһ
+static FORCE_INLINE bool IsNewSortKeyLess(const DrawSortKey& left, const DrawSortKey& right)
+{
+	if (left.u64SortKey != right.u64SortKey)
+	{
+		return left.u64SortKey < right.u64SortKey;
+	}
+	return left.u32DrawItem < right.u32DrawItem;
+}
+
+// ±꣩Ȱ±ٰȶ򣻷ֵָڵ
+static DrawSortKey* SortNewKeys(DrawSortKey* aryKeys, DrawSortKey* aryTemp, unsigned int u32Count)
+{
+	DrawSortKey* aryByDrawItem = RadixSort(aryKeys, aryTemp, u32Count, 4, [](const DrawSortKey& sortKey) { return static_cast<unsigned long long>(sortKey.u32DrawItem); });
+	return RadixSort64(aryByDrawItem, aryByDrawItem == aryKeys ? aryTemp : aryKeys, u32Count);
+}
+
+// Իִвƶu32MaxMovesʱֹͣfalseʱȻԭԪ
+static bool InsertionSortKeys(DrawSortKey* aryKeys, unsigned int u32Count, unsigned int u32MaxMoves, unsigned int& u32OutMoves)
+{
+	u32OutMoves = 0;
+
+	for (unsigned int i = 1; i < u32Count; ++i)
+	{
+		if (aryKeys[i - 1].u64SortKey <= aryKeys[i].u64SortKey)
+		{
+			continue;
+		}
+
+		DrawSortKey sortKey = aryKeys[i];
+		unsigned int j = i;
+		do
+		{
+			aryKeys[j] = aryKeys[j - 1];
+			--j;
+			++u32OutMoves;
+		} while (j > 0 && aryKeys[j - 1].u64SortKey > sortKey.u64SortKey);
+		aryKeys[j] = sortKey;
+
+		if (u32OutMoves > u32MaxMoves)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 RD3d9RenderQueue::RD3d9RenderQueue() :
+	m_pSceneManager(nullptr),
+	m_u32SceneFrame(0),
+	m_u32BuildIndex(1),
+	m_u32ShaderGeneration(0),
+	m_u32MaterialRevision(0),
+	m_bMaterialChanged(true),
+	m_bNewSortKeysSorted(true),
+	m_bParallelBuild(false),
+	m_CameraPosition(0.0f, 0.0f, 0.0f),
+	m_bCameraMoved(true),
 	m_pViewTransform(nullptr),
 	m_pProjectionTransform(nullptr),
-	m_bNeedUpdateCachedMaterialShader(false)
+	m_pLight(nullptr)
 {
 
 }
@@ -22,10 +91,48 @@ RD3d9RenderQueue::~RD3d9RenderQueue()
 {
 }
 
+void RD3d9RenderQueue::BeginBuild(const RSceneManager* pSceneManager, unsigned int u32SceneFrame)
+{
+	if (m_pSceneManager != pSceneManager || (u32SceneFrame != m_u32SceneFrame && u32SceneFrame != m_u32SceneFrame + 1))
+	{
+		Clear();
+		m_pSceneManager = pSceneManager;
+	}
+	m_u32SceneFrame = u32SceneFrame;
+
+	++m_u32BuildIndex;
+	m_bMaterialChanged = RMesh::GetMaterialRevision() != m_u32MaterialRevision;
+	m_u32MaterialRevision = RMesh::GetMaterialRevision();
+	m_vecNewSortKeys.clear();
+	m_bNewSortKeysSorted = true;
+	m_Statistics = RenderQueueStatistics();
+}
+
+void RD3d9RenderQueue::RemoveModel(unsigned int u32TransformHandle)
+{
+	if (u32TransformHandle >= m_vecHandleToDrawItems.size() || m_vecHandleToDrawItems[u32TransformHandle].pModel == nullptr)
+	{
+		return;
+	}
+
+	ModelDrawItems& modelDrawItems = m_vecHandleToDrawItems[u32TransformHandle];
+	for (unsigned int u32DrawItem : modelDrawItems.vecDrawItems)
+	{
+		FreeDrawItem(u32DrawItem);
+	}
+	m_Statistics.u32RemovedItemCount += modelDrawItems.vecDrawItems.size();
+
+	modelDrawItems.pModel = nullptr;
+	modelDrawItems.vecDrawItems.clear();
+}
+
 void RD3d9RenderQueue::SetCamera(const RCamera* pCamera)
 {
 	m_ViewOppositeDirection = -(pCamera->GetDirection());
-	m_pCameraPosition = &(pCamera->GetWorldPosition());
+
+	const D3DXVECTOR3& cameraPosition = pCamera->GetWorldPosition();
+	m_bCameraMoved = cameraPosition != m_CameraPosition;
+	m_CameraPosition = cameraPosition;
 
 	m_pViewTransform = pCamera->GetViewTransform();
 	m_pProjectionTransform = pCamera->GetProjectionTransform();
@@ -35,49 +142,520 @@ void RD3d9RenderQueue::SetCamera(const RCamera* pCamera)
 
 void RD3d9RenderQueue::InsertModel(RModel* pModel)
 {
-	RenderState				renderState;
+	ModelDrawItems& modelDrawItems = GetModelDrawItems(pModel->GetTransformHandle());
+	bool bCreated = CreateDrawItems(modelDrawItems, pModel);
+
+	UpdateDrawItems(modelDrawItems, pModel, bCreated, m_vecNewSortKeys, m_Statistics.u32RekeyedItemCount);
+	m_bNewSortKeysSorted = false;
+}
+
+void RD3d9RenderQueue::InsertModels(RModel* const* aryModels, unsigned int u32Count)
+{
+	RClock buildClock;
+	RThreadPool& threadPool = RThreadPool::GetInstance();
+
+	// ÿ̷߳ͬʱ֤ÿٴu32MinModelsPerBuildTaskģ
+	unsigned int u32TaskCount = (threadPool.GetWorkerCount() + 1) * 2;
+	if (u32TaskCount > u32Count / u32MinModelsPerBuildTask)
+	{
+		u32TaskCount = u32Count / u32MinModelsPerBuildTask;
+	}
+
+	if (!m_bParallelBuild || threadPool.GetWorkerCount() == 0 || u32TaskCount < 2)
+	{
+		for (unsigned int i = 0; i < u32Count; ++i)
+		{
+			InsertModel(aryModels[i]);
+		}
+		m_Statistics.f32BuildTime += buildClock.Tick() * 1000.0f;
+		return;
+	}
+
+	// вܸıĴС
+	unsigned int u32MaxHandle = 0;
+	for (unsigned int i = 0; i < u32Count; ++i)
+	{
+		if (aryModels[i]->GetTransformHandle() > u32MaxHandle)
+		{
+			u32MaxHandle = aryModels[i]->GetTransformHandle();
+		}
+	}
+	GetModelDrawItems(u32MaxHandle);
+
+	if (m_vecBuildTasks.size() < u32TaskCount)
+	{
+		m_vecBuildTasks.resize(u32TaskCount);
+	}
+
+	threadPool.ParallelFor(u32TaskCount, [this, aryModels, u32Count, u32TaskCount](unsigned int u32Task)
+	{
+		BuildTask& task = m_vecBuildTasks[u32Task];
+		task.vecNewSortKeys.clear();
+		task.vecDeferredModels.clear();
+		task.u32RekeyedItemCount = 0;
+
+		unsigned int u32Begin = static_cast<unsigned int>(static_cast<unsigned long long>(u32Count) * u32Task / u32TaskCount);
+		unsigned int u32End = static_cast<unsigned int>(static_cast<unsigned long long>(u32Count) * (u32Task + 1) / u32TaskCount);
+
+		for (unsigned int i = u32Begin; i < u32End; ++i)
+		{
+			RModel* pModel = aryModels[i];
+			ModelDrawItems& modelDrawItems = m_vecHandleToDrawItems[pModel->GetTransformHandle()];
+
+			if (modelDrawItems.pModel != pModel || modelDrawItems.vecDrawItems.size() != pModel->GetRenderUnitCount() || NeedQueryShader(modelDrawItems))
+			{
+				task.vecDeferredModels.push_back(i);
+				continue;
+			}
+
+			UpdateDrawItems(modelDrawItems, pModel, false, task.vecNewSortKeys, task.u32RekeyedItemCount);
+		}
+
+		unsigned int u32NewCount = static_cast<unsigned int>(task.vecNewSortKeys.size());
+		if (task.vecSortTemp.size() < u32NewCount)
+		{
+			task.vecSortTemp.resize(u32NewCount);
+		}
+		task.arySortedKeys = SortNewKeys(task.vecNewSortKeys.data(), task.vecSortTemp.data(), u32NewCount);
+	});
+
+	// ԭ˳дҪȡɫģ
+	m_Statistics.u32BuildTaskCount = u32TaskCount;
+	for (unsigned int u32Task = 0; u32Task < u32TaskCount; ++u32Task)
+	{
+		const BuildTask& task = m_vecBuildTasks[u32Task];
+		for (unsigned int u32Model : task.vecDeferredModels)
+		{
+			InsertModel(aryModels[u32Model]);
+		}
+		m_Statistics.u32DeferredModelCount += task.vecDeferredModels.size();
+		m_Statistics.u32RekeyedItemCount += task.u32RekeyedItemCount;
+	}
+
+	// Ľ֮ǰ鲢ÿȡСԪ
+	unsigned int u32TotalCount = m_vecNewSortKeys.size();
+	for (unsigned int u32Task = 0; u32Task < u32TaskCount; ++u32Task)
+	{
+		u32TotalCount += m_vecBuildTasks[u32Task].vecNewSortKeys.size();
+	}
+
+	if (m_vecSortTemp.size() < u32TotalCount)
+	{
+		m_vecSortTemp.resize(u32TotalCount);
+	}
+
+	// в֮ǰInsertModelģͬĹ
+	unsigned int u32InsertedCount = m_vecNewSortKeys.size();
+	if (!m_bNewSortKeysSorted)
+	{
+		if (SortNewKeys(m_vecNewSortKeys.data(), m_vecSortTemp.data(), u32InsertedCount) != m_vecNewSortKeys.data())
+		{
+			memcpy(m_vecNewSortKeys.data(), m_vecSortTemp.data(), u32InsertedCount * sizeof(DrawSortKey));
+		}
+	}
+
+	// 鲢飬ÿȡС٣ֱȽԪ
+	for (unsigned int u32Task = 0; u32Task < u32TaskCount; ++u32Task)
+	{
+		m_vecBuildTasks[u32Task].u32MergePosition = 0;
+	}
+
+	DrawSortKey* aryMerged = m_vecSortTemp.data();
+	unsigned int u32InsertedPosition = 0;
+	for (unsigned int k = 0; k < u32TotalCount; ++k)
+	{
+		const DrawSortKey* pMinKey = nullptr;
+		unsigned int* pu32MinPosition = nullptr;
+
+		if (u32InsertedPosition < u32InsertedCount)
+		{
+			pMinKey = &m_vecNewSortKeys[u32InsertedPosition];
+			pu32MinPosition = &u32InsertedPosition;
+		}
+
+		for (unsigned int u32Task = 0; u32Task < u32TaskCount; ++u32Task)
+		{
+			BuildTask& task = m_vecBuildTasks[u32Task];
+			if (task.u32MergePosition < task.vecNewSortKeys.size())
+			{
+				const DrawSortKey* pKey = &task.arySortedKeys[task.u32MergePosition];
+				if (pMinKey == nullptr || IsNewSortKeyLess(*pKey, *pMinKey))
+				{
+					pMinKey = pKey;
+					pu32MinPosition = &task.u32MergePosition;
+				}
+			}
+		}
+
+		aryMerged[k] = *pMinKey;
+		++(*pu32MinPosition);
+	}
+
+	m_vecNewSortKeys.swap(m_vecSortTemp);
+	m_vecNewSortKeys.resize(u32TotalCount);
+	m_bNewSortKeysSorted = true;
+
+	m_Statistics.f32BuildTime += buildClock.Tick() * 1000.0f;
+}
+
+RD3d9RenderQueue::ModelDrawItems& RD3d9RenderQueue::GetModelDrawItems(unsigned int u32TransformHandle)
+{
+	if (u32TransformHandle >= m_vecHandleToDrawItems.size())
+	{
+		ModelDrawItems nullModelDrawItems;
+		nullModelDrawItems.pModel = nullptr;
+		nullModelDrawItems.pWorldTransform = nullptr;
+		nullModelDrawItems.u32WorldRevision = 0;
+		nullModelDrawItems.u32VisibleBuild = 0;
+		m_vecHandleToDrawItems.resize(u32TransformHandle + 1, nullModelDrawItems);
+	}
+
+	return m_vecHandleToDrawItems[u32TransformHandle];
+}
+
+bool RD3d9RenderQueue::CreateDrawItems(ModelDrawItems& modelDrawItems, RModel* pModel)
+{
+	// ģ͵һοɼģ͸ûȾԪıʱ´
+	if (modelDrawItems.pModel == pModel && modelDrawItems.vecDrawItems.size() == pModel->GetRenderUnitCount())
+	{
+		return false;
+	}
+
+	RemoveModel(pModel->GetTransformHandle());
 
+	modelDrawItems.pModel = pModel;
+	for (RMesh* pMesh : pModel->GetMeshes())
+	{
+		for (RRenderUnit* pPrimitive : pMesh->GetRenderUnits())
+		{
+			unsigned int u32DrawItem = AllocateDrawItem();
+			DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+			drawItem.pRenderUnit = pPrimitive;
+			drawItem.pMesh = pMesh;
+			drawItem.drawPacket = pPrimitive->GetDrawPacket();
+			modelDrawItems.vecDrawItems.push_back(u32DrawItem);
+		}
+	}
+
+	m_Statistics.u32AddedItemCount += modelDrawItems.vecDrawItems.size();
+	return true;
+}
+
+void RD3d9RenderQueue::UpdateDrawItems(ModelDrawItems& modelDrawItems, RModel* pModel, bool bCreated, vector<DrawSortKey>& vecNewSortKeys, unsigned int& u32RekeyedCount)
+{
 	const D3DXMATRIX* pWorldTransform = &(pModel->GetWorldTransform());
+	unsigned int u32WorldRevision = pModel->GetWorldRevision();
+
+	bool bMoved = bCreated || modelDrawItems.u32WorldRevision != u32WorldRevision || modelDrawItems.pWorldTransform != pWorldTransform;
+	modelDrawItems.pWorldTransform = pWorldTransform;
+	modelDrawItems.u32WorldRevision = u32WorldRevision;
+
+	bool bWasVisible = modelDrawItems.u32VisibleBuild == m_u32BuildIndex - 1;
+	modelDrawItems.u32VisibleBuild = m_u32BuildIndex;
+
+	// ģûƶлһεУı
+	if (bWasVisible && !bMoved && !m_bCameraMoved && !m_bMaterialChanged)
+	{
+		bool bUnchanged = true;
+		for (unsigned int u32DrawItem : modelDrawItems.vecDrawItems)
+		{
+			DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+			if (drawItem.pShader == nullptr || drawItem.u32ShaderGeneration != m_u32ShaderGeneration)
+			{
+				bUnchanged = false;
+				break;
+			}
+			drawItem.u32VisibleBuild = m_u32BuildIndex;
+		}
 
-	// ʹģ;ƽƽ׶üģľԽƿΪȣʵʹÿȾԪĵжϾ
-	float f32DepthSquare = RwgeMath::Distance2(*(m_pCameraPosition), pModel->GetWorldPosition());
+		if (bUnchanged)
+		{
+			return;
+		}
+	}
 
+	unsigned int u32Index = 0;
 	for (RMesh* pMesh : pModel->GetMeshes())
 	{
-		renderState.pMaterial = pMesh->GetMaterial();
-		const list<RRenderUnit*>& listPrimitives = pMesh->GetRenderUnits();
+		// ʹΧľƽƽ׶ü󣬾ԽƿΪȣûаΧʱʹģ͵λ
+		D3DXVECTOR3 meshCenter;
+		if (bMoved)
+		{
+			meshCenter = pModel->GetWorldPosition();
+			if (!pMesh->GetLocalBounds().IsEmpty())
+			{
+				D3DXVec3TransformCoord(&meshCenter, &(pMesh->GetLocalBounds().center), pWorldTransform);
+			}
+		}
+
+		for (RRenderUnit* pPrimitive : pMesh->GetRenderUnits())
+		{
+			unsigned int u32DrawItem = modelDrawItems.vecDrawItems[u32Index++];
+			DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+
+			if (bMoved)
+			{
+				drawItem.worldCenter = meshCenter;
+				pPrimitive->SetWorldTransform(pWorldTransform);
+			}
+
+			// һιвɼĻǸݸλü
+			bool bRekey = UpdateRenderState(drawItem) || bMoved || m_bCameraMoved || drawItem.u32VisibleBuild != m_u32BuildIndex - 1;
+
+			// ɫʧʱ޷
+			if (drawItem.pShader == nullptr)
+			{
+				continue;
+			}
+
+			if (bRekey)
+			{
+				EDrawLayer layer = EDL_Translucent;
+				if (drawItem.pMaterial->GetBlendMode() == EBM_Opaque)
+				{
+					layer = EDL_Opaque;
+				}
+				else if (drawItem.pMaterial->GetBlendMode() == EBM_Masked)
+				{
+					layer = EDL_Masked;
+				}
+
+				float f32DepthSquare = RwgeMath::Distance2(m_CameraPosition, drawItem.worldCenter);
+				drawItem.u64SortKey = MakeSortKey(layer, drawItem.pShader, drawItem.pMaterial, drawItem.pRenderUnit, f32DepthSquare);
+
+				// ͸ȾԪ۲췽ڵѡԤȼ˳ֻ滻ʼ
+				if (layer == EDL_Translucent && pPrimitive->HasViewOrders())
+				{
+					unsigned int u32Octant = RRenderUnit::SelectViewOrder(drawItem.worldCenter - m_CameraPosition, *pWorldTransform);
+					drawItem.drawPacket.u32StartIndex = pPrimitive->GetViewOrderStartIndex(u32Octant);
+				}
+				else
+				{
+					drawItem.drawPacket.u32StartIndex = pPrimitive->GetDrawPacket().u32StartIndex;
+				}
+				++u32RekeyedCount;
+			}
+
+			drawItem.u32VisibleBuild = m_u32BuildIndex;
+
+			// һιû
+			if (drawItem.u32OrderBuild != m_u32BuildIndex - 1)
+			{
+				DrawSortKey sortKey;
+				sortKey.u64SortKey = drawItem.u64SortKey;
+				sortKey.u32DrawItem = u32DrawItem;
+				vecNewSortKeys.push_back(sortKey);
+			}
+		}
+	}
+}
+
+void RD3d9RenderQueue::Sort()
+{
+	RClock sortClock;
+
+	// һεƳβɼĻˢ
+	unsigned int u32PrevBuild = m_u32BuildIndex - 1;
+	unsigned int u32Count = 0;
+	bool bSorted = true;
+
+	for (unsigned int i = 0; i < m_vecSortKeys.size(); ++i)
+	{
+		unsigned int u32DrawItem = m_vecSortKeys[i].u32DrawItem;
+		DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+
+		if (drawItem.u32OrderBuild != u32PrevBuild || drawItem.u32VisibleBuild != m_u32BuildIndex)
+		{
+			continue;
+		}
+		drawItem.u32OrderBuild = m_u32BuildIndex;
+
+		DrawSortKey& sortKey = m_vecSortKeys[u32Count];
+		sortKey.u64SortKey = drawItem.u64SortKey;
+		sortKey.u32DrawItem = u32DrawItem;
+
+		if (u32Count > 0 && m_vecSortKeys[u32Count - 1].u64SortKey > sortKey.u64SortKey)
+		{
+			bSorted = false;
+		}
+		++u32Count;
+	}
+	m_vecSortKeys.resize(u32Count);
+
+	unsigned int u32NewCount = m_vecNewSortKeys.size();
+	unsigned int u32TotalCount = u32Count + u32NewCount;
+	if (m_vecSortTemp.size() < u32TotalCount)
+	{
+		m_vecSortTemp.resize(u32TotalCount);
+	}
 
-		// Ҫshader
-		if (m_bNeedUpdateCachedMaterialShader || renderState.pMaterial->GetCachedShader() == nullptr)
+	if (!bSorted)
+	{
+		if (!InsertionSortKeys(m_vecSortKeys.data(), u32Count, u32Count * u32MaxSortMovesPerItem, m_Statistics.u32SortMoveCount))
 		{
-			renderState.pShader = RD3d9ShaderManager::GetInstance().GetShader(RShaderKey(renderState.pMaterial->GetMaterialKey(), m_SceneKey, m_GlobalKey));
-			renderState.pMaterial->SetCachedShader(renderState.pShader);
+			if (RadixSort64(m_vecSortKeys.data(), m_vecSortTemp.data(), u32Count) != m_vecSortKeys.data())
+			{
+				memcpy(m_vecSortKeys.data(), m_vecSortTemp.data(), u32Count * sizeof(DrawSortKey));
+			}
+			m_Statistics.bFullSort = true;
 		}
-		else
+	}
+
+	if (u32NewCount > 0)
+	{
+		for (const DrawSortKey& sortKey : m_vecNewSortKeys)
 		{
-			renderState.pShader = renderState.pMaterial->GetCachedShader();
+			m_vecDrawItems[sortKey.u32DrawItem].u32OrderBuild = m_u32BuildIndex;
 		}
 
-		for (RRenderUnit* pPrimitive : listPrimitives)
+		if (!m_bNewSortKeysSorted)
 		{
-			pPrimitive->SetWorldTransform(pWorldTransform);
+			if (SortNewKeys(m_vecNewSortKeys.data(), m_vecSortTemp.data(), u32NewCount) != m_vecNewSortKeys.data())
+			{
+				memcpy(m_vecNewSortKeys.data(), m_vecSortTemp.data(), u32NewCount * sizeof(DrawSortKey));
+			}
+		}
 
-			if (renderState.pMaterial->GetBlendMode() == EBM_Opaque || renderState.pMaterial->GetBlendMode() == EBM_Masked)
+		// 鲢ͬʱһеĻǰ
+		DrawSortKey* aryMerged = m_vecSortTemp.data();
+		unsigned int i = 0;
+		unsigned int j = 0;
+		unsigned int k = 0;
+		while (i < u32Count && j < u32NewCount)
+		{
+			if (m_vecNewSortKeys[j].u64SortKey < m_vecSortKeys[i].u64SortKey)
 			{
-				RenderUnitWithDepth renderPrimitiveWidthDepth(f32DepthSquare, pPrimitive);
-				m_mapOpaqueGroup[renderState].insert(renderPrimitiveWidthDepth);
+				aryMerged[k++] = m_vecNewSortKeys[j++];
 			}
 			else
 			{
-				RenderStateWithDepth renderStateWithDepth(renderState);
-				m_mapTranslucentGroup[renderStateWithDepth].push_back(pPrimitive);
+				aryMerged[k++] = m_vecSortKeys[i++];
 			}
 		}
+		while (i < u32Count)
+		{
+			aryMerged[k++] = m_vecSortKeys[i++];
+		}
+		while (j < u32NewCount)
+		{
+			aryMerged[k++] = m_vecNewSortKeys[j++];
+		}
+
+		m_vecSortKeys.swap(m_vecSortTemp);
+		m_vecSortKeys.resize(u32TotalCount);
 	}
+
+	m_Statistics.u32DrawItemCount = u32TotalCount;
+	m_Statistics.u32InsertedItemCount = u32NewCount;
+	m_Statistics.u32RegisteredItemCount = m_vecDrawItems.size() - m_vecFreeDrawItems.size();
+	m_Statistics.f32BuildTime += sortClock.Tick() * 1000.0f;
 }
 
 void RD3d9RenderQueue::Clear()
 {
-	m_mapOpaqueGroup.clear();
-	m_mapTranslucentGroup.clear();
+	m_vecDrawItems.clear();
+	m_vecFreeDrawItems.clear();
+	m_vecHandleToDrawItems.clear();
+	m_vecSortKeys.clear();
+	m_vecNewSortKeys.clear();
+	m_bNewSortKeysSorted = true;
+	m_pSceneManager = nullptr;
+}
+
+unsigned int RD3d9RenderQueue::AllocateDrawItem()
+{
+	unsigned int u32DrawItem;
+	if (m_vecFreeDrawItems.empty())
+	{
+		u32DrawItem = m_vecDrawItems.size();
+		m_vecDrawItems.push_back(DrawItem());
+	}
+	else
+	{
+		u32DrawItem = m_vecFreeDrawItems.back();
+		m_vecFreeDrawItems.pop_back();
+	}
+
+	// ΪʱһθȾ״̬ʱһȡɫ
+	DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+	drawItem.pRenderUnit = nullptr;
+	drawItem.pShader = nullptr;
+	drawItem.pMaterial = nullptr;
+	drawItem.pMesh = nullptr;
+	drawItem.u64SortKey = 0;
+	drawItem.u32ShaderGeneration = m_u32ShaderGeneration;
+	drawItem.u32VisibleBuild = 0;
+	drawItem.u32OrderBuild = 0;
+
+	return u32DrawItem;
+}
+
+void RD3d9RenderQueue::FreeDrawItem(unsigned int u32DrawItem)
+{
+	// 㣬֮ǰв±겻ٱЧĻ
+	DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+	drawItem.pRenderUnit = nullptr;
+	drawItem.u32VisibleBuild = 0;
+	drawItem.u32OrderBuild = 0;
+
+	m_vecFreeDrawItems.push_back(u32DrawItem);
+}
+
+bool RD3d9RenderQueue::UpdateRenderState(DrawItem& drawItem)
+{
+	RMaterial* pMaterial = drawItem.pMesh->GetMaterial();
+	RD3d9Shader* pShader = pMaterial->GetCachedShader();
+
+	if (pShader != nullptr && pShader == drawItem.pShader && pMaterial == drawItem.pMaterial && drawItem.u32ShaderGeneration == m_u32ShaderGeneration)
+	{
+		return false;
+	}
+
+	// Ҫshader
+	if (pShader == nullptr || drawItem.u32ShaderGeneration != m_u32ShaderGeneration)
+	{
+		pShader = RD3d9ShaderManager::GetInstance().GetShader(RShaderKey(pMaterial->GetMaterialKey(), m_SceneKey, m_GlobalKey));
+		pMaterial->SetCachedShader(pShader);
+	}
+
+	drawItem.pMaterial = pMaterial;
+	drawItem.pShader = pShader;
+	drawItem.u32ShaderGeneration = m_u32ShaderGeneration;
+
+	return true;
+}
+
+bool RD3d9RenderQueue::NeedQueryShader(const ModelDrawItems& modelDrawItems) const
+{
+	// UpdateRenderStateлȡɫһ
+	for (unsigned int u32DrawItem : modelDrawItems.vecDrawItems)
+	{
+		const DrawItem& drawItem = m_vecDrawItems[u32DrawItem];
+		if (drawItem.pMesh->GetMaterial()->GetCachedShader() == nullptr || drawItem.u32ShaderGeneration != m_u32ShaderGeneration)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+unsigned long long RD3d9RenderQueue::MakeSortKey(EDrawLayer layer, const RD3d9Shader* pShader, const RMaterial* pMaterial, const RRenderUnit* pRenderUnit, float f32DepthSquare)
+{
+	// ǸλģʽֵĴС˳һ
+	unsigned int u32Depth;
+	memcpy(&u32Depth, &f32DepthSquare, sizeof(u32Depth));
+
+	unsigned long long u64Layer		= static_cast<unsigned long long>(layer) << 62;
+	unsigned long long u64Shader	= static_cast<unsigned long long>(pShader->GetSortId() & 0x3FFF);
+	unsigned long long u64Material	= static_cast<unsigned long long>(pMaterial->GetSortId());
+
+	if (layer == EDL_Translucent)
+	{
+		return u64Layer | (static_cast<unsigned long long>(~u32Depth) << 30) | (u64Shader << 16) | u64Material;
+	}
+
+	unsigned long long u64Geometry	= static_cast<unsigned long long>(pRenderUnit->GetGeometrySortId() & 0xFFF);
+
+	return u64Layer | (u64Shader << 48) | (u64Material << 32) | (u64Geometry << 20) | (u32Depth >> 12);
 }
\ No newline at end of file
@@ -3,26 +3,62 @@
 #include "RwgeGraphics.h"
 #include <RwgeAppWindow.h>
 #include "RwgeD3d9Device.h"
+#include "RwgeD3d9RenderDevice.h"
+#include "RwgeNullRenderDevice.h"
 #include "RwgeD3d9SwapChain.h"
 #include "RwgeD3d9RenderTarget.h"
 #include "RwgeD3d9ShaderManager.h"
 #include "RwgeMaterial.h"
+#include "RwgeLight.h"
 #include "RwgeD3d9VertexDeclaration.h"
 #include "RwgeVertexStream.h"
 #include "RwgeIndexStream.h"
 #include "RwgeVertexDeclarationManager.h"
 #include "RwgeTextureManager.h"
+#include "RwgeGpuMemoryManager.h"
+#include "RwgeDynamicUploader.h"
+#include "RwgeDynamicBatcher.h"
+#include "RwgeRenderDevice.h"
+#include "RwgeD3d9Viewport.h"
+#include "RwgeCamera.h"
+#include "RwgeMesh.h"
+#include "RwgeRenderUnit.h"
+#include "RwgeTransformStore.h"
 #include <RwgeLog.h>
+#include <RwgeClock.h>
+#include <RwgeMath.h>
+#include <RwgeRadixSort.h>
+#include <RwgeThreadPool.h>
 #include "RwgeD3dx9Extension.h"
+#include <algorithm>
 
 using namespace std;
 using namespace RwgeD3dx9Extension;
 
+const unsigned int RD3d9RenderSystem::u32MinInstanceCount		= 4;
+const unsigned int RD3d9RenderSystem::u32MaxInstancesPerBuffer	= 4096;
+const unsigned int RD3d9RenderSystem::u32MinDynamicBatchCount	= 2;
+
 RD3d9RenderSystem::RD3d9RenderSystem() : 
 	m_pD3d9(nullptr),
 	m_pDevice(nullptr),
+	m_pRenderDevice(nullptr),
+	m_pDefaultRenderTarget(nullptr),
 	m_pActivedRenderTarget(nullptr),
-	m_pFormerRenderTarget(nullptr)
+	m_pFormerRenderTarget(nullptr),
+	m_u32FrameIndex(0),
+	m_u32QueueBuildCount(0),
+	m_bParallelQueueBuild(false),
+	m_bInstancingEnabled(true),
+	m_bTransformSubmitted(false),
+	m_bOppositeViewSubmitted(false),
+	m_bLightSubmitted(false),
+	m_bDynamicBatchingEnabled(true),
+	m_pDynamicBatcher(new RDynamicBatcher()),
+	m_bDepthPrepassEnabled(false),
+	m_bOverdrawEstimationEnabled(false),
+	m_u32ExecutedCommandSize(0),
+	m_pViewportStatistics(&m_DiscardedStatistics)
 {
 	m_pD3d9 = Direct3DCreate9(D3D_SDK_VERSION);
 	if (!m_pD3d9)
@@ -30,13 +66,24 @@ RD3d9RenderSystem::RD3d9RenderSystem() :
 		RwgeErrorBox(TEXT("Initialize Direct3D-9 failed."));
 	}
 
-	GlobalKey globalShaderKey;
-	globalShaderKey.SetShaderSkinKey(false);
-	m_RenderQueue.SetGlobalKey(globalShaderKey);
+	m_GlobalShaderKey.SetShaderSkinKey(false);
+	D3DXMatrixIdentity(&m_SubmittedViewProjTransform);
 }
 
 RD3d9RenderSystem::~RD3d9RenderSystem()
 {
+	for (auto& pairViewportData : m_mapViewportRenderData)
+	{
+		delete pairViewportData.second->pRenderQueue;
+		delete pairViewportData.second;
+	}
+	m_mapViewportRenderData.clear();
+
+	delete m_pDynamicBatcher;
+	if (m_pRenderDevice != nullptr)
+	{
+		delete m_pRenderDevice;
+	}
 	RwgeSafeRelease(m_pD3d9);
 }
 
@@ -50,16 +97,27 @@ RD3d9RenderTarget* RD3d9RenderSystem::RegWinodwForRenderTarget(RAppWindow& windo
 	}
 #endif
 
+	// ͷȾĿʹNullRenderDeviceΪڴȾĿ
+	if (m_pDevice == nullptr && m_pRenderDevice != nullptr)
+	{
+		RwgeLog(TEXT("Can not register window \"%s\" for render target while running headless."), window.GetName());
+		return nullptr;
+	}
+
 	// DeviceΪգ򴴽Device򴴽SwapChain
 	if (m_pDevice == nullptr)
 	{
 		m_pDevice = new RD3d9Device(window);
 		m_mapWindowsToRenderTargets.insert(make_pair(&window, m_pDevice));
+		m_pDefaultRenderTarget = m_pDevice;
 
-		// DeviceɺʼȾģ
+		// Deviceɺ󴴽RenderDeviceʼȾģ
+		m_pRenderDevice				= new RD3d9RenderDevice();
 		m_pVertexDeclarationManager = new RVertexDeclarationManager();
 		m_pShaderManager			= new RD3d9ShaderManager();
 		m_pTextureManager			= new RTextureManager();
+		m_pGpuMemoryManager			= new RGpuMemoryManager();
+		m_pDynamicUploader			= new RDynamicUploader(m_CommandBuffer);
 
 		return m_pDevice;
 	}
@@ -83,6 +141,10 @@ bool RD3d9RenderSystem::DeRegWindowForRenderTarget(RAppWindow& window)
 	{
 		m_pDevice = nullptr;
 	}
+	if (itRenderTarget->second == m_pDefaultRenderTarget)
+	{
+		m_pDefaultRenderTarget = nullptr;
+	}
 
 	delete itRenderTarget->second;
 	m_mapWindowsToRenderTargets.erase(itRenderTarget);
@@ -90,22 +152,51 @@ bool RD3d9RenderSystem::DeRegWindowForRenderTarget(RAppWindow& window)
 	return true;
 }
 
-void RD3d9RenderSystem::BeginScene()
+RD3d9RenderTarget* RD3d9RenderSystem::CreateHeadlessRenderTarget(int s32Width, int s32Height)
 {
-	HRESULT hResult = g_pD3d9Device->BeginScene();
-	if (FAILED(hResult))
+	if (m_pRenderDevice != nullptr)
 	{
-		RwgeLog(TEXT("Begin scene failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
+		RwgeLog(TEXT("Create headless render target failed - render device has already been created."));
+		return nullptr;
 	}
+
+	m_pRenderDevice				= new RNullRenderDevice();
+	m_pVertexDeclarationManager = new RVertexDeclarationManager();
+	m_pShaderManager			= new RD3d9ShaderManager();
+	m_pTextureManager			= new RTextureManager();
+	m_pGpuMemoryManager			= new RGpuMemoryManager();
+	m_pDynamicUploader			= new RDynamicUploader(m_CommandBuffer);
+
+	// ͷȾĿûжӦĴڣӳԿָΪPresentFrameʱʲôҲ
+	m_pDefaultRenderTarget = new RNullRenderTarget(s32Width, s32Height);
+	m_mapWindowsToRenderTargets.insert(make_pair(nullptr, m_pDefaultRenderTarget));
+
+	return m_pDefaultRenderTarget;
+}
+
+void RD3d9RenderSystem::BeginScene()
+{
+	m_CommandBuffer.BeginScene();
 }
 
 void RD3d9RenderSystem::EndScene()
 {
-	HRESULT hResult = g_pD3d9Device->EndScene();
-	if (FAILED(hResult))
-	{
-		RwgeLog(TEXT("End scene failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-	}
+	m_CommandBuffer.EndScene();
+
+	FlushCommandBuffer();
+}
+
+const DeviceStateStatistics& RD3d9RenderSystem::GetDeviceStateStatistics() const
+{
+	RwgeAssert(m_pRenderDevice);
+
+	return m_pRenderDevice->GetStateShadow().GetStatistics();
+}
+
+void RD3d9RenderSystem::FlushCommandBuffer()
+{
+	m_CommandBuffer.Execute(*g_pRenderDevice, m_u32ExecutedCommandSize);
+	m_u32ExecutedCommandSize = m_CommandBuffer.GetDataSize();
 }
 
 void RD3d9RenderSystem::SubmitRenderTarget(RD3d9RenderTarget* pRenderTarget)
@@ -113,11 +204,7 @@ void RD3d9RenderSystem::SubmitRenderTarget(RD3d9RenderTarget* pRenderTarget)
 	RwgeAssert(pRenderTarget);
 	RwgeAssert(pRenderTarget != m_pActivedRenderTarget);	// RenderTargetظ˵߼
 
-	HRESULT hResult = g_pD3d9Device->SetRenderTarget(0, pRenderTarget->GetD3dSurface());
-	if (FAILED(hResult))
-	{
-		RwgeLog(TEXT("Set render target failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-	}
+	m_CommandBuffer.SetRenderTarget(0, pRenderTarget->GetD3dSurface());
 	pRenderTarget->ReleaseD3dSurface();		// ͷSurfaceü
 
 	m_pFormerRenderTarget = m_pActivedRenderTarget;
@@ -142,25 +229,19 @@ void RD3d9RenderSystem::SubmitFormerRenderTarget()
 
 void RD3d9RenderSystem::SubmitDefaultRenderTarget()
 {
-	SubmitRenderTarget(m_pDevice);
+	SubmitRenderTarget(m_pDefaultRenderTarget);
 }
 
 void RD3d9RenderSystem::ClearActivedRenderTarget()
 {
 	RwgeAssert(m_pActivedRenderTarget);
 
-	HRESULT hResult = g_pD3d9Device->Clear(
-		0, 
+	m_CommandBuffer.Clear(
 		nullptr, 
 		D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 
 		m_pActivedRenderTarget->GetBackgroundColor(), 
 		m_pActivedRenderTarget->GetMaxZ(), 
 		0);
-
-	if (FAILED(hResult))
-	{
-		RwgeLog(TEXT("Clear render target failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-	}
 }
 
 void RD3d9RenderSystem::SubmitViewport(const RD3d9Viewport* pViewport)
@@ -168,11 +249,7 @@ void RD3d9RenderSystem::SubmitViewport(const RD3d9Viewport* pViewport)
 	RwgeAssert(pViewport);
 	RwgeAssert(pViewport != m_pAcitvedViewport);	// Viewportظ˵߼
 
-	HRESULT hResult = g_pD3d9Device->SetViewport(pViewport->GetD3dViewport());
-	if (FAILED(hResult))
-	{
-		RwgeLog(TEXT("Set viewport failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-	}
+	m_CommandBuffer.SetViewport(pViewport->GetD3dViewport());
 
 	m_pFormerViewport = m_pAcitvedViewport;
 	m_pAcitvedViewport = pViewport;
@@ -199,18 +276,12 @@ void RD3d9RenderSystem::ClearViewport(const RD3d9Viewport* pViewport)
 {
 	RwgeAssert(pViewport);
 
-	HRESULT hResult = g_pD3d9Device->Clear(
-		1,
+	m_CommandBuffer.Clear(
 		&pViewport->GetD3dRect(),
 		D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
 		pViewport->GetBackgroundColor(),
 		pViewport->GetMaxZ(),
 		0);
-
-	if (FAILED(hResult))
-	{
-		RwgeLog(TEXT("Clear viewport failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-	}
 }
 
 void RD3d9RenderSystem::SubmitRenderState(const RenderState& newRenderState)
@@ -223,8 +294,9 @@ void RD3d9RenderSystem::SubmitRenderState(const RenderState& newRenderState)
 	{
 		SubmitShader(newRenderState.pShader);
 
-		m_ActivedRenderState.pShader->SetMaterial(pNewMaterial);
+		m_ActivedRenderState.pShader->SetMaterial(m_CommandBuffer, pNewMaterial);
 		m_ActivedRenderState.pMaterial = pNewMaterial;
+		++m_pViewportStatistics->aryCounters[EFC_MaterialSwitchCount];
 	}
 }
 
@@ -237,8 +309,9 @@ void RD3d9RenderSystem::SubmitMaterial(RMaterial* pNewMaterial)
 		// ע⣺лShaderڱȾĳݣҪпȷ
 		SubmitShader(pNewMaterial->GetCachedShader());
 
-		m_ActivedRenderState.pShader->SetMaterial(pNewMaterial);
+		m_ActivedRenderState.pShader->SetMaterial(m_CommandBuffer, pNewMaterial);
 		m_ActivedRenderState.pMaterial = pNewMaterial;
+		++m_pViewportStatistics->aryCounters[EFC_MaterialSwitchCount];
 	}
 }
 
@@ -248,119 +321,376 @@ void RD3d9RenderSystem::SubmitShader(RD3d9Shader* pNewShader)
 	{
 		if (m_ActivedRenderState.pShader != nullptr)
 		{
-			m_ActivedRenderState.pShader->End();
+			m_ActivedRenderState.pShader->End(m_CommandBuffer);
 		}
 		
 		if (pNewShader != nullptr)
 		{
-			pNewShader->Begin();
+			pNewShader->Begin(m_CommandBuffer);
 		}
 		
 		m_ActivedRenderState.pShader = pNewShader;
 	}
 }
 
-void RD3d9RenderSystem::SubmitVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration)
+void RD3d9RenderSystem::SubmitDrawPacket(const DrawPacket& drawPacket)
 {
-	RwgeAssert(pVertexDeclaration);
+	RwgeAssert(drawPacket.pD3dVertexDeclaration);
+
+	if (m_ActivedDrawPacket.pD3dVertexDeclaration != drawPacket.pD3dVertexDeclaration)
+	{
+		m_CommandBuffer.SetVertexDeclaration(drawPacket.pD3dVertexDeclaration);
+		m_ActivedDrawPacket.pD3dVertexDeclaration = drawPacket.pD3dVertexDeclaration;
+	}
+
+	// δʹõStreamSource
+	for (unsigned char i = drawPacket.u8StreamCount; i < m_ActivedDrawPacket.u8StreamCount; ++i)
+	{
+		m_CommandBuffer.SetStreamSource(i, nullptr, 0, 0);
+		m_ActivedDrawPacket.aryVertexBuffers[i] = nullptr;
+		m_ActivedDrawPacket.aryStreamOffsets[i] = 0;
+		m_ActivedDrawPacket.aryStreamStrides[i] = 0;
+	}
 
-	if (m_pActivedVertexDeclaration != pVertexDeclaration)
+	for (unsigned char i = 0; i < drawPacket.u8StreamCount; ++i)
 	{
-		HRESULT hResult = g_pD3d9Device->SetVertexDeclaration(pVertexDeclaration->GetD3dVertexDeclaration());
-		if (FAILED(hResult))
+		if (m_ActivedDrawPacket.aryVertexBuffers[i] != drawPacket.aryVertexBuffers[i] ||
+			m_ActivedDrawPacket.aryStreamOffsets[i] != drawPacket.aryStreamOffsets[i] ||
+			m_ActivedDrawPacket.aryStreamStrides[i] != drawPacket.aryStreamStrides[i])
 		{
-			RwgeLog(TEXT("Set vertex declaration failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
+			m_CommandBuffer.SetStreamSource(
+				i,									// Stream ID
+				drawPacket.aryVertexBuffers[i],		// 󶨵StreamBuffer
+				drawPacket.aryStreamOffsets[i],		// StreamBufferOffset
+				drawPacket.aryStreamStrides[i]);	// StreamBufferStride
+
+			m_ActivedDrawPacket.aryVertexBuffers[i] = drawPacket.aryVertexBuffers[i];
+			m_ActivedDrawPacket.aryStreamOffsets[i] = drawPacket.aryStreamOffsets[i];
+			m_ActivedDrawPacket.aryStreamStrides[i] = drawPacket.aryStreamStrides[i];
 		}
+	}
+
+	m_ActivedDrawPacket.u8StreamCount = drawPacket.u8StreamCount;
 
-		m_pActivedVertexDeclaration = pVertexDeclaration;
+	if (m_ActivedDrawPacket.pD3dIndexBuffer != drawPacket.pD3dIndexBuffer)
+	{
+		m_CommandBuffer.SetIndices(drawPacket.pD3dIndexBuffer, drawPacket.GetIndexFormat());
+		m_ActivedDrawPacket.pD3dIndexBuffer = drawPacket.pD3dIndexBuffer;
 	}
 }
 
-void RD3d9RenderSystem::SubmitVertexStream(const vector<VertexStream*>& vecVertexStreams)
+void RD3d9RenderSystem::SubmitRenderUnit(const RRenderUnit& renderUnit)
 {
-	RwgeAssert(m_pActivedVertexDeclaration->GetStreamCount() == vecVertexStreams.size());
+	const D3DXMATRIX* pWorld = renderUnit.GetWorldTransform();
+	PrimitiveTransform transform;
+	RD3d9Shader::ComputePrimitiveTransforms(&pWorld, 1, m_SubmittedViewProjTransform, &transform);
 
-	// δʹõStreamSource
-	for (unsigned int i = vecVertexStreams.size(); i < m_u8ActivedStreamCount; ++i)
+	SubmitDraw(renderUnit.GetDrawPacket(), transform);
+}
+
+void RD3d9RenderSystem::SubmitSceneConstants(RD3d9Shader* pSharedShader, const RD3d9RenderQueue& renderQueue)
+{
+	if (!m_bOppositeViewSubmitted || m_SubmittedOppositeView != renderQueue.m_ViewOppositeDirection)
+	{
+		pSharedShader->SetOppositeView(m_CommandBuffer, &renderQueue.m_ViewOppositeDirection);
+		m_SubmittedOppositeView = renderQueue.m_ViewOppositeDirection;
+		m_bOppositeViewSubmitted = true;
+	}
+
+	if (renderQueue.m_pLight != nullptr)
 	{
-		HRESULT hResult = g_pD3d9Device->SetStreamSource(i, nullptr, 0, 0);
-		if (FAILED(hResult))
+		const float* pLightConstants = renderQueue.m_pLight->GetConstants();
+		const unsigned int u32LightConstantCount = renderQueue.m_pLight->GetConstantCount();
+		if (!m_bLightSubmitted ||
+			m_vecSubmittedLightConstants.size() != u32LightConstantCount ||
+			!RwgeEqualMemory(m_vecSubmittedLightConstants.data(), pLightConstants, u32LightConstantCount * sizeof(float)))
 		{
-			RwgeLog(TEXT("Set stream source failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
+			pSharedShader->SetLight(m_CommandBuffer, renderQueue.m_pLight);
+			m_vecSubmittedLightConstants.assign(pLightConstants, pLightConstants + u32LightConstantCount);
+			m_bLightSubmitted = true;
 		}
-		m_vecActivedVertexStreams[i] = nullptr;
 	}
+}
+
+void RD3d9RenderSystem::SubmitTransform(const PrimitiveTransform& transform)
+{
+	if (!m_bTransformSubmitted || !RwgeEqualMemory(&m_SubmittedTransform, &transform, sizeof(PrimitiveTransform)))
+	{
+		m_ActivedRenderState.pShader->SetTransform(m_CommandBuffer, transform);
+		m_SubmittedTransform = transform;
+		m_bTransformSubmitted = true;
+	}
+
+	// ʳһύ֮˸ı䣬Ҫύ
+	m_ActivedRenderState.pShader->CommitChanges(m_CommandBuffer);
+}
+
+void RD3d9RenderSystem::SubmitDraw(const DrawPacket& drawPacket, const PrimitiveTransform& transform)
+{
+	SubmitTransform(transform);
+	SubmitDrawPacket(drawPacket);
+
+	// ִDP
+	m_CommandBuffer.DrawIndexedPrimitive(
+		drawPacket.GetPrimitiveType(),		// ͼԪ
+		drawPacket.u32BaseVertexIndex,		// ӵڼ㿪ʼƥ0
+		0,									// С
+		drawPacket.u32VertexCount,			// еĶ
+		drawPacket.u32StartIndex,			// ӵڼʼ
+		drawPacket.u32PrimitiveCount);		// ͼԪ
+
+	++m_FrameStatistics.u32DrawItemCount;
+	++m_FrameStatistics.u32DrawCallCount;
+	m_pViewportStatistics->aryCounters[EFC_PrimitiveCount] += drawPacket.u32PrimitiveCount;
+	m_pViewportStatistics->aryCounters[EFC_VertexCount] += drawPacket.u32VertexCount;
+}
+
+unsigned int RD3d9RenderSystem::SubmitInstancedRenderUnits(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin, unsigned int u32End)
+{
+	const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Begin].u32DrawItem];
+	const DrawPacket& drawPacket = drawItem.drawPacket;
+	RwgeAssert(drawPacket.u8StreamCount < DrawPacket::u8MaxStreams);
+
+	// ʵṩɫеΪλ۲ͶӰΪ۲ͶӰ
+	SubmitTransform(m_IdentityWorldTransform);
 
-	if (vecVertexStreams.size() > m_vecActivedVertexStreams.size())
+	// ȾԪĶ֮ʵʵÿλƵƫƶͬ
+	DrawPacket instancedPacket = drawPacket;
+	if (drawItem.pRenderUnit->GetDynamicStreamMask() != 0 && !drawItem.pRenderUnit->WriteDynamicStreams(instancedPacket))
 	{
-		m_vecActivedVertexStreams.resize(vecVertexStreams.size());
+		return u32Begin;
 	}
 
-	for (unsigned int i = 0; i < vecVertexStreams.size(); ++i)
+	instancedPacket.pD3dVertexDeclaration = RVertexDeclarationManager::GetInstance().GetInstancedVertexDeclaration(drawItem.pRenderUnit->GetVertexDeclaration())->GetD3dVertexDeclaration();
+	const unsigned char u8InstanceStream = instancedPacket.u8StreamCount++;
+	instancedPacket.aryVertexBuffers[u8InstanceStream] = m_pDynamicUploader->GetD3dVertexBuffer();
+	instancedPacket.aryStreamStrides[u8InstanceStream] = sizeof(D3DXMATRIX);
+
+	while (u32Begin < u32End)
 	{
-		if (m_vecActivedVertexStreams[i] != vecVertexStreams[i])
+		unsigned int u32InstanceCount = min(u32End - u32Begin, u32MaxInstancesPerBuffer);
+
+		// ֱдеλռ䲻ʱֹͣʵʣĻ
+		unsigned int u32InstanceOffset;
+		D3DXMATRIX* aryInstanceTransforms = static_cast<D3DXMATRIX*>(m_pDynamicUploader->WriteVertices(u32InstanceCount * sizeof(D3DXMATRIX), sizeof(D3DXMATRIX), u32InstanceOffset));
+		if (aryInstanceTransforms == nullptr)
 		{
-			if (vecVertexStreams[i]->pD3dVertexBuffer == nullptr)
-			{
-				RwgeLog(TEXT("Vertex stream can't be submited before binding to a vertex buffer."));
-				continue;
-			}
+			break;
+		}
 
-			HRESULT hResult = g_pD3d9Device->SetStreamSource(
-				i,											// Stream ID
-				vecVertexStreams[i]->pD3dVertexBuffer,		// 󶨵StreamBuffer
-				vecVertexStreams[i]->u32StreamOffset,		// StreamBufferOffset
-				vecVertexStreams[i]->u8VertexSize);			// StreamBufferStride
+		for (unsigned int u32Instance = 0; u32Instance < u32InstanceCount; ++u32Instance)
+		{
+			const DrawItem& instanceItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Begin + u32Instance].u32DrawItem];
+			aryInstanceTransforms[u32Instance] = *instanceItem.pRenderUnit->GetWorldTransform();
+		}
 
-			if (FAILED(hResult))
-			{
-				RwgeLog(TEXT("Set stream source failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
-			}
+		instancedPacket.aryStreamOffsets[u8InstanceStream] = u32InstanceOffset;
+
+		SubmitDrawPacket(instancedPacket);
 
-			m_vecActivedVertexStreams[i] = vecVertexStreams[i];
+		for (unsigned int i = 0; i < u8InstanceStream; ++i)
+		{
+			m_CommandBuffer.SetStreamSourceFreq(i, D3DSTREAMSOURCE_INDEXEDDATA | u32InstanceCount);
 		}
+		m_CommandBuffer.SetStreamSourceFreq(u8InstanceStream, D3DSTREAMSOURCE_INSTANCEDATA | 1);
+
+		m_CommandBuffer.DrawIndexedPrimitive(
+			drawPacket.GetPrimitiveType(),
+			drawPacket.u32BaseVertexIndex,
+			0,
+			drawPacket.u32VertexCount,
+			drawPacket.u32StartIndex,
+			drawPacket.u32PrimitiveCount);
+
+		m_FrameStatistics.u32DrawItemCount += u32InstanceCount;
+		m_FrameStatistics.u32InstanceCount += u32InstanceCount;
+		++m_FrameStatistics.u32DrawCallCount;
+		++m_FrameStatistics.u32InstancedDrawCallCount;
+		m_pViewportStatistics->aryCounters[EFC_PrimitiveCount] += drawPacket.u32PrimitiveCount * u32InstanceCount;
+		m_pViewportStatistics->aryCounters[EFC_VertexCount] += drawPacket.u32VertexCount * u32InstanceCount;
+
+		u32Begin += u32InstanceCount;
 	}
 
-	m_u8ActivedStreamCount = vecVertexStreams.size();
+	// ָΪʵƣ֮DPᱻʵ
+	for (unsigned int i = 0; i <= u8InstanceStream; ++i)
+	{
+		m_CommandBuffer.SetStreamSourceFreq(i, 1);
+	}
+
+	return u32Begin;
 }
 
-void RD3d9RenderSystem::SubmitIndexStream(const IndexStream* pIndexStream)
+unsigned int RD3d9RenderSystem::FindDynamicBatchEnd(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin) const
 {
-	RwgeAssert(pIndexStream);
+	const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Begin].u32DrawItem];
+	if (!RDynamicBatcher::CanBatch(*drawItem.pRenderUnit))
+	{
+		return u32Begin;
+	}
+
+	const unsigned int u32SortKeyCount = renderQueue.m_vecSortKeys.size();
+	unsigned int u32VertexCount = 0;
+	unsigned int u32IndexCount = 0;
+	unsigned int u32End = u32Begin;
 
-	if (m_pActivedIndexStream != pIndexStream)
+	while (u32End < u32SortKeyCount)
 	{
-		HRESULT hResult = g_pD3d9Device->SetIndices(pIndexStream->pD3dIndexBuffer);
-		if (FAILED(hResult))
+		const DrawItem& nextItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32End].u32DrawItem];
+		const DrawPacket& drawPacket = nextItem.drawPacket;
+
+		if (nextItem.pShader != drawItem.pShader ||
+			nextItem.pMaterial != drawItem.pMaterial ||
+			drawPacket.pD3dVertexDeclaration != drawItem.drawPacket.pD3dVertexDeclaration ||
+			u32VertexCount + drawPacket.u32VertexCount > RDynamicBatcher::u32MaxBatchVertexCount ||
+			u32IndexCount + drawPacket.u32PrimitiveCount * 3 > RDynamicBatcher::u32MaxBatchIndexCount ||
+			(u32End != u32Begin && !RDynamicBatcher::CanBatch(*nextItem.pRenderUnit)))
 		{
-			RwgeLog(TEXT("Set indices failed - ErrorCode: %s"), D3dErrorCodeToString(hResult));
+			break;
 		}
-		m_pActivedIndexStream = pIndexStream;
+
+		u32VertexCount += drawPacket.u32VertexCount;
+		u32IndexCount += drawPacket.u32PrimitiveCount * 3;
+		++u32End;
+	}
+
+	return u32End;
+}
+
+bool RD3d9RenderSystem::SubmitDynamicBatch(const RD3d9RenderQueue& renderQueue, unsigned int u32Begin, unsigned int u32End)
+{
+	m_vecDynamicBatchUnits.clear();
+	for (unsigned int u32Item = u32Begin; u32Item < u32End; ++u32Item)
+	{
+		m_vecDynamicBatchUnits.push_back(renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem].pRenderUnit);
 	}
+
+	const RRenderUnit* pBatchedRenderUnit = m_pDynamicBatcher->Batch(m_vecDynamicBatchUnits.data(), m_vecDynamicBatchUnits.size());
+	if (pBatchedRenderUnit == nullptr)
+	{
+		return false;
+	}
+
+	// ϲȾԪѾ任ռ䣬Ϊλ
+	SubmitDraw(pBatchedRenderUnit->GetDrawPacket(), m_IdentityWorldTransform);
+
+	// SubmitDrawѺϲȾԪΪһ
+	const unsigned int u32ItemCount = u32End - u32Begin;
+	m_FrameStatistics.u32DrawItemCount += u32ItemCount - 1;
+	m_FrameStatistics.u32DynamicBatchedItemCount += u32ItemCount;
+	++m_FrameStatistics.u32DynamicBatchCount;
+
+	return true;
 }
 
-void RD3d9RenderSystem::SubmitRenderUnit(const RRenderUnit& renderUnit)
+bool RD3d9RenderSystem::SubmitDepthPrepass(const RD3d9RenderQueue& renderQueue, unsigned int u32OpaqueEnd, unsigned int u32TransformBase)
 {
-	m_ActivedRenderState.pShader->SetTransform(renderUnit.GetWorldTransform(), &m_RenderQueue.m_ViewProjTransform);
-	m_ActivedRenderState.pShader->CommitChanges();
+	if (u32OpaqueEnd == 0)
+	{
+		return false;
+	}
 
-	SubmitVertexDeclaration(renderUnit.GetVertexDeclaration());
-	SubmitVertexStream(renderUnit.GetVertexStreams());
-	SubmitIndexStream(renderUnit.GetIndexStream());
+	RD3d9ShaderManager& shaderManager = RD3d9ShaderManager::GetInstance();
+	RVertexDeclarationManager& declarationManager = RVertexDeclarationManager::GetInstance();
 
-	// ִDP
-	HRESULT hResult = g_pD3d9Device->DrawIndexedPrimitive(
-		renderUnit.GetPrimitiveType(),		// ͼԪ
-		0,									// ӵڼ㿪ʼƥ0
-		0,									// С
-		renderUnit.GetVertexCount(),		// еĶ
-		0,									// ӵڼʼ
-		renderUnit.GetPrimitveCount());		// ͼԪ
+	m_vecDepthPrepassKeys.resize(u32OpaqueEnd);
+	m_vecDepthPrepassTemp.resize(u32OpaqueEnd);
+	for (unsigned int u32Item = 0; u32Item < u32OpaqueEnd; ++u32Item)
+	{
+		const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem];
+
+		// PassʹEQUALȲԣûдȵĻᱻȫ޳
+		if (shaderManager.GetDepthOnlyShader(drawItem.pShader) == nullptr)
+		{
+			return false;
+		}
+
+		// ǸλģʽֵĴС˳һ
+		float f32DepthSquare = RwgeMath::Distance2(renderQueue.m_CameraPosition, drawItem.worldCenter);
+		unsigned int u32Depth;
+		memcpy(&u32Depth, &f32DepthSquare, sizeof(u32Depth));
+
+		DrawSortKey& depthKey = m_vecDepthPrepassKeys[u32Item];
+		depthKey.u64SortKey = u32Depth;
+		depthKey.u32DrawItem = u32Item;
+	}
+
+	// ύκλ֮ǰдлĶ̬λŲʱԤȾ
+	m_vecDepthPrepassPackets.resize(u32OpaqueEnd);
+	for (unsigned int u32Item = 0; u32Item < u32OpaqueEnd; ++u32Item)
+	{
+		const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem];
+		DrawPacket& drawPacket = m_vecDepthPrepassPackets[u32Item];
+		drawPacket = drawItem.drawPacket;
+
+		// 0ֻλʱֻ0
+		const RD3d9VertexDeclaration* pPositionOnlyDeclaration = declarationManager.GetPositionOnlyVertexDeclaration(drawItem.pRenderUnit->GetVertexDeclaration());
+		if (pPositionOnlyDeclaration != nullptr)
+		{
+			drawPacket.pD3dVertexDeclaration = pPositionOnlyDeclaration->GetD3dVertexDeclaration();
+			drawPacket.u8StreamCount = 1;
+		}
+
+		if (drawItem.pRenderUnit->GetDynamicStreamMask() != 0 && !drawItem.pRenderUnit->WriteDynamicStreams(drawPacket))
+		{
+			return false;
+		}
+	}
+
+	// ȶģͬĻPassе˳
+	const DrawSortKey* aryOrder = RadixSort(m_vecDepthPrepassKeys.data(), m_vecDepthPrepassTemp.data(), u32OpaqueEnd, 4,
+		[](const DrawSortKey& depthKey) { return depthKey.u64SortKey; });
+
+	for (unsigned int u32Order = 0; u32Order < u32OpaqueEnd; ++u32Order)
+	{
+		const unsigned int u32Item = aryOrder[u32Order].u32DrawItem;
+		const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem];
+		const DrawPacket& drawPacket = m_vecDepthPrepassPackets[u32Item];
+
+		// ɫʹòʣɫͬĻֻ֮л任
+		SubmitShader(shaderManager.GetDepthOnlyShader(drawItem.pShader));
+		SubmitTransform(m_vecTransformArena[u32TransformBase + u32Item]);
+		SubmitDrawPacket(drawPacket);
+
+		m_CommandBuffer.DrawIndexedPrimitive(
+			drawPacket.GetPrimitiveType(),
+			drawPacket.u32BaseVertexIndex,
+			0,
+			drawPacket.u32VertexCount,
+			drawPacket.u32StartIndex,
+			drawPacket.u32PrimitiveCount);
+
+		// ԤȾ
+		++m_FrameStatistics.u32DrawCallCount;
+		++m_pViewportStatistics->aryCounters[EFC_DepthPrepassDrawCount];
+		m_pViewportStatistics->aryCounters[EFC_PrimitiveCount] += drawPacket.u32PrimitiveCount;
+		m_pViewportStatistics->aryCounters[EFC_VertexCount] += drawPacket.u32VertexCount;
+	}
+
+	// ɫرɫд룬ɫPass״̬ɫҪָ
+	SubmitShader(nullptr);
+	m_CommandBuffer.SetRenderState(D3DRS_COLORWRITEENABLE, D3DCOLORWRITEENABLE_RED | D3DCOLORWRITEENABLE_GREEN | D3DCOLORWRITEENABLE_BLUE | D3DCOLORWRITEENABLE_ALPHA);
+
+	return true;
+}
 
-	if (FAILED(hResult))
+void RD3d9RenderSystem::EstimateOverdraw(const RD3d9RenderQueue& renderQueue, unsigned int u32OpaqueEnd, unsigned int u32TransformBase)
+{
+	const D3DVIEWPORT9* pD3dViewport = m_pAcitvedViewport->GetD3dViewport();
+	m_OverdrawEstimator.Begin(pD3dViewport->Width, pD3dViewport->Height);
+
+	for (unsigned int u32Item = 0; u32Item < u32OpaqueEnd; ++u32Item)
 	{
-		RwgeLog(TEXT("Draw Primitive Failed : %X"), hResult);
+		const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem];
+		m_OverdrawEstimator.AddDraw(drawItem.pRenderUnit->GetLocalBounds(), m_vecTransformArena[u32TransformBase + u32Item].worldViewProj);
 	}
+
+	m_OverdrawEstimator.End();
+
+	const OverdrawEstimate& estimate = m_OverdrawEstimator.GetEstimate();
+	m_pViewportStatistics->aryCounters[EFC_EstimatedCoveredPixels] += estimate.u32CoveredPixels;
+	m_pViewportStatistics->aryCounters[EFC_EstimatedRasterizedPixels] += estimate.u32RasterizedPixels;
+	m_pViewportStatistics->aryCounters[EFC_EstimatedShadedPixels] += estimate.u32ShadedPixels;
 }
 
 void RD3d9RenderSystem::SubmitRenderQueue(const RD3d9RenderQueue& renderQueue)
@@ -371,47 +701,356 @@ void RD3d9RenderSystem::SubmitRenderQueue(const RD3d9RenderQueue& renderQueue)
 	{
 		return;		// ɫ޷ִȾֱӷ
 	}
-	pSharedShader->SetOppositeView(&renderQueue.m_ViewOppositeDirection);
-	if (renderQueue.m_pLight != nullptr)
+	SubmitSceneConstants(pSharedShader, renderQueue);
+	m_SubmittedViewProjTransform = renderQueue.m_ViewProjTransform;
+
+	// ================================ лı任 ================================
+	const unsigned int u32SortKeyCount = renderQueue.m_vecSortKeys.size();
+	unsigned int u32OpaqueEnd = 0;		// ͸㼶λǰ
+	m_vecTransformWorlds.resize(u32SortKeyCount + 1);
+	for (unsigned int u32Item = 0; u32Item < u32SortKeyCount; ++u32Item)
 	{
-		pSharedShader->SetLight(renderQueue.m_pLight);
+		const DrawSortKey& sortKey = renderQueue.m_vecSortKeys[u32Item];
+		m_vecTransformWorlds[u32Item] = renderQueue.m_vecDrawItems[sortKey.u32DrawItem].pRenderUnit->GetWorldTransform();
+
+		const EDrawLayer layer = RD3d9RenderQueue::GetSortKeyLayer(sortKey.u64SortKey);
+		u32OpaqueEnd += layer == EDL_Opaque;
+		++m_pViewportStatistics->aryCounters[EFC_OpaqueRenderUnitCount + layer];
 	}
 
-	// ================================ ͸ ================================
-	const OpaqueGroupMap& mapOpaqueGroup = renderQueue.m_mapOpaqueGroup;
-	OpaqueGroupMap::const_iterator itOpaqueRenderUnitSet = mapOpaqueGroup.begin();
-	for (; itOpaqueRenderUnitSet != mapOpaqueGroup.end(); ++itOpaqueRenderUnitSet)
+	// һΪλ󣬹ʵ붯̬ʹ
+	D3DXMATRIX matIdentity;
+	D3DXMatrixIdentity(&matIdentity);
+	m_vecTransformWorlds[u32SortKeyCount] = &matIdentity;
+
+	const unsigned int u32TransformBase = m_vecTransformArena.size();
+	m_vecTransformArena.resize(u32TransformBase + u32SortKeyCount + 1);
+	RD3d9Shader::ComputePrimitiveTransforms(m_vecTransformWorlds.data(), u32SortKeyCount + 1, renderQueue.m_ViewProjTransform, &m_vecTransformArena[u32TransformBase]);
+	m_IdentityWorldTransform = m_vecTransformArena[u32TransformBase + u32SortKeyCount];
+
+	if (m_bOverdrawEstimationEnabled)
 	{
-		/* ͬͼԪ϶ӦȾ״̬һͬԲһ˸ı䣬ûбҪʵı仯 */
+		EstimateOverdraw(renderQueue, u32OpaqueEnd, u32TransformBase);
+	}
 
-		const RenderState& newRenderState = itOpaqueRenderUnitSet->first;
-		SubmitShader(newRenderState.pShader);									// ύɫ
-		m_ActivedRenderState.pShader->SetMaterial(newRenderState.pMaterial);	// ύ
+	// ================================ ͸㼶ԤȾ ================================
+	const bool bDepthPrepass = m_bDepthPrepassEnabled && SubmitDepthPrepass(renderQueue, u32OpaqueEnd, u32TransformBase);
 
-		for (const RenderUnitWithDepth& renderUnitWithDepth : itOpaqueRenderUnitSet->second)
+	// ================================ ˳ ================================
+	// ͸Masked͸㼶Ⱥ˳ѾУֻɫʱ仯ʱлȾ״̬
+	RD3d9Shader* pCurrentShader = nullptr;
+	RMaterial* pCurrentMaterial = nullptr;
+	for (unsigned int u32Begin = 0; u32Begin < u32SortKeyCount;)
+	{
+		const DrawItem& drawItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Begin].u32DrawItem];
+
+		// 뿪͸㼶ʱǰɫ֮ɫBeginʱԼȲ
+		if (bDepthPrepass && u32Begin == u32OpaqueEnd)
 		{
-			SubmitRenderUnit(*renderUnitWithDepth.pRenderUnit);
+			SubmitShader(nullptr);
+			pCurrentShader = nullptr;
 		}
+
+		// ԤȾ֮Ĳ͸ƣ֤ԤȾʹͬı任
+		const bool bDepthEqual = bDepthPrepass && u32Begin < u32OpaqueEnd;
+
+		// ҳdrawItemʼġԺϲΪһʵƵ
+		unsigned int u32End = u32Begin + 1;
+		if (m_bInstancingEnabled && !bDepthEqual && drawItem.drawPacket.u8StreamCount < DrawPacket::u8MaxStreams)
+		{
+			while (u32End < u32SortKeyCount)
+			{
+				const DrawItem& nextItem = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32End].u32DrawItem];
+				if (nextItem.pShader != drawItem.pShader ||
+					nextItem.pMaterial != drawItem.pMaterial ||
+					!nextItem.drawPacket.HasSameGeometry(drawItem.drawPacket))
+				{
+					break;
+				}
+				++u32End;
+			}
+		}
+
+		RD3d9Shader* pInstancedShader = nullptr;
+		if (u32End - u32Begin >= u32MinInstanceCount)
+		{
+			pInstancedShader = RD3d9ShaderManager::GetInstance().GetInstancedShader(drawItem.pShader);
+		}
+
+		RD3d9Shader* pShader = pInstancedShader != nullptr ? pInstancedShader : drawItem.pShader;
+		if (pShader != pCurrentShader || drawItem.pMaterial != pCurrentMaterial)
+		{
+			SubmitShader(pShader);												// ύɫ
+			m_ActivedRenderState.pShader->SetMaterial(m_CommandBuffer, drawItem.pMaterial);		// ύ
+			++m_pViewportStatistics->aryCounters[EFC_MaterialSwitchCount];
+
+			// ɫPassBeginʱԼȲԣҪ֮󸲸ǣִֵͬʱ
+			if (bDepthEqual)
+			{
+				m_CommandBuffer.SetRenderState(D3DRS_ZFUNC, D3DCMP_EQUAL);
+				m_CommandBuffer.SetRenderState(D3DRS_ZWRITEENABLE, FALSE);
+			}
+
+			pCurrentShader = pShader;
+			pCurrentMaterial = drawItem.pMaterial;
+		}
+
+		unsigned int u32DrawnEnd = u32Begin;		// [u32Begin, u32DrawnEnd)Ѿͨʵ̬
+		if (pInstancedShader != nullptr)
+		{
+			u32DrawnEnd = SubmitInstancedRenderUnits(renderQueue, u32Begin, u32End);
+
+			// ʵռ䲻ʱʣĻԭɫ
+			if (u32DrawnEnd < u32End)
+			{
+				SubmitShader(drawItem.pShader);
+				m_ActivedRenderState.pShader->SetMaterial(m_CommandBuffer, drawItem.pMaterial);
+				++m_pViewportStatistics->aryCounters[EFC_MaterialSwitchCount];
+
+				pCurrentShader = drawItem.pShader;
+				m_FrameStatistics.u32InstancingFallbackItemCount += u32End - u32DrawnEnd;
+			}
+		}
+		else
+		{
+			// ʵʱ԰СȾԪϲΪһλƣʧʱ
+			unsigned int u32BatchEnd = m_bDynamicBatchingEnabled && !bDepthEqual ? FindDynamicBatchEnd(renderQueue, u32Begin) : u32Begin;
+			if (u32BatchEnd - u32Begin >= u32MinDynamicBatchCount && SubmitDynamicBatch(renderQueue, u32Begin, u32BatchEnd))
+			{
+				u32End = u32BatchEnd;
+				u32DrawnEnd = u32BatchEnd;
+			}
+		}
+
+		for (unsigned int u32Item = u32DrawnEnd; u32Item < u32End; ++u32Item)
+		{
+			const DrawItem& item = renderQueue.m_vecDrawItems[renderQueue.m_vecSortKeys[u32Item].u32DrawItem];
+			if (item.pRenderUnit->GetDynamicStreamMask() == 0)
+			{
+				SubmitDraw(item.drawPacket, m_vecTransformArena[u32TransformBase + u32Item]);
+			}
+			else
+			{
+				// ̬ÿλдλòͬڻDrawPacket޸ƫ
+				DrawPacket drawPacket = item.drawPacket;
+				if (item.pRenderUnit->WriteDynamicStreams(drawPacket))
+				{
+					SubmitDraw(drawPacket, m_vecTransformArena[u32TransformBase + u32Item]);
+				}
+			}
+		}
+
+		u32Begin = u32End;
+	}
+
+	// Ⱦֻв͸㼶ʱͬҪɫEQUALӰ֮Ļ
+	if (bDepthPrepass && u32OpaqueEnd == u32SortKeyCount)
+	{
+		SubmitShader(nullptr);
+	}
+}
+
+const RD3d9RenderQueue* RD3d9RenderSystem::GetViewportRenderQueue(const RD3d9Viewport* pViewport) const
+{
+	auto iterViewportData = m_mapViewportRenderData.find(pViewport);
+	if (iterViewportData == m_mapViewportRenderData.end())
+	{
+		return nullptr;
 	}
 
-	// ================================ ͸ ================================
-	const TranslucentGroupMap& mapTranslucentGroup = renderQueue.m_mapTranslucentGroup;
-	TranslucentGroupMap::const_iterator itTranslucentRenderUnitList = mapTranslucentGroup.begin();
-	for (; itTranslucentRenderUnitList != mapTranslucentGroup.end(); ++itTranslucentRenderUnitList)
+	return iterViewportData->second->pRenderQueue;
+}
+
+RD3d9RenderQueue* RD3d9RenderSystem::CreateRenderQueue()
+{
+	RD3d9RenderQueue* pRenderQueue = new RD3d9RenderQueue();
+	pRenderQueue->SetGlobalKey(m_GlobalShaderKey);
+
+	return pRenderQueue;
+}
+
+void RD3d9RenderSystem::ReleaseRenderQueue(RD3d9RenderQueue* pRenderQueue)
+{
+	delete pRenderQueue;
+}
+
+RD3d9RenderSystem::ViewportRenderData* RD3d9RenderSystem::GetViewportRenderData(RD3d9Viewport& viewport)
+{
+	ViewportRenderData*& pViewportData = m_mapViewportRenderData[&viewport];
+	if (pViewportData == nullptr)
+	{
+		pViewportData = new ViewportRenderData();
+		pViewportData->pViewport = &viewport;
+		pViewportData->pRenderQueue = new RD3d9RenderQueue();
+		pViewportData->pRenderQueue->SetGlobalKey(m_GlobalShaderKey);
+	}
+
+	pViewportData->u32LastFrame = m_u32FrameIndex;
+
+	return pViewportData;
+}
+
+void RD3d9RenderSystem::BuildViewportRenderQueues()
+{
+	// ÿÿֻ֡һΣʱһ۲ӿ
+	m_vecFrameScenes.clear();
+	for (ViewportRenderData* pViewportData : m_vecFrameViewports)
 	{
-		const RenderState& newRenderState = itTranslucentRenderUnitList->first;
-		SubmitShader(newRenderState.pShader);									// ύɫ
-		m_ActivedRenderState.pShader->SetMaterial(newRenderState.pMaterial);	// ύ
+		RCamera* pCamera = pViewportData->pViewport->GetCamera();
+		pViewportData->sceneView.pCamera = pCamera;
+		pViewportData->pSceneManager = pCamera != nullptr ? pCamera->GetAttachedSceneManager() : nullptr;
+		pViewportData->f32SceneTime = 0.0f;
+
+		RSceneManager* pSceneManager = pViewportData->pSceneManager;
+		if (pSceneManager != nullptr && find(m_vecFrameScenes.begin(), m_vecFrameScenes.end(), pSceneManager) == m_vecFrameScenes.end())
+		{
+			RClock sceneClock;
+			pSceneManager->BeginFrame();
+			pViewportData->f32SceneTime = sceneClock.Tick() * 1000.0f;
+
+			m_vecFrameScenes.push_back(pSceneManager);
+		}
+	}
 
-		for (const RRenderUnit* pRenderUnit : itTranslucentRenderUnitList->second)
+	// ͼ׶ڻȡʱŻ£г֮ڵǰ߳лȡһΣвüʱֻȡ
+	for (ViewportRenderData* pViewportData : m_vecFrameViewports)
+	{
+		if (pViewportData->pSceneManager != nullptr)
 		{
-			SubmitRenderUnit(*pRenderUnit);
+			pViewportData->sceneView.pCamera->GetFrustum();
 		}
 	}
+
+	RThreadPool& threadPool = RThreadPool::GetInstance();
+	const unsigned int u32ViewportCount = m_vecFrameViewports.size();
+
+	threadPool.ParallelFor(u32ViewportCount, [this](unsigned int u32Viewport)
+	{
+		ViewportRenderData* pViewportData = m_vecFrameViewports[u32Viewport];
+		if (pViewportData->pSceneManager != nullptr)
+		{
+			RClock cullClock;
+			pViewportData->pSceneManager->CullView(pViewportData->sceneView);
+			pViewportData->f32SceneTime += cullClock.Tick() * 1000.0f;
+		}
+	});
+
+	for (ViewportRenderData* pViewportData : m_vecFrameViewports)
+	{
+		if (pViewportData->pSceneManager == nullptr)
+		{
+			continue;
+		}
+
+		RD3d9RenderQueue& renderQueue = *pViewportData->pRenderQueue;
+		renderQueue.SetParallelBuildEnabled(m_bParallelQueueBuild);
+
+		RClock buildClock;
+		pViewportData->pSceneManager->BuildViewQueue(pViewportData->sceneView, pViewportData->pViewport, renderQueue);
+		++m_u32QueueBuildCount;
+		pViewportData->f32SceneTime += max(buildClock.Tick() * 1000.0f - renderQueue.GetStatistics().f32BuildTime, 0.0f);
+	}
+
+	threadPool.ParallelFor(u32ViewportCount, [this](unsigned int u32Viewport)
+	{
+		ViewportRenderData* pViewportData = m_vecFrameViewports[u32Viewport];
+		if (pViewportData->pSceneManager != nullptr)
+		{
+			pViewportData->pRenderQueue->Sort();
+		}
+	});
+}
+
+void RD3d9RenderSystem::RenderViewport(const ViewportRenderData& viewportData, unsigned int u32RenderTarget, FrameStatistics& renderTargetStatistics)
+{
+	ViewportFrameStatistics viewportStatistics;
+	viewportStatistics.u32RenderTarget = u32RenderTarget;
+	viewportStatistics.u32Viewport = 0;
+	if (!m_vecViewportFrameStatistics.empty() && m_vecViewportFrameStatistics.back().u32RenderTarget == u32RenderTarget)
+	{
+		viewportStatistics.u32Viewport = m_vecViewportFrameStatistics.back().u32Viewport + 1;
+	}
+
+	FrameStatistics& statistics = viewportStatistics.statistics;
+	m_pViewportStatistics = &statistics;
+
+	// еļȾӿǰĲֵӿڵļ
+	const unsigned int u32DrawCallCount				= m_CommandBuffer.GetCommandCount(ERC_DrawIndexedPrimitive);
+	const unsigned int u32ShaderSwitchCount			= m_CommandBuffer.GetCommandCount(ERC_BeginEffect);
+	const unsigned int u32TextureBindCount			= m_CommandBuffer.GetCommandCount(ERC_SetEffectTexture);
+	const unsigned int u32StreamSourceChangeCount	= m_CommandBuffer.GetCommandCount(ERC_SetStreamSource);
+	const unsigned int u32ConstantBytes				= m_CommandBuffer.GetEffectDataSize();
+
+	const RD3d9RenderQueue& renderQueue = *viewportData.pRenderQueue;
+
+	RClock phaseClock;
+	SubmitRenderQueue(renderQueue);
+	statistics.aryPhaseTimes[EFP_Submit] = phaseClock.Tick() * 1000.0f;
+
+	// ڳʱṹȾУȾһιĽ
+	if (viewportData.pSceneManager != nullptr)
+	{
+		const CullingStatistics& cullingStatistics = viewportData.sceneView.statistics;
+		statistics.aryCounters[EFC_VisibleModelCount] = cullingStatistics.u32VisibleModelCount;
+		statistics.aryCounters[EFC_CulledModelCount] = cullingStatistics.u32CulledModelCount;
+		statistics.aryPhaseTimes[EFP_BuildQueue] = renderQueue.GetStatistics().f32BuildTime;
+		statistics.aryPhaseTimes[EFP_RenderScene] = viewportData.f32SceneTime;
+	}
+
+	statistics.aryCounters[EFC_DrawCallCount]				= m_CommandBuffer.GetCommandCount(ERC_DrawIndexedPrimitive) - u32DrawCallCount;
+	statistics.aryCounters[EFC_ShaderSwitchCount]			= m_CommandBuffer.GetCommandCount(ERC_BeginEffect) - u32ShaderSwitchCount;
+	statistics.aryCounters[EFC_TextureBindCount]			= m_CommandBuffer.GetCommandCount(ERC_SetEffectTexture) - u32TextureBindCount;
+	statistics.aryCounters[EFC_StreamSourceChangeCount]	= m_CommandBuffer.GetCommandCount(ERC_SetStreamSource) - u32StreamSourceChangeCount;
+	statistics.aryCounters[EFC_ConstantBytes]				= m_CommandBuffer.GetEffectDataSize() - u32ConstantBytes;
+
+	m_pViewportStatistics = &m_DiscardedStatistics;
+
+	renderTargetStatistics.Accumulate(statistics);
+	m_vecViewportFrameStatistics.push_back(viewportStatistics);
 }
 
 void RD3d9RenderSystem::RenderOneFrame(float fDeltaTime)
 {
+	m_FrameStatistics = RenderSystemStatistics();
+	m_vecViewportFrameStatistics.clear();
+	m_vecRenderTargetFrameStatistics.clear();
+	m_TotalFrameStatistics.Reset();
+
+	// ÿ֡¼¼֮ǰ¼ʱѾִ
+	FlushCommandBuffer();
+	m_CommandBuffer.Reset();
+	m_u32ExecutedCommandSize = 0;
+
+	// 任빲ļ¼ÿ֡¿ʼ
+	m_vecTransformArena.clear();
+	m_bTransformSubmitted = false;
+	m_bOppositeViewSubmitted = false;
+	m_bLightSubmitted = false;
+	m_pRenderDevice->GetStateShadow().ResetStatistics();
+
+	// ΪӿڹȾУӿڵ˳֮ύ˳һ
+	++m_u32FrameIndex;
+	m_vecFrameViewports.clear();
+	for (auto& pairRenderTarget : m_mapWindowsToRenderTargets)
+	{
+		RD3d9RenderTarget* pRenderTarget = pairRenderTarget.second;
+		if (pRenderTarget->IsUsingDefaultViewport())
+		{
+			m_vecFrameViewports.push_back(GetViewportRenderData(pRenderTarget->m_DefaultViewport));
+		}
+		else
+		{
+			for (RD3d9Viewport* pViewport : pRenderTarget->m_listViewports)
+			{
+				m_vecFrameViewports.push_back(GetViewportRenderData(*pViewport));
+			}
+		}
+	}
+
+	BuildViewportRenderQueues();
+
+	unsigned int u32FrameViewport = 0;
+
 	// ע⣬˴autoҪãᴴ
 	for (auto& pairRenderTarget : m_mapWindowsToRenderTargets)
 	{
@@ -423,11 +1062,13 @@ void RD3d9RenderSystem::RenderOneFrame(float fDeltaTime)
 		BeginScene();
 		ClearActivedRenderTarget();
 
+		const unsigned int u32RenderTarget = m_vecRenderTargetFrameStatistics.size();
+		FrameStatistics renderTargetStatistics;
+
 		// RenderTargetʹĬϵViewportҪֶViewport
 		if (m_pActivedRenderTarget->IsUsingDefaultViewport())
 		{
-			m_pActivedRenderTarget->m_DefaultViewport.UpdateCamera(m_RenderQueue);	// ĳȡȾ
-			SubmitRenderQueue(m_RenderQueue);
+			RenderViewport(*m_vecFrameViewports[u32FrameViewport++], u32RenderTarget, renderTargetStatistics);
 		}
 		// ֶViewportִȾ
 		else
@@ -435,13 +1076,40 @@ void RD3d9RenderSystem::RenderOneFrame(float fDeltaTime)
 			for (RD3d9Viewport* pViewport : m_pActivedRenderTarget->m_listViewports)
 			{
 				SubmitViewport(pViewport);
-				pViewport->UpdateCamera(m_RenderQueue);								// ĳȡȾ
-				SubmitRenderQueue(m_RenderQueue);
+				RenderViewport(*m_vecFrameViewports[u32FrameViewport++], u32RenderTarget, renderTargetStatistics);
 			}
 		}
 
+		RClock executeClock;
 		EndScene();
+		renderTargetStatistics.aryPhaseTimes[EFP_Submit] += executeClock.Tick() * 1000.0f;
+
+		m_TotalFrameStatistics.Accumulate(renderTargetStatistics);
+		m_vecRenderTargetFrameStatistics.push_back(renderTargetStatistics);
 	}
+
+	// ֡ѾִУ֮дĶ̬һ֡
+	m_pDynamicUploader->EndFrame(*m_pRenderDevice);
+
+	// ͷű֡ûȾӿڵȾУӿڿѾ
+	for (auto iterViewportData = m_mapViewportRenderData.begin(); iterViewportData != m_mapViewportRenderData.end();)
+	{
+		if (iterViewportData->second->u32LastFrame != m_u32FrameIndex)
+		{
+			delete iterViewportData->second->pRenderQueue;
+			delete iterViewportData->second;
+			iterViewportData = m_mapViewportRenderData.erase(iterViewportData);
+		}
+		else
+		{
+			++iterViewportData;
+		}
+	}
+
+	m_FrameStatisticsHistory.AddFrame(m_TotalFrameStatistics);
+
+	// ȾУ³޸ͬѾӳڱ֡ĻУ¼ǩ
+	CollectFrameSignature(m_vecRenderedSignature);
 }
 
 void RD3d9RenderSystem::PresentFrame()
@@ -451,3 +1119,75 @@ void RD3d9RenderSystem::PresentFrame()
 		pairRenderTarget.second->Present();
 	}
 }
+
+bool RD3d9RenderSystem::HasFrameChanged() const
+{
+	if (m_u32FrameIndex == 0)
+	{
+		return true;
+	}
+
+	CollectFrameSignature(m_vecSignatureScratch);
+
+	return m_vecSignatureScratch != m_vecRenderedSignature;
+}
+
+void RD3d9RenderSystem::CollectFrameSignature(vector<size_t>& vecSignature) const
+{
+	vecSignature.clear();
+
+	// ڵı任ԴʡԴɫĲ붥ݵ޸Ķֻ¼ȫֵİ汾ţһ
+	// ı䶼Ⱦд
+	vecSignature.push_back(RTransformStore::GetInstance().GetChangeEpoch());
+	vecSignature.push_back(RMaterial::GetUpdateRevision());
+	vecSignature.push_back(RLight::GetColorRevision());
+	vecSignature.push_back(RMesh::GetMaterialRevision());
+	vecSignature.push_back(RRenderUnit::GetVertexRevision());
+
+	auto appendViewport = [&vecSignature](const RD3d9Viewport& viewport)
+	{
+		const D3DVIEWPORT9* pD3dViewport = viewport.GetD3dViewport();
+		RCamera* pCamera = viewport.GetCamera();
+
+		vecSignature.push_back(reinterpret_cast<size_t>(&viewport));
+		vecSignature.push_back(pD3dViewport->X);
+		vecSignature.push_back(pD3dViewport->Y);
+		vecSignature.push_back(pD3dViewport->Width);
+		vecSignature.push_back(pD3dViewport->Height);
+		vecSignature.push_back(viewport.GetBackgroundColor());
+		vecSignature.push_back(reinterpret_cast<size_t>(pCamera));
+
+		if (pCamera != nullptr)
+		{
+			// ͶӰλȽϣλ볯Ѿ޸ļԪ
+			const unsigned int* pProjectionBits = reinterpret_cast<const unsigned int*>(static_cast<const float*>(*pCamera->GetProjectionTransform()));
+			vecSignature.insert(vecSignature.end(), pProjectionBits, pProjectionBits + 16);
+
+			const RSceneManager* pSceneManager = pCamera->GetAttachedSceneManager();
+			vecSignature.push_back(reinterpret_cast<size_t>(pSceneManager));
+			vecSignature.push_back(pSceneManager != nullptr ? pSceneManager->GetRevision() : 0);
+		}
+	};
+
+	for (auto& pairRenderTarget : m_mapWindowsToRenderTargets)
+	{
+		const RD3d9RenderTarget* pRenderTarget = pairRenderTarget.second;
+		const D3DRECT& d3dRect = pRenderTarget->GetD3dRect();
+
+		vecSignature.push_back(reinterpret_cast<size_t>(pRenderTarget));
+		vecSignature.push_back(static_cast<unsigned int>(d3dRect.x2 - d3dRect.x1));
+		vecSignature.push_back(static_cast<unsigned int>(d3dRect.y2 - d3dRect.y1));
+
+		if (pRenderTarget->IsUsingDefaultViewport())
+		{
+			appendViewport(*pRenderTarget->GetDefaultViewport());
+		}
+		else
+		{
+			for (const RD3d9Viewport* pViewport : pRenderTarget->m_listViewports)
+			{
+				appendViewport(*pViewport);
+			}
+		}
+	}
+}
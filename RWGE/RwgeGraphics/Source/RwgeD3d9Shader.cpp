@@ -3,6 +3,7 @@
 #include <RwgeAssert.h>
 #include <RwgeLog.h>
 #include "RwgeGraphics.h"
+#include "RwgeCommandBuffer.h"
 #include "RwgeD3d9Device.h"
 #include "RwgeLight.h"
 #include "RwgeMaterial.h"
@@ -11,23 +12,26 @@
 #include "RwgeShaderKey.h"
 #include <RwgeMath.h>
 
+#if RWGE_SIMD_SSE
+#	include <xmmintrin.h>
+#endif
+
 using namespace std;
 
 RD3d9Shader::RD3d9Shader(const RShaderKey& key, LPD3DXEFFECTPOOL pEffectPool /* = nullptr */)
 {
+	m_u16SortId = 0;
+	m_pInstancedShader = nullptr;
+	m_bInstancedShaderQueried = false;
+	m_pDepthOnlyShader = nullptr;
+	m_bDepthOnlyShaderQueried = false;
+	m_aryBoundMaterialConstants = nullptr;
+	m_u16BoundMaterialConstantCount = 0;
 	m_strBinaryFilePath = RShaderCompilerEnvironment::GetShaderBinaryPath(key);
 	m_ShaderKey = key;
 
 	LPD3DXBUFFER pErrorBuffer = nullptr;
-	HRESULT hResult = D3DXCreateEffectFromFile(
-		g_pD3d9Device,								// D3D Deviceָ
-		m_strBinaryFilePath.c_str(),				// ShaderԴļ·
-		nullptr,									// 궨ļҪ
-		nullptr,									// IncludeļҪ
-		0,											// Flag
-		pEffectPool,								// EffectPoolָ
-		&m_pEffect,									// Effectָָ
-		&pErrorBuffer);								// ErrorϢָ
+	HRESULT hResult = g_pRenderDevice->CreateEffectFromFile(m_strBinaryFilePath.c_str(), pEffectPool, &m_pEffect, &pErrorBuffer);
 
 	if (FAILED(hResult))
 	{
@@ -36,10 +40,10 @@ RD3d9Shader::RD3d9Shader(const RShaderKey& key, LPD3DXEFFECTPOOL pEffectPool /*
 		return;
 	}
 
-	m_hOppositeView = m_pEffect->GetParameterByName(nullptr, "g_vecOppositeView");
-	m_hLight = m_pEffect->GetParameterByName(nullptr, "g_Light");
-	m_hMaterial = m_pEffect->GetParameterByName(nullptr, "g_Material");
-	m_hPrimitiveTransform = m_pEffect->GetParameterByName(nullptr, "g_Transform");
+	m_hOppositeView = g_pRenderDevice->GetEffectParameterByName(m_pEffect, "g_vecOppositeView");
+	m_hLight = g_pRenderDevice->GetEffectParameterByName(m_pEffect, "g_Light");
+	m_hMaterial = g_pRenderDevice->GetEffectParameterByName(m_pEffect, "g_Material");
+	m_hPrimitiveTransform = g_pRenderDevice->GetEffectParameterByName(m_pEffect, "g_Transform");
 
 	m_u8TextureCount = key.GetTextureCountKey();
 	if (m_u8TextureCount)
@@ -51,7 +55,7 @@ RD3d9Shader::RD3d9Shader(const RShaderKey& key, LPD3DXEFFECTPOOL pEffectPool /*
 		for (unsigned int i = 0; i < m_u8TextureCount; ++i)
 		{
 			_stprintf_s(szTextureName, TEXT("g_Texture_%u"), i);
-			m_aryTextureHandles[i] = m_pEffect->GetParameterByName(nullptr, szTextureName);
+			m_aryTextureHandles[i] = g_pRenderDevice->GetEffectParameterByName(m_pEffect, szTextureName);
 
 			m_aryBoundingTextures[i] = nullptr;
 		}
@@ -62,44 +66,51 @@ RD3d9Shader::RD3d9Shader(const RShaderKey& key, LPD3DXEFFECTPOOL pEffectPool /*
 
 RD3d9Shader::~RD3d9Shader()
 {
-	RwgeSafeRelease(m_pEffect);
+	if (m_pEffect != nullptr)
+	{
+		g_pRenderDevice->ReleaseEffect(m_pEffect);
+	}
+
+	delete[] m_aryBoundMaterialConstants;
 }
 
-void RD3d9Shader::Begin()
+void RD3d9Shader::Begin(RCommandBuffer& commandBuffer)
 {
-	unsigned int uPassCount;
-	m_pEffect->Begin(&uPassCount, 0);
-	m_pEffect->BeginPass(0);		// ʱǶPassٶTechniqueǵPass
+	commandBuffer.BeginEffect(m_pEffect);		// ʱǶPassٶTechniqueǵPass
 }
 
-void RD3d9Shader::End()
+bool RD3d9Shader::HasTechnique(const char* szName) const
 {
-	m_pEffect->EndPass();
-	m_pEffect->End();
+	return g_pRenderDevice->GetEffectTechniqueByName(m_pEffect, szName) != nullptr;
+}
 
-	ClearBoundingTextures();	// յǰѰ󶨵
+void RD3d9Shader::End(RCommandBuffer& commandBuffer)
+{
+	commandBuffer.EndEffect(m_pEffect);
+
+	// EffectEnd֮ȻֵѰ󶨵ʳҪգ´Beginֵ֮ͬᱻظ
 }
 
-void RD3d9Shader::CommitChanges() const
+void RD3d9Shader::CommitChanges(RCommandBuffer& commandBuffer) const
 {
-	m_pEffect->CommitChanges();
+	commandBuffer.CommitEffectChanges(m_pEffect);
 }
 
-void RD3d9Shader::SetOppositeView(const D3DXVECTOR3* pDirection)
+void RD3d9Shader::SetOppositeView(RCommandBuffer& commandBuffer, const D3DXVECTOR3* pDirection)
 {
 	RwgeAssert(pDirection);
 
-	m_pEffect->SetRawValue(m_hOppositeView, pDirection, 0, sizeof(float) * 3);
+	commandBuffer.SetEffectRawValue(m_pEffect, m_hOppositeView, pDirection, sizeof(float) * 3);
 }
 
-void RD3d9Shader::SetLight(const RLight* pLight)
+void RD3d9Shader::SetLight(RCommandBuffer& commandBuffer, const RLight* pLight)
 {
 	RwgeAssert(pLight);
 
-	m_pEffect->SetValue(m_hLight, pLight->GetConstants(), pLight->GetConstantCount() * sizeof(float));
+	commandBuffer.SetEffectValue(m_pEffect, m_hLight, pLight->GetConstants(), pLight->GetConstantCount() * sizeof(float));
 }
 
-void RD3d9Shader::SetMaterial(const RMaterial* pMaterial)
+void RD3d9Shader::SetMaterial(RCommandBuffer& commandBuffer, const RMaterial* pMaterial)
 {
 	RwgeAssert(pMaterial);
 
@@ -113,11 +124,25 @@ void RD3d9Shader::SetMaterial(const RMaterial* pMaterial)
 		//		ʵEffectͨűDeviceȾ״̬ģȾ״̬ÿΪShaderĹ
 		// 2.	һʵַʽǽMaskClipValueֵͨ궨崫ݸShader
 		//		˵ЧʽϵͣD3DRS_ALPHAREFĿԼΪ500CPUʱڣлShaderĿͨ5000ʱ
-		g_pD3d9Device->SetRenderState(D3DRS_ALPHAREF, static_cast<unsigned long>(pMaterial->GetOpacityMaskClipValue() * RwgeMath::u8Max));
+		// 3.	͸PassҲD3DRS_ALPHAREFﲻж豸еֵǼ¼ִʱDeviceStateShadow
+		commandBuffer.SetRenderState(D3DRS_ALPHAREF, static_cast<unsigned long>(pMaterial->GetOpacityMaskClipValue() * RwgeMath::u8Max));
 	}
 
-	// 󶨳
-	m_pEffect->SetValue(m_hMaterial, pMaterial->GetConstants(), pMaterial->GetConstantCount() * sizeof(float));
+	// 󶨳g_MaterialǹEffectеǰֵͬʱҪظ
+	const unsigned short u16ConstantCount = pMaterial->GetConstantCount();
+	if (u16ConstantCount != m_u16BoundMaterialConstantCount ||
+		memcmp(m_aryBoundMaterialConstants, pMaterial->GetConstants(), u16ConstantCount * sizeof(float)) != 0)
+	{
+		commandBuffer.SetEffectValue(m_pEffect, m_hMaterial, pMaterial->GetConstants(), u16ConstantCount * sizeof(float));
+
+		if (u16ConstantCount != m_u16BoundMaterialConstantCount)
+		{
+			delete[] m_aryBoundMaterialConstants;
+			m_aryBoundMaterialConstants = new float[u16ConstantCount];
+			m_u16BoundMaterialConstantCount = u16ConstantCount;
+		}
+		RwgeCopyMemory(m_aryBoundMaterialConstants, pMaterial->GetConstants(), u16ConstantCount * sizeof(float));
+	}
 
 	// 
 	RwgeAssert(m_u8TextureCount == pMaterial->GetTextureCount());
@@ -126,36 +151,83 @@ void RD3d9Shader::SetMaterial(const RMaterial* pMaterial)
 	{
 		if (pTextureAry[i] != m_aryBoundingTextures[i])
 		{
-			SetTexture(i, pTextureAry[i]);
+			SetTexture(commandBuffer, i, pTextureAry[i]);
 		}
 	}
 }
 
-void RD3d9Shader::SetTexture(unsigned u32Index, const RD3d9Texture* pTexture)
+void RD3d9Shader::SetTexture(RCommandBuffer& commandBuffer, unsigned u32Index, const RD3d9Texture* pTexture)
 {
 	RwgeAssert(pTexture);
 	RwgeAssert(u32Index < 16);
 
-	m_pEffect->SetTexture(m_aryTextureHandles[u32Index], pTexture->GetD3DTexture());
+	commandBuffer.SetEffectTexture(m_pEffect, m_aryTextureHandles[u32Index], pTexture->GetD3DTexture());
 	m_aryBoundingTextures[u32Index] = const_cast<RD3d9Texture*>(pTexture);		// ShaderıTextureתΪ˱淽
 }
 
-void RD3d9Shader::SetTransform(const D3DXMATRIX* pWorld, const D3DXMATRIX* pViewProjection)
+void RD3d9Shader::SetTransform(RCommandBuffer& commandBuffer, const D3DXMATRIX* pWorld, const D3DXMATRIX* pViewProjection)
 {
 	RwgeAssert(pWorld);
 	RwgeAssert(pViewProjection);
 
-	static PrimitiveTransform transform;
-	D3DXMatrixTranspose(&transform.world, pWorld);
-	D3DXMatrixMultiplyTranspose(&transform.worldViewProj, pWorld, pViewProjection);
+	PrimitiveTransform transform;
+	ComputePrimitiveTransforms(&pWorld, 1, *pViewProjection, &transform);
+
+	SetTransform(commandBuffer, transform);
+}
 
-	m_pEffect->SetRawValue(m_hPrimitiveTransform, &transform, 0, sizeof(PrimitiveTransform));
+void RD3d9Shader::SetTransform(RCommandBuffer& commandBuffer, const PrimitiveTransform& transform)
+{
+	commandBuffer.SetEffectRawValue(m_pEffect, m_hPrimitiveTransform, &transform, sizeof(PrimitiveTransform));
 }
 
-void RD3d9Shader::ClearBoundingTextures()
+void RD3d9Shader::ComputePrimitiveTransforms(const D3DXMATRIX* const* aryWorlds, unsigned int u32Count, const D3DXMATRIX& matViewProjection, PrimitiveTransform* aryTransforms)
 {
-	for (unsigned int i = 0; i < m_u8TextureCount; ++i)
+#if RWGE_SIMD_SSE
+	const __m128 viewProjRow0 = _mm_loadu_ps(&matViewProjection._11);
+	const __m128 viewProjRow1 = _mm_loadu_ps(&matViewProjection._21);
+	const __m128 viewProjRow2 = _mm_loadu_ps(&matViewProjection._31);
+	const __m128 viewProjRow3 = _mm_loadu_ps(&matViewProjection._41);
+
+	for (unsigned int u32Transform = 0; u32Transform < u32Count; ++u32Transform)
 	{
-		m_aryBoundingTextures[i] = nullptr;
+		const D3DXMATRIX& matWorld = *aryWorlds[u32Transform];
+		PrimitiveTransform& transform = aryTransforms[u32Transform];
+
+		__m128 worldRow0 = _mm_loadu_ps(&matWorld._11);
+		__m128 worldRow1 = _mm_loadu_ps(&matWorld._21);
+		__m128 worldRow2 = _mm_loadu_ps(&matWorld._31);
+		__m128 worldRow3 = _mm_loadu_ps(&matWorld._41);
+
+		// ۲ͶӰĵiiеĸԪ۲ͶӰе
+		__m128 resultRows[4];
+		const float* pWorld = &matWorld._11;
+		for (unsigned int u32Row = 0; u32Row < 4; ++u32Row, pWorld += 4)
+		{
+			__m128 row = _mm_mul_ps(_mm_set1_ps(pWorld[0]), viewProjRow0);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pWorld[1]), viewProjRow1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pWorld[2]), viewProjRow2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pWorld[3]), viewProjRow3));
+			resultRows[u32Row] = row;
+		}
+
+		_MM_TRANSPOSE4_PS(worldRow0, worldRow1, worldRow2, worldRow3);
+		_mm_storeu_ps(&transform.world._11, worldRow0);
+		_mm_storeu_ps(&transform.world._21, worldRow1);
+		_mm_storeu_ps(&transform.world._31, worldRow2);
+		_mm_storeu_ps(&transform.world._41, worldRow3);
+
+		_MM_TRANSPOSE4_PS(resultRows[0], resultRows[1], resultRows[2], resultRows[3]);
+		_mm_storeu_ps(&transform.worldViewProj._11, resultRows[0]);
+		_mm_storeu_ps(&transform.worldViewProj._21, resultRows[1]);
+		_mm_storeu_ps(&transform.worldViewProj._31, resultRows[2]);
+		_mm_storeu_ps(&transform.worldViewProj._41, resultRows[3]);
 	}
-}
\ No newline at end of file
+#else
+	for (unsigned int u32Transform = 0; u32Transform < u32Count; ++u32Transform)
+	{
+		D3DXMatrixTranspose(&aryTransforms[u32Transform].world, aryWorlds[u32Transform]);
+		D3DXMatrixMultiplyTranspose(&aryTransforms[u32Transform].worldViewProj, aryWorlds[u32Transform], &matViewProjection);
+	}
+#endif
+}
@@ -6,6 +6,7 @@
 #include <RwgeLog.h>
 #include "RwgeShaderCompilerEnv.h"
 #include "RwgeD3dx9Extension.h"
+#include "RwgeGraphics.h"
 
 using namespace std;
 using namespace RwgeD3dx9Extension;
@@ -13,9 +14,10 @@ using namespace RwgeD3dx9Extension;
 bool RD3d9ShaderManager::m_bRecompileShader = true;
 
 RD3d9ShaderManager::RD3d9ShaderManager() :
-	m_pSharedShader(nullptr)
+	m_pSharedShader(nullptr),
+	m_pEffectPool(nullptr)
 {
-	HRESULT hResult = D3DXCreateEffectPool(&m_pEffectPool);
+	HRESULT hResult = g_pRenderDevice->CreateEffectPool(&m_pEffectPool);
 
 	if (FAILED(hResult))
 	{
@@ -26,7 +28,10 @@ RD3d9ShaderManager::RD3d9ShaderManager() :
 
 RD3d9ShaderManager::~RD3d9ShaderManager()
 {
-
+	if (m_pEffectPool != nullptr)
+	{
+		g_pRenderDevice->ReleaseEffectPool(m_pEffectPool);
+	}
 }
 
 bool RD3d9ShaderManager::CompileShader(const RShaderKey& key)
@@ -188,11 +193,57 @@ RD3d9Shader* RD3d9ShaderManager::GetShader(const RShaderKey& key)
 		}
 	}
 
+	pShader->m_u16SortId = static_cast<unsigned short>(m_mapShaders.size());
 	RwgeAssert(m_mapShaders.insert(make_pair(key, pShader)).second);
 
 	return pShader;
 }
 
+RD3d9Shader* RD3d9ShaderManager::GetInstancedShader(RD3d9Shader* pShader)
+{
+	RwgeAssert(pShader);
+
+	// ɫУȡʧʱҲֻһΣÿ֡±
+	if (!pShader->m_bInstancedShaderQueried)
+	{
+		RShaderKey key = pShader->GetShaderKey();
+		key.SetShaderInstancingKey(true);
+
+		pShader->m_pInstancedShader = GetShader(key);
+		pShader->m_bInstancedShaderQueried = true;
+	}
+
+	return pShader->m_pInstancedShader;
+}
+
+RD3d9Shader* RD3d9ShaderManager::GetDepthOnlyShader(RD3d9Shader* pShader)
+{
+	RwgeAssert(pShader);
+
+	if (!pShader->m_bDepthOnlyShaderQueried)
+	{
+		// ֶαֲ䣬ʹɫɫͬĹ
+		const RShaderKey& sourceKey = pShader->GetShaderKey();
+		RShaderKey key;
+		key.SetSceneKey(sourceKey.GetSceneKey());
+		key.SetTwoSidedKey(sourceKey.GetTwoSidedKey());
+		key.SetShaderSkinKey(sourceKey.GetShaderSkinKey());
+		key.SetShaderDepthOnlyKey(true);
+
+		pShader->m_pDepthOnlyShader = GetShader(key);
+		pShader->m_bDepthOnlyShaderQueried = true;
+
+		// ɫûаUniformDefinition.hlsliʱSHADER_DEPTH_ONLYTechniqueEffectԤȾ
+		if (pShader->m_pDepthOnlyShader != nullptr && !pShader->m_pDepthOnlyShader->HasTechnique("DepthOnlyTechnique"))
+		{
+			RwgeLog("Depth only shader has no DepthOnlyTechnique with shader key : %s!", key.ToHexString());
+			pShader->m_pDepthOnlyShader = nullptr;
+		}
+	}
+
+	return pShader->m_pDepthOnlyShader;
+}
+
 RD3d9Shader* RD3d9ShaderManager::GetSharedShader()
 {
 	if (m_pSharedShader == nullptr)
@@ -12,14 +12,17 @@ RD3d9Texture::RD3d9Texture() : m_pD3DTexture(nullptr)
 
 RD3d9Texture::~RD3d9Texture()
 {
-	RwgeSafeRelease(m_pD3DTexture);
+	if (m_pD3DTexture != nullptr)
+	{
+		g_pRenderDevice->ReleaseTexture(m_pD3DTexture);
+	}
 }
 
 bool RD3d9Texture::Load(const TCHAR* szPath)
 {
 	m_strFilePath = szPath;
 
-	HRESULT hResult = D3DXCreateTextureFromFile(g_pD3d9Device, szPath, &m_pD3DTexture);
+	HRESULT hResult = g_pRenderDevice->CreateTextureFromFile(szPath, &m_pD3DTexture);
 
 	if (FAILED(hResult))
 	{
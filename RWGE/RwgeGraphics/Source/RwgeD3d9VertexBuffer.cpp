@@ -1,6 +1,7 @@
 #include "RwgeD3d9VertexBuffer.h"
 
 #include "RwgeGraphics.h"
+#include "RwgeCommandBuffer.h"
 #include "RwgeD3d9Device.h"
 #include "RwgeVertexStream.h"
 #include <d3dx9.h>
@@ -9,15 +10,13 @@
 
 using namespace RwgeD3dx9Extension;
 
-RD3d9VertexBuffer::RD3d9VertexBuffer(unsigned int u32BufferSize) : m_u32BufferSize(u32BufferSize), m_u32UsedSize(0)
+RD3d9VertexBuffer::RD3d9VertexBuffer(unsigned int u32BufferSize, bool bDynamic /* = true */) : m_u32BufferSize(u32BufferSize), m_u32UsedSize(0)
 {
-	HRESULT hResult = g_pD3d9Device->CreateVertexBuffer(
+	HRESULT hResult = g_pRenderDevice->CreateVertexBuffer(
 		u32BufferSize,									// ֽ
-		D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,			// ;
-		D3DFMT_VERTEXDATA,								// FVF
+		bDynamic ? D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY : D3DUSAGE_WRITEONLY,	// ;
 		D3DPOOL_DEFAULT,								// Դ
-		&m_pD3dVertexBuffer,							// ַ
-		nullptr);										// 
+		&m_pD3dVertexBuffer);							// ַ
 
 	if (FAILED(hResult))
 	{
@@ -29,15 +28,13 @@ RD3d9VertexBuffer::~RD3d9VertexBuffer()
 {
 	if (m_pD3dVertexBuffer)
 	{
-		m_pD3dVertexBuffer->Release();
+		g_pRenderDevice->ReleaseVertexBuffer(m_pD3dVertexBuffer);
 	}
 }
 
 bool RD3d9VertexBuffer::BindVertexStream(VertexStream* pVertexStream)
 {
 	RwgeAssert(pVertexStream);
-	RwgeAssert(pVertexStream->aryVertices);
-	RwgeAssert(pVertexStream->u32StreamSize);
 
 	if (pVertexStream->u32StreamSize > m_u32BufferSize - m_u32UsedSize)
 	{
@@ -47,9 +44,34 @@ bool RD3d9VertexBuffer::BindVertexStream(VertexStream* pVertexStream)
 		return false;
 	}
 
+	if (!BindVertexStream(pVertexStream, m_u32UsedSize))
+	{
+		return false;
+	}
+
+	m_u32UsedSize += pVertexStream->u32StreamSize;
+
+	return true;
+}
+
+bool RD3d9VertexBuffer::BindVertexStream(VertexStream* pVertexStream, unsigned int u32Offset)
+{
+	RwgeAssert(pVertexStream);
+	RwgeAssert(pVertexStream->aryVertices);
+	RwgeAssert(pVertexStream->u32StreamSize);
+
+	if (u32Offset > m_u32BufferSize || pVertexStream->u32StreamSize > m_u32BufferSize - u32Offset)
+	{
+		RwgeLog(TEXT("Failed to bind vertex stream to buffer - Buffer overflow. BufferSize : %u, Offset : %u, StreamSize : %u"), 
+			m_u32BufferSize, 
+			u32Offset,
+			pVertexStream->u32StreamSize);
+		return false;
+	}
+
 	void* pDestinationBuffer;
 
-	HRESULT hResult = m_pD3dVertexBuffer->Lock(m_u32UsedSize, pVertexStream->u32StreamSize, &pDestinationBuffer, 0);
+	HRESULT hResult = g_pRenderDevice->LockVertexBuffer(m_pD3dVertexBuffer, u32Offset, pVertexStream->u32StreamSize, &pDestinationBuffer, 0);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to lock vertex buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
@@ -58,7 +80,7 @@ bool RD3d9VertexBuffer::BindVertexStream(VertexStream* pVertexStream)
 
 	RwgeCopyMemory(pDestinationBuffer, pVertexStream->aryVertices, pVertexStream->u32StreamSize);
 
-	hResult = m_pD3dVertexBuffer->Unlock();
+	hResult = g_pRenderDevice->UnlockVertexBuffer(m_pD3dVertexBuffer);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to unlock vertex buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
@@ -66,12 +88,28 @@ bool RD3d9VertexBuffer::BindVertexStream(VertexStream* pVertexStream)
 	}
 
 	pVertexStream->pD3dVertexBuffer = m_pD3dVertexBuffer;
-	pVertexStream->u32StreamOffset = m_u32UsedSize;
-	m_u32UsedSize += pVertexStream->u32StreamSize;
+	pVertexStream->u32StreamOffset = u32Offset;
 
 	return true;
 }
 
+void* RD3d9VertexBuffer::WriteData(RCommandBuffer& commandBuffer, unsigned int u32Offset, unsigned int u32Size, bool bDiscard)
+{
+	RwgeAssert(u32Size);
+
+	if (u32Offset + u32Size > m_u32BufferSize)
+	{
+		RwgeLog(TEXT("Failed to write vertex buffer - Buffer overflow. BufferSize : %u, Offset : %u, Size : %u"),
+			m_u32BufferSize,
+			u32Offset,
+			u32Size);
+		return nullptr;
+	}
+
+	// DISCARD·һ黺NOOVERWRITEŵ޸GPUʹõ߶ȴGPU
+	return commandBuffer.WriteVertexBuffer(m_pD3dVertexBuffer, u32Offset, u32Size, bDiscard ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE);
+}
+
 bool RD3d9VertexBuffer::UpdateVertexStream(VertexStream* pVertexStream) const
 {
 	RwgeAssert(pVertexStream);
@@ -89,7 +127,7 @@ bool RD3d9VertexBuffer::UpdateVertexStream(VertexStream* pVertexStream) const
 
 	void* pDestinationBuffer;
 
-	HRESULT hResult = m_pD3dVertexBuffer->Lock(pVertexStream->u32StreamOffset, pVertexStream->u32StreamSize, &pDestinationBuffer, 0);
+	HRESULT hResult = g_pRenderDevice->LockVertexBuffer(m_pD3dVertexBuffer, pVertexStream->u32StreamOffset, pVertexStream->u32StreamSize, &pDestinationBuffer, 0);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to lock vertex buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
@@ -98,7 +136,7 @@ bool RD3d9VertexBuffer::UpdateVertexStream(VertexStream* pVertexStream) const
 
 	RwgeCopyMemory(pDestinationBuffer, pVertexStream->aryVertices, pVertexStream->u32StreamSize);
 
-	hResult = m_pD3dVertexBuffer->Unlock();
+	hResult = g_pRenderDevice->UnlockVertexBuffer(m_pD3dVertexBuffer);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Failed to unlock vertex buffer - ErrorCode: %s"), D3dErrorCodeToString(hResult));
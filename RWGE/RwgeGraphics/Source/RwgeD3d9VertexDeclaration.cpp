@@ -1,12 +1,19 @@
 #include "RwgeD3d9VertexDeclaration.h"
 
+#include "RwgeGraphics.h"
 #include "RwgeD3d9Device.h"
 #include "RwgeVertexDeclarationTemplate.h"
 #include <RwgeLog.h>
 
 using namespace std;
 
-RD3d9VertexDeclaration::RD3d9VertexDeclaration(const RVertexDeclarationTemplate& declarationTemplate)
+RD3d9VertexDeclaration::RD3d9VertexDeclaration(const RVertexDeclarationTemplate& declarationTemplate) :
+	m_u8PositionStream(0),
+	m_u16PositionOffset(0xFFFF),
+	m_Template(declarationTemplate),
+	m_pInstancedDeclaration(nullptr),
+	m_pPositionOnlyDeclaration(nullptr),
+	m_bPositionOnlyDeclarationQueried(false)
 {
 	unsigned char u8ElementCount = declarationTemplate.GetElementCount();
 	unsigned char u8StreamCount = declarationTemplate.GetStreamCount();
@@ -30,6 +37,12 @@ RD3d9VertexDeclaration::RD3d9VertexDeclaration(const RVertexDeclarationTemplate&
 			pVertexElements[u32ElementIndex].Usage		= element.u8Usage;
 			pVertexElements[u32ElementIndex].UsageIndex	= element.u8UsageIndex;
 
+			if (element.u8Usage == D3DDECLUSAGE_POSITION && element.u8UsageIndex == 0 && element.u8Type == D3DDECLTYPE_FLOAT3)
+			{
+				m_u8PositionStream = u8StreamID;
+				m_u16PositionOffset = u16Offset;
+			}
+
 			u16Offset += element.GetElementSize();
 			++u32ElementIndex;
 		}
@@ -40,7 +53,7 @@ RD3d9VertexDeclaration::RD3d9VertexDeclaration(const RVertexDeclarationTemplate&
 
 	pVertexElements[u8ElementCount] = D3DDECL_END();
 
-	HRESULT hResult = g_pD3d9Device->CreateVertexDeclaration(pVertexElements, &m_pD3dVertexDeclaration);
+	HRESULT hResult = g_pRenderDevice->CreateVertexDeclaration(pVertexElements, &m_pD3dVertexDeclaration);
 	if (FAILED(hResult))
 	{
 		RwgeLog(TEXT("Create vertex declaration failed : %X"), hResult);
@@ -53,6 +66,6 @@ RD3d9VertexDeclaration::~RD3d9VertexDeclaration()
 {
 	if (m_pD3dVertexDeclaration)
 	{
-		m_pD3dVertexDeclaration->Release();
+		g_pRenderDevice->ReleaseVertexDeclaration(m_pD3dVertexDeclaration);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "RwgeDeviceStateShadow.h"
+
+#include <RwgeAssert.h>
+
+const unsigned int RDeviceStateShadow::u32MaxRenderStates		= 256;
+const unsigned int RDeviceStateShadow::u32MaxSamplers			= 20;
+const unsigned int RDeviceStateShadow::u32MaxSamplerStates		= 14;
+const unsigned int RDeviceStateShadow::u32MaxShaderConstants	= 256;
+const unsigned int RDeviceStateShadow::u32MaxStreams			= 16;
+
+static const char* s_aryStateNames[EDeviceState_MAX] =
+{
+	"RenderState",
+	"SamplerState",
+	"Texture",
+	"VertexShader",
+	"PixelShader",
+	"VertexShaderConstant",
+	"PixelShaderConstant",
+	"VertexDeclaration",
+	"StreamSource",
+	"StreamSourceFreq",
+	"Indices",
+};
+
+RDeviceStateShadow::RDeviceStateShadow()
+{
+	m_aryRenderStates			= new ShadowValue[u32MaxRenderStates];
+	m_arySamplerStates			= new ShadowValue[u32MaxSamplers * u32MaxSamplerStates];
+	m_aryTextures				= new ShadowPointer[u32MaxSamplers];
+	m_aryVertexShaderConstants	= new ShadowConstant[u32MaxShaderConstants];
+	m_aryPixelShaderConstants	= new ShadowConstant[u32MaxShaderConstants];
+	m_aryStreams				= new ShadowStream[u32MaxStreams];
+	m_aryStreamFrequencies		= new ShadowValue[u32MaxStreams];
+
+	Invalidate();
+}
+
+RDeviceStateShadow::~RDeviceStateShadow()
+{
+	delete[] m_aryRenderStates;
+	delete[] m_arySamplerStates;
+	delete[] m_aryTextures;
+	delete[] m_aryVertexShaderConstants;
+	delete[] m_aryPixelShaderConstants;
+	delete[] m_aryStreams;
+	delete[] m_aryStreamFrequencies;
+}
+
+void RDeviceStateShadow::Invalidate()
+{
+	for (unsigned int i = 0; i < u32MaxRenderStates; ++i)
+	{
+		m_aryRenderStates[i].bValid = false;
+	}
+
+	for (unsigned int i = 0; i < u32MaxSamplers * u32MaxSamplerStates; ++i)
+	{
+		m_arySamplerStates[i].bValid = false;
+	}
+
+	for (unsigned int i = 0; i < u32MaxSamplers; ++i)
+	{
+		m_aryTextures[i].bValid = false;
+	}
+
+	for (unsigned int i = 0; i < u32MaxShaderConstants; ++i)
+	{
+		m_aryVertexShaderConstants[i].bValid = false;
+		m_aryPixelShaderConstants[i].bValid = false;
+	}
+
+	for (unsigned int i = 0; i < u32MaxStreams; ++i)
+	{
+		m_aryStreams[i].bValid = false;
+		m_aryStreamFrequencies[i].bValid = false;
+	}
+
+	m_VertexShader.bValid = false;
+	m_PixelShader.bValid = false;
+	m_VertexDeclaration.bValid = false;
+	m_Indices.bValid = false;
+}
+
+const char* RDeviceStateShadow::GetStateName(EDeviceState state)
+{
+	RwgeAssert(state < EDeviceState_MAX);
+
+	return s_aryStateNames[state];
+}
+
+bool RDeviceStateShadow::SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value)
+{
+	if (static_cast<unsigned int>(state) >= u32MaxRenderStates)
+	{
+		return Issue(EDS_RenderState);
+	}
+
+	return UpdateValue(m_aryRenderStates[state], u32Value, EDS_RenderState);
+}
+
+bool RDeviceStateShadow::SetSamplerState(unsigned long u32Sampler, D3DSAMPLERSTATETYPE type, unsigned long u32Value)
+{
+	int s32Sampler = GetSamplerIndex(u32Sampler);
+	if (s32Sampler < 0 || static_cast<unsigned int>(type) >= u32MaxSamplerStates)
+	{
+		return Issue(EDS_SamplerState);
+	}
+
+	return UpdateValue(m_arySamplerStates[s32Sampler * u32MaxSamplerStates + type], u32Value, EDS_SamplerState);
+}
+
+bool RDeviceStateShadow::SetTexture(unsigned long u32Sampler, IDirect3DBaseTexture9* pTexture)
+{
+	int s32Sampler = GetSamplerIndex(u32Sampler);
+	if (s32Sampler < 0)
+	{
+		return Issue(EDS_Texture);
+	}
+
+	return UpdatePointer(m_aryTextures[s32Sampler], pTexture, EDS_Texture);
+}
+
+bool RDeviceStateShadow::SetVertexShader(IDirect3DVertexShader9* pVertexShader)
+{
+	return UpdatePointer(m_VertexShader, pVertexShader, EDS_VertexShader);
+}
+
+bool RDeviceStateShadow::SetPixelShader(IDirect3DPixelShader9* pPixelShader)
+{
+	return UpdatePointer(m_PixelShader, pPixelShader, EDS_PixelShader);
+}
+
+bool RDeviceStateShadow::SetVertexShaderConstantF(unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount)
+{
+	return UpdateConstants(m_aryVertexShaderConstants, u32StartRegister, pData, u32RegisterCount, EDS_VertexShaderConstant);
+}
+
+bool RDeviceStateShadow::SetPixelShaderConstantF(unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount)
+{
+	return UpdateConstants(m_aryPixelShaderConstants, u32StartRegister, pData, u32RegisterCount, EDS_PixelShaderConstant);
+}
+
+bool RDeviceStateShadow::SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	return UpdatePointer(m_VertexDeclaration, pVertexDeclaration, EDS_VertexDeclaration);
+}
+
+bool RDeviceStateShadow::SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride)
+{
+	if (u32Stream >= u32MaxStreams)
+	{
+		return Issue(EDS_StreamSource);
+	}
+
+	ShadowStream& stream = m_aryStreams[u32Stream];
+	if (stream.bValid && stream.pVertexBuffer == pVertexBuffer && stream.u32Offset == u32Offset && stream.u32Stride == u32Stride)
+	{
+		return Skip(EDS_StreamSource);
+	}
+
+	stream.pVertexBuffer = pVertexBuffer;
+	stream.u32Offset = u32Offset;
+	stream.u32Stride = u32Stride;
+	stream.bValid = true;
+
+	return Issue(EDS_StreamSource);
+}
+
+bool RDeviceStateShadow::SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting)
+{
+	if (u32Stream >= u32MaxStreams)
+	{
+		return Issue(EDS_StreamSourceFreq);
+	}
+
+	return UpdateValue(m_aryStreamFrequencies[u32Stream], u32Setting, EDS_StreamSourceFreq);
+}
+
+bool RDeviceStateShadow::SetIndices(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	return UpdatePointer(m_Indices, pIndexBuffer, EDS_Indices);
+}
+
+bool RDeviceStateShadow::UpdateValue(ShadowValue& shadowValue, unsigned long u32Value, EDeviceState state)
+{
+	if (shadowValue.bValid && shadowValue.u32Value == u32Value)
+	{
+		return Skip(state);
+	}
+
+	shadowValue.u32Value = u32Value;
+	shadowValue.bValid = true;
+
+	return Issue(state);
+}
+
+bool RDeviceStateShadow::UpdatePointer(ShadowPointer& shadowPointer, const void* pValue, EDeviceState state)
+{
+	if (shadowPointer.bValid && shadowPointer.pValue == pValue)
+	{
+		return Skip(state);
+	}
+
+	shadowPointer.pValue = pValue;
+	shadowPointer.bValid = true;
+
+	return Issue(state);
+}
+
+bool RDeviceStateShadow::UpdateConstants(ShadowConstant* aryShadowConstants, unsigned int& u32StartRegister, const float*& pData, unsigned int& u32RegisterCount, EDeviceState state)
+{
+	if (u32StartRegister + u32RegisterCount > u32MaxShaderConstants)
+	{
+		return Issue(state);
+	}
+
+	// ҵһһֵıļĴͬʱӰ
+	int s32FirstChanged = -1;
+	int s32LastChanged = -1;
+	for (unsigned int i = 0; i < u32RegisterCount; ++i)
+	{
+		ShadowConstant& constant = aryShadowConstants[u32StartRegister + i];
+		const float* pValues = pData + i * 4;
+
+		if (constant.bValid && memcmp(constant.aryValues, pValues, sizeof(constant.aryValues)) == 0)
+		{
+			continue;
+		}
+
+		RwgeCopyMemory(constant.aryValues, pValues, sizeof(constant.aryValues));
+		constant.bValid = true;
+
+		if (s32FirstChanged < 0)
+		{
+			s32FirstChanged = i;
+		}
+		s32LastChanged = i;
+	}
+
+	if (s32FirstChanged < 0)
+	{
+		return Skip(state);
+	}
+
+	u32StartRegister += s32FirstChanged;
+	pData += s32FirstChanged * 4;
+	u32RegisterCount = s32LastChanged - s32FirstChanged + 1;
+
+	return Issue(state);
+}
+
+int RDeviceStateShadow::GetSamplerIndex(unsigned long u32Sampler) const
+{
+	// زΪ0 ~ 15ΪD3DVERTEXTEXTURESAMPLER0 ~ D3DVERTEXTEXTURESAMPLER3
+	if (u32Sampler < 16)
+	{
+		return static_cast<int>(u32Sampler);
+	}
+
+	if (u32Sampler >= D3DVERTEXTEXTURESAMPLER0 && u32Sampler - D3DVERTEXTEXTURESAMPLER0 < u32MaxSamplers - 16)
+	{
+		return static_cast<int>(u32Sampler - D3DVERTEXTEXTURESAMPLER0 + 16);
+	}
+
+	return -1;
+}
@@ -0,0 +1,279 @@
+#include "RwgeDynamicBatcher.h"
+
+#include <string.h>
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+#include <RwgeThreadPool.h>
+#include "RwgeDynamicUploader.h"
+#include "RwgeD3d9VertexDeclaration.h"
+#include "RwgeVertexDeclarationTemplate.h"
+
+#if RWGE_SIMD_SSE
+#	include <xmmintrin.h>
+#endif
+
+using namespace std;
+
+const unsigned int RDynamicBatcher::u32MaxUnitVertexCount	= 256;
+const unsigned int RDynamicBatcher::u32MaxBatchVertexCount	= 8192;
+const unsigned int RDynamicBatcher::u32MaxBatchIndexCount	= 24576;
+const unsigned int RDynamicBatcher::u32ParallelVertexCount	= 4096;
+
+// 任u32CountFLOAT3ԪأbPointΪtrueʱ任ƽƣֻ3x3
+static void TransformElements(unsigned char* pElement, unsigned int u32Count, unsigned int u32Stride, const D3DXMATRIX& matTransform, bool bPoint)
+{
+#if RWGE_SIMD_SSE
+	const __m128 row0 = _mm_loadu_ps(&matTransform._11);
+	const __m128 row1 = _mm_loadu_ps(&matTransform._21);
+	const __m128 row2 = _mm_loadu_ps(&matTransform._31);
+	const __m128 row3 = bPoint ? _mm_loadu_ps(&matTransform._41) : _mm_setzero_ps();
+
+	for (unsigned int u32Element = 0; u32Element < u32Count; ++u32Element, pElement += u32Stride)
+	{
+		float* pValue = reinterpret_cast<float*>(pElement);
+
+		__m128 result = _mm_add_ps(row3, _mm_mul_ps(_mm_set1_ps(pValue[0]), row0));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(pValue[1]), row1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(pValue[2]), row2));
+
+		_mm_storel_pi(reinterpret_cast<__m64*>(pValue), result);
+		_mm_store_ss(pValue + 2, _mm_movehl_ps(result, result));
+	}
+#else
+	const float f32W = bPoint ? 1.0f : 0.0f;
+
+	for (unsigned int u32Element = 0; u32Element < u32Count; ++u32Element, pElement += u32Stride)
+	{
+		float* pValue = reinterpret_cast<float*>(pElement);
+		float x = pValue[0], y = pValue[1], z = pValue[2];
+
+		pValue[0] = x * matTransform._11 + y * matTransform._21 + z * matTransform._31 + f32W * matTransform._41;
+		pValue[1] = x * matTransform._12 + y * matTransform._22 + z * matTransform._32 + f32W * matTransform._42;
+		pValue[2] = x * matTransform._13 + y * matTransform._23 + z * matTransform._33 + f32W * matTransform._43;
+	}
+#endif
+}
+
+RDynamicBatcher::RDynamicBatcher() :
+	m_pBatchVertices(nullptr)
+{
+	D3DXMatrixIdentity(&m_matIdentity);
+}
+
+RDynamicBatcher::~RDynamicBatcher()
+{
+
+}
+
+bool RDynamicBatcher::CanBatch(const RRenderUnit& renderUnit)
+{
+	const RD3d9VertexDeclaration* pVertexDeclaration = renderUnit.GetVertexDeclaration();
+	const IndexStream* pIndexStream = renderUnit.GetIndexStream();
+	const vector<VertexStream*>& vecVertexStreams = renderUnit.GetVertexStreams();
+
+	// ͼ˳ȾԪ۲췽лʼֻ֮ʹû˳
+	return renderUnit.GetPrimitiveType() == D3DPT_TRIANGLELIST &&
+		!renderUnit.HasViewOrders() &&
+		renderUnit.GetWorldTransform() != nullptr &&
+		renderUnit.GetVertexCount() <= u32MaxUnitVertexCount &&
+		pVertexDeclaration != nullptr && pVertexDeclaration->HasPosition() && pVertexDeclaration->GetStreamCount() == 1 &&
+		vecVertexStreams.size() == 1 && vecVertexStreams[0]->aryVertices != nullptr &&
+		renderUnit.GetBaseVertexIndex() + renderUnit.GetVertexCount() <= vecVertexStreams[0]->u32VertexCount &&
+		pIndexStream != nullptr && pIndexStream->aryIndices != nullptr &&
+		renderUnit.GetStartIndex() + renderUnit.GetPrimitveCount() * 3 <= pIndexStream->u32IndexCount;
+}
+
+const RRenderUnit* RDynamicBatcher::Batch(const RRenderUnit* const* aryRenderUnits, unsigned int u32Count)
+{
+	RwgeAssert(u32Count > 0);
+
+	const RD3d9VertexDeclaration* pVertexDeclaration = aryRenderUnits[0]->GetVertexDeclaration();
+
+	VertexLayout& layout = m_Layout;
+	BuildVertexLayout(pVertexDeclaration, layout);
+
+	// ================================ ȷÿȾԪеλ ================================
+	m_vecEntries.resize(u32Count);
+	unsigned int u32VertexCount = 0;
+	unsigned int u32IndexCount = 0;
+	for (unsigned int u32Unit = 0; u32Unit < u32Count; ++u32Unit)
+	{
+		RwgeAssert(aryRenderUnits[u32Unit]->GetVertexDeclaration() == pVertexDeclaration);
+
+		m_vecEntries[u32Unit].pRenderUnit = aryRenderUnits[u32Unit];
+		m_vecEntries[u32Unit].u32FirstVertex = u32VertexCount;
+		m_vecEntries[u32Unit].u32FirstIndex = u32IndexCount;
+
+		u32VertexCount += aryRenderUnits[u32Unit]->GetVertexCount();
+		u32IndexCount += aryRenderUnits[u32Unit]->GetPrimitveCount() * 3;
+	}
+
+	RwgeAssert(u32VertexCount <= u32MaxBatchVertexCount);
+	RwgeAssert(u32IndexCount <= u32MaxBatchIndexCount);
+
+	const unsigned int u32VertexDataSize = u32VertexCount * layout.u32Stride;
+	const unsigned int u32IndexDataSize = u32IndexCount * IndexStream::u8Index16Size;
+
+	// ================================ ¼ ================================
+	// ڼ¼һ֮ǰЧдٰѶֱӱ任
+	RDynamicUploader& uploader = RDynamicUploader::GetInstance();
+
+	unsigned int u32IndexOffset;
+	unsigned short* aryBatchIndices = static_cast<unsigned short*>(uploader.WriteIndices(u32IndexDataSize, u32IndexOffset));
+	if (aryBatchIndices == nullptr)
+	{
+		return nullptr;
+	}
+
+	WriteIndices(aryBatchIndices);
+
+	// ================================ 任 ================================
+	// 㰴д룬ʱͨBaseVertexIndexλ
+	unsigned int u32VertexOffset;
+	m_pBatchVertices = static_cast<unsigned char*>(uploader.WriteVertices(u32VertexDataSize, layout.u32Stride, u32VertexOffset));
+	if (m_pBatchVertices == nullptr)
+	{
+		return nullptr;
+	}
+
+	RThreadPool& threadPool = RThreadPool::GetInstance();
+	unsigned int u32MaxTaskCount = (threadPool.GetWorkerCount() + 1) * 2;
+	if (u32MaxTaskCount > u32Count)
+	{
+		u32MaxTaskCount = u32Count;
+	}
+
+	if (u32VertexCount < u32ParallelVertexCount || u32MaxTaskCount < 2)
+	{
+		TransformEntries(layout, 0, u32Count);
+	}
+	else
+	{
+		// ȾԪȵػָÿȾԪдȷ֮以Ӱ
+		m_vecTaskEntryBegin.clear();
+		for (unsigned int u32Unit = 0; u32Unit < u32Count; ++u32Unit)
+		{
+			unsigned int u32TaskIndex = static_cast<unsigned int>(m_vecTaskEntryBegin.size());
+			if (u32TaskIndex < u32MaxTaskCount && m_vecEntries[u32Unit].u32FirstVertex * u32MaxTaskCount >= u32VertexCount * u32TaskIndex)
+			{
+				m_vecTaskEntryBegin.push_back(u32Unit);
+			}
+		}
+
+		const unsigned int u32TaskCount = static_cast<unsigned int>(m_vecTaskEntryBegin.size());
+		m_vecTaskEntryBegin.push_back(u32Count);
+
+		threadPool.ParallelFor(u32TaskCount, [this, &layout](unsigned int u32Task)
+		{
+			TransformEntries(layout, m_vecTaskEntryBegin[u32Task], m_vecTaskEntryBegin[u32Task + 1]);
+		});
+	}
+
+	m_pBatchVertices = nullptr;
+
+	const unsigned int u32BaseVertex = u32VertexOffset / layout.u32Stride;
+	const unsigned int u32StartIndex = u32IndexOffset / IndexStream::u8Index16Size;
+
+	// ================================ »ʹõȾԪ ================================
+	if (m_RingIndexStream.pD3dIndexBuffer == nullptr)
+	{
+		m_RingIndexStream.u32IndexCount = uploader.GetIndexBufferSize() / IndexStream::u8Index16Size;
+		m_RingIndexStream.u32StreamSize = uploader.GetIndexBufferSize();
+		m_RingIndexStream.pD3dIndexBuffer = uploader.GetD3dIndexBuffer();
+	}
+
+	RingTarget& ringTarget = m_mapRingTargets[layout.u32Stride];
+	if (ringTarget.renderUnit.GetVertexStreams().empty())
+	{
+		// ֻڻУaryVerticesΪգȾԪΧ
+		ringTarget.vertexStream.u8VertexSize = static_cast<unsigned char>(layout.u32Stride);
+		ringTarget.vertexStream.u32VertexCount = uploader.GetVertexBufferSize() / layout.u32Stride;
+		ringTarget.vertexStream.u32StreamSize = ringTarget.vertexStream.u32VertexCount * layout.u32Stride;
+		ringTarget.vertexStream.pD3dVertexBuffer = uploader.GetD3dVertexBuffer();
+
+		ringTarget.renderUnit.AddVertexStream(&ringTarget.vertexStream);
+		ringTarget.renderUnit.SetIndexStream(&m_RingIndexStream);
+		ringTarget.renderUnit.SetPrimitiveType(D3DPT_TRIANGLELIST);
+		ringTarget.renderUnit.SetWorldTransform(&m_matIdentity);
+	}
+
+	ringTarget.renderUnit.SetVertexDeclaration(const_cast<RD3d9VertexDeclaration*>(pVertexDeclaration));
+	ringTarget.renderUnit.SetSubRange(u32BaseVertex, u32VertexCount, u32StartIndex, u32IndexCount / 3);
+
+	return &ringTarget.renderUnit;
+}
+
+void RDynamicBatcher::TransformEntries(const VertexLayout& layout, unsigned int u32Begin, unsigned int u32End)
+{
+	for (unsigned int u32Entry = u32Begin; u32Entry < u32End; ++u32Entry)
+	{
+		const BatchEntry& entry = m_vecEntries[u32Entry];
+		const RRenderUnit* pRenderUnit = entry.pRenderUnit;
+		const VertexStream* pVertexStream = pRenderUnit->GetVertexStreams()[0];
+		const unsigned int u32VertexCount = pRenderUnit->GetVertexCount();
+
+		// ƶ㣬ԭر任λ뷽
+		unsigned char* pDestination = m_pBatchVertices + entry.u32FirstVertex * layout.u32Stride;
+		const unsigned char* pSource = reinterpret_cast<const unsigned char*>(pVertexStream->aryVertices) + pRenderUnit->GetBaseVertexIndex() * layout.u32Stride;
+		memcpy(pDestination, pSource, u32VertexCount * layout.u32Stride);
+
+		const D3DXMATRIX& matWorld = *pRenderUnit->GetWorldTransform();
+		TransformElements(pDestination + layout.u32PositionOffset, u32VertexCount, layout.u32Stride, matWorld, true);
+		for (unsigned int u32DirectionOffset : layout.vecDirectionOffsets)
+		{
+			TransformElements(pDestination + u32DirectionOffset, u32VertexCount, layout.u32Stride, matWorld, false);
+		}
+	}
+}
+
+void RDynamicBatcher::WriteIndices(unsigned short* aryBatchIndices) const
+{
+	for (const BatchEntry& entry : m_vecEntries)
+	{
+		const RRenderUnit* pRenderUnit = entry.pRenderUnit;
+
+		// εĵһ㣻Դ32λģεĶ֤ϲ16λ
+		const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+		const unsigned int u32StartIndex = pRenderUnit->GetStartIndex();
+		unsigned short* aryDestinationIndices = aryBatchIndices + entry.u32FirstIndex;
+		const unsigned int u32IndexCount = pRenderUnit->GetPrimitveCount() * 3;
+
+		if (pIndexStream->u8IndexSize == IndexStream::u8Index16Size)
+		{
+			const unsigned short* aryIndices = static_cast<const unsigned short*>(pIndexStream->GetIndexData(u32StartIndex));
+			const unsigned short u16IndexOffset = static_cast<unsigned short>(entry.u32FirstVertex);
+
+			for (unsigned int u32Index = 0; u32Index < u32IndexCount; ++u32Index)
+			{
+				aryDestinationIndices[u32Index] = aryIndices[u32Index] + u16IndexOffset;
+			}
+		}
+		else
+		{
+			for (unsigned int u32Index = 0; u32Index < u32IndexCount; ++u32Index)
+			{
+				aryDestinationIndices[u32Index] = static_cast<unsigned short>(pIndexStream->GetIndex(u32StartIndex + u32Index) + entry.u32FirstVertex);
+			}
+		}
+	}
+}
+
+void RDynamicBatcher::BuildVertexLayout(const RD3d9VertexDeclaration* pVertexDeclaration, VertexLayout& outLayout)
+{
+	outLayout.u32Stride = pVertexDeclaration->GetVertexSizeOfStream(0);
+	outLayout.u32PositionOffset = pVertexDeclaration->GetPositionOffset();
+	outLayout.vecDirectionOffsets.clear();
+
+	// ߡߡֻ3x3֣ɫеı任һ
+	unsigned short u16ElementOffset = 0;
+	for (const VertexElement& element : pVertexDeclaration->GetTemplate().GetVertexElementListOfStream(0))
+	{
+		if (element.u8Type == D3DDECLTYPE_FLOAT3 &&
+			(element.u8Usage == D3DDECLUSAGE_NORMAL || element.u8Usage == D3DDECLUSAGE_TANGENT || element.u8Usage == D3DDECLUSAGE_BINORMAL))
+		{
+			outLayout.vecDirectionOffsets.push_back(u16ElementOffset);
+		}
+
+		u16ElementOffset += element.GetElementSize();
+	}
+}
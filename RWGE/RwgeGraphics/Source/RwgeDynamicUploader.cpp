@@ -0,0 +1,96 @@
+#include "RwgeDynamicUploader.h"
+
+#include "RwgeRenderDevice.h"
+#include "RwgeIndexStream.h"
+#include "RwgeD3d9VertexBuffer.h"
+#include "RwgeD3d9IndexBuffer.h"
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+
+RDynamicUploader::RDynamicUploader(RCommandBuffer& commandBuffer, unsigned int u32VertexBufferSize /* = 4 * 1024 * 1024 */, unsigned int u32IndexBufferSize /* = 1024 * 1024 */) :
+	m_CommandBuffer(commandBuffer),
+	m_pVertexBuffer(new RD3d9VertexBuffer(u32VertexBufferSize)),
+	m_pIndexBuffer(new RD3d9IndexBuffer(u32IndexBufferSize)),
+	m_VertexRing(u32VertexBufferSize),
+	m_IndexRing(u32IndexBufferSize)
+{
+
+}
+
+RDynamicUploader::~RDynamicUploader()
+{
+	delete m_pVertexBuffer;
+	delete m_pIndexBuffer;
+}
+
+void* RDynamicUploader::WriteVertices(unsigned int u32Size, unsigned int u32Alignment, unsigned int& u32Offset)
+{
+	RingAllocation allocation;
+	if (!m_VertexRing.Allocate(u32Size, u32Alignment, allocation))
+	{
+		RwgeLog(TEXT("Failed to allocate dynamic vertex data - Size : %u, FrameSize : %u, UsedSize : %u"),
+			u32Size,
+			m_VertexRing.GetFrameSize(),
+			m_VertexRing.GetUsedSize());
+		return nullptr;
+	}
+
+	u32Offset = allocation.u32Offset;
+
+	return m_pVertexBuffer->WriteData(m_CommandBuffer, allocation.u32Offset, u32Size, allocation.bDiscard);
+}
+
+void* RDynamicUploader::WriteIndices(unsigned int u32Size, unsigned int& u32Offset)
+{
+	RingAllocation allocation;
+	if (!m_IndexRing.Allocate(u32Size, IndexStream::u8Index16Size, allocation))
+	{
+		RwgeLog(TEXT("Failed to allocate dynamic index data - Size : %u, FrameSize : %u, UsedSize : %u"),
+			u32Size,
+			m_IndexRing.GetFrameSize(),
+			m_IndexRing.GetUsedSize());
+		return nullptr;
+	}
+
+	u32Offset = allocation.u32Offset;
+
+	return m_pIndexBuffer->WriteData(m_CommandBuffer, allocation.u32Offset, u32Size, allocation.bDiscard);
+}
+
+void RDynamicUploader::EndFrame(RRenderDevice& device)
+{
+	const unsigned int u32Fence = device.IssueFrameFence();
+	m_VertexRing.EndFrame(u32Fence);
+	m_IndexRing.EndFrame(u32Fence);
+
+	const unsigned int u32CompletedFence = device.GetCompletedFrameFence();
+	m_VertexRing.Retire(u32CompletedFence);
+	m_IndexRing.Retire(u32CompletedFence);
+}
+
+IDirect3DVertexBuffer9* RDynamicUploader::GetD3dVertexBuffer() const
+{
+	return m_pVertexBuffer->GetD3dVertexBuffer();
+}
+
+IDirect3DIndexBuffer9* RDynamicUploader::GetD3dIndexBuffer() const
+{
+	return m_pIndexBuffer->GetD3dIndexBuffer();
+}
+
+void RDynamicUploader::LogStatistics() const
+{
+	const RFrameRingAllocator* aryRings[] = { &m_VertexRing, &m_IndexRing };
+	const TCHAR* aryNames[] = { TEXT("Vertex"), TEXT("Index") };
+
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		RwgeLog(TEXT("Dynamic %s ring - Capacity : %u, Used : %u, InFlightFrames : %u, Discards : %u, Failures : %u"),
+			aryNames[i],
+			aryRings[i]->GetCapacity(),
+			aryRings[i]->GetUsedSize(),
+			aryRings[i]->GetInFlightFrameCount(),
+			aryRings[i]->GetDiscardCount(),
+			aryRings[i]->GetFailedCount());
+	}
+}
@@ -0,0 +1,256 @@
+#include "RwgeFrameStatistics.h"
+
+#include <fstream>
+#include <iomanip>
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+
+using namespace std;
+
+const unsigned int FrameStatistics::u32ColumnCount					= EFrameCounter_MAX + EFramePhase_MAX;
+const unsigned int RFrameStatisticsHistory::u32DefaultWindowSize	= 120;
+
+static const char* s_aryCounterNames[EFrameCounter_MAX] =
+{
+	"DrawCallCount",
+	"PrimitiveCount",
+	"VertexCount",
+	"ShaderSwitchCount",
+	"MaterialSwitchCount",
+	"TextureBindCount",
+	"StreamSourceChangeCount",
+	"ConstantBytes",
+	"OpaqueRenderUnitCount",
+	"MaskedRenderUnitCount",
+	"TranslucentRenderUnitCount",
+	"VisibleModelCount",
+	"CulledModelCount",
+	"DepthPrepassDrawCount",
+	"EstimatedCoveredPixels",
+	"EstimatedRasterizedPixels",
+	"EstimatedShadedPixels",
+};
+
+static const char* s_aryPhaseNames[EFramePhase_MAX] =
+{
+	"RenderSceneTime",
+	"BuildQueueTime",
+	"SubmitTime",
+};
+
+// д룬ʱλС
+static void WriteColumn(ostream& stream, const FrameStatistics& statistics, unsigned int u32Column)
+{
+	if (u32Column < EFrameCounter_MAX)
+	{
+		stream << statistics.aryCounters[u32Column];
+	}
+	else
+	{
+		stream << statistics.aryPhaseTimes[u32Column - EFrameCounter_MAX];
+	}
+}
+
+float FrameStatistics::GetColumn(unsigned int u32Column) const
+{
+	RwgeAssert(u32Column < u32ColumnCount);
+
+	if (u32Column < EFrameCounter_MAX)
+	{
+		return static_cast<float>(aryCounters[u32Column]);
+	}
+
+	return aryPhaseTimes[u32Column - EFrameCounter_MAX];
+}
+
+const char* FrameStatistics::GetColumnName(unsigned int u32Column)
+{
+	RwgeAssert(u32Column < u32ColumnCount);
+
+	if (u32Column < EFrameCounter_MAX)
+	{
+		return s_aryCounterNames[u32Column];
+	}
+
+	return s_aryPhaseNames[u32Column - EFrameCounter_MAX];
+}
+
+const char* FrameStatistics::GetCounterName(EFrameCounter counter)
+{
+	RwgeAssert(counter < EFrameCounter_MAX);
+
+	return s_aryCounterNames[counter];
+}
+
+const char* FrameStatistics::GetPhaseName(EFramePhase phase)
+{
+	RwgeAssert(phase < EFramePhase_MAX);
+
+	return s_aryPhaseNames[phase];
+}
+
+RFrameStatisticsHistory::RFrameStatisticsHistory() :
+	m_vecFrames(u32DefaultWindowSize),
+	m_u32NextFrame(0),
+	m_u32FrameCount(0),
+	m_u32TotalFrameCount(0)
+{
+
+}
+
+RFrameStatisticsHistory::~RFrameStatisticsHistory()
+{
+
+}
+
+void RFrameStatisticsHistory::SetWindowSize(unsigned int u32WindowSize)
+{
+	RwgeAssert(u32WindowSize > 0);
+
+	m_vecFrames.assign(u32WindowSize, FrameStatistics());
+	Clear();
+}
+
+void RFrameStatisticsHistory::Clear()
+{
+	m_u32NextFrame = 0;
+	m_u32FrameCount = 0;
+	m_u32TotalFrameCount = 0;
+}
+
+void RFrameStatisticsHistory::AddFrame(const FrameStatistics& statistics)
+{
+	m_vecFrames[m_u32NextFrame] = statistics;
+	m_u32NextFrame = (m_u32NextFrame + 1) % m_vecFrames.size();
+
+	if (m_u32FrameCount < m_vecFrames.size())
+	{
+		++m_u32FrameCount;
+	}
+	++m_u32TotalFrameCount;
+}
+
+const FrameStatistics& RFrameStatisticsHistory::GetFrame(unsigned int u32Frame) const
+{
+	RwgeAssert(u32Frame < m_u32FrameCount);
+
+	// δʱһ֡λ±0λһ֡дλ
+	unsigned int u32First = m_u32FrameCount < m_vecFrames.size() ? 0 : m_u32NextFrame;
+	return m_vecFrames[(u32First + u32Frame) % m_vecFrames.size()];
+}
+
+FrameStatisticsRange RFrameStatisticsHistory::GetCounterRange(EFrameCounter counter) const
+{
+	RwgeAssert(counter < EFrameCounter_MAX);
+
+	return GetColumnRange(counter);
+}
+
+FrameStatisticsRange RFrameStatisticsHistory::GetPhaseRange(EFramePhase phase) const
+{
+	RwgeAssert(phase < EFramePhase_MAX);
+
+	return GetColumnRange(EFrameCounter_MAX + phase);
+}
+
+FrameStatisticsRange RFrameStatisticsHistory::GetColumnRange(unsigned int u32Column) const
+{
+	FrameStatisticsRange range;
+	if (m_u32FrameCount == 0)
+	{
+		return range;
+	}
+
+	// ܴܺۼʹ˫
+	double f64Sum = 0.0;
+	range.f32Min = range.f32Max = GetFrame(0).GetColumn(u32Column);
+	for (unsigned int u32Frame = 0; u32Frame < m_u32FrameCount; ++u32Frame)
+	{
+		float f32Value = GetFrame(u32Frame).GetColumn(u32Column);
+		range.f32Min = min(range.f32Min, f32Value);
+		range.f32Max = max(range.f32Max, f32Value);
+		f64Sum += f32Value;
+	}
+	range.f32Average = static_cast<float>(f64Sum / m_u32FrameCount);
+
+	return range;
+}
+
+bool RFrameStatisticsHistory::SaveToCsv(const TCHAR* szPath) const
+{
+	ofstream csvFile(szPath, ios::out);
+	if (!csvFile)
+	{
+		RwgeLog(TEXT("Failed to open statistics file \"%s\"."), szPath);
+		return false;
+	}
+
+	csvFile << fixed << setprecision(3) << "Frame";
+	for (unsigned int u32Column = 0; u32Column < FrameStatistics::u32ColumnCount; ++u32Column)
+	{
+		csvFile << ',' << FrameStatistics::GetColumnName(u32Column);
+	}
+	csvFile << '\n';
+
+	for (unsigned int u32Frame = 0; u32Frame < m_u32FrameCount; ++u32Frame)
+	{
+		const FrameStatistics& statistics = GetFrame(u32Frame);
+
+		csvFile << GetFirstFrameNumber() + u32Frame;
+		for (unsigned int u32Column = 0; u32Column < FrameStatistics::u32ColumnCount; ++u32Column)
+		{
+			csvFile << ',';
+			WriteColumn(csvFile, statistics, u32Column);
+		}
+		csvFile << '\n';
+	}
+
+	return csvFile.good();
+}
+
+bool RFrameStatisticsHistory::SaveToJson(const TCHAR* szPath) const
+{
+	ofstream jsonFile(szPath, ios::out);
+	if (!jsonFile)
+	{
+		RwgeLog(TEXT("Failed to open statistics file \"%s\"."), szPath);
+		return false;
+	}
+
+	jsonFile << fixed << setprecision(3) << "{\n";
+	jsonFile << "\t\"windowSize\": " << GetWindowSize() << ",\n";
+	jsonFile << "\t\"frameCount\": " << m_u32FrameCount << ",\n";
+	jsonFile << "\t\"firstFrame\": " << GetFirstFrameNumber() << ",\n";
+
+	// ÿͳƵķΧ
+	jsonFile << "\t\"summary\": {\n";
+	for (unsigned int u32Column = 0; u32Column < FrameStatistics::u32ColumnCount; ++u32Column)
+	{
+		FrameStatisticsRange range = GetColumnRange(u32Column);
+		jsonFile << "\t\t\"" << FrameStatistics::GetColumnName(u32Column) << "\": { "
+			<< "\"min\": " << range.f32Min << ", "
+			<< "\"avg\": " << range.f32Average << ", "
+			<< "\"max\": " << range.f32Max << " }"
+			<< (u32Column + 1 < FrameStatistics::u32ColumnCount ? ",\n" : "\n");
+	}
+	jsonFile << "\t},\n";
+
+	// ֡ݣÿ֡һ
+	jsonFile << "\t\"frames\": [\n";
+	for (unsigned int u32Frame = 0; u32Frame < m_u32FrameCount; ++u32Frame)
+	{
+		const FrameStatistics& statistics = GetFrame(u32Frame);
+
+		jsonFile << "\t\t{ \"Frame\": " << GetFirstFrameNumber() + u32Frame;
+		for (unsigned int u32Column = 0; u32Column < FrameStatistics::u32ColumnCount; ++u32Column)
+		{
+			jsonFile << ", \"" << FrameStatistics::GetColumnName(u32Column) << "\": ";
+			WriteColumn(jsonFile, statistics, u32Column);
+		}
+		jsonFile << (u32Frame + 1 < m_u32FrameCount ? " },\n" : " }\n");
+	}
+	jsonFile << "\t]\n";
+	jsonFile << "}\n";
+
+	return jsonFile.good();
+}
@@ -0,0 +1,199 @@
+#include "RwgeGpuMemoryManager.h"
+
+#include <algorithm>
+#include "RwgeVertexStream.h"
+#include "RwgeIndexStream.h"
+#include "RwgeD3d9VertexBuffer.h"
+#include "RwgeD3d9IndexBuffer.h"
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+
+using namespace std;
+
+const unsigned int RGpuMemoryManager::u32Alignment = 16;
+
+static const TCHAR* s_aryBufferTypeNames[EGpuBufferType_MAX] =
+{
+	TEXT("Vertex"),
+	TEXT("Index"),
+	TEXT("Index32"),
+};
+
+struct GpuBufferPage
+{
+	EGpuBufferType		type;
+	RD3d9VertexBuffer*	pVertexBuffer;
+	RD3d9IndexBuffer*	pIndexBuffer;
+	RTlsfAllocator		allocator;
+
+	GpuBufferPage(EGpuBufferType bufferType, unsigned int u32Size, unsigned int u32Alignment) :
+		type(bufferType),
+		pVertexBuffer(bufferType == EGBT_Vertex ? new RD3d9VertexBuffer(u32Size, false) : nullptr),
+		pIndexBuffer(bufferType != EGBT_Vertex ? new RD3d9IndexBuffer(u32Size, false, bufferType == EGBT_Index32 ? IndexStream::u8Index32Size : IndexStream::u8Index16Size) : nullptr),
+		allocator(u32Size, u32Alignment)
+	{
+
+	}
+
+	~GpuBufferPage()
+	{
+		delete pVertexBuffer;
+		delete pIndexBuffer;
+	}
+};
+
+RGpuMemoryManager::RGpuMemoryManager(unsigned int u32VertexPageSize /* = 4 * 1024 * 1024 */, unsigned int u32IndexPageSize /* = 1024 * 1024 */)
+{
+	m_aryPageSizes[EGBT_Vertex] = u32VertexPageSize;
+	m_aryPageSizes[EGBT_Index] = u32IndexPageSize;
+	m_aryPageSizes[EGBT_Index32] = u32IndexPageSize;
+}
+
+RGpuMemoryManager::~RGpuMemoryManager()
+{
+	for (unsigned int u32Type = 0; u32Type < EGpuBufferType_MAX; ++u32Type)
+	{
+		for (GpuBufferPage* pPage : m_aryPages[u32Type])
+		{
+			delete pPage;
+		}
+		m_aryPages[u32Type].clear();
+	}
+}
+
+bool RGpuMemoryManager::BindVertexStream(VertexStream* pVertexStream, GpuAllocation& allocation)
+{
+	RwgeAssert(pVertexStream);
+	RwgeAssert(!allocation.IsValid());
+
+	allocation.pPage = Allocate(EGBT_Vertex, pVertexStream->u32StreamSize, allocation.allocation);
+	if (allocation.pPage == nullptr)
+	{
+		return false;
+	}
+
+	if (!allocation.pPage->pVertexBuffer->BindVertexStream(pVertexStream, allocation.allocation.u32Offset))
+	{
+		Free(allocation);
+		return false;
+	}
+
+	return true;
+}
+
+bool RGpuMemoryManager::BindIndexStream(IndexStream* pIndexStream, GpuAllocation& allocation)
+{
+	RwgeAssert(pIndexStream);
+	RwgeAssert(!allocation.IsValid());
+
+	allocation.pPage = Allocate(pIndexStream->u8IndexSize == IndexStream::u8Index32Size ? EGBT_Index32 : EGBT_Index, pIndexStream->u32StreamSize, allocation.allocation);
+	if (allocation.pPage == nullptr)
+	{
+		return false;
+	}
+
+	if (!allocation.pPage->pIndexBuffer->BindIndexStream(pIndexStream, allocation.allocation.u32Offset))
+	{
+		Free(allocation);
+		return false;
+	}
+
+	return true;
+}
+
+bool RGpuMemoryManager::UpdateVertexStream(const GpuAllocation& allocation, VertexStream* pVertexStream) const
+{
+	RwgeAssert(allocation.IsValid() && allocation.pPage->type == EGBT_Vertex);
+	RwgeAssert(pVertexStream->u32StreamOffset == allocation.allocation.u32Offset);
+
+	return allocation.pPage->pVertexBuffer->UpdateVertexStream(pVertexStream);
+}
+
+void RGpuMemoryManager::Free(GpuAllocation& allocation)
+{
+	if (!allocation.IsValid())
+	{
+		return;
+	}
+
+	GpuBufferPage* pPage = allocation.pPage;
+	pPage->allocator.Free(allocation.allocation);
+	allocation = GpuAllocation();
+
+	// ҳʱͷţÿֻٱһҳⷴжʱظ
+	vector<GpuBufferPage*>& vecPages = m_aryPages[pPage->type];
+	if (pPage->allocator.IsEmpty() && vecPages.size() > 1)
+	{
+		vecPages.erase(find(vecPages.begin(), vecPages.end(), pPage));
+		delete pPage;
+	}
+}
+
+GpuMemoryStatistics RGpuMemoryManager::GetStatistics(EGpuBufferType type) const
+{
+	RwgeAssert(type < EGpuBufferType_MAX);
+
+	GpuMemoryStatistics statistics;
+	for (const GpuBufferPage* pPage : m_aryPages[type])
+	{
+		const RTlsfAllocator& allocator = pPage->allocator;
+		const unsigned int u32LargestFreeBlock = allocator.GetLargestFreeBlock();
+
+		++statistics.u32PageCount;
+		statistics.u32Capacity += allocator.GetCapacity();
+		statistics.u32UsedSize += allocator.GetUsedSize();
+		statistics.u32AllocationCount += allocator.GetAllocationCount();
+		statistics.u32FreeBlockCount += allocator.GetFreeBlockCount();
+		statistics.u32LargestFreeBlock = u32LargestFreeBlock > statistics.u32LargestFreeBlock ? u32LargestFreeBlock : statistics.u32LargestFreeBlock;
+	}
+
+	const unsigned int u32FreeSize = statistics.u32Capacity - statistics.u32UsedSize;
+	statistics.f32Fragmentation = u32FreeSize > 0 ? 1.0f - static_cast<float>(statistics.u32LargestFreeBlock) / u32FreeSize : 0.0f;
+
+	return statistics;
+}
+
+void RGpuMemoryManager::LogStatistics() const
+{
+	for (unsigned int u32Type = 0; u32Type < EGpuBufferType_MAX; ++u32Type)
+	{
+		const GpuMemoryStatistics statistics = GetStatistics(static_cast<EGpuBufferType>(u32Type));
+
+		RwgeLog(TEXT("GPU %s buffers - Pages : %u, Capacity : %u, Used : %u, Allocations : %u, FreeBlocks : %u, LargestFreeBlock : %u, Fragmentation : %.3f"),
+			s_aryBufferTypeNames[u32Type],
+			statistics.u32PageCount,
+			statistics.u32Capacity,
+			statistics.u32UsedSize,
+			statistics.u32AllocationCount,
+			statistics.u32FreeBlockCount,
+			statistics.u32LargestFreeBlock,
+			statistics.f32Fragmentation);
+	}
+}
+
+GpuBufferPage* RGpuMemoryManager::Allocate(EGpuBufferType type, unsigned int u32Size, TlsfAllocation& allocation)
+{
+	for (GpuBufferPage* pPage : m_aryPages[type])
+	{
+		if (pPage->allocator.Allocate(u32Size, allocation))
+		{
+			return pPage;
+		}
+	}
+
+	// ҳСʹһҳ
+	unsigned int u32PageSize = (u32Size + u32Alignment - 1) / u32Alignment * u32Alignment;
+	u32PageSize = u32PageSize > m_aryPageSizes[type] ? u32PageSize : m_aryPageSizes[type];
+
+	GpuBufferPage* pPage = new GpuBufferPage(type, u32PageSize, u32Alignment);
+	if (!pPage->allocator.Allocate(u32Size, allocation))
+	{
+		RwgeLog(TEXT("Failed to allocate %s buffer memory - Size : %u"), s_aryBufferTypeNames[type], u32Size);
+		delete pPage;
+		return nullptr;
+	}
+
+	m_aryPages[type].push_back(pPage);
+
+	return pPage;
+}
@@ -1,11 +1,14 @@
 #include "RwgeLight.h"
 
+unsigned int RLight::m_u32ColorRevision = 0;
+
 RLight::RLight() : 
 	m_AmbientColor(0.0f, 0.0f, 0.0f), 
 	m_DiffuseColor(0.0f, 0.0f, 0.0f),
 	m_u16ConstantCount(0),
 	m_aryConstants(nullptr),
-	m_bConstantBufferOutOfDate(true)
+	m_bConstantBufferOutOfDate(true),
+	m_u32ConstantBufferRevision(0xFFFFFFFF)
 {
 
 }
@@ -17,9 +20,12 @@ RLight::~RLight()
 
 const float* RLight::GetConstants() const
 {
-	if (m_bConstantBufferOutOfDate)
+	// Դ任ıʱͬҪ
+	unsigned int u32WorldRevision = GetWorldRevision();
+	if (m_bConstantBufferOutOfDate || m_u32ConstantBufferRevision != u32WorldRevision)
 	{
 		UpdateConstantBuffer();
+		m_u32ConstantBufferRevision = u32WorldRevision;
 	}
 
 	return m_aryConstants;
@@ -29,18 +35,14 @@ void RLight::SetAmbietnColor(const FColorRGB& color)
 {
 	m_AmbientColor = color;
 	m_bConstantBufferOutOfDate = true;
+	++m_u32ColorRevision;
 }
 
 void RLight::SetDiffuseColor(const FColorRGB& color)
 {
 	m_DiffuseColor = color;
 	m_bConstantBufferOutOfDate = true;
-}
-
-void RLight::UpdateWorldTransform() const
-{
-	RSceneNode::UpdateWorldTransform();
-	m_bConstantBufferOutOfDate = true;
+	++m_u32ColorRevision;
 }
 
 RDirectionalLight::RDirectionalLight() : RLight()
@@ -19,6 +19,9 @@ using namespace std;
 #define u16ConstantCount(MaterialAttribute)					(u16##MaterialAttribute##ConstantCount)
 #define u8TextureCount(MaterialAttribute)					(u8##MaterialAttribute##TextureCount)
 
+unsigned short RMaterial::m_u16NextSortId = 0;
+unsigned int RMaterial::m_u32UpdateRevision = 0;
+
 RMaterial::RMaterial() : 
 	m_pBaseColor			(new MExpConstantColor()),
 	m_pEmissiveColor		(new MExpConstantColor()),
@@ -36,6 +39,7 @@ RMaterial::RMaterial() :
 	m_aryConstants			(nullptr),
 	m_u8TextureCount		(0),
 	m_aryTextures			(nullptr),
+	m_u16SortId				(m_u16NextSortId++),
 	m_pCachedShader			(nullptr)
 {
 
@@ -115,6 +119,8 @@ bool RMaterial::IsFullyRough() const
 
 void RMaterial::Update()
 {
+	++m_u32UpdateRevision;
+
 	// ==================================== ³ ====================================
 	unsigned short u16ConstantCount(BaseColor)		= GetMemberConstantCount(BaseColor);
 	unsigned short u16ConstantCount(EmissiveColor)	= GetMemberConstantCount(EmissiveColor);
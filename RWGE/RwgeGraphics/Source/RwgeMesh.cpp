@@ -1,5 +1,8 @@
 #include "RwgeMesh.h"
 
+#include "RwgeRenderUnit.h"
+
+unsigned int RMesh::m_u32MaterialRevision = 0;
 
 RMesh::RMesh()
 {
@@ -13,6 +16,7 @@ RMesh::~RMesh()
 void RMesh::SetMaterial(RMaterial* pMaterial)
 {
 	m_pMaterial = pMaterial;
+	++m_u32MaterialRevision;
 }
 
 RMaterial* RMesh::GetMaterial() const
@@ -23,6 +27,7 @@ RMaterial* RMesh::GetMaterial() const
 void RMesh::AddRenderUnit(RRenderUnit* pPrimitive)
 {
 	m_listPrimitives.push_back(pPrimitive);
+	m_LocalBounds.Merge(pPrimitive->GetLocalBounds());
 }
 
 const std::list<RRenderUnit*>& RMesh::GetRenderUnits()
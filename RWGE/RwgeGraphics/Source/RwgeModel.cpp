@@ -1,7 +1,23 @@
 #include "RwgeModel.h"
 
+#include "RwgeMesh.h"
+#include "RwgeMaterial.h"
+#include "RwgeRenderUnit.h"
+#include "RwgeVertexStream.h"
+#include "RwgeIndexStream.h"
+#include "RwgeD3d9VertexDeclaration.h"
+#include "RwgeOcclusionBuffer.h"
+#include "RwgeSceneManager.h"
 
-RModel::RModel() : RSceneNode()
+RModel::RModel() : 
+	RSceneNode(),
+	m_u32RenderUnitCount(0),
+	m_u32OccluderTriangleCount(0),
+	m_u32WorldBoundsRevision(0xFFFFFFFF),
+	m_bLocalBoundsOutOfDate(true),
+	m_OccluderMode(EOM_Auto),
+	m_bStatic(false),
+	m_bStaticBatched(false)
 {
 	m_NodeType = ENT_Model;
 }
@@ -14,9 +30,149 @@ RModel::~RModel()
 void RModel::AddMesh(RMesh* pMesh)
 {
 	m_listMeshes.push_back(pMesh);
+
+	NeedUpdateLocalBounds();
+}
+
+void RModel::NeedUpdateLocalBounds()
+{
+	m_bLocalBoundsOutOfDate = true;
+
+	if (m_pSceneManager)
+	{
+		m_pSceneManager->NotifyModelBoundsChanged(this);
+	}
 }
 
 std::list<RMesh*>& RModel::GetMeshes()
 {
 	return m_listMeshes;
 }
+
+const RBounds& RModel::GetLocalBounds() const
+{
+	if (m_bLocalBoundsOutOfDate)
+	{
+		UpdateLocalBounds();
+	}
+
+	return m_LocalBounds;
+}
+
+const RBounds& RModel::GetWorldBounds() const
+{
+	if (m_bLocalBoundsOutOfDate)
+	{
+		UpdateLocalBounds();
+	}
+
+	unsigned int u32WorldRevision = GetWorldRevision();
+	if (m_u32WorldBoundsRevision != u32WorldRevision)
+	{
+		m_LocalBounds.Transform(m_WorldBounds, GetWorldTransform());
+		m_u32WorldBoundsRevision = u32WorldRevision;
+	}
+
+	return m_WorldBounds;
+}
+
+unsigned int RModel::GetRenderUnitCount() const
+{
+	if (m_bLocalBoundsOutOfDate)
+	{
+		UpdateLocalBounds();
+	}
+
+	return m_u32RenderUnitCount;
+}
+
+unsigned int RModel::GetOccluderTriangleCount() const
+{
+	if (m_bLocalBoundsOutOfDate)
+	{
+		UpdateLocalBounds();
+	}
+
+	return m_u32OccluderTriangleCount;
+}
+
+void RModel::AddToOcclusionBuffer(ROcclusionBuffer& occlusionBuffer) const
+{
+	const D3DXMATRIX& worldTransform = GetWorldTransform();
+
+	for (RMesh* pMesh : m_listMeshes)
+	{
+		for (RRenderUnit* pRenderUnit : pMesh->GetRenderUnits())
+		{
+			if (!IsOccluderRenderUnit(pMesh, pRenderUnit))
+			{
+				continue;
+			}
+
+			const RD3d9VertexDeclaration* pVertexDeclaration = pRenderUnit->GetVertexDeclaration();
+			const VertexStream* pVertexStream = pRenderUnit->GetVertexStreams()[pVertexDeclaration->GetPositionStream()];
+			const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+
+			// ȾԪֻʹеһʱʼ
+			const unsigned int u32BaseVertexIndex = pRenderUnit->GetBaseVertexIndex();
+
+			occlusionBuffer.AddOccluder(
+				reinterpret_cast<const unsigned char*>(pVertexStream->aryVertices) + u32BaseVertexIndex * pVertexStream->u8VertexSize + pVertexDeclaration->GetPositionOffset(),
+				pVertexStream->u32VertexCount - u32BaseVertexIndex,
+				pVertexStream->u8VertexSize,
+				pIndexStream ? pIndexStream->GetIndexData(pRenderUnit->GetStartIndex()) : nullptr,
+				pIndexStream ? pIndexStream->u8IndexSize : IndexStream::u8Index16Size,
+				pRenderUnit->GetPrimitveCount(),
+				worldTransform);
+		}
+	}
+}
+
+bool RModel::IsOccluderRenderUnit(const RMesh* pMesh, const RRenderUnit* pRenderUnit)
+{
+	// ֻв͸ʲڵ壬Maskedʿܴο
+	if (pMesh->GetMaterial() == nullptr || pMesh->GetMaterial()->GetBlendMode() != EBM_Opaque)
+	{
+		return false;
+	}
+
+	const RD3d9VertexDeclaration* pVertexDeclaration = pRenderUnit->GetVertexDeclaration();
+	if (pRenderUnit->GetPrimitiveType() != D3DPT_TRIANGLELIST ||
+		pVertexDeclaration == nullptr || !pVertexDeclaration->HasPosition() ||
+		pVertexDeclaration->GetPositionStream() >= pRenderUnit->GetVertexStreams().size())
+	{
+		return false;
+	}
+
+	// դȡCPU˵ĶݣѾͷţֻGPU壩ȾԪΪڵ壬ڵεԤҲ
+	const VertexStream* pVertexStream = pRenderUnit->GetVertexStreams()[pVertexDeclaration->GetPositionStream()];
+	const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+
+	return	pVertexStream != nullptr && pVertexStream->aryVertices != nullptr &&
+			(pIndexStream == nullptr || pIndexStream->aryIndices != nullptr);
+}
+
+void RModel::UpdateLocalBounds() const
+{
+	m_LocalBounds.Reset();
+	m_u32RenderUnitCount = 0;
+	m_u32OccluderTriangleCount = 0;
+
+	for (RMesh* pMesh : m_listMeshes)
+	{
+		m_LocalBounds.Merge(pMesh->GetLocalBounds());
+		m_u32RenderUnitCount += pMesh->GetRenderUnits().size();
+
+		for (RRenderUnit* pRenderUnit : pMesh->GetRenderUnits())
+		{
+			if (IsOccluderRenderUnit(pMesh, pRenderUnit))
+			{
+				m_u32OccluderTriangleCount += pRenderUnit->GetPrimitveCount();
+			}
+		}
+	}
+
+	// ֲΧ巢ı䣬ΧҪ¼
+	m_u32WorldBoundsRevision = 0xFFFFFFFF;
+	m_bLocalBoundsOutOfDate = false;
+}
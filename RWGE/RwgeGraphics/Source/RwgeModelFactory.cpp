@@ -7,10 +7,19 @@
 #include "RwgeVertexStream.h"
 #include "RwgeIndexStream.h"
 #include "RwgeD3d9VertexDeclaration.h"
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+#include <algorithm>
+#include <vector>
 #include <fstream>
 
 using namespace std;
 
+// ļ[Magic][][][ֽ][][][ͼ˳][ͼ˳]Rwge3dsMaxPlugеRwgeModelFile.hһ
+// ûMagicľļֱԶʼûֽ16λ
+// ͼ˳Ϊ0RRenderUnit::u8ViewOrderCountÿͼ˳*3ͬļ֮Ϊ0
+static const unsigned int u32MeshFileMagic = 0x48534D52;		// "RMSH"
+
 struct VertexData
 {
 	D3DXVECTOR3 position;
@@ -33,6 +42,84 @@ struct VertexData
 	}
 };
 
+struct AttributeData
+{
+	D3DXVECTOR2 texCoord;
+	D3DXVECTOR3 normal;
+	D3DXVECTOR3 tangent;
+};
+
+struct SkinnedDynamicData
+{
+	D3DXVECTOR3 normal;
+	D3DXVECTOR3 tangent;
+};
+
+// ְѽĶݲΪȾԪöӦĶֺaryVerticesͷ
+// ҪDYNAMICеĶ
+static unsigned int AddVertexStreams(RRenderUnit* pRenderUnit, VertexData* aryVertices, unsigned int u32VertexCount, EVertexStreamLayout layout)
+{
+	RVertexDeclarationManager& declarationManager = RVertexDeclarationManager::GetInstance();
+
+	switch (layout)
+	{
+	case EVSL_PositionSplit:
+		{
+			D3DXVECTOR3* aryPositions = new D3DXVECTOR3[u32VertexCount];
+			AttributeData* aryAttributes = new AttributeData[u32VertexCount];
+			for (unsigned int i = 0; i < u32VertexCount; ++i)
+			{
+				aryPositions[i] = aryVertices[i].position;
+				aryAttributes[i].texCoord = aryVertices[i].texCoord;
+				aryAttributes[i].normal = aryVertices[i].normal;
+				aryAttributes[i].tangent = aryVertices[i].tangent;
+			}
+			delete[] aryVertices;
+
+			pRenderUnit->SetVertexDeclaration(declarationManager.GetPositionSplitVertexDeclaration());
+			pRenderUnit->AddVertexStream(new VertexStream(sizeof(D3DXVECTOR3), u32VertexCount, aryPositions));
+			pRenderUnit->AddVertexStream(new VertexStream(sizeof(AttributeData), u32VertexCount, aryAttributes));
+		}
+		break;
+
+	case EVSL_SkinnedSplit:
+		{
+			D3DXVECTOR3* aryPositions = new D3DXVECTOR3[u32VertexCount];
+			SkinnedDynamicData* aryDynamicData = new SkinnedDynamicData[u32VertexCount];
+			D3DXVECTOR2* aryTexCoords = new D3DXVECTOR2[u32VertexCount];
+			for (unsigned int i = 0; i < u32VertexCount; ++i)
+			{
+				aryPositions[i] = aryVertices[i].position;
+				aryDynamicData[i].normal = aryVertices[i].normal;
+				aryDynamicData[i].tangent = aryVertices[i].tangent;
+				aryTexCoords[i] = aryVertices[i].texCoord;
+			}
+			delete[] aryVertices;
+
+			pRenderUnit->SetVertexDeclaration(declarationManager.GetSkinnedSplitVertexDeclaration());
+			pRenderUnit->AddVertexStream(new VertexStream(sizeof(D3DXVECTOR3), u32VertexCount, aryPositions));
+			pRenderUnit->AddVertexStream(new VertexStream(sizeof(SkinnedDynamicData), u32VertexCount, aryDynamicData));
+			pRenderUnit->AddVertexStream(new VertexStream(sizeof(D3DXVECTOR2), u32VertexCount, aryTexCoords));
+		}
+		break;
+
+	case EVSL_Interleaved:
+	default:
+		pRenderUnit->SetVertexDeclaration(declarationManager.GetDefaultVertexDeclaration());
+		pRenderUnit->AddVertexStream(new VertexStream(sizeof(VertexData), u32VertexCount, aryVertices));
+		break;
+	}
+
+	const RD3d9VertexDeclaration* pVertexDeclaration = pRenderUnit->GetVertexDeclaration();
+	for (unsigned int i = 0; i < pRenderUnit->GetVertexStreams().size(); ++i)
+	{
+		RwgeAssert(pRenderUnit->GetVertexStreams()[i]->u8VertexSize == pVertexDeclaration->GetVertexSizeOfStream(i));
+	}
+
+	// CPUƤÿ֡дλáڵ
+	return layout == EVSL_SkinnedSplit ? 0x3 : 0;
+}
+
 RModel* ModelFactory::CreateTriangle()
 {
 	RModel* pModel = new RModel();
@@ -203,45 +290,148 @@ RModel* ModelFactory::CreateBox()
 	return pModel;
 }
 
-RMesh* ModelFactory::LoadMesh(const string& strPath)
+// ȡu32IndexCountu8FileIndexSizeֽڵκһСu32VertexCountʱnullptr
+// ʱ32λתΪ16λ
+// ȡu32IndexCount׷ӵvecIndicesĩβļضϻ㷶Χʱfalse
+static bool ReadIndices(ifstream& meshFile, unsigned int u32IndexCount, unsigned char u8FileIndexSize, unsigned int u32VertexCount, vector<unsigned int>& vecIndices)
 {
-	RMesh* pMesh = new RMesh();
+	const size_t u32FirstIndex = vecIndices.size();
+	vecIndices.resize(u32FirstIndex + u32IndexCount);
+	if (u8FileIndexSize == IndexStream::u8Index32Size)
+	{
+		meshFile.read(reinterpret_cast<char*>(vecIndices.data() + u32FirstIndex), u32IndexCount * sizeof(unsigned int));
+	}
+	else
+	{
+		vector<unsigned short> vecIndices16(u32IndexCount);
+		meshFile.read(reinterpret_cast<char*>(vecIndices16.data()), u32IndexCount * sizeof(unsigned short));
+		copy(vecIndices16.begin(), vecIndices16.end(), vecIndices.begin() + u32FirstIndex);
+	}
+
+	if (!meshFile)
+	{
+		vecIndices.resize(u32FirstIndex);
+		return false;
+	}
+
+	for (size_t i = u32FirstIndex; i < vecIndices.size(); ++i)
+	{
+		if (vecIndices[i] >= u32VertexCount)
+		{
+			RwgeLog(TEXT("Index out of range - Index : %u, Value : %u, VertexCount : %u"), static_cast<unsigned int>(i), vecIndices[i], u32VertexCount);
+			vecIndices.resize(u32FirstIndex);
+			return false;
+		}
+	}
 
+	return true;
+}
+
+static IndexStream* CreateIndexStream(const vector<unsigned int>& vecIndices, unsigned int u32VertexCount)
+{
+	const unsigned int u32IndexCount = static_cast<unsigned int>(vecIndices.size());
+
+	if (IndexStream::SelectIndexSize(u32VertexCount) == IndexStream::u8Index32Size)
+	{
+		unsigned int* pIndexData = new unsigned int[u32IndexCount];
+		copy(vecIndices.begin(), vecIndices.end(), pIndexData);
+		return new IndexStream(u32IndexCount, pIndexData);
+	}
+
+	unsigned short* pIndexData = new unsigned short[u32IndexCount];
+	for (unsigned int i = 0; i < u32IndexCount; ++i)
+	{
+		pIndexData[i] = static_cast<unsigned short>(vecIndices[i]);
+	}
+	return new IndexStream(u32IndexCount, pIndexData);
+}
+
+RMesh* ModelFactory::LoadMesh(const string& strPath, EVertexStreamLayout layout /* = EVSL_PositionSplit */)
+{
 	ifstream meshFile(strPath, ios::in | ios::binary);
+	if (!meshFile)
+	{
+		RwgeLog(TEXT("Failed to open mesh file \"%hs\"."), strPath.c_str());
+		return nullptr;
+	}
 
 	unsigned int uVertexCount = 0;
 	unsigned int uFaceCount = 0;
-	meshFile.read(reinterpret_cast<char*>(&uVertexCount), sizeof(uVertexCount));
-	meshFile.read(reinterpret_cast<char*>(&uFaceCount), sizeof(uFaceCount));
+	unsigned int u32FileIndexSize = IndexStream::u8Index16Size;
 
-	RRenderUnit* pRenderUnit = new RRenderUnit();
+	unsigned int u32Magic = 0;
+	meshFile.read(reinterpret_cast<char*>(&u32Magic), sizeof(u32Magic));
+	if (u32Magic == u32MeshFileMagic)
+	{
+		meshFile.read(reinterpret_cast<char*>(&uVertexCount), sizeof(uVertexCount));
+		meshFile.read(reinterpret_cast<char*>(&uFaceCount), sizeof(uFaceCount));
+		meshFile.read(reinterpret_cast<char*>(&u32FileIndexSize), sizeof(u32FileIndexSize));
+	}
+	else
+	{
+		uVertexCount = u32Magic;
+		meshFile.read(reinterpret_cast<char*>(&uFaceCount), sizeof(uFaceCount));
+	}
 
-	pRenderUnit->SetVertexDeclaration(RVertexDeclarationManager::GetInstance().GetDefaultVertexDeclaration());
-	pRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
-	pRenderUnit->SetPrimitiveCount(uFaceCount);
+	// ɵĵضΪ16λ65536ľļеѾ
+	if (!meshFile || uVertexCount == 0 || uFaceCount == 0 ||
+		(u32FileIndexSize != IndexStream::u8Index16Size && u32FileIndexSize != IndexStream::u8Index32Size) ||
+		(u32FileIndexSize == IndexStream::u8Index16Size && uVertexCount > IndexStream::u32MaxIndex16VertexCount))
+	{
+		RwgeLog(TEXT("Mesh file \"%hs\" is invalid - VertexCount : %u, FaceCount : %u, IndexSize : %u"), strPath.c_str(), uVertexCount, uFaceCount, u32FileIndexSize);
+		return nullptr;
+	}
 
-	const unsigned int uVertexSize = pRenderUnit->GetVertexDeclaration()->GetVertexSize();
-	unsigned int uVertexDataSize = uVertexSize * uVertexCount;
-	VertexData* pVertexData = new VertexData[uVertexDataSize];
+	// ļеĶǽ洢ģغֲٰ
+	VertexData* pVertexData = new VertexData[uVertexCount];
+	meshFile.read(reinterpret_cast<char*>(pVertexData), sizeof(VertexData) * uVertexCount);
 
-	meshFile.read(reinterpret_cast<char*>(pVertexData), uVertexDataSize);
+	const unsigned int uIndexCount = uFaceCount * 3;
+	const unsigned char u8FileIndexSize = static_cast<unsigned char>(u32FileIndexSize);
+	vector<unsigned int> vecIndices;
+	if (!meshFile || !ReadIndices(meshFile, uIndexCount, u8FileIndexSize, uVertexCount, vecIndices))
+	{
+		RwgeLog(TEXT("Mesh file \"%hs\" is truncated or has invalid indices."), strPath.c_str());
+		delete[] pVertexData;
+		return nullptr;
+	}
 
-	VertexStream* pVertexStream = new VertexStream(uVertexSize, uVertexCount, pVertexData);
+	// ͼ˳ڻ֮ͬһУͼ˳ʱֻʹûȻԻ
+	unsigned int u32ViewOrderCount = 0;
+	meshFile.read(reinterpret_cast<char*>(&u32ViewOrderCount), sizeof(u32ViewOrderCount));
+	bool bViewOrders = false;
+	if (!meshFile)
+	{
+		u32ViewOrderCount = 0;
+	}
+	else if (u32ViewOrderCount == RRenderUnit::u8ViewOrderCount)
+	{
+		bViewOrders = ReadIndices(meshFile, uIndexCount * u32ViewOrderCount, u8FileIndexSize, uVertexCount, vecIndices);
+	}
 
-	const unsigned int uIndexCount = uFaceCount * 3;
-	unsigned short* pIndexData = new unsigned short[uIndexCount];
-	meshFile.read(reinterpret_cast<char*>(pIndexData), uIndexCount * sizeof(unsigned short));
+	if (u32ViewOrderCount != 0 && !bViewOrders)
+	{
+		RwgeLog(TEXT("Mesh file \"%hs\" has invalid view orders, only the base order is used - ViewOrderCount : %u"), strPath.c_str(), u32ViewOrderCount);
+	}
 
-	IndexStream* pIndexStream = new IndexStream(uIndexCount, pIndexData);
+	meshFile.close();
+
+	IndexStream* pIndexStream = CreateIndexStream(vecIndices, uVertexCount);
+
+	RRenderUnit* pRenderUnit = new RRenderUnit();
+
+	pRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
+	pRenderUnit->SetPrimitiveCount(uFaceCount);
+
+	const unsigned int u32DynamicStreamMask = AddVertexStreams(pRenderUnit, pVertexData, uVertexCount, layout);
 
-	pRenderUnit->AddVertexStream(pVertexStream);
 	pRenderUnit->SetIndexStream(pIndexStream);
-	pRenderUnit->BindStreamToBuffer();
+	pRenderUnit->BindStreamToBuffer(u32DynamicStreamMask);
+	pRenderUnit->SetViewOrdersEnabled(bViewOrders);
 
+	RMesh* pMesh = new RMesh();
 	pMesh->AddRenderUnit(pRenderUnit);
 
-	meshFile.close();
-
 	return pMesh;
 }
 
@@ -249,19 +439,33 @@ RModel* ModelFactory::CreateZhanHun()
 {
 	RModel* pModel = new RModel();
 
-	pModel->AddMesh(LoadMesh("meshes/05.mesh"));
-	pModel->AddMesh(LoadMesh("meshes/01.mesh"));
-	pModel->AddMesh(LoadMesh("meshes/2d4dbb8_obj.mesh"));
-	pModel->AddMesh(LoadMesh("meshes/man_hand02.mesh"));
-	pModel->AddMesh(LoadMesh("meshes/man_head04.mesh"));
-
-	list<RMesh*>& plistMeshes = pModel->GetMeshes();
-	auto itMeshPtr = plistMeshes.begin();
-	(*itMeshPtr++)->SetMaterial(MaterialFactory::CreateZhanHunBodyMaterial());
-	(*itMeshPtr++)->SetMaterial(MaterialFactory::CreateZhanHunShoulderMaterial());
-	(*itMeshPtr++)->SetMaterial(MaterialFactory::CreateZhanHunHairMaterial());
-	(*itMeshPtr++)->SetMaterial(MaterialFactory::CreateZhanHunHandMaterial());
-	(*itMeshPtr++)->SetMaterial(MaterialFactory::CreateZhanHunHeadMaterial());
+	RMesh* aryMeshes[] =
+	{
+		LoadMesh("meshes/05.mesh"),
+		LoadMesh("meshes/01.mesh"),
+		LoadMesh("meshes/2d4dbb8_obj.mesh"),
+		LoadMesh("meshes/man_hand02.mesh"),
+		LoadMesh("meshes/man_head04.mesh"),
+	};
+
+	RMaterial* (*aryMaterialCreators[])() =
+	{
+		MaterialFactory::CreateZhanHunBodyMaterial,
+		MaterialFactory::CreateZhanHunShoulderMaterial,
+		MaterialFactory::CreateZhanHunHairMaterial,
+		MaterialFactory::CreateZhanHunHandMaterial,
+		MaterialFactory::CreateZhanHunHeadMaterial,
+	};
+
+	// ʧܵ
+	for (unsigned int i = 0; i < sizeof(aryMeshes) / sizeof(aryMeshes[0]); ++i)
+	{
+		if (aryMeshes[i] != nullptr)
+		{
+			aryMeshes[i]->SetMaterial(aryMaterialCreators[i]());
+			pModel->AddMesh(aryMeshes[i]);
+		}
+	}
 
 	return pModel;
 }
@@ -272,3 +476,25 @@ RModel* ModelFactory::LoadModel(const string& strPath)
 
 	return pModel;
 }
+
+RModel* ModelFactory::CloneModel(RModel* pSource)
+{
+	RModel* pModel = new RModel();
+
+	for (RMesh* pSourceMesh : pSource->GetMeshes())
+	{
+		RMesh* pMesh = new RMesh();
+		pModel->AddMesh(pMesh);
+
+		pMesh->SetMaterial(pSourceMesh->GetMaterial());
+
+		for (RRenderUnit* pSourceRenderUnit : pSourceMesh->GetRenderUnits())
+		{
+			pMesh->AddRenderUnit(new RRenderUnit(*pSourceRenderUnit));
+		}
+	}
+
+	pModel->SetOccluderMode(pSource->GetOccluderMode());
+
+	return pModel;
+}
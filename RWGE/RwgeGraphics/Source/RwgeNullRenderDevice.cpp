@@ -0,0 +1,425 @@
+#include "RwgeNullRenderDevice.h"
+
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+
+#ifdef _WIN32
+#	include <Windows.h>
+#else
+#	include <chrono>
+#endif
+
+using namespace std;
+
+static const char* s_aryCallNames[ERenderDeviceCall_MAX] =
+{
+	"CreateResource",
+	"ReleaseResource",
+	"LockBuffer",
+	"GetEffectParameter",
+	"BeginEffect",
+	"EndEffect",
+	"CommitEffectChanges",
+	"SetEffectValue",
+	"SetEffectTexture",
+	"BeginScene",
+	"EndScene",
+	"SetRenderTarget",
+	"SetViewport",
+	"Clear",
+	"SetRenderState",
+	"SetVertexDeclaration",
+	"SetStreamSource",
+	"SetStreamSourceFreq",
+	"SetIndices",
+	"DrawIndexedPrimitive",
+};
+
+static unsigned long long GetTimeInNanoseconds()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER s_Frequency = { 0 };
+	if (s_Frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&s_Frequency);
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return static_cast<unsigned long long>(static_cast<double>(counter.QuadPart) * 1000000000.0 / static_cast<double>(s_Frequency.QuadPart));
+#else
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+RNullRenderDevice::RNullRenderDevice() :
+	m_u32BufferWriteCostPerKB(0),
+	m_u32FenceLatency(0),
+	m_u32LastFence(0),
+	m_u32NextHandle(0),
+	m_u64BufferBytesAllocated(0),
+	m_pLockedBuffer(nullptr),
+	m_u32LockedSize(0)
+{
+	for (unsigned int i = 0; i < ERenderDeviceCall_MAX; ++i)
+	{
+		m_aryCallCosts[i] = 0;
+	}
+}
+
+RNullRenderDevice::~RNullRenderDevice()
+{
+
+}
+
+const char* RNullRenderDevice::GetCallName(ERenderDeviceCall call)
+{
+	RwgeAssert(call < ERenderDeviceCall_MAX);
+
+	return s_aryCallNames[call];
+}
+
+void RNullRenderDevice::RecordCall(ERenderDeviceCall call)
+{
+	++m_Counters.aryCallCounts[call];
+
+	if (m_aryCallCosts[call] != 0)
+	{
+		SimulateCost(m_aryCallCosts[call]);
+	}
+}
+
+void RNullRenderDevice::SimulateCost(unsigned long long u64Nanoseconds)
+{
+	// æȴSleepһռõ߳
+	unsigned long long u64End = GetTimeInNanoseconds() + u64Nanoseconds;
+	while (GetTimeInNanoseconds() < u64End)
+	{
+
+	}
+}
+
+void* RNullRenderDevice::CreateHandle()
+{
+	// ֻԴ16ֽڵʵָ뷽ʽͻ
+	return reinterpret_cast<void*>(static_cast<size_t>(++m_u32NextHandle) << 4);
+}
+
+HRESULT RNullRenderDevice::CreateBuffer(unsigned int u32Size, void** ppBuffer)
+{
+	RecordCall(ERDC_CreateResource);
+
+	if (u32Size == 0)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	*ppBuffer = CreateHandle();
+	m_mapBufferSizes[*ppBuffer] = u32Size;
+	m_u64BufferBytesAllocated += u32Size;
+
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::LockBuffer(const void* pBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData)
+{
+	RecordCall(ERDC_LockBuffer);
+
+	auto itBuffer = m_mapBufferSizes.find(pBuffer);
+	if (itBuffer == m_mapBufferSizes.end() || m_pLockedBuffer != nullptr)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	// D3D9 ͬSizeΪ0ʱOffsetʼ
+	if (u32Size == 0 && u32Offset < itBuffer->second)
+	{
+		u32Size = itBuffer->second - u32Offset;
+	}
+
+	if (u32Size == 0 || u32Offset + u32Size > itBuffer->second)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	if (m_vecLockMemory.size() < u32Size)
+	{
+		m_vecLockMemory.resize(u32Size);
+	}
+
+	m_pLockedBuffer = pBuffer;
+	m_u32LockedSize = u32Size;
+	*ppData = m_vecLockMemory.data();
+
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::UnlockBuffer(const void* pBuffer)
+{
+	if (m_pLockedBuffer != pBuffer)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	m_Counters.u64BufferBytesWritten += m_u32LockedSize;
+	if (m_u32BufferWriteCostPerKB != 0)
+	{
+		SimulateCost(static_cast<unsigned long long>(m_u32LockedSize) * m_u32BufferWriteCostPerKB / 1024);
+	}
+
+	m_pLockedBuffer = nullptr;
+	m_u32LockedSize = 0;
+
+	return D3D_OK;
+}
+
+void RNullRenderDevice::ReleaseBuffer(const void* pBuffer)
+{
+	RecordCall(ERDC_ReleaseResource);
+
+	auto itBuffer = m_mapBufferSizes.find(pBuffer);
+	if (itBuffer == m_mapBufferSizes.end())
+	{
+		RwgeLog(TEXT("Null render device : releasing an unknown buffer."));
+		return;
+	}
+
+	m_u64BufferBytesAllocated -= itBuffer->second;
+	m_mapBufferSizes.erase(itBuffer);
+}
+
+HRESULT RNullRenderDevice::CreateVertexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DPOOL pool, IDirect3DVertexBuffer9** ppVertexBuffer)
+{
+	void* pBuffer = nullptr;
+	HRESULT hResult = CreateBuffer(u32Size, &pBuffer);
+	*ppVertexBuffer = static_cast<IDirect3DVertexBuffer9*>(pBuffer);
+	return hResult;
+}
+
+HRESULT RNullRenderDevice::LockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags)
+{
+	return LockBuffer(pVertexBuffer, u32Offset, u32Size, ppData);
+}
+
+HRESULT RNullRenderDevice::UnlockVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer)
+{
+	return UnlockBuffer(pVertexBuffer);
+}
+
+void RNullRenderDevice::ReleaseVertexBuffer(IDirect3DVertexBuffer9* pVertexBuffer)
+{
+	ReleaseBuffer(pVertexBuffer);
+}
+
+HRESULT RNullRenderDevice::CreateIndexBuffer(unsigned int u32Size, unsigned long u32Usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9** ppIndexBuffer)
+{
+	void* pBuffer = nullptr;
+	HRESULT hResult = CreateBuffer(u32Size, &pBuffer);
+	*ppIndexBuffer = static_cast<IDirect3DIndexBuffer9*>(pBuffer);
+	if (SUCCEEDED(hResult))
+	{
+		m_mapIndexFormats[pBuffer] = format;
+	}
+	return hResult;
+}
+
+HRESULT RNullRenderDevice::LockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer, unsigned int u32Offset, unsigned int u32Size, void** ppData, unsigned long u32Flags)
+{
+	return LockBuffer(pIndexBuffer, u32Offset, u32Size, ppData);
+}
+
+HRESULT RNullRenderDevice::UnlockIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	return UnlockBuffer(pIndexBuffer);
+}
+
+void RNullRenderDevice::ReleaseIndexBuffer(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	ReleaseBuffer(pIndexBuffer);
+	m_mapIndexFormats.erase(pIndexBuffer);
+}
+
+D3DFORMAT RNullRenderDevice::GetIndexBufferFormat(const IDirect3DIndexBuffer9* pIndexBuffer) const
+{
+	auto itFormat = m_mapIndexFormats.find(pIndexBuffer);
+	return itFormat != m_mapIndexFormats.end() ? itFormat->second : D3DFMT_UNKNOWN;
+}
+
+HRESULT RNullRenderDevice::CreateVertexDeclaration(const D3DVERTEXELEMENT9* aryVertexElements, IDirect3DVertexDeclaration9** ppVertexDeclaration)
+{
+	RecordCall(ERDC_CreateResource);
+	*ppVertexDeclaration = static_cast<IDirect3DVertexDeclaration9*>(CreateHandle());
+	return D3D_OK;
+}
+
+void RNullRenderDevice::ReleaseVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	RecordCall(ERDC_ReleaseResource);
+}
+
+HRESULT RNullRenderDevice::CreateTextureFromFile(const TCHAR* szPath, IDirect3DTexture9** ppTexture)
+{
+	RecordCall(ERDC_CreateResource);
+	*ppTexture = static_cast<IDirect3DTexture9*>(CreateHandle());
+	return D3D_OK;
+}
+
+void RNullRenderDevice::ReleaseTexture(IDirect3DTexture9* pTexture)
+{
+	RecordCall(ERDC_ReleaseResource);
+}
+
+HRESULT RNullRenderDevice::CreateEffectPool(ID3DXEffectPool** ppEffectPool)
+{
+	RecordCall(ERDC_CreateResource);
+	*ppEffectPool = static_cast<ID3DXEffectPool*>(CreateHandle());
+	return D3D_OK;
+}
+
+void RNullRenderDevice::ReleaseEffectPool(ID3DXEffectPool* pEffectPool)
+{
+	RecordCall(ERDC_ReleaseResource);
+}
+
+HRESULT RNullRenderDevice::CreateEffectFromFile(const TCHAR* szPath, ID3DXEffectPool* pEffectPool, ID3DXEffect** ppEffect, ID3DXBuffer** ppErrorBuffer)
+{
+	RecordCall(ERDC_CreateResource);
+	*ppEffect = static_cast<ID3DXEffect*>(CreateHandle());
+	if (ppErrorBuffer != nullptr)
+	{
+		*ppErrorBuffer = nullptr;
+	}
+	return D3D_OK;
+}
+
+void RNullRenderDevice::ReleaseEffect(ID3DXEffect* pEffect)
+{
+	RecordCall(ERDC_ReleaseResource);
+}
+
+D3DXHANDLE RNullRenderDevice::GetEffectParameterByName(ID3DXEffect* pEffect, const char* szName)
+{
+	RecordCall(ERDC_GetEffectParameter);
+	return static_cast<D3DXHANDLE>(CreateHandle());
+}
+
+D3DXHANDLE RNullRenderDevice::GetEffectTechniqueByName(ID3DXEffect* pEffect, const char* szName)
+{
+	RecordCall(ERDC_GetEffectParameter);
+	return static_cast<D3DXHANDLE>(CreateHandle());
+}
+
+HRESULT RNullRenderDevice::BeginEffect(ID3DXEffect* pEffect)
+{
+	RecordCall(ERDC_BeginEffect);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::EndEffect(ID3DXEffect* pEffect)
+{
+	RecordCall(ERDC_EndEffect);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::CommitEffectChanges(ID3DXEffect* pEffect)
+{
+	RecordCall(ERDC_CommitEffectChanges);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetEffectValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Size)
+{
+	RecordCall(ERDC_SetEffectValue);
+	m_Counters.u64EffectBytesWritten += u32Size;
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetEffectRawValue(ID3DXEffect* pEffect, D3DXHANDLE hParameter, const void* pData, unsigned int u32Offset, unsigned int u32Size)
+{
+	RecordCall(ERDC_SetEffectValue);
+	m_Counters.u64EffectBytesWritten += u32Size;
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetEffectTexture(ID3DXEffect* pEffect, D3DXHANDLE hParameter, IDirect3DBaseTexture9* pTexture)
+{
+	RecordCall(ERDC_SetEffectTexture);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::BeginScene()
+{
+	RecordCall(ERDC_BeginScene);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::EndScene()
+{
+	RecordCall(ERDC_EndScene);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetRenderTarget(unsigned int u32Index, IDirect3DSurface9* pSurface)
+{
+	RecordCall(ERDC_SetRenderTarget);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetViewport(const D3DVIEWPORT9* pViewport)
+{
+	RecordCall(ERDC_SetViewport);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::Clear(unsigned int u32RectCount, const D3DRECT* aryRects, unsigned long u32Flags, D3DCOLOR color, float f32Z, unsigned long u32Stencil)
+{
+	RecordCall(ERDC_Clear);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetRenderState(D3DRENDERSTATETYPE state, unsigned long u32Value)
+{
+	RecordCall(ERDC_SetRenderState);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetVertexDeclaration(IDirect3DVertexDeclaration9* pVertexDeclaration)
+{
+	RecordCall(ERDC_SetVertexDeclaration);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetStreamSource(unsigned int u32Stream, IDirect3DVertexBuffer9* pVertexBuffer, unsigned int u32Offset, unsigned int u32Stride)
+{
+	RecordCall(ERDC_SetStreamSource);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetStreamSourceFreq(unsigned int u32Stream, unsigned int u32Setting)
+{
+	RecordCall(ERDC_SetStreamSourceFreq);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::SetIndices(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	RecordCall(ERDC_SetIndices);
+	return D3D_OK;
+}
+
+HRESULT RNullRenderDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE type, int s32BaseVertexIndex, unsigned int u32MinVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount)
+{
+	RecordCall(ERDC_DrawIndexedPrimitive);
+	m_Counters.u64PrimitiveCount += u32PrimitiveCount;
+	return D3D_OK;
+}
+
+unsigned int RNullRenderDevice::IssueFrameFence()
+{
+	return ++m_u32LastFence;
+}
+
+unsigned int RNullRenderDevice::GetCompletedFrameFence()
+{
+	return m_u32LastFence > m_u32FenceLatency ? m_u32LastFence - m_u32FenceLatency : 0;
+}
@@ -0,0 +1,550 @@
+#include "RwgeOcclusionBuffer.h"
+
+#include <math.h>
+#include <float.h>
+#include <RwgeAssert.h>
+#include <RwgeThreadPool.h>
+
+#if RWGE_SIMD_SSE
+#	include <xmmintrin.h>
+#endif
+
+static FORCE_INLINE float Min3(float a, float b, float c)
+{
+	float f32Min = a < b ? a : b;
+	return f32Min < c ? f32Min : c;
+}
+
+static FORCE_INLINE float Max3(float a, float b, float c)
+{
+	float f32Max = a > b ? a : b;
+	return f32Max > c ? f32Max : c;
+}
+
+ROcclusionBuffer::ROcclusionBuffer(unsigned int u32Width /* = 256 */, unsigned int u32Height /* = 128 */) :
+	m_u32TileCountX(u32Width == 0 ? 1 : (u32Width + u32TileWidth - 1) / u32TileWidth),
+	m_u32TileCountY(u32Height == 0 ? 1 : (u32Height + u32TileHeight - 1) / u32TileHeight),
+	m_u32BinningTaskCount(0),
+	m_bSimdEnabled(true),
+	m_u32OccluderTriangleCount(0),
+	m_u32RasterizedTriangleCount(0)
+{
+	m_u32Width = m_u32TileCountX * u32TileWidth;
+	m_u32Height = m_u32TileCountY * u32TileHeight;
+
+	D3DXMatrixIdentity(&m_ViewProj);
+
+	// 𼶼룬ֱֻʣһ
+	unsigned int u32LevelWidth = m_u32Width;
+	unsigned int u32LevelHeight = m_u32Height;
+
+	while (true)
+	{
+		m_vecHiZLevels.push_back(std::vector<float>(u32LevelWidth * u32LevelHeight, 1.0f));
+		m_vecLevelWidth.push_back(u32LevelWidth);
+		m_vecLevelHeight.push_back(u32LevelHeight);
+
+		if (u32LevelWidth == 1 && u32LevelHeight == 1)
+		{
+			break;
+		}
+
+		u32LevelWidth = (u32LevelWidth + 1) >> 1;
+		u32LevelHeight = (u32LevelHeight + 1) >> 1;
+	}
+}
+
+ROcclusionBuffer::~ROcclusionBuffer()
+{
+
+}
+
+void ROcclusionBuffer::BeginFrame(const D3DXMATRIX& viewProj)
+{
+	m_ViewProj = viewProj;
+	m_vecOccluders.clear();
+
+	m_u32OccluderTriangleCount = 0;
+	m_u32RasterizedTriangleCount = 0;
+
+	std::vector<float>& vecDepth = m_vecHiZLevels[0];
+	vecDepth.assign(vecDepth.size(), 1.0f);
+}
+
+void ROcclusionBuffer::AddOccluder(
+	const void* pPositions,
+	unsigned int u32VertexCount,
+	unsigned int u32Stride,
+	const void* aryIndices,
+	unsigned char u8IndexSize,
+	unsigned int u32TriangleCount,
+	const D3DXMATRIX& world)
+{
+	if (pPositions == nullptr || u32VertexCount == 0 || u32TriangleCount == 0)
+	{
+		return;
+	}
+
+	Occluder occluder;
+	occluder.pPositions			= reinterpret_cast<const unsigned char*>(pPositions);
+	occluder.u32VertexCount		= u32VertexCount;
+	occluder.u32Stride			= u32Stride;
+	occluder.aryIndices			= aryIndices;
+	occluder.u32IndexSize		= u8IndexSize;
+	occluder.u32TriangleCount	= u32TriangleCount;
+	D3DXMatrixMultiply(&occluder.worldViewProj, &world, &m_ViewProj);
+
+	m_vecOccluders.push_back(occluder);
+	m_u32OccluderTriangleCount += u32TriangleCount;
+}
+
+void ROcclusionBuffer::Rasterize()
+{
+	RThreadPool& threadPool = RThreadPool::GetInstance();
+	const unsigned int u32OccluderCount = static_cast<unsigned int>(m_vecOccluders.size());
+	const unsigned int u32TileCount = m_u32TileCountX * m_u32TileCountY;
+
+	// ÿ̷߳񣬰ڵȵػָ
+	unsigned int u32MaxTaskCount = (threadPool.GetWorkerCount() + 1) * 2;
+	if (u32MaxTaskCount > u32OccluderCount)
+	{
+		u32MaxTaskCount = u32OccluderCount;
+	}
+
+	m_vecTaskOccluderBegin.clear();
+	unsigned int u32AccumulatedCount = 0;
+	for (unsigned int u32Occluder = 0; u32Occluder < u32OccluderCount; ++u32Occluder)
+	{
+		// ѾۼƵδﵽƽʱN㣬ʼһ
+		unsigned int u32TaskIndex = static_cast<unsigned int>(m_vecTaskOccluderBegin.size());
+		if (u32TaskIndex < u32MaxTaskCount &&
+			static_cast<unsigned long long>(u32AccumulatedCount) * u32MaxTaskCount >= static_cast<unsigned long long>(m_u32OccluderTriangleCount) * u32TaskIndex)
+		{
+			m_vecTaskOccluderBegin.push_back(u32Occluder);
+		}
+
+		u32AccumulatedCount += m_vecOccluders[u32Occluder].u32TriangleCount;
+	}
+
+	m_u32BinningTaskCount = static_cast<unsigned int>(m_vecTaskOccluderBegin.size());
+	m_vecTaskOccluderBegin.push_back(u32OccluderCount);
+
+	if (m_vecBinningTasks.size() < m_u32BinningTaskCount)
+	{
+		m_vecBinningTasks.resize(m_u32BinningTaskCount);
+	}
+
+	threadPool.ParallelFor(m_u32BinningTaskCount, [this, u32TileCount](unsigned int u32Task)
+	{
+		BinningTask& task = m_vecBinningTasks[u32Task];
+
+		task.vecTriangles.clear();
+		task.vecTileBins.resize(u32TileCount);
+		for (std::vector<unsigned int>& vecBin : task.vecTileBins)
+		{
+			vecBin.clear();
+		}
+
+		BinOccluders(task, m_vecTaskOccluderBegin[u32Task], m_vecTaskOccluderBegin[u32Task + 1]);
+	});
+
+	for (unsigned int u32Task = 0; u32Task < m_u32BinningTaskCount; ++u32Task)
+	{
+		m_u32RasterizedTriangleCount += static_cast<unsigned int>(m_vecBinningTasks[u32Task].vecTriangles.size());
+	}
+
+	if (m_u32RasterizedTriangleCount > 0)
+	{
+		threadPool.ParallelFor(u32TileCount, [this](unsigned int u32Tile) { RasterizeTile(u32Tile); });
+	}
+
+	BuildHiZ();
+}
+
+void ROcclusionBuffer::BinOccluders(BinningTask& task, unsigned int u32Begin, unsigned int u32End)
+{
+	for (unsigned int u32Occluder = u32Begin; u32Occluder < u32End; ++u32Occluder)
+	{
+		const Occluder& occluder = m_vecOccluders[u32Occluder];
+
+		// Ȱж任üռ䣬ιĶֻҪ任һ
+		task.vecClipVertices.resize(occluder.u32VertexCount);
+		for (unsigned int u32Vertex = 0; u32Vertex < occluder.u32VertexCount; ++u32Vertex)
+		{
+			const D3DXVECTOR3* pPosition = reinterpret_cast<const D3DXVECTOR3*>(occluder.pPositions + u32Vertex * occluder.u32Stride);
+			D3DXVec3Transform(&task.vecClipVertices[u32Vertex], pPosition, &occluder.worldViewProj);
+		}
+
+		for (unsigned int u32Triangle = 0; u32Triangle < occluder.u32TriangleCount; ++u32Triangle)
+		{
+			unsigned int aryIndex[3];
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				const unsigned int u32Index = u32Triangle * 3 + i;
+				if (occluder.aryIndices == nullptr)
+				{
+					aryIndex[i] = u32Index;
+				}
+				else
+				{
+					aryIndex[i] = occluder.u32IndexSize == 4 ? static_cast<const unsigned int*>(occluder.aryIndices)[u32Index] : static_cast<const unsigned short*>(occluder.aryIndices)[u32Index];
+				}
+			}
+
+			if (aryIndex[0] >= occluder.u32VertexCount || aryIndex[1] >= occluder.u32VertexCount || aryIndex[2] >= occluder.u32VertexCount)
+			{
+				RwgeAssert(false);
+				continue;
+			}
+
+			const D3DXVECTOR4& v0 = task.vecClipVertices[aryIndex[0]];
+			const D3DXVECTOR4& v1 = task.vecClipVertices[aryIndex[1]];
+			const D3DXVECTOR4& v2 = task.vecClipVertices[aryIndex[2]];
+
+			// λͬһüʱֱӶ
+			if ((v0.x >  v0.w && v1.x >  v1.w && v2.x >  v2.w) ||
+				(v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w) ||
+				(v0.y >  v0.w && v1.y >  v1.w && v2.y >  v2.w) ||
+				(v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w) ||
+				(v0.z >  v0.w && v1.z >  v1.w && v2.z >  v2.w) ||
+				(v0.z < 0.0f  && v1.z < 0.0f  && v2.z < 0.0f))
+			{
+				continue;
+			}
+
+			if (v0.z >= 0.0f && v1.z >= 0.0f && v2.z >= 0.0f)
+			{
+				SetupTriangle(task, v0, v1, v2);
+				continue;
+			}
+
+			// ƽ棨z = 0ཻüõ4㣬βΪ
+			const D3DXVECTOR4* aryInput[3] = { &v0, &v1, &v2 };
+			D3DXVECTOR4 aryClipped[4];
+			unsigned int u32ClippedCount = 0;
+
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				const D3DXVECTOR4& a = *aryInput[i];
+				const D3DXVECTOR4& b = *aryInput[(i + 1) % 3];
+
+				if (a.z >= 0.0f)
+				{
+					aryClipped[u32ClippedCount++] = a;
+				}
+
+				if ((a.z >= 0.0f) != (b.z >= 0.0f))
+				{
+					float t = a.z / (a.z - b.z);
+					aryClipped[u32ClippedCount++] = a + (b - a) * t;
+				}
+			}
+
+			for (unsigned int i = 2; i < u32ClippedCount; ++i)
+			{
+				SetupTriangle(task, aryClipped[0], aryClipped[i - 1], aryClipped[i]);
+			}
+		}
+	}
+}
+
+void ROcclusionBuffer::SetupTriangle(BinningTask& task, const D3DXVECTOR4& v0, const D3DXVECTOR4& v1, const D3DXVECTOR4& v2)
+{
+	// ͶӰĻռ䣬ԭϽ
+	const D3DXVECTOR4* aryClip[3] = { &v0, &v1, &v2 };
+	float aryX[3], aryY[3], aryZ[3];
+
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		float f32InvW = 1.0f / aryClip[i]->w;
+		aryX[i] = (aryClip[i]->x * f32InvW * 0.5f + 0.5f) * m_u32Width;
+		aryY[i] = (0.5f - aryClip[i]->y * f32InvW * 0.5f) * m_u32Height;
+		aryZ[i] = aryClip[i]->z * f32InvW;
+	}
+
+	// ͳһΪΪĶ˳ʹڲıߺС0
+	float f32Area = (aryX[1] - aryX[0]) * (aryY[2] - aryY[0]) - (aryY[1] - aryY[0]) * (aryX[2] - aryX[0]);
+	if (f32Area < 0.0f)
+	{
+		float f32Temp;
+		f32Temp = aryX[1]; aryX[1] = aryX[2]; aryX[2] = f32Temp;
+		f32Temp = aryY[1]; aryY[1] = aryY[2]; aryY[2] = f32Temp;
+		f32Temp = aryZ[1]; aryZ[1] = aryZ[2]; aryZ[2] = f32Temp;
+		f32Area = -f32Area;
+	}
+
+	if (!(f32Area > FLT_EPSILON))
+	{
+		return;
+	}
+
+	// (x + 0.5, y + 0.5)λΰΧڵطΧ
+	float f32MinX = ceilf(Min3(aryX[0], aryX[1], aryX[2]) - 0.5f);
+	float f32MinY = ceilf(Min3(aryY[0], aryY[1], aryY[2]) - 0.5f);
+	float f32MaxX = floorf(Max3(aryX[0], aryX[1], aryX[2]) - 0.5f);
+	float f32MaxY = floorf(Max3(aryY[0], aryY[1], aryY[2]) - 0.5f);
+
+	if (f32MinX > m_u32Width - 1.0f || f32MinY > m_u32Height - 1.0f || f32MaxX < 0.0f || f32MaxY < 0.0f)
+	{
+		return;
+	}
+
+	TriangleSetup triangle;
+	triangle.s32MinX = f32MinX < 0.0f ? 0 : static_cast<int>(f32MinX);
+	triangle.s32MinY = f32MinY < 0.0f ? 0 : static_cast<int>(f32MinY);
+	triangle.s32MaxX = f32MaxX > m_u32Width - 1.0f ? m_u32Width - 1 : static_cast<int>(f32MaxX);
+	triangle.s32MaxY = f32MaxY > m_u32Height - 1.0f ? m_u32Height - 1 : static_cast<int>(f32MaxY);
+
+	if (triangle.s32MinX > triangle.s32MaxX || triangle.s32MinY > triangle.s32MaxY)
+	{
+		return;
+	}
+
+	// ߺCѾ˵ĵİƫ
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		unsigned int j = (i + 1) % 3;
+
+		float A = aryY[i] - aryY[j];
+		float B = aryX[j] - aryX[i];
+
+		triangle.aryEdgeA[i] = A;
+		triangle.aryEdgeB[i] = B;
+		triangle.aryEdgeC[i] = 0.5f * (A + B) - (A * aryX[i] + B * aryY[i]);
+	}
+
+	// ĻռԵ
+	float f32InvArea = 1.0f / f32Area;
+	triangle.f32DepthA = ((aryZ[1] - aryZ[0]) * (aryY[2] - aryY[0]) - (aryZ[2] - aryZ[0]) * (aryY[1] - aryY[0])) * f32InvArea;
+	triangle.f32DepthB = ((aryZ[2] - aryZ[0]) * (aryX[1] - aryX[0]) - (aryZ[1] - aryZ[0]) * (aryX[2] - aryX[0])) * f32InvArea;
+	triangle.f32DepthC = aryZ[0] - triangle.f32DepthA * aryX[0] - triangle.f32DepthB * aryY[0] + 0.5f * (triangle.f32DepthA + triangle.f32DepthB);
+
+	// дθǵзֿ
+	unsigned int u32TriangleIndex = static_cast<unsigned int>(task.vecTriangles.size());
+	task.vecTriangles.push_back(triangle);
+
+	unsigned int u32TileMinX = triangle.s32MinX / u32TileWidth;
+	unsigned int u32TileMaxX = triangle.s32MaxX / u32TileWidth;
+	unsigned int u32TileMinY = triangle.s32MinY / u32TileHeight;
+	unsigned int u32TileMaxY = triangle.s32MaxY / u32TileHeight;
+
+	for (unsigned int u32TileY = u32TileMinY; u32TileY <= u32TileMaxY; ++u32TileY)
+	{
+		for (unsigned int u32TileX = u32TileMinX; u32TileX <= u32TileMaxX; ++u32TileX)
+		{
+			task.vecTileBins[u32TileY * m_u32TileCountX + u32TileX].push_back(u32TriangleIndex);
+		}
+	}
+}
+
+void ROcclusionBuffer::RasterizeTile(unsigned int u32Tile)
+{
+	int s32TileMinX = (u32Tile % m_u32TileCountX) * u32TileWidth;
+	int s32TileMinY = (u32Tile / m_u32TileCountX) * u32TileHeight;
+	int s32TileMaxX = s32TileMinX + u32TileWidth - 1;
+	int s32TileMaxY = s32TileMinY + u32TileHeight - 1;
+
+	// ˳ÿιդĽ߳޹
+	for (unsigned int u32Task = 0; u32Task < m_u32BinningTaskCount; ++u32Task)
+	{
+		const BinningTask& task = m_vecBinningTasks[u32Task];
+
+		for (unsigned int u32TriangleIndex : task.vecTileBins[u32Tile])
+		{
+			const TriangleSetup& triangle = task.vecTriangles[u32TriangleIndex];
+
+			RasterizeTriangle(
+				triangle,
+				triangle.s32MinX > s32TileMinX ? triangle.s32MinX : s32TileMinX,
+				triangle.s32MinY > s32TileMinY ? triangle.s32MinY : s32TileMinY,
+				triangle.s32MaxX < s32TileMaxX ? triangle.s32MaxX : s32TileMaxX,
+				triangle.s32MaxY < s32TileMaxY ? triangle.s32MaxY : s32TileMaxY);
+		}
+	}
+}
+
+void ROcclusionBuffer::RasterizeTriangle(const TriangleSetup& triangle, int s32MinX, int s32MinY, int s32MaxX, int s32MaxY)
+{
+#if RWGE_SIMD_SSE
+	if (!m_bSimdEnabled)
+	{
+		RasterizeTriangleScalar(triangle, s32MinX, s32MinY, s32MaxX, s32MaxY);
+		return;
+	}
+
+	float* aryDepth = m_vecHiZLevels[0].data();
+
+	// ֿĿ4ı뵽4֮ÿ4Ȼλͬһֿ
+	const int s32StartX = s32MinX & ~3;
+	const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	const __m128 edgeA0 = _mm_set1_ps(triangle.aryEdgeA[0]);
+	const __m128 edgeA1 = _mm_set1_ps(triangle.aryEdgeA[1]);
+	const __m128 edgeA2 = _mm_set1_ps(triangle.aryEdgeA[2]);
+	const __m128 depthA = _mm_set1_ps(triangle.f32DepthA);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int y = s32MinY; y <= s32MaxY; ++y)
+	{
+		float f32Y = static_cast<float>(y);
+		__m128 rowEdge0 = _mm_set1_ps(triangle.aryEdgeB[0] * f32Y + triangle.aryEdgeC[0]);
+		__m128 rowEdge1 = _mm_set1_ps(triangle.aryEdgeB[1] * f32Y + triangle.aryEdgeC[1]);
+		__m128 rowEdge2 = _mm_set1_ps(triangle.aryEdgeB[2] * f32Y + triangle.aryEdgeC[2]);
+		__m128 rowDepth = _mm_set1_ps(triangle.f32DepthB * f32Y + triangle.f32DepthC);
+		float* aryRow = aryDepth + y * m_u32Width;
+
+		for (int x = s32StartX; x <= s32MaxX; x += 4)
+		{
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, pixelX), rowEdge0), zero),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, pixelX), rowEdge1), zero)),
+				_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, pixelX), rowEdge2), zero));
+
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+			__m128 oldDepth = _mm_loadu_ps(aryRow + x);
+			__m128 newDepth = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(oldDepth, depth)), _mm_andnot_ps(inside, oldDepth));
+			_mm_storeu_ps(aryRow + x, newDepth);
+		}
+	}
+#else
+	RasterizeTriangleScalar(triangle, s32MinX, s32MinY, s32MaxX, s32MaxY);
+#endif
+}
+
+void ROcclusionBuffer::RasterizeTriangleScalar(const TriangleSetup& triangle, int s32MinX, int s32MinY, int s32MaxX, int s32MaxY)
+{
+	float* aryDepth = m_vecHiZLevels[0].data();
+
+	for (int y = s32MinY; y <= s32MaxY; ++y)
+	{
+		float f32Y = static_cast<float>(y);
+		float f32RowEdge0 = triangle.aryEdgeB[0] * f32Y + triangle.aryEdgeC[0];
+		float f32RowEdge1 = triangle.aryEdgeB[1] * f32Y + triangle.aryEdgeC[1];
+		float f32RowEdge2 = triangle.aryEdgeB[2] * f32Y + triangle.aryEdgeC[2];
+		float f32RowDepth = triangle.f32DepthB * f32Y + triangle.f32DepthC;
+		float* aryRow = aryDepth + y * m_u32Width;
+
+		for (int x = s32MinX; x <= s32MaxX; ++x)
+		{
+			float f32X = static_cast<float>(x);
+
+			if (triangle.aryEdgeA[0] * f32X + f32RowEdge0 >= 0.0f &&
+				triangle.aryEdgeA[1] * f32X + f32RowEdge1 >= 0.0f &&
+				triangle.aryEdgeA[2] * f32X + f32RowEdge2 >= 0.0f)
+			{
+				float f32Depth = triangle.f32DepthA * f32X + f32RowDepth;
+				if (f32Depth < aryRow[x])
+				{
+					aryRow[x] = f32Depth;
+				}
+			}
+		}
+	}
+}
+
+void ROcclusionBuffer::BuildHiZ()
+{
+	for (unsigned int u32Level = 1; u32Level < m_vecHiZLevels.size(); ++u32Level)
+	{
+		const std::vector<float>& vecSource = m_vecHiZLevels[u32Level - 1];
+		std::vector<float>& vecTarget = m_vecHiZLevels[u32Level];
+
+		const unsigned int u32SourceWidth = m_vecLevelWidth[u32Level - 1];
+		const unsigned int u32SourceHeight = m_vecLevelHeight[u32Level - 1];
+		const unsigned int u32TargetWidth = m_vecLevelWidth[u32Level];
+		const unsigned int u32TargetHeight = m_vecLevelHeight[u32Level];
+
+		for (unsigned int y = 0; y < u32TargetHeight; ++y)
+		{
+			// һĳߴΪʱһУУֻһԴ
+			const float* aryRow0 = vecSource.data() + (y * 2) * u32SourceWidth;
+			const float* aryRow1 = vecSource.data() + (y * 2 + 1 < u32SourceHeight ? y * 2 + 1 : y * 2) * u32SourceWidth;
+
+			for (unsigned int x = 0; x < u32TargetWidth; ++x)
+			{
+				unsigned int x0 = x * 2;
+				unsigned int x1 = x0 + 1 < u32SourceWidth ? x0 + 1 : x0;
+
+				float f32Max0 = aryRow0[x0] > aryRow0[x1] ? aryRow0[x0] : aryRow0[x1];
+				float f32Max1 = aryRow1[x0] > aryRow1[x1] ? aryRow1[x0] : aryRow1[x1];
+				vecTarget[y * u32TargetWidth + x] = f32Max0 > f32Max1 ? f32Max0 : f32Max1;
+			}
+		}
+	}
+}
+
+bool ROcclusionBuffer::IsOccluded(const D3DXVECTOR3& minPoint, const D3DXVECTOR3& maxPoint) const
+{
+	float f32MinX = FLT_MAX, f32MinY = FLT_MAX, f32MinZ = FLT_MAX;
+	float f32MaxX = -FLT_MAX, f32MaxY = -FLT_MAX;
+
+	for (unsigned int u32Corner = 0; u32Corner < 8; ++u32Corner)
+	{
+		D3DXVECTOR3 corner(
+			(u32Corner & 1) ? maxPoint.x : minPoint.x,
+			(u32Corner & 2) ? maxPoint.y : minPoint.y,
+			(u32Corner & 4) ? maxPoint.z : minPoint.z);
+
+		D3DXVECTOR4 clip;
+		D3DXVec3Transform(&clip, &corner, &m_ViewProj);
+
+		// жλڽƽ֮ǰʱͶӰľβܰסAABBصΪɼ
+		if (clip.z < 0.0f || clip.w <= 0.0f)
+		{
+			return false;
+		}
+
+		float f32InvW = 1.0f / clip.w;
+		float f32X = (clip.x * f32InvW * 0.5f + 0.5f) * m_u32Width;
+		float f32Y = (0.5f - clip.y * f32InvW * 0.5f) * m_u32Height;
+		float f32Z = clip.z * f32InvW;
+
+		f32MinX = f32X < f32MinX ? f32X : f32MinX;
+		f32MaxX = f32X > f32MaxX ? f32X : f32MaxX;
+		f32MinY = f32Y < f32MinY ? f32Y : f32MinY;
+		f32MaxY = f32Y > f32MaxY ? f32Y : f32MaxY;
+		f32MinZ = f32Z < f32MinZ ? f32Z : f32MinZ;
+	}
+
+	// ȫλĻԶƽ֮Ķ󽻸׶ü
+	if (f32MaxX < 0.0f || f32MaxY < 0.0f || f32MinX >= m_u32Width || f32MinY >= m_u32Height || f32MinZ > 1.0f)
+	{
+		return false;
+	}
+
+	// νӴ
+	unsigned int x0 = f32MinX < 0.0f ? 0 : static_cast<unsigned int>(f32MinX);
+	unsigned int y0 = f32MinY < 0.0f ? 0 : static_cast<unsigned int>(f32MinY);
+	unsigned int x1 = f32MaxX >= m_u32Width ? m_u32Width - 1 : static_cast<unsigned int>(f32MaxX);
+	unsigned int y1 = f32MaxY >= m_u32Height ? m_u32Height - 1 : static_cast<unsigned int>(f32MaxY);
+
+	// ѡÿϲ4صHiZ㼶
+	unsigned int u32Level = 0;
+	while (((x1 >> u32Level) - (x0 >> u32Level) > 3 || (y1 >> u32Level) - (y0 >> u32Level) > 3) && u32Level + 1 < m_vecHiZLevels.size())
+	{
+		++u32Level;
+	}
+
+	const std::vector<float>& vecLevel = m_vecHiZLevels[u32Level];
+	const unsigned int u32LevelWidth = m_vecLevelWidth[u32Level];
+
+	for (unsigned int y = y0 >> u32Level; y <= (y1 >> u32Level); ++y)
+	{
+		for (unsigned int x = x0 >> u32Level; x <= (x1 >> u32Level); ++x)
+		{
+			if (vecLevel[y * u32LevelWidth + x] >= f32MinZ)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
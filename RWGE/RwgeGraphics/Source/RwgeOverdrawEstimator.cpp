@@ -0,0 +1,163 @@
+#include "RwgeOverdrawEstimator.h"
+
+#include <math.h>
+#include <float.h>
+#include <RwgeAssert.h>
+#include <RwgeBounds.h>
+
+// λ[f32Min, f32Max]ڵĸӷΧûʱؾڵĸ
+static void GetCellRange(float f32Min, float f32Max, unsigned int u32CellCount, unsigned int& u32First, unsigned int& u32Last)
+{
+	float f32First = ceilf(f32Min - 0.5f);
+	float f32Last = floorf(f32Max - 0.5f);
+	if (f32First > f32Last)
+	{
+		f32First = f32Last = floorf((f32Min + f32Max) * 0.5f);
+	}
+
+	const float f32MaxCell = static_cast<float>(u32CellCount - 1);
+	u32First = static_cast<unsigned int>(f32First < 0.0f ? 0.0f : (f32First > f32MaxCell ? f32MaxCell : f32First));
+	u32Last = static_cast<unsigned int>(f32Last < 0.0f ? 0.0f : (f32Last > f32MaxCell ? f32MaxCell : f32Last));
+}
+
+ROverdrawEstimator::ROverdrawEstimator(unsigned int u32CellSize /* = 16 */, unsigned int u32MaxCellsPerAxis /* = 128 */) :
+	m_u32CellSize(u32CellSize == 0 ? 1 : u32CellSize),
+	m_u32MaxCellsPerAxis(u32MaxCellsPerAxis == 0 ? 1 : u32MaxCellsPerAxis),
+	m_u32CellCountX(0),
+	m_u32CellCountY(0),
+	m_f64PixelsPerCell(0.0),
+	m_u64CoveredCells(0),
+	m_u64RasterizedCells(0),
+	m_u64ShadedCells(0)
+{
+
+}
+
+ROverdrawEstimator::~ROverdrawEstimator()
+{
+
+}
+
+void ROverdrawEstimator::Begin(unsigned int u32ViewportWidth, unsigned int u32ViewportHeight)
+{
+	m_u32CellCountX = (u32ViewportWidth + m_u32CellSize - 1) / m_u32CellSize;
+	m_u32CellCountY = (u32ViewportHeight + m_u32CellSize - 1) / m_u32CellSize;
+	m_u32CellCountX = m_u32CellCountX == 0 ? 1 : (m_u32CellCountX > m_u32MaxCellsPerAxis ? m_u32MaxCellsPerAxis : m_u32CellCountX);
+	m_u32CellCountY = m_u32CellCountY == 0 ? 1 : (m_u32CellCountY > m_u32MaxCellsPerAxis ? m_u32MaxCellsPerAxis : m_u32CellCountY);
+	m_f64PixelsPerCell = static_cast<double>(u32ViewportWidth) * u32ViewportHeight / (m_u32CellCountX * m_u32CellCountY);
+
+	const unsigned int u32CellCount = m_u32CellCountX * m_u32CellCountY;
+	m_vecDepth.assign(u32CellCount, 1.0f);
+	m_vecCovered.assign(u32CellCount, 0);
+
+	m_u64CoveredCells = 0;
+	m_u64RasterizedCells = 0;
+	m_u64ShadedCells = 0;
+	m_Estimate = OverdrawEstimate();
+}
+
+void ROverdrawEstimator::AddDraw(const RBounds& localBounds, const D3DXMATRIX& worldViewProj)
+{
+	RwgeAssert(!m_vecDepth.empty());
+
+	if (localBounds.IsEmpty())
+	{
+		return;
+	}
+
+	const D3DXVECTOR3 minPoint = localBounds.center - localBounds.extents;
+	const D3DXVECTOR3 maxPoint = localBounds.center + localBounds.extents;
+
+	float f32MinX = FLT_MAX, f32MinY = FLT_MAX, f32MinZ = FLT_MAX;
+	float f32MaxX = -FLT_MAX, f32MaxY = -FLT_MAX, f32MaxZ = -FLT_MAX;
+	bool bCrossNearPlane = false;
+
+	for (unsigned int u32Corner = 0; u32Corner < 8; ++u32Corner)
+	{
+		D3DXVECTOR3 corner(
+			(u32Corner & 1) ? maxPoint.x : minPoint.x,
+			(u32Corner & 2) ? maxPoint.y : minPoint.y,
+			(u32Corner & 4) ? maxPoint.z : minPoint.z);
+
+		D3DXVECTOR4 clip;
+		D3DXVec3Transform(&clip, &corner, &worldViewProj);
+
+		if (clip.z < 0.0f || clip.w <= 0.0f)
+		{
+			bCrossNearPlane = true;
+			break;
+		}
+
+		float f32InvW = 1.0f / clip.w;
+		float f32X = (clip.x * f32InvW * 0.5f + 0.5f) * m_u32CellCountX;
+		float f32Y = (0.5f - clip.y * f32InvW * 0.5f) * m_u32CellCountY;
+		float f32Z = clip.z * f32InvW;
+
+		f32MinX = f32X < f32MinX ? f32X : f32MinX;
+		f32MaxX = f32X > f32MaxX ? f32X : f32MaxX;
+		f32MinY = f32Y < f32MinY ? f32Y : f32MinY;
+		f32MaxY = f32Y > f32MaxY ? f32Y : f32MaxY;
+		f32MinZ = f32Z < f32MinZ ? f32Z : f32MinZ;
+		f32MaxZ = f32Z > f32MaxZ ? f32Z : f32MaxZ;
+	}
+
+	unsigned int x0, y0, x1, y1;
+	if (bCrossNearPlane)
+	{
+		x0 = 0;
+		y0 = 0;
+		x1 = m_u32CellCountX - 1;
+		y1 = m_u32CellCountY - 1;
+		f32MinZ = 0.0f;
+		f32MaxZ = 1.0f;
+	}
+	else
+	{
+		// ȫλӿԶƽ֮ĻƲ
+		if (f32MaxX < 0.0f || f32MaxY < 0.0f || f32MinX >= m_u32CellCountX || f32MinY >= m_u32CellCountY || f32MinZ > 1.0f)
+		{
+			return;
+		}
+
+		GetCellRange(f32MinX, f32MaxX, m_u32CellCountX, x0, x1);
+		GetCellRange(f32MinY, f32MaxY, m_u32CellCountY, y0, y1);
+		f32MaxZ = f32MaxZ > 1.0f ? 1.0f : f32MaxZ;
+	}
+
+	for (unsigned int y = y0; y <= y1; ++y)
+	{
+		float* aryDepth = &m_vecDepth[y * m_u32CellCountX];
+		unsigned char* aryCovered = &m_vecCovered[y * m_u32CellCountX];
+
+		for (unsigned int x = x0; x <= x1; ++x)
+		{
+			// ɫͬLESSEQUAL
+			if (f32MinZ <= aryDepth[x])
+			{
+				++m_u64ShadedCells;
+				aryDepth[x] = f32MaxZ < aryDepth[x] ? f32MaxZ : aryDepth[x];
+			}
+
+			if (!aryCovered[x])
+			{
+				aryCovered[x] = 1;
+				++m_u64CoveredCells;
+			}
+		}
+	}
+
+	m_u64RasterizedCells += static_cast<unsigned long long>(x1 - x0 + 1) * (y1 - y0 + 1);
+	++m_Estimate.u32DrawCount;
+}
+
+void ROverdrawEstimator::End()
+{
+	const double f64MaxPixels = 4294967295.0;
+	const double f64Covered = m_u64CoveredCells * m_f64PixelsPerCell;
+	const double f64Rasterized = m_u64RasterizedCells * m_f64PixelsPerCell;
+	const double f64Shaded = m_u64ShadedCells * m_f64PixelsPerCell;
+
+	m_Estimate.u32CoveredPixels = static_cast<unsigned int>(f64Covered < f64MaxPixels ? f64Covered + 0.5 : f64MaxPixels);
+	m_Estimate.u32RasterizedPixels = static_cast<unsigned int>(f64Rasterized < f64MaxPixels ? f64Rasterized + 0.5 : f64MaxPixels);
+	m_Estimate.u32ShadedPixels = static_cast<unsigned int>(f64Shaded < f64MaxPixels ? f64Shaded + 0.5 : f64MaxPixels);
+}
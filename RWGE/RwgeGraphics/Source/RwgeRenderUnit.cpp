@@ -2,52 +2,339 @@
 
 #include "RwgeVertexStream.h"
 #include "RwgeIndexStream.h"
-#include "RwgeD3d9VertexBuffer.h"
-#include "RwgeD3d9IndexBuffer.h"
+#include "RwgeDynamicUploader.h"
+#include "RwgeD3d9VertexDeclaration.h"
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+#include <algorithm>
 
 using namespace std;
 
+unsigned short RRenderUnit::m_u16NextGeometrySortId = 0;
+unsigned int RRenderUnit::m_u32VertexRevision = 0;
+
 RRenderUnit::RRenderUnit() : 
 	m_pVertexDeclaration(nullptr),
 	m_PrimitiveType(D3DPT_POINTLIST), 
 	m_u32PrimitiveCount(0), 
 	m_u32VertexCount(0), 
+	m_u32BaseVertexIndex(0),
+	m_u32StartIndex(0),
 	m_pIndexStream(nullptr),
-	m_pVertexBuffer(nullptr),
-	m_pIndexBuffer(nullptr),
-	m_pWorldTransform(nullptr)
+	m_u32DynamicStreamMask(0),
+	m_bBound(false),
+	m_bViewOrders(false),
+	m_pWorldTransform(nullptr),
+	m_u16GeometrySortId(m_u16NextGeometrySortId++)
 {
 
 }
 
-RRenderUnit::~RRenderUnit()
+RRenderUnit::RRenderUnit(const RRenderUnit& geometrySource) :
+	m_pVertexDeclaration(geometrySource.m_pVertexDeclaration),
+	m_PrimitiveType(geometrySource.m_PrimitiveType),
+	m_u32PrimitiveCount(geometrySource.m_u32PrimitiveCount),
+	m_u32VertexCount(geometrySource.m_u32VertexCount),
+	m_u32BaseVertexIndex(geometrySource.m_u32BaseVertexIndex),
+	m_u32StartIndex(geometrySource.m_u32StartIndex),
+	m_vecVertexStreams(geometrySource.m_vecVertexStreams),
+	m_pIndexStream(geometrySource.m_pIndexStream),
+	m_u32DynamicStreamMask(geometrySource.m_u32DynamicStreamMask),
+	m_bBound(geometrySource.m_bBound),
+	m_bViewOrders(geometrySource.m_bViewOrders),
+	m_pWorldTransform(nullptr),
+	m_LocalBounds(geometrySource.m_LocalBounds),
+	m_DrawPacket(geometrySource.m_DrawPacket),
+	m_u16GeometrySortId(geometrySource.m_u16GeometrySortId)
 {
+	// ҲԴȾԪİ󶨣ɾԴȾԪʱȻڻ
+	if (m_bBound)
+	{
+		for (VertexStream* pVertexStream : m_vecVertexStreams)
+		{
+			++pVertexStream->u32BindCount;
+		}
 
+		if (m_pIndexStream != nullptr)
+		{
+			++m_pIndexStream->u32BindCount;
+		}
+	}
+}
+
+RRenderUnit::~RRenderUnit()
+{
+	UnbindStreamFromBuffer();
 }
 
 void RRenderUnit::AddVertexStream(VertexStream* pVertexStream)
 {
+	// ʱÿжһԣԵһΪ׼
+	if (m_vecVertexStreams.empty())
+	{
+		m_u32VertexCount = pVertexStream->u32VertexCount;
+	}
+	else if (pVertexStream->u32VertexCount != m_u32VertexCount)
+	{
+		RwgeLog(TEXT("Vertex count of stream %u (%u) doesn't match the first stream (%u)."), 
+			m_vecVertexStreams.size(), pVertexStream->u32VertexCount, m_u32VertexCount);
+	}
+
 	m_vecVertexStreams.push_back(pVertexStream);
-	m_u32VertexCount += pVertexStream->u32VertexCount;
 }
 
-void RRenderUnit::BindStreamToBuffer()
+void RRenderUnit::BindStreamToBuffer(unsigned int u32DynamicStreamMask /* = 0 */)
 {
-	unsigned int u32BufferSize = 0;
-	for (VertexStream* pVertexStream : m_vecVertexStreams)
+	RwgeAssert(!m_bBound);
+
+	RGpuMemoryManager& gpuMemoryManager = RGpuMemoryManager::GetInstance();
+
+	// ȾԪѾ󶨵ֻü
+	m_u32DynamicStreamMask = u32DynamicStreamMask;
+	for (unsigned int i = 0; i < m_vecVertexStreams.size(); ++i)
+	{
+		VertexStream* pVertexStream = m_vecVertexStreams[i];
+		if (pVertexStream->u32BindCount++ > 0)
+		{
+			continue;
+		}
+
+		if (u32DynamicStreamMask & (1 << i))
+		{
+			// ƫÿλʱWriteDynamicStreams
+			pVertexStream->pD3dVertexBuffer = RDynamicUploader::GetInstance().GetD3dVertexBuffer();
+			pVertexStream->u32StreamOffset = 0;
+		}
+		else
+		{
+			gpuMemoryManager.BindVertexStream(pVertexStream, pVertexStream->allocation);
+		}
+	}
+
+	if (m_pIndexStream != nullptr && m_pIndexStream->u32BindCount++ == 0)
+	{
+		gpuMemoryManager.BindIndexStream(m_pIndexStream, m_pIndexStream->allocation);
+	}
+	m_bBound = true;
+
+	UpdateLocalBounds();
+	BakeDrawPacket();
+}
+
+void RRenderUnit::UnbindStreamFromBuffer()
+{
+	if (!m_bBound)
 	{
-		u32BufferSize += pVertexStream->u32StreamSize;
+		return;
 	}
 
-	m_pVertexBuffer = new RD3d9VertexBuffer(u32BufferSize);
-	m_pIndexBuffer = new RD3d9IndexBuffer(m_pIndexStream->u32StreamSize);
+	RGpuMemoryManager& gpuMemoryManager = RGpuMemoryManager::GetInstance();
 
+	// ȾԪõְ󶨣̬ûӷ䣬Freeκ
 	for (VertexStream* pVertexStream : m_vecVertexStreams)
 	{
-		m_pVertexBuffer->BindVertexStream(pVertexStream);
+		RwgeAssert(pVertexStream->u32BindCount > 0);
+		if (--pVertexStream->u32BindCount == 0)
+		{
+			gpuMemoryManager.Free(pVertexStream->allocation);
+			pVertexStream->pD3dVertexBuffer = nullptr;
+			pVertexStream->u32StreamOffset = 0;
+		}
+	}
+
+	if (m_pIndexStream != nullptr)
+	{
+		RwgeAssert(m_pIndexStream->u32BindCount > 0);
+		if (--m_pIndexStream->u32BindCount == 0)
+		{
+			gpuMemoryManager.Free(m_pIndexStream->allocation);
+			m_pIndexStream->pD3dIndexBuffer = nullptr;
+			m_pIndexStream->u32StreamOffset = 0;
+		}
+	}
+
+	m_u32DynamicStreamMask = 0;
+	m_bBound = false;
+	m_DrawPacket = DrawPacket();
+}
+
+bool RRenderUnit::UpdateVertexStream(unsigned char u8StreamID)
+{
+	RwgeAssert(u8StreamID < m_vecVertexStreams.size());
+
+	++m_u32VertexRevision;
+
+	// ̬ÿλʱд룻ΧȻʹðʱĶλ
+	if (m_u32DynamicStreamMask & (1 << u8StreamID))
+	{
+		return true;
+	}
+
+	// ̬ڻеλò䣬DrawPacketҪ
+	VertexStream* pVertexStream = m_vecVertexStreams[u8StreamID];
+	RwgeAssert(pVertexStream->allocation.IsValid());
+
+	return RGpuMemoryManager::GetInstance().UpdateVertexStream(pVertexStream->allocation, pVertexStream);
+}
+
+bool RRenderUnit::WriteDynamicStreams(DrawPacket& drawPacket) const
+{
+	RDynamicUploader& uploader = RDynamicUploader::GetInstance();
+
+	// ֻдdrawPacketʵʰ󶨵ԤȾֻ0
+	for (unsigned char i = 0; i < drawPacket.u8StreamCount; ++i)
+	{
+		if (!(m_u32DynamicStreamMask & (1 << i)))
+		{
+			continue;
+		}
+
+		const VertexStream* pVertexStream = m_vecVertexStreams[i];
+		RwgeAssert(pVertexStream->aryVertices);
+
+		unsigned int u32Offset;
+		void* pData = uploader.WriteVertices(pVertexStream->u32StreamSize, pVertexStream->u8VertexSize, u32Offset);
+		if (pData == nullptr)
+		{
+			return false;
+		}
+
+		RwgeCopyMemory(pData, pVertexStream->aryVertices, pVertexStream->u32StreamSize);
+		drawPacket.aryStreamOffsets[i] = u32Offset;
+	}
+
+	return true;
+}
+
+void RRenderUnit::SetSubRange(unsigned int u32BaseVertexIndex, unsigned int u32VertexCount, unsigned int u32StartIndex, unsigned int u32PrimitiveCount)
+{
+	m_u32BaseVertexIndex = u32BaseVertexIndex;
+	m_u32VertexCount = u32VertexCount;
+	m_u32StartIndex = u32StartIndex;
+	m_u32PrimitiveCount = u32PrimitiveCount;
+	m_bViewOrders = false;
+
+	UpdateLocalBounds();
+	BakeDrawPacket();
+}
+
+bool RRenderUnit::SetViewOrdersEnabled(bool bEnabled)
+{
+	m_bViewOrders = false;
+	if (!bEnabled)
+	{
+		return true;
+	}
+
+	const unsigned int u32OrderIndexCount = m_u32PrimitiveCount * 3;
+	if (m_PrimitiveType != D3DPT_TRIANGLELIST || m_pIndexStream == nullptr ||
+		m_pIndexStream->u32IndexCount < m_u32StartIndex + u32OrderIndexCount * (1 + u8ViewOrderCount))
+	{
+		RwgeLog(TEXT("Index stream doesn't contain view orders - PrimitiveType : %u, PrimitiveCount : %u, IndexCount : %u"),
+			static_cast<unsigned int>(m_PrimitiveType), m_u32PrimitiveCount, m_pIndexStream != nullptr ? m_pIndexStream->u32IndexCount : 0);
+		return false;
+	}
+
+	m_bViewOrders = true;
+	return true;
+}
+
+unsigned int RRenderUnit::GetViewOrderStartIndex(unsigned int u32Octant) const
+{
+	RwgeAssert(m_bViewOrders && u32Octant < u8ViewOrderCount);
+
+	return m_DrawPacket.u32StartIndex + (u32Octant + 1) * m_u32PrimitiveCount * 3;
+}
+
+unsigned int RRenderUnit::SelectViewOrder(const D3DXVECTOR3& viewDirection, const D3DXMATRIX& worldTransform)
+{
+	// ֲll * M = dMΪr0r1r2ʱl0 = d(r1r2) / detֻֻҪţdetֻӰ
+	const D3DXVECTOR3 row0(worldTransform._11, worldTransform._12, worldTransform._13);
+	const D3DXVECTOR3 row1(worldTransform._21, worldTransform._22, worldTransform._23);
+	const D3DXVECTOR3 row2(worldTransform._31, worldTransform._32, worldTransform._33);
+
+	D3DXVECTOR3 aryCofactors[3];
+	D3DXVec3Cross(&aryCofactors[0], &row1, &row2);
+	D3DXVec3Cross(&aryCofactors[1], &row2, &row0);
+	D3DXVec3Cross(&aryCofactors[2], &row0, &row1);
+
+	const bool bMirrored = D3DXVec3Dot(&row0, &aryCofactors[0]) < 0.0f;
+
+	unsigned int u32Octant = 0;
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		const bool bNegative = D3DXVec3Dot(&viewDirection, &aryCofactors[i]) < 0.0f;
+		if (bNegative != bMirrored)
+		{
+			u32Octant |= 1 << i;
+		}
+	}
+
+	return u32Octant;
+}
+
+bool RRenderUnit::HasSameGeometry(const RRenderUnit& other) const
+{
+	return m_DrawPacket.HasSameGeometry(other.m_DrawPacket);
+}
+
+void RRenderUnit::BakeDrawPacket()
+{
+	RwgeAssert(m_vecVertexStreams.size() <= DrawPacket::u8MaxStreams);
+
+	m_DrawPacket = DrawPacket();
+	m_DrawPacket.pD3dVertexDeclaration = m_pVertexDeclaration != nullptr ? m_pVertexDeclaration->GetD3dVertexDeclaration() : nullptr;
+	m_DrawPacket.pD3dIndexBuffer = m_pIndexStream != nullptr ? m_pIndexStream->pD3dIndexBuffer : nullptr;
+	m_DrawPacket.u8StreamCount = static_cast<unsigned char>(min<size_t>(m_vecVertexStreams.size(), DrawPacket::u8MaxStreams));
+	m_DrawPacket.u8PrimitiveType = static_cast<unsigned char>(m_PrimitiveType);
+	m_DrawPacket.u8IndexSize = m_pIndexStream != nullptr ? m_pIndexStream->u8IndexSize : 0;
+	m_DrawPacket.u32BaseVertexIndex = m_u32BaseVertexIndex;
+	m_DrawPacket.u32VertexCount = m_u32VertexCount;
+	m_DrawPacket.u32StartIndex = m_u32StartIndex + (m_pIndexStream != nullptr ? m_pIndexStream->u32StreamOffset / m_pIndexStream->u8IndexSize : 0);
+	m_DrawPacket.u32PrimitiveCount = m_u32PrimitiveCount;
+
+	for (unsigned char i = 0; i < m_DrawPacket.u8StreamCount; ++i)
+	{
+		const VertexStream* pVertexStream = m_vecVertexStreams[i];
+		if (pVertexStream->pD3dVertexBuffer == nullptr)
+		{
+			RwgeLog(TEXT("Vertex stream can't be baked into a draw packet before binding to a vertex buffer."));
+		}
+
+		m_DrawPacket.aryVertexBuffers[i] = pVertexStream->pD3dVertexBuffer;
+		m_DrawPacket.aryStreamOffsets[i] = pVertexStream->u32StreamOffset;
+		m_DrawPacket.aryStreamStrides[i] = pVertexStream->u8VertexSize;
 	}
+}
+
+void RRenderUnit::UpdateLocalBounds()
+{
+	m_LocalBounds.Reset();
+
+	if (m_pVertexDeclaration == nullptr || !m_pVertexDeclaration->HasPosition())
+	{
+		return;
+	}
+
+	unsigned char u8PositionStream = m_pVertexDeclaration->GetPositionStream();
+	if (u8PositionStream >= m_vecVertexStreams.size())
+	{
+		return;
+	}
+
+	const VertexStream* pVertexStream = m_vecVertexStreams[u8PositionStream];
+	if (pVertexStream->aryVertices == nullptr)
+	{
+		return;		// ֻڻУ綯̬Ļλ壩
+	}
+
+	const unsigned char* pPositions = reinterpret_cast<const unsigned char*>(pVertexStream->aryVertices) + 
+		m_u32BaseVertexIndex * pVertexStream->u8VertexSize + m_pVertexDeclaration->GetPositionOffset();
+
+	// ֻʹеһʱΧֻһζ
+	unsigned int u32VertexCount = min(m_u32VertexCount, pVertexStream->u32VertexCount - m_u32BaseVertexIndex);
 
-	m_pIndexBuffer->BindIndexStream(m_pIndexStream);
+	m_LocalBounds.SetByPoints(pPositions, u32VertexCount, pVertexStream->u8VertexSize);
 }
 
 //void RRenderUnit::UpdatePrimitiveCount()
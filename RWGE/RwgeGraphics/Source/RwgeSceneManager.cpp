@@ -1,11 +1,16 @@
 #include "RwgeSceneManager.h"
 
 #include <RwgeLog.h>
+#include <RwgeAssert.h>
 #include "RwgeCamera.h"
 #include "RwgeD3d9Viewport.h"
 #include "RwgeModel.h"
 #include "RwgeLight.h"
 #include "RwgeD3d9RenderQueue.h"
+#include "RwgeTransformStore.h"
+#include <RwgeMath.h>
+#include <algorithm>
+#include <float.h>
 
 using namespace std;
 
@@ -13,13 +18,29 @@ RSceneManager::RSceneManager() :
 	m_pRoot(new RSceneNode()), 
 	m_pLight(nullptr), 
 	m_pActiveCamera(nullptr), 
-	m_bSceneChanged(false)
+	m_bSceneChanged(false),
+	m_bFrustumCullingEnabled(true),
+	m_u32FrameIndex(0),
+	m_bFrameSceneChanged(false),
+	m_u32Revision(0),
+	m_SpatialIndex(0.5f, 0.25f),
+	m_u32RenderUnitCount(0),
+	m_u32LastRefittedProxyCount(0),
+	m_u32LastReinsertedProxyCount(0),
+	m_bOcclusionCullingEnabled(false),
+	m_f32OccluderMinScreenSize(0.1f),
+	m_u32MaxTrianglesPerOccluder(2048),
+	m_u32OccluderTriangleBudget(16384),
+	m_pStaticBatchRoot(nullptr)
 {
 	m_pRoot->m_pSceneManager = this;
+
+	RTransformStore::GetInstance().RegUpdateListener(this);
 }
 
 RSceneManager::~RSceneManager()
 {
+	RTransformStore::GetInstance().DeRegUpdateListener(this);
 
 }
 
@@ -30,22 +51,242 @@ RSceneNode* RSceneManager::GetSceneRoot() const
 
 void RSceneManager::RenderScene(RCamera* pCamera, RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue)
 {
-	m_pActiveCamera = pCamera;
+	BeginFrame();
+
+	m_SceneView.pCamera = pCamera;
+	CullView(m_SceneView);
+	BuildViewQueue(m_SceneView, pViewport, renderQueue);
+	renderQueue.Sort();
+}
+
+void RSceneManager::BeginFrame()
+{
+	++m_u32FrameIndex;
+
+	// з任ĳڵ㣬ͬռ֮ģ͵Χڱ֡ڲٱд
+	UpdateSpatialIndex();
+
+	m_vecFrameUnregisteredHandles.swap(m_vecUnregisteredHandles);
+	m_vecUnregisteredHandles.clear();
+
+	m_bFrameSceneChanged = m_bSceneChanged;
+	GetSceneKey();
+}
+
+void RSceneManager::CullView(SceneView& view) const
+{
+	view.vecCandidateModels.clear();
+	view.candidateBounds.Clear();
+	view.vecVisibleModels.clear();
+	view.statistics = CullingStatistics();
+
+	if (m_bFrustumCullingEnabled)
+	{
+		const RFrustum& frustum = view.pCamera->GetFrustum();
+
+		// Fat AABBȫλ׶ʱΧһҲ׶ڣģʹΧü
+		m_SpatialIndex.QueryFrustum(frustum, [&view](void* pUserData, bool bFullyInside)
+		{
+			RModel* pModel = static_cast<RModel*>(pUserData);
+
+			if (bFullyInside)
+			{
+				view.vecVisibleModels.push_back(pModel);
+			}
+			else
+			{
+				view.vecCandidateModels.push_back(pModel);
+				view.candidateBounds.PushBack(pModel->GetWorldBounds());
+			}
+		}, view.vecQueryStack);
+
+		const unsigned int u32CandidateCount = view.vecCandidateModels.size();
+		view.vecVisibleFlags.resize(u32CandidateCount);
+		frustum.CullBatch(view.candidateBounds, view.vecVisibleFlags.data());
+
+		for (unsigned int i = 0; i < u32CandidateCount; ++i)
+		{
+			if (view.vecVisibleFlags[i])
+			{
+				view.vecVisibleModels.push_back(view.vecCandidateModels[i]);
+			}
+		}
+	}
+	else
+	{
+		m_SpatialIndex.ForEachProxy([&view](void* pUserData) { view.vecVisibleModels.push_back(static_cast<RModel*>(pUserData)); });
+	}
+}
+
+void RSceneManager::BuildViewQueue(SceneView& view, RD3d9Viewport* pViewport, RD3d9RenderQueue& renderQueue)
+{
+	m_pActiveCamera = view.pCamera;
+
+	CullingStatistics& statistics = view.statistics;
+
+	if (m_bOcclusionCullingEnabled && !view.vecVisibleModels.empty())
+	{
+		OcclusionCullModels(view);
+	}
 
-	// еĳڵ
-	m_pRoot->UpdateSelfAndAllChildren();
+	statistics.u32ModelCount = m_SpatialIndex.GetProxyCount();
+	statistics.u32VisibleModelCount = view.vecVisibleModels.size();
+	statistics.u32CulledModelCount = statistics.u32ModelCount - statistics.u32VisibleModelCount;
 
-	// ģͼ뵽Ⱦ
-	// ToDoҪʵֿռ仮׶ü
-	renderQueue.Clear();
-	renderQueue.SetCamera(pCamera);
+	// Ⱦ֮֡䱣ֻҪɾѾӳƳģ
+	renderQueue.BeginBuild(this, m_u32FrameIndex);
+	for (unsigned int u32Handle : m_vecFrameUnregisteredHandles)
+	{
+		renderQueue.RemoveModel(u32Handle);
+	}
+
+	renderQueue.SetCamera(view.pCamera);
 	renderQueue.SetLight(m_pLight);
-	if (m_bSceneChanged)
+	if (m_bFrameSceneChanged)
 	{
 		renderQueue.NeedUpdateCachedMaterialShader();
 	}
-	renderQueue.SetSceneKey(GetSceneKey());
-	FindModelsInSceneTree(m_pRoot, renderQueue);
+	renderQueue.SetSceneKey(m_SceneKey);
+
+	renderQueue.InsertModels(view.vecVisibleModels.data(), view.vecVisibleModels.size());
+	for (RModel* pModel : view.vecVisibleModels)
+	{
+		statistics.u32VisibleRenderUnitCount += pModel->GetRenderUnitCount();
+	}
+	statistics.u32CulledRenderUnitCount = m_u32RenderUnitCount - statistics.u32VisibleRenderUnitCount;
+
+	if (pViewport != nullptr)
+	{
+		pViewport->SetCullingStatistics(statistics);
+	}
+}
+
+void RSceneManager::UpdateSpatialIndex()
+{
+	// ģͿѾUpdateб¼㣬ǶͨOnTransformsUpdated¼
+	RTransformStore::GetInstance().Update();
+
+	m_u32LastRefittedProxyCount = 0;
+	m_u32LastReinsertedProxyCount = 0;
+
+	for (unsigned int u32Handle : m_vecTransformChangedHandles)
+	{
+		RefreshProxy(u32Handle);
+	}
+	m_vecTransformChangedHandles.clear();
+
+	for (unsigned int u32Handle : m_vecBoundsChangedHandles)
+	{
+		RefreshProxy(u32Handle);
+	}
+	m_vecBoundsChangedHandles.clear();
+}
+
+void RSceneManager::BuildStaticBatches()
+{
+	// ʹģ͵任Ҫȸ
+	UpdateSpatialIndex();
+
+	vector<RModel*> vecStaticModels;
+	CollectStaticModels(m_pRoot, vecStaticModels);
+
+	if (m_pStaticBatchRoot == nullptr)
+	{
+		m_pStaticBatchRoot = m_pRoot->CreateChild();
+	}
+
+	unsigned int u32FirstBatchedModel = m_StaticBatcher.GetBatchedModels().size();
+	m_StaticBatcher.Build(vecStaticModels, m_pStaticBatchRoot);
+
+	const vector<RModel*>& vecBatchedModels = m_StaticBatcher.GetBatchedModels();
+	for (unsigned int u32Model = u32FirstBatchedModel; u32Model < vecBatchedModels.size(); ++u32Model)
+	{
+		UnregisterNode(vecBatchedModels[u32Model]);
+	}
+}
+
+void RSceneManager::ClearStaticBatches()
+{
+	vector<RModel*> vecBatchedModels = m_StaticBatcher.GetBatchedModels();
+	m_StaticBatcher.Clear();
+
+	for (RModel* pModel : vecBatchedModels)
+	{
+		if (pModel->GetAttachedSceneManager() == this)
+		{
+			RegisterNode(pModel);
+		}
+	}
+}
+
+void RSceneManager::CollectStaticModels(RSceneNode* pNode, vector<RModel*>& vecOutModels)
+{
+	if (pNode->m_NodeType == RSceneNode::ENT_Model)
+	{
+		RModel* pModel = static_cast<RModel*>(pNode);
+		if (pModel->IsStatic() && !pModel->IsStaticBatched())
+		{
+			vecOutModels.push_back(pModel);
+		}
+	}
+
+	for (RSceneNode* pChild : pNode->m_listChildren)
+	{
+		CollectStaticModels(pChild, vecOutModels);
+	}
+}
+
+RModel* RSceneManager::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, float f32MaxDistance, float* pOutDistance /* = nullptr */)
+{
+	UpdateSpatialIndex();
+
+	RModel* pHitModel = nullptr;
+	float f32HitDistance = f32MaxDistance;
+	D3DXVECTOR3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	// бFat AABBҶӺҪģ͵Χ
+	m_SpatialIndex.RayCast(origin, direction, f32MaxDistance, [&](void* pUserData, float f32CurMaxDistance) -> float
+	{
+		RModel* pModel = static_cast<RModel*>(pUserData);
+		const RBounds& bounds = pModel->GetWorldBounds();
+
+		float f32Distance;
+		if (bounds.IsEmpty() || 
+			!Aabb(bounds.center - bounds.extents, bounds.center + bounds.extents).IntersectRay(origin, invDirection, f32CurMaxDistance, f32Distance))
+		{
+			return f32CurMaxDistance;
+		}
+
+		pHitModel = pModel;
+		f32HitDistance = f32Distance;
+		return f32Distance;
+	});
+
+	if (pHitModel != nullptr && pOutDistance != nullptr)
+	{
+		*pOutDistance = f32HitDistance;
+	}
+
+	return pHitModel;
+}
+
+void RSceneManager::QueryModelsInAabb(const D3DXVECTOR3& minPoint, const D3DXVECTOR3& maxPoint, std::vector<RModel*>& vecOutModels)
+{
+	UpdateSpatialIndex();
+
+	Aabb queryAabb(minPoint, maxPoint);
+	m_SpatialIndex.QueryAabb(queryAabb, [&](void* pUserData) -> bool
+	{
+		RModel* pModel = static_cast<RModel*>(pUserData);
+		const RBounds& bounds = pModel->GetWorldBounds();
+
+		if (!bounds.IsEmpty() && queryAabb.Overlaps(Aabb(bounds.center - bounds.extents, bounds.center + bounds.extents)))
+		{
+			vecOutModels.push_back(pModel);
+		}
+
+		return true;
+	});
 }
 
 void RSceneManager::SetLight(RLight* pLight)
@@ -53,6 +294,7 @@ void RSceneManager::SetLight(RLight* pLight)
 	m_pLight = pLight;
 	
 	m_bSceneChanged = true;
+	++m_u32Revision;
 }
 
 const RLight* RSceneManager::GetLight() const
@@ -65,6 +307,13 @@ RCamera* RSceneManager::GetActiveCamera()
 	return m_pActiveCamera;
 }
 
+void RSceneManager::SetOccluderSelection(float f32MinScreenSize, unsigned int u32MaxTrianglesPerOccluder, unsigned int u32TriangleBudget)
+{
+	m_f32OccluderMinScreenSize = f32MinScreenSize;
+	m_u32MaxTrianglesPerOccluder = u32MaxTrianglesPerOccluder;
+	m_u32OccluderTriangleBudget = u32TriangleBudget;
+}
+
 const SceneKey& RSceneManager::GetSceneKey()
 {
 	if (m_bSceneChanged)
@@ -84,17 +333,215 @@ const SceneKey& RSceneManager::GetSceneKey()
 	return m_SceneKey;
 }
 
-void RSceneManager::FindModelsInSceneTree(RSceneNode* pNode, RD3d9RenderQueue& renderQueue)
+void RSceneManager::RegisterNode(RSceneNode* pNode)
 {
-	// ڵĲ֤˳вܴڿսڵ㣬˲Ҫָ
+	if (pNode->m_NodeType != RSceneNode::ENT_Model)
+	{
+		return;
+	}
 
-	if (pNode->m_NodeType == RSceneNode::ENT_Model)
+	RModel* pModel = static_cast<RModel*>(pNode);
+	unsigned int u32Handle = pNode->m_u32TransformHandle;
+
+	// ϲģɾ̬еĴģʹ
+	if (pModel->IsStaticBatched())
+	{
+		return;
+	}
+
+	if (u32Handle >= m_vecHandleToProxy.size())
+	{
+		ModelProxy nullProxy = { RDynamicAabbTree::u32NullNode, 0, false };
+		m_vecHandleToProxy.resize(u32Handle + 1, nullProxy);
+	}
+
+	ModelProxy& modelProxy = m_vecHandleToProxy[u32Handle];
+	RwgeAssert(modelProxy.u32Proxy == RDynamicAabbTree::u32NullNode);
+
+	modelProxy.u32Proxy = m_SpatialIndex.CreateProxy(GetProxyAabb(pModel), pModel);
+	modelProxy.u32RenderUnitCount = pModel->GetRenderUnitCount();
+	m_u32RenderUnitCount += modelProxy.u32RenderUnitCount;
+	++m_u32Revision;
+}
+
+void RSceneManager::UnregisterNode(RSceneNode* pNode)
+{
+	// ڵʱҲãʱܷRModelĳԱֻݾ
+	unsigned int u32Handle = pNode->m_u32TransformHandle;
+
+	if (u32Handle < m_vecHandleToProxy.size() && m_vecHandleToProxy[u32Handle].u32Proxy != RDynamicAabbTree::u32NullNode)
+	{
+		ModelProxy& modelProxy = m_vecHandleToProxy[u32Handle];
+
+		m_SpatialIndex.DestroyProxy(modelProxy.u32Proxy);
+		m_u32RenderUnitCount -= modelProxy.u32RenderUnitCount;
+
+		modelProxy.u32Proxy = RDynamicAabbTree::u32NullNode;
+		modelProxy.u32RenderUnitCount = 0;
+		modelProxy.bTransformChanged = false;
+
+		m_vecUnregisteredHandles.push_back(u32Handle);
+		++m_u32Revision;
+	}
+}
+
+void RSceneManager::NotifyModelBoundsChanged(RModel* pModel)
+{
+	m_vecBoundsChangedHandles.push_back(pModel->GetTransformHandle());
+	++m_u32Revision;
+}
+
+void RSceneManager::OnTransformsUpdated(const RTransformStore& transformStore)
+{
+	// ֻ¼ڱעģͣ¼֮עģͻRefreshProxyб
+	transformStore.ForEachUpdatedTransform([this](unsigned int u32Handle)
 	{
-		renderQueue.InsertModel(reinterpret_cast<RModel*>(pNode));
+		if (u32Handle < m_vecHandleToProxy.size() && m_vecHandleToProxy[u32Handle].u32Proxy != RDynamicAabbTree::u32NullNode)
+		{
+			ModelProxy& modelProxy = m_vecHandleToProxy[u32Handle];
+			if (!modelProxy.bTransformChanged)
+			{
+				modelProxy.bTransformChanged = true;
+				m_vecTransformChangedHandles.push_back(u32Handle);
+			}
+		}
+	});
+}
+
+void RSceneManager::RefreshProxy(unsigned int u32TransformHandle)
+{
+	// 任Ľڵ㲻һģͣҲһڵǰ
+	if (u32TransformHandle >= m_vecHandleToProxy.size() || m_vecHandleToProxy[u32TransformHandle].u32Proxy == RDynamicAabbTree::u32NullNode)
+	{
+		return;
 	}
 
-	for (RSceneNode* pChildNode : pNode->m_listChildren)
+	ModelProxy& modelProxy = m_vecHandleToProxy[u32TransformHandle];
+	RModel* pModel = static_cast<RModel*>(m_SpatialIndex.GetUserData(modelProxy.u32Proxy));
+	modelProxy.bTransformChanged = false;
+
+	unsigned int u32RenderUnitCount = pModel->GetRenderUnitCount();
+	m_u32RenderUnitCount = m_u32RenderUnitCount - modelProxy.u32RenderUnitCount + u32RenderUnitCount;
+	modelProxy.u32RenderUnitCount = u32RenderUnitCount;
+
+	++m_u32LastRefittedProxyCount;
+	if (m_SpatialIndex.MoveProxy(modelProxy.u32Proxy, GetProxyAabb(pModel)))
 	{
-		FindModelsInSceneTree(pChildNode, renderQueue);
+		++m_u32LastReinsertedProxyCount;
 	}
 }
+
+Aabb RSceneManager::GetProxyAabb(const RModel* pModel)
+{
+	const RBounds& bounds = pModel->GetWorldBounds();
+
+	// ûģλΪAABB
+	if (bounds.IsEmpty())
+	{
+		return Aabb(pModel->GetWorldPosition(), pModel->GetWorldPosition());
+	}
+
+	return Aabb(bounds.center - bounds.extents, bounds.center + bounds.extents);
+}
+
+void RSceneManager::OcclusionCullModels(SceneView& view)
+{
+	const RCamera* pCamera = view.pCamera;
+	CullingStatistics& statistics = view.statistics;
+	vector<RModel*>& vecVisibleModels = view.vecVisibleModels;
+
+	const unsigned int u32VisibleCount = vecVisibleModels.size();
+	const D3DXVECTOR3& cameraPosition = pCamera->GetWorldPosition();
+
+	D3DXMATRIX viewProj;
+	D3DXMatrixMultiply(&viewProj, pCamera->GetViewTransform(), pCamera->GetProjectionTransform());
+	m_OcclusionBuffer.BeginFrame(viewProj);
+
+	// ָڵֱӼ룬ģͰĻߴԤѡ
+	m_vecOccluderCandidates.clear();
+	m_vecOccluderFlags.assign(u32VisibleCount, 0);
+	unsigned int u32TriangleCount = 0;
+
+	for (unsigned int i = 0; i < u32VisibleCount; ++i)
+	{
+		RModel* pModel = vecVisibleModels[i];
+		unsigned int u32ModelTriangleCount = pModel->GetOccluderTriangleCount();
+
+		if (pModel->GetOccluderMode() == EOM_Never || u32ModelTriangleCount == 0)
+		{
+			continue;
+		}
+
+		if (pModel->GetOccluderMode() == EOM_Always)
+		{
+			pModel->AddToOcclusionBuffer(m_OcclusionBuffer);
+			m_vecOccluderFlags[i] = 1;
+			u32TriangleCount += u32ModelTriangleCount;
+			continue;
+		}
+
+		const RBounds& bounds = pModel->GetWorldBounds();
+		if (u32ModelTriangleCount > m_u32MaxTrianglesPerOccluder || bounds.IsEmpty())
+		{
+			continue;
+		}
+
+		// λڰΧʱģͼռĻ
+		float f32Distance = RwgeMath::Distance(cameraPosition, bounds.center);
+		float f32ScreenSize = f32Distance > bounds.f32Radius ? bounds.f32Radius / f32Distance : FLT_MAX;
+
+		if (f32ScreenSize >= m_f32OccluderMinScreenSize)
+		{
+			OccluderCandidate candidate = { f32ScreenSize, i };
+			m_vecOccluderCandidates.push_back(candidate);
+		}
+	}
+
+	std::sort(m_vecOccluderCandidates.begin(), m_vecOccluderCandidates.end(), [](const OccluderCandidate& left, const OccluderCandidate& right)
+	{
+		return left.f32ScreenSize > right.f32ScreenSize;
+	});
+
+	for (const OccluderCandidate& candidate : m_vecOccluderCandidates)
+	{
+		RModel* pModel = vecVisibleModels[candidate.u32VisibleIndex];
+		unsigned int u32ModelTriangleCount = pModel->GetOccluderTriangleCount();
+
+		if (u32TriangleCount + u32ModelTriangleCount > m_u32OccluderTriangleBudget)
+		{
+			continue;
+		}
+
+		pModel->AddToOcclusionBuffer(m_OcclusionBuffer);
+		m_vecOccluderFlags[candidate.u32VisibleIndex] = 1;
+		u32TriangleCount += u32ModelTriangleCount;
+	}
+
+	statistics.u32OccluderCount = m_OcclusionBuffer.GetOccluderCount();
+	statistics.u32OccluderTriangleCount = m_OcclusionBuffer.GetOccluderTriangleCount();
+
+	if (statistics.u32OccluderCount == 0)
+	{
+		return;
+	}
+
+	m_OcclusionBuffer.Rasterize();
+
+	// ڵǿɼģģʹΧԣԭƳڵģ
+	unsigned int u32KeptCount = 0;
+	for (unsigned int i = 0; i < u32VisibleCount; ++i)
+	{
+		RModel* pModel = vecVisibleModels[i];
+		const RBounds& bounds = pModel->GetWorldBounds();
+
+		if (!m_vecOccluderFlags[i] && !bounds.IsEmpty() && m_OcclusionBuffer.IsOccluded(bounds.center - bounds.extents, bounds.center + bounds.extents))
+		{
+			++statistics.u32OccludedModelCount;
+			continue;
+		}
+
+		vecVisibleModels[u32KeptCount++] = pModel;
+	}
+
+	vecVisibleModels.resize(u32KeptCount);
+}
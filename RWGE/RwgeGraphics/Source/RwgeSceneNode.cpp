@@ -1,6 +1,7 @@
 #include "RwgeSceneNode.h"
 
 #include "RwgeSceneManager.h"
+#include "RwgeTransformStore.h"
 #include <RwgeAssert.h>
 #include <RwgeMath.h>
 #include <RwgeLog.h>
@@ -8,31 +9,35 @@
 using namespace RwgeMath;
 
 RSceneNode::RSceneNode() : 
-	m_pSceneManager					(nullptr),
-	m_NodeType						(ENT_Node),
-    m_Position						(0.0f, 0.0f, 0.0f),
-	m_Orientation					(0.0f, 0.0f, 0.0f, 1.0f),
-	m_Scale							(1.0f, 1.0f, 1.0f),
-	m_WorldPosition					(0.0f, 0.0f, 0.0f),
-	m_WorldOrientation				(0.0f, 0.0f, 0.0f, 1.0f),
-	m_WorldScale					(1.0f, 1.0f, 1.0f),
-	m_pParent						(nullptr),
-	m_bParentHasNotified			(false),
-	m_bNeedAllChildrenUpdate		(false),
-	m_bWorldTransformChanged		(false),
-	m_bCachedTransformOutOfDate		(false),
-	m_bCachedWorldTransformOutOfDate(false),
-	m_bInheritTranslation			(true),
-	m_bInheritRotation				(true),
-	m_bInheritScale					(true)
-{
-	D3DXMatrixIdentity(&m_Transform);
-	D3DXMatrixIdentity(&m_WorldTransform);
+	m_pSceneManager		(nullptr),
+	m_NodeType			(ENT_Node),
+	m_u32TransformHandle(RTransformStore::GetInstance().CreateTransform()),
+	m_pParent			(nullptr)
+{
+
 }
 
 RSceneNode::~RSceneNode()
 {
+	// ӽڵ㲻ᱻͷţǳΪûиڵĽڵ
+	for (auto pChild : m_listChildren)
+	{
+		pChild->m_pParent = nullptr;
+		pChild->SetSceneManager(nullptr);
+		RTransformStore::GetInstance().SetParent(pChild->m_u32TransformHandle, RTransformStore::u32InvalidHandle);
+	}
 
+	if (m_pParent)
+	{
+		m_pParent->m_listChildren.remove(this);
+	}
+
+	if (m_pSceneManager)
+	{
+		m_pSceneManager->UnregisterNode(this);
+	}
+
+	RTransformStore::GetInstance().ReleaseTransform(m_u32TransformHandle);
 }
 
 RSceneNode* RSceneNode::CreateChild()
@@ -45,6 +50,7 @@ RSceneNode* RSceneNode::CreateChild()
 	// ýڵĸڵΪǰڵ
 	pNode->m_pParent = this;
 	pNode->m_pSceneManager = this->m_pSceneManager;
+	RTransformStore::GetInstance().SetParent(pNode->m_u32TransformHandle, m_u32TransformHandle);
 
 	return pNode;
 }
@@ -55,6 +61,7 @@ void RSceneNode::ReleaseChild(RSceneNode* pNode)
 	{
 		// ӽڵбƳ
 		m_listChildren.remove(pNode);
+		pNode->m_pParent = nullptr;
 
 		delete pNode;
 	}
@@ -75,10 +82,10 @@ void RSceneNode::AttachChild(RSceneNode* pNode)
 
 		// ýڵĸڵΪǰڵ
 		pNode->m_pParent = this;
-		pNode->m_pSceneManager = this->m_pSceneManager;
+		pNode->SetSceneManager(m_pSceneManager);
 
 		// ΪpNodeĸڵ㷢˸ı䣬ҪpNode任
-		pNode->NeedUpdate();
+		RTransformStore::GetInstance().SetParent(pNode->m_u32TransformHandle, m_u32TransformHandle);
 	}
 #ifdef _DEBUG
 	else
@@ -97,7 +104,8 @@ void RSceneNode::RemoveChild(RSceneNode* pNode)
 
 		// ڵ㸸ڵΪ
 		pNode->m_pParent = nullptr;
-		pNode->m_pSceneManager = nullptr;
+		pNode->SetSceneManager(nullptr);
+		RTransformStore::GetInstance().SetParent(pNode->m_u32TransformHandle, RTransformStore::u32InvalidHandle);
 	}
 }
 
@@ -108,61 +116,65 @@ RSceneNode* RSceneNode::GetParent() const
 
 void RSceneNode::Translate(const D3DXVECTOR3& vector, ETransformSpace space /* = TB_Parent */)
 {
+	D3DXVECTOR3 position = GetPosition();
+
 	switch (space)
 	{
 	case TS_World:
 		if (m_pParent)
 		{
-			m_Position += m_pParent->GetWorldOrientation().Inverse().RotateVector(vector) / m_pParent->GetWorldScale();
+			position += m_pParent->GetWorldOrientation().Inverse().RotateVector(vector) / m_pParent->GetWorldScale();
 		}
 		else
 		{
 			// ڸڵ㣬ٶڵΪϵԭ
-			m_Position += vector;
+			position += vector;
 		}
 		break;
 
 	case TS_Self:
-		m_Position += m_Orientation.RotateVector(vector);
+		position += GetOrientation().RotateVector(vector);
 		break;
 
 	case TS_Parent:
 	default:
-		m_Position += vector;
+		position += vector;
 		break;
 	}
 
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalPosition(m_u32TransformHandle, position);
 }
 
-// SetPositionȼm_Position = (0, 0, 0)ʱִTranslate
+// SetPositionȼھֲλΪ(0, 0, 0)ʱִTranslate
 void RSceneNode::SetPosition(const D3DXVECTOR3& position, ETransformSpace space /* = TB_Parent */)
 {
+	D3DXVECTOR3 newPosition;
+
 	switch (space)
 	{
 	case TS_World:
 		if (m_pParent)
 		{
-			m_Position = m_pParent->GetWorldOrientation().Inverse().RotateVector(position) / m_pParent->GetWorldScale();
+			newPosition = m_pParent->GetWorldOrientation().Inverse().RotateVector(position) / m_pParent->GetWorldScale();
 		}
 		else
 		{
 			// ڸڵ㣬ٶڵΪϵԭ
-			m_Position = position;
+			newPosition = position;
 		}
 		break;
 
 	case TS_Self:
-		m_Position = m_Orientation.RotateVector(position);
+		newPosition = GetOrientation().RotateVector(position);
 		break;
 
 	case TS_Parent:
 	default:
-		m_Position = position;
+		newPosition = position;
 		break;
 	}
 
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalPosition(m_u32TransformHandle, newPosition);
 }
 
 /* 
@@ -180,35 +192,37 @@ void RSceneNode::Rotate(const RQuaternion& rotation, ETransformSpace space /* =
 	RQuaternion qNormal = rotation;
 	qNormal.Normalise();
 
+	RQuaternion orientation = GetOrientation();
+
 	switch (space)
 	{
 	case TS_World:
 		if (m_pParent)
 		{
 			RQuaternion parentWorldOrientation = m_pParent->GetWorldOrientation();
-			m_Orientation = parentWorldOrientation.Inverse() * qNormal * parentWorldOrientation * m_Orientation;
+			orientation = parentWorldOrientation.Inverse() * qNormal * parentWorldOrientation * orientation;
 		}
 		else
 		{
 			// ڸڵ㣬ٶڵΪϵԭ
-			m_Orientation = qNormal * m_Orientation;
+			orientation = qNormal * orientation;
 		}
 		break;
 
 	case TS_Parent:
-		m_Orientation = qNormal * m_Orientation;
+		orientation = qNormal * orientation;
 		break;
 
 	case TS_Self:
 	default:
-		m_Orientation = m_Orientation * qNormal;
+		orientation = orientation * qNormal;
 		break;
 	}
 
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalOrientation(m_u32TransformHandle, orientation);
 }
 
-// SetOrientationȼm_Orientation = (1, 0, 0, 0)ʱִRotate
+// SetOrientationȼھֲתΪ(0, 0, 0, 1)ʱִRotate
 void RSceneNode::SetOrientation(const RQuaternion& orientation, ETransformSpace space /* = TS_Self */)
 {
 	RQuaternion qNormal = orientation;
@@ -220,23 +234,17 @@ void RSceneNode::SetOrientation(const RQuaternion& orientation, ETransformSpace
 		if (m_pParent)
 		{
 			RQuaternion parentWorldOrientation = m_pParent->GetWorldOrientation();
-			m_Orientation = parentWorldOrientation.Inverse() * qNormal * parentWorldOrientation;
-		}
-		else
-		{
-			// ڸڵ㣬ٶڵΪϵԭ
-			m_Orientation = qNormal;
+			qNormal = parentWorldOrientation.Inverse() * qNormal * parentWorldOrientation;
 		}
 		break;
 
 	case TS_Parent:
 	case TS_Self:
 	default:
-		m_Orientation = qNormal;
 		break;
 	}
 
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalOrientation(m_u32TransformHandle, qNormal);
 }
 
 void RSceneNode::Pitch(const AngleRadian& radianAngle, ETransformSpace space /* = TS_Self */)
@@ -261,7 +269,7 @@ D3DXVECTOR3 RSceneNode::GetDirection(ETransformSpace space /* = TS_World */) con
 	switch (space)
 	{
 	case TS_Parent:
-		originalDirection = m_Orientation.RotateVector(RwgeMath::Vector3UnitZ);
+		originalDirection = GetOrientation().RotateVector(RwgeMath::Vector3UnitZ);
 		break;
 
 	case TS_Self:
@@ -291,7 +299,7 @@ void RSceneNode::LookAt(const D3DXVECTOR3& targetPosition, ETransformSpace space
 	switch (space)
 	{
 	case TS_Parent:
-		targetDirection = targetPosition - m_Position;
+		targetDirection = targetPosition - GetPosition();
 		break;
 
 	case TS_Self:
@@ -309,275 +317,85 @@ void RSceneNode::LookAt(const D3DXVECTOR3& targetPosition, ETransformSpace space
 
 void RSceneNode::Scale(const D3DXVECTOR3& scale)
 {
-	m_Scale *= scale;
-
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalScale(m_u32TransformHandle, GetScale() * scale);
 }
 
-// SetScaleȼm_Scale = (1, 1, 1)ʱִScale
+// SetScaleȼھֲΪ(1, 1, 1)ʱִScale
 void RSceneNode::SetScale(const D3DXVECTOR3& scale, ETransformSpace space /* = TS_Self */)
 {
+	D3DXVECTOR3 newScale;
+
 	switch (space)
 	{
 	case TS_World:
 		if (m_pParent)
 		{
-			m_Scale = m_Scale / m_pParent->GetWorldScale();
+			newScale = scale / m_pParent->GetWorldScale();
 		}
 		else
 		{
 			// ڸڵ㣬ٶڵΪϵԭ
-			m_Scale = scale;
+			newScale = scale;
 		}
 		break;
 
 	case TS_Parent:
 	case TS_Self:
 	default:
-		m_Scale = scale;
+		newScale = scale;
 		break;
 	}
 
-	NeedUpdate();
+	RTransformStore::GetInstance().SetLocalScale(m_u32TransformHandle, newScale);
 }
 
 const D3DXVECTOR3& RSceneNode::GetPosition() const
 {
-	return m_Position;
+	return RTransformStore::GetInstance().GetLocalPosition(m_u32TransformHandle);
 }
 
 const D3DXVECTOR3& RSceneNode::GetWorldPosition() const
 {
-	// Ҫ任
-	if (m_bWorldTransformChanged)
-	{
-		UpdateWorldTransform();
-	}
-
-	return m_WorldPosition;
+	return RTransformStore::GetInstance().GetWorldPosition(m_u32TransformHandle);
 }
 
 const RQuaternion& RSceneNode::GetOrientation() const
 {
-	return m_Orientation;
+	return RTransformStore::GetInstance().GetLocalOrientation(m_u32TransformHandle);
 }
 
 const RQuaternion& RSceneNode::GetWorldOrientation() const
 {
-	// Ҫ任
-	if (m_bWorldTransformChanged)
-	{
-		UpdateWorldTransform();
-	}
-
-	return m_WorldOrientation;
+	return RTransformStore::GetInstance().GetWorldOrientation(m_u32TransformHandle);
 }
 
 const D3DXVECTOR3& RSceneNode::GetScale() const
 {
-	return m_Scale;
+	return RTransformStore::GetInstance().GetLocalScale(m_u32TransformHandle);
 }
 
 const D3DXVECTOR3& RSceneNode::GetWorldScale() const
 {
-	// Ҫ任
-	if (m_bWorldTransformChanged)
-	{
-		UpdateWorldTransform();
-	}
-
-	return m_WorldScale;
+	return RTransformStore::GetInstance().GetWorldScale(m_u32TransformHandle);
 }
 
-const D3DXMATRIX& RSceneNode::GetTransform() const
+D3DXMATRIX RSceneNode::GetTransform() const
 {
-	if (m_bCachedTransformOutOfDate)
-	{
-		UpdateCachedTransform();
-	}
+	// 任ٱʹã˲棬ÿλȡʱ
+	D3DXMATRIX transform;
+	SetTransform(transform, GetPosition(), GetOrientation(), GetScale());
 
-	return m_Transform;
+	return transform;
 }
 
 const D3DXMATRIX& RSceneNode::GetWorldTransform() const
 {
-	if (m_bCachedWorldTransformOutOfDate)
-	{
-		UpdateCachedWorldTransform();
-	}
-
-	return m_WorldTransform;
-}
-
-void RSceneNode::UpdateWorldTransform() const
-{
-	// Եϸ任ĹУԶݹ飬ֱ򳡾ĸ
-
-	if (m_pParent)
-	{
-		const RQuaternion& parentWorldOrientation = m_pParent->GetWorldOrientation();
-		const D3DXVECTOR3& parentWorldScale = m_pParent->GetWorldScale();
-
-		// ̳иڵλ
-		if (m_bInheritTranslation)
-		{
-			m_WorldPosition = parentWorldOrientation.RotateVector(parentWorldScale * m_Position) + m_pParent->GetWorldPosition();
-		}
-		else
-		{
-			m_WorldPosition = m_Position;
-		}
-		
-		// ̳иڵת
-		if (m_bInheritRotation)
-		{
-			m_WorldOrientation = parentWorldOrientation * m_Orientation;
-		}
-		else
-		{
-			m_WorldOrientation = m_Orientation;
-		}
-
-		// ̳иڵ
-		if (m_bInheritScale)
-		{
-			m_WorldScale = parentWorldScale * m_Scale;
-		}
-		else
-		{
-			m_WorldScale = m_Scale;
-		}
-	}
-	// ڸڵ㣬任任
-	else
-	{
-		m_WorldPosition = m_Position;
-		m_WorldOrientation = m_Orientation;
-		m_WorldScale = m_Scale;
-	}
-
-	// ø任ı־
-	m_bWorldTransformChanged = false;
-	m_bParentHasNotified = false;
-	m_bCachedWorldTransformOutOfDate = true;
+	return RTransformStore::GetInstance().GetWorldTransform(m_u32TransformHandle);
 }
 
-void RSceneNode::UpdateCachedTransform() const
+unsigned int RSceneNode::GetWorldRevision() const
 {
-	SetTransform(m_Transform, m_Position, m_Orientation, m_Scale);
-
-	m_bCachedTransformOutOfDate = false;
-}
-
-void RSceneNode::UpdateCachedWorldTransform() const
-{
-	if (m_bWorldTransformChanged)
-	{
-		UpdateWorldTransform();
-	}
-
-	SetTransform(m_WorldTransform, m_WorldPosition, m_WorldOrientation, m_WorldScale);
-
-	m_bCachedWorldTransformOutOfDate = false;
-}
-
-void RSceneNode::NeedUpdate()
-{
-	m_bWorldTransformChanged = true;
-	m_bCachedTransformOutOfDate = true;
-	m_bCachedWorldTransformOutOfDate = true;
-
-	NotifyParentToUpdate();		// ֪ͨڵҪ
-	NotifyChildrenToUpdate();	// ֪ͨӽڵҪ
-}
-
-void RSceneNode::NotifyParentToUpdate()
-{
-	// ֻڸڵڣҸڵδ֪ͨ²ִ֪ͨ
-	if (m_pParent && !m_bParentHasNotified)
-	{
-		// ڵҪеӽڵ㣬˵ڵѾϴݹ֪ͨˣʱҪظ֪ͨ
-
-		// ڵ㲻еӽڵ㣬ִ֪ͨ
-		if (!m_pParent->m_bNeedAllChildrenUpdate)
-		{
-			m_pParent->m_listChildrenToUpdate.push_back(this);
-
-			// ĸ֪ͨ
-			m_pParent->NotifyParentToUpdate();
-		}
-
-		m_bParentHasNotified = true;
-	}
-}
-
-void RSceneNode::NotifyChildrenToUpdate()
-{
-	// ֪ͨӽڵµȱ
-	// ŵ㣺ԽʡĿ
-	// ȱ㣺ӽڵ任»ӳһ֡Aڵĸڵڵ1֡ı䣬1֡ʱȡAڵ任õڵı֮ǰֵ
-
-#if NOTIFY_CHILDREN_WHEN_TRANSFORM
-	// Ҫеӽڵʱִ֪ͨ
-	if (!m_bNeedAllChildrenUpdate)
-	{
-		for (auto pChild : m_listChildren)
-		{
-			// ӽڵҪ任˵ӽڵѾ㲥֪ͨҪظ㲥
-
-			// ӽڵ㲻֪任˸ı䣬ִ֪ͨ
-			if (!pChild->m_bWorldTransformChanged)
-			{
-				pChild->m_bWorldTransformChanged = true;
-
-				// 㲥֪ͨ
-				pChild->NotifyChildrenToUpdate();
-			}
-		}
-
-		m_bNeedAllChildrenUpdate = true;
-		m_listChildrenToUpdate.clear();		// еӽڵ㶼Ҫʱմӽڵб
-	}
-#else
-	m_bNeedAllChildrenUpdate = true;
-	m_listChildrenToUpdate.clear();			// еӽڵ㶼Ҫʱմӽڵб
-#endif
-}
-
-void RSceneNode::UpdateSelfAndAllChildren(bool bForceUpdate /* = false */) const
-{
-	// µǰڵ
-	if (bForceUpdate)
-	{
-		UpdateWorldTransform();
-
-		m_bNeedAllChildrenUpdate = true;
-		m_listChildrenToUpdate.clear();
-	}
-	else if (m_bWorldTransformChanged)
-	{
-		UpdateWorldTransform();
-	}
-
-	// ӽڵ
-	if (m_bNeedAllChildrenUpdate)
-	{
-		for (auto pChild : m_listChildren)
-		{
-			pChild->UpdateSelfAndAllChildren(true);
-		}
-
-		m_bNeedAllChildrenUpdate = false;
-	}
-	else
-	{
-		for (auto pChild : m_listChildrenToUpdate)
-		{
-			pChild->UpdateSelfAndAllChildren(true);
-		}
-
-		m_listChildrenToUpdate.clear();
-	}
+	return RTransformStore::GetInstance().GetWorldRevision(m_u32TransformHandle);
 }
 
 D3DXMATRIX* RSceneNode::SetTransform(D3DXMATRIX& pOut, const D3DXVECTOR3& translation, const RQuaternion& rotation, const D3DXVECTOR3& scale)
@@ -612,30 +430,63 @@ RSceneManager* RSceneNode::GetAttachedSceneManager() const
 
 void RSceneNode::SetInheritTranslation(bool bInherit)
 {
-	m_bInheritTranslation = bInherit;
+	SetInheritFlag(RTransformStore::EIF_Translation, bInherit);
 }
 
 void RSceneNode::SetInheritRotation(bool bInherit)
 {
-	m_bInheritRotation = bInherit;
+	SetInheritFlag(RTransformStore::EIF_Rotation, bInherit);
 }
 
 void RSceneNode::SetInheritScale(bool bInherit)
 {
-	m_bInheritScale = bInherit;
+	SetInheritFlag(RTransformStore::EIF_Scale, bInherit);
 }
 
 bool RSceneNode::GetInheritTranslation() const
 {
-	return m_bInheritTranslation;
+	return (RTransformStore::GetInstance().GetInheritFlags(m_u32TransformHandle) & RTransformStore::EIF_Translation) != 0;
 }
 
 bool RSceneNode::GetInheritRotation() const
 {
-	return m_bInheritRotation;
+	return (RTransformStore::GetInstance().GetInheritFlags(m_u32TransformHandle) & RTransformStore::EIF_Rotation) != 0;
 }
 
 bool RSceneNode::GetInheritScale() const
 {
-	return m_bInheritScale;
+	return (RTransformStore::GetInstance().GetInheritFlags(m_u32TransformHandle) & RTransformStore::EIF_Scale) != 0;
+}
+
+void RSceneNode::SetInheritFlag(unsigned char u8Flag, bool bInherit)
+{
+	RTransformStore& transformStore = RTransformStore::GetInstance();
+	unsigned char u8InheritFlags = transformStore.GetInheritFlags(m_u32TransformHandle);
+
+	transformStore.SetInheritFlags(m_u32TransformHandle, bInherit ? (u8InheritFlags | u8Flag) : (u8InheritFlags & ~u8Flag));
+}
+void RSceneNode::SetSceneManager(RSceneManager* pSceneManager)
+{
+	// нڵĳĸڵһ£ͬʱֱӷ
+	if (m_pSceneManager == pSceneManager)
+	{
+		return;
+	}
+
+	if (m_pSceneManager)
+	{
+		m_pSceneManager->UnregisterNode(this);
+	}
+
+	m_pSceneManager = pSceneManager;
+
+	if (m_pSceneManager)
+	{
+		m_pSceneManager->RegisterNode(this);
+	}
+
+	for (RSceneNode* pChild : m_listChildren)
+	{
+		pChild->SetSceneManager(pSceneManager);
+	}
 }
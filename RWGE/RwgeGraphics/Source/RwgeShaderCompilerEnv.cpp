@@ -84,6 +84,8 @@ void RShaderCompilerEnvironment::SetShaderKey(const RShaderKey& key)
 	SetDefine("TEXTURE_COUNT",				key.GetTextureCountKey());
 	SetDefine("MATERIAL_FULLY_ROUGH",		key.GetFullyRoughKey());
 	SetDefine("LIGHT_TYPE",					key.GetLightTypeKey());
+	SetDefine("SHADER_INSTANCING",			key.GetShaderInstancingKey());
+	SetDefine("SHADER_DEPTH_ONLY",			key.GetShaderDepthOnlyKey());
 
 	const RTexturesToTextureUnitsMap* pTextureMap = RShaderKey::GetTexturesToTextureUnitsMap(key.GetTextureMapHashKey());
 	if (pTextureMap != nullptr)
@@ -0,0 +1,447 @@
+#include "RwgeStaticBatcher.h"
+
+#include <set>
+#include <float.h>
+#include <algorithm>
+#include <RwgeAssert.h>
+#include "RwgeMesh.h"
+#include "RwgeMaterial.h"
+#include "RwgeRenderUnit.h"
+#include "RwgeVertexStream.h"
+#include "RwgeIndexStream.h"
+#include "RwgeD3d9VertexDeclaration.h"
+#include "RwgeVertexDeclarationTemplate.h"
+
+using namespace std;
+
+// 10λÿһλ֮0
+static FORCE_INLINE unsigned int SpreadBits10(unsigned int u32Value)
+{
+	u32Value &= 0x3FF;
+	u32Value = (u32Value | (u32Value << 16)) & 0x030000FF;
+	u32Value = (u32Value | (u32Value << 8))  & 0x0300F00F;
+	u32Value = (u32Value | (u32Value << 4))  & 0x030C30C3;
+	u32Value = (u32Value | (u32Value << 2))  & 0x09249249;
+	return u32Value;
+}
+
+static FORCE_INLINE unsigned int QuantizeCoordinate(float f32Value, float f32Min, float f32Scale)
+{
+	float f32Quantized = (f32Value - f32Min) * f32Scale;
+	return f32Quantized <= 0.0f ? 0 : f32Quantized >= 1023.0f ? 1023 : static_cast<unsigned int>(f32Quantized);
+}
+
+RStaticBatcher::RStaticBatcher() :
+	m_u32MaxClusterVertexCount(4096),
+	m_f32MaxClusterRadius(64.0f)
+{
+
+}
+
+RStaticBatcher::~RStaticBatcher()
+{
+	Clear();
+}
+
+void RStaticBatcher::SetClusterLimits(unsigned int u32MaxVertexCount, float f32MaxRadius)
+{
+	RwgeAssert(u32MaxVertexCount > 0 && u32MaxVertexCount <= 65536);
+
+	m_u32MaxClusterVertexCount = u32MaxVertexCount;
+	m_f32MaxClusterRadius = f32MaxRadius;
+}
+
+void RStaticBatcher::Build(const vector<RModel*>& vecModels, RSceneNode* pClusterParent)
+{
+	RwgeAssert(pClusterParent);
+
+	// ================================ ʣڵ巽ʽ ================================
+	const unsigned int u32FirstNewBatch = m_vecBatches.size();
+	set<const void*> setSourceBuffers;
+
+	for (RModel* pModel : vecModels)
+	{
+		if (pModel->IsStaticBatched())
+		{
+			continue;
+		}
+
+		if (!CanBatchModel(pModel))
+		{
+			++m_Statistics.u32SkippedModelCount;
+			continue;
+		}
+
+		// ģʱTransformStore·ڴ棬˸任Ǳָ
+		const D3DXMATRIX worldTransform = pModel->GetWorldTransform();
+
+		for (RMesh* pMesh : pModel->GetMeshes())
+		{
+			for (RRenderUnit* pRenderUnit : pMesh->GetRenderUnits())
+			{
+				StaticBatch* pBatch = nullptr;
+				for (unsigned int u32Batch = u32FirstNewBatch; u32Batch < m_vecBatches.size(); ++u32Batch)
+				{
+					StaticBatch* pCandidate = m_vecBatches[u32Batch];
+					if (pCandidate->pMaterial == pMesh->GetMaterial() &&
+						pCandidate->pVertexDeclaration == pRenderUnit->GetVertexDeclaration() &&
+						pCandidate->occluderMode == pModel->GetOccluderMode())
+					{
+						pBatch = pCandidate;
+						break;
+					}
+				}
+
+				if (pBatch == nullptr)
+				{
+					pBatch = new StaticBatch();
+					pBatch->pMaterial = pMesh->GetMaterial();
+					pBatch->pVertexDeclaration = pRenderUnit->GetVertexDeclaration();
+					pBatch->occluderMode = pModel->GetOccluderMode();
+					pBatch->pIndexStream = nullptr;
+					m_vecBatches.push_back(pBatch);
+				}
+
+				RBounds worldBounds;
+				pRenderUnit->GetLocalBounds().Transform(worldBounds, worldTransform);
+
+				SourceUnit sourceUnit;
+				sourceUnit.pRenderUnit = pRenderUnit;
+				sourceUnit.worldTransform = worldTransform;
+				sourceUnit.worldCenter = worldBounds.center;
+				sourceUnit.f32WorldRadius = worldBounds.f32Radius;
+				sourceUnit.u32MortonCode = 0;
+				pBatch->vecSourceUnits.push_back(sourceUnit);
+
+				for (const VertexStream* pVertexStream : pRenderUnit->GetVertexStreams())
+				{
+					setSourceBuffers.insert(pVertexStream->pD3dVertexBuffer);
+				}
+				setSourceBuffers.insert(pRenderUnit->GetIndexStream()->pD3dIndexBuffer);
+
+				++m_Statistics.u32SourceRenderUnitCount;
+			}
+		}
+
+		pModel->m_bStaticBatched = true;
+		m_vecBatchedModels.push_back(pModel);
+		++m_Statistics.u32SourceModelCount;
+	}
+
+	setSourceBuffers.erase(nullptr);
+	m_Statistics.u32SourceBufferCount += setSourceBuffers.size();
+
+	// ================================ ϲÿεݲִ ================================
+	for (unsigned int u32Batch = u32FirstNewBatch; u32Batch < m_vecBatches.size(); ++u32Batch)
+	{
+		BuildClusters(*m_vecBatches[u32Batch], pClusterParent);
+	}
+
+	m_Statistics.u32BatchCount = m_vecBatches.size();
+}
+
+void RStaticBatcher::Clear()
+{
+	for (StaticBatch* pBatch : m_vecBatches)
+	{
+		for (RModel* pCluster : pBatch->vecClusters)
+		{
+			for (RMesh* pMesh : pCluster->GetMeshes())
+			{
+				for (RRenderUnit* pRenderUnit : pMesh->GetRenderUnits())
+				{
+					delete pRenderUnit;
+				}
+				delete pMesh;
+			}
+
+			// ʱӸڵ볡Ƴ
+			delete pCluster;
+		}
+
+		for (VertexStream* pVertexStream : pBatch->vecVertexStreams)
+		{
+			delete pVertexStream;
+		}
+
+		RGpuMemoryManager& gpuMemoryManager = RGpuMemoryManager::GetInstance();
+		for (GpuAllocation& allocation : pBatch->vecVertexAllocations)
+		{
+			gpuMemoryManager.Free(allocation);
+		}
+		gpuMemoryManager.Free(pBatch->indexAllocation);
+
+		delete pBatch->pIndexStream;
+		delete pBatch;
+	}
+	m_vecBatches.clear();
+
+	for (RModel* pModel : m_vecBatchedModels)
+	{
+		pModel->m_bStaticBatched = false;
+	}
+	m_vecBatchedModels.clear();
+
+	m_Statistics = StaticBatchStatistics();
+}
+
+bool RStaticBatcher::CanBatchModel(RModel* pModel) const
+{
+	if (pModel->GetMeshes().empty())
+	{
+		return false;
+	}
+
+	for (RMesh* pMesh : pModel->GetMeshes())
+	{
+		if (pMesh->GetMaterial() == nullptr || pMesh->GetMaterial()->GetBlendMode() == EBM_Translucent)
+		{
+			return false;
+		}
+
+		for (RRenderUnit* pRenderUnit : pMesh->GetRenderUnits())
+		{
+			const RD3d9VertexDeclaration* pVertexDeclaration = pRenderUnit->GetVertexDeclaration();
+			const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+			const vector<VertexStream*>& vecVertexStreams = pRenderUnit->GetVertexStreams();
+
+			if (pRenderUnit->GetPrimitiveType() != D3DPT_TRIANGLELIST ||
+				pRenderUnit->GetBaseVertexIndex() != 0 || pRenderUnit->GetStartIndex() != 0 ||
+				pIndexStream == nullptr || pIndexStream->aryIndices == nullptr ||
+				pIndexStream->u32IndexCount < pRenderUnit->GetPrimitveCount() * 3 ||
+				pVertexDeclaration == nullptr || !pVertexDeclaration->HasPosition() ||
+				vecVertexStreams.empty() || vecVertexStreams.size() != pVertexDeclaration->GetStreamCount())
+			{
+				return false;
+			}
+
+			for (const VertexStream* pVertexStream : vecVertexStreams)
+			{
+				if (pVertexStream->aryVertices == nullptr || pVertexStream->u32VertexCount != vecVertexStreams[0]->u32VertexCount)
+				{
+					return false;
+				}
+			}
+
+			if (GetSourceVertexCount(pRenderUnit) > m_u32MaxClusterVertexCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void RStaticBatcher::BuildClusters(StaticBatch& batch, RSceneNode* pClusterParent)
+{
+	// ================================ ΧĵMorton ================================
+	D3DXVECTOR3 minCenter(FLT_MAX, FLT_MAX, FLT_MAX);
+	D3DXVECTOR3 maxCenter(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	unsigned int u32TotalVertexCount = 0;
+	unsigned int u32TotalIndexCount = 0;
+
+	for (const SourceUnit& sourceUnit : batch.vecSourceUnits)
+	{
+		D3DXVec3Minimize(&minCenter, &minCenter, &sourceUnit.worldCenter);
+		D3DXVec3Maximize(&maxCenter, &maxCenter, &sourceUnit.worldCenter);
+		u32TotalVertexCount += GetSourceVertexCount(sourceUnit.pRenderUnit);
+		u32TotalIndexCount += sourceUnit.pRenderUnit->GetPrimitveCount() * 3;
+	}
+
+	D3DXVECTOR3 size = maxCenter - minCenter;
+	float f32MaxSize = max(max(size.x, size.y), max(size.z, FLT_MIN));
+	float f32Scale = 1023.0f / f32MaxSize;
+
+	for (SourceUnit& sourceUnit : batch.vecSourceUnits)
+	{
+		sourceUnit.u32MortonCode =
+			SpreadBits10(QuantizeCoordinate(sourceUnit.worldCenter.x, minCenter.x, f32Scale)) |
+			(SpreadBits10(QuantizeCoordinate(sourceUnit.worldCenter.y, minCenter.y, f32Scale)) << 1) |
+			(SpreadBits10(QuantizeCoordinate(sourceUnit.worldCenter.z, minCenter.z, f32Scale)) << 2);
+	}
+
+	// ȶ֤ͬһλϵȾԪ˳򣬺˳һһӦ
+	stable_sort(batch.vecSourceUnits.begin(), batch.vecSourceUnits.end(), [](const SourceUnit& left, const SourceUnit& right)
+	{
+		return left.u32MortonCode < right.u32MortonCode;
+	});
+
+	// ================================ ִزϲ ================================
+	const unsigned int u32StreamCount = batch.pVertexDeclaration->GetStreamCount();
+	batch.vecStreamData.resize(u32StreamCount);
+	for (unsigned int u32Stream = 0; u32Stream < u32StreamCount; ++u32Stream)
+	{
+		batch.vecStreamData[u32Stream].reserve(u32TotalVertexCount * batch.vecSourceUnits[0].pRenderUnit->GetVertexStreams()[u32Stream]->u8VertexSize);
+	}
+	batch.vecIndices.reserve(u32TotalIndexCount);
+
+	struct ClusterRange
+	{
+		unsigned int	u32BaseVertexIndex;
+		unsigned int	u32VertexCount;
+		unsigned int	u32StartIndex;
+		unsigned int	u32IndexCount;
+	};
+	vector<ClusterRange> vecClusterRanges;
+
+	unsigned int u32VertexCount = 0;
+	for (unsigned int u32Unit = 0; u32Unit < batch.vecSourceUnits.size();)
+	{
+		ClusterRange clusterRange = { u32VertexCount, 0, static_cast<unsigned int>(batch.vecIndices.size()), 0 };
+
+		// ðΧAABBƴصİΧ뾶
+		D3DXVECTOR3 minPoint(FLT_MAX, FLT_MAX, FLT_MAX);
+		D3DXVECTOR3 maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		for (; u32Unit < batch.vecSourceUnits.size(); ++u32Unit)
+		{
+			const SourceUnit& sourceUnit = batch.vecSourceUnits[u32Unit];
+			unsigned int u32UnitVertexCount = GetSourceVertexCount(sourceUnit.pRenderUnit);
+
+			D3DXVECTOR3 radius(sourceUnit.f32WorldRadius, sourceUnit.f32WorldRadius, sourceUnit.f32WorldRadius);
+			D3DXVECTOR3 unitMin = sourceUnit.worldCenter - radius;
+			D3DXVECTOR3 unitMax = sourceUnit.worldCenter + radius;
+			D3DXVec3Minimize(&unitMin, &unitMin, &minPoint);
+			D3DXVec3Maximize(&unitMax, &unitMax, &maxPoint);
+			D3DXVECTOR3 extents = (unitMax - unitMin) * 0.5f;
+
+			if (clusterRange.u32VertexCount > 0 &&
+				(clusterRange.u32VertexCount + u32UnitVertexCount > m_u32MaxClusterVertexCount || D3DXVec3Length(&extents) > m_f32MaxClusterRadius))
+			{
+				break;
+			}
+
+			AppendSourceUnit(batch, sourceUnit, clusterRange.u32BaseVertexIndex);
+
+			minPoint = unitMin;
+			maxPoint = unitMax;
+			clusterRange.u32VertexCount += u32UnitVertexCount;
+		}
+
+		clusterRange.u32IndexCount = batch.vecIndices.size() - clusterRange.u32StartIndex;
+		u32VertexCount += clusterRange.u32VertexCount;
+		vecClusterRanges.push_back(clusterRange);
+	}
+
+	// ================================ Ķ뻺 ================================
+	RGpuMemoryManager& gpuMemoryManager = RGpuMemoryManager::GetInstance();
+
+	batch.vecVertexAllocations.resize(u32StreamCount);
+	for (unsigned int u32Stream = 0; u32Stream < u32StreamCount; ++u32Stream)
+	{
+		unsigned char u8VertexSize = batch.vecSourceUnits[0].pRenderUnit->GetVertexStreams()[u32Stream]->u8VertexSize;
+		batch.vecVertexStreams.push_back(new VertexStream(u8VertexSize, u32VertexCount, batch.vecStreamData[u32Stream].data()));
+		gpuMemoryManager.BindVertexStream(batch.vecVertexStreams.back(), batch.vecVertexAllocations[u32Stream]);
+	}
+
+	batch.pIndexStream = new IndexStream(batch.vecIndices.size(), batch.vecIndices.data());
+	gpuMemoryManager.BindIndexStream(batch.pIndexStream, batch.indexAllocation);
+
+	m_Statistics.u32BufferCount += u32StreamCount + 1;
+
+	// ================================ ÿһģ ================================
+	for (const ClusterRange& clusterRange : vecClusterRanges)
+	{
+		RRenderUnit* pRenderUnit = new RRenderUnit();
+		pRenderUnit->SetVertexDeclaration(const_cast<RD3d9VertexDeclaration*>(batch.pVertexDeclaration));
+		pRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
+		for (VertexStream* pVertexStream : batch.vecVertexStreams)
+		{
+			pRenderUnit->AddVertexStream(pVertexStream);
+		}
+		pRenderUnit->SetIndexStream(batch.pIndexStream);
+		pRenderUnit->SetSubRange(clusterRange.u32BaseVertexIndex, clusterRange.u32VertexCount, clusterRange.u32StartIndex, clusterRange.u32IndexCount / 3);
+
+		RMesh* pMesh = new RMesh();
+		pMesh->SetMaterial(batch.pMaterial);
+		pMesh->AddRenderUnit(pRenderUnit);
+
+		RModel* pCluster = new RModel();
+		pCluster->SetOccluderMode(batch.occluderMode);
+		pCluster->AddMesh(pMesh);
+
+		pClusterParent->AttachChild(pCluster);
+		batch.vecClusters.push_back(pCluster);
+	}
+
+	m_Statistics.u32ClusterCount += vecClusterRanges.size();
+}
+
+void RStaticBatcher::AppendSourceUnit(StaticBatch& batch, const SourceUnit& sourceUnit, unsigned int u32ClusterBaseVertex)
+{
+	const RRenderUnit* pRenderUnit = sourceUnit.pRenderUnit;
+	const RVertexDeclarationTemplate& declarationTemplate = batch.pVertexDeclaration->GetTemplate();
+	const unsigned int u32VertexCount = GetSourceVertexCount(pRenderUnit);
+	const unsigned int u32FirstVertex = batch.vecStreamData[0].size() / pRenderUnit->GetVertexStreams()[0]->u8VertexSize;
+
+	// Ҫʹ任תþ任Ա֤ǾʱȻ洹ֱ
+	const D3DXMATRIX& worldTransform = sourceUnit.worldTransform;
+	D3DXMATRIX normalTransform;
+	D3DXMatrixInverse(&normalTransform, nullptr, &worldTransform);
+	D3DXMatrixTranspose(&normalTransform, &normalTransform);
+
+	// ================================ Ʋ任 ================================
+	for (unsigned int u32Stream = 0; u32Stream < batch.vecStreamData.size(); ++u32Stream)
+	{
+		const VertexStream* pVertexStream = pRenderUnit->GetVertexStreams()[u32Stream];
+		const unsigned char* pSource = reinterpret_cast<const unsigned char*>(pVertexStream->aryVertices);
+		vector<unsigned char>& vecStreamData = batch.vecStreamData[u32Stream];
+
+		const unsigned int u32DataOffset = vecStreamData.size();
+		vecStreamData.insert(vecStreamData.end(), pSource, pSource + u32VertexCount * pVertexStream->u8VertexSize);
+
+		unsigned short u16ElementOffset = 0;
+		for (const VertexElement& element : declarationTemplate.GetVertexElementListOfStream(u32Stream))
+		{
+			bool bPosition	= element.u8Usage == D3DDECLUSAGE_POSITION;
+			bool bNormal	= element.u8Usage == D3DDECLUSAGE_NORMAL || element.u8Usage == D3DDECLUSAGE_TANGENT || element.u8Usage == D3DDECLUSAGE_BINORMAL;
+
+			if (element.u8Type == D3DDECLTYPE_FLOAT3 && (bPosition || bNormal))
+			{
+				unsigned char* pElement = vecStreamData.data() + u32DataOffset + u16ElementOffset;
+
+				for (unsigned int u32Vertex = 0; u32Vertex < u32VertexCount; ++u32Vertex, pElement += pVertexStream->u8VertexSize)
+				{
+					D3DXVECTOR3 value;
+					memcpy(&value, pElement, sizeof(D3DXVECTOR3));
+
+					if (bPosition)
+					{
+						D3DXVec3TransformCoord(&value, &value, &worldTransform);
+					}
+					else
+					{
+						D3DXVec3TransformNormal(&value, &value, &normalTransform);
+						D3DXVec3Normalize(&value, &value);
+					}
+
+					memcpy(pElement, &value, sizeof(D3DXVECTOR3));
+				}
+			}
+
+			u16ElementOffset += element.GetElementSize();
+		}
+	}
+
+	// ================================ ׷ ================================
+	// Դ32λģصĶ65536ϲ16λ
+	const IndexStream* pIndexStream = pRenderUnit->GetIndexStream();
+	const unsigned int u32IndexCount = pRenderUnit->GetPrimitveCount() * 3;
+	const unsigned int u32IndexOffset = u32FirstVertex - u32ClusterBaseVertex;
+
+	// 任ᷭתεĻƷ򣬽ÿεʹ汣ֲ
+	const bool bFlipWinding = D3DXMatrixDeterminant(&worldTransform) < 0.0f;
+
+	for (unsigned int u32Index = 0; u32Index < u32IndexCount; u32Index += 3)
+	{
+		batch.vecIndices.push_back(static_cast<unsigned short>(pIndexStream->GetIndex(u32Index) + u32IndexOffset));
+		batch.vecIndices.push_back(static_cast<unsigned short>(pIndexStream->GetIndex(u32Index + (bFlipWinding ? 2 : 1)) + u32IndexOffset));
+		batch.vecIndices.push_back(static_cast<unsigned short>(pIndexStream->GetIndex(u32Index + (bFlipWinding ? 1 : 2)) + u32IndexOffset));
+	}
+}
+
+unsigned int RStaticBatcher::GetSourceVertexCount(const RRenderUnit* pRenderUnit)
+{
+	return pRenderUnit->GetVertexStreams()[0]->u32VertexCount;
+}
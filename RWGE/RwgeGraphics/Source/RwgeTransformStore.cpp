@@ -0,0 +1,632 @@
+#include "RwgeTransformStore.h"
+
+#include "RwgeSceneNode.h"
+#include <RwgeAssert.h>
+#include <RwgeMath.h>
+#include <RwgeThreadPool.h>
+
+using namespace std;
+using namespace RwgeMath;
+
+const unsigned int RTransformStore::u32InvalidHandle;
+
+RTransformStore::RTransformStore() :
+	m_u32TransformCount		(0),
+	m_u32DirtyCount			(0),
+	m_u32ChangeEpoch		(1),
+	m_u32LastUpdatedCount	(0),
+	m_u32ParallelSplitDepth	(0),
+	m_bOrderOutOfDate		(false)
+{
+
+}
+
+RTransformStore::~RTransformStore()
+{
+
+}
+
+unsigned int RTransformStore::CreateTransform()
+{
+	unsigned int u32Handle;
+	if (m_vecFreeHandles.empty())
+	{
+		u32Handle = static_cast<unsigned int>(m_vecHandleToIndex.size());
+		m_vecHandleToIndex.push_back(u32InvalidHandle);
+		m_vecParentHandle.push_back(u32InvalidHandle);
+	}
+	else
+	{
+		u32Handle = m_vecFreeHandles.back();
+		m_vecFreeHandles.pop_back();
+	}
+
+	// µı任׷ӵĩβûиڵ㣬Բƻ
+	unsigned int u32Index = static_cast<unsigned int>(m_vecIndexToHandle.size());
+
+	m_vecLocalPosition.push_back(D3DXVECTOR3(0.0f, 0.0f, 0.0f));
+	m_vecLocalOrientation.push_back(RQuaternion(0.0f, 0.0f, 0.0f, 1.0f));
+	m_vecLocalScale.push_back(D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+	m_vecWorldPosition.push_back(D3DXVECTOR3(0.0f, 0.0f, 0.0f));
+	m_vecWorldOrientation.push_back(RQuaternion(0.0f, 0.0f, 0.0f, 1.0f));
+	m_vecWorldScale.push_back(D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+	m_vecWorldTransform.push_back(D3DXMATRIX());
+	D3DXMatrixIdentity(&m_vecWorldTransform.back());
+	m_vecWorldRevision.push_back(0);
+	m_vecFreshStamp.push_back(0);
+	m_vecParentIndex.push_back(u32InvalidHandle);
+	m_vecSubtreeEnd.push_back(u32Index + 1);
+	m_vecInheritFlags.push_back(EIF_All);
+	m_vecIndexToHandle.push_back(u32Handle);
+	if ((u32Index & 31) == 0)
+	{
+		m_vecDirtyBits.push_back(0);
+	}
+
+	m_vecHandleToIndex[u32Handle] = u32Index;
+	m_vecParentHandle[u32Handle] = u32InvalidHandle;
+
+	// ½ڵΪ0ĸڵ㣬ڲģʽڴнڵ㣬׷ӵнڵĩβȻ򣬲Ҫ»
+	if (m_u32ParallelSplitDepth > 0)
+	{
+		m_vecSerialNodes.push_back(u32Index);
+		m_vecSerialNodeChanged.push_back(0);
+	}
+
+	++m_u32TransformCount;
+
+	return u32Handle;
+}
+
+void RTransformStore::ReleaseTransform(unsigned int u32Handle)
+{
+	RwgeAssert(m_vecHandleToIndex[u32Handle] != u32InvalidHandle);
+
+	// еλñһţӽڵĸڵǰȻԷʵ
+	m_vecHandleToIndex[u32Handle] = u32InvalidHandle;
+	m_vecParentHandle[u32Handle] = u32InvalidHandle;
+	m_vecReleasedHandles.push_back(u32Handle);
+
+	--m_u32TransformCount;
+	m_bOrderOutOfDate = true;
+}
+
+void RTransformStore::SetParent(unsigned int u32Handle, unsigned int u32ParentHandle)
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+
+	m_vecParentHandle[u32Handle] = u32ParentHandle;
+	m_vecParentIndex[u32Index] = u32ParentHandle == u32InvalidHandle ? u32InvalidHandle : m_vecHandleToIndex[u32ParentHandle];
+
+	m_bOrderOutOfDate = true;
+	MarkDirty(u32Index);
+}
+
+unsigned int RTransformStore::GetParent(unsigned int u32Handle) const
+{
+	return m_vecParentHandle[u32Handle];
+}
+
+void RTransformStore::SetLocalPosition(unsigned int u32Handle, const D3DXVECTOR3& position)
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	m_vecLocalPosition[u32Index] = position;
+	MarkDirty(u32Index);
+}
+
+void RTransformStore::SetLocalOrientation(unsigned int u32Handle, const RQuaternion& orientation)
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	m_vecLocalOrientation[u32Index] = orientation;
+	MarkDirty(u32Index);
+}
+
+void RTransformStore::SetLocalScale(unsigned int u32Handle, const D3DXVECTOR3& scale)
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	m_vecLocalScale[u32Index] = scale;
+	MarkDirty(u32Index);
+}
+
+void RTransformStore::SetInheritFlags(unsigned int u32Handle, unsigned char u8InheritFlags)
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	m_vecInheritFlags[u32Index] = u8InheritFlags;
+	MarkDirty(u32Index);
+}
+
+const D3DXVECTOR3& RTransformStore::GetWorldPosition(unsigned int u32Handle) const
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	UpdateWorldOnDemand(u32Index);
+
+	return m_vecWorldPosition[u32Index];
+}
+
+const RQuaternion& RTransformStore::GetWorldOrientation(unsigned int u32Handle) const
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	UpdateWorldOnDemand(u32Index);
+
+	return m_vecWorldOrientation[u32Index];
+}
+
+const D3DXVECTOR3& RTransformStore::GetWorldScale(unsigned int u32Handle) const
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	UpdateWorldOnDemand(u32Index);
+
+	return m_vecWorldScale[u32Index];
+}
+
+const D3DXMATRIX& RTransformStore::GetWorldTransform(unsigned int u32Handle) const
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	UpdateWorldOnDemand(u32Index);
+
+	return m_vecWorldTransform[u32Index];
+}
+
+unsigned int RTransformStore::GetWorldRevision(unsigned int u32Handle) const
+{
+	unsigned int u32Index = m_vecHandleToIndex[u32Handle];
+	UpdateWorldOnDemand(u32Index);
+
+	return m_vecWorldRevision[u32Index];
+}
+
+void RTransformStore::Update()
+{
+	if (m_bOrderOutOfDate)
+	{
+		RebuildOrder();
+	}
+
+	m_u32LastUpdatedCount = 0;
+	m_vecUpdatedRanges.clear();
+
+	if (m_u32DirtyCount == 0)
+	{
+		return;
+	}
+
+	if (m_u32ParallelSplitDepth == 0)
+	{
+		m_u32LastUpdatedCount = UpdateDirtyRange(0, static_cast<unsigned int>(m_vecIndexToHandle.size()), m_vecUpdatedRanges);
+	}
+	else
+	{
+		UpdateParallel();
+	}
+
+	RwgeZeroMemory(&m_vecDirtyBits[0], m_vecDirtyBits.size() * sizeof(unsigned int));
+	m_u32DirtyCount = 0;
+
+	// һUpdateḲǱεĽҪȡԼĵĽڵ
+	for (auto pListener : m_listUpdateListeners)
+	{
+		pListener->OnTransformsUpdated(*this);
+	}
+}
+
+void RTransformStore::RegUpdateListener(RTransformUpdateListener* pListener)
+{
+	m_listUpdateListeners.push_back(pListener);
+}
+
+void RTransformStore::DeRegUpdateListener(RTransformUpdateListener* pListener)
+{
+	m_listUpdateListeners.remove(pListener);
+}
+
+void RTransformStore::SetParallelSplitDepth(unsigned int u32Depth)
+{
+	if (m_u32ParallelSplitDepth != u32Depth)
+	{
+		m_u32ParallelSplitDepth = u32Depth;
+
+		// ֻҪ»˳
+		RebuildParallelTasks();
+	}
+}
+
+unsigned int RTransformStore::UpdateDirtyRange(unsigned int u32Begin, unsigned int u32End, std::vector<UpdatedRange>& vecRanges) const
+{
+	unsigned int u32UpdatedCount = 0;
+	unsigned int u32Index = u32Begin;
+
+	while (u32Index < u32End)
+	{
+		unsigned int u32Bits = m_vecDirtyBits[u32Index >> 5] >> (u32Index & 31);
+
+		// ǰ32λʣĽڵ㶼ûбǣֱһ
+		if (u32Bits == 0)
+		{
+			u32Index = (u32Index | 31) + 1;
+			continue;
+		}
+
+		while ((u32Bits & 1) == 0)
+		{
+			u32Bits >>= 1;
+			++u32Index;
+		}
+
+		// ͬһ32λпܰĽڵ
+		if (u32Index >= u32End)
+		{
+			break;
+		}
+
+		// ǽڵģڵӽڵ㱻
+		unsigned int u32SubtreeEnd = m_vecSubtreeEnd[u32Index];
+		for (unsigned int u32Node = u32Index; u32Node < u32SubtreeEnd; ++u32Node)
+		{
+			ComputeWorld(u32Node);
+		}
+
+		UpdatedRange range = { u32Index, u32SubtreeEnd };
+		vecRanges.push_back(range);
+
+		u32UpdatedCount += u32SubtreeEnd - u32Index;
+		u32Index = u32SubtreeEnd;
+	}
+
+	return u32UpdatedCount;
+}
+
+void RTransformStore::UpdateParallel()
+{
+	// и·ָϵĽڵ㣬ڵ㱻¼ʱӽڵҲҪ¼
+	for (unsigned int u32Index : m_vecSerialNodes)
+	{
+		unsigned int u32ParentIndex = m_vecParentIndex[u32Index];
+		bool bChanged = IsDirty(u32Index) || (u32ParentIndex != u32InvalidHandle && m_vecSerialNodeChanged[u32ParentIndex]);
+
+		m_vecSerialNodeChanged[u32Index] = bChanged;
+		if (bChanged)
+		{
+			ComputeWorld(u32Index);
+			++m_u32LastUpdatedCount;
+
+			// нڵ㰴Уʱϲһ
+			if (!m_vecUpdatedRanges.empty() && m_vecUpdatedRanges.back().u32End == u32Index)
+			{
+				++m_vecUpdatedRanges.back().u32End;
+			}
+			else
+			{
+				UpdatedRange range = { u32Index, u32Index + 1 };
+				m_vecUpdatedRanges.push_back(range);
+			}
+		}
+	}
+
+	// ÿΪһи£ÿѸµ¼ڸԵУٺϲ
+	m_vecTaskUpdatedCount.assign(m_vecTaskRoots.size(), 0);
+	m_vecTaskUpdatedRanges.resize(m_vecTaskRoots.size());
+
+	RThreadPool::GetInstance().ParallelFor(static_cast<unsigned int>(m_vecTaskRoots.size()), [this](unsigned int u32Task)
+	{
+		unsigned int u32Root = m_vecTaskRoots[u32Task];
+		unsigned int u32SubtreeEnd = m_vecSubtreeEnd[u32Root];
+		unsigned int u32ParentIndex = m_vecParentIndex[u32Root];
+		std::vector<UpdatedRange>& vecTaskRanges = m_vecTaskUpdatedRanges[u32Task];
+		vecTaskRanges.clear();
+
+		// ڵ㷢˸ı䣬Ҫ¼
+		if (u32ParentIndex != u32InvalidHandle && m_vecSerialNodeChanged[u32ParentIndex])
+		{
+			for (unsigned int u32Node = u32Root; u32Node < u32SubtreeEnd; ++u32Node)
+			{
+				ComputeWorld(u32Node);
+			}
+
+			UpdatedRange range = { u32Root, u32SubtreeEnd };
+			vecTaskRanges.push_back(range);
+			m_vecTaskUpdatedCount[u32Task] = u32SubtreeEnd - u32Root;
+		}
+		else
+		{
+			m_vecTaskUpdatedCount[u32Task] = UpdateDirtyRange(u32Root, u32SubtreeEnd, vecTaskRanges);
+		}
+	});
+
+	for (unsigned int u32Task = 0; u32Task < m_vecTaskRoots.size(); ++u32Task)
+	{
+		m_u32LastUpdatedCount += m_vecTaskUpdatedCount[u32Task];
+		m_vecUpdatedRanges.insert(m_vecUpdatedRanges.end(), m_vecTaskUpdatedRanges[u32Task].begin(), m_vecTaskUpdatedRanges[u32Task].end());
+	}
+}
+
+void RTransformStore::RebuildParallelTasks()
+{
+	m_vecSerialNodes.clear();
+	m_vecTaskRoots.clear();
+
+	if (m_u32ParallelSplitDepth == 0)
+	{
+		return;
+	}
+
+	const unsigned int u32Count = static_cast<unsigned int>(m_vecIndexToHandle.size());
+	m_vecSerialNodeChanged.assign(u32Count, 0);
+
+	// 鰴УȵڷָȵĽڵ
+	vector<unsigned int> vecDepth(u32Count, 0);
+	unsigned int u32Index = 0;
+
+	while (u32Index < u32Count)
+	{
+		unsigned int u32ParentIndex = m_vecParentIndex[u32Index];
+		vecDepth[u32Index] = u32ParentIndex == u32InvalidHandle ? 0 : vecDepth[u32ParentIndex] + 1;
+
+		if (vecDepth[u32Index] < m_u32ParallelSplitDepth)
+		{
+			m_vecSerialNodes.push_back(u32Index);
+			++u32Index;
+		}
+		else
+		{
+			m_vecTaskRoots.push_back(u32Index);
+			u32Index = m_vecSubtreeEnd[u32Index];
+		}
+	}
+}
+
+void RTransformStore::RebuildOrder()
+{
+	const unsigned int u32HandleCount = static_cast<unsigned int>(m_vecHandleToIndex.size());
+
+	// ڵѾͷŵĽڵΪڵ㣬任Ҫ¼
+	for (unsigned int u32Handle = 0; u32Handle < u32HandleCount; ++u32Handle)
+	{
+		unsigned int u32ParentHandle = m_vecParentHandle[u32Handle];
+		if (m_vecHandleToIndex[u32Handle] != u32InvalidHandle &&
+			u32ParentHandle != u32InvalidHandle &&
+			m_vecHandleToIndex[u32ParentHandle] == u32InvalidHandle)
+		{
+			m_vecParentHandle[u32Handle] = u32InvalidHandle;
+			MarkDirty(m_vecHandleToIndex[u32Handle]);
+		}
+	}
+
+	// ڵͳӽڵ㣬ÿڵӽڵ
+	vector<unsigned int> vecChildStart(u32HandleCount + 1, 0);
+	for (unsigned int u32Handle = 0; u32Handle < u32HandleCount; ++u32Handle)
+	{
+		if (m_vecHandleToIndex[u32Handle] != u32InvalidHandle && m_vecParentHandle[u32Handle] != u32InvalidHandle)
+		{
+			++vecChildStart[m_vecParentHandle[u32Handle] + 1];
+		}
+	}
+	for (unsigned int u32Handle = 0; u32Handle < u32HandleCount; ++u32Handle)
+	{
+		vecChildStart[u32Handle + 1] += vecChildStart[u32Handle];
+	}
+
+	// ԭе˳ӽڵ㣬ֵ֤ܽڵ֮˳ź󱣳ֲ
+	vector<unsigned int> vecChildren(vecChildStart[u32HandleCount]);
+	vector<unsigned int> vecCursor(vecChildStart.begin(), vecChildStart.end() - 1);
+	for (unsigned int u32Handle : m_vecIndexToHandle)
+	{
+		if (m_vecHandleToIndex[u32Handle] != u32InvalidHandle && m_vecParentHandle[u32Handle] != u32InvalidHandle)
+		{
+			vecChildren[vecCursor[m_vecParentHandle[u32Handle]]++] = u32Handle;
+		}
+	}
+
+	// иڵõµ
+	vector<unsigned int> vecNewToOld;
+	vector<unsigned int> vecNewToHandle;
+	vector<unsigned int> vecStack;
+	vecNewToOld.reserve(m_u32TransformCount);
+	vecNewToHandle.reserve(m_u32TransformCount);
+
+	for (unsigned int u32Root : m_vecIndexToHandle)
+	{
+		if (m_vecHandleToIndex[u32Root] == u32InvalidHandle || m_vecParentHandle[u32Root] != u32InvalidHandle)
+		{
+			continue;
+		}
+
+		vecStack.push_back(u32Root);
+		while (!vecStack.empty())
+		{
+			unsigned int u32Handle = vecStack.back();
+			vecStack.pop_back();
+
+			vecNewToOld.push_back(m_vecHandleToIndex[u32Handle]);
+			vecNewToHandle.push_back(u32Handle);
+
+			// ѹջʹһӽڵȳջ
+			for (unsigned int u32Child = vecChildStart[u32Handle + 1]; u32Child > vecChildStart[u32Handle]; --u32Child)
+			{
+				vecStack.push_back(vecChildren[u32Child - 1]);
+			}
+		}
+	}
+
+	RwgeAssert(vecNewToOld.size() == m_u32TransformCount);
+
+	// ǣͷŽڵı֮
+	vector<unsigned int> vecDirtyBits((m_u32TransformCount + 31) >> 5, 0);
+	m_u32DirtyCount = 0;
+	for (unsigned int u32Index = 0; u32Index < m_u32TransformCount; ++u32Index)
+	{
+		if (IsDirty(vecNewToOld[u32Index]))
+		{
+			vecDirtyBits[u32Index >> 5] |= 1u << (u32Index & 31);
+			++m_u32DirtyCount;
+		}
+	}
+	m_vecDirtyBits.swap(vecDirtyBits);
+
+	Permute(m_vecLocalPosition,		vecNewToOld);
+	Permute(m_vecLocalOrientation,	vecNewToOld);
+	Permute(m_vecLocalScale,		vecNewToOld);
+	Permute(m_vecWorldPosition,		vecNewToOld);
+	Permute(m_vecWorldOrientation,	vecNewToOld);
+	Permute(m_vecWorldScale,		vecNewToOld);
+	Permute(m_vecWorldTransform,	vecNewToOld);
+	Permute(m_vecWorldRevision,		vecNewToOld);
+	Permute(m_vecInheritFlags,		vecNewToOld);
+	m_vecFreshStamp.assign(m_u32TransformCount, 0);
+	m_vecIndexToHandle.swap(vecNewToHandle);
+
+	for (unsigned int u32Index = 0; u32Index < m_u32TransformCount; ++u32Index)
+	{
+		m_vecHandleToIndex[m_vecIndexToHandle[u32Index]] = u32Index;
+	}
+
+	// иڵһӽڵ֮ǰʱ԰Ľλϴ
+	m_vecParentIndex.resize(m_u32TransformCount);
+	m_vecSubtreeEnd.resize(m_u32TransformCount);
+	for (unsigned int u32Index = 0; u32Index < m_u32TransformCount; ++u32Index)
+	{
+		unsigned int u32ParentHandle = m_vecParentHandle[m_vecIndexToHandle[u32Index]];
+		m_vecParentIndex[u32Index] = u32ParentHandle == u32InvalidHandle ? u32InvalidHandle : m_vecHandleToIndex[u32ParentHandle];
+		m_vecSubtreeEnd[u32Index] = u32Index + 1;
+	}
+	for (unsigned int u32Index = m_u32TransformCount; u32Index > 0; --u32Index)
+	{
+		unsigned int u32ParentIndex = m_vecParentIndex[u32Index - 1];
+		if (u32ParentIndex != u32InvalidHandle && m_vecSubtreeEnd[u32ParentIndex] < m_vecSubtreeEnd[u32Index - 1])
+		{
+			m_vecSubtreeEnd[u32ParentIndex] = m_vecSubtreeEnd[u32Index - 1];
+		}
+	}
+
+	// ɺͷŵľſԱ
+	m_vecFreeHandles.insert(m_vecFreeHandles.end(), m_vecReleasedHandles.begin(), m_vecReleasedHandles.end());
+	m_vecReleasedHandles.clear();
+
+	m_bOrderOutOfDate = false;
+
+	RebuildParallelTasks();
+}
+
+void RTransformStore::UpdateWorldOnDemand(unsigned int u32Index) const
+{
+	if (m_u32DirtyCount == 0 || m_vecFreshStamp[u32Index] == m_u32ChangeEpoch)
+	{
+		return;
+	}
+
+	// ϲңֱڵڵǰԪѾ¹Ľڵ
+	m_vecPathScratch.clear();
+	unsigned int u32RecomputeCount = 0;
+	unsigned int u32Node = u32Index;
+
+	for (; u32Node != u32InvalidHandle; u32Node = m_vecParentIndex[u32Node])
+	{
+		if (m_vecFreshStamp[u32Node] == m_u32ChangeEpoch)
+		{
+			break;
+		}
+
+		m_vecPathScratch.push_back(u32Node);
+
+		// ¼ڵ㣬µ·Ҫ¼
+		if (IsDirty(u32Node))
+		{
+			u32RecomputeCount = static_cast<unsigned int>(m_vecPathScratch.size());
+		}
+	}
+
+	// ͣѸµĽڵʱܸձ¹·ϵĽڵȻǻľֵģ·Ҫ¼
+	if (u32Node != u32InvalidHandle)
+	{
+		u32RecomputeCount = static_cast<unsigned int>(m_vecPathScratch.size());
+	}
+
+	// Զ¸·ϵĽڵ
+	for (unsigned int u32Path = u32RecomputeCount; u32Path > 0; --u32Path)
+	{
+		ComputeWorld(m_vecPathScratch[u32Path - 1]);
+	}
+
+	for (unsigned int u32PathNode : m_vecPathScratch)
+	{
+		m_vecFreshStamp[u32PathNode] = m_u32ChangeEpoch;
+	}
+}
+
+void RTransformStore::ComputeWorld(unsigned int u32Index) const
+{
+	unsigned int u32ParentIndex = m_vecParentIndex[u32Index];
+
+	if (u32ParentIndex != u32InvalidHandle)
+	{
+		const RQuaternion& parentWorldOrientation = m_vecWorldOrientation[u32ParentIndex];
+		const D3DXVECTOR3& parentWorldScale = m_vecWorldScale[u32ParentIndex];
+		unsigned char u8InheritFlags = m_vecInheritFlags[u32Index];
+
+		// ̳иڵλ
+		if (u8InheritFlags & EIF_Translation)
+		{
+			m_vecWorldPosition[u32Index] = parentWorldOrientation.RotateVector(parentWorldScale * m_vecLocalPosition[u32Index]) + m_vecWorldPosition[u32ParentIndex];
+		}
+		else
+		{
+			m_vecWorldPosition[u32Index] = m_vecLocalPosition[u32Index];
+		}
+
+		// ̳иڵת
+		if (u8InheritFlags & EIF_Rotation)
+		{
+			m_vecWorldOrientation[u32Index] = parentWorldOrientation * m_vecLocalOrientation[u32Index];
+		}
+		else
+		{
+			m_vecWorldOrientation[u32Index] = m_vecLocalOrientation[u32Index];
+		}
+
+		// ̳иڵ
+		if (u8InheritFlags & EIF_Scale)
+		{
+			m_vecWorldScale[u32Index] = parentWorldScale * m_vecLocalScale[u32Index];
+		}
+		else
+		{
+			m_vecWorldScale[u32Index] = m_vecLocalScale[u32Index];
+		}
+	}
+	// ڸڵ㣬任任
+	else
+	{
+		m_vecWorldPosition[u32Index] = m_vecLocalPosition[u32Index];
+		m_vecWorldOrientation[u32Index] = m_vecLocalOrientation[u32Index];
+		m_vecWorldScale[u32Index] = m_vecLocalScale[u32Index];
+	}
+
+	RSceneNode::SetTransform(m_vecWorldTransform[u32Index], m_vecWorldPosition[u32Index], m_vecWorldOrientation[u32Index], m_vecWorldScale[u32Index]);
+
+	++m_vecWorldRevision[u32Index];
+}
+
+void RTransformStore::MarkDirty(unsigned int u32Index)
+{
+	// κα任Ӱڵ任аµĽ
+	++m_u32ChangeEpoch;
+
+	if (!IsDirty(u32Index))
+	{
+		m_vecDirtyBits[u32Index >> 5] |= 1u << (u32Index & 31);
+		++m_u32DirtyCount;
+	}
+}
+
+template<typename T>
+void RTransformStore::Permute(vector<T>& vecData, const vector<unsigned int>& vecNewToOld)
+{
+	vector<T> vecPermuted;
+	vecPermuted.reserve(vecNewToOld.size());
+
+	for (unsigned int u32OldIndex : vecNewToOld)
+	{
+		vecPermuted.push_back(vecData[u32OldIndex]);
+	}
+
+	vecData.swap(vecPermuted);
+}
@@ -3,14 +3,24 @@
 #include <d3dx9.h>
 #include <RwgeVertexDeclarationTemplate.h>
 #include <RwgeLog.h>
+#include <RwgeAssert.h>
 
 using namespace std;
 
-const string strDefaultVertexDeclarationName = "DefaultVertexDeclaration";
+// { Type, Method, Usage, UsageIndex }
+// ʹD3DDECLMETHOD_CROSSUVʱᴴʧܣԭDXĹٷSampleTangentʹõMethodҲDefault
+static const VertexElement s_PositionElement	= { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 };
+static const VertexElement s_TexCoordElement	= { D3DDECLTYPE_FLOAT2, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 0 };
+static const VertexElement s_NormalElement		= { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL, 0 };
+static const VertexElement s_TangentElement		= { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TANGENT, 0 };
 
-RVertexDeclarationManager::RVertexDeclarationManager()
+RVertexDeclarationManager::RVertexDeclarationManager() :
+	m_pDefaultVertexDeclaration(nullptr),
+	m_pPositionSplitVertexDeclaration(nullptr),
+	m_pSkinnedSplitVertexDeclaration(nullptr)
 {
 	GenerateDefaultVertexDeclaration();
+	GenerateSplitVertexDeclarations();
 }
 
 RVertexDeclarationManager::~RVertexDeclarationManager()
@@ -18,31 +28,121 @@ RVertexDeclarationManager::~RVertexDeclarationManager()
 
 }
 
+RD3d9VertexDeclaration* RVertexDeclarationManager::GetVertexDeclaration(const RVertexDeclarationTemplate& declarationTemplate)
+{
+	unsigned int u32Hash = declarationTemplate.GetLayoutHash();
+
+	pair<multimap<unsigned int, RD3d9VertexDeclaration*>::iterator, multimap<unsigned int, RD3d9VertexDeclaration*>::iterator> range = 
+		m_mapVertexDeclarations.equal_range(u32Hash);
+	for (multimap<unsigned int, RD3d9VertexDeclaration*>::iterator itDeclaration = range.first; itDeclaration != range.second; ++itDeclaration)
+	{
+		if (itDeclaration->second->GetTemplate() == declarationTemplate)
+		{
+			return itDeclaration->second;
+		}
+	}
+
+	if (range.first != range.second)
+	{
+		RwgeLog(TEXT("Vertex declaration layout hash collision : %X"), u32Hash);
+	}
+
+	RD3d9VertexDeclaration* pVertexDeclaration = new RD3d9VertexDeclaration(declarationTemplate);
+	m_mapVertexDeclarations.insert(make_pair(u32Hash, pVertexDeclaration));
+
+	return pVertexDeclaration;
+}
+
 RD3d9VertexDeclaration* RVertexDeclarationManager::GetDefaultVertexDeclaration()
 {
-	return m_mapVertexDeclarations[strDefaultVertexDeclarationName];
+	return m_pDefaultVertexDeclaration;
 }
 
-void RVertexDeclarationManager::GenerateDefaultVertexDeclaration()
+RD3d9VertexDeclaration* RVertexDeclarationManager::GetPositionSplitVertexDeclaration()
 {
-	RVertexDeclarationTemplate declarationTemplate;
+	return m_pPositionSplitVertexDeclaration;
+}
 
-	// { Type, Method, Usage, UsageIndex }
-	// ʹD3DDECLMETHOD_CROSSUVʱᴴʧܣԭDXĹٷSampleTangentʹõMethodҲDefault
-	VertexElement position = { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 };
-	VertexElement texCoord = { D3DDECLTYPE_FLOAT2, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 0 };
-	VertexElement normal = { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL, 0 };
-	VertexElement tangent = { D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TANGENT, 0 };
+RD3d9VertexDeclaration* RVertexDeclarationManager::GetSkinnedSplitVertexDeclaration()
+{
+	return m_pSkinnedSplitVertexDeclaration;
+}
 
-	declarationTemplate.PushBackVertexElement(position);
-	declarationTemplate.PushBackVertexElement(texCoord);
-	declarationTemplate.PushBackVertexElement(normal);
-	declarationTemplate.PushBackVertexElement(tangent);
+const RD3d9VertexDeclaration* RVertexDeclarationManager::GetInstancedVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration)
+{
+	RwgeAssert(pVertexDeclaration);
 
-	RD3d9VertexDeclaration* pVertexDeclaration = new RD3d9VertexDeclaration(declarationTemplate);
+	if (pVertexDeclaration->m_pInstancedDeclaration == nullptr)
+	{
+		RVertexDeclarationTemplate declarationTemplate = pVertexDeclaration->GetTemplate();
+		unsigned char u8InstanceStream = declarationTemplate.GetStreamCount();
+		declarationTemplate.SetStreamCount(u8InstanceStream + 1);
 
-	if (!m_mapVertexDeclarations.insert(make_pair(strDefaultVertexDeclarationName, pVertexDeclaration)).second)
+		// ÿһռһFLOAT4ɫеInstanceInputӦ
+		for (unsigned char u8Row = 0; u8Row < 4; ++u8Row)
+		{
+			VertexElement worldRow = { D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, static_cast<unsigned char>(4 + u8Row) };
+			declarationTemplate.PushBackVertexElement(worldRow, u8InstanceStream);
+		}
+
+		pVertexDeclaration->m_pInstancedDeclaration = GetVertexDeclaration(declarationTemplate);
+	}
+
+	return pVertexDeclaration->m_pInstancedDeclaration;
+}
+
+const RD3d9VertexDeclaration* RVertexDeclarationManager::GetPositionOnlyVertexDeclaration(const RD3d9VertexDeclaration* pVertexDeclaration)
+{
+	RwgeAssert(pVertexDeclaration);
+
+	if (!pVertexDeclaration->m_bPositionOnlyDeclarationQueried)
 	{
-		RwgeLog(TEXT("Insert default vertex declaration failed!"));
+		pVertexDeclaration->m_bPositionOnlyDeclarationQueried = true;
+
+		// ĶʹֻȡλãҲСֻλõİ汾
+		const RVertexDeclarationTemplate& sourceTemplate = pVertexDeclaration->GetTemplate();
+		if (sourceTemplate.GetStreamCount() > 1 && sourceTemplate.GetStreamElementCount(0) == 1 && 
+			sourceTemplate.GetVertexElementListOfStream(0).front() == s_PositionElement)
+		{
+			RVertexDeclarationTemplate declarationTemplate;
+			declarationTemplate.PushBackVertexElement(s_PositionElement);
+
+			pVertexDeclaration->m_pPositionOnlyDeclaration = GetVertexDeclaration(declarationTemplate);
+		}
 	}
+
+	return pVertexDeclaration->m_pPositionOnlyDeclaration;
+}
+
+void RVertexDeclarationManager::GenerateDefaultVertexDeclaration()
+{
+	RVertexDeclarationTemplate declarationTemplate;
+
+	declarationTemplate.PushBackVertexElement(s_PositionElement);
+	declarationTemplate.PushBackVertexElement(s_TexCoordElement);
+	declarationTemplate.PushBackVertexElement(s_NormalElement);
+	declarationTemplate.PushBackVertexElement(s_TangentElement);
+
+	m_pDefaultVertexDeclaration = GetVertexDeclaration(declarationTemplate);
+}
+
+void RVertexDeclarationManager::GenerateSplitVertexDeclarations()
+{
+	RVertexDeclarationTemplate positionSplitTemplate;
+	positionSplitTemplate.SetStreamCount(2);
+	positionSplitTemplate.PushBackVertexElement(s_PositionElement, 0);
+	positionSplitTemplate.PushBackVertexElement(s_TexCoordElement, 1);
+	positionSplitTemplate.PushBackVertexElement(s_NormalElement, 1);
+	positionSplitTemplate.PushBackVertexElement(s_TangentElement, 1);
+
+	m_pPositionSplitVertexDeclaration = GetVertexDeclaration(positionSplitTemplate);
+
+	RVertexDeclarationTemplate skinnedSplitTemplate;
+	skinnedSplitTemplate.SetStreamCount(3);
+	skinnedSplitTemplate.PushBackVertexElement(s_PositionElement, 0);
+	skinnedSplitTemplate.PushBackVertexElement(s_NormalElement, 1);
+	skinnedSplitTemplate.PushBackVertexElement(s_TangentElement, 1);
+	skinnedSplitTemplate.PushBackVertexElement(s_TexCoordElement, 2);
+
+	m_pSkinnedSplitVertexDeclaration = GetVertexDeclaration(skinnedSplitTemplate);
 }
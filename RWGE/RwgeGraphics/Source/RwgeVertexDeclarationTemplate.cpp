@@ -127,4 +127,46 @@ void RVertexDeclarationTemplate::SetStreamCount(unsigned char u8StreamCount)
 		m_u8ElementCount += elementsOfStream.listVertexElements.size();
 		m_u16TotalVertexSize += elementsOfStream.u16StreamVertexSize;
 	}
-}
\ No newline at end of file
+}
+
+unsigned int RVertexDeclarationTemplate::GetLayoutHash() const
+{
+	// FNV-1aϣķָҲ㣬ԪͬʽͬģõͬĹϣ
+	const size_t u32FnvOffsetBasis = 2166136261U;
+	const size_t u32FnvPrime = 16777619U;
+
+	size_t u32Hash = u32FnvOffsetBasis;
+	for (const ElementListOfStream& elementsOfStream : m_ElementTable)
+	{
+		for (const VertexElement& element : elementsOfStream.listVertexElements)
+		{
+			u32Hash ^= element.u8Type;			u32Hash *= u32FnvPrime;
+			u32Hash ^= element.u8Method;		u32Hash *= u32FnvPrime;
+			u32Hash ^= element.u8Usage;			u32Hash *= u32FnvPrime;
+			u32Hash ^= element.u8UsageIndex;	u32Hash *= u32FnvPrime;
+		}
+
+		u32Hash ^= 0xFF;
+		u32Hash *= u32FnvPrime;
+	}
+
+	return u32Hash;
+}
+
+bool RVertexDeclarationTemplate::operator == (const RVertexDeclarationTemplate& right) const
+{
+	if (m_ElementTable.size() != right.m_ElementTable.size() || m_u8ElementCount != right.m_u8ElementCount)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < m_ElementTable.size(); ++i)
+	{
+		if (m_ElementTable[i].listVertexElements != right.m_ElementTable[i].listVertexElements)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
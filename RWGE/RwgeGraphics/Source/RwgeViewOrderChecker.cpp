@@ -0,0 +1,233 @@
+#include "RwgeViewOrderChecker.h"
+
+#include <math.h>
+#include <algorithm>
+#include "RwgeRenderUnit.h"
+#include "RwgeVertexStream.h"
+#include "RwgeIndexStream.h"
+#include "RwgeD3d9VertexDeclaration.h"
+#include <RwgeAssert.h>
+#include <RwgeLog.h>
+
+using namespace std;
+
+// ͬ[0, 1)֮
+static float NextRandom(unsigned int& u32State)
+{
+	u32State = u32State * 1664525 + 1013904223;
+	return (u32State >> 8) * (1.0f / 16777216.0f);
+}
+
+RViewOrderChecker::RViewOrderChecker()
+{
+
+}
+
+RViewOrderChecker::~RViewOrderChecker()
+{
+
+}
+
+ViewOrderQuality RViewOrderChecker::Evaluate(const RRenderUnit& renderUnit, unsigned int u32ViewCount, unsigned int u32Seed /* = 1 */)
+{
+	ViewOrderQuality quality;
+
+	const RD3d9VertexDeclaration* pVertexDeclaration = renderUnit.GetVertexDeclaration();
+	const IndexStream* pIndexStream = renderUnit.GetIndexStream();
+	if (renderUnit.GetPrimitiveType() != D3DPT_TRIANGLELIST ||
+		pVertexDeclaration == nullptr || !pVertexDeclaration->HasPosition() ||
+		pVertexDeclaration->GetPositionStream() >= renderUnit.GetVertexStreams().size() ||
+		renderUnit.GetVertexStreams()[pVertexDeclaration->GetPositionStream()]->aryVertices == nullptr ||
+		pIndexStream == nullptr || pIndexStream->aryIndices == nullptr ||
+		renderUnit.GetStartIndex() + renderUnit.GetPrimitveCount() * 3 > pIndexStream->u32IndexCount)
+	{
+		RwgeLog(TEXT("View order can't be checked without positions and indices on the CPU."));
+		return quality;
+	}
+
+	D3DXMATRIX matIdentity;
+	D3DXMatrixIdentity(&matIdentity);
+
+	const unsigned int u32OrderIndexCount = renderUnit.GetPrimitveCount() * 3;
+	unsigned int u32State = u32Seed;
+
+	for (unsigned int i = 0; i < u32ViewCount; ++i)
+	{
+		// λϾȷֲķ
+		const float f32Z = NextRandom(u32State) * 2.0f - 1.0f;
+		const float f32Angle = NextRandom(u32State) * 2.0f * D3DX_PI;
+		const float f32Radius = sqrtf(max(0.0f, 1.0f - f32Z * f32Z));
+		const D3DXVECTOR3 viewDirection(f32Radius * cosf(f32Angle), f32Radius * sinf(f32Angle), f32Z);
+
+		unsigned long long u64OverlappingPairCount = 0;
+		const unsigned long long u64BaseCount = CountOutOfOrderPairs(renderUnit, renderUnit.GetStartIndex(), viewDirection, u64OverlappingPairCount);
+
+		quality.u64OverlappingPairCount += u64OverlappingPairCount;
+		quality.u64BaseOutOfOrderCount += u64BaseCount;
+
+		if (renderUnit.HasViewOrders())
+		{
+			// ͼ˳ͬΣصĶ˳ͬ
+			const unsigned int u32Octant = RRenderUnit::SelectViewOrder(viewDirection, matIdentity);
+			quality.u64ViewOrderOutOfOrderCount += CountOutOfOrderPairs(renderUnit, renderUnit.GetStartIndex() + (u32Octant + 1) * u32OrderIndexCount, viewDirection, u64OverlappingPairCount);
+		}
+		else
+		{
+			quality.u64ViewOrderOutOfOrderCount += u64BaseCount;
+		}
+
+		++quality.u32ViewCount;
+	}
+
+	return quality;
+}
+
+void RViewOrderChecker::LogQuality(const ViewOrderQuality& quality) const
+{
+	RwgeLog(TEXT("View order quality - Views : %u, OverlappingPairs : %llu, BaseOutOfOrder : %llu (%.4f), ViewOrderOutOfOrder : %llu (%.4f)"),
+		quality.u32ViewCount,
+		quality.u64OverlappingPairCount,
+		quality.u64BaseOutOfOrderCount,
+		quality.GetBaseErrorRate(),
+		quality.u64ViewOrderOutOfOrderCount,
+		quality.GetViewOrderErrorRate());
+}
+
+unsigned long long RViewOrderChecker::CountOutOfOrderPairs(const RRenderUnit& renderUnit, unsigned int u32StartIndex, const D3DXVECTOR3& viewDirection, unsigned long long& u64OverlappingPairCount)
+{
+	const RD3d9VertexDeclaration* pVertexDeclaration = renderUnit.GetVertexDeclaration();
+	const VertexStream* pVertexStream = renderUnit.GetVertexStreams()[pVertexDeclaration->GetPositionStream()];
+	const IndexStream* pIndexStream = renderUnit.GetIndexStream();
+	const unsigned int u32PrimitiveCount = renderUnit.GetPrimitveCount();
+
+	RwgeAssert(u32StartIndex + u32PrimitiveCount * 3 <= pIndexStream->u32IndexCount);
+
+	// ʼ
+	const unsigned char* pPositions = reinterpret_cast<const unsigned char*>(pVertexStream->aryVertices) +
+		renderUnit.GetBaseVertexIndex() * pVertexStream->u8VertexSize + pVertexDeclaration->GetPositionOffset();
+
+	// ͶӰƽ
+	const D3DXVECTOR3 reference = fabsf(viewDirection.y) < 0.9f ? D3DXVECTOR3(0.0f, 1.0f, 0.0f) : D3DXVECTOR3(1.0f, 0.0f, 0.0f);
+	D3DXVECTOR3 axisU;
+	D3DXVECTOR3 axisV;
+	D3DXVec3Cross(&axisU, &reference, &viewDirection);
+	D3DXVec3Normalize(&axisU, &axisU);
+	D3DXVec3Cross(&axisV, &viewDirection, &axisU);
+
+	m_vecTriangles.resize(u32PrimitiveCount);
+	for (unsigned int i = 0; i < u32PrimitiveCount; ++i)
+	{
+		ProjectedTriangle& triangle = m_vecTriangles[i];
+		triangle.u32DrawOrder = i;
+
+		for (unsigned int j = 0; j < 3; ++j)
+		{
+			const unsigned int u32Vertex = pIndexStream->GetIndex(u32StartIndex + i * 3 + j);
+			const D3DXVECTOR3& position = *reinterpret_cast<const D3DXVECTOR3*>(pPositions + u32Vertex * pVertexStream->u8VertexSize);
+
+			const float f32Depth = D3DXVec3Dot(&position, &viewDirection);
+			const D3DXVECTOR2 point(D3DXVec3Dot(&position, &axisU), D3DXVec3Dot(&position, &axisV));
+			triangle.aryPoints[j] = point;
+
+			if (j == 0)
+			{
+				triangle.f32MinDepth = triangle.f32MaxDepth = f32Depth;
+				triangle.boundsMin = triangle.boundsMax = point;
+			}
+			else
+			{
+				triangle.f32MinDepth = min(triangle.f32MinDepth, f32Depth);
+				triangle.f32MaxDepth = max(triangle.f32MaxDepth, f32Depth);
+				triangle.boundsMin = D3DXVECTOR2(min(triangle.boundsMin.x, point.x), min(triangle.boundsMin.y, point.y));
+				triangle.boundsMax = D3DXVECTOR2(max(triangle.boundsMax.x, point.x), max(triangle.boundsMax.y, point.y));
+			}
+		}
+	}
+
+	// ͶӰxСֵֻҪȽxΧཻ
+	sort(m_vecTriangles.begin(), m_vecTriangles.end(),
+		[](const ProjectedTriangle& triangle0, const ProjectedTriangle& triangle1) { return triangle0.boundsMin.x < triangle1.boundsMin.x; });
+
+	unsigned long long u64OutOfOrderCount = 0;
+	u64OverlappingPairCount = 0;
+
+	for (unsigned int i = 0; i < u32PrimitiveCount; ++i)
+	{
+		const ProjectedTriangle& triangle0 = m_vecTriangles[i];
+
+		for (unsigned int j = i + 1; j < u32PrimitiveCount && m_vecTriangles[j].boundsMin.x < triangle0.boundsMax.x; ++j)
+		{
+			const ProjectedTriangle& triangle1 = m_vecTriangles[j];
+			if (triangle1.boundsMin.y >= triangle0.boundsMax.y || triangle0.boundsMin.y >= triangle1.boundsMax.y)
+			{
+				continue;
+			}
+
+			// ع۲췽ȷΧཻζԲ
+			const ProjectedTriangle* pNear = nullptr;
+			const ProjectedTriangle* pFar = nullptr;
+			if (triangle0.f32MaxDepth < triangle1.f32MinDepth)
+			{
+				pNear = &triangle0;
+				pFar = &triangle1;
+			}
+			else if (triangle1.f32MaxDepth < triangle0.f32MinDepth)
+			{
+				pNear = &triangle1;
+				pFar = &triangle0;
+			}
+			else
+			{
+				continue;
+			}
+
+			if (!Overlap(triangle0, triangle1))
+			{
+				continue;
+			}
+
+			++u64OverlappingPairCount;
+			if (pFar->u32DrawOrder > pNear->u32DrawOrder)
+			{
+				++u64OutOfOrderCount;
+			}
+		}
+	}
+
+	return u64OutOfOrderCount;
+}
+
+bool RViewOrderChecker::Overlap(const ProjectedTriangle& triangle0, const ProjectedTriangle& triangle1)
+{
+	// ԣε6ߵķдһʹͶӰཻʱβصֻӴ߻򶥵ʱΪص
+	const ProjectedTriangle* aryTriangles[2] = { &triangle0, &triangle1 };
+
+	for (unsigned int t = 0; t < 2; ++t)
+	{
+		for (unsigned int e = 0; e < 3; ++e)
+		{
+			const D3DXVECTOR2& point0 = aryTriangles[t]->aryPoints[e];
+			const D3DXVECTOR2& point1 = aryTriangles[t]->aryPoints[(e + 1) % 3];
+			const D3DXVECTOR2 axis(point0.y - point1.y, point1.x - point0.x);
+
+			float aryMin[2];
+			float aryMax[2];
+			for (unsigned int k = 0; k < 2; ++k)
+			{
+				for (unsigned int p = 0; p < 3; ++p)
+				{
+					const float f32Projection = aryTriangles[k]->aryPoints[p].x * axis.x + aryTriangles[k]->aryPoints[p].y * axis.y;
+					aryMin[k] = p == 0 ? f32Projection : min(aryMin[k], f32Projection);
+					aryMax[k] = p == 0 ? f32Projection : max(aryMax[k], f32Projection);
+				}
+			}
+
+			if (aryMax[0] <= aryMin[1] || aryMax[1] <= aryMin[0])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,40 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-15
+	DESC :
+	1.	ΧͬʱAABB + 볤ΧAABBͬ׶üʱȡϽһ
+	2.	볤С0ʾհΧ壬հΧκΰΧϲĽһΧ
+	3.	Χ任ռʱʹArvoķµİ볤ڱ任3x3ȡֵԭ볤ˣΧ뾶
+		ϵŴ󣬱任İΧȻģֱӱ任8AABBĽԴ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <d3dx9.h>
+
+class RBounds
+{
+public:
+	RBounds();
+	RBounds(const D3DXVECTOR3& inCenter, const D3DXVECTOR3& inExtents, float f32InRadius);
+	~RBounds();
+
+	void Reset();
+	bool IsEmpty() const;
+
+	/*
+	ݶݼΧ
+	@Param
+		pPositions		һλõĵַλñ3float
+		u32Count		
+		u32Stride		λֽ֮
+	*/
+	void SetByPoints(const void* pPositions, unsigned int u32Count, unsigned int u32Stride);
+	void Merge(const RBounds& bounds);
+	void Transform(RBounds& outBounds, const D3DXMATRIX& matrix) const;		// matrixǷ任
+
+	D3DXVECTOR3	center;
+	float		f32Radius;
+	D3DXVECTOR3	extents;
+};
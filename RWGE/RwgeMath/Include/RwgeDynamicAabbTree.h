@@ -0,0 +1,306 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-16
+	DESC :
+	1.	̬AABBһöΧҶӽڵ㱣ProxyAABBڲڵAABBӽڵAABBĲ
+		׶ü߲ѯصѯѯĸӶ볡еĶԹϵ
+	2.	Ҷӽڵ㱣AABBFat AABBƶֻҪµAABBȻFat AABBͲҪ޸Ľṹ
+		ʱŴƳҶӲ²룬ͬʱظڵ¼㣨RefitȽڵAABB
+	3.	ҶʱʹñʽSAHѡֵܽڵ㣺Ӹڵ㿪ʼ£Ƚ"ڵǰڵ㴦¸ڵ""ĳ
+		ӽڵ"ĴۣΪڲڵıȽڵΪӵı
+	4.	ƳҶӺظڵ϶ÿڵ㳢תӽڵڵ㣬򽻻ڵ㣩ѡڲڵ
+		֮СķʹڶƶʱȻֽϺõ
+	5.	ڵУʹãнڵͨڵʱҪ޸κ
+	6.	ѯӿڶģ庯صĲ뷵ֵע
+
+   UPDATE
+	AUTH :	һ																			   DATE : 2016-07-05
+	DESC :
+	1.	׶ѯһʹõṩջİ汾ûб޸ʱ߳̿ԸʹԼջͬʱѯ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include "RwgeFrustum.h"
+
+struct Aabb
+{
+	D3DXVECTOR3 minPoint;
+	D3DXVECTOR3 maxPoint;
+
+	Aabb() {};
+	Aabb(const D3DXVECTOR3& inMinPoint, const D3DXVECTOR3& inMaxPoint) : minPoint(inMinPoint), maxPoint(inMaxPoint) {};
+
+	FORCE_INLINE D3DXVECTOR3 GetCenter()	const { return (minPoint + maxPoint) * 0.5f; };
+	FORCE_INLINE D3DXVECTOR3 GetExtents()	const { return (maxPoint - minPoint) * 0.5f; };
+
+	FORCE_INLINE float GetSurfaceArea() const
+	{
+		float dx = maxPoint.x - minPoint.x;
+		float dy = maxPoint.y - minPoint.y;
+		float dz = maxPoint.z - minPoint.z;
+		return 2.0f * (dx * dy + dy * dz + dz * dx);
+	}
+
+	FORCE_INLINE bool Contains(const Aabb& aabb) const
+	{
+		return	minPoint.x <= aabb.minPoint.x && minPoint.y <= aabb.minPoint.y && minPoint.z <= aabb.minPoint.z &&
+				aabb.maxPoint.x <= maxPoint.x && aabb.maxPoint.y <= maxPoint.y && aabb.maxPoint.z <= maxPoint.z;
+	}
+
+	FORCE_INLINE bool Overlaps(const Aabb& aabb) const
+	{
+		return	minPoint.x <= aabb.maxPoint.x && minPoint.y <= aabb.maxPoint.y && minPoint.z <= aabb.maxPoint.z &&
+				aabb.minPoint.x <= maxPoint.x && aabb.minPoint.y <= maxPoint.y && aabb.minPoint.z <= maxPoint.z;
+	}
+
+	FORCE_INLINE static Aabb Combine(const Aabb& a, const Aabb& b)
+	{
+		Aabb result;
+		D3DXVec3Minimize(&result.minPoint, &a.minPoint, &b.minPoint);
+		D3DXVec3Maximize(&result.maxPoint, &a.maxPoint, &b.maxPoint);
+		return result;
+	}
+
+	/*
+	AABB󽻣Slab
+	@Param
+		origin				
+		invDirection		߷ÿĵ
+		f32MaxDistance		ֻ[0, f32MaxDistance]ΧڵĽ㣬ԷĳΪλ
+		f32OutDistance		ཻʱAABBľ룬AABBڲʱΪ0
+	*/
+	bool IntersectRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& invDirection, float f32MaxDistance, float& f32OutDistance) const;
+};
+
+class RDynamicAabbTree
+{
+public:
+	static const unsigned int u32NullNode = 0xFFFFFFFF;
+
+private:
+	struct TreeNode
+	{
+		Aabb			aabb;				// ҶӽڵбFat AABB
+		void*			pUserData;
+		unsigned int	u32Parent;			// ڵʱһڵ
+		unsigned int	u32Child1;
+		unsigned int	u32Child2;
+		int				s32Height;			// ҶӽڵΪ0нڵΪ-1
+
+		FORCE_INLINE bool IsLeaf() const { return u32Child1 == u32NullNode; };
+	};
+
+public:
+	/*
+	@Param
+		f32FatMargin		Fat AABBÿľ
+		f32FatRatio			Fat AABBÿϰСıʵľȡнϴһ
+	*/
+	RDynamicAabbTree(float f32FatMargin = 0.1f, float f32FatRatio = 0.1f);
+	~RDynamicAabbTree();
+
+	unsigned int CreateProxy(const Aabb& aabb, void* pUserData);
+	void DestroyProxy(unsigned int u32Proxy);
+	bool MoveProxy(unsigned int u32Proxy, const Aabb& aabb);		// trueʾҶӱ²룬falseʾFat AABBȻЧ
+
+	FORCE_INLINE void*			GetUserData(unsigned int u32Proxy)	const { return m_vecNodes[u32Proxy].pUserData; };
+	FORCE_INLINE const Aabb&	GetFatAabb(unsigned int u32Proxy)	const { return m_vecNodes[u32Proxy].aabb; };
+	FORCE_INLINE unsigned int	GetProxyCount()						const { return m_u32ProxyCount; };
+	FORCE_INLINE int			GetHeight()							const { return m_u32Root == u32NullNode ? 0 : m_vecNodes[m_u32Root].s32Height; };
+	float GetAreaRatio() const;		// нڵ֮ڵıֵںԽСԽ
+
+	/*
+	׶ѯ
+	@Param
+		callback	void (void* pUserData, bool bFullyInside)bFullyInsideΪtrueʱFat AABBȫλ׶
+	*/
+	template<typename T>
+	void QueryFrustum(const RFrustum& frustum, T callback) const;
+	template<typename T>
+	void QueryFrustum(const RFrustum& frustum, T callback, std::vector<unsigned int>& vecStack) const;	// ʹvecStackڲջ
+
+	/*
+	صѯ
+	@Param
+		callback	bool (void* pUserData)falseʱֹѯ
+	*/
+	template<typename T>
+	void QueryAabb(const Aabb& aabb, T callback) const;
+
+	/*
+	߲ѯֻFat AABBཻҶ
+	@Param
+		callback	float (void* pUserData, float f32MaxDistance)µڲüĲѯ0ʱֹѯ
+					f32MaxDistanceʾ
+	*/
+	template<typename T>
+	void RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, float f32MaxDistance, T callback) const;
+
+	template<typename T>
+	void ForEachProxy(T callback) const;		// void (void* pUserData)
+
+private:
+	unsigned int AllocateNode();
+	void FreeNode(unsigned int u32Node);
+
+	void InsertLeaf(unsigned int u32Leaf);
+	void RemoveLeaf(unsigned int u32Leaf);
+	void RefitAncestors(unsigned int u32Node);		// u32Nodeʼ¼AABB߶ȣת
+	void RotateNodes(unsigned int u32Node);
+	void UpdateNode(unsigned int u32Node);			// ӽڵ¼AABB߶
+
+	Aabb MakeFatAabb(const Aabb& aabb) const;
+
+private:
+	std::vector<TreeNode>				m_vecNodes;
+	unsigned int						m_u32Root;
+	unsigned int						m_u32FreeList;
+	unsigned int						m_u32ProxyCount;
+
+	float								m_f32FatMargin;
+	float								m_f32FatRatio;
+
+	mutable std::vector<unsigned int>	m_vecStack;			// ѯʱʹõջÿβѯڴ
+};
+
+template<typename T>
+void RDynamicAabbTree::QueryFrustum(const RFrustum& frustum, T callback) const
+{
+	QueryFrustum(frustum, callback, m_vecStack);
+}
+
+template<typename T>
+void RDynamicAabbTree::QueryFrustum(const RFrustum& frustum, T callback, std::vector<unsigned int>& vecStack) const
+{
+	if (m_u32Root == u32NullNode)
+	{
+		return;
+	}
+
+	// ջеԪΪ ڵ * 2 + Ƿȫλ׶ڣȫλ׶ڵҪ
+	vecStack.clear();
+	vecStack.push_back(m_u32Root << 1);
+
+	while (!vecStack.empty())
+	{
+		unsigned int u32Entry = vecStack.back();
+		vecStack.pop_back();
+
+		const TreeNode& node = m_vecNodes[u32Entry >> 1];
+		unsigned int u32Inside = u32Entry & 1;
+
+		if (!u32Inside)
+		{
+			RFrustum::EIntersection intersection = frustum.Classify(node.aabb.GetCenter(), node.aabb.GetExtents());
+			if (intersection == RFrustum::EI_Outside)
+			{
+				continue;
+			}
+
+			u32Inside = intersection == RFrustum::EI_Inside ? 1 : 0;
+		}
+
+		if (node.IsLeaf())
+		{
+			callback(node.pUserData, u32Inside != 0);
+		}
+		else
+		{
+			vecStack.push_back((node.u32Child1 << 1) | u32Inside);
+			vecStack.push_back((node.u32Child2 << 1) | u32Inside);
+		}
+	}
+}
+
+template<typename T>
+void RDynamicAabbTree::QueryAabb(const Aabb& aabb, T callback) const
+{
+	if (m_u32Root == u32NullNode)
+	{
+		return;
+	}
+
+	m_vecStack.clear();
+	m_vecStack.push_back(m_u32Root);
+
+	while (!m_vecStack.empty())
+	{
+		const TreeNode& node = m_vecNodes[m_vecStack.back()];
+		m_vecStack.pop_back();
+
+		if (!node.aabb.Overlaps(aabb))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(node.pUserData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			m_vecStack.push_back(node.u32Child1);
+			m_vecStack.push_back(node.u32Child2);
+		}
+	}
+}
+
+template<typename T>
+void RDynamicAabbTree::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, float f32MaxDistance, T callback) const
+{
+	if (m_u32Root == u32NullNode)
+	{
+		return;
+	}
+
+	D3DXVECTOR3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	m_vecStack.clear();
+	m_vecStack.push_back(m_u32Root);
+
+	while (!m_vecStack.empty())
+	{
+		const TreeNode& node = m_vecNodes[m_vecStack.back()];
+		m_vecStack.pop_back();
+
+		float f32Distance;
+		if (!node.aabb.IntersectRay(origin, invDirection, f32MaxDistance, f32Distance))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			f32MaxDistance = callback(node.pUserData, f32MaxDistance);
+			if (f32MaxDistance <= 0.0f)
+			{
+				return;
+			}
+		}
+		else
+		{
+			m_vecStack.push_back(node.u32Child1);
+			m_vecStack.push_back(node.u32Child2);
+		}
+	}
+}
+
+template<typename T>
+void RDynamicAabbTree::ForEachProxy(T callback) const
+{
+	for (const TreeNode& node : m_vecNodes)
+	{
+		if (node.s32Height == 0)
+		{
+			callback(node.pUserData);
+		}
+	}
+}
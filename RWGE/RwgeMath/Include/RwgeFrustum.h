@@ -0,0 +1,89 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-06-15
+	DESC :
+	1.	׶6ƽɣƽ淨ָ׶ڲƽ淽ֱӴͼͶӰȡGribb & Hartmann
+		A.	D3D ʹüռ (x, y, z, w) = (X, Y, Z, 1) * ViewProj׶ڵΪ
+			-w <= x <= w-w <= y <= w0 <= z <= w
+		B.	ƽΪ4  1УƽΪ4  2УƽΪ3УԶƽΪ4 - 3
+	2.	ΧƽĲԣd = Dot(N, Center) + DЧ뾶 r = Min(Χ뾶, Dot(|N|, Extents))d < -r ʱΧ
+		ȫλƽֻ࣬Ҫλһƽ༴޳
+	3.	ʱΧ尴SoAķʽţBoundsBatchÿʹSSE ͬʱ4Χ壬֧SSE ƽ̨ʹñ汾
+		汾ĲԽȫһ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <vector>
+#include <d3dx9.h>
+#include <RwgeCoreDef.h>
+#include "RwgeBounds.h"
+
+// SoAʽŵһΧ壬׶
+struct BoundsBatch
+{
+	std::vector<float>	vecCenterX;
+	std::vector<float>	vecCenterY;
+	std::vector<float>	vecCenterZ;
+	std::vector<float>	vecRadius;
+	std::vector<float>	vecExtentX;
+	std::vector<float>	vecExtentY;
+	std::vector<float>	vecExtentZ;
+
+	void Clear();
+	void PushBack(const RBounds& bounds);
+	FORCE_INLINE unsigned int GetCount() const { return static_cast<unsigned int>(vecCenterX.size()); };
+};
+
+class RFrustum
+{
+public:
+	enum EFrustumPlane
+	{
+		EFP_Left,
+		EFP_Right,
+		EFP_Bottom,
+		EFP_Top,
+		EFP_Near,
+		EFP_Far,
+
+		EFrustumPlane_MAX
+	};
+
+	enum EIntersection
+	{
+		EI_Outside,
+		EI_Intersect,
+		EI_Inside,
+
+		EIntersection_MAX
+	};
+
+public:
+	RFrustum();
+	~RFrustum();
+
+	void SetByViewProjection(const D3DXMATRIX& viewProjTransform);
+
+	bool IsVisible(const RBounds& bounds) const;
+	EIntersection Classify(const D3DXVECTOR3& center, const D3DXVECTOR3& extents) const;		// ֻʹAABBԣڲβü
+
+	/*
+	԰ΧǷɼ
+	@Param
+		batch			ҪԵİΧ
+		aryVisible		ÿΧǷɼ01ȲСbatch.GetCount()
+	@Return
+		ɼİΧ
+	*/
+	unsigned int CullBatch(const BoundsBatch& batch, unsigned char* aryVisible) const;
+
+	FORCE_INLINE const D3DXPLANE& GetPlane(EFrustumPlane plane) const { return m_aryPlanes[plane]; };
+
+private:
+	unsigned int CullBatchScalar(const BoundsBatch& batch, unsigned int u32Begin, unsigned char* aryVisible) const;
+
+private:
+	D3DXPLANE	m_aryPlanes[EFrustumPlane_MAX];
+};
@@ -40,7 +40,7 @@ public:
 	float Modulus() const;			// Ԫģ
 	RQuaternion& Normalise();		// λԪ
 
-	D3DXVECTOR3&& RotateVector(const D3DXVECTOR3& vector) const;
+	D3DXVECTOR3 RotateVector(const D3DXVECTOR3& vector) const;
 
 	__forceinline static RQuaternion* AxisAngleToQuaternion(RQuaternion* pOutQuaternion, const D3DXVECTOR3* pInAxis, const AngleRadian& inAngle);
 	__forceinline static void QuaternionToAxisAngle(const RQuaternion* pInQuaternion, D3DXVECTOR3* pOutAxis, AngleRadian& outRadianAngle);
@@ -0,0 +1,146 @@
+#include "RwgeBounds.h"
+
+#include <math.h>
+#include <float.h>
+#include "RwgeMath.h"
+
+RBounds::RBounds() :
+	center		(0.0f, 0.0f, 0.0f),
+	f32Radius	(-1.0f),
+	extents		(-1.0f, -1.0f, -1.0f)
+{
+}
+
+RBounds::RBounds(const D3DXVECTOR3& inCenter, const D3DXVECTOR3& inExtents, float f32InRadius) :
+	center		(inCenter),
+	f32Radius	(f32InRadius),
+	extents		(inExtents)
+{
+}
+
+RBounds::~RBounds()
+{
+}
+
+void RBounds::Reset()
+{
+	center		= RwgeMath::Vector3Zero;
+	f32Radius	= -1.0f;
+	extents		= D3DXVECTOR3(-1.0f, -1.0f, -1.0f);
+}
+
+bool RBounds::IsEmpty() const
+{
+	return extents.x < 0.0f || extents.y < 0.0f || extents.z < 0.0f;
+}
+
+void RBounds::SetByPoints(const void* pPositions, unsigned int u32Count, unsigned int u32Stride)
+{
+	if (u32Count == 0)
+	{
+		Reset();
+		return;
+	}
+
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pPositions);
+
+	D3DXVECTOR3 minPoint( FLT_MAX,  FLT_MAX,  FLT_MAX);
+	D3DXVECTOR3 maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for (unsigned int i = 0; i < u32Count; ++i)
+	{
+		const D3DXVECTOR3& point = *reinterpret_cast<const D3DXVECTOR3*>(pBytes + i * u32Stride);
+		D3DXVec3Minimize(&minPoint, &minPoint, &point);
+		D3DXVec3Maximize(&maxPoint, &maxPoint, &point);
+	}
+
+	center	= (minPoint + maxPoint) * 0.5f;
+	extents	= (maxPoint - minPoint) * 0.5f;
+
+	// Χ뾶ʹö㵽ĵ룬AABB
+	float f32MaxDistance2 = 0.0f;
+	for (unsigned int i = 0; i < u32Count; ++i)
+	{
+		const D3DXVECTOR3& point = *reinterpret_cast<const D3DXVECTOR3*>(pBytes + i * u32Stride);
+		float f32Distance2 = RwgeMath::Distance2(point, center);
+		if (f32Distance2 > f32MaxDistance2)
+		{
+			f32MaxDistance2 = f32Distance2;
+		}
+	}
+
+	f32Radius = sqrtf(f32MaxDistance2);
+}
+
+void RBounds::Merge(const RBounds& bounds)
+{
+	if (bounds.IsEmpty())
+	{
+		return;
+	}
+
+	if (IsEmpty())
+	{
+		*this = bounds;
+		return;
+	}
+
+	D3DXVECTOR3 minPoint = center - extents;
+	D3DXVECTOR3 maxPoint = center + extents;
+	D3DXVECTOR3 otherMinPoint = bounds.center - bounds.extents;
+	D3DXVECTOR3 otherMaxPoint = bounds.center + bounds.extents;
+	D3DXVec3Minimize(&minPoint, &minPoint, &otherMinPoint);
+	D3DXVec3Maximize(&maxPoint, &maxPoint, &otherMaxPoint);
+
+	D3DXVECTOR3 newCenter = (minPoint + maxPoint) * 0.5f;
+	D3DXVECTOR3 newExtents = (maxPoint - minPoint) * 0.5f;
+
+	// µİΧҪͬʱɵİΧ򣬵ҪAABB
+	float f32NewRadius = RwgeMath::Distance(newCenter, center) + f32Radius;
+	float f32OtherRadius = RwgeMath::Distance(newCenter, bounds.center) + bounds.f32Radius;
+	if (f32OtherRadius > f32NewRadius)
+	{
+		f32NewRadius = f32OtherRadius;
+	}
+
+	float f32BoxRadius = D3DXVec3Length(&newExtents);
+	if (f32BoxRadius < f32NewRadius)
+	{
+		f32NewRadius = f32BoxRadius;
+	}
+
+	center		= newCenter;
+	extents		= newExtents;
+	f32Radius	= f32NewRadius;
+}
+
+void RBounds::Transform(RBounds& outBounds, const D3DXMATRIX& matrix) const
+{
+	if (IsEmpty())
+	{
+		outBounds.Reset();
+		return;
+	}
+
+	D3DXVECTOR3 newCenter;
+	D3DXVec3TransformCoord(&newCenter, &center, &matrix);
+
+	// D3DʹĵiмΪֲi任Ľ
+	D3DXVECTOR3 newExtents(
+		fabsf(matrix._11) * extents.x + fabsf(matrix._21) * extents.y + fabsf(matrix._31) * extents.z,
+		fabsf(matrix._12) * extents.x + fabsf(matrix._22) * extents.y + fabsf(matrix._32) * extents.z,
+		fabsf(matrix._13) * extents.x + fabsf(matrix._23) * extents.y + fabsf(matrix._33) * extents.z);
+
+	float f32Scale2X = matrix._11 * matrix._11 + matrix._12 * matrix._12 + matrix._13 * matrix._13;
+	float f32Scale2Y = matrix._21 * matrix._21 + matrix._22 * matrix._22 + matrix._23 * matrix._23;
+	float f32Scale2Z = matrix._31 * matrix._31 + matrix._32 * matrix._32 + matrix._33 * matrix._33;
+	float f32MaxScale2 = f32Scale2X > f32Scale2Y ? f32Scale2X : f32Scale2Y;
+	f32MaxScale2 = f32MaxScale2 > f32Scale2Z ? f32MaxScale2 : f32Scale2Z;
+
+	float f32NewRadius = f32Radius * sqrtf(f32MaxScale2);
+	float f32BoxRadius = D3DXVec3Length(&newExtents);
+
+	outBounds.center	= newCenter;
+	outBounds.extents	= newExtents;
+	outBounds.f32Radius	= f32NewRadius < f32BoxRadius ? f32NewRadius : f32BoxRadius;
+}
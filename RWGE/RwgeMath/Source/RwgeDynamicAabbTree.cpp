@@ -0,0 +1,495 @@
+#include "RwgeDynamicAabbTree.h"
+
+#include <RwgeAssert.h>
+
+bool Aabb::IntersectRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& invDirection, float f32MaxDistance, float& f32OutDistance) const
+{
+	float f32Near = 0.0f;
+	float f32Far = f32MaxDistance;
+
+	const float* aryOrigin = &origin.x;
+	const float* aryInvDirection = &invDirection.x;
+	const float* aryMin = &minPoint.x;
+	const float* aryMax = &maxPoint.x;
+
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		float f32T1 = (aryMin[i] - aryOrigin[i]) * aryInvDirection[i];
+		float f32T2 = (aryMax[i] - aryOrigin[i]) * aryInvDirection[i];
+
+		if (f32T1 > f32T2)
+		{
+			float f32Temp = f32T1;
+			f32T1 = f32T2;
+			f32T2 = f32Temp;
+		}
+
+		f32Near = f32T1 > f32Near ? f32T1 : f32Near;
+		f32Far = f32T2 < f32Far ? f32T2 : f32Far;
+
+		if (f32Near > f32Far)
+		{
+			return false;
+		}
+	}
+
+	f32OutDistance = f32Near;
+	return true;
+}
+
+RDynamicAabbTree::RDynamicAabbTree(float f32FatMargin, float f32FatRatio) :
+	m_u32Root		(u32NullNode),
+	m_u32FreeList	(u32NullNode),
+	m_u32ProxyCount	(0),
+	m_f32FatMargin	(f32FatMargin),
+	m_f32FatRatio	(f32FatRatio)
+{
+}
+
+RDynamicAabbTree::~RDynamicAabbTree()
+{
+}
+
+unsigned int RDynamicAabbTree::CreateProxy(const Aabb& aabb, void* pUserData)
+{
+	unsigned int u32Proxy = AllocateNode();
+
+	TreeNode& node = m_vecNodes[u32Proxy];
+	node.aabb		= MakeFatAabb(aabb);
+	node.pUserData	= pUserData;
+	node.s32Height	= 0;
+
+	InsertLeaf(u32Proxy);
+	++m_u32ProxyCount;
+
+	return u32Proxy;
+}
+
+void RDynamicAabbTree::DestroyProxy(unsigned int u32Proxy)
+{
+	RwgeAssert(u32Proxy < m_vecNodes.size() && m_vecNodes[u32Proxy].IsLeaf());
+
+	RemoveLeaf(u32Proxy);
+	FreeNode(u32Proxy);
+	--m_u32ProxyCount;
+}
+
+bool RDynamicAabbTree::MoveProxy(unsigned int u32Proxy, const Aabb& aabb)
+{
+	RwgeAssert(u32Proxy < m_vecNodes.size() && m_vecNodes[u32Proxy].IsLeaf());
+
+	const Aabb& fatAabb = m_vecNodes[u32Proxy].aabb;
+	Aabb newFatAabb = MakeFatAabb(aabb);
+
+	// µAABBȻҶûСFat AABB󣬻ήͲѯЧʣĽṹҪı
+	if (fatAabb.Contains(aabb) && fatAabb.GetSurfaceArea() <= 4.0f * newFatAabb.GetSurfaceArea())
+	{
+		return false;
+	}
+
+	RemoveLeaf(u32Proxy);
+	m_vecNodes[u32Proxy].aabb = newFatAabb;
+	InsertLeaf(u32Proxy);
+
+	return true;
+}
+
+float RDynamicAabbTree::GetAreaRatio() const
+{
+	if (m_u32Root == u32NullNode)
+	{
+		return 0.0f;
+	}
+
+	float f32RootArea = m_vecNodes[m_u32Root].aabb.GetSurfaceArea();
+	if (f32RootArea <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float f32TotalArea = 0.0f;
+	for (const TreeNode& node : m_vecNodes)
+	{
+		if (node.s32Height >= 0)
+		{
+			f32TotalArea += node.aabb.GetSurfaceArea();
+		}
+	}
+
+	return f32TotalArea / f32RootArea;
+}
+
+unsigned int RDynamicAabbTree::AllocateNode()
+{
+	unsigned int u32Node;
+
+	if (m_u32FreeList != u32NullNode)
+	{
+		u32Node = m_u32FreeList;
+		m_u32FreeList = m_vecNodes[u32Node].u32Parent;
+	}
+	else
+	{
+		u32Node = m_vecNodes.size();
+		m_vecNodes.push_back(TreeNode());
+	}
+
+	TreeNode& node = m_vecNodes[u32Node];
+	node.pUserData	= nullptr;
+	node.u32Parent	= u32NullNode;
+	node.u32Child1	= u32NullNode;
+	node.u32Child2	= u32NullNode;
+	node.s32Height	= 0;
+
+	return u32Node;
+}
+
+void RDynamicAabbTree::FreeNode(unsigned int u32Node)
+{
+	m_vecNodes[u32Node].u32Parent = m_u32FreeList;
+	m_vecNodes[u32Node].s32Height = -1;
+	m_u32FreeList = u32Node;
+}
+
+void RDynamicAabbTree::InsertLeaf(unsigned int u32Leaf)
+{
+	if (m_u32Root == u32NullNode)
+	{
+		m_u32Root = u32Leaf;
+		m_vecNodes[u32Leaf].u32Parent = u32NullNode;
+		return;
+	}
+
+	// ʹSAHѡֵܽڵ
+	const Aabb leafAabb = m_vecNodes[u32Leaf].aabb;
+	unsigned int u32Index = m_u32Root;
+
+	while (!m_vecNodes[u32Index].IsLeaf())
+	{
+		const TreeNode& node = m_vecNodes[u32Index];
+
+		float f32Area = node.aabb.GetSurfaceArea();
+		float f32CombinedArea = Aabb::Combine(node.aabb, leafAabb).GetSurfaceArea();
+
+		// ڵǰڵ㴦¸ڵĴ
+		float f32Cost = 2.0f * f32CombinedArea;
+
+		// ʱǰڵ㣨ԼȣΪӵĴ
+		float f32InheritanceCost = 2.0f * (f32CombinedArea - f32Area);
+
+		float aryChildCost[2];
+		unsigned int aryChildren[2] = { node.u32Child1, node.u32Child2 };
+		for (unsigned int i = 0; i < 2; ++i)
+		{
+			const TreeNode& child = m_vecNodes[aryChildren[i]];
+			float f32ChildCombinedArea = Aabb::Combine(child.aabb, leafAabb).GetSurfaceArea();
+
+			if (child.IsLeaf())
+			{
+				aryChildCost[i] = f32ChildCombinedArea + f32InheritanceCost;
+			}
+			else
+			{
+				aryChildCost[i] = f32ChildCombinedArea - child.aabb.GetSurfaceArea() + f32InheritanceCost;
+			}
+		}
+
+		if (f32Cost < aryChildCost[0] && f32Cost < aryChildCost[1])
+		{
+			break;
+		}
+
+		u32Index = aryChildCost[0] < aryChildCost[1] ? aryChildren[0] : aryChildren[1];
+	}
+
+	unsigned int u32Sibling = u32Index;
+
+	// µĸڵ㣬ע⡿AllocateNodeܵݣ֮ǰȡĽڵȫʧЧ
+	unsigned int u32OldParent = m_vecNodes[u32Sibling].u32Parent;
+	unsigned int u32NewParent = AllocateNode();
+
+	TreeNode& newParent = m_vecNodes[u32NewParent];
+	newParent.u32Parent	= u32OldParent;
+	newParent.u32Child1	= u32Sibling;
+	newParent.u32Child2	= u32Leaf;
+	newParent.aabb		= Aabb::Combine(leafAabb, m_vecNodes[u32Sibling].aabb);
+	newParent.s32Height	= m_vecNodes[u32Sibling].s32Height + 1;
+
+	if (u32OldParent != u32NullNode)
+	{
+		TreeNode& oldParent = m_vecNodes[u32OldParent];
+		if (oldParent.u32Child1 == u32Sibling)
+		{
+			oldParent.u32Child1 = u32NewParent;
+		}
+		else
+		{
+			oldParent.u32Child2 = u32NewParent;
+		}
+	}
+	else
+	{
+		m_u32Root = u32NewParent;
+	}
+
+	m_vecNodes[u32Sibling].u32Parent = u32NewParent;
+	m_vecNodes[u32Leaf].u32Parent = u32NewParent;
+
+	RefitAncestors(m_vecNodes[u32Leaf].u32Parent);
+}
+
+void RDynamicAabbTree::RemoveLeaf(unsigned int u32Leaf)
+{
+	if (u32Leaf == m_u32Root)
+	{
+		m_u32Root = u32NullNode;
+		return;
+	}
+
+	unsigned int u32Parent = m_vecNodes[u32Leaf].u32Parent;
+	unsigned int u32GrandParent = m_vecNodes[u32Parent].u32Parent;
+	unsigned int u32Sibling = m_vecNodes[u32Parent].u32Child1 == u32Leaf ? m_vecNodes[u32Parent].u32Child2 : m_vecNodes[u32Parent].u32Child1;
+
+	// ֵܽڵ滻ڵ㣬ȻͷŸڵ
+	if (u32GrandParent != u32NullNode)
+	{
+		TreeNode& grandParent = m_vecNodes[u32GrandParent];
+		if (grandParent.u32Child1 == u32Parent)
+		{
+			grandParent.u32Child1 = u32Sibling;
+		}
+		else
+		{
+			grandParent.u32Child2 = u32Sibling;
+		}
+
+		m_vecNodes[u32Sibling].u32Parent = u32GrandParent;
+		FreeNode(u32Parent);
+
+		RefitAncestors(u32GrandParent);
+	}
+	else
+	{
+		m_u32Root = u32Sibling;
+		m_vecNodes[u32Sibling].u32Parent = u32NullNode;
+		FreeNode(u32Parent);
+	}
+
+	m_vecNodes[u32Leaf].u32Parent = u32NullNode;
+}
+
+void RDynamicAabbTree::RefitAncestors(unsigned int u32Node)
+{
+	while (u32Node != u32NullNode)
+	{
+		UpdateNode(u32Node);
+		RotateNodes(u32Node);
+
+		u32Node = m_vecNodes[u32Node].u32Parent;
+	}
+}
+
+void RDynamicAabbTree::UpdateNode(unsigned int u32Node)
+{
+	TreeNode& node = m_vecNodes[u32Node];
+	const TreeNode& child1 = m_vecNodes[node.u32Child1];
+	const TreeNode& child2 = m_vecNodes[node.u32Child2];
+
+	node.aabb = Aabb::Combine(child1.aabb, child2.aabb);
+	node.s32Height = 1 + (child1.s32Height > child2.s32Height ? child1.s32Height : child2.s32Height);
+}
+
+void RDynamicAabbTree::RotateNodes(unsigned int u32A)
+{
+	/*
+	ڵAӽڵΪBCBӽڵΪDECӽڵΪFG
+			A
+		  /   \
+		 B     C
+		/ \   / \
+	   D   E F   G
+	ѡתУBFGCDEDFGתֻBCԼǵAABBı䣬ֻҪȽ
+	BCڲڵı֮
+	*/
+	enum ERotate
+	{
+		ER_None,
+		ER_BF,
+		ER_BG,
+		ER_CD,
+		ER_CE,
+		ER_DF,
+		ER_DG,
+	};
+
+	TreeNode& nodeA = m_vecNodes[u32A];
+	if (nodeA.s32Height < 2)
+	{
+		return;
+	}
+
+	unsigned int u32B = nodeA.u32Child1;
+	unsigned int u32C = nodeA.u32Child2;
+	TreeNode& nodeB = m_vecNodes[u32B];
+	TreeNode& nodeC = m_vecNodes[u32C];
+
+	ERotate bestRotate = ER_None;
+
+	if (nodeB.IsLeaf())
+	{
+		// ֻܽBCӽڵ㽻
+		const TreeNode& nodeF = m_vecNodes[nodeC.u32Child1];
+		const TreeNode& nodeG = m_vecNodes[nodeC.u32Child2];
+
+		float f32BestCost = nodeC.aabb.GetSurfaceArea();
+		float f32CostBF = Aabb::Combine(nodeB.aabb, nodeG.aabb).GetSurfaceArea();
+		float f32CostBG = Aabb::Combine(nodeB.aabb, nodeF.aabb).GetSurfaceArea();
+
+		if (f32CostBF < f32BestCost)
+		{
+			bestRotate = ER_BF;
+			f32BestCost = f32CostBF;
+		}
+		if (f32CostBG < f32BestCost)
+		{
+			bestRotate = ER_BG;
+		}
+	}
+	else if (nodeC.IsLeaf())
+	{
+		// ֻܽCBӽڵ㽻
+		const TreeNode& nodeD = m_vecNodes[nodeB.u32Child1];
+		const TreeNode& nodeE = m_vecNodes[nodeB.u32Child2];
+
+		float f32BestCost = nodeB.aabb.GetSurfaceArea();
+		float f32CostCD = Aabb::Combine(nodeC.aabb, nodeE.aabb).GetSurfaceArea();
+		float f32CostCE = Aabb::Combine(nodeC.aabb, nodeD.aabb).GetSurfaceArea();
+
+		if (f32CostCD < f32BestCost)
+		{
+			bestRotate = ER_CD;
+			f32BestCost = f32CostCD;
+		}
+		if (f32CostCE < f32BestCost)
+		{
+			bestRotate = ER_CE;
+		}
+	}
+	else
+	{
+		const TreeNode& nodeD = m_vecNodes[nodeB.u32Child1];
+		const TreeNode& nodeE = m_vecNodes[nodeB.u32Child2];
+		const TreeNode& nodeF = m_vecNodes[nodeC.u32Child1];
+		const TreeNode& nodeG = m_vecNodes[nodeC.u32Child2];
+
+		float f32AreaB = nodeB.aabb.GetSurfaceArea();
+		float f32AreaC = nodeC.aabb.GetSurfaceArea();
+
+		float aryCost[] =
+		{
+			f32AreaB + f32AreaC,
+			f32AreaB + Aabb::Combine(nodeB.aabb, nodeG.aabb).GetSurfaceArea(),
+			f32AreaB + Aabb::Combine(nodeB.aabb, nodeF.aabb).GetSurfaceArea(),
+			f32AreaC + Aabb::Combine(nodeC.aabb, nodeE.aabb).GetSurfaceArea(),
+			f32AreaC + Aabb::Combine(nodeC.aabb, nodeD.aabb).GetSurfaceArea(),
+			Aabb::Combine(nodeF.aabb, nodeE.aabb).GetSurfaceArea() + Aabb::Combine(nodeD.aabb, nodeG.aabb).GetSurfaceArea(),
+			Aabb::Combine(nodeG.aabb, nodeE.aabb).GetSurfaceArea() + Aabb::Combine(nodeF.aabb, nodeD.aabb).GetSurfaceArea(),
+		};
+
+		for (unsigned int i = ER_BF; i <= ER_DG; ++i)
+		{
+			if (aryCost[i] < aryCost[bestRotate])
+			{
+				bestRotate = static_cast<ERotate>(i);
+			}
+		}
+	}
+
+	switch (bestRotate)
+	{
+	case ER_BF:
+	case ER_BG:
+		{
+			// BCӽڵ㽻CΪB¸ڵ
+			unsigned int u32Swap = bestRotate == ER_BF ? nodeC.u32Child1 : nodeC.u32Child2;
+			if (bestRotate == ER_BF)
+			{
+				nodeC.u32Child1 = u32B;
+			}
+			else
+			{
+				nodeC.u32Child2 = u32B;
+			}
+
+			nodeA.u32Child1 = u32Swap;
+			m_vecNodes[u32Swap].u32Parent = u32A;
+			nodeB.u32Parent = u32C;
+
+			UpdateNode(u32C);
+			UpdateNode(u32A);
+		}
+		break;
+
+	case ER_CD:
+	case ER_CE:
+		{
+			// CBӽڵ㽻BΪC¸ڵ
+			unsigned int u32Swap = bestRotate == ER_CD ? nodeB.u32Child1 : nodeB.u32Child2;
+			if (bestRotate == ER_CD)
+			{
+				nodeB.u32Child1 = u32C;
+			}
+			else
+			{
+				nodeB.u32Child2 = u32C;
+			}
+
+			nodeA.u32Child2 = u32Swap;
+			m_vecNodes[u32Swap].u32Parent = u32A;
+			nodeC.u32Parent = u32B;
+
+			UpdateNode(u32B);
+			UpdateNode(u32A);
+		}
+		break;
+
+	case ER_DF:
+	case ER_DG:
+		{
+			// DCĳӽڵ㽻
+			unsigned int u32D = nodeB.u32Child1;
+			unsigned int u32Swap = bestRotate == ER_DF ? nodeC.u32Child1 : nodeC.u32Child2;
+
+			nodeB.u32Child1 = u32Swap;
+			if (bestRotate == ER_DF)
+			{
+				nodeC.u32Child1 = u32D;
+			}
+			else
+			{
+				nodeC.u32Child2 = u32D;
+			}
+
+			m_vecNodes[u32Swap].u32Parent = u32B;
+			m_vecNodes[u32D].u32Parent = u32C;
+
+			UpdateNode(u32B);
+			UpdateNode(u32C);
+			UpdateNode(u32A);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+Aabb RDynamicAabbTree::MakeFatAabb(const Aabb& aabb) const
+{
+	D3DXVECTOR3 margin = aabb.GetExtents() * m_f32FatRatio;
+	margin.x = margin.x > m_f32FatMargin ? margin.x : m_f32FatMargin;
+	margin.y = margin.y > m_f32FatMargin ? margin.y : m_f32FatMargin;
+	margin.z = margin.z > m_f32FatMargin ? margin.z : m_f32FatMargin;
+
+	return Aabb(aabb.minPoint - margin, aabb.maxPoint + margin);
+}
@@ -0,0 +1,174 @@
+#include "RwgeFrustum.h"
+
+#include <math.h>
+
+#if RWGE_SIMD_SSE
+#	include <xmmintrin.h>
+#endif
+
+void BoundsBatch::Clear()
+{
+	vecCenterX.clear();
+	vecCenterY.clear();
+	vecCenterZ.clear();
+	vecRadius.clear();
+	vecExtentX.clear();
+	vecExtentY.clear();
+	vecExtentZ.clear();
+}
+
+void BoundsBatch::PushBack(const RBounds& bounds)
+{
+	vecCenterX.push_back(bounds.center.x);
+	vecCenterY.push_back(bounds.center.y);
+	vecCenterZ.push_back(bounds.center.z);
+	vecRadius.push_back(bounds.f32Radius);
+	vecExtentX.push_back(bounds.extents.x);
+	vecExtentY.push_back(bounds.extents.y);
+	vecExtentZ.push_back(bounds.extents.z);
+}
+
+RFrustum::RFrustum()
+{
+	D3DXMATRIX identity;
+	D3DXMatrixIdentity(&identity);
+
+	SetByViewProjection(identity);
+}
+
+RFrustum::~RFrustum()
+{
+}
+
+void RFrustum::SetByViewProjection(const D3DXMATRIX& m)
+{
+	m_aryPlanes[EFP_Left]	= D3DXPLANE(m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41);
+	m_aryPlanes[EFP_Right]	= D3DXPLANE(m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41);
+	m_aryPlanes[EFP_Bottom]	= D3DXPLANE(m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42);
+	m_aryPlanes[EFP_Top]	= D3DXPLANE(m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42);
+	m_aryPlanes[EFP_Near]	= D3DXPLANE(m._13,         m._23,         m._33,         m._43);
+	m_aryPlanes[EFP_Far]	= D3DXPLANE(m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43);
+
+	// ƽҪλΧ뾶ƽıȽû
+	for (D3DXPLANE& plane : m_aryPlanes)
+	{
+		D3DXPlaneNormalize(&plane, &plane);
+	}
+}
+
+bool RFrustum::IsVisible(const RBounds& bounds) const
+{
+	for (const D3DXPLANE& plane : m_aryPlanes)
+	{
+		// ˳SSE 汾һ£֤汾Ľȫͬ
+		float f32Distance = (bounds.center.x * plane.a + bounds.center.y * plane.b) + (bounds.center.z * plane.c + plane.d);
+		float f32BoxRadius = (bounds.extents.x * fabsf(plane.a) + bounds.extents.y * fabsf(plane.b)) + bounds.extents.z * fabsf(plane.c);
+		float f32Radius = bounds.f32Radius < f32BoxRadius ? bounds.f32Radius : f32BoxRadius;
+
+		if (f32Distance < -f32Radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+RFrustum::EIntersection RFrustum::Classify(const D3DXVECTOR3& center, const D3DXVECTOR3& extents) const
+{
+	EIntersection result = EI_Inside;
+
+	for (const D3DXPLANE& plane : m_aryPlanes)
+	{
+		float f32Distance = (center.x * plane.a + center.y * plane.b) + (center.z * plane.c + plane.d);
+		float f32BoxRadius = (extents.x * fabsf(plane.a) + extents.y * fabsf(plane.b)) + extents.z * fabsf(plane.c);
+
+		if (f32Distance < -f32BoxRadius)
+		{
+			return EI_Outside;
+		}
+
+		if (f32Distance < f32BoxRadius)
+		{
+			result = EI_Intersect;
+		}
+	}
+
+	return result;
+}
+
+unsigned int RFrustum::CullBatch(const BoundsBatch& batch, unsigned char* aryVisible) const
+{
+	const unsigned int u32Count = batch.GetCount();
+	unsigned int u32Index = 0;
+	unsigned int u32VisibleCount = 0;
+
+#if RWGE_SIMD_SSE
+	const float* aryCenterX = batch.vecCenterX.data();
+	const float* aryCenterY = batch.vecCenterY.data();
+	const float* aryCenterZ = batch.vecCenterZ.data();
+	const float* aryRadius	= batch.vecRadius.data();
+	const float* aryExtentX = batch.vecExtentX.data();
+	const float* aryExtentY = batch.vecExtentY.data();
+	const float* aryExtentZ = batch.vecExtentZ.data();
+
+	// ÿβ4Χ壬ʣ಻4Ĳֽ汾
+	for (; u32Index + 4 <= u32Count; u32Index += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(aryCenterX + u32Index);
+		__m128 centerY = _mm_loadu_ps(aryCenterY + u32Index);
+		__m128 centerZ = _mm_loadu_ps(aryCenterZ + u32Index);
+		__m128 radius  = _mm_loadu_ps(aryRadius  + u32Index);
+		__m128 extentX = _mm_loadu_ps(aryExtentX + u32Index);
+		__m128 extentY = _mm_loadu_ps(aryExtentY + u32Index);
+		__m128 extentZ = _mm_loadu_ps(aryExtentZ + u32Index);
+
+		__m128 outside = _mm_setzero_ps();
+
+		for (const D3DXPLANE& plane : m_aryPlanes)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.a)), _mm_mul_ps(centerY, _mm_set1_ps(plane.b))),
+				_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.c)), _mm_set1_ps(plane.d)));
+
+			__m128 boxRadius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(fabsf(plane.a))), _mm_mul_ps(extentY, _mm_set1_ps(fabsf(plane.b)))),
+				_mm_mul_ps(extentZ, _mm_set1_ps(fabsf(plane.c))));
+
+			__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_min_ps(radius, boxRadius));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int s32OutsideMask = _mm_movemask_ps(outside);
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			unsigned char u8Visible = ((s32OutsideMask >> i) & 1) ^ 1;
+			aryVisible[u32Index + i] = u8Visible;
+			u32VisibleCount += u8Visible;
+		}
+	}
+#endif
+
+	return u32VisibleCount + CullBatchScalar(batch, u32Index, aryVisible);
+}
+
+unsigned int RFrustum::CullBatchScalar(const BoundsBatch& batch, unsigned int u32Begin, unsigned char* aryVisible) const
+{
+	const unsigned int u32Count = batch.GetCount();
+	unsigned int u32VisibleCount = 0;
+
+	for (unsigned int u32Index = u32Begin; u32Index < u32Count; ++u32Index)
+	{
+		RBounds bounds(
+			D3DXVECTOR3(batch.vecCenterX[u32Index], batch.vecCenterY[u32Index], batch.vecCenterZ[u32Index]),
+			D3DXVECTOR3(batch.vecExtentX[u32Index], batch.vecExtentY[u32Index], batch.vecExtentZ[u32Index]),
+			batch.vecRadius[u32Index]);
+
+		unsigned char u8Visible = IsVisible(bounds) ? 1 : 0;
+		aryVisible[u32Index] = u8Visible;
+		u32VisibleCount += u8Visible;
+	}
+
+	return u32VisibleCount;
+}
@@ -176,7 +176,7 @@ RQuaternion& RQuaternion::Normalise()
 	return *this;
 }
 
-D3DXVECTOR3&& RQuaternion::RotateVector(const D3DXVECTOR3& vector) const
+D3DXVECTOR3 RQuaternion::RotateVector(const D3DXVECTOR3& vector) const
 {
 	D3DXVECTOR3 uv;
 	D3DXVECTOR3 uuv;
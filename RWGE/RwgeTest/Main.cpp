@@ -0,0 +1,75 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <cstdio>
+#include <RwgeApplication.h>
+#include <RwgeD3d9RenderSystem.h>
+
+namespace
+{
+	struct TestEntry
+	{
+		const char* pName;
+		RTestRegistry::TestFunction pFunction;
+	};
+
+	// עᷢھ̬ʼ׶Σʹúڵľ̬ʼ˳
+	std::vector<TestEntry>& GetTestEntries()
+	{
+		static std::vector<TestEntry> vecEntries;
+		return vecEntries;
+	}
+
+	unsigned int s_u32CurrentFailureCount = 0;
+	RD3d9RenderTarget* s_pRenderTarget = nullptr;
+}
+
+void RTestRegistry::RegisterTest(const char* pName, TestFunction pFunction)
+{
+	TestEntry entry = { pName, pFunction };
+	GetTestEntries().push_back(entry);
+}
+
+void RTestRegistry::ReportFailure(const char* pFile, int s32Line, const char* pExpression)
+{
+	printf("  %s(%d) : check failed : %s\n", pFile, s32Line, pExpression);
+	++s_u32CurrentFailureCount;
+}
+
+int RTestRegistry::RunAllTests()
+{
+	int s32FailedCount = 0;
+
+	for (const TestEntry& entry : GetTestEntries())
+	{
+		s_u32CurrentFailureCount = 0;
+		entry.pFunction();
+
+		printf("[%s] %s\n", s_u32CurrentFailureCount == 0 ? "PASSED" : "FAILED", entry.pName);
+		if (s_u32CurrentFailureCount > 0)
+		{
+			++s32FailedCount;
+		}
+	}
+
+	printf("%d of %u tests failed.\n", s32FailedCount, static_cast<unsigned int>(GetTestEntries().size()));
+
+	return s32FailedCount;
+}
+
+RD3d9RenderTarget* RTestRegistry::GetRenderTarget()
+{
+	return s_pRenderTarget;
+}
+
+int main()
+{
+	// RApplicationRenderSystemǵֻܴһΣвԹͬһӦóͷȾĿ
+	RApplication::AppDelegate appDelegate;
+	RApplication::SetDelegate(&appDelegate);
+
+	RApplication application;
+	s_pRenderTarget = RD3d9RenderSystem::GetInstance().CreateHeadlessRenderTarget(320, 240);
+
+	return RTestRegistry::RunAllTests() == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "RwgeTest.h"
+
+#include <RwgeApplication.h>
+#include <RwgeD3d9RenderSystem.h>
+#include <RwgeD3d9RenderTarget.h>
+#include <RwgeSceneManager.h>
+#include <RwgeSceneNode.h>
+#include <RwgeCamera.h>
+#include <RwgeLight.h>
+
+namespace
+{
+	// ͷȾĿϵһ̬ΪȾĿĬ
+	struct StaticScene
+	{
+		RSceneManager*		pScene;
+		RCamera*			pCamera;
+		RDirectionalLight*	pLight;
+		RSceneNode*			pProp;
+
+		StaticScene()
+		{
+			pScene = new RSceneManager();
+			pCamera = new RCamera();
+			pLight = new RDirectionalLight();
+			pProp = new RSceneNode();
+			pScene->GetSceneRoot()->AttachChild(pCamera);
+			pScene->GetSceneRoot()->AttachChild(pLight);
+			pScene->GetSceneRoot()->AttachChild(pProp);
+			pScene->SetLight(pLight);
+			pCamera->SetPerspective(0.785f, 4.0f / 3.0f, 1.0f, 1000.0f);
+			pCamera->SetPosition(D3DXVECTOR3(0.0f, 0.0f, -10.0f));
+			RTestRegistry::GetRenderTarget()->SetDefaultCamera(pCamera);
+		}
+
+		~StaticScene()
+		{
+			RTestRegistry::GetRenderTarget()->SetDefaultCamera(nullptr);
+			delete pScene->GetSceneRoot();
+			delete pCamera;
+			delete pLight;
+			delete pProp;
+			delete pScene;
+		}
+	};
+}
+
+// ERP_OnChange»ûиı֡Ⱦֻڵһֻ֮֡֡ۼ֡
+RWGE_TEST(Application_OnChangeSkipsStaticFrames)
+{
+	RApplication& application = RApplication::GetInstance();
+	RD3d9RenderSystem& renderSystem = RD3d9RenderSystem::GetInstance();
+	StaticScene scene;
+
+	application.SetRedrawPolicy(RApplication::ERP_OnChange);
+	const unsigned int u32InitialBuildCount = renderSystem.GetQueueBuildCount();
+	const unsigned int u32InitialSkippedCount = application.GetSkippedFrameCount();
+
+	application.RunFrames(1);
+	RWGE_CHECK(renderSystem.GetQueueBuildCount() - u32InitialBuildCount == 1);
+
+	for (unsigned int u32Frame = 1; u32Frame <= 100; ++u32Frame)
+	{
+		application.RunFrames(1);
+		RWGE_CHECK(renderSystem.GetQueueBuildCount() - u32InitialBuildCount == 1);
+		RWGE_CHECK(application.GetSkippedFrameCount() - u32InitialSkippedCount == u32Frame);
+	}
+
+	application.SetRedrawPolicy(RApplication::ERP_Always);
+}
+
+// RequestRedrawڵı任ı䶼ֻһ֡ؽһȾУ֮֡
+RWGE_TEST(Application_OnChangeRebuildsOnceAfterChange)
+{
+	RApplication& application = RApplication::GetInstance();
+	RD3d9RenderSystem& renderSystem = RD3d9RenderSystem::GetInstance();
+	StaticScene scene;
+
+	application.SetRedrawPolicy(RApplication::ERP_OnChange);
+	application.RunFrames(1);
+
+	unsigned int u32BuildCount = renderSystem.GetQueueBuildCount();
+	unsigned int u32SkippedCount = application.GetSkippedFrameCount();
+
+	application.RequestRedraw();
+	application.RunFrames(10);
+	RWGE_CHECK(renderSystem.GetQueueBuildCount() - u32BuildCount == 1);
+	RWGE_CHECK(application.GetSkippedFrameCount() - u32SkippedCount == 9);
+
+	u32BuildCount = renderSystem.GetQueueBuildCount();
+	u32SkippedCount = application.GetSkippedFrameCount();
+
+	scene.pProp->Translate(D3DXVECTOR3(1.0f, 0.0f, 0.0f));
+	application.RunFrames(10);
+	RWGE_CHECK(renderSystem.GetQueueBuildCount() - u32BuildCount == 1);
+	RWGE_CHECK(application.GetSkippedFrameCount() - u32SkippedCount == 9);
+
+	application.SetRedrawPolicy(RApplication::ERP_Always);
+}
@@ -0,0 +1,109 @@
+#include "RwgeTest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <RwgeCommandBuffer.h>
+#include <RwgeNullRenderDevice.h>
+
+// ļĸʽȡ32λĻȻD3DFMT_INDEX32ֻд尴16λ
+RWGE_TEST(CommandBuffer_LoadedIndexBuffersKeepTheirFormat)
+{
+	RNullRenderDevice& device = static_cast<RNullRenderDevice&>(RRenderDevice::GetInstance());
+	const TCHAR* szPath = TEXT("RwgeCommandBufferTest.rwcb");
+
+	IDirect3DIndexBuffer9* pIndex32Buffer = nullptr;
+	IDirect3DIndexBuffer9* pIndex16Buffer = nullptr;
+	IDirect3DIndexBuffer9* pWrittenBuffer = nullptr;
+	RWGE_CHECK(SUCCEEDED(device.CreateIndexBuffer(1024, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &pIndex32Buffer)));
+	RWGE_CHECK(SUCCEEDED(device.CreateIndexBuffer(1024, D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &pIndex16Buffer)));
+	RWGE_CHECK(SUCCEEDED(device.CreateIndexBuffer(1024, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &pWrittenBuffer)));
+
+	RCommandBuffer commandBuffer;
+	commandBuffer.SetIndices(pIndex32Buffer, D3DFMT_INDEX32);
+	commandBuffer.DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 3, 0, 1);
+	commandBuffer.SetIndices(pIndex16Buffer, D3DFMT_INDEX16);
+	commandBuffer.DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 3, 0, 1);
+	unsigned int* aryIndices = static_cast<unsigned int*>(commandBuffer.WriteIndexBuffer(pWrittenBuffer, 0, 3 * sizeof(unsigned int), 0));
+	aryIndices[0] = 0;
+	aryIndices[1] = 1;
+	aryIndices[2] = 2;
+	RWGE_CHECK(commandBuffer.SaveToFile(szPath));
+
+	RCommandBuffer loadedBuffer;
+	RWGE_CHECK(loadedBuffer.LoadFromFile(szPath, device));
+
+	const std::vector<IDirect3DIndexBuffer9*>& vecLoadedBuffers = loadedBuffer.GetLoadedIndexBuffers();
+	RWGE_CHECK(vecLoadedBuffers.size() == 3);
+	if (vecLoadedBuffers.size() == 3)
+	{
+		RWGE_CHECK(device.GetIndexBufferFormat(vecLoadedBuffers[0]) == D3DFMT_INDEX32);
+		RWGE_CHECK(device.GetIndexBufferFormat(vecLoadedBuffers[1]) == D3DFMT_INDEX16);
+		RWGE_CHECK(device.GetIndexBufferFormat(vecLoadedBuffers[2]) == D3DFMT_INDEX16);
+	}
+
+	device.ReleaseIndexBuffer(pIndex32Buffer);
+	device.ReleaseIndexBuffer(pIndex16Buffer);
+	device.ReleaseIndexBuffer(pWrittenBuffer);
+	remove("RwgeCommandBufferTest.rwcb");
+}
+
+namespace
+{
+	// ļʼu32Offsetֽڵ32λΪu32Valueλļĩβ
+	void PatchCommandFile(const TCHAR* szSourcePath, const TCHAR* szPath, unsigned int u32DataSize, size_t u32Offset, unsigned int u32Value)
+	{
+		std::ifstream sourceFile(szSourcePath, std::ios::in | std::ios::binary);
+		std::vector<char> vecFile((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+		sourceFile.close();
+
+		*reinterpret_cast<unsigned int*>(vecFile.data() + vecFile.size() - u32DataSize + u32Offset) = u32Value;
+
+		std::ofstream patchedFile(szPath, std::ios::out | std::ios::binary);
+		patchedFile.write(vecFile.data(), vecFile.size());
+	}
+}
+
+// 𻵵ļܱأСڲṹ塢ûа8ֽڶ롢ݳд뷶Χʱܾ
+RWGE_TEST(CommandBuffer_CorruptedFilesAreRejected)
+{
+	RNullRenderDevice& device = static_cast<RNullRenderDevice&>(RRenderDevice::GetInstance());
+	const TCHAR* szSourcePath = TEXT("RwgeCommandBufferSource.rwcb");
+	const TCHAR* szPath = TEXT("RwgeCommandBufferCorrupted.rwcb");
+
+	IDirect3DIndexBuffer9* pIndexBuffer = nullptr;
+	RWGE_CHECK(SUCCEEDED(device.CreateIndexBuffer(1024, D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &pIndexBuffer)));
+
+	// ֻһWriteIndexBufferֶΪֽ͡ƫơֽ
+	RCommandBuffer commandBuffer;
+	RwgeZeroMemory(commandBuffer.WriteIndexBuffer(pIndexBuffer, 0, 16, 0), 16);
+	RWGE_CHECK(commandBuffer.SaveToFile(szSourcePath));
+
+	const unsigned int u32DataSize = commandBuffer.GetDataSize();
+	const size_t u32SizeField = sizeof(unsigned int);
+	const size_t u32OffsetField = 2 * sizeof(unsigned int) + sizeof(void*);
+	const size_t u32DataSizeField = u32OffsetField + sizeof(unsigned int);
+
+	RCommandBuffer loadedBuffer;
+	RWGE_CHECK(loadedBuffer.LoadFromFile(szSourcePath, device));
+	RWGE_CHECK(loadedBuffer.GetCommandCount() == 1);
+
+	PatchCommandFile(szSourcePath, szPath, u32DataSize, u32SizeField, 8);
+	RWGE_CHECK(!loadedBuffer.LoadFromFile(szPath, device));
+
+	PatchCommandFile(szSourcePath, szPath, u32DataSize, u32SizeField, u32DataSize - 4);
+	RWGE_CHECK(!loadedBuffer.LoadFromFile(szPath, device));
+
+	PatchCommandFile(szSourcePath, szPath, u32DataSize, u32DataSizeField, 4096);
+	RWGE_CHECK(!loadedBuffer.LoadFromFile(szPath, device));
+
+	PatchCommandFile(szSourcePath, szPath, u32DataSize, u32OffsetField, 4096);
+	RWGE_CHECK(!loadedBuffer.LoadFromFile(szPath, device));
+
+	PatchCommandFile(szSourcePath, szPath, u32DataSize, u32OffsetField, 0xFFFFFFF8);
+	RWGE_CHECK(!loadedBuffer.LoadFromFile(szPath, device));
+
+	device.ReleaseIndexBuffer(pIndexBuffer);
+	remove("RwgeCommandBufferSource.rwcb");
+	remove("RwgeCommandBufferCorrupted.rwcb");
+}
@@ -0,0 +1,197 @@
+#include "RwgeTest.h"
+
+#include <deque>
+#include <vector>
+#include <RwgeFrameRingAllocator.h>
+#include <RwgeDynamicUploader.h>
+#include <RwgeNullRenderDevice.h>
+
+namespace
+{
+	/*
+	ģGPU Իλʹã¼ÿδɵ֡дķΧµķ䲻ǻǰ֮֡ǰķصDISCARD֮
+	һڴ棬֮ǰ֡ռû
+	*/
+	class RingModel
+	{
+	public:
+		struct Range
+		{
+			unsigned int	u32Begin;
+			unsigned int	u32End;
+		};
+
+		struct Frame
+		{
+			unsigned int		u32Fence;
+			std::vector<Range>	vecRanges;
+		};
+
+		RingModel(unsigned int u32Capacity) : m_u32Capacity(u32Capacity), m_u32FrameAllocationCount(0), m_u32FrameDiscardCount(0) {};
+
+		void CheckAllocation(unsigned int u32Offset, unsigned int u32Size, unsigned int u32Alignment, bool bDiscard)
+		{
+			RWGE_CHECK(u32Offset % u32Alignment == 0);
+			RWGE_CHECK(u32Offset + u32Size <= m_u32Capacity);
+
+			if (bDiscard)
+			{
+				RWGE_CHECK(m_u32FrameAllocationCount == 0);
+				++m_u32FrameDiscardCount;
+				m_deqFrames.clear();
+			}
+
+			const Range range = { u32Offset, u32Offset + u32Size };
+			for (const Frame& frame : m_deqFrames)
+			{
+				for (const Range& inFlight : frame.vecRanges)
+				{
+					RWGE_CHECK(range.u32End <= inFlight.u32Begin || range.u32Begin >= inFlight.u32End);
+				}
+			}
+			for (const Range& current : m_CurrentFrame.vecRanges)
+			{
+				RWGE_CHECK(range.u32End <= current.u32Begin || range.u32Begin >= current.u32End);
+			}
+
+			m_CurrentFrame.vecRanges.push_back(range);
+			++m_u32FrameAllocationCount;
+		}
+
+		FORCE_INLINE bool IsFirstAllocation() const { return m_u32FrameAllocationCount == 0; };
+
+		void EndFrame(unsigned int u32Fence)
+		{
+			RWGE_CHECK(m_u32FrameDiscardCount <= 1);
+
+			m_CurrentFrame.u32Fence = u32Fence;
+			m_deqFrames.push_back(m_CurrentFrame);
+			m_CurrentFrame.vecRanges.clear();
+			m_u32FrameAllocationCount = 0;
+			m_u32FrameDiscardCount = 0;
+		}
+
+		void Retire(unsigned int u32CompletedFence)
+		{
+			while (!m_deqFrames.empty() && static_cast<int>(m_deqFrames.front().u32Fence - u32CompletedFence) <= 0)
+			{
+				m_deqFrames.pop_front();
+			}
+		}
+
+	private:
+		unsigned int		m_u32Capacity;
+		unsigned int		m_u32FrameAllocationCount;
+		unsigned int		m_u32FrameDiscardCount;
+		Frame				m_CurrentFrame;
+		std::deque<Frame>	m_deqFrames;
+	};
+}
+
+// ĴСGPU ӳ٣Χֵƣ䲻δɵ֡صÿ֡DISCARDһβֻڵһη
+RWGE_TEST(FrameRingAllocator_RandomFramesNeverOverlapInFlightRanges)
+{
+	const unsigned int u32Capacity = 256 * 1024;
+	RFrameRingAllocator ringAllocator(u32Capacity);
+	RingModel model(u32Capacity);
+	RTestRandom random(2016);
+
+	unsigned int u32Fence = 0xFFFFFF00;
+	unsigned int u32DiscardCount = 0;
+
+	for (unsigned int u32Frame = 0; u32Frame < 2000; ++u32Frame)
+	{
+		// ÿ100֡һGPU ֡
+		const unsigned int u32Latency = (u32Frame / 100) % 4;
+		const unsigned int u32AllocationCount = random.NextUInt() % 12;
+
+		for (unsigned int i = 0; i < u32AllocationCount; ++i)
+		{
+			const unsigned int u32Size = 1 + random.NextUInt() % (random.NextUInt() % 16 == 0 ? u32Capacity / 2 : u32Capacity / 32);
+			const unsigned int u32Alignment = 1 + random.NextUInt() % 64;
+			const bool bFirstAllocation = model.IsFirstAllocation();
+
+			RingAllocation allocation;
+			if (ringAllocator.Allocate(u32Size, u32Alignment, allocation))
+			{
+				RWGE_CHECK(allocation.u32Size == u32Size);
+				model.CheckAllocation(allocation.u32Offset, allocation.u32Size, u32Alignment, allocation.bDiscard);
+				u32DiscardCount += allocation.bDiscard ? 1 : 0;
+			}
+			else
+			{
+				// ֡ĵһηͨDISCARDõռ
+				RWGE_CHECK(!bFirstAllocation);
+			}
+		}
+
+		RWGE_CHECK(ringAllocator.GetDiscardCount() == u32DiscardCount);
+		RWGE_CHECK(ringAllocator.GetUsedSize() <= u32Capacity);
+
+		++u32Fence;
+		ringAllocator.EndFrame(u32Fence);
+		model.EndFrame(u32Fence);
+
+		ringAllocator.Retire(u32Fence - u32Latency);
+		model.Retire(u32Fence - u32Latency);
+	}
+
+	// ΧֵѾƣзDISCARDGPU ֡λȫͷ
+	RWGE_CHECK(u32Fence < 0xFFFFFF00);
+	RWGE_CHECK(u32DiscardCount > 0);
+	ringAllocator.Retire(u32Fence);
+	RWGE_CHECK(ringAllocator.GetUsedSize() == 0 && ringAllocator.GetInFlightFrameCount() == 0);
+}
+
+// DynamicUploaderNullRenderDeviceģGPU ӳʹͬĹDISCARDֻһ֡ĵһд
+RWGE_TEST(DynamicUploader_FenceLatencyNeverOverlapsInFlightRanges)
+{
+	RNullRenderDevice& device = static_cast<RNullRenderDevice&>(RRenderDevice::GetInstance());
+	RDynamicUploader& uploader = RDynamicUploader::GetInstance();
+	const RFrameRingAllocator& vertexRing = uploader.GetVertexRing();
+
+	// ͷ֮ǰȾµ֡ʹģ뻷λͬ״̬ʼ
+	device.SetFenceLatency(0);
+	uploader.EndFrame(device);
+	RWGE_CHECK(vertexRing.GetUsedSize() == 0);
+
+	RingModel model(uploader.GetVertexBufferSize());
+	RTestRandom random(7);
+	unsigned int u32Fence = device.GetCompletedFrameFence();
+	const unsigned int u32InitialDiscardCount = vertexRing.GetDiscardCount();
+
+	for (unsigned int u32Frame = 0; u32Frame < 48; ++u32Frame)
+	{
+		const unsigned int u32Latency = (u32Frame / 12) % 4;
+		device.SetFenceLatency(u32Latency);
+
+		const unsigned int u32WriteCount = 1 + random.NextUInt() % 6;
+		for (unsigned int i = 0; i < u32WriteCount; ++i)
+		{
+			const unsigned int u32Size = 1 + random.NextUInt() % (uploader.GetVertexBufferSize() / 8);
+			const unsigned int u32Alignment = 4 * (1 + random.NextUInt() % 16);		// 㲽
+			const unsigned int u32DiscardCount = vertexRing.GetDiscardCount();
+			const bool bFirstAllocation = model.IsFirstAllocation();
+
+			unsigned int u32Offset = 0;
+			if (uploader.WriteVertices(u32Size, u32Alignment, u32Offset) != nullptr)
+			{
+				model.CheckAllocation(u32Offset, u32Size, u32Alignment, vertexRing.GetDiscardCount() != u32DiscardCount);
+			}
+			else
+			{
+				RWGE_CHECK(!bFirstAllocation);
+			}
+		}
+
+		uploader.EndFrame(device);
+		model.EndFrame(++u32Fence);
+		model.Retire(device.GetCompletedFrameFence());
+	}
+
+	RWGE_CHECK(vertexRing.GetDiscardCount() > u32InitialDiscardCount);
+
+	device.SetFenceLatency(0);
+	uploader.EndFrame(device);
+	RWGE_CHECK(vertexRing.GetUsedSize() == 0);
+}
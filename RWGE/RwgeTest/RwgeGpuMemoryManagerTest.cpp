@@ -0,0 +1,169 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <algorithm>
+#include <RwgeTlsfAllocator.h>
+#include <RwgeGpuMemoryManager.h>
+#include <RwgeVertexStream.h>
+
+namespace
+{
+	bool CompareOffset(const TlsfAllocation& a, const TlsfAllocation& b)
+	{
+		return a.u32Offset < b.u32Offset;
+	}
+
+	/*
+	ƫдķ䣺ص롢λ֮ڣôСппƬʶɷ֮
+	϶пϲÿο϶һп
+	*/
+	void CheckAllocator(const RTlsfAllocator& allocator, std::vector<TlsfAllocation> vecAllocations)
+	{
+		std::sort(vecAllocations.begin(), vecAllocations.end(), CompareOffset);
+
+		unsigned int u32UsedSize = 0;
+		unsigned int u32FreeBlockCount = 0;
+		unsigned int u32LargestFreeBlock = 0;
+		unsigned int u32End = 0;
+
+		for (const TlsfAllocation& allocation : vecAllocations)
+		{
+			RWGE_CHECK(allocation.u32Offset % allocator.GetAlignment() == 0 && allocation.u32Size % allocator.GetAlignment() == 0);
+			RWGE_CHECK(allocation.u32Offset >= u32End);
+			RWGE_CHECK(allocation.u32Offset + allocation.u32Size <= allocator.GetCapacity());
+
+			if (allocation.u32Offset > u32End)
+			{
+				++u32FreeBlockCount;
+				u32LargestFreeBlock = std::max(u32LargestFreeBlock, allocation.u32Offset - u32End);
+			}
+
+			u32UsedSize += allocation.u32Size;
+			u32End = allocation.u32Offset + allocation.u32Size;
+		}
+
+		if (allocator.GetCapacity() > u32End)
+		{
+			++u32FreeBlockCount;
+			u32LargestFreeBlock = std::max(u32LargestFreeBlock, allocator.GetCapacity() - u32End);
+		}
+
+		const unsigned int u32FreeSize = allocator.GetCapacity() - u32UsedSize;
+		const float f32Fragmentation = u32FreeSize > 0 ? 1.0f - static_cast<float>(u32LargestFreeBlock) / u32FreeSize : 0.0f;
+
+		RWGE_CHECK(allocator.GetAllocationCount() == vecAllocations.size());
+		RWGE_CHECK(allocator.GetUsedSize() == u32UsedSize);
+		RWGE_CHECK(allocator.GetFreeSize() == u32FreeSize);
+		RWGE_CHECK(allocator.GetFreeBlockCount() == u32FreeBlockCount);
+		RWGE_CHECK(allocator.GetLargestFreeBlock() == u32LargestFreeBlock);
+		RWGE_CHECK(allocator.GetFragmentation() == f32Fragmentation);
+	}
+}
+
+// ļжУ以صͳʵʵķһ£ȫͷźпռϲΪһ
+RWGE_TEST(TlsfAllocator_RandomTraceCoalescesBackToOneBlock)
+{
+	const unsigned int u32Capacity = 4 * 1024 * 1024;
+	RTlsfAllocator allocator(u32Capacity, 16);
+	RTestRandom random(2016);
+	std::vector<TlsfAllocation> vecAllocations;
+
+	for (unsigned int u32Step = 0; u32Step < 20000; ++u32Step)
+	{
+		// ǰһƫأһƫжأСӼֽڵ64KB
+		const unsigned int u32LoadChance = u32Step < 10000 ? 70 : 30;
+		if (vecAllocations.empty() || random.NextUInt() % 100 < u32LoadChance)
+		{
+			const unsigned int u32Size = 1 + random.NextUInt() % (random.NextUInt() % 8 == 0 ? 64 * 1024 : 2048);
+
+			TlsfAllocation allocation;
+			if (allocator.Allocate(u32Size, allocation))
+			{
+				RWGE_CHECK(allocation.IsValid() && allocation.u32Size >= u32Size && allocation.u32Size - u32Size < 16);
+				vecAllocations.push_back(allocation);
+			}
+			else
+			{
+				RWGE_CHECK(!allocation.IsValid());
+			}
+		}
+		else
+		{
+			const unsigned int u32Index = random.NextUInt() % vecAllocations.size();
+			allocator.Free(vecAllocations[u32Index]);
+			RWGE_CHECK(!vecAllocations[u32Index].IsValid());
+
+			vecAllocations[u32Index] = vecAllocations.back();
+			vecAllocations.pop_back();
+		}
+
+		if (u32Step % 256 == 0)
+		{
+			CheckAllocator(allocator, vecAllocations);
+		}
+	}
+
+	CheckAllocator(allocator, vecAllocations);
+
+	while (!vecAllocations.empty())
+	{
+		allocator.Free(vecAllocations.back());
+		vecAllocations.pop_back();
+	}
+
+	CheckAllocator(allocator, vecAllocations);
+	RWGE_CHECK(allocator.IsEmpty());
+	RWGE_CHECK(allocator.GetFreeBlockCount() == 1);
+	RWGE_CHECK(allocator.GetLargestFreeBlock() == u32Capacity);
+	RWGE_CHECK(allocator.GetFragmentation() == 0.0f);
+
+	// ϲԱһη
+	TlsfAllocation wholeAllocation;
+	RWGE_CHECK(allocator.Allocate(u32Capacity, wholeAllocation) && wholeAllocation.u32Offset == 0);
+	allocator.Free(wholeAllocation);
+}
+
+// һҳᴴµҳжغеҳͷţҳСʹõҳ
+RWGE_TEST(GpuMemoryManager_EmptyPagesAreReleased)
+{
+	RGpuMemoryManager& gpuMemoryManager = RGpuMemoryManager::GetInstance();
+	const GpuMemoryStatistics initialStatistics = gpuMemoryManager.GetStatistics(EGBT_Vertex);
+
+	// ÿ1MBĬϵҳСΪ4MB
+	const unsigned int u32StreamCount = 24;
+	std::vector<unsigned char> vecVertices(16 * 65536);
+	std::vector<VertexStream> vecStreams(u32StreamCount, VertexStream(16, 65536, vecVertices.data()));
+	std::vector<GpuAllocation> vecAllocations(u32StreamCount + 1);
+
+	for (unsigned int i = 0; i < u32StreamCount; ++i)
+	{
+		RWGE_CHECK(gpuMemoryManager.BindVertexStream(&vecStreams[i], vecAllocations[i]));
+	}
+
+	std::vector<unsigned char> vecLargeVertices(16 * 400000);
+	VertexStream largeStream(16, 400000, vecLargeVertices.data());
+	RWGE_CHECK(gpuMemoryManager.BindVertexStream(&largeStream, vecAllocations[u32StreamCount]));
+
+	const GpuMemoryStatistics loadedStatistics = gpuMemoryManager.GetStatistics(EGBT_Vertex);
+	RWGE_CHECK(loadedStatistics.u32PageCount >= initialStatistics.u32PageCount + u32StreamCount / 4);
+	RWGE_CHECK(loadedStatistics.u32AllocationCount == initialStatistics.u32AllocationCount + u32StreamCount + 1);
+	RWGE_CHECK(loadedStatistics.u32UsedSize == initialStatistics.u32UsedSize + u32StreamCount * 16 * 65536 + 16 * 400000);
+
+	// ˳ж
+	RTestRandom random(7);
+	for (unsigned int i = u32StreamCount + 1; i > 1; --i)
+	{
+		std::swap(vecAllocations[i - 1], vecAllocations[random.NextUInt() % i]);
+	}
+	for (GpuAllocation& allocation : vecAllocations)
+	{
+		gpuMemoryManager.Free(allocation);
+		RWGE_CHECK(!allocation.IsValid());
+	}
+
+	// ÿֻٱһҳ
+	const GpuMemoryStatistics unloadedStatistics = gpuMemoryManager.GetStatistics(EGBT_Vertex);
+	RWGE_CHECK(unloadedStatistics.u32PageCount == std::max(initialStatistics.u32PageCount, 1u));
+	RWGE_CHECK(unloadedStatistics.u32AllocationCount == initialStatistics.u32AllocationCount);
+	RWGE_CHECK(unloadedStatistics.u32UsedSize == initialStatistics.u32UsedSize);
+}
@@ -0,0 +1,109 @@
+#include "RwgeTest.h"
+
+#include <string.h>
+#include <vector>
+#include <RwgeOcclusionBuffer.h>
+
+namespace
+{
+	// λԭ㿴+Z۲Ϊλ󣬽ƽ0.1Զƽ100
+	D3DXMATRIX CreateViewProj()
+	{
+		D3DXMATRIX proj;
+		D3DXMatrixPerspectiveFovLH(&proj, D3DX_PI / 3.0f, 2.0f, 0.1f, 100.0f);
+		return proj;
+	}
+
+	// λZ = 10Ļǽ
+	const float aryWallPositions[] =
+	{
+		-30.0f, -30.0f, 10.0f,
+		-30.0f,  30.0f, 10.0f,
+		 30.0f,  30.0f, 10.0f,
+		 30.0f, -30.0f, 10.0f,
+	};
+	const unsigned short aryWallIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+	// ǽһդΣһƽཻڸǲü벿ָǵ
+	std::vector<float> CreateRandomTriangles(unsigned int u32Seed, unsigned int u32TriangleCount)
+	{
+		std::vector<float> vecPositions;
+		unsigned int u32State = u32Seed;
+		for (unsigned int i = 0; i < u32TriangleCount * 3 * 3; ++i)
+		{
+			u32State = u32State * 1664525 + 1013904223;
+			const float f32Random = ((u32State >> 8) & 0xFFFF) / 65535.0f;
+			switch (i % 3)
+			{
+			case 0:		vecPositions.push_back(-12.0f + 24.0f * f32Random);	break;
+			case 1:		vecPositions.push_back(-6.0f + 12.0f * f32Random);	break;
+			default:	vecPositions.push_back(-2.0f + 11.0f * f32Random);	break;
+			}
+		}
+		return vecPositions;
+	}
+
+	bool IsBoxOccluded(const ROcclusionBuffer& occlusionBuffer, float x, float y, float z0, float z1)
+	{
+		return occlusionBuffer.IsOccluded(D3DXVECTOR3(x - 0.25f, y - 0.25f, z0), D3DXVECTOR3(x + 0.25f, y + 0.25f, z1));
+	}
+}
+
+// ǽĺӱڵǽǰƽཻĺǿɼ
+RWGE_TEST(OcclusionBuffer_WallOccludesBoxesBehindIt)
+{
+	D3DXMATRIX world;
+	D3DXMatrixIdentity(&world);
+
+	ROcclusionBuffer occlusionBuffer;
+	occlusionBuffer.BeginFrame(CreateViewProj());
+	occlusionBuffer.AddOccluder(aryWallPositions, 4, sizeof(float) * 3, aryWallIndices, sizeof(unsigned short), 2, world);
+	occlusionBuffer.Rasterize();
+	RWGE_CHECK(occlusionBuffer.GetRasterizedTriangleCount() == 2);
+
+	for (int y = -2; y <= 2; ++y)
+	{
+		for (int x = -2; x <= 2; ++x)
+		{
+			RWGE_CHECK(IsBoxOccluded(occlusionBuffer, x * 1.5f, y * 1.5f, 15.0f, 16.0f));
+			RWGE_CHECK(!IsBoxOccluded(occlusionBuffer, x * 1.5f, y * 1.5f, 5.0f, 6.0f));
+			RWGE_CHECK(!IsBoxOccluded(occlusionBuffer, x * 1.5f, y * 1.5f, -1.0f, 20.0f));
+		}
+	}
+}
+
+// SSE դõȫͬȻڵ
+RWGE_TEST(OcclusionBuffer_SimdMatchesScalar)
+{
+	D3DXMATRIX world;
+	D3DXMatrixIdentity(&world);
+	const D3DXMATRIX viewProj = CreateViewProj();
+
+	ROcclusionBuffer simdBuffer;
+	ROcclusionBuffer scalarBuffer;
+	scalarBuffer.SetSimdEnabled(false);
+
+	for (unsigned int u32Seed = 1; u32Seed <= 8; ++u32Seed)
+	{
+		const std::vector<float> vecTriangles = CreateRandomTriangles(u32Seed, 256);
+		ROcclusionBuffer* aryBuffers[] = { &simdBuffer, &scalarBuffer };
+		for (ROcclusionBuffer* pBuffer : aryBuffers)
+		{
+			pBuffer->BeginFrame(viewProj);
+			pBuffer->AddOccluder(aryWallPositions, 4, sizeof(float) * 3, aryWallIndices, sizeof(unsigned short), 2, world);
+			pBuffer->AddOccluder(vecTriangles.data(), 256 * 3, sizeof(float) * 3, nullptr, sizeof(unsigned short), 256, world);
+			pBuffer->Rasterize();
+		}
+
+		RWGE_CHECK(simdBuffer.GetRasterizedTriangleCount() == scalarBuffer.GetRasterizedTriangleCount());
+		RWGE_CHECK(memcmp(simdBuffer.GetDepthBuffer(), scalarBuffer.GetDepthBuffer(), simdBuffer.GetWidth() * simdBuffer.GetHeight() * sizeof(float)) == 0);
+
+		for (int z = 2; z <= 12; z += 2)
+		{
+			for (int x = -4; x <= 4; ++x)
+			{
+				RWGE_CHECK(IsBoxOccluded(simdBuffer, x * 1.5f, 0.0f, z, z + 1.0f) == IsBoxOccluded(scalarBuffer, x * 1.5f, 0.0f, z, z + 1.0f));
+			}
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <cstdlib>
+#include <RwgeThreadPool.h>
+#include <RwgeD3d9RenderSystem.h>
+#include <RwgeD3d9RenderQueue.h>
+#include <RwgeSceneManager.h>
+#include <RwgeSceneNode.h>
+#include <RwgeCamera.h>
+#include <RwgeLight.h>
+#include <RwgeModel.h>
+#include <RwgeMesh.h>
+#include <RwgeModelFactory.h>
+#include <RwgeMaterialFactory.h>
+
+using namespace std;
+
+namespace
+{
+	const unsigned int u32InitialModelCount = 4096;
+	const unsigned int u32FrameCount = 12;
+	const unsigned int u32ChangedModelCount = 64;		// ÿ֡ɾ滻ʵģ
+	const unsigned int u32WorkerCount = 3;				// ˵ĻҲִ̣֤߳в·
+
+	float RandomFloat(float f32Min, float f32Max)
+	{
+		return f32Min + (f32Max - f32Min) * (rand() / static_cast<float>(RAND_MAX));
+	}
+
+	RModel* CreateModel(RModel* pSourceModel, RSceneManager* pScene)
+	{
+		RModel* pModel = ModelFactory::CloneModel(pSourceModel);
+		pModel->SetPosition(D3DXVECTOR3(RandomFloat(-300.0f, 300.0f), RandomFloat(-300.0f, 300.0f), RandomFloat(-300.0f, 300.0f)));
+		pScene->GetSceneRoot()->AttachChild(pModel);
+
+		return pModel;
+	}
+
+	// Ⱦеύ˳ͬ±Ҳͬͬ˳
+	bool HasSameSubmitOrder(const RD3d9RenderQueue& serialQueue, const RD3d9RenderQueue& parallelQueue)
+	{
+		const vector<DrawSortKey>& vecSerialKeys = serialQueue.GetSortKeys();
+		const vector<DrawSortKey>& vecParallelKeys = parallelQueue.GetSortKeys();
+
+		if (vecSerialKeys.size() != vecParallelKeys.size())
+		{
+			return false;
+		}
+
+		for (unsigned int i = 0; i < vecSerialKeys.size(); ++i)
+		{
+			if (vecSerialKeys[i].u64SortKey != vecParallelKeys[i].u64SortKey || vecSerialKeys[i].u32DrawItem != vecParallelKeys[i].u32DrawItem)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+// йǲοʵ֣йύ˳ȫͬģɺд²ʱ
+// пɼҪʣƶʹģ½׶壬вͨ·鲢ϲ
+RWGE_TEST(RenderQueue_ParallelBuildMatchesSerialBuild)
+{
+	RD3d9RenderSystem& renderSystem = RD3d9RenderSystem::GetInstance();
+	RThreadPool& threadPool = RThreadPool::GetInstance();
+	const unsigned int u32DefaultWorkerCount = threadPool.GetWorkerCount();
+	srand(1);
+
+	RD3d9RenderQueue* pSerialQueue = renderSystem.CreateRenderQueue();
+	RD3d9RenderQueue* pParallelQueue = renderSystem.CreateRenderQueue();
+	pSerialQueue->SetParallelBuildEnabled(false);
+	pParallelQueue->SetParallelBuildEnabled(true);
+
+	RSceneManager* pScene = new RSceneManager();
+	RCamera* pCamera = new RCamera();
+	RDirectionalLight* pLight = new RDirectionalLight();
+	pScene->GetSceneRoot()->AttachChild(pCamera);
+	pScene->GetSceneRoot()->AttachChild(pLight);
+	pScene->SetLight(pLight);
+	pCamera->SetPerspective(0.785f, 4.0f / 3.0f, 1.0f, 2000.0f);
+	pCamera->SetPosition(D3DXVECTOR3(0.0f, 0.0f, -800.0f));
+
+	// ֮һģʹһֲʣжɫ
+	RModel* pSourceModel = ModelFactory::CreateBox();
+	RMaterial* pWhiteMaterial = MaterialFactory::CreateWhiteMaterial();
+	vector<RModel*> vecModels;
+
+	for (unsigned int i = 0; i < u32InitialModelCount; ++i)
+	{
+		RModel* pModel = CreateModel(pSourceModel, pScene);
+		if (i % 3 == 0)
+		{
+			pModel->GetMeshes().front()->SetMaterial(pWhiteMaterial);
+		}
+		vecModels.push_back(pModel);
+	}
+
+	// зֱʹԼͼڵ޳ĽụӰ
+	SceneView serialView;
+	SceneView parallelView;
+	serialView.pCamera = pCamera;
+	parallelView.pCamera = pCamera;
+
+	for (unsigned int u32Frame = 0; u32Frame < u32FrameCount; ++u32Frame)
+	{
+		for (unsigned int i = 0; i < vecModels.size() / 10; ++i)
+		{
+			vecModels[rand() % vecModels.size()]->Translate(D3DXVECTOR3(RandomFloat(-5.0f, 5.0f), RandomFloat(-5.0f, 5.0f), RandomFloat(-5.0f, 5.0f)));
+		}
+		pCamera->SetPosition(D3DXVECTOR3((u32Frame % 4) * 150.0f - 225.0f, 0.0f, -800.0f));
+
+		const bool bAddModels = u32Frame % 3 == 1;
+		if (bAddModels)
+		{
+			for (unsigned int i = 0; i < u32ChangedModelCount; ++i)
+			{
+				vecModels.push_back(CreateModel(pSourceModel, pScene));
+			}
+		}
+		else if (u32Frame % 3 == 2)
+		{
+			RMaterial* pNewMaterial = MaterialFactory::CreateMetalBoxMaterial();
+			for (unsigned int i = 0; i < u32ChangedModelCount; ++i)
+			{
+				vecModels[rand() % vecModels.size()]->GetMeshes().front()->SetMaterial(pNewMaterial);
+			}
+		}
+		else if (u32Frame > 0)
+		{
+			for (unsigned int i = 0; i < u32ChangedModelCount; ++i)
+			{
+				unsigned int u32Model = rand() % vecModels.size();
+				delete vecModels[u32Model];
+				vecModels[u32Model] = vecModels.back();
+				vecModels.pop_back();
+			}
+		}
+
+		pScene->BeginFrame();
+
+		// ر̳߳عοٿ̳߳زй
+		threadPool.SetWorkerCount(0);
+		pScene->CullView(serialView);
+		pScene->BuildViewQueue(serialView, nullptr, *pSerialQueue);
+		pSerialQueue->Sort();
+
+		threadPool.SetWorkerCount(u32WorkerCount);
+		pScene->CullView(parallelView);
+		pScene->BuildViewQueue(parallelView, nullptr, *pParallelQueue);
+		pParallelQueue->Sort();
+
+		RWGE_CHECK(pSerialQueue->GetDrawItemCount() > 0);
+		RWGE_CHECK(HasSameSubmitOrder(*pSerialQueue, *pParallelQueue));
+
+		const RenderQueueStatistics& statistics = pParallelQueue->GetStatistics();
+		RWGE_CHECK(pSerialQueue->GetStatistics().u32BuildTaskCount == 0);
+		RWGE_CHECK(statistics.u32BuildTaskCount >= 2);
+		RWGE_CHECK(!bAddModels || statistics.u32DeferredModelCount > 0);
+	}
+
+	threadPool.SetWorkerCount(u32DefaultWorkerCount);
+	renderSystem.ReleaseRenderQueue(pSerialQueue);
+	renderSystem.ReleaseRenderQueue(pParallelQueue);
+
+	delete pScene->GetSceneRoot();
+	for (RModel* pModel : vecModels)
+	{
+		delete pModel;
+	}
+	delete pCamera;
+	delete pLight;
+	delete pSourceModel;
+	delete pScene;
+}
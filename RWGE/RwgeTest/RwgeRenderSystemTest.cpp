@@ -0,0 +1,166 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <RwgeD3d9RenderSystem.h>
+#include <RwgeD3d9RenderTarget.h>
+#include <RwgeD3d9RenderQueue.h>
+#include <RwgeDynamicUploader.h>
+#include <RwgeSceneManager.h>
+#include <RwgeSceneNode.h>
+#include <RwgeCamera.h>
+#include <RwgeModel.h>
+#include <RwgeMesh.h>
+#include <RwgeRenderUnit.h>
+#include <RwgeVertexStream.h>
+#include <RwgeIndexStream.h>
+#include <RwgeModelFactory.h>
+#include <RwgeMaterialFactory.h>
+#include <RwgeD3d9VertexDeclaration.h>
+#include <RwgeVertexDeclarationManager.h>
+
+using namespace std;
+
+namespace
+{
+	// ModelFactory֮һĶǶ̬ģÿλƶu32VertexCountд뻷λ壻
+	// Ķһͬ
+	RModel* CreateDynamicTriangle(unsigned int u32VertexCount)
+	{
+		RD3d9VertexDeclaration* pDeclaration = RVertexDeclarationManager::GetInstance().GetDefaultVertexDeclaration();
+		const unsigned int u32VertexSize = pDeclaration->GetVertexSize();
+
+		unsigned char* aryVertices = new unsigned char[u32VertexSize * u32VertexCount]();
+		const D3DXVECTOR3 aryCorners[3] = { D3DXVECTOR3(0.0f, 0.0f, 0.0f), D3DXVECTOR3(0.0f, 1.0f, 0.0f), D3DXVECTOR3(1.0f, 1.0f, 0.0f) };
+		for (unsigned int i = 0; i < u32VertexCount; ++i)
+		{
+			memcpy(aryVertices + i * u32VertexSize + pDeclaration->GetPositionOffset(), &aryCorners[i < 3 ? i : 0], sizeof(D3DXVECTOR3));
+		}
+
+		unsigned short* aryIndices = new unsigned short[3];
+		aryIndices[0] = 0;
+		aryIndices[1] = 1;
+		aryIndices[2] = 2;
+
+		RRenderUnit* pRenderUnit = new RRenderUnit();
+		pRenderUnit->SetVertexDeclaration(pDeclaration);
+		pRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
+		pRenderUnit->SetPrimitiveCount(1);
+		pRenderUnit->AddVertexStream(new VertexStream(u32VertexSize, u32VertexCount, aryVertices));
+		pRenderUnit->SetIndexStream(new IndexStream(3, aryIndices));
+		pRenderUnit->BindStreamToBuffer(1);
+
+		RMesh* pMesh = new RMesh();
+		pMesh->SetMaterial(MaterialFactory::CreateWoodenBoxMaterial());
+		pMesh->AddRenderUnit(pRenderUnit);
+
+		RModel* pModel = ModelFactory::CreateTriangle();
+		pModel->AddMesh(pMesh);
+
+		return pModel;
+	}
+
+	// Ⱦu32ModelCountͬһ̬εģͣԤȾDP
+	unsigned int RenderDynamicTriangles(unsigned int u32VertexCount, unsigned int u32ModelCount)
+	{
+		RD3d9RenderSystem& renderSystem = RD3d9RenderSystem::GetInstance();
+		RD3d9RenderTarget* pRenderTarget = RTestRegistry::GetRenderTarget();
+
+		RSceneManager* pScene = new RSceneManager();
+		pScene->SetOcclusionCullingEnabled(false);
+
+		RCamera* pCamera = new RCamera();
+		pScene->GetSceneRoot()->AttachChild(pCamera);
+		pCamera->SetPerspective(0.785f, 4.0f / 3.0f, 1.0f, 2000.0f);
+		pRenderTarget->SetDefaultCamera(pCamera);
+
+		RModel* pSourceModel = CreateDynamicTriangle(u32VertexCount);
+		vector<RModel*> vecModels;
+		for (unsigned int i = 0; i < u32ModelCount; ++i)
+		{
+			RModel* pModel = ModelFactory::CloneModel(pSourceModel);
+			pModel->SetPosition(D3DXVECTOR3(static_cast<float>(i) - u32ModelCount * 0.5f, 0.0f, 20.0f + i));
+			pScene->GetSceneRoot()->AttachChild(pModel);
+			vecModels.push_back(pModel);
+		}
+
+		renderSystem.SetDepthPrepassEnabled(true);
+		renderSystem.RenderOneFrame(0.0f);
+		renderSystem.SetDepthPrepassEnabled(false);
+
+		const unsigned int u32PrepassDrawCount = renderSystem.GetTotalFrameStatistics().aryCounters[EFC_DepthPrepassDrawCount];
+
+		pRenderTarget->SetDefaultCamera(nullptr);
+		delete pScene->GetSceneRoot();
+		for (RModel* pModel : vecModels)
+		{
+			delete pModel;
+		}
+		delete pCamera;
+		delete pSourceModel;
+		delete pScene;
+
+		return u32PrepassDrawCount;
+	}
+}
+
+// һ֡пʵĻʵʱŲµĻƣǱ
+RWGE_TEST(RenderSystem_InstancingFallsBackWhenInstanceStreamIsFull)
+{
+	RD3d9RenderSystem& renderSystem = RD3d9RenderSystem::GetInstance();
+	RD3d9RenderTarget* pRenderTarget = RTestRegistry::GetRenderTarget();
+
+	RSceneManager* pScene = new RSceneManager();
+	pScene->SetOcclusionCullingEnabled(false);
+
+	RCamera* pCamera = new RCamera();
+	pScene->GetSceneRoot()->AttachChild(pCamera);
+	pCamera->SetPerspective(0.785f, 4.0f / 3.0f, 1.0f, 2000.0f);
+	pRenderTarget->SetDefaultCamera(pCamera);
+
+	// кӶ׶ڣʹͬĲ뼸ݣһοʵĻ
+	const unsigned int u32ModelCount = RDynamicUploader::GetInstance().GetVertexBufferSize() / sizeof(D3DXMATRIX) + 4096;
+	RModel* pSourceModel = ModelFactory::CreateBox();
+	vector<RModel*> vecModels;
+
+	for (unsigned int i = 0; i < u32ModelCount; ++i)
+	{
+		RModel* pModel = ModelFactory::CloneModel(pSourceModel);
+		pModel->SetPosition(D3DXVECTOR3(static_cast<float>(i % 64) - 32.0f, static_cast<float>(i / 64 % 64) - 32.0f, 300.0f + i / 4096));
+		pScene->GetSceneRoot()->AttachChild(pModel);
+		vecModels.push_back(pModel);
+	}
+
+	renderSystem.RenderOneFrame(0.0f);
+
+	const RenderSystemStatistics& statistics = renderSystem.GetFrameStatistics();
+	const RD3d9RenderQueue* pRenderQueue = renderSystem.GetViewportRenderQueue(pRenderTarget->GetDefaultViewport());
+	RWGE_CHECK(pRenderQueue != nullptr && pRenderQueue->GetDrawItemCount() == u32ModelCount);
+	RWGE_CHECK(statistics.u32InstancingFallbackItemCount > 0);
+	RWGE_CHECK(statistics.u32InstanceCount + statistics.u32InstancingFallbackItemCount == u32ModelCount);
+	RWGE_CHECK(statistics.u32DrawItemCount == u32ModelCount);
+
+	pRenderTarget->SetDefaultCamera(nullptr);
+	delete pScene->GetSceneRoot();
+	for (RModel* pModel : vecModels)
+	{
+		delete pModel;
+	}
+	delete pCamera;
+	delete pSourceModel;
+	delete pScene;
+}
+
+// ԤȾκβ͸Ļж̬д뻷λʱÿдȣŲʱԤȾ
+// УûдȵĻᱻPassEQUALȲ޳
+RWGE_TEST(RenderSystem_DepthPrepassNeverDropsDynamicItems)
+{
+	const unsigned int u32ModelCount = 8;
+
+	// ÿģһ̬һ̬ȾԪ
+	RWGE_CHECK(RenderDynamicTriangles(3, u32ModelCount) == u32ModelCount * 2);
+
+	// ÿĶ̬λķ֮һ
+	const unsigned int u32VertexSize = RVertexDeclarationManager::GetInstance().GetDefaultVertexDeclaration()->GetVertexSize();
+	const unsigned int u32LargeVertexCount = RDynamicUploader::GetInstance().GetVertexBufferSize() / 4 / u32VertexSize + 1;
+	RWGE_CHECK(RenderDynamicTriangles(u32LargeVertexCount, u32ModelCount) == 0);
+}
@@ -0,0 +1,75 @@
+#include "RwgeTest.h"
+
+#include <RwgeGpuMemoryManager.h>
+#include <RwgeRenderUnit.h>
+#include <RwgeVertexStream.h>
+#include <RwgeIndexStream.h>
+
+namespace
+{
+	unsigned int GetAllocationCount(EGpuBufferType type)
+	{
+		return RGpuMemoryManager::GetInstance().GetStatistics(type).u32AllocationCount;
+	}
+}
+
+// ԴȾԪӷ䣬ɾԴȾԪʱȻ󶨣һȾԪɾʱŹ黹ӷ
+RWGE_TEST(RenderUnit_CloneKeepsStreamsBoundAfterSourceIsDeleted)
+{
+	const unsigned int u32VertexAllocationCount = GetAllocationCount(EGBT_Vertex);
+	const unsigned int u32IndexAllocationCount = GetAllocationCount(EGBT_Index);
+
+	float aryVertices[3 * 3] = { 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+	unsigned short aryIndices[3] = { 0, 1, 2 };
+	VertexStream vertexStream(sizeof(float) * 3, 3, aryVertices);
+	IndexStream indexStream(3, aryIndices);
+
+	RRenderUnit* pSourceRenderUnit = new RRenderUnit();
+	pSourceRenderUnit->SetPrimitiveType(D3DPT_TRIANGLELIST);
+	pSourceRenderUnit->SetPrimitiveCount(1);
+	pSourceRenderUnit->AddVertexStream(&vertexStream);
+	pSourceRenderUnit->SetIndexStream(&indexStream);
+	pSourceRenderUnit->BindStreamToBuffer();
+
+	RRenderUnit* pFirstClone = new RRenderUnit(*pSourceRenderUnit);
+	RRenderUnit* pSecondClone = new RRenderUnit(*pSourceRenderUnit);
+	RWGE_CHECK(vertexStream.u32BindCount == 3 && indexStream.u32BindCount == 3);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount + 1);
+	RWGE_CHECK(GetAllocationCount(EGBT_Index) == u32IndexAllocationCount + 1);
+
+	delete pSourceRenderUnit;
+	RWGE_CHECK(vertexStream.pD3dVertexBuffer != nullptr && indexStream.pD3dIndexBuffer != nullptr);
+	RWGE_CHECK(pFirstClone->GetDrawPacket().aryVertexBuffers[0] == vertexStream.pD3dVertexBuffer);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount + 1);
+	RWGE_CHECK(GetAllocationCount(EGBT_Index) == u32IndexAllocationCount + 1);
+
+	delete pFirstClone;
+	RWGE_CHECK(vertexStream.u32BindCount == 1 && indexStream.u32BindCount == 1);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount + 1);
+
+	delete pSecondClone;
+	RWGE_CHECK(vertexStream.pD3dVertexBuffer == nullptr && indexStream.pD3dIndexBuffer == nullptr);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount);
+	RWGE_CHECK(GetAllocationCount(EGBT_Index) == u32IndexAllocationCount);
+}
+
+// ûȾԪб
+RWGE_TEST(RenderUnit_UnbindWithoutIndexStream)
+{
+	const unsigned int u32VertexAllocationCount = GetAllocationCount(EGBT_Vertex);
+
+	float aryVertices[3 * 4] = {};
+	VertexStream vertexStream(sizeof(float) * 3, 4, aryVertices);
+
+	RRenderUnit* pRenderUnit = new RRenderUnit();
+	pRenderUnit->AddVertexStream(&vertexStream);
+	pRenderUnit->BindStreamToBuffer();
+	RWGE_CHECK(vertexStream.pD3dVertexBuffer != nullptr);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount + 1);
+
+	pRenderUnit->UnbindStreamFromBuffer();
+	RWGE_CHECK(vertexStream.pD3dVertexBuffer == nullptr && vertexStream.u32BindCount == 0);
+	RWGE_CHECK(GetAllocationCount(EGBT_Vertex) == u32VertexAllocationCount);
+
+	delete pRenderUnit;
+}
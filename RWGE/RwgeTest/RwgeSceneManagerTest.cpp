@@ -0,0 +1,57 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <RwgeSceneManager.h>
+#include <RwgeSceneNode.h>
+#include <RwgeModel.h>
+#include <RwgeModelFactory.h>
+
+// TransformStoreгһUpdateһ©Լģ͵ˢ
+RWGE_TEST(SceneManager_RefitsModelsUpdatedByAnotherScene)
+{
+	RSceneManager* pSceneA = new RSceneManager();
+	RSceneManager* pSceneB = new RSceneManager();
+
+	RModel* pModelA = ModelFactory::CreateBox();
+	RModel* pModelB = ModelFactory::CreateBox();
+	pSceneA->GetSceneRoot()->AttachChild(pModelA);
+	pSceneB->GetSceneRoot()->AttachChild(pModelB);
+	pSceneA->BeginFrame();
+	pSceneB->BeginFrame();
+
+	// AĲѯBeginFrameִUpdateģB任ʱ¼
+	pModelB->SetPosition(D3DXVECTOR3(100.0f, 0.0f, 0.0f));
+	pSceneA->RayCast(D3DXVECTOR3(0.0f, 0.0f, -10.0f), D3DXVECTOR3(0.0f, 0.0f, 1.0f), 100.0f);
+	pSceneA->BeginFrame();
+	RWGE_CHECK(pSceneA->GetLastRefittedProxyCount() == 0);
+
+	pSceneB->BeginFrame();
+	RWGE_CHECK(pSceneB->GetLastRefittedProxyCount() == 1);
+
+	std::vector<RModel*> vecModels;
+	pSceneB->QueryModelsInAabb(D3DXVECTOR3(90.0f, -10.0f, -10.0f), D3DXVECTOR3(110.0f, 10.0f, 10.0f), vecModels);
+	RWGE_CHECK(vecModels.size() == 1 && vecModels[0] == pModelB);
+
+	vecModels.clear();
+	pSceneB->QueryModelsInAabb(D3DXVECTOR3(-10.0f, -10.0f, -10.0f), D3DXVECTOR3(10.0f, 10.0f, 10.0f), vecModels);
+	RWGE_CHECK(vecModels.empty());
+
+	// ģͬһUpdateƶʱֻˢԼģ
+	pModelA->SetPosition(D3DXVECTOR3(0.0f, 50.0f, 0.0f));
+	pModelB->SetPosition(D3DXVECTOR3(0.0f, -50.0f, 0.0f));
+	pSceneB->BeginFrame();
+	pSceneA->BeginFrame();
+	RWGE_CHECK(pSceneA->GetLastRefittedProxyCount() == 1);
+	RWGE_CHECK(pSceneB->GetLastRefittedProxyCount() == 1);
+
+	vecModels.clear();
+	pSceneA->QueryModelsInAabb(D3DXVECTOR3(-10.0f, 40.0f, -10.0f), D3DXVECTOR3(10.0f, 60.0f, 10.0f), vecModels);
+	RWGE_CHECK(vecModels.size() == 1 && vecModels[0] == pModelA);
+
+	delete pModelA;
+	delete pModelB;
+	delete pSceneA->GetSceneRoot();
+	delete pSceneB->GetSceneRoot();
+	delete pSceneA;
+	delete pSceneB;
+}
@@ -0,0 +1,49 @@
+/*--------------------------------------------------------------------------------------------------------------------*\
+   CREATE
+	AUTH :	һ																			   DATE : 2016-07-08
+	DESC :
+	1.	ͷعԳ򣬲ڣ̨ʧܵĲʱķֵΪ0
+	2.	RWGE_TESTĲԺھ̬ʼ׶Զעᣬע˳ִ
+	3.	RWGE_CHECKʧʱ¼ļкţִеǰԵʣಿ
+	4.	RTestRandomRBenchmarkRandomͬĲӾʧʱ
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+class RD3d9RenderTarget;
+
+class RTestRegistry
+{
+public:
+	typedef void (*TestFunction)();
+
+	static void RegisterTest(const char* pName, TestFunction pFunction);
+	static void ReportFailure(const char* pFile, int s32Line, const char* pExpression);
+	static int RunAllTests();		// ʧܵĲ
+	static RD3d9RenderTarget* GetRenderTarget();		// mainдͷȾĿ꣬ԽʱҪָ
+};
+
+class RTestRegistrar
+{
+public:
+	RTestRegistrar(const char* pName, RTestRegistry::TestFunction pFunction) { RTestRegistry::RegisterTest(pName, pFunction); };
+};
+
+class RTestRandom
+{
+public:
+	RTestRandom(unsigned int u32Seed = 12345) : m_u32State(u32Seed) {};
+
+	unsigned int NextUInt() { m_u32State = m_u32State * 1664525 + 1013904223; return m_u32State >> 8; };
+
+private:
+	unsigned int m_u32State;
+};
+
+#define RWGE_TEST(Name) \
+	static void Name(); \
+	static RTestRegistrar s_##Name##Registrar(#Name, Name); \
+	static void Name()
+
+#define RWGE_CHECK(Expression) \
+	do { if (!(Expression)) { RTestRegistry::ReportFailure(__FILE__, __LINE__, #Expression); } } while (0)
@@ -0,0 +1,41 @@
+#include "RwgeTest.h"
+
+#include <RwgeTransformStore.h>
+
+// ģʽ´ĸڵ£任Զͣڴʱĵλ
+RWGE_TEST(TransformStore_RootCreatedInParallelModeIsUpdated)
+{
+	RTransformStore& transformStore = RTransformStore::GetInstance();
+
+	unsigned int u32Root = transformStore.CreateTransform();
+	unsigned int u32Child = transformStore.CreateTransform();
+	transformStore.SetParent(u32Child, u32Root);
+	transformStore.SetParallelSplitDepth(1);
+	transformStore.Update();
+
+	// ֻڵ㲻ıнڵУһUpdate»
+	unsigned int u32NewRoot = transformStore.CreateTransform();
+	transformStore.SetLocalPosition(u32NewRoot, D3DXVECTOR3(1.0f, 2.0f, 3.0f));
+	transformStore.Update();
+
+	const D3DXMATRIX& world = transformStore.GetWorldTransform(u32NewRoot);
+	RWGE_CHECK(world._41 == 1.0f && world._42 == 2.0f && world._43 == 3.0f);
+
+	bool bReported = false;
+	transformStore.ForEachUpdatedTransform([&](unsigned int u32Handle) { bReported = bReported || u32Handle == u32NewRoot; });
+	RWGE_CHECK(bReported);
+
+	// ¸ڵµӽڵͬҪ
+	unsigned int u32NewChild = transformStore.CreateTransform();
+	transformStore.SetParent(u32NewChild, u32NewRoot);
+	transformStore.SetLocalPosition(u32NewChild, D3DXVECTOR3(1.0f, 0.0f, 0.0f));
+	transformStore.Update();
+	RWGE_CHECK(transformStore.GetWorldTransform(u32NewChild)._41 == 2.0f);
+
+	transformStore.ReleaseTransform(u32NewChild);
+	transformStore.ReleaseTransform(u32NewRoot);
+	transformStore.ReleaseTransform(u32Child);
+	transformStore.ReleaseTransform(u32Root);
+	transformStore.SetParallelSplitDepth(0);
+	transformStore.Update();
+}
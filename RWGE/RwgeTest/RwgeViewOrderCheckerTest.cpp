@@ -0,0 +1,113 @@
+#include "RwgeTest.h"
+
+#include <vector>
+#include <algorithm>
+#include <RwgeRenderUnit.h>
+#include <RwgeVertexStream.h>
+#include <RwgeIndexStream.h>
+#include <RwgeVertexDeclarationManager.h>
+#include <RwgeViewOrderChecker.h>
+
+namespace
+{
+	/*
+	ķοƬһƽXYƽ棬һƽYZƽ棬ͬһеĿƬڴͶӰصȲཻ
+	˳Ǵҵģͼ˳뵼BuildViewOrdersͬ޴ϵľӴС
+	*/
+	const unsigned int u32CardCount = 16;
+
+	void BuildCards(std::vector<D3DXVECTOR3>& vecPositions, std::vector<unsigned short>& vecIndices)
+	{
+		for (unsigned int i = 0; i < u32CardCount; ++i)
+		{
+			const unsigned int u32Layer = i % (u32CardCount / 2);
+			const float f32Depth = u32Layer * 0.5f;
+			const float f32Shift = u32Layer * 0.2f;
+			const unsigned short u16First = static_cast<unsigned short>(vecPositions.size());
+
+			for (unsigned int u32Corner = 0; u32Corner < 4; ++u32Corner)
+			{
+				const float u = f32Shift + ((u32Corner & 1) ? 2.0f : 0.0f);
+				const float v = f32Shift + ((u32Corner & 2) ? 2.0f : 0.0f);
+				vecPositions.push_back(i < u32CardCount / 2 ? D3DXVECTOR3(u, v, f32Depth) : D3DXVECTOR3(6.0f + f32Depth, v, u));
+			}
+
+			const unsigned short aryQuad[6] = { 0, 1, 2, 2, 1, 3 };
+			for (unsigned short u16Index : aryQuad)
+			{
+				vecIndices.push_back(u16First + u16Index);
+			}
+		}
+	}
+
+	void AppendViewOrders(const std::vector<D3DXVECTOR3>& vecPositions, std::vector<unsigned short>& vecIndices)
+	{
+		const unsigned int u32TriangleCount = static_cast<unsigned int>(vecIndices.size() / 3);
+		const std::vector<unsigned short> vecBaseIndices(vecIndices);
+
+		for (unsigned int u32Octant = 0; u32Octant < RRenderUnit::u8ViewOrderCount; ++u32Octant)
+		{
+			const D3DXVECTOR3 direction((u32Octant & 1) ? -1.0f : 1.0f, (u32Octant & 2) ? -1.0f : 1.0f, (u32Octant & 4) ? -1.0f : 1.0f);
+
+			std::vector<float> vecDepths(u32TriangleCount);
+			std::vector<unsigned int> vecTriangles(u32TriangleCount);
+			for (unsigned int i = 0; i < u32TriangleCount; ++i)
+			{
+				const D3DXVECTOR3 centroid = (vecPositions[vecBaseIndices[i * 3]] + vecPositions[vecBaseIndices[i * 3 + 1]] + vecPositions[vecBaseIndices[i * 3 + 2]]) / 3.0f;
+				vecDepths[i] = D3DXVec3Dot(&centroid, &direction);
+				vecTriangles[i] = i;
+			}
+
+			std::stable_sort(vecTriangles.begin(), vecTriangles.end(), [&vecDepths](unsigned int a, unsigned int b) { return vecDepths[a] > vecDepths[b]; });
+
+			for (unsigned int u32Triangle : vecTriangles)
+			{
+				vecIndices.insert(vecIndices.end(), vecBaseIndices.begin() + u32Triangle * 3, vecBaseIndices.begin() + u32Triangle * 3 + 3);
+			}
+		}
+	}
+}
+
+// ۲췽£ѡͼ˳˳ζڴҵĻ˳
+RWGE_TEST(ViewOrderChecker_ViewOrdersBeatUnsortedOrder)
+{
+	std::vector<D3DXVECTOR3> vecPositions;
+	std::vector<unsigned short> vecIndices;
+	BuildCards(vecPositions, vecIndices);
+
+	// Ϊλһ˳
+	const unsigned int u32TriangleCount = static_cast<unsigned int>(vecIndices.size() / 3);
+	RTestRandom random(24);
+	for (unsigned int i = u32TriangleCount; i > 1; --i)
+	{
+		const unsigned int j = random.NextUInt() % i;
+		std::swap_ranges(vecIndices.begin() + (i - 1) * 3, vecIndices.begin() + i * 3, vecIndices.begin() + j * 3);
+	}
+
+	AppendViewOrders(vecPositions, vecIndices);
+
+	VertexStream vertexStream(sizeof(D3DXVECTOR3), static_cast<unsigned int>(vecPositions.size()), vecPositions.data());
+	IndexStream indexStream(static_cast<unsigned int>(vecIndices.size()), vecIndices.data());
+
+	RRenderUnit renderUnit;
+	renderUnit.SetVertexDeclaration(RVertexDeclarationManager::GetInstance().GetPositionSplitVertexDeclaration());
+	renderUnit.SetPrimitiveType(D3DPT_TRIANGLELIST);
+	renderUnit.SetPrimitiveCount(u32TriangleCount);
+	renderUnit.AddVertexStream(&vertexStream);
+	renderUnit.SetIndexStream(&indexStream);
+	RWGE_CHECK(renderUnit.SetViewOrdersEnabled(true));
+
+	RViewOrderChecker checker;
+	for (unsigned int u32Seed = 1; u32Seed <= 4; ++u32Seed)
+	{
+		const ViewOrderQuality quality = checker.Evaluate(renderUnit, 64, u32Seed);
+		RWGE_CHECK(quality.u32ViewCount == 64);
+		RWGE_CHECK(quality.u64OverlappingPairCount > 0);
+		RWGE_CHECK(quality.u64ViewOrderOutOfOrderCount < quality.u64BaseOutOfOrderCount);
+	}
+
+	// ûͼ˳ʱͬ
+	RWGE_CHECK(renderUnit.SetViewOrdersEnabled(false));
+	const ViewOrderQuality baseQuality = checker.Evaluate(renderUnit, 64);
+	RWGE_CHECK(baseQuality.u64ViewOrderOutOfOrderCount == baseQuality.u64BaseOutOfOrderCount);
+}
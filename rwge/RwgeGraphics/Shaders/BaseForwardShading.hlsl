@@ -1,13 +1,5 @@
-#include "Material.hlsli"
-#include "Light.hlsli"
-#include "BRDF.hlsli"
-#include "SH.hlsli"
-
-//////////////////////////////////////////////////////////////////////////////
-
-// sharedؼͨEffect Poolڲͬshader乲
-shared matrix	g_WVP;
-shared float3	g_ViewOppositeDirection;				// ָӵ㷢ķ
+// ʡԴBRDFSHԼ任ʵԤȾ汾ĺҲ
+#include "UniformDefinition.hlsli"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -41,16 +33,19 @@ VSOutput BaseVS(float4 inPosition	: POSITION,
 				float2 inTexCoord	: TEXCOORD0,
 				float3 inNormal		: NORMAL,
 				float3 inBinormal	: BINORMAL,
-				float3 inTangent	: TANGENT)
+				float3 inTangent	: TANGENT
+				VS_INSTANCE_INPUT)
 {
 	VSOutput output = (VSOutput)0;
 
-	output.position = inPosition;
-	output.PsUsedPos = inPosition;
+	// üռλñɫʹͬGET_WORLD_VIEW_PROJ()㣬EQUALȲԻ޳
+	float4x4 matWorld = GET_WORLD_TRANSFORM();
+	output.position = mul(inPosition, GET_WORLD_VIEW_PROJ());
+	output.PsUsedPos = mul(inPosition, matWorld).xyz;
 	output.texCoord = inTexCoord;
-	output.normal = inNormal;
-	output.binormal = inBinormal;
-	output.tangent = inTangent;
+	output.normal = mul(inNormal, (float3x3)matWorld);
+	output.binormal = mul(inBinormal, (float3x3)matWorld);
+	output.tangent = mul(inTangent, (float3x3)matWorld);
 
 	return output;
 }
@@ -90,7 +85,7 @@ half4 BasePS(	float3 inPosition	: TEXCOORD1,
 	diffuseColor += specular * 0.45;
 	specularColor = 0;
 #else
-	half normalDotView = max(dot(normal, g_ViewOppositeDirection), 0);
+	half normalDotView = max(dot(normal, g_vecOppositeView.xyz), 0);
 
 #	if MATERIAL_NONMETAL
 	specularColor = EnvBRDFApproxNonmetal(roughness, normalDotView);
@@ -109,7 +104,7 @@ half4 BasePS(	float3 inPosition	: TEXCOORD1,
 
 	// ============================= 㷽 =============================
 #if MATERIAL_SHADING_MODE != SHADING_UNLIT
-	half3 reflectionVector = -g_ViewOppositeDirection + normal * dot(normal, g_ViewOppositeDirection) * 2.0;
+	half3 reflectionVector = -g_vecOppositeView.xyz + normal * dot(normal, g_vecOppositeView.xyz) * 2.0;
 	half3 lightDirection = GetLightWorldDirection(inPosition);
 	half  normalDotLight = max(0, dot(normal, lightDirection));
 	half reflectionDotLight = max(0, dot(reflectionVector, lightDirection));
@@ -136,6 +131,8 @@ half4 BasePS(	float3 inPosition	: TEXCOORD1,
 
 //////////////////////////////////////////////////////////////////////////////
 
+// Ȱ汾ֻUniformDefinition.hlsliеDepthOnlyTechnique
+#if !SHADER_DEPTH_ONLY
 technique BaseTechnique
 {
 	pass BasePass
@@ -210,4 +207,5 @@ technique BaseTechnique
 		VertexShader = compile vs_3_0 BaseVS();
 		PixelShader = compile ps_3_0 BasePS();
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -15,7 +15,7 @@ struct DirectionalLight
 	float3 worldDirection;
 };
 
-shared DirectionalLight g_DirectionalLight;
+shared DirectionalLight g_Light;		// ͨg_LightùԴ
 
 #elif LIGHT_TYPE == POINT_LIGHT
 
@@ -26,7 +26,7 @@ struct PointLight
 	float3 worldPosition;
 };
 
-shared PointLight g_PointLight;
+shared PointLight g_Light;
 
 #endif
 
@@ -35,9 +35,9 @@ half3 GetLightAmbientColor()
 #if LIGHT_TYPE == NO_LIGHT
 	return 0;
 #elif LIGHT_TYPE == DIRECTIONAL_LIGHT
-	return g_DirectionalLight.ambientColor;
+	return g_Light.ambientColor;
 #elif LIGHT_TYPE == POINT_LIGHT
-	return g_PointLight.ambientColor;
+	return g_Light.ambientColor;
 #endif
 }
 
@@ -46,9 +46,9 @@ half3 GetLightDiffuseColor()
 #if LIGHT_TYPE == NO_LIGHT
 	return 0;
 #elif LIGHT_TYPE == DIRECTIONAL_LIGHT
-	return g_DirectionalLight.diffuseColor;
+	return g_Light.diffuseColor;
 #elif LIGHT_TYPE == POINT_LIGHT
-	return g_PointLight.diffuseColor;
+	return g_Light.diffuseColor;
 #endif
 }
 
@@ -57,9 +57,9 @@ float3 GetLightWorldDirection(float3 position)
 #if LIGHT_TYPE == NO_LIGHT
 	return float3(1.0f, 1.0f, 1.0f);
 #elif LIGHT_TYPE == DIRECTIONAL_LIGHT
-	return g_DirectionalLight.worldDirection;
+	return g_Light.worldDirection;
 #elif LIGHT_TYPE == POINT_LIGHT
-	return g_PointLight.worldPosition - position;
+	return g_Light.worldPosition - position;
 #endif
 }
 